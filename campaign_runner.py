@@ -71,7 +71,7 @@ class CampaignRunner:
         keys = ["center_freq_hz", "sample_rate_hz", "rbw_hz", "overlap",
                 "window", "lna_gain", "vga_gain", "antenna_amp",
                 "antenna_port", "ppm_error", "filter", "cooldown_request",
-                "method_psd"]
+                "method_psd", "target_averages"]
         try:
             rf_params = {k: self.store.consult_persistent(k) for k in keys}
             if rf_params.get("cooldown_request") is None:
@@ -158,7 +158,7 @@ class CampaignRunner:
         """
         self.store.add_to_persistent("campaign_runner_running", True)
         try:
-            async with ZmqPairController(addr=cfg.IPC_ADDR, is_server=True) as zmq_ctrl:
+            async with ZmqPairController(addr=cfg.IPC_ADDR_CAMPAIGN, is_server=True) as zmq_ctrl:
                 await asyncio.sleep(0.5)
                 # AcquireDual aplica la lógica de "patching" para corregir el centro
                 acquirer = AcquireDual(zmq_ctrl, log)
@@ -45,6 +45,9 @@ DEBUG = os.getenv("DEBUG", "false").lower() == "true"
 
 DUMMY_MAC = os.getenv("DUMMY_MAC", "d0:65:78:9c:dd:d0")
 
+#: Pide al motor RF los tiempos por etapa en cada reply (objeto "metrics")
+RF_METRICS = os.getenv("RF_METRICS", "false").lower() == "true"
+
 # Endpoints de la API
 DATA_URL = os.getenv("DATA_URL", "/data")
 STATUS_URL = os.getenv("STATUS_URL", "/status")
@@ -52,8 +55,13 @@ CAMPAIGN_URL = os.getenv("CAMPAIGN_URL", "/campaigns")
 REALTIME_URL = os.getenv("REALTIME_URL", "/realtime")
 GPS_URL = os.getenv("GPS_URL", "/gps")
 
+#: Transporte del audio rf_app -> server_webrtc.py: "tcp" (tramas OPU0) o "rtp" (RTP/Opus sobre UDP)
+AUDIO_TRANSPORT = os.getenv("AUDIO_TRANSPORT", "tcp").strip().lower()
+
 #: Dirección del socket IPC para comunicación con el motor RF
 IPC_ADDR = os.getenv("IPC_ADDR", "ipc:///tmp/rf_engine")
+#: Endpoint propio del campaign runner (el motor RF se conecta a ambos)
+IPC_ADDR_CAMPAIGN = os.getenv("IPC_ADDR_CAMPAIGN", "ipc:///tmp/rf_engine_campaign")
 
 # Intervalos de tiempo
 INTERVAL_REQUEST_CAMPAIGNS_S = int(os.getenv("INTERVAL_REQUEST_CAMPAIGNS_S", "60"))
@@ -0,0 +1,78 @@
+/**
+ * @file gps_time_shm.c
+ * @brief Implementación del segmento compartido de hora GPS (seqlock sobre `shm_open`).
+ */
+
+#include "gps_time_shm.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @addtogroup gps_time_shm_module
+ * @{
+ */
+
+gps_time_shm_t *gps_time_shm_open(bool writer) {
+    const int fd = writer ? shm_open(GPS_TIME_SHM_NAME, O_CREAT | O_RDWR, 0644)
+                          : shm_open(GPS_TIME_SHM_NAME, O_RDONLY, 0);
+    if (fd < 0) return NULL;
+
+    if (writer && ftruncate(fd, (off_t)sizeof(gps_time_shm_t)) != 0) {
+        close(fd);
+        return NULL;
+    }
+    void *p = mmap(NULL, sizeof(gps_time_shm_t), writer ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                   MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return NULL;
+
+    gps_time_shm_t *shm = (gps_time_shm_t*)p;
+    if (writer) {
+        shm->magic = GPS_TIME_SHM_MAGIC;
+        shm->version = GPS_TIME_SHM_VERSION;
+    }
+    return shm;
+}
+
+void gps_time_shm_publish(gps_time_shm_t *shm, const gps_time_fix_t *fix) {
+    if (!shm || !fix) return;
+    const unsigned s = atomic_load_explicit(&shm->seq, memory_order_relaxed);
+    atomic_store_explicit(&shm->seq, s + 1U, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    atomic_store_explicit(&shm->utc_ns, fix->utc_ns, memory_order_relaxed);
+    atomic_store_explicit(&shm->mono_ns, fix->mono_ns, memory_order_relaxed);
+    atomic_store_explicit(&shm->quality, fix->quality, memory_order_relaxed);
+    atomic_store_explicit(&shm->satellites, fix->satellites, memory_order_relaxed);
+
+    atomic_store_explicit(&shm->seq, s + 2U, memory_order_release);
+}
+
+int gps_time_shm_read(const gps_time_shm_t *shm, gps_time_fix_t *out) {
+    if (!shm || !out || shm->magic != GPS_TIME_SHM_MAGIC || shm->version != GPS_TIME_SHM_VERSION) return -1;
+
+    // The writer only holds the lock for four stores: a few retries always suffice
+    for (int tries = 0; tries < 64; tries++) {
+        const unsigned s1 = atomic_load_explicit(&shm->seq, memory_order_acquire);
+        if (s1 & 1U) continue;
+        out->utc_ns = atomic_load_explicit(&shm->utc_ns, memory_order_relaxed);
+        out->mono_ns = atomic_load_explicit(&shm->mono_ns, memory_order_relaxed);
+        out->quality = atomic_load_explicit(&shm->quality, memory_order_relaxed);
+        out->satellites = atomic_load_explicit(&shm->satellites, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&shm->seq, memory_order_relaxed) == s1) {
+            return (s1 != 0U && out->quality > 0) ? 0 : -1;
+        }
+    }
+    return -1;
+}
+
+void gps_time_shm_close(gps_time_shm_t *shm) {
+    if (shm) munmap(shm, sizeof(gps_time_shm_t));
+}
+
+/** @} */
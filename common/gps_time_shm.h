@@ -0,0 +1,88 @@
+/**
+ * @file gps_time_shm.h
+ * @brief Canal de memoria compartida con la última hora UTC del GPS y su instante monotónico.
+ *
+ * gps-lte decodifica la hora NMEA (GGA) y la publica en un segmento POSIX (`shm_open`)
+ * de unas decenas de bytes; rf_app lo mapea en solo lectura y traduce sus marcas
+ * `CLOCK_MONOTONIC` a UTC sin pasar por los archivos JSON `persistent`. El segmento se
+ * protege con un seqlock: el escritor nunca bloquea y el lector reintenta si lo leyó a mitad
+ * de una actualización.
+ *
+ * La precisión es la de la llegada de la trama por el puerto serie (decenas de ms, sin PPS):
+ * suficiente para alinear capturas entre nodos a nivel de trama, no de muestra.
+ * @author GCPDS
+ * @date 2026
+ */
+
+#ifndef GPS_TIME_SHM_H
+#define GPS_TIME_SHM_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @defgroup gps_time_shm_module GPS Time SHM
+ * @brief Hora GPS compartida entre gps-lte y rf_app.
+ * @{
+ */
+
+#define GPS_TIME_SHM_NAME    "/bacn_gps_time" /**< Nombre POSIX del segmento (`/dev/shm/bacn_gps_time`). */
+#define GPS_TIME_SHM_MAGIC   0x54535047u      /**< "GPST" en little-endian. */
+#define GPS_TIME_SHM_VERSION 1                /**< Versión del layout. */
+#define GPS_TIME_MAX_AGE_NS  (10LL * 1000000000LL) /**< Antigüedad máxima de un fix para usarlo como referencia. */
+
+/**
+ * @brief Layout del segmento compartido.
+ */
+typedef struct {
+    uint32_t magic;            /**< @ref GPS_TIME_SHM_MAGIC (lo escribe el creador). */
+    uint32_t version;          /**< @ref GPS_TIME_SHM_VERSION. */
+    atomic_uint seq;           /**< Seqlock: impar mientras el escritor actualiza. */
+    atomic_int quality;        /**< Calidad del fix GGA (0 = sin fix). */
+    atomic_int satellites;     /**< Satélites en uso. */
+    _Atomic int64_t utc_ns;    /**< Hora UTC del fix (ns desde 1970). */
+    _Atomic int64_t mono_ns;   /**< `CLOCK_MONOTONIC` (ns) al recibir la trama. */
+} gps_time_shm_t;
+
+/**
+ * @brief Copia consistente de un fix.
+ */
+typedef struct {
+    int64_t utc_ns;   /**< Hora UTC del fix (ns desde 1970). */
+    int64_t mono_ns;  /**< `CLOCK_MONOTONIC` (ns) al recibir la trama. */
+    int quality;      /**< Calidad del fix GGA. */
+    int satellites;   /**< Satélites en uso. */
+} gps_time_fix_t;
+
+/**
+ * @brief Mapea el segmento.
+ * @param writer true para crearlo en lectura/escritura (gps-lte), false para mapearlo en solo lectura.
+ * @return Puntero al segmento, o NULL si no existe (lector) o falló la creación.
+ */
+gps_time_shm_t *gps_time_shm_open(bool writer);
+
+/**
+ * @brief Publica un fix (solo el escritor).
+ * @param shm Segmento abierto con `writer = true`.
+ * @param fix Fix a publicar.
+ */
+void gps_time_shm_publish(gps_time_shm_t *shm, const gps_time_fix_t *fix);
+
+/**
+ * @brief Lee el último fix.
+ * @param shm Segmento.
+ * @param[out] out Fix leído.
+ * @return 0 si hay un fix válido, -1 si no hay segmento, no hay fix o el layout no coincide.
+ */
+int gps_time_shm_read(const gps_time_shm_t *shm, gps_time_fix_t *out);
+
+/**
+ * @brief Desmapea el segmento (no lo borra).
+ * @param shm Segmento.
+ */
+void gps_time_shm_close(gps_time_shm_t *shm);
+
+/** @} */
+
+#endif // GPS_TIME_SHM_H
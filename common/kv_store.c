@@ -0,0 +1,387 @@
+/**
+ * @file kv_store.c
+ * @brief Implementación del almacén clave/valor compartido (seqlock por slot + snapshot JSON).
+ */
+
+#include "kv_store.h"
+
+#include <cjson/cJSON.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @addtogroup kv_store_module
+ * @{
+ */
+
+/** Reintentos de un lector frente a un slot en escritura (el escritor solo copia el valor). */
+#define KV_READ_TRIES 1024
+
+typedef enum { KV_PROBE_EMPTY, KV_PROBE_OTHER, KV_PROBE_MATCH, KV_PROBE_BUSY } kv_probe_t;
+
+/** @brief FNV-1a de 32 bits: el mismo hash que usa `ShmStore` en Python. */
+static uint32_t kv_hash(const char *key) {
+    uint32_t h = 2166136261u;
+    for (const unsigned char *c = (const unsigned char*)key; *c; c++) {
+        h ^= *c;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static bool key_ok(const char *key) {
+    return key && key[0] != '\0' && strlen(key) < KV_KEY_MAX;
+}
+
+static kv_slot_t *slot_at(kv_shm_t *shm, uint32_t h, unsigned n) {
+    return &shm->slots[(h + n) % KV_SLOTS];
+}
+
+/**
+ * @brief Copia consistente de un slot para un lector.
+ * @param[out] buf Recibe el valor si la clave coincide (al menos @ref KV_VALUE_MAX bytes).
+ */
+static kv_probe_t read_slot(const kv_slot_t *s, const char *key, char *buf, size_t *len, uint8_t *type) {
+    char k[KV_KEY_MAX];
+    for (int tries = 0; tries < KV_READ_TRIES; tries++) {
+        const unsigned s1 = atomic_load_explicit(&s->seq, memory_order_acquire);
+        if (s1 & 1U) continue;
+
+        const uint8_t t = s->type;
+        size_t n = s->len;
+        memcpy(k, s->key, sizeof(k));
+        k[KV_KEY_MAX - 1] = '\0';
+        const bool match = (t != KV_TYPE_EMPTY) && strcmp(k, key) == 0;
+        if (match) {
+            if (n > KV_VALUE_MAX) n = KV_VALUE_MAX;
+            memcpy(buf, s->value, n);
+        }
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&s->seq, memory_order_relaxed) != s1) continue;
+
+        if (t == KV_TYPE_EMPTY) return KV_PROBE_EMPTY;
+        if (!match) return KV_PROBE_OTHER;
+        *len = n;
+        *type = t;
+        return KV_PROBE_MATCH;
+    }
+    return KV_PROBE_BUSY;
+}
+
+/** @brief Escribe un slot bajo el lock de escritores. */
+static void write_slot(kv_slot_t *s, const char *key, uint8_t type, const char *value, size_t len) {
+    const unsigned seq = atomic_load_explicit(&s->seq, memory_order_relaxed);
+    atomic_store_explicit(&s->seq, seq + 1U, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    s->type = type;
+    s->len = (uint16_t)len;
+    memset(s->key, 0, sizeof(s->key));
+    if (key) strcpy(s->key, key);
+    if (len) memcpy(s->value, value, len);
+
+    atomic_store_explicit(&s->seq, seq + 2U, memory_order_release);
+}
+
+/**
+ * @brief Slot de @p key para un escritor: el que ya la tiene o el primer libre del sondeo.
+ * @return NULL si la tabla está llena.
+ */
+static kv_slot_t *find_slot_locked(kv_shm_t *shm, const char *key) {
+    const uint32_t h = kv_hash(key);
+    for (unsigned n = 0; n < KV_SLOTS; n++) {
+        kv_slot_t *s = slot_at(shm, h, n);
+        if (s->type == KV_TYPE_EMPTY || strncmp(s->key, key, KV_KEY_MAX) == 0) return s;
+    }
+    return NULL;
+}
+
+static cJSON *load_snapshot(void) {
+    FILE *f = fopen(KV_SNAPSHOT_PATH, "r");
+    if (!f) return NULL;
+
+    size_t cap = 4096, len = 0;
+    char *text = (char*)malloc(cap);
+    while (text) {
+        const size_t n = fread(text + len, 1, cap - len - 1, f);
+        len += n;
+        if (n == 0) break;
+        if (cap - len < 2048) {
+            char *tmp = (char*)realloc(text, cap * 2);
+            if (!tmp) {
+                free(text);
+                text = NULL;
+                break;
+            }
+            text = tmp;
+            cap *= 2;
+        }
+    }
+    fclose(f);
+    if (!text) return NULL;
+    text[len] = '\0';
+
+    cJSON *root = cJSON_Parse(text);
+    free(text);
+    if (root && !cJSON_IsObject(root)) {
+        cJSON_Delete(root);
+        root = NULL;
+    }
+    return root;
+}
+
+/**
+ * @brief Texto que va al slot para un valor: la cadena cruda o su JSON.
+ * @return Cadena en el heap (liberar con free()), o NULL si falló la reserva.
+ */
+static char *slot_text(const cJSON *item, uint8_t *type) {
+    if (cJSON_IsString(item) && item->valuestring) {
+        *type = KV_TYPE_STRING;
+        return strdup(item->valuestring);
+    }
+    *type = KV_TYPE_JSON;
+    return cJSON_PrintUnformatted(item);
+}
+
+/**
+ * @brief Reescribe el snapshot desde los slots (tmp + rename: nunca queda a medias).
+ * @param big_key Clave cuyo valor no cupo en su slot (NULL si ninguna).
+ * @param big_item Valor de @p big_key.
+ */
+static int write_snapshot_locked(kv_shm_t *shm, const char *big_key, const cJSON *big_item) {
+    cJSON *root = cJSON_CreateObject();
+    cJSON *old = NULL;
+    bool old_loaded = false;
+    char *buf = (char*)malloc(KV_VALUE_MAX + 1);
+    if (!root || !buf) {
+        cJSON_Delete(root);
+        free(buf);
+        return -1;
+    }
+
+    for (unsigned i = 0; i < KV_SLOTS; i++) {
+        const kv_slot_t *s = &shm->slots[i];
+        cJSON *item = NULL;
+        if (s->type == KV_TYPE_STRING || s->type == KV_TYPE_JSON) {
+            memcpy(buf, s->value, s->len);
+            buf[s->len] = '\0';
+            item = (s->type == KV_TYPE_STRING) ? cJSON_CreateString(buf) : cJSON_Parse(buf);
+        } else if (s->type == KV_TYPE_SNAPSHOT) {
+            if (big_key && strcmp(s->key, big_key) == 0) {
+                item = cJSON_Duplicate(big_item, true);
+            } else {
+                if (!old_loaded) {
+                    old = load_snapshot();
+                    old_loaded = true;
+                }
+                item = cJSON_Duplicate(cJSON_GetObjectItemCaseSensitive(old, s->key), true);
+            }
+        }
+        if (item) cJSON_AddItemToObject(root, s->key, item);
+    }
+    cJSON_Delete(old);
+    free(buf);
+
+    char *out = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    if (!out) return -1;
+
+    int rc = -1;
+    const char *tmp_path = KV_SNAPSHOT_PATH ".tmp";
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd >= 0) {
+        const char *ptr = out;
+        size_t remaining = strlen(out);
+        while (remaining > 0) {
+            const ssize_t written = write(fd, ptr, remaining);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            ptr += (size_t)written;
+            remaining -= (size_t)written;
+        }
+        if (remaining == 0 && fsync(fd) == 0) rc = 0;
+        close(fd);
+        if (rc == 0 && rename(tmp_path, KV_SNAPSHOT_PATH) != 0) rc = -1;
+        if (rc != 0) unlink(tmp_path);
+    }
+    free(out);
+    return rc;
+}
+
+/** @brief Carga el snapshot en un segmento recién creado (sin reescribirlo). */
+static void import_snapshot_locked(kv_shm_t *shm) {
+    cJSON *root = load_snapshot();
+    if (!root) return;
+
+    const cJSON *item;
+    cJSON_ArrayForEach(item, root) {
+        if (!key_ok(item->string)) continue;
+        kv_slot_t *s = find_slot_locked(shm, item->string);
+        if (!s) break;
+
+        uint8_t type;
+        char *text = slot_text(item, &type);
+        if (!text) continue;
+        const size_t len = strlen(text);
+        if (len > KV_VALUE_MAX) write_slot(s, item->string, KV_TYPE_SNAPSHOT, NULL, 0);
+        else write_slot(s, item->string, type, text, len);
+        free(text);
+    }
+    cJSON_Delete(root);
+}
+
+int kv_open(kv_store_t *kv) {
+    if (!kv) return -1;
+    kv->shm = NULL;
+    kv->fd = -1;
+
+    const int fd = shm_open(KV_SHM_NAME, O_CREAT | O_RDWR, 0666);
+    if (fd < 0) return -1;
+    // Python and both binaries write it: undo the creator's umask
+    (void)fchmod(fd, 0666);
+
+    if (flock(fd, LOCK_EX) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    struct stat st;
+    const bool resize = fstat(fd, &st) != 0 || st.st_size != (off_t)sizeof(kv_shm_t);
+    if (resize && ftruncate(fd, (off_t)sizeof(kv_shm_t)) != 0) {
+        flock(fd, LOCK_UN);
+        close(fd);
+        return -1;
+    }
+
+    void *p = mmap(NULL, sizeof(kv_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        flock(fd, LOCK_UN);
+        close(fd);
+        return -1;
+    }
+    kv_shm_t *shm = (kv_shm_t*)p;
+
+    if (resize || shm->magic != KV_MAGIC || shm->version != KV_VERSION ||
+        shm->n_slots != KV_SLOTS || shm->slot_size != KV_SLOT_SIZE) {
+        memset(shm, 0, sizeof(*shm));
+        shm->version = KV_VERSION;
+        shm->n_slots = KV_SLOTS;
+        shm->slot_size = KV_SLOT_SIZE;
+        import_snapshot_locked(shm);
+        atomic_thread_fence(memory_order_release);
+        shm->magic = KV_MAGIC;
+    }
+
+    flock(fd, LOCK_UN);
+    kv->shm = shm;
+    kv->fd = fd;
+    return 0;
+}
+
+int kv_set(kv_store_t *kv, const char *key, const char *value_text) {
+    if (!kv || !kv->shm || !key_ok(key)) return -1;
+
+    cJSON *item = NULL;
+    if (!value_text) item = cJSON_CreateNull();
+    else if (!(item = cJSON_Parse(value_text))) item = cJSON_CreateString(value_text);
+    uint8_t type;
+    char *text = item ? slot_text(item, &type) : NULL;
+    if (!text) {
+        cJSON_Delete(item);
+        return -1;
+    }
+    size_t len = strlen(text);
+    if (len > KV_VALUE_MAX) {
+        type = KV_TYPE_SNAPSHOT;
+        len = 0;
+    }
+
+    if (flock(kv->fd, LOCK_EX) != 0) {
+        free(text);
+        cJSON_Delete(item);
+        return -1;
+    }
+
+    int rc = -1;
+    kv_slot_t *s = find_slot_locked(kv->shm, key);
+    if (s) {
+        // gps-lte rewrites the same flags on every fix: nothing to publish
+        const bool same = s->type == type && type != KV_TYPE_SNAPSHOT && s->len == len &&
+                          memcmp(s->value, text, len) == 0;
+        rc = 0;
+        if (!same) {
+            write_slot(s, key, type, text, len);
+            rc = write_snapshot_locked(kv->shm, key, item);
+        }
+    }
+
+    flock(kv->fd, LOCK_UN);
+    free(text);
+    cJSON_Delete(item);
+    return rc;
+}
+
+char *kv_get(kv_store_t *kv, const char *key) {
+    if (!kv || !kv->shm || !key_ok(key)) return NULL;
+
+    char buf[KV_VALUE_MAX + 1];
+    const uint32_t h = kv_hash(key);
+    for (unsigned n = 0; n < KV_SLOTS; n++) {
+        size_t len = 0;
+        uint8_t type = KV_TYPE_EMPTY;
+        const kv_probe_t r = read_slot(slot_at(kv->shm, h, n), key, buf, &len, &type);
+        if (r == KV_PROBE_OTHER) continue;
+        if (r != KV_PROBE_MATCH) return NULL;
+
+        if (type != KV_TYPE_SNAPSHOT) {
+            char *out = (char*)malloc(len + 1);
+            if (!out) return NULL;
+            memcpy(out, buf, len);
+            out[len] = '\0';
+            return out;
+        }
+
+        // Oversized value: the snapshot is the only copy
+        cJSON *root = load_snapshot();
+        const cJSON *item = cJSON_GetObjectItemCaseSensitive(root, key);
+        char *out = NULL;
+        if (item) {
+            out = (cJSON_IsString(item) && item->valuestring) ? strdup(item->valuestring)
+                                                              : cJSON_PrintUnformatted(item);
+        }
+        cJSON_Delete(root);
+        return out;
+    }
+    return NULL;
+}
+
+int kv_clear(kv_store_t *kv) {
+    if (!kv || !kv->shm) return -1;
+    if (flock(kv->fd, LOCK_EX) != 0) return -1;
+    for (unsigned i = 0; i < KV_SLOTS; i++) {
+        kv_slot_t *s = &kv->shm->slots[i];
+        if (s->type != KV_TYPE_EMPTY) write_slot(s, NULL, KV_TYPE_EMPTY, NULL, 0);
+    }
+    const int rc = write_snapshot_locked(kv->shm, NULL, NULL);
+    flock(kv->fd, LOCK_UN);
+    return rc;
+}
+
+void kv_close(kv_store_t *kv) {
+    if (!kv) return;
+    if (kv->shm) munmap(kv->shm, sizeof(kv_shm_t));
+    if (kv->fd >= 0) close(kv->fd);
+    kv->shm = NULL;
+    kv->fd = -1;
+}
+
+/** @} */
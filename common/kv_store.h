@@ -0,0 +1,125 @@
+/**
+ * @file kv_store.h
+ * @brief Almacén clave/valor en memoria compartida con slots fijos y lecturas sin lock.
+ *
+ * Reemplaza el ciclo leer-parsear-reescribir de `/dev/shm/persistent.json` en cada consulta:
+ * el segmento POSIX `/dev/shm/bacn_kv` tiene @ref KV_SLOTS slots de tamaño fijo direccionados
+ * por hash de la clave (sondeo lineal). Cada slot es un seqlock: los lectores copian el valor
+ * y reintentan si un escritor lo tocó en el medio, sin syscalls ni parseo. Los escritores
+ * (rf_app, ltegps_app y `utils.io_util.ShmStore` en Python) se serializan con `flock` sobre
+ * el segmento y reescriben el snapshot JSON, que queda solo como copia durable: al crear el
+ * segmento se importa desde él.
+ *
+ * Los valores se guardan como texto: cadenas crudas o JSON. Un valor que no cabe en el slot
+ * se marca @ref KV_TYPE_SNAPSHOT y se lee del snapshot (camino lento, solo para listas largas).
+ * @author GCPDS
+ * @date 2026
+ */
+
+#ifndef KV_STORE_H
+#define KV_STORE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @defgroup kv_store_module KV Store
+ * @brief Estado compartido entre rf_app, ltegps_app y Python.
+ * @{
+ */
+
+#define KV_SHM_NAME       "/bacn_kv"                 /**< Nombre POSIX (`/dev/shm/bacn_kv`). */
+#define KV_SNAPSHOT_PATH  "/dev/shm/persistent.json" /**< Snapshot JSON (formato histórico). */
+#define KV_MAGIC          0x30564B42u                /**< "BKV0" en little-endian. */
+#define KV_VERSION        1                          /**< Versión del layout. */
+#define KV_SLOTS          64                         /**< Slots del segmento. */
+#define KV_SLOT_SIZE      4096                       /**< Bytes por slot. */
+#define KV_KEY_MAX        48                         /**< Bytes de clave, incluido el NUL. */
+#define KV_VALUE_MAX      (KV_SLOT_SIZE - 8 - KV_KEY_MAX) /**< Bytes de valor por slot (sin NUL). */
+
+/** @brief Tipo del valor de un slot. */
+typedef enum {
+    KV_TYPE_EMPTY    = 0, /**< Slot libre (corta el sondeo). */
+    KV_TYPE_STRING   = 1, /**< Cadena cruda (se devuelve sin comillas). */
+    KV_TYPE_JSON     = 2, /**< Texto JSON (número, bool, objeto, lista, null). */
+    KV_TYPE_SNAPSHOT = 3  /**< El valor no cabe: vive solo en el snapshot. */
+} kv_type_t;
+
+/**
+ * @brief Slot del segmento (@ref KV_SLOT_SIZE bytes).
+ */
+typedef struct {
+    atomic_uint seq;            /**< Seqlock: impar mientras un escritor lo actualiza. */
+    uint8_t  type;              /**< @ref kv_type_t. */
+    uint8_t  reserved;          /**< Cero. */
+    uint16_t len;               /**< Bytes de @ref value. */
+    char key[KV_KEY_MAX];       /**< Clave terminada en NUL. */
+    char value[KV_VALUE_MAX];   /**< Valor (sin NUL). */
+} kv_slot_t;
+
+/**
+ * @brief Layout del segmento.
+ */
+typedef struct {
+    uint32_t magic;             /**< @ref KV_MAGIC (se escribe al final de la inicialización). */
+    uint32_t version;           /**< @ref KV_VERSION. */
+    uint32_t n_slots;           /**< @ref KV_SLOTS. */
+    uint32_t slot_size;         /**< @ref KV_SLOT_SIZE. */
+    uint8_t  reserved[48];      /**< Relleno hasta 64 bytes. */
+    kv_slot_t slots[KV_SLOTS];  /**< Tabla hash. */
+} kv_shm_t;
+
+_Static_assert(sizeof(kv_slot_t) == KV_SLOT_SIZE, "kv_slot_t debe medir KV_SLOT_SIZE");
+_Static_assert(sizeof(kv_shm_t) == 64 + KV_SLOTS * KV_SLOT_SIZE, "kv_shm_t: cabecera de 64 bytes");
+
+/**
+ * @brief Segmento mapeado por un proceso.
+ */
+typedef struct {
+    kv_shm_t *shm; /**< Segmento. */
+    int fd;        /**< Descriptor del segmento (lock de escritores). */
+} kv_store_t;
+
+/**
+ * @brief Mapea el segmento, creándolo e importando el snapshot si no existe.
+ * @param[out] kv Handle.
+ * @return 0 en éxito, -1 si no se pudo abrir o mapear.
+ */
+int kv_open(kv_store_t *kv);
+
+/**
+ * @brief Agrega o actualiza una clave y reescribe el snapshot.
+ * @details Si @p value_text es JSON válido se guarda tipado; si no, como cadena. Escribir el
+ * mismo valor que ya tiene la clave no toca el segmento ni el snapshot.
+ * @param kv Handle.
+ * @param key Clave (menos de @ref KV_KEY_MAX bytes).
+ * @param value_text Valor como texto (NULL = `null`).
+ * @return 0 en éxito, -1 si la clave es inválida, la tabla está llena o falló el lock.
+ */
+int kv_set(kv_store_t *kv, const char *key, const char *value_text);
+
+/**
+ * @brief Consulta una clave sin locks.
+ * @param kv Handle.
+ * @param key Clave.
+ * @return Cadena cruda (valores string) o texto JSON; liberar con free(). NULL si no existe.
+ */
+char *kv_get(kv_store_t *kv, const char *key);
+
+/**
+ * @brief Vacía el segmento y deja el snapshot como `{}`.
+ * @param kv Handle.
+ * @return 0 en éxito, -1 si falló el lock.
+ */
+int kv_clear(kv_store_t *kv);
+
+/**
+ * @brief Desmapea el segmento (no lo borra).
+ * @param kv Handle.
+ */
+void kv_close(kv_store_t *kv);
+
+/** @} */
+
+#endif // KV_STORE_H
@@ -121,13 +121,22 @@ def format_data_for_upload(payload, log: logging.Logger) -> dict:
         dict: Diccionario formateado listo para ser serializado como JSON.
     """
     post_dict = {
-        "Pxx": payload.get("Pxx", []),
         "start_freq_hz": int(payload.get("start_freq_hz", 0)),
         "end_freq_hz": int(payload.get("end_freq_hz", 0)),
         "timestamp": cfg.get_time_ms(),
         "mac": cfg.get_mac()
     }
 
+    # Con "detect": {"only": true} el motor responde solo el resumen, sin Pxx
+    if "Pxx" in payload or "detect" not in payload:
+        post_dict["Pxx"] = payload.get("Pxx", [])
+    if "detect" in payload:
+        post_dict["detect"] = payload["detect"]
+    if "spectrogram" in payload:
+        post_dict["spectrogram"] = payload["spectrogram"]
+    if "capture" in payload:
+        post_dict["capture"] = payload["capture"]
+
     if payload.get("excursion_hz", 0) != 0:
         post_dict.update({"excursion_hz": int(payload.get("excursion_hz"))})
 
@@ -211,6 +220,7 @@ class CronSchedulerCampaign:
             "antenna_amp": camp.get('antenna_amp'),
             "filter": camp.get('filter'),
             "cooldown_request": float(camp.get('cooldown_request', 1.0)),
+            "target_averages": camp.get('target_averages'),
             "method_psd": "pfb"
         }
         store.update_from_dict(dict_persist_params)
@@ -299,6 +309,9 @@ class AcquireDual:
         if not isinstance(acquisition_result, dict):
             raise TypeError("Se esperaba que _single_acquire devolviera un dict.")
         
+        if "Pxx" not in acquisition_result and "detect" in acquisition_result:
+            return acquisition_result  # respuesta solo de detección: no hay bins que corregir
+
         if "Pxx" not in acquisition_result:
             raise KeyError("No se encontró la llave 'Pxx' en acquisition_result.")
         
@@ -498,6 +511,8 @@ class AcquireDual:
             rf_params["cooldown_request"] = 1.0
         else:
             rf_params["cooldown_request"] = float(rf_params["cooldown_request"])
+        if cfg.RF_METRICS:
+            rf_params["metrics"] = True
         self._log.debug(f"Acquiring CF: {rf_params['center_freq_hz']/1e6} MHz")
         try:
             data = await self.controller.request(rf_params)
@@ -512,6 +527,17 @@ class AcquireDual:
             self.last_error_reason = data.get("reason", "unknown")
             self._log.warning(f"Acquisition error from RF engine: {self.last_error_reason}")
             return None
+        metrics = data.pop("metrics", None)
+        if metrics:
+            self._log.info(
+                "[RF_METRICS] total=%.1f ms wait=%.1f load=%.1f comp=%.1f filter=%.1f psd=%.1f "
+                "json=%.1f | %.2f MS/s | dropped=%d B",
+                metrics.get("total_ms", 0.0), metrics.get("acq_wait_ms", 0.0),
+                metrics.get("iq_load_ms", 0.0), metrics.get("iq_comp_ms", 0.0),
+                metrics.get("filter_ms", 0.0), metrics.get("psd_ms", 0.0),
+                metrics.get("serialize_ms", 0.0), metrics.get("msps", 0.0),
+                int(metrics.get("rb_dropped_bytes", 0)),
+            )
         # PLL/Hardware settle time
         await asyncio.sleep(0.05) 
         return data
@@ -533,6 +559,9 @@ class AcquireDual:
         data1 = await self._single_acquire(rf_params)
         if data1 is None:
             return None
+        filt = rf_params.get("filter") if isinstance(rf_params, dict) else None
+        if isinstance(filt, dict) and filt.get("zoom"):
+            return data1  # zoom: el centro del span es la banda del filtro, no el DC del HackRF
         try:
             data1 = self._apply_dc_correction_to_acquisition(data1)
             return data1
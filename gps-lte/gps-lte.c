@@ -8,6 +8,12 @@
  * de la telemetría GPS hacia una API REST externa. Además, incluye lógica de redundancia para 
  * verificar la conectividad mediante ICMP (ping) y reiniciar la interfaz en caso de fallos críticos.
  *
+ * Tras el arranque todo corre en un único hilo sobre @ref reactor_module: la UART del GPS,
+ * un `timerfd` para la cadencia de envío, netlink para el estado de ppp0 y una sonda ICMP
+ * propia. Los POST de posición van por curl multi con sus sockets y su plazo en el mismo
+ * reactor, así que un enlace LTE lento nunca deja de drenar la UART. El proceso duerme en
+ * `epoll_wait` entre eventos y solo lanza procesos para `pon`/`poff`.
+ *
  * @author GCPDS
  * @date 2026
  */
@@ -25,10 +31,14 @@
 #include <string.h>
 #include <ctype.h>
 
+#include <sys/epoll.h>
+
 #include "utils.h"       
 #include "bacn_LTE.h"
 #include "bacn_GPS.h"
 #include "bacn_gpio.h"
+#include "reactor.h"
+#include "net_monitor.h"
 
 void run_cmd(const char *cmd);
 int get_ppp_ip(char *ip);
@@ -159,6 +169,18 @@ static bool has_nonzero_coordinate_rounded(const char *coord_str) {
 #define IP_BUF 64    /**< Tamaño del buffer para almacenar direcciones IPv4. */
 /** @} */
 
+/** * @name Cadencia del Reactor
+ * @{ 
+ */
+#define GPS_POST_PERIOD_MS  10000 /**< Período del envío de posición y de la prueba de conectividad. */
+#define PING_TIMEOUT_MS     1000  /**< Espera del echo ICMP (equivale a `ping -W 1`). */
+#define PING_MAX_FAILS      6     /**< Pruebas fallidas seguidas antes de reiniciar PPP. */
+#define PPP_DIAL_WAIT_MS    15000 /**< Espera de una IP en ppp0 tras `pon`. */
+#define PPP_OFF_WAIT_MS     5000  /**< Pausa entre `poff` y el siguiente `pon`. */
+#define PPP_DOWN_WAIT_MS    15000 /**< Pausa tras `poff` cuando la red cayó por completo. */
+#define PPP_DIAL_ATTEMPTS   2     /**< Marcados por ciclo de conexión. */
+/** @} */
+
 /** * @name Manejadores de Hardware y UART
  * @{ 
  */
@@ -175,62 +197,262 @@ GPSCommand GPSInfo;
 
 bool LTE_open = false; /**< Indica si el puerto serie LTE está abierto. */
 bool GPS_open = false; /**< Indica si el puerto serie GPS está abierto. */
-bool GPSRDY  = false;  /**< Bandera de sincronización para nueva trama GPS. */
-pthread_mutex_t gps_ready_mutex = PTHREAD_MUTEX_INITIALIZER;
-pthread_cond_t gps_ready_cond = PTHREAD_COND_INITIALIZER;
 /** @} */
 
-static bool gps_wait_for_ready(int timeout_ms) {
-    struct timespec deadline;
-    clock_gettime(CLOCK_REALTIME, &deadline);
-    deadline.tv_sec += timeout_ms / 1000;
-    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
-    if (deadline.tv_nsec >= 1000000000L) {
-        deadline.tv_sec += 1;
-        deadline.tv_nsec -= 1000000000L;
-    }
-
-    pthread_mutex_lock(&gps_ready_mutex);
-    while (!GPSRDY) {
-        int rc = pthread_cond_timedwait(&gps_ready_cond, &gps_ready_mutex, &deadline);
-        if (rc == ETIMEDOUT) {
-            pthread_mutex_unlock(&gps_ready_mutex);
-            return false;
-        }
-    }
-    GPSRDY = false;
-    pthread_mutex_unlock(&gps_ready_mutex);
-    return true;
+/**
+ * @brief Estado de la interfaz PPP.
+ */
+typedef enum {
+    PPP_DOWN,        /**< Sin conexión ni marcado en curso (la prueba ICMP la reintenta). */
+    PPP_DIALING,     /**< `pon` enviado, esperando IP en ppp0. */
+    PPP_RESTARTING,  /**< `poff` enviado, esperando para volver a marcar. */
+    PPP_UP           /**< ppp0 tiene IPv4. */
+} ppp_state_t;
+
+/**
+ * @brief Contexto del reactor principal.
+ */
+typedef struct {
+    reactor_t reactor;       /**< Bucle de eventos. */
+    gp_uart *gps;            /**< UART del GPS. */
+    char *api_url;           /**< URL de la API (NULL = sin envíos). */
+    const char *ping_ip;     /**< Destino de la prueba de conectividad. */
+    icmp_probe_t probe;      /**< Sonda ICMP (fd -1 = se usa `ping`). */
+    int probe_tfd;           /**< Timeout del echo en curso. */
+    int ppp_tfd;             /**< Plazo del estado PPP en curso. */
+    ppp_state_t ppp;         /**< Estado de ppp0. */
+    int dial_attempts;       /**< Marcados del ciclo de conexión actual. */
+    int gps_frames;          /**< Tramas parseadas desde el último envío. */
+    int ping_fails;          /**< Pruebas fallidas seguidas. */
+    bool fix_ok;             /**< Las coordenadas del último fix encolado son válidas. */
+    double fix_lat;          /**< Latitud decimal del último fix encolado. */
+    double fix_lng;          /**< Longitud decimal del último fix encolado. */
+} gps_lte_ctx_t;
+
+/**
+ * @brief Envía `pon` y espera la IP de ppp0 (la confirma netlink o el plazo).
+ */
+static void ppp_dial(gps_lte_ctx_t *ctx)
+{
+    run_cmd("sudo pon rnet");
+    ctx->ppp = PPP_DIALING;
+    ctx->dial_attempts++;
+    reactor_timer_arm(ctx->ppp_tfd, PPP_DIAL_WAIT_MS, 0);
 }
 
 /**
- * @brief Gestiona la conexión a la red de datos mediante el demonio PPP.
- * @details Ejecuta el script de marcado 'rnet'. Si la asignación de IP falla, intenta 
- * reiniciar la interfaz una vez tras un tiempo de espera. Utiliza @ref get_ppp_ip para 
- * validar el éxito de la operación.
+ * @brief Envía `poff` y vuelve a marcar tras @p wait_ms.
  */
-void connection_LTE(void)
+static void ppp_restart(gps_lte_ctx_t *ctx, uint32_t wait_ms)
+{
+    run_cmd("sudo poff rnet");
+    ctx->ppp = PPP_RESTARTING;
+    reactor_timer_arm(ctx->ppp_tfd, wait_ms, 0);
+}
+
+/**
+ * @brief Reevalúa ppp0 tras un evento netlink o el vencimiento de un plazo.
+ */
+static void ppp_check(gps_lte_ctx_t *ctx)
 {
     char ip[IP_BUF];
+    const bool has_ip = get_ppp_ip(ip);
 
-    // 2. Network / Internet Setup    
-    run_cmd("sudo pon rnet");
-    sleep(15);
-    
-    if(!get_ppp_ip(ip)) {
+    if (has_ip && ctx->ppp != PPP_UP && ctx->ppp != PPP_RESTARTING) {
+        printf("PPP connected. IP = %s\n", ip);
+        ctx->ppp = PPP_UP;
+        ctx->dial_attempts = 0;
+        reactor_timer_arm(ctx->ppp_tfd, 0, 0);
+    } else if (!has_ip && ctx->ppp == PPP_UP) {
+        printf("ppp0 lost its IP address. Restarting PPP...\n");
+        ctx->dial_attempts = 0;
+        ppp_restart(ctx, PPP_OFF_WAIT_MS);
+    }
+}
+
+static void on_ppp_timer(int fd, uint32_t events, void *arg)
+{
+    (void)fd; (void)events;
+    gps_lte_ctx_t *ctx = (gps_lte_ctx_t *)arg;
+
+    if (ctx->ppp == PPP_RESTARTING) {
+        ppp_dial(ctx);
+        return;
+    }
+    if (ctx->ppp != PPP_DIALING) return;
+
+    ppp_check(ctx);
+    if (ctx->ppp == PPP_UP) return;
+    if (ctx->dial_attempts < PPP_DIAL_ATTEMPTS) {
         printf("No IP address assigned! Restarting PPP...\n");
-        run_cmd("sudo poff rnet");
-        sleep(5);
-        run_cmd("sudo pon rnet");
-        sleep(15);
+        ppp_restart(ctx, PPP_OFF_WAIT_MS);
+    } else {
+        printf("PPP failed again. No IP assigned.\n");
+        ctx->ppp = PPP_DOWN;
+        ctx->dial_attempts = 0;
+    }
+}
 
-        if(!get_ppp_ip(ip)) {
-            printf("PPP failed again. No IP assigned.\n");
-        }
+static void on_netlink(int fd, uint32_t events, void *arg)
+{
+    (void)events;
+    if (net_link_monitor_drain(fd)) ppp_check((gps_lte_ctx_t *)arg);
+}
+
+static void on_gps_readable(int fd, uint32_t events, void *arg)
+{
+    gps_lte_ctx_t *ctx = (gps_lte_ctx_t *)arg;
+    const int n = GPS_HandleReadable(ctx->gps);
+    if (n < 0 || (events & (EPOLLERR | EPOLLHUP))) {
+        // systemd restarts the service and reopens the port
+        fprintf(stderr, "ERROR: GPS UART closed\n");
+        reactor_del(&ctx->reactor, fd);
+        ctx->reactor.stop = true;
+        return;
     }
-    if(strlen(ip) > 0) {
-        printf("PPP connected. IP = %s\n", ip);
+    ctx->gps_frames += n;
+}
+
+/**
+ * @brief Encola la última posición para la API; la histéresis espera a @ref on_fix_sent.
+ */
+static void post_position(gps_lte_ctx_t *ctx)
+{
+    printf("Latitude: %s, Longitude: %s, Altitude: %s\n", GPSInfo.Latitude, GPSInfo.Longitude, GPSInfo.Altitude);
+    // --- A. SEND DATA ---
+    int status = -1;
+    if (GPSInfo.Latitude != NULL &&
+        GPSInfo.Longitude != NULL &&
+        has_nonzero_coordinate_rounded(GPSInfo.Latitude) &&
+        has_nonzero_coordinate_rounded(GPSInfo.Longitude)) {
+        status = post_gps_data(ctx->api_url, GPSInfo.Altitude, GPSInfo.Latitude, GPSInfo.Longitude);
+    } else {
+        fprintf(stderr, "Skipping GPS POST: invalid/null coordinates\n");
+    }
+
+    if (status != GPS_POST_QUEUED) {
+        fprintf(stderr, "Failed gps POST with error code: %d\n", status);
+        return;
+    }
+    printf("GPS fix queued for %s\n", ctx->api_url);
+
+    // Coordinates of this fix: the hysteresis applies them once it is actually delivered
+    ctx->fix_ok = gps_to_decimal(GPSInfo.Latitude, GPSInfo.LatDir, false, &ctx->fix_lat) &&
+                  gps_to_decimal(GPSInfo.Longitude, GPSInfo.LonDir, true, &ctx->fix_lng);
+}
+
+/**
+ * @brief Entrega confirmada del último fix encolado: actualiza la histéresis en memoria compartida.
+ */
+static void on_fix_sent(void *arg)
+{
+    gps_lte_ctx_t *ctx = (gps_lte_ctx_t *)arg;
+    printf("Success: Data posted to %s\n", ctx->api_url);
+
+    // --- HISTÉRESIS (200 m) usando last_lat/last_lng ---
+    if (!ctx->fix_ok) {
+        fprintf(stderr, "Skipping shared-memory GPS update: invalid current coordinates\n");
+        shm_add_to_persistent_gps("changed_gps", "false");
+        return;
+    }
+    const double cur_lat = ctx->fix_lat;
+    const double cur_lng = ctx->fix_lng;
+
+    char *last_lat_str = shm_consult_persistent_gps("last_lat");
+    char *last_lng_str = shm_consult_persistent_gps("last_lng");
+
+    double last_lat = 0.0;
+    double last_lng = 0.0;
+    bool has_last = parse_double_strict(last_lat_str, &last_lat) &&
+                    parse_double_strict(last_lng_str, &last_lng);
+
+    bool should_update = true;
+    if (has_last) {
+        double distance_m = haversine_m(last_lat, last_lng, cur_lat, cur_lng);
+        should_update = (distance_m > 200.0);
+        printf("GPS hysteresis distance: %.2f m (threshold: 200.00 m)\n", distance_m);
+    }
+
+    if (should_update) {
+        char lat_text[32];
+        char lng_text[32];
+        snprintf(lat_text, sizeof(lat_text), "%.7f", cur_lat);
+        snprintf(lng_text, sizeof(lng_text), "%.7f", cur_lng);
+
+        shm_add_to_persistent_gps("last_lat", lat_text);
+        shm_add_to_persistent_gps("last_lng", lng_text);
+        
+        shm_add_to_persistent_gps("changed_gps", "true");
+    } else {
+        shm_add_to_persistent_gps("changed_gps", "false");
+    }
+
+    free(last_lat_str); // free(NULL) es seguro en C
+    free(last_lng_str);
+}
+
+/**
+ * @brief Cuenta el resultado de una prueba de conectividad y reinicia PPP si la red no vuelve.
+ */
+static void ping_result(gps_lte_ctx_t *ctx, bool ok)
+{
+    if (ok) {
+        printf("Ping to %s successful.\n", ctx->ping_ip);
+        ctx->ping_fails = 0;
+        return;
+    }
+
+    printf("Ping to %s failed. Retry count: %d\n", ctx->ping_ip, ctx->ping_fails + 1);
+    ctx->ping_fails++;
+    if (ctx->ping_fails >= PING_MAX_FAILS) {
+        ctx->ping_fails = 0;
+        printf("CRITICAL: Network down for too long. Rebooting...\n");
+        ctx->dial_attempts = 0;
+        ppp_restart(ctx, PPP_DOWN_WAIT_MS);
+    }
+}
+
+static void on_probe_readable(int fd, uint32_t events, void *arg)
+{
+    (void)fd; (void)events;
+    gps_lte_ctx_t *ctx = (gps_lte_ctx_t *)arg;
+    if (icmp_probe_handle(&ctx->probe)) {
+        reactor_timer_arm(ctx->probe_tfd, 0, 0);
+        ping_result(ctx, true);
+    }
+}
+
+static void on_probe_timer(int fd, uint32_t events, void *arg)
+{
+    (void)fd; (void)events;
+    gps_lte_ctx_t *ctx = (gps_lte_ctx_t *)arg;
+    if (!ctx->probe.pending) return;
+    ctx->probe.pending = false;
+    ping_result(ctx, false);
+}
+
+static void on_post_timer(int fd, uint32_t events, void *arg)
+{
+    (void)fd; (void)events;
+    gps_lte_ctx_t *ctx = (gps_lte_ctx_t *)arg;
+
+    if (ctx->gps_frames > 0) {
+        ctx->gps_frames = 0;
+        post_position(ctx);
+    }
+
+    // --- B. CHECK CONNECTIVITY --- (not while pppd is being cycled)
+    if (ctx->ppp == PPP_DIALING || ctx->ppp == PPP_RESTARTING) return;
+    if (ctx->probe.fd >= 0) {
+        if (icmp_probe_send(&ctx->probe) == 0) reactor_timer_arm(ctx->probe_tfd, PING_TIMEOUT_MS, 0);
+        else ping_result(ctx, false);
+        return;
     }
+
+    // No ICMP socket allowed for this user: fall back to the ping binary
+    char ping_cmd[100];
+    snprintf(ping_cmd, sizeof(ping_cmd), "ping -c 1 -W 1 %s > /dev/null", ctx->ping_ip);
+    ping_result(ctx, system(ping_cmd) == 0);
 }
 
 /**
@@ -248,23 +470,7 @@ void run_cmd(const char *cmd) {
  * @return 1 si se obtuvo con éxito, 0 en caso contrario.
  */
 int get_wlan_ip(char *ip) {
-    FILE *fp;
-    char cmd[] = "ip -o -4 addr show wlan0 | awk '{print $4}' | cut -d/ -f1";
-    char buffer[IP_BUF] = {0};
-
-    fp = popen(cmd, "r");
-    if (!fp) return 0;
-
-    if (fgets(buffer, sizeof(buffer), fp) != NULL) {
-        buffer[strcspn(buffer, "\n")] = 0;
-        if (strlen(buffer) > 0) {
-            strcpy(ip, buffer);
-            pclose(fp);
-            return 1;
-        }
-    }
-    pclose(fp);
-    return 0;
+    return net_iface_ipv4("wlan0", ip, IP_BUF);
 }
 
 /**
@@ -273,23 +479,7 @@ int get_wlan_ip(char *ip) {
  * @return 1 si se obtuvo con éxito, 0 en caso contrario.
  */
 int get_eth_ip(char *ip) {
-    FILE *fp;
-    char cmd[] = "ip -o -4 addr show eth0 | awk '{print $4}' | cut -d/ -f1";
-    char buffer[IP_BUF] = {0};
-
-    fp = popen(cmd, "r");
-    if (!fp) return 0;
-
-    if (fgets(buffer, sizeof(buffer), fp) != NULL) {
-        buffer[strcspn(buffer, "\n")] = 0;
-        if (strlen(buffer) > 0) {
-            strcpy(ip, buffer);
-            pclose(fp);
-            return 1;
-        }
-    }
-    pclose(fp);
-    return 0;
+    return net_iface_ipv4("eth0", ip, IP_BUF);
 }
 
 /**
@@ -298,23 +488,7 @@ int get_eth_ip(char *ip) {
  * @return 1 si se obtuvo con éxito, 0 en caso contrario.
  */
 int get_ppp_ip(char *ip) {
-    FILE *fp;
-    char cmd[] = "ip -o -4 addr show ppp0 | awk '{print $4}' | cut -d/ -f1";
-    char buffer[IP_BUF] = {0};
-
-    fp = popen(cmd, "r");
-    if (!fp) return 0;
-
-    if (fgets(buffer, sizeof(buffer), fp) != NULL) {
-        buffer[strcspn(buffer, "\n")] = 0;
-        if (strlen(buffer) > 0) {
-            strcpy(ip, buffer);
-            pclose(fp);
-            return 1;
-        }
-    }
-    pclose(fp);
-    return 0;
+    return net_iface_ipv4("ppp0", ip, IP_BUF);
 }
 
 /** @} */
@@ -323,26 +497,25 @@ int get_ppp_ip(char *ip) {
  * @brief Punto de entrada principal para el servicio de geolocalización.
  * @details El flujo de ejecución es el siguiente:
  * 1. **Inicialización**: Verifica el estado del módulo LTE, activa la alimentación si es necesario e inicializa las UARTs.
- * 2. **Conexión**: Levanta la interfaz PPP mediante @ref connection_LTE.
- * 3. **Bucle de Telemetría**:
- * - Espera a que la bandera @ref GPSRDY sea verdadera.
- * - Cada 10 actualizaciones de GPS, envía Latitud, Longitud y Altitud a la API mediante un HTTP POST.
- * - Realiza una prueba de conectividad (ping) a una IP de referencia.
- * - Si el ping falla repetidamente (6 intentos), reinicia la conexión PPP para intentar recuperar el servicio.
+ * 2. **Conexión**: Lanza `pon` y deja que netlink confirme la IP de ppp0 (reintenta con `poff`/`pon` si no llega).
+ * 3. **Reactor**:
+ * - Cada trama de la UART del GPS se parsea al llegar.
+ * - Cada 10 s (timerfd), si hubo tramas nuevas, encola Latitud, Longitud y Altitud para un HTTP POST a la API
+ *   (curl multi sobre el mismo reactor, sin bloquear la lectura de la UART).
+ * - En el mismo tick envía un echo ICMP a una IP de referencia.
+ * - Si la prueba falla repetidamente (6 intentos), o ppp0 pierde su IP, reinicia la conexión PPP.
  * * @return 0 en terminación normal, -1 en caso de error de apertura de hardware.
  */
 int main(void)
 {
-    char *api_url = getenv_c_gps("API_URL"); 
-    const char *ip_address = "10.10.1.254";
-    char ping_cmd[100];
-    int count = 0;
-    int tryRB = 0;
-    int status = 0;
-    int ping_result = 0;
+    static gps_lte_ctx_t ctx;
     int lte_start_attempts = 0;
     const int lte_start_max_attempts = 8;
 
+    ctx.api_url = getenv_c_gps("API_URL");
+    ctx.ping_ip = "10.10.1.254";
+    ctx.gps = &GPS;
+
     system("clear");
     system("sudo poff rnet");
 
@@ -384,112 +557,46 @@ int main(void)
 
     close_usart(&LTE);
 
-    // 2. Network / Internet Setup    
-    connection_LTE();
+    // 2. Event sources
+    if (reactor_init(&ctx.reactor) != 0 ||
+        reactor_add(&ctx.reactor, GPS.serial_fd, EPOLLIN, on_gps_readable, &ctx) != 0 ||
+        reactor_add_timer(&ctx.reactor, GPS_POST_PERIOD_MS, on_post_timer, &ctx) < 0 ||
+        (ctx.ppp_tfd = reactor_add_timer(&ctx.reactor, 0, on_ppp_timer, &ctx)) < 0 ||
+        (ctx.probe_tfd = reactor_add_timer(&ctx.reactor, 0, on_probe_timer, &ctx)) < 0 ||
+        gps_uploader_init(&ctx.reactor, on_fix_sent, &ctx) != 0) {
+        perror("ERROR: reactor setup failed");
+        close_usart1(&GPS);
+        return -1;
+    }
 
-    // 3. Environment Setup    
-    if (api_url == NULL) {
+    const int nl_fd = net_link_monitor_open();
+    if (nl_fd < 0 || reactor_add(&ctx.reactor, nl_fd, EPOLLIN, on_netlink, &ctx) != 0) {
+        fprintf(stderr, "WARN: netlink unavailable; ppp0 is only checked on dial timeouts\n");
+    }
+
+    if (icmp_probe_open(&ctx.probe, ctx.ping_ip) != 0 ||
+        reactor_add(&ctx.reactor, ctx.probe.fd, EPOLLIN, on_probe_readable, &ctx) != 0) {
+        fprintf(stderr, "WARN: no ICMP socket (check net.ipv4.ping_group_range); using ping\n");
+        icmp_probe_close(&ctx.probe);
+    }
+
+    // 3. Network / Internet Setup (completes inside the reactor)
+    ppp_dial(&ctx);
+
+    // 4. Environment Setup    
+    if (ctx.api_url == NULL) {
         printf("WARN: API_URL not set. Data sending will be skipped.\n");
     } else {
-        printf("API URL found: %s\n", api_url);
+        printf("API URL found: %s\n", ctx.api_url);
     }
 
-    // 4. Main Loop Variables    
-    snprintf(ping_cmd, sizeof(ping_cmd), "ping -c 1 -W 1 %s", ip_address);
-    
-    while (1)
-    {
-        if (gps_wait_for_ready(1000)) {
-            count++;
-
-            // Trigger every 10 GPS updates
-            if(count >= 10) { 
-                count = 0; // Reset counter
-		        printf("Latitude: %s, Longitude: %s, Altitude: %s\n", GPSInfo.Latitude, GPSInfo.Longitude, GPSInfo.Altitude);
-                // --- A. SEND DATA ---
-                status = -1;
-                if (GPSInfo.Latitude != NULL &&
-                    GPSInfo.Longitude != NULL &&
-                    has_nonzero_coordinate_rounded(GPSInfo.Latitude) &&
-                    has_nonzero_coordinate_rounded(GPSInfo.Longitude)) {
-                    status = post_gps_data(api_url, GPSInfo.Altitude, GPSInfo.Latitude, GPSInfo.Longitude);
-                } else {
-                    fprintf(stderr, "Skipping GPS POST: invalid/null coordinates\n");
-                }
-
-                if (status == 0) {
-                    printf("Success: Data posted to %s\n", api_url);
-
-                    // --- HISTÉRESIS (200 m) usando last_lat/last_lng ---
-                    double cur_lat = 0.0;
-                    double cur_lng = 0.0;
-                    bool cur_ok = gps_to_decimal(GPSInfo.Latitude, GPSInfo.LatDir, false, &cur_lat) &&
-                                  gps_to_decimal(GPSInfo.Longitude, GPSInfo.LonDir, true, &cur_lng);
-
-                    if (!cur_ok) {
-                        fprintf(stderr, "Skipping shared-memory GPS update: invalid current coordinates\n");
-                        shm_add_to_persistent_gps("changed_gps", "false");
-                    } else {
-                        char *last_lat_str = shm_consult_persistent_gps("last_lat");
-                        char *last_lng_str = shm_consult_persistent_gps("last_lng");
-
-                        double last_lat = 0.0;
-                        double last_lng = 0.0;
-                        bool has_last = parse_double_strict(last_lat_str, &last_lat) &&
-                                        parse_double_strict(last_lng_str, &last_lng);
-
-                        bool should_update = true;
-                        if (has_last) {
-                            double distance_m = haversine_m(last_lat, last_lng, cur_lat, cur_lng);
-                            should_update = (distance_m > 200.0);
-                            printf("GPS hysteresis distance: %.2f m (threshold: 200.00 m)\n", distance_m);
-                        }
-
-                        if (should_update) {
-                            char lat_text[32];
-                            char lng_text[32];
-                            snprintf(lat_text, sizeof(lat_text), "%.7f", cur_lat);
-                            snprintf(lng_text, sizeof(lng_text), "%.7f", cur_lng);
-
-                            shm_add_to_persistent_gps("last_lat", lat_text);
-                            shm_add_to_persistent_gps("last_lng", lng_text);
-                            
-                            shm_add_to_persistent_gps("changed_gps", "true");
-                        } else {
-                            shm_add_to_persistent_gps("changed_gps", "false");
-                        }
-
-                        free(last_lat_str); // free(NULL) es seguro en C
-                        free(last_lng_str);
-                    }
-                } else {
-                    fprintf(stderr, "Failed gps POST with error code: %d\n", status);
-                }
-
-                // --- B. CHECK CONNECTIVITY ---
-                // We run the ping command HERE to get the current status
-                ping_result = system(ping_cmd); 
-
-                if (ping_result == 0) {
-                    // Success (0 return code)
-                    printf("Ping to %s successful.\n", ip_address);
-                    tryRB = 0;
-                } else {
-                    // Failure
-                    printf("Ping to %s failed. Retry count: %d\n", ip_address, tryRB + 1);
-                    tryRB++;
-                    
-                    if(tryRB >= 6) {
-                        tryRB = 0;
-                        printf("CRITICAL: Network down for too long. Rebooting...\n");
-                        system("sudo poff rnet");
-                        sleep(15);
-                        connection_LTE();
-                    }
-                }
-            } 
-        }
-    }    
+    const int rc = reactor_run(&ctx.reactor);
 
-    return 0;
+    gps_uploader_cleanup();
+    icmp_probe_close(&ctx.probe);
+    if (nl_fd >= 0) close(nl_fd);
+    reactor_close(&ctx.reactor);
+    close_usart1(&GPS);
+    free(ctx.api_url);
+    return (rc == 0 && GPS_open) ? 0 : -1;
 }
@@ -1,9 +1,12 @@
 /**
  * @file bacn_GPS.c
- * @brief Implementación del manejador de datos GPS e hilo de recepción.
+ * @brief Implementación del manejador de datos GPS y de su lectura no bloqueante.
  */
 
 #include "bacn_GPS.h"
+#include "gps_time_shm.h"
+
+#include <errno.h>
 
 /**
  * @addtogroup bacn_gps_module
@@ -17,13 +20,54 @@ const char NMEA_DELIMITERS[3] = "$,";
 
 /** @cond DOXYGEN_SHOULD_SKIP_THIS */
 extern GPSCommand GPSInfo;
-extern bool GPSRDY;
 extern bool GPS_open;
-extern pthread_mutex_t gps_ready_mutex;
-extern pthread_cond_t gps_ready_cond;
 /** @endcond */
 
-bool GPS_run = false;
+/** @brief Segmento de hora GPS para rf_app (se crea con el primer fix). */
+static gps_time_shm_t *gps_time_shm = NULL;
+
+/**
+ * @brief Convierte la hora GGA `hhmmss.ss` a UTC completa (ns desde 1970).
+ * @details GGA no trae fecha: se toma la del reloj del sistema, eligiendo el día que deja la
+ * hora NMEA a menos de 12 h del reloj (cubre el cruce de medianoche).
+ * @return true si la hora es válida.
+ */
+static bool nmea_time_to_utc_ns(const char *hhmmss, int64_t *utc_ns)
+{
+    if (!hhmmss || strlen(hhmmss) < 6) return false;
+    for (int i = 0; i < 6; i++) {
+        if (hhmmss[i] < '0' || hhmmss[i] > '9') return false;
+    }
+    const int hh = (hhmmss[0] - '0') * 10 + (hhmmss[1] - '0');
+    const int mm = (hhmmss[2] - '0') * 10 + (hhmmss[3] - '0');
+    const double ss = strtod(hhmmss + 4, NULL);
+    if (hh > 23 || mm > 59 || ss >= 61.0) return false;
+
+    struct timespec wall;
+    clock_gettime(CLOCK_REALTIME, &wall);
+    const int64_t day = 86400LL * 1000000000LL;
+    const int64_t now_ns = (int64_t)wall.tv_sec * 1000000000LL + wall.tv_nsec;
+    int64_t t = (now_ns / day) * day + ((int64_t)hh * 3600 + mm * 60) * 1000000000LL + (int64_t)(ss * 1e9);
+    if (t - now_ns > day / 2) t -= day;
+    else if (now_ns - t > day / 2) t += day;
+    *utc_ns = t;
+    return true;
+}
+
+/**
+ * @brief Publica en @ref GPS_TIME_SHM_NAME la hora de la última trama GGA con fix.
+ * @param mono_ns `CLOCK_MONOTONIC` al terminar la lectura de la trama.
+ */
+static void publish_gps_time(int64_t mono_ns)
+{
+    if (!GPSInfo.Header || !strstr(GPSInfo.Header, "GGA") || !GPSInfo.Quality) return;
+    const int quality = atoi(GPSInfo.Quality);
+    gps_time_fix_t fix = { 0, mono_ns, quality, GPSInfo.Satelites ? atoi(GPSInfo.Satelites) : 0 };
+    if (quality <= 0 || !nmea_time_to_utc_ns(GPSInfo.UTC_Time, &fix.utc_ns)) return;
+
+    if (!gps_time_shm) gps_time_shm = gps_time_shm_open(true);
+    gps_time_shm_publish(gps_time_shm, &fix);
+}
 
 int8_t init_usart1(gp_uart *s_uart)
 {    
@@ -51,21 +95,16 @@ int8_t init_usart1(gp_uart *s_uart)
         return -1;
     }
 
-    GPS_run = true;
-
-    if (pthread_create(&s_uart->th_recv, NULL, &GPSIntHandler, (void *)(s_uart)) != 0)
-    {
-        printf("ERROR : initial thread receive serial failed\r\n");
-        return -1;
-    }
-
+    s_uart->line_len = 0;
+    GPS_open = true;
     return 0;
 }
 
 void close_usart1(gp_uart *s_uart)
 {   
-    GPS_run = false;
-    close(s_uart->serial_fd);
+    if (s_uart->serial_fd >= 0) close(s_uart->serial_fd);
+    s_uart->serial_fd = -1;
+    GPS_open = false;
 }
 
 void GPS_Track(char* GPSData)
@@ -104,52 +143,43 @@ void GPS_Track(char* GPSData)
     if (token != NULL) GPSInfo.Cheksum = token;
 }
 
-void* GPSIntHandler(void *arg)
+int GPS_HandleReadable(gp_uart *s_uart)
 {
-    gp_uart *s_uart = (gp_uart *)arg;
-    fd_set rset;
-    struct timeval tv;
-    int32_t count = 0;
-    uint8_t i = 0;
-
-
-    while(GPS_run)
-    {
-        FD_ZERO(&rset);
-        FD_SET(s_uart->serial_fd, &rset);
-        tv.tv_sec = 30;
-        tv.tv_usec = 0;
-
-        count = select(s_uart->serial_fd + 1, &rset, NULL, NULL, &tv);
-
-        if(count > 0)
-        {            
-            memset(RESPONSE_BUFFER_GPS, 0, UART_BUFFER_SIZE); 
-            //usleep(100000);           
-            s_uart->recv_buff_cnt = read(s_uart->serial_fd, &RESPONSE_BUFFER_GPS, UART_BUFFER_SIZE); 
-            if(strlen(RESPONSE_BUFFER_GPS) > 30) {
-                GPS_Track(RESPONSE_BUFFER_GPS);
-            }
-            pthread_mutex_lock(&gps_ready_mutex);
-            GPSRDY = true;
-            pthread_cond_signal(&gps_ready_cond);
-            pthread_mutex_unlock(&gps_ready_mutex);
-            //printf ("%s\n",RESPONSE_BUFFER_GPS);          
+    char chunk[UART_BUFFER_SIZE];
+    int parsed = 0;
+
+    for (;;) {
+        const ssize_t n = read(s_uart->serial_fd, chunk, sizeof(chunk));
+        if (n == 0) return -1;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return -1;
         }
-        else
-        {
-            if(s_uart->serial_fd < 0)
-            {
-                //close serial
-                GPS_run = false;
-                close(s_uart->serial_fd);                
-                printf("UART close 2\r\n");                 
+        s_uart->recv_buff_cnt = (int32_t)n;
+
+        struct timespec rx_mono;
+        clock_gettime(CLOCK_MONOTONIC, &rx_mono);
+        for (ssize_t i = 0; i < n; i++) {
+            const char c = chunk[i];
+            if (c != '\n' && c != '\r') {
+                // Overlong garbage: drop it and resync on the next line
+                if (s_uart->line_len < sizeof(s_uart->line) - 1) s_uart->line[s_uart->line_len++] = c;
+                else s_uart->line_len = 0;
+                continue;
             }
+            if (s_uart->line_len > 30) {
+                // GPSInfo points into RESPONSE_BUFFER_GPS until the next sentence
+                memcpy(RESPONSE_BUFFER_GPS, s_uart->line, s_uart->line_len);
+                RESPONSE_BUFFER_GPS[s_uart->line_len] = '\0';
+                GPS_Track(RESPONSE_BUFFER_GPS);
+                publish_gps_time((int64_t)rx_mono.tv_sec * 1000000000LL + rx_mono.tv_nsec);
+                parsed++;
+            }
+            s_uart->line_len = 0;
         }
     }
-    GPS_open = true;
-    printf("UART close\r\n"); 
-    pthread_exit(NULL);       
+    return parsed;
 }
 
 /** @} */
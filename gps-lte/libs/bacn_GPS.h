@@ -1,14 +1,14 @@
 /**
  * @file bacn_GPS.h
  * @brief Controlador para la adquisición y parseo de datos NMEA desde un receptor GPS.
- * * Este módulo gestiona la lectura asíncrona de tramas GPS y extrae información
- * relevante como latitud, longitud y altitud para su posterior envío.
+ * * Este módulo gestiona la lectura no bloqueante de tramas GPS (el descriptor lo vigila el
+ * reactor de ltegps_app) y extrae información relevante como latitud, longitud y altitud
+ * para su posterior envío.
  */
 
 #ifndef BACN_GPS_H
 #define BACN_GPS_H
 
-#include <pthread.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -16,7 +16,6 @@
 #include <fcntl.h>
 #include <termios.h>
 #include <stdint.h>
-#include <sys/select.h>
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
@@ -39,9 +38,10 @@
  */
 typedef struct
 {
-    uint32_t serial_fd;     /**< Descriptor de archivo del dispositivo serie. */
-    pthread_t th_recv;      /**< Hilo dedicado para la escucha del puerto. */
-    int32_t recv_buff_cnt;  /**< Cantidad de bytes leídos en el último evento. */
+    int serial_fd;                  /**< Descriptor de archivo del dispositivo serie (no bloqueante). */
+    int32_t recv_buff_cnt;          /**< Cantidad de bytes leídos en el último evento. */
+    char line[UART_BUFFER_SIZE];    /**< Trama NMEA en armado (hasta el fin de línea). */
+    size_t line_len;                /**< Bytes acumulados en @ref line. */
 } gp_uart;
 
 /**
@@ -71,14 +71,16 @@ typedef struct gps_command_s
 /* --- Funciones de Control --- */
 
 /**
- * @brief Inicializa el puerto serie del GPS y lanza el hilo de recepción.
+ * @brief Abre y configura el puerto serie del GPS (no bloqueante).
+ * @details El descriptor `s_uart->serial_fd` se registra después en el reactor con
+ * @ref GPS_HandleReadable.
  * @param s_uart Puntero a la estructura de control gp_uart.
  * @return 0 en éxito, -1 en caso de fallo.
  */
 int8_t init_usart1(gp_uart *s_uart);
 
 /**
- * @brief Detiene el hilo de recepción y cierra el descriptor de la UART.
+ * @brief Cierra el descriptor de la UART.
  * @param s_uart Puntero a la estructura de control.
  */
 void close_usart1(gp_uart *s_uart);
@@ -90,11 +92,14 @@ void close_usart1(gp_uart *s_uart);
 void GPS_Track(char* GPSData);
 
 /**
- * @brief Hilo de ejecución para la captura de datos del puerto serie.
- * @details Utiliza select() para monitoreo no bloqueante y dispara el parseo 
- * si la trama recibida tiene una longitud mínima válida.
+ * @brief Lee lo disponible en la UART y parsea cada trama completa.
+ * @details Llamar cuando el reactor reporta el descriptor legible. Las tramas se arman por
+ * línea; cada una con longitud mínima válida pasa por @ref GPS_Track (los punteros de
+ * GPSInfo quedan válidos hasta la próxima trama) y, si es GGA con fix, se publica su hora.
+ * @param s_uart Puntero a la estructura de control.
+ * @return Número de tramas parseadas, o -1 si el puerto se cerró o falló.
  */
-void* GPSIntHandler(void *arg);
+int GPS_HandleReadable(gp_uart *s_uart);
 
 /** @} */
 
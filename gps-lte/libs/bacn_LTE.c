@@ -5,6 +5,8 @@
 
 #include "bacn_LTE.h"
 
+#include <poll.h>
+
 /**
  * @addtogroup bacn_lte_module
  * @{
@@ -15,27 +17,54 @@ int8_t Response_Status, CRLF_COUNT = 0, Data_Count;
 volatile uint8_t OBDCount = 0, GPSCount = 0;
 
 // Variables globales para el control de flujo
-char RESPONSE_BUFFER[UART_BUFFER_SIZE]; /**< Buffer global donde el hilo deposita los datos recibidos. */
-bool LTERDY = false;                     /**< Flag que indica que hay nuevos datos listos en el buffer. */
-
-bool LTE_run = false;
+char RESPONSE_BUFFER[UART_BUFFER_SIZE]; /**< Buffer donde se deposita la última respuesta recibida. */
 
-static pthread_mutex_t lte_response_mutex = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t lte_response_cond = PTHREAD_COND_INITIALIZER;
+/** UART abierta por @ref init_usart (la lee @ref WaitForExpectedResponse). */
+static st_uart *lte_uart = NULL;
 
 /** @cond DOXYGEN_SHOULD_SKIP_THIS */
 extern bool LTE_open;
 /** @endcond */
 
-static void deadline_from_now_ms(struct timespec *ts, uint32_t timeout_ms)
+static int64_t now_ms(void)
 {
-    clock_gettime(CLOCK_REALTIME, ts);
-    ts->tv_sec += timeout_ms / 1000U;
-    ts->tv_nsec += (long)(timeout_ms % 1000U) * 1000000L;
-    if (ts->tv_nsec >= 1000000000L) {
-        ts->tv_sec += 1;
-        ts->tv_nsec -= 1000000000L;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Lee una respuesta del módem en RESPONSE_BUFFER.
+ * @details Espera el primer byte hasta @p timeout_ms y luego sigue leyendo mientras
+ * lleguen bytes con menos de @ref LTE_INTERBYTE_MS de separación.
+ * @return Bytes leídos (0 = timeout).
+ */
+static size_t lte_read_response(int fd, uint32_t timeout_ms)
+{
+    size_t used = 0;
+    const int64_t deadline = now_ms() + timeout_ms;
+    memset(RESPONSE_BUFFER, 0, sizeof(RESPONSE_BUFFER));
+
+    while (used < (size_t)(UART_BUFFER_SIZE - 1)) {
+        int wait_ms = LTE_INTERBYTE_MS;
+        if (used == 0) {
+            const int64_t left = deadline - now_ms();
+            if (left <= 0) break;
+            wait_ms = (int)left;
+        }
+
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        const int rc = poll(&pfd, 1, wait_ms);
+        if (rc < 0 && errno == EINTR) continue;
+        if (rc <= 0) break;
+
+        const ssize_t bytes = read(fd, RESPONSE_BUFFER + used, (size_t)(UART_BUFFER_SIZE - 1) - used);
+        if (bytes < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+        if (bytes <= 0) break;
+        used += (size_t)bytes;
     }
+    if (lte_uart) lte_uart->recv_buff_cnt = (int32_t)used;
+    return used;
 }
 
 static int count_crlf_sequences(const char *buffer)
@@ -57,8 +86,6 @@ static int count_crlf_sequences(const char *buffer)
 
 void Read_Response(void)
 {
-    pthread_mutex_lock(&lte_response_mutex);
-
     if (Response_Status == LTE_RESPONSE_STARTING) {
         Response_Status = LTE_RESPONSE_WAITING;
     }
@@ -76,7 +103,6 @@ void Read_Response(void)
 
     CRLF_COUNT = 0;
     TimeOut = 0;
-    pthread_mutex_unlock(&lte_response_mutex);
 }
 
 void Start_Read_Response(void)
@@ -90,33 +116,19 @@ void Start_Read_Response(void)
 
 bool WaitForExpectedResponse(const char* ExpectedResponse)
 {   
-    struct timespec deadline;
-    deadline_from_now_ms(&deadline, DEFAULT_TIMEOUT + TimeOut);
-
-    pthread_mutex_lock(&lte_response_mutex);
-    while (!LTERDY) {
-        if (!LTE_run) {
-            Response_Status = LTE_RESPONSE_ERROR;
-            pthread_mutex_unlock(&lte_response_mutex);
-            return false;
-        }
-
-        int rc = pthread_cond_timedwait(&lte_response_cond, &lte_response_mutex, &deadline);
-        if (rc == ETIMEDOUT) {
-            Response_Status = LTE_RESPONSE_TIMEOUT;
-            pthread_mutex_unlock(&lte_response_mutex);
-            return false;
-        }
+    if (!lte_uart || lte_uart->serial_fd < 0) {
+        Response_Status = LTE_RESPONSE_ERROR;
+        return false;
     }
 
-    LTERDY = false;
-    pthread_mutex_unlock(&lte_response_mutex);
+    if (lte_read_response(lte_uart->serial_fd, DEFAULT_TIMEOUT + TimeOut) == 0) {
+        Response_Status = LTE_RESPONSE_TIMEOUT;
+        return false;
+    }
     Start_Read_Response();                      /* First read response */
 
-    pthread_mutex_lock(&lte_response_mutex);
     bool matched = (Response_Status != LTE_RESPONSE_TIMEOUT) &&
                    (strstr(RESPONSE_BUFFER, ExpectedResponse) != NULL);
-    pthread_mutex_unlock(&lte_response_mutex);
 
     if (matched)
         return true;                            /* Return true for success */
@@ -126,11 +138,10 @@ bool WaitForExpectedResponse(const char* ExpectedResponse)
 
 bool SendATandExpectResponse(st_uart *s_uart, const char* ATCommand, const char* ExpectedResponse)
 {
-    pthread_mutex_lock(&lte_response_mutex);
     memset(RESPONSE_BUFFER, 0, sizeof(RESPONSE_BUFFER));
-    LTERDY = false;
     Response_Status = LTE_RESPONSE_STARTING;
-    pthread_mutex_unlock(&lte_response_mutex);
+    // Drop anything unsolicited so the answer is not mixed with stale bytes
+    tcflush(s_uart->serial_fd, TCIFLUSH);
 
     LTE_SendString(s_uart, ATCommand);            /* Send AT command to LTE */
     return WaitForExpectedResponse(ExpectedResponse);
@@ -184,91 +195,17 @@ int8_t init_usart(st_uart *s_uart)
         return -1;
     }
 
-    LTE_run = true;
-
-    if (pthread_create(&s_uart->th_recv, NULL, &LTEIntHandler, (void *)(s_uart)) != 0)
-    {
-        printf("ERROR : initial thread receive serial failed\r\n");
-        return -1;
-    }
-
+    lte_uart = s_uart;
+    LTE_open = true;
     return 0;
 }
 
 void close_usart(st_uart *s_uart)
 {   
-    pthread_mutex_lock(&lte_response_mutex);
-    LTE_run = false;
-    pthread_cond_broadcast(&lte_response_cond);
-    pthread_mutex_unlock(&lte_response_mutex);
-    close(s_uart->serial_fd);
-}
-
-void* LTEIntHandler(void *arg)
-{
-    st_uart *s_uart = (st_uart *)arg;
-    fd_set rset;
-    struct timeval tv;
-    int32_t count = 0;
-
-    while(LTE_run)
-    {
-        FD_ZERO(&rset);
-        FD_SET(s_uart->serial_fd, &rset);
-        tv.tv_sec = 30;
-        tv.tv_usec = 0;
-
-        count = select(s_uart->serial_fd + 1, &rset, NULL, NULL, &tv);
-
-        if(count > 0)
-        {
-            char local_buffer[UART_BUFFER_SIZE];
-            size_t used = 0;
-            memset(local_buffer, 0, sizeof(local_buffer));
-
-            while (LTE_run && used < (size_t)(UART_BUFFER_SIZE - 1)) {
-                ssize_t bytes = read(s_uart->serial_fd, local_buffer + used, (size_t)(UART_BUFFER_SIZE - 1) - used);
-                if (bytes > 0) {
-                    used += (size_t)bytes;
-                    s_uart->recv_buff_cnt = (int32_t)used;
-                } else {
-                    break;
-                }
-
-                FD_ZERO(&rset);
-                FD_SET(s_uart->serial_fd, &rset);
-                tv.tv_sec = 0;
-                tv.tv_usec = 200000;
-                count = select(s_uart->serial_fd + 1, &rset, NULL, NULL, &tv);
-                if (count <= 0) {
-                    break;
-                }
-            }
-
-            pthread_mutex_lock(&lte_response_mutex);
-            memset(RESPONSE_BUFFER, 0, sizeof(RESPONSE_BUFFER));
-            memcpy(RESPONSE_BUFFER, local_buffer, used);
-            if (used >= (size_t)(UART_BUFFER_SIZE - 1)) {
-                Response_Status = LTE_RESPONSE_BUFFER_FULL;
-            }
-            LTERDY = true;
-            pthread_cond_signal(&lte_response_cond);
-            pthread_mutex_unlock(&lte_response_mutex);
-        }
-        else
-        {
-            if(s_uart->serial_fd < 0)
-            {
-                //close serial
-                LTE_run = false;
-                close(s_uart->serial_fd);                
-                printf("UART close 2\r\n");                 
-            }
-        }
-    }
-    LTE_open = true;
-    printf("UART close\r\n"); 
-    pthread_exit(NULL);       
+    if (s_uart->serial_fd >= 0) close(s_uart->serial_fd);
+    s_uart->serial_fd = -1;
+    if (lte_uart == s_uart) lte_uart = NULL;
+    LTE_open = false;
 }
 
 /** @} */
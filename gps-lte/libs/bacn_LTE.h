@@ -2,13 +2,12 @@
  * @file bacn_LTE.h
  * @brief Controlador para la comunicación con módulos LTE vía comandos AT.
  * * Este módulo gestiona una interfaz serie (UART) para enviar comandos AT y
- * recibir respuestas de forma asíncrona mediante un hilo dedicado.
+ * recibir sus respuestas con `poll()` sobre el descriptor, sin hilo dedicado.
  */
 
 #ifndef BACN_LTE_H
 #define BACN_LTE_H
 
-#include <pthread.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -16,7 +15,6 @@
 #include <fcntl.h>
 #include <termios.h>
 #include <stdint.h>
-#include <sys/select.h>
 #include <errno.h>
 #include <string.h>
 #include <stdlib.h>
@@ -32,6 +30,8 @@
 #define UART_BUFFER_SIZE    120
 /** @brief Tiempo de espera por defecto para la respuesta (escalado para lógica interna). */
 #define DEFAULT_TIMEOUT     4000 
+/** @brief Silencio (ms) que da por terminada una respuesta ya empezada. */
+#define LTE_INTERBYTE_MS    200
 /** @brief Cantidad de secuencias CRLF (\r\n) esperadas para dar por terminada una respuesta estándar. */
 #define DEFAULT_CRLF_COUNT  2
 /** @brief Ruta del dispositivo serie en el sistema. */
@@ -53,8 +53,7 @@ enum LTE_RESPONSE_STATUS {
  * @brief Estructura de control para la UART del LTE.
  */
 typedef struct {
-    uint32_t serial_fd;         /**< Descriptor de archivo del puerto serie. */
-    pthread_t th_recv;          /**< Identificador del hilo de recepción asíncrona. */
+    int serial_fd;              /**< Descriptor de archivo del puerto serie. */
     int32_t recv_buff_cnt;      /**< Contador de bytes recibidos en la última lectura. */
 } st_uart;
 
@@ -69,7 +68,7 @@ void Read_Response(void);
 void Start_Read_Response(void);
 
 /**
- * @brief Espera a que el buffer contenga una cadena específica tras una recepción.
+ * @brief Lee la respuesta de la UART abierta y verifica que contenga una cadena específica.
  * @param ExpectedResponse Cadena de texto que se busca (ej. "OK", "ERROR").
  * @return true Si se encontró la respuesta esperada.
  * @return false Si hubo timeout o la respuesta no coincide.
@@ -100,24 +99,18 @@ bool LTE_Start(st_uart *s_uart);
 void LTE_SendString(st_uart *s_uart, const char *data);
 
 /**
- * @brief Configura el puerto serie e inicia el hilo de recepción.
+ * @brief Configura el puerto serie (las respuestas se leen en @ref WaitForExpectedResponse).
  * @param s_uart Puntero a la estructura donde se guardará el descriptor y el hilo.
  * @return 0 en éxito, -1 en caso de error de apertura o configuración.
  */
 int8_t init_usart(st_uart *s_uart);
 
 /**
- * @brief Finaliza el hilo de recepción y cierra el puerto serie.
+ * @brief Cierra el puerto serie.
  * @param s_uart Puntero a la configuración de la UART.
  */
 void close_usart(st_uart *s_uart);
 
-/**
- * @brief Función ejecutada por el hilo para monitorear el puerto serie.
- * @param arg Puntero a st_uart pasado como argumento de hilo.
- */
-void* LTEIntHandler(void *arg);
-
 /** @} */
 
 #endif // BACN_LTE_H
@@ -0,0 +1,161 @@
+/**
+ * @file net_monitor.c
+ * @brief Implementación de la consulta de interfaces, el monitor netlink y la sonda ICMP.
+ */
+
+#include "net_monitor.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <ifaddrs.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <netinet/ip.h>
+#include <netinet/ip_icmp.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * @addtogroup net_monitor_module
+ * @{
+ */
+
+int net_iface_ipv4(const char *ifname, char *ip, size_t len) {
+    struct ifaddrs *ifs = NULL;
+    if (!ifname || !ip || len == 0 || getifaddrs(&ifs) != 0) return 0;
+
+    int found = 0;
+    for (const struct ifaddrs *it = ifs; it && !found; it = it->ifa_next) {
+        if (!it->ifa_addr || it->ifa_addr->sa_family != AF_INET || strcmp(it->ifa_name, ifname) != 0) continue;
+        const struct sockaddr_in *sin = (const struct sockaddr_in*)it->ifa_addr;
+        found = inet_ntop(AF_INET, &sin->sin_addr, ip, (socklen_t)len) != NULL;
+    }
+    freeifaddrs(ifs);
+    return found;
+}
+
+int net_link_monitor_open(void) {
+    const int fd = socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd < 0) return -1;
+
+    struct sockaddr_nl sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.nl_family = AF_NETLINK;
+    sa.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR;
+    if (bind(fd, (struct sockaddr*)&sa, sizeof(sa)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool net_link_monitor_drain(int fd) {
+    char buf[8192] __attribute__((aligned(NLMSG_ALIGNTO)));
+    bool changed = false;
+
+    for (;;) {
+        const ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n < 0) {
+            // ENOBUFS: events were lost, so assume something changed
+            if (errno == ENOBUFS) changed = true;
+            if (errno == EINTR || errno == ENOBUFS) continue;
+            break;
+        }
+        if (n == 0) break;
+        size_t left = (size_t)n;
+        for (const struct nlmsghdr *nh = (const struct nlmsghdr*)buf; NLMSG_OK(nh, left);
+             nh = NLMSG_NEXT(nh, left)) {
+            switch (nh->nlmsg_type) {
+                case RTM_NEWLINK: case RTM_DELLINK:
+                case RTM_NEWADDR: case RTM_DELADDR:
+                    changed = true;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    return changed;
+}
+
+static uint16_t icmp_checksum(const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t*)data;
+    uint32_t sum = 0;
+    for (; len > 1; p += 2, len -= 2) sum += (uint32_t)((p[0] << 8) | p[1]);
+    if (len) sum += (uint32_t)(p[0] << 8);
+    while (sum >> 16) sum = (sum & 0xFFFFu) + (sum >> 16);
+    return htons((uint16_t)~sum);
+}
+
+int icmp_probe_open(icmp_probe_t *p, const char *ipv4) {
+    if (!p) return -1;
+    memset(p, 0, sizeof(*p));
+    p->fd = -1;
+    p->dst.sin_family = AF_INET;
+    if (!ipv4 || inet_pton(AF_INET, ipv4, &p->dst.sin_addr) != 1) return -1;
+
+    p->fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_ICMP);
+    if (p->fd < 0) {
+        p->fd = socket(AF_INET, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_ICMP);
+        p->raw = true;
+    }
+    if (p->fd < 0) return -1;
+    p->id = (uint16_t)getpid();
+    return 0;
+}
+
+int icmp_probe_send(icmp_probe_t *p) {
+    if (!p || p->fd < 0) return -1;
+    struct icmphdr h;
+    memset(&h, 0, sizeof(h));
+    h.type = ICMP_ECHO;
+    h.un.echo.id = htons(p->id);
+    h.un.echo.sequence = htons(++p->seq);
+    h.checksum = icmp_checksum(&h, sizeof(h));
+
+    p->pending = sendto(p->fd, &h, sizeof(h), 0, (const struct sockaddr*)&p->dst, sizeof(p->dst)) ==
+                 (ssize_t)sizeof(h);
+    return p->pending ? 0 : -1;
+}
+
+bool icmp_probe_handle(icmp_probe_t *p) {
+    if (!p || p->fd < 0) return false;
+    uint8_t buf[512];
+    bool got = false;
+
+    for (;;) {
+        struct sockaddr_in from;
+        socklen_t from_len = sizeof(from);
+        const ssize_t n = recvfrom(p->fd, buf, sizeof(buf), 0, (struct sockaddr*)&from, &from_len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (from.sin_addr.s_addr != p->dst.sin_addr.s_addr) continue;
+
+        size_t off = 0;
+        if (p->raw) {
+            if ((size_t)n < sizeof(struct iphdr)) continue;
+            off = (size_t)((const struct iphdr*)buf)->ihl * 4U;
+        }
+        if ((size_t)n < off + sizeof(struct icmphdr)) continue;
+        const struct icmphdr *h = (const struct icmphdr*)(buf + off);
+        if (h->type != ICMP_ECHOREPLY || ntohs(h->un.echo.sequence) != p->seq) continue;
+        // With SOCK_DGRAM the kernel rewrites the id and filters replies per socket
+        if (p->raw && ntohs(h->un.echo.id) != p->id) continue;
+        if (p->pending) got = true;
+        p->pending = false;
+    }
+    return got;
+}
+
+void icmp_probe_close(icmp_probe_t *p) {
+    if (!p) return;
+    if (p->fd >= 0) close(p->fd);
+    p->fd = -1;
+    p->pending = false;
+}
+
+/** @} */
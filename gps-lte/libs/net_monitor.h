@@ -0,0 +1,86 @@
+/**
+ * @file net_monitor.h
+ * @brief Estado de interfaces y conectividad sin procesos externos (netlink + ICMP propio).
+ *
+ * Sustituye a `ip addr | awk | cut` y a `ping -c 1`: las direcciones se consultan con
+ * `getifaddrs`, los cambios de enlace/dirección llegan por un socket netlink que el reactor
+ * vigila, y la prueba de conectividad es un echo ICMP enviado desde el propio proceso.
+ */
+
+#ifndef NET_MONITOR_H
+#define NET_MONITOR_H
+
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @defgroup net_monitor_module Net Monitor
+ * @ingroup gps_binary
+ * @brief Interfaces, netlink y sonda ICMP de ltegps_app.
+ * @{
+ */
+
+/**
+ * @brief Dirección IPv4 de una interfaz.
+ * @param ifname Nombre (ej. "ppp0").
+ * @param[out] ip Texto de la dirección.
+ * @param len Tamaño de @p ip.
+ * @return 1 si la interfaz tiene IPv4, 0 si no.
+ */
+int net_iface_ipv4(const char *ifname, char *ip, size_t len);
+
+/**
+ * @brief Abre un socket netlink suscrito a cambios de enlace y de direcciones IPv4.
+ * @return Descriptor no bloqueante, o -1 en error.
+ */
+int net_link_monitor_open(void);
+
+/**
+ * @brief Vacía los mensajes pendientes del socket netlink.
+ * @param fd Descriptor de @ref net_link_monitor_open.
+ * @return true si alguno fue un alta/baja de enlace o dirección.
+ */
+bool net_link_monitor_drain(int fd);
+
+/**
+ * @brief Sonda ICMP echo en proceso.
+ */
+typedef struct {
+    int fd;                 /**< Socket ICMP (-1 = sin sonda). */
+    bool raw;               /**< SOCK_RAW (con cabecera IP) en lugar de SOCK_DGRAM. */
+    uint16_t id;            /**< Identificador (solo SOCK_RAW; el kernel lo fija en DGRAM). */
+    uint16_t seq;           /**< Secuencia del último echo. */
+    bool pending;           /**< Hay un echo sin respuesta. */
+    struct sockaddr_in dst; /**< Destino. */
+} icmp_probe_t;
+
+/**
+ * @brief Abre la sonda: ICMP sin privilegios (`ping_group_range`) o, si no, SOCK_RAW.
+ * @param p Sonda.
+ * @param ipv4 Destino en texto.
+ * @return 0 en éxito, -1 si no hay socket ICMP disponible.
+ */
+int icmp_probe_open(icmp_probe_t *p, const char *ipv4);
+
+/**
+ * @brief Envía un echo nuevo (el anterior sin respuesta se da por perdido).
+ * @return 0 en éxito, -1 en error.
+ */
+int icmp_probe_send(icmp_probe_t *p);
+
+/**
+ * @brief Lee las respuestas pendientes (llamar cuando el socket está legible).
+ * @return true si llegó el echo reply del último envío.
+ */
+bool icmp_probe_handle(icmp_probe_t *p);
+
+/**
+ * @brief Cierra la sonda.
+ */
+void icmp_probe_close(icmp_probe_t *p);
+
+/** @} */
+
+#endif // NET_MONITOR_H
@@ -0,0 +1,131 @@
+/**
+ * @file reactor.c
+ * @brief Implementación del reactor epoll de ltegps_app.
+ */
+
+#include "reactor.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+/**
+ * @addtogroup reactor_module
+ * @{
+ */
+
+static reactor_handler_t *find_handler(reactor_t *r, int fd) {
+    for (int i = 0; i < REACTOR_MAX_HANDLERS; i++) {
+        if (r->handlers[i].fd == fd) return &r->handlers[i];
+    }
+    return NULL;
+}
+
+static int add_handler(reactor_t *r, int fd, uint32_t events, reactor_cb_t cb, void *ctx, bool timer) {
+    if (!r || fd < 0 || !cb) return -1;
+    reactor_handler_t *h = find_handler(r, -1);
+    if (!h) return -1;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = h;
+    if (epoll_ctl(r->epfd, EPOLL_CTL_ADD, fd, &ev) != 0) return -1;
+
+    h->fd = fd;
+    h->cb = cb;
+    h->ctx = ctx;
+    h->timer = timer;
+    return 0;
+}
+
+int reactor_init(reactor_t *r) {
+    if (!r) return -1;
+    memset(r, 0, sizeof(*r));
+    for (int i = 0; i < REACTOR_MAX_HANDLERS; i++) r->handlers[i].fd = -1;
+    r->epfd = epoll_create1(EPOLL_CLOEXEC);
+    return (r->epfd >= 0) ? 0 : -1;
+}
+
+int reactor_add(reactor_t *r, int fd, uint32_t events, reactor_cb_t cb, void *ctx) {
+    return add_handler(r, fd, events, cb, ctx, false);
+}
+
+int reactor_mod(reactor_t *r, int fd, uint32_t events) {
+    if (!r || fd < 0) return -1;
+    reactor_handler_t *h = find_handler(r, fd);
+    if (!h) return -1;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = h;
+    return epoll_ctl(r->epfd, EPOLL_CTL_MOD, fd, &ev);
+}
+
+void reactor_del(reactor_t *r, int fd) {
+    if (!r || fd < 0) return;
+    reactor_handler_t *h = find_handler(r, fd);
+    if (!h) return;
+    epoll_ctl(r->epfd, EPOLL_CTL_DEL, fd, NULL);
+    h->fd = -1;
+    h->cb = NULL;
+    h->ctx = NULL;
+}
+
+int reactor_timer_arm(int tfd, uint32_t delay_ms, uint32_t period_ms) {
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = delay_ms / 1000U;
+    its.it_value.tv_nsec = (long)(delay_ms % 1000U) * 1000000L;
+    its.it_interval.tv_sec = period_ms / 1000U;
+    its.it_interval.tv_nsec = (long)(period_ms % 1000U) * 1000000L;
+    return timerfd_settime(tfd, 0, &its, NULL);
+}
+
+int reactor_add_timer(reactor_t *r, uint32_t period_ms, reactor_cb_t cb, void *ctx) {
+    const int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (tfd < 0) return -1;
+    if ((period_ms && reactor_timer_arm(tfd, period_ms, period_ms) != 0) ||
+        add_handler(r, tfd, EPOLLIN, cb, ctx, true) != 0) {
+        close(tfd);
+        return -1;
+    }
+    return tfd;
+}
+
+int reactor_run(reactor_t *r) {
+    if (!r) return -1;
+    struct epoll_event events[REACTOR_MAX_HANDLERS];
+
+    while (!r->stop) {
+        const int n = epoll_wait(r->epfd, events, REACTOR_MAX_HANDLERS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            return -1;
+        }
+        for (int i = 0; i < n && !r->stop; i++) {
+            reactor_handler_t *h = (reactor_handler_t*)events[i].data.ptr;
+            // A previous callback in this batch may have removed it
+            if (h->fd < 0 || !h->cb) continue;
+            if (h->timer) {
+                uint64_t expirations;
+                if (read(h->fd, &expirations, sizeof(expirations)) != (ssize_t)sizeof(expirations)) continue;
+            }
+            h->cb(h->fd, events[i].events, h->ctx);
+        }
+    }
+    return 0;
+}
+
+void reactor_close(reactor_t *r) {
+    if (!r) return;
+    if (r->epfd >= 0) close(r->epfd);
+    r->epfd = -1;
+}
+
+/** @} */
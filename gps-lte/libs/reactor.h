@@ -0,0 +1,112 @@
+/**
+ * @file reactor.h
+ * @brief Reactor epoll de un solo hilo para ltegps_app (UARTs, timerfd y sockets).
+ *
+ * Reemplaza los hilos por UART y las esperas con timeout: cada descriptor se registra con
+ * un callback y @ref reactor_run duerme en `epoll_wait` hasta que haya algo que atender.
+ * Los temporizadores son `timerfd` del reloj monotónico, así que la cadencia no depende
+ * de cuántas tramas lleguen.
+ */
+
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @defgroup reactor_module Reactor
+ * @ingroup gps_binary
+ * @brief Bucle de eventos de ltegps_app.
+ * @{
+ */
+
+#define REACTOR_MAX_HANDLERS 12 /**< Descriptores registrables a la vez (incluye los sockets de curl). */
+
+/**
+ * @brief Callback de un descriptor listo.
+ * @param fd Descriptor.
+ * @param events Máscara `EPOLL*` recibida.
+ * @param ctx Contexto dado al registrar.
+ */
+typedef void (*reactor_cb_t)(int fd, uint32_t events, void *ctx);
+
+/** @brief Entrada registrada. */
+typedef struct {
+    int fd;           /**< Descriptor (-1 = libre). */
+    reactor_cb_t cb;  /**< Callback. */
+    void *ctx;        /**< Contexto del callback. */
+    bool timer;       /**< Es un `timerfd`: se lee antes del callback. */
+} reactor_handler_t;
+
+/** @brief Estado del reactor. */
+typedef struct {
+    int epfd;                                        /**< Instancia epoll. */
+    bool stop;                                       /**< @ref reactor_run retorna en la próxima vuelta. */
+    reactor_handler_t handlers[REACTOR_MAX_HANDLERS]; /**< Tabla de callbacks. */
+} reactor_t;
+
+/**
+ * @brief Crea la instancia epoll.
+ * @return 0 en éxito, -1 en error.
+ */
+int reactor_init(reactor_t *r);
+
+/**
+ * @brief Registra un descriptor.
+ * @param r Reactor.
+ * @param fd Descriptor (no bloqueante).
+ * @param events Máscara `EPOLLIN`/`EPOLLOUT`.
+ * @param cb Callback.
+ * @param ctx Contexto.
+ * @return 0 en éxito, -1 si la tabla está llena o epoll falló.
+ */
+int reactor_add(reactor_t *r, int fd, uint32_t events, reactor_cb_t cb, void *ctx);
+
+/**
+ * @brief Cambia la máscara de eventos de un descriptor ya registrado.
+ * @param r Reactor.
+ * @param fd Descriptor.
+ * @param events Nueva máscara `EPOLLIN`/`EPOLLOUT`.
+ * @return 0 en éxito, -1 si no está registrado o epoll falló.
+ */
+int reactor_mod(reactor_t *r, int fd, uint32_t events);
+
+/**
+ * @brief Quita un descriptor (no lo cierra).
+ */
+void reactor_del(reactor_t *r, int fd);
+
+/**
+ * @brief Crea un `timerfd` monotónico y lo registra.
+ * @param r Reactor.
+ * @param period_ms Período (0 = desarmado; se arma luego con @ref reactor_timer_arm).
+ * @param cb Callback (el reactor ya consumió las expiraciones).
+ * @param ctx Contexto.
+ * @return Descriptor del temporizador, o -1 en error.
+ */
+int reactor_add_timer(reactor_t *r, uint32_t period_ms, reactor_cb_t cb, void *ctx);
+
+/**
+ * @brief Arma un temporizador.
+ * @param tfd Descriptor de @ref reactor_add_timer.
+ * @param delay_ms Primera expiración (0 = desarmar).
+ * @param period_ms Período posterior (0 = una sola vez).
+ * @return 0 en éxito, -1 en error.
+ */
+int reactor_timer_arm(int tfd, uint32_t delay_ms, uint32_t period_ms);
+
+/**
+ * @brief Atiende eventos hasta @ref reactor_t::stop.
+ * @return 0 al detenerse, -1 si `epoll_wait` falló.
+ */
+int reactor_run(reactor_t *r);
+
+/**
+ * @brief Cierra la instancia epoll.
+ */
+void reactor_close(reactor_t *r);
+
+/** @} */
+
+#endif // REACTOR_H
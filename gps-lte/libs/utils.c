@@ -5,77 +5,16 @@
 
 #include "utils.h"
 
-#include <cjson/cJSON.h>
-#include <sys/file.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <errno.h>
+#include "kv_store.h"
 
-#define SHM_PERSISTENT_PATH_GPS "/dev/shm/persistent.json"
+#include <sys/epoll.h>
 
-static char *read_all_from_fd_gps(int fd) {
-    if (lseek(fd, 0, SEEK_SET) < 0) {
-        return NULL;
-    }
-
-    size_t cap = 4096;
-    size_t len = 0;
-    char *buffer = (char *)malloc(cap);
-    if (!buffer) {
-        return NULL;
-    }
+/** Shared key/value segment of this process (mapped on first use). */
+static kv_store_t g_kv_gps = { NULL, -1 };
 
-    while (1) {
-        if (len + 2048 > cap) {
-            cap *= 2;
-            char *tmp = (char *)realloc(buffer, cap);
-            if (!tmp) {
-                free(buffer);
-                return NULL;
-            }
-            buffer = tmp;
-        }
-
-        ssize_t n = read(fd, buffer + len, cap - len - 1);
-        if (n < 0) {
-            free(buffer);
-            return NULL;
-        }
-        if (n == 0) {
-            break;
-        }
-        len += (size_t)n;
-    }
-
-    buffer[len] = '\0';
-    return buffer;
-}
-
-static cJSON *parse_root_or_empty_gps(const char *text) {
-    if (!text || text[0] == '\0') {
-        return cJSON_CreateObject();
-    }
-
-    cJSON *root = cJSON_Parse(text);
-    if (!root || !cJSON_IsObject(root)) {
-        if (root) {
-            cJSON_Delete(root);
-        }
-        return cJSON_CreateObject();
-    }
-    return root;
-}
-
-static cJSON *parse_value_or_string_gps(const char *value_text) {
-    if (!value_text) {
-        return cJSON_CreateNull();
-    }
-
-    cJSON *parsed = cJSON_Parse(value_text);
-    if (parsed) {
-        return parsed;
-    }
-    return cJSON_CreateString(value_text);
+static kv_store_t *persistent_store_gps(void) {
+    if (!g_kv_gps.shm && kv_open(&g_kv_gps) != 0) return NULL;
+    return &g_kv_gps;
 }
 
 /**
@@ -157,6 +96,262 @@ double nmea_to_decimal(double raw_coord) {
     return degrees + (minutes / 60.0);
 }
 
+/* ---------- GPS uploader: curl multi on the reactor + pending-fix queue ---------- */
+
+/** Fixes kept while the link is down or slow (oldest dropped first). */
+#define GPS_QUEUE_MAX 64
+/** Pending fixes survive restarts here (relative to the service WorkingDirectory). */
+#define GPS_QUEUE_PATH "Queue/gps_queue.jsonl"
+/** A POST slower than this marks the link as slow. */
+#define GPS_SLOW_LINK_S 2.0
+/** On a slow link, fixes are held until this many are pending and then sent together. */
+#define GPS_BATCH_SIZE 6
+/** Keep resolved addresses for the whole LTE session instead of curl's 60 s default. */
+#define GPS_DNS_CACHE_S 3600L
+
+typedef struct {
+    reactor_t *reactor;                             /**< Event loop driving the transfers. */
+    CURLM *multi;                                   /**< Multi handle: sockets and timeout live in the reactor. */
+    int timer_fd;                                   /**< timerfd armed with curl's requested timeout. */
+    CURL *curl;                                     /**< Reused handle: keeps the TCP/TLS connection alive. */
+    struct curl_slist *headers;                     /**< Content-Type header list. */
+    char url[MAX_URL_LENGTH];                       /**< Cached "<base>/gps". */
+    char base[MAX_URL_LENGTH];                      /**< Base URL the cache was built from. */
+    char mac[MAC_ADDR_LENGTH];                      /**< Cached wlan0 MAC ("" = not read yet). */
+    char queue[GPS_QUEUE_MAX][MAX_JSON_LENGTH];     /**< Ring of pending payloads. */
+    int head;                                       /**< Oldest pending entry. */
+    int count;                                      /**< Pending entries. */
+    bool loaded;                                    /**< GPS_QUEUE_PATH already read. */
+    bool slow;                                      /**< Last POST exceeded GPS_SLOW_LINK_S. */
+    bool busy;                                      /**< A POST is in flight. */
+    bool busy_evicted;                              /**< The fix in flight was dropped from the full queue. */
+    int sent_run;                                   /**< Fixes delivered since the queue was last empty. */
+    bool newest_pending;                            /**< The last fix from post_gps_data is not delivered yet. */
+    gps_uploader_sent_cb_t on_sent;                 /**< Delivery callback of the newest fix. */
+    void *on_sent_ctx;                              /**< Context of on_sent. */
+} gps_uploader_t;
+
+static gps_uploader_t g_up = { .timer_fd = -1 };
+
+static CURL *uploader_handle(void) {
+    if (g_up.curl) return g_up.curl;
+    g_up.curl = curl_easy_init();
+    if (!g_up.curl) return NULL;
+
+    g_up.headers = curl_slist_append(NULL, "Content-Type: application/json");
+    curl_easy_setopt(g_up.curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(g_up.curl, CURLOPT_HTTPHEADER, g_up.headers);
+    // Timeout para evitar que un envío quede colgado si no hay internet
+    curl_easy_setopt(g_up.curl, CURLOPT_TIMEOUT, 5L);
+    curl_easy_setopt(g_up.curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(g_up.curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(g_up.curl, CURLOPT_TCP_KEEPIDLE, 30L);
+    curl_easy_setopt(g_up.curl, CURLOPT_TCP_KEEPINTVL, 15L);
+    curl_easy_setopt(g_up.curl, CURLOPT_DNS_CACHE_TIMEOUT, GPS_DNS_CACHE_S);
+    return g_up.curl;
+}
+
+static void queue_save(void) {
+    char tmp[sizeof(GPS_QUEUE_PATH) + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", GPS_QUEUE_PATH);
+
+    if (g_up.count == 0) {
+        unlink(GPS_QUEUE_PATH);
+        return;
+    }
+    FILE *f = fopen(tmp, "w");
+    if (!f) return; // no Queue/ dir: the queue stays in memory only
+    for (int i = 0; i < g_up.count; i++) {
+        fprintf(f, "%s\n", g_up.queue[(g_up.head + i) % GPS_QUEUE_MAX]);
+    }
+    if (fclose(f) != 0 || rename(tmp, GPS_QUEUE_PATH) != 0) unlink(tmp);
+}
+
+/** @return false when the oldest pending fix had to be dropped to make room. */
+static bool queue_push(const char *payload) {
+    bool kept = true;
+    if (g_up.count == GPS_QUEUE_MAX) {
+        g_up.head = (g_up.head + 1) % GPS_QUEUE_MAX;
+        g_up.count--;
+        kept = false;
+    }
+    char *slot = g_up.queue[(g_up.head + g_up.count) % GPS_QUEUE_MAX];
+    snprintf(slot, MAX_JSON_LENGTH, "%s", payload);
+    g_up.count++;
+    return kept;
+}
+
+static void queue_pop(void) {
+    g_up.head = (g_up.head + 1) % GPS_QUEUE_MAX;
+    g_up.count--;
+}
+
+static void queue_load(void) {
+    g_up.loaded = true;
+    FILE *f = fopen(GPS_QUEUE_PATH, "r");
+    if (!f) return;
+    char line[MAX_JSON_LENGTH + 2];
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '{') queue_push(line);
+    }
+    fclose(f);
+    if (g_up.count > 0) printf("[UTILS] %d fixes GPS pendientes recuperados de %s\n", g_up.count, GPS_QUEUE_PATH);
+}
+
+/** Hands the oldest pending fix to the multi handle; the reactor completes it. */
+static void uploader_start(void) {
+    if (g_up.busy || g_up.count == 0 || !g_up.multi || !uploader_handle()) return;
+
+    curl_easy_setopt(g_up.curl, CURLOPT_URL, g_up.url);
+    // Copied: the ring slot may be recycled by queue_push while the POST is in flight
+    curl_easy_setopt(g_up.curl, CURLOPT_COPYPOSTFIELDS, g_up.queue[g_up.head]);
+    if (curl_multi_add_handle(g_up.multi, g_up.curl) != CURLM_OK) {
+        fprintf(stderr, "[UTILS] Error: no se pudo iniciar el envío GPS.\n");
+        return;
+    }
+    g_up.busy = true;
+    g_up.busy_evicted = false;
+}
+
+/** @return 0 sent, 3 transport error (keep it), -1 rejected by the server (drop it). */
+static int post_result(CURL *curl, CURLcode res) {
+    if (res != CURLE_OK) {
+        fprintf(stderr, "[UTILS] Error en CURL: %s\n", curl_easy_strerror(res));
+        return 3;
+    }
+
+    double total_s = 0.0;
+    long http = 0;
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &total_s);
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http);
+    g_up.slow = (total_s > GPS_SLOW_LINK_S);
+
+    if (http >= 400 && http < 500) {
+        fprintf(stderr, "[UTILS] API rechazó el fix GPS (HTTP %ld). Descartado.\n", http);
+        return -1;
+    }
+    if (http >= 500) {
+        fprintf(stderr, "[UTILS] Error del servidor (HTTP %ld).\n", http);
+        return 3;
+    }
+    return 0;
+}
+
+/**
+ * Finishes the POST in flight. Pending fixes keep draining oldest-first, one transfer
+ * at a time, without ever blocking the reactor; a failed send leaves the rest queued
+ * for the next post_gps_data call.
+ */
+static void uploader_finish(CURLcode res) {
+    const int r = post_result(g_up.curl, res);
+    if (r > 0) {
+        fprintf(stderr, "[UTILS] %d fixes GPS en cola para reintento.\n", g_up.count);
+        g_up.sent_run = 0;
+        queue_save();
+        return;
+    }
+
+    if (g_up.count > 0 && !g_up.busy_evicted) queue_pop();
+    if (r == 0) g_up.sent_run++;
+    queue_save();
+
+    if (g_up.count > 0) {
+        uploader_start();
+        return;
+    }
+
+    if (g_up.sent_run > 1) printf("[UTILS] Lote de %d fixes GPS enviado.\n", g_up.sent_run);
+    else if (g_up.sent_run == 1) printf("[UTILS] Datos GPS enviados con exito.\n");
+    g_up.sent_run = 0;
+
+    // The queue tail is always the newest fix: an empty queue after a success means it went out
+    const bool newest = g_up.newest_pending;
+    g_up.newest_pending = false;
+    if (r == 0 && newest && g_up.on_sent) g_up.on_sent(g_up.on_sent_ctx);
+}
+
+static void uploader_check_done(void) {
+    CURLMsg *msg;
+    int left = 0;
+    while ((msg = curl_multi_info_read(g_up.multi, &left)) != NULL) {
+        if (msg->msg != CURLMSG_DONE) continue;
+        const CURLcode res = msg->data.result;
+        curl_multi_remove_handle(g_up.multi, msg->easy_handle);
+        g_up.busy = false;
+        uploader_finish(res);
+    }
+}
+
+static void on_curl_fd(int fd, uint32_t events, void *arg) {
+    (void)arg;
+    int flags = 0;
+    if (events & EPOLLIN) flags |= CURL_CSELECT_IN;
+    if (events & EPOLLOUT) flags |= CURL_CSELECT_OUT;
+    if (events & (EPOLLERR | EPOLLHUP)) flags |= CURL_CSELECT_ERR;
+    int running = 0;
+    curl_multi_socket_action(g_up.multi, fd, flags, &running);
+    uploader_check_done();
+}
+
+static void on_curl_timer(int fd, uint32_t events, void *arg) {
+    (void)fd; (void)events; (void)arg;
+    int running = 0;
+    curl_multi_socket_action(g_up.multi, CURL_SOCKET_TIMEOUT, 0, &running);
+    uploader_check_done();
+}
+
+/** CURLMOPT_SOCKETFUNCTION: mirrors curl's interest in a socket into the reactor. */
+static int on_curl_socket(CURL *easy, curl_socket_t s, int what, void *userp, void *socketp) {
+    (void)easy; (void)userp;
+    if (what == CURL_POLL_REMOVE) {
+        reactor_del(g_up.reactor, s);
+        return 0;
+    }
+
+    uint32_t events = 0;
+    if (what == CURL_POLL_IN || what == CURL_POLL_INOUT) events |= EPOLLIN;
+    if (what == CURL_POLL_OUT || what == CURL_POLL_INOUT) events |= EPOLLOUT;
+
+    if (socketp) return (reactor_mod(g_up.reactor, s, events) == 0) ? 0 : -1;
+    if (reactor_add(g_up.reactor, s, events, on_curl_fd, NULL) != 0) {
+        fprintf(stderr, "[UTILS] Error: no se pudo registrar el socket de curl en el reactor.\n");
+        return -1;
+    }
+    curl_multi_assign(g_up.multi, s, &g_up); // any non-NULL marker: "already registered"
+    return 0;
+}
+
+/** CURLMOPT_TIMERFUNCTION: -1 disarms, 0 means "as soon as possible". */
+static int on_curl_timeout(CURLM *multi, long timeout_ms, void *userp) {
+    (void)multi; (void)userp;
+    if (timeout_ms < 0) return reactor_timer_arm(g_up.timer_fd, 0, 0);
+    return reactor_timer_arm(g_up.timer_fd, (timeout_ms > 0) ? (uint32_t)timeout_ms : 1U, 0);
+}
+
+int gps_uploader_init(reactor_t *r, gps_uploader_sent_cb_t on_sent, void *ctx) {
+    if (!r || g_up.multi) return -1;
+    if (curl_global_init(CURL_GLOBAL_DEFAULT) != CURLE_OK) return -1;
+
+    g_up.reactor = r;
+    g_up.timer_fd = reactor_add_timer(r, 0, on_curl_timer, NULL);
+    g_up.multi = (g_up.timer_fd >= 0) ? curl_multi_init() : NULL;
+    if (!g_up.multi) {
+        if (g_up.timer_fd >= 0) {
+            reactor_del(r, g_up.timer_fd);
+            close(g_up.timer_fd);
+        }
+        g_up.timer_fd = -1;
+        curl_global_cleanup();
+        return -1;
+    }
+    curl_multi_setopt(g_up.multi, CURLMOPT_SOCKETFUNCTION, on_curl_socket);
+    curl_multi_setopt(g_up.multi, CURLMOPT_TIMERFUNCTION, on_curl_timeout);
+    g_up.on_sent = on_sent;
+    g_up.on_sent_ctx = ctx;
+    return 0;
+}
+
 int post_gps_data(
     const char *base_api_url,
     const char *altitude_str,
@@ -176,14 +371,11 @@ int post_gps_data(
         return -1;
     }
 
-    CURL *curl;
-    CURLcode res;
-    char full_url[256];
     char json_payload[MAX_JSON_LENGTH];
-    char mac_address[MAC_ADDR_LENGTH];
 
-    // Obtener MAC
-    if (get_wlan0_mac(mac_address) != 0) {
+    // Obtener MAC (una sola vez por proceso)
+    if (g_up.mac[0] == '\0' && get_wlan0_mac(g_up.mac) != 0) {
+        g_up.mac[0] = '\0';
         fprintf(stderr, "[UTILS] Error: No se pudo obtener la MAC de wlan0.\n");
         return 1; 
     }
@@ -205,165 +397,72 @@ int post_gps_data(
     // --- 4. Formatear JSON ---
     int written = snprintf(json_payload, MAX_JSON_LENGTH, 
         "{\"mac\": \"%s\", \"lat\": %.6f, \"lng\": %.6f, \"alt\": %.1f}",
-        mac_address, final_lat, final_lng, alt);
+        g_up.mac, final_lat, final_lng, alt);
 
     if (written < 0 || written >= MAX_JSON_LENGTH) {
         fprintf(stderr, "[UTILS] Error: JSON buffer overflow.\n");
         return 2;
     }
 
-    // Construir URL completa
-    snprintf(full_url, sizeof(full_url), "%s/gps", base_api_url);
-
-    // --- 5. Enviar con CURL ---
-    curl = curl_easy_init();
-    if(curl) {
-        curl_easy_setopt(curl, CURLOPT_URL, full_url);
-        curl_easy_setopt(curl, CURLOPT_POST, 1L);
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_payload);
-
-        struct curl_slist *headers = NULL;
-        headers = curl_slist_append(headers, "Content-Type: application/json");
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-
-        // Timeout para evitar que el programa se quede colgado si no hay internet
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 5L);
-
-        res = curl_easy_perform(curl);
-
-        if(res != CURLE_OK) {
-            fprintf(stderr, "[UTILS] Error en CURL: %s\n", curl_easy_strerror(res));
-            curl_slist_free_all(headers);
-            curl_easy_cleanup(curl);
-            return 3;
-        }
-
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-    } else {
-        return 4;
-    }
-
-    printf("[UTILS] Datos GPS (%.6f, %.6f, %.1f)enviados con exito.\n", final_lat, final_lng, alt);
-
-    return 0; // Éxito
-}
-
-int shm_add_to_persistent_gps(const char *key, const char *value_text) {
-    if (!key || key[0] == '\0') {
-        return -1;
-    }
-
-    int fd = open(SHM_PERSISTENT_PATH_GPS, O_RDWR | O_CREAT, 0666);
-    if (fd < 0) {
-        return -1;
-    }
+    // --- 5. Encolar; el reactor hace el envío (handle persistente, sin bloquear) ---
+    if (!g_up.multi || !uploader_handle()) return 4;
 
-    if (flock(fd, LOCK_EX) != 0) {
-        close(fd);
-        return -1;
+    if (strcmp(g_up.base, base_api_url) != 0) {
+        snprintf(g_up.base, sizeof(g_up.base), "%s", base_api_url);
+        snprintf(g_up.url, sizeof(g_up.url), "%s/gps", base_api_url);
     }
 
-    int rc = -1;
-    char *content = read_all_from_fd_gps(fd);
-    cJSON *root = parse_root_or_empty_gps(content);
-    free(content);
+    if (!g_up.loaded) queue_load();
+    // The fix in flight is the queue head: a full queue may evict it mid-POST
+    if (!queue_push(json_payload) && g_up.busy) g_up.busy_evicted = true;
+    g_up.newest_pending = true;
+    queue_save();
 
-    if (!root) {
-        goto cleanup;
+    if (g_up.busy) {
+        printf("[UTILS] Envío GPS en curso: fix en cola (%d pendientes).\n", g_up.count);
+        return GPS_POST_QUEUED;
     }
 
-    cJSON *new_item = parse_value_or_string_gps(value_text);
-    if (!new_item) {
-        cJSON_Delete(root);
-        goto cleanup;
+    // Slow link: hold fixes and send them back-to-back once a batch is full
+    if (g_up.slow && g_up.count < GPS_BATCH_SIZE) {
+        printf("[UTILS] Enlace lento: fix GPS en cola (%d/%d).\n", g_up.count, GPS_BATCH_SIZE);
+        return GPS_POST_QUEUED;
     }
 
-    cJSON_DeleteItemFromObjectCaseSensitive(root, key);
-    cJSON_AddItemToObject(root, key, new_item);
-
-    char *out = cJSON_PrintUnformatted(root);
-    cJSON_Delete(root);
-    if (!out) {
-        goto cleanup;
-    }
-
-    size_t out_len = strlen(out);
-
-    if (ftruncate(fd, 0) != 0) {
-        free(out);
-        goto cleanup;
-    }
+    uploader_start();
+    printf("[UTILS] Datos GPS (%.6f, %.6f, %.1f) en envío.\n", final_lat, final_lng, alt);
+    return GPS_POST_QUEUED;
+}
 
-    if (lseek(fd, 0, SEEK_SET) < 0) {
-        free(out);
-        goto cleanup;
+void gps_uploader_cleanup(void) {
+    if (g_up.count > 0) queue_save();
+    if (g_up.busy) curl_multi_remove_handle(g_up.multi, g_up.curl);
+    g_up.busy = false;
+    if (g_up.curl) {
+        curl_slist_free_all(g_up.headers);
+        curl_easy_cleanup(g_up.curl);
     }
-
-    const char *ptr = out;
-    size_t remaining = out_len;
-    while (remaining > 0) {
-        ssize_t written = write(fd, ptr, remaining);
-        if (written < 0) {
-            if (errno == EINTR) {
-                continue;
-            }
-            free(out);
-            goto cleanup;
-        }
-        ptr += (size_t)written;
-        remaining -= (size_t)written;
+    if (g_up.multi) {
+        curl_multi_cleanup(g_up.multi);
+        curl_global_cleanup();
     }
-
-    free(out);
-
-    if (fsync(fd) != 0) {
-        goto cleanup;
+    if (g_up.timer_fd >= 0) {
+        reactor_del(g_up.reactor, g_up.timer_fd);
+        close(g_up.timer_fd);
     }
+    g_up.curl = NULL;
+    g_up.headers = NULL;
+    g_up.multi = NULL;
+    g_up.timer_fd = -1;
+    g_up.base[0] = '\0';
+}
 
-    rc = 0;
-
-cleanup:
-    flock(fd, LOCK_UN);
-    close(fd);
-    return rc;
+int shm_add_to_persistent_gps(const char *key, const char *value_text) {
+    return kv_set(persistent_store_gps(), key, value_text);
 }
 
 char *shm_consult_persistent_gps(const char *key) {
-    if (!key || key[0] == '\0') {
-        return NULL;
-    }
-
-    int fd = open(SHM_PERSISTENT_PATH_GPS, O_RDONLY);
-    if (fd < 0) {
-        return NULL;
-    }
-
-    if (flock(fd, LOCK_SH) != 0) {
-        close(fd);
-        return NULL;
-    }
-
-    char *result = NULL;
-    char *content = read_all_from_fd_gps(fd);
-    cJSON *root = parse_root_or_empty_gps(content);
-    free(content);
-
-    if (root) {
-        cJSON *item = cJSON_GetObjectItemCaseSensitive(root, key);
-        if (item) {
-            if (cJSON_IsString(item) && item->valuestring) {
-                result = strdup(item->valuestring);
-            } else {
-                result = cJSON_PrintUnformatted(item);
-            }
-        }
-        cJSON_Delete(root);
-    }
-
-    flock(fd, LOCK_UN);
-    close(fd);
-    return result;
+    return kv_get(persistent_store_gps(), key);
 }
 
 char *ashm_consult_persistent_gps(const char *key) {
@@ -20,6 +20,8 @@
 #include <unistd.h>
 #include <netinet/in.h>
 
+#include "reactor.h"
+
 /**
  * @defgroup utils_gpslte Utilities GPS-LTE
  * @ingroup gps_binary
@@ -31,6 +33,15 @@
 #define MAX_JSON_LENGTH 256
 #define MAC_ADDR_LENGTH 18
 
+/** post_gps_data: the fix is queued; its delivery is reported later through gps_uploader_sent_cb_t. */
+#define GPS_POST_QUEUED 5
+
+/**
+ * @brief Called on the reactor once the newest fix given to post_gps_data was delivered.
+ * @param ctx Context given to gps_uploader_init.
+ */
+typedef void (*gps_uploader_sent_cb_t)(void *ctx);
+
 /**
  * @brief Reads a specific key from a local .env file.
  * @param key The key to search for (e.g., "API_URL").
@@ -47,13 +58,36 @@ char *getenv_c_gps(const char *key);
 int get_wlan0_mac(char *mac_out);
 
 /**
- * @brief Converts coordinates to JSON and POSTs them via HTTP.
- * @note Automatically retrieves the wlan0 MAC address to include in the JSON.
+ * @brief Attaches the GPS uploader to the reactor.
+ *
+ * Uploads run on a curl multi handle whose sockets and timeout are registered
+ * in @p r, so a POST never blocks the thread that drains the GPS UART.
+ *
+ * @param r Reactor that will drive the transfers.
+ * @param on_sent Delivery callback (NULL = none).
+ * @param ctx Context for @p on_sent.
+ * @return int 0 on success, -1 on failure (post_gps_data then fails with 4).
+ */
+int gps_uploader_init(reactor_t *r, gps_uploader_sent_cb_t on_sent, void *ctx);
+
+/**
+ * @brief Converts coordinates to JSON and queues them for an HTTP POST.
+ * @note The wlan0 MAC, the URL and the curl handle are cached per process, so
+ * consecutive reports reuse the same resolved address and TCP/TLS connection.
+ *
+ * Every fix goes through a pending queue (also kept in Queue/gps_queue.jsonl
+ * across restarts). The reactor sends pending fixes oldest-first on the same
+ * connection, one transfer at a time; a failed send leaves the rest queued for
+ * the next call. When the last POST took longer than 2 s, fixes are held and
+ * sent as a batch of 6.
+ *
  * * @param base_api_url The server URL (e.g., "http://myserver.com").
  * @param altitude_str Altitude as string.
  * @param latitude_str Latitude as string.
  * @param longitude_str Longitude as string.
- * @return int 0 on success, non-zero on failure.
+ * @return int GPS_POST_QUEUED when the fix was queued, whether its POST started
+ * or it is held behind a transfer in flight or for a slow-link batch; nothing
+ * has been delivered yet. Any other value means it could not be built or queued.
  */
 int post_gps_data(
     const char *base_api_url,
@@ -63,12 +97,18 @@ int post_gps_data(
 );
 
 /**
- * @brief Adds or updates a key in /dev/shm/persistent.json (GPS-LTE variant).
+ * @brief Persists pending fixes and releases the curl handles used by post_gps_data.
+ * @note Call it before closing the reactor given to gps_uploader_init.
+ */
+void gps_uploader_cleanup(void);
+
+/**
+ * @brief Adds or updates a key in the shared key/value store (GPS-LTE variant).
  *
- * Uses exclusive file lock + fsync for safe multi-process writes,
- * matching Python ShmStore protection semantics.
+ * Writes the key's slot in /dev/shm/bacn_kv under the writers' lock and
+ * rewrites the /dev/shm/persistent.json snapshot, like Python ShmStore.
  *
- * @param key JSON key to insert/update.
+ * @param key Key to insert/update.
  * @param value_text Value as text. If valid JSON, it is stored typed;
  * otherwise it is stored as JSON string.
  * @return int 0 on success, -1 on error.
@@ -76,13 +116,13 @@ int post_gps_data(
 int shm_add_to_persistent_gps(const char *key, const char *value_text);
 
 /**
- * @brief Reads a key from /dev/shm/persistent.json (GPS-LTE variant).
+ * @brief Reads a key from the shared key/value store (GPS-LTE variant).
  *
- * Uses shared file lock for safe concurrent reads.
+ * Lock-free and parse-free (per-slot seqlock).
  * - If JSON value is string: returns raw string content (no quotes).
  * - Otherwise: returns unformatted JSON text.
  *
- * @param key JSON key to query.
+ * @param key Key to query.
  * @return char* Heap-allocated string (caller must free), or NULL on not found/error.
  */
 char *shm_consult_persistent_gps(const char *key);
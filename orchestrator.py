@@ -354,7 +354,8 @@ def fetch_realtime_config(client):
                 antenna_amp=bool(json_payload.get("antenna_amp")),
                 antenna_port=int(json_payload.get("antenna_port")), 
                 ppm_error=float(ppm_err_shm) if ppm_err_shm else 0.0,
-                cooldown_request=float(json_payload.get("cooldown_request", 2.0))
+                cooldown_request=float(json_payload.get("cooldown_request", 2.0)),
+                target_averages=json_payload.get("target_averages")
             )
         
         if json_payload.get("demodulation") in ["fm","am"]:
@@ -367,6 +368,7 @@ def fetch_realtime_config(client):
             config_obj.filter = FilterConfig(
                 start_freq_hz=int(json_payload.get("filter").get("start_freq_hz")),
                 end_freq_hz=int(json_payload.get("filter").get("end_freq_hz")),
+                zoom=bool(json_payload.get("filter").get("zoom", False)),
             )
 
         else:
@@ -0,0 +1,591 @@
+/**
+ * @file rf_bench.c
+ * @brief Benchmark offline de los kernels DSP del binario RF (sin HackRF ni ZMQ).
+ *
+ * @details Alimenta IQ int8 sintético (FM + AM + ruido) o grabado (`.cs8`, I/Q intercalados)
+ * a las mismas etapas que usa `rf_app`:
+ * - Ruta PSD: @ref load_iq_into_signal, @ref iq_compensation, @ref chan_filter_apply_inplace_abs,
+ *   @ref execute_welch_psd y @ref execute_pfb_psd, con el tamaño de captura y `nperseg` que
+ *   produce @ref find_params_psd para cada combinación de tasa, RBW y ventana.
+ * - Ruta de audio (float32): @ref iq_decim_process_s8_cf32, @ref iq_iir_filter_apply_cf32,
+ *   @ref fm_radio_cf32_to_pcm y @ref am_radio_local_cf32_to_pcm en bloques de
+ *   @ref AUDIO_CHUNK_SAMPLES.
+ *
+ * Recorre la matriz tasas × RBW × ventanas × hilos OpenMP e imprime, por etapa, los
+ * percentiles de latencia (p50/p90/p99/máx) y el throughput en muestras/s calculado sobre p50.
+ *
+ * Uso:
+ * @code
+ * rf_bench [--iq captura.cs8] [--rates 2e6,10e6,20e6] [--rbws 1000,10000,100000]
+ *          [--windows hann,flattop] [--threads 1,2,4] [--iters 20] [--overlap 0.5] [--csv]
+ * @endcode
+ *
+ * @author GCPDS
+ * @date 2026
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <time.h>
+#include <complex.h>
+#include <omp.h>
+
+#include "datatypes.h"
+#include "psd.h"
+#include "chan_filter.h"
+#include "fm_radio.h"
+#include "am_radio_local.h"
+#include "iq_decim.h"
+#include "iq_iir_filter.h"
+#include "audio_stream_ctx.h"
+#include "fft_wisdom.h"
+#include "pfb_kernels.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/**
+ * @defgroup rf_bench_module RF Bench
+ * @ingroup rf_binary
+ * @brief Matriz de benchmarks de las etapas DSP con entrada sintética o grabada.
+ * @{
+ */
+
+#define BENCH_MAX_LIST   16      /**< Máximo de valores por eje de la matriz. */
+#define BENCH_CENTER_HZ  100000000ULL /**< Frecuencia central ficticia para el filtro de canal. */
+#define BENCH_AUDIO_FS   48000   /**< Tasa de audio de los demoduladores. */
+
+/**
+ * @brief Ejes de la matriz y opciones de ejecución.
+ */
+typedef struct {
+    double rates[BENCH_MAX_LIST];            /**< Tasas de muestreo (Hz). */
+    int n_rates;
+    int rbws[BENCH_MAX_LIST];                /**< RBW objetivo (Hz). */
+    int n_rbws;
+    PsdWindowType_t windows[BENCH_MAX_LIST]; /**< Ventanas PSD. */
+    int n_windows;
+    int threads[BENCH_MAX_LIST];             /**< Hilos OpenMP. */
+    int n_threads;
+    int iters;                               /**< Repeticiones cronometradas por celda. */
+    double overlap;                          /**< Solapamiento Welch (0..1). */
+    bool csv;                                /**< Salida CSV en lugar de tabla. */
+    const char *iq_path;                     /**< Captura `.cs8` opcional (NULL = sintético). */
+} bench_opts_t;
+
+/**
+ * @brief Latencias de una etapa a lo largo de las repeticiones.
+ */
+typedef struct {
+    const char *name; /**< Nombre de la etapa. */
+    double *ms;       /**< Latencias (ms), una por repetición. */
+    int n;            /**< Repeticiones registradas. */
+} bench_stage_t;
+
+static const struct { const char *name; PsdWindowType_t type; } k_windows[] = {
+    { "hann", HANN_TYPE }, { "hamming", HAMMING_TYPE }, { "blackman", BLACKMAN_TYPE },
+    { "flattop", FLAT_TOP_TYPE }, { "kaiser", KAISER_TYPE }, { "tukey", TUKEY_TYPE },
+    { "bartlett", BARTLETT_TYPE }, { "rectangular", RECTANGULAR_TYPE },
+};
+
+static const char *window_name(PsdWindowType_t t) {
+    for (size_t i = 0; i < sizeof(k_windows) / sizeof(k_windows[0]); i++) {
+        if (k_windows[i].type == t) return k_windows[i].name;
+    }
+    return "?";
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    const double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/* ========================================================================== */
+/* Command line                                                               */
+/* ========================================================================== */
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "Usage: %s [--iq file.cs8] [--rates list] [--rbws list] [--windows list]\n"
+            "          [--threads list] [--iters N] [--overlap F] [--csv]\n"
+            "  Lists are comma separated, e.g. --rates 2e6,20e6 --windows hann,flattop\n",
+            argv0);
+}
+
+static int parse_double_list(const char *s, double *out, int max) {
+    int n = 0;
+    char *dup = strdup(s);
+    if (!dup) return 0;
+    for (char *tok = strtok(dup, ","); tok && n < max; tok = strtok(NULL, ",")) {
+        const double v = strtod(tok, NULL);
+        if (v > 0.0) out[n++] = v;
+    }
+    free(dup);
+    return n;
+}
+
+static int parse_int_list(const char *s, int *out, int max) {
+    double tmp[BENCH_MAX_LIST];
+    const int n = parse_double_list(s, tmp, max < BENCH_MAX_LIST ? max : BENCH_MAX_LIST);
+    for (int i = 0; i < n; i++) out[i] = (int)llround(tmp[i]);
+    return n;
+}
+
+static int parse_window_list(const char *s, PsdWindowType_t *out, int max) {
+    int n = 0;
+    char *dup = strdup(s);
+    if (!dup) return 0;
+    for (char *tok = strtok(dup, ","); tok && n < max; tok = strtok(NULL, ",")) {
+        bool found = false;
+        for (size_t i = 0; i < sizeof(k_windows) / sizeof(k_windows[0]); i++) {
+            if (strcasecmp(tok, k_windows[i].name) == 0) {
+                out[n++] = k_windows[i].type;
+                found = true;
+                break;
+            }
+        }
+        if (!found) fprintf(stderr, "[BENCH] Unknown window '%s' ignored\n", tok);
+    }
+    free(dup);
+    return n;
+}
+
+static int parse_args(int argc, char **argv, bench_opts_t *o) {
+    memset(o, 0, sizeof(*o));
+    o->rates[0] = 2e6;  o->rates[1] = 10e6; o->rates[2] = 20e6; o->n_rates = 3;
+    o->rbws[0] = 1000;  o->rbws[1] = 10000; o->rbws[2] = 100000; o->n_rbws = 3;
+    o->windows[0] = HANN_TYPE; o->windows[1] = FLAT_TOP_TYPE; o->n_windows = 2;
+    o->iters = 20;
+    o->overlap = 0.5;
+
+    const int max_thr = omp_get_max_threads();
+    o->threads[o->n_threads++] = 1;
+    if (max_thr > 1) o->threads[o->n_threads++] = max_thr;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(a, "--csv") == 0) { o->csv = true; continue; }
+        if (strcmp(a, "-h") == 0 || strcmp(a, "--help") == 0) { usage(argv[0]); return 1; }
+        if (!v) { usage(argv[0]); return -1; }
+
+        if      (strcmp(a, "--iq") == 0)      o->iq_path = v;
+        else if (strcmp(a, "--rates") == 0)   o->n_rates = parse_double_list(v, o->rates, BENCH_MAX_LIST);
+        else if (strcmp(a, "--rbws") == 0)    o->n_rbws = parse_int_list(v, o->rbws, BENCH_MAX_LIST);
+        else if (strcmp(a, "--windows") == 0) o->n_windows = parse_window_list(v, o->windows, BENCH_MAX_LIST);
+        else if (strcmp(a, "--threads") == 0) o->n_threads = parse_int_list(v, o->threads, BENCH_MAX_LIST);
+        else if (strcmp(a, "--iters") == 0)   o->iters = atoi(v);
+        else if (strcmp(a, "--overlap") == 0) o->overlap = strtod(v, NULL);
+        else { usage(argv[0]); return -1; }
+        i++;
+    }
+
+    if (o->n_rates == 0 || o->n_rbws == 0 || o->n_windows == 0 || o->n_threads == 0 || o->iters < 1) {
+        usage(argv[0]);
+        return -1;
+    }
+    if (o->overlap < 0.0 || o->overlap >= 1.0) o->overlap = 0.5;
+    return 0;
+}
+
+/* ========================================================================== */
+/* Input                                                                      */
+/* ========================================================================== */
+
+/**
+ * @brief Genera IQ int8 sintético: WBFM en +fs/8, AM en -fs/8 y ruido gaussiano.
+ * @details Tono de 1 kHz, desviación FM de 75 kHz y modulación AM del 50 %, con la escala
+ * típica de una captura del HackRF (pico ~±90 cuentas) para ejercitar la ruta completa.
+ */
+static void synth_iq(int8_t *dst, size_t n_samples, double fs) {
+    uint32_t lcg = 0x12345678u;
+    double fm_phase = 0.0;
+    const double f_fm = fs / 8.0, f_am = -fs / 8.0, f_tone = 1000.0, dev = 75000.0;
+
+    for (size_t n = 0; n < n_samples; n++) {
+        const double t = (double)n / fs;
+        const double tone = sin(2.0 * M_PI * f_tone * t);
+        fm_phase += 2.0 * M_PI * (f_fm + dev * tone) / fs;
+        if (fm_phase > M_PI) fm_phase -= 2.0 * M_PI;
+
+        const double am_env = 1.0 + 0.5 * tone;
+        double complex x = 40.0 * cexp(I * fm_phase) + 20.0 * am_env * cexp(I * 2.0 * M_PI * f_am * t);
+
+        /* Box-Muller on a small LCG: deterministic across runs */
+        lcg = lcg * 1664525u + 1013904223u;
+        const double u1 = ((double)(lcg >> 8) + 1.0) / 16777217.0;
+        lcg = lcg * 1664525u + 1013904223u;
+        const double u2 = (double)(lcg >> 8) / 16777216.0;
+        const double r = 4.0 * sqrt(-2.0 * log(u1));
+        x += r * cos(2.0 * M_PI * u2) + I * r * sin(2.0 * M_PI * u2);
+
+        const double re = fmax(-127.0, fmin(127.0, round(creal(x))));
+        const double im = fmax(-127.0, fmin(127.0, round(cimag(x))));
+        dst[2 * n]     = (int8_t)re;
+        dst[2 * n + 1] = (int8_t)im;
+    }
+}
+
+/**
+ * @brief Llena @p dst con la captura grabada, repitiéndola si es más corta.
+ * @return 0 en éxito, -1 si el archivo no se puede leer o está vacío.
+ */
+static int load_recorded_iq(const char *path, int8_t *dst, size_t n_bytes) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "[BENCH] Cannot open %s\n", path);
+        return -1;
+    }
+    size_t filled = 0;
+    while (filled < n_bytes) {
+        const size_t got = fread(dst + filled, 1, n_bytes - filled, f);
+        if (got == 0) {
+            if (filled == 0 || ferror(f)) break;
+            rewind(f);
+            continue;
+        }
+        filled += got;
+    }
+    fclose(f);
+    if (filled < n_bytes) {
+        fprintf(stderr, "[BENCH] %s is empty or unreadable\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+/* ========================================================================== */
+/* Stats / output                                                             */
+/* ========================================================================== */
+
+static int stage_init(bench_stage_t *s, const char *name, int iters) {
+    s->name = name;
+    s->n = 0;
+    s->ms = (double*)malloc(sizeof(double) * (size_t)iters);
+    return s->ms ? 0 : -1;
+}
+
+static void print_header(const bench_opts_t *o) {
+    if (o->csv) {
+        printf("rate_hz,rbw_hz,window,threads,nperseg,samples,stage,p50_ms,p90_ms,p99_ms,max_ms,msps\n");
+    } else {
+        printf("%10s %8s %-9s %3s %7s %9s  %-14s %9s %9s %9s %9s %9s\n",
+               "rate", "rbw", "window", "thr", "nperseg", "samples", "stage",
+               "p50[ms]", "p90[ms]", "p99[ms]", "max[ms]", "MS/s");
+    }
+}
+
+/**
+ * @brief Ordena las latencias de la etapa e imprime percentiles y throughput (sobre p50).
+ */
+static void stage_report(const bench_opts_t *o, bench_stage_t *s, double rate, int rbw,
+                         const char *win, int thr, int nperseg, size_t samples) {
+    if (s->n == 0) return;
+    qsort(s->ms, (size_t)s->n, sizeof(double), cmp_double);
+
+    const double p50 = s->ms[(s->n - 1) * 50 / 100];
+    const double p90 = s->ms[(s->n - 1) * 90 / 100];
+    const double p99 = s->ms[(s->n - 1) * 99 / 100];
+    const double pmax = s->ms[s->n - 1];
+    const double msps = (p50 > 0.0) ? (double)samples / (p50 * 1e3) : 0.0;
+
+    if (o->csv) {
+        printf("%.0f,%d,%s,%d,%d,%zu,%s,%.4f,%.4f,%.4f,%.4f,%.3f\n",
+               rate, rbw, win, thr, nperseg, samples, s->name, p50, p90, p99, pmax, msps);
+    } else {
+        printf("%10.0f %8d %-9s %3d %7d %9zu  %-14s %9.3f %9.3f %9.3f %9.3f %9.2f\n",
+               rate, rbw, win, thr, nperseg, samples, s->name, p50, p90, p99, pmax, msps);
+    }
+    s->n = 0;
+}
+
+/* ========================================================================== */
+/* PSD path                                                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Cronometra la ruta PSD de una celda (tasa, RBW, ventana, hilos).
+ * @return 0 en éxito, -1 si falla la reserva.
+ */
+static int bench_psd_cell(const bench_opts_t *o, const int8_t *iq, double fs, int rbw,
+                          PsdWindowType_t win, int thr) {
+    DesiredCfg_t desired;
+    memset(&desired, 0, sizeof(desired));
+    desired.sample_rate = fs;
+    desired.rbw = rbw;
+    desired.overlap = o->overlap;
+    desired.window_type = win;
+    desired.center_freq = BENCH_CENTER_HZ;
+
+    PsdConfig_t psd_cfg;
+    RB_cfg_t rb_cfg;
+    find_params_psd(desired, NULL, &psd_cfg, &rb_cfg);
+
+    const size_t n_samples = rb_cfg.total_bytes / 2U;
+    signal_iq_t sig = { NULL, 0 };
+    sig.signal_iq = (double complex*)malloc(sizeof(double complex) * n_samples);
+    double *f_out = (double*)malloc(sizeof(double) * (size_t)psd_cfg.nperseg);
+    double *p_out = (double*)malloc(sizeof(double) * (size_t)psd_cfg.nperseg);
+
+    /* Channel filter around the synthetic FM carrier (+fs/8), 200 kHz wide */
+    filter_t filt;
+    filt.start_freq_hz = (int)(BENCH_CENTER_HZ + (uint64_t)(fs / 8.0) - 100000ULL);
+    filt.end_freq_hz   = (int)(BENCH_CENTER_HZ + (uint64_t)(fs / 8.0) + 100000ULL);
+    filt.mode = CHAN_FILTER_AUTO;
+    char err[128];
+    const bool filt_ok = chan_filter_validate_cfg_abs(&filt, BENCH_CENTER_HZ, fs, err, sizeof(err)) == 0;
+
+    bench_stage_t st[5];
+    memset(st, 0, sizeof(st));
+    int rc = 0;
+    if (!sig.signal_iq || !f_out || !p_out ||
+        stage_init(&st[0], "load_iq", o->iters) || stage_init(&st[1], "iq_comp", o->iters) ||
+        stage_init(&st[2], "chan_filter", o->iters) || stage_init(&st[3], "welch_psd", o->iters) ||
+        stage_init(&st[4], "pfb_psd", o->iters)) {
+        rc = -1;
+        goto out;
+    }
+
+    omp_set_num_threads(thr);
+
+    /* One untimed pass warms the plan caches (FFTW, window, filter mask) */
+    for (int it = -1; it < o->iters; it++) {
+        double t0, t1;
+
+        sig.n_signal = n_samples;
+        t0 = now_ms();
+        load_iq_into_signal(iq, rb_cfg.total_bytes, &sig);
+        t1 = now_ms();
+        if (it >= 0) st[0].ms[st[0].n++] = t1 - t0;
+
+        t0 = now_ms();
+        iq_compensation(&sig);
+        t1 = now_ms();
+        if (it >= 0) st[1].ms[st[1].n++] = t1 - t0;
+
+        if (filt_ok) {
+            t0 = now_ms();
+            chan_filter_apply_inplace_abs(&sig, &filt, BENCH_CENTER_HZ, fs);
+            t1 = now_ms();
+            if (it >= 0) st[2].ms[st[2].n++] = t1 - t0;
+        }
+
+        t0 = now_ms();
+        execute_welch_psd(&sig, &psd_cfg, f_out, p_out);
+        t1 = now_ms();
+        if (it >= 0) st[3].ms[st[3].n++] = t1 - t0;
+
+        t0 = now_ms();
+        execute_pfb_psd(&sig, &psd_cfg, f_out, p_out);
+        t1 = now_ms();
+        if (it >= 0) st[4].ms[st[4].n++] = t1 - t0;
+    }
+
+    for (int s = 0; s < 5; s++) {
+        stage_report(o, &st[s], fs, rbw, window_name(win), thr, psd_cfg.nperseg, n_samples);
+    }
+
+out:
+    for (int s = 0; s < 5; s++) free(st[s].ms);
+    free(sig.signal_iq);
+    free(f_out);
+    free(p_out);
+    return rc;
+}
+
+/* ========================================================================== */
+/* Audio path                                                                 */
+/* ========================================================================== */
+
+/**
+ * @brief Cronometra diezmador + demodulador (FM y AM) por bloque de @ref AUDIO_CHUNK_SAMPLES.
+ * @details Reproduce la configuración del hilo de audio de `rf_app`: el diezmador se planifica
+ * con las mismas tasas intermedias y el demodulador trabaja a la tasa resultante. Estas etapas
+ * no usan OpenMP, así que se miden una vez por tasa.
+ * @return 0 en éxito, -1 si falla la reserva.
+ */
+static int bench_audio(const bench_opts_t *o, const int8_t *iq, size_t iq_bytes, double fs) {
+    const size_t chunk = AUDIO_CHUNK_SAMPLES;
+    const size_t n_chunks = iq_bytes / (2U * chunk);
+    if (n_chunks == 0) return 0;
+
+    const int iters = o->iters * 4;
+    float complex *iqf = (float complex*)malloc(sizeof(float complex) * chunk);
+    size_t n_iq = 0;
+    int16_t *pcm = (int16_t*)malloc(sizeof(int16_t) * chunk);
+    fm_radio_t *fm = (fm_radio_t*)calloc(1, sizeof(fm_radio_t));
+    am_radio_local_t *am = (am_radio_local_t*)calloc(1, sizeof(am_radio_local_t));
+    iq_decim_t decim;
+    memset(&decim, 0, sizeof(decim));
+    iq_iir_filter_t iir;
+    memset(&iir, 0, sizeof(iir));
+    filter_audio_t iir_cfg;
+    memset(&iir_cfg, 0, sizeof(iir_cfg));
+    iir_cfg.type_filter = BANDPASS_TYPE;
+    iir_cfg.order_fliter = IQ_FILTER_ORDER;
+    iir_cfg.bw_filter_hz = IQ_FILTER_BW_FM_HZ;
+
+    bench_stage_t st[4];
+    memset(st, 0, sizeof(st));
+    int rc = 0;
+    if (!iqf || !pcm || !fm || !am || stage_init(&st[0], "iq_decim", iters) ||
+        stage_init(&st[1], "fm_demod", iters) || stage_init(&st[2], "am_demod", iters) ||
+        stage_init(&st[3], "iq_iir", iters)) {
+        rc = -1;
+        goto out;
+    }
+
+    for (int mode = 0; mode < 2; mode++) {
+        const bool is_am = (mode == 1);
+        int r1 = 1, r2 = 1;
+        const int planned = is_am
+            ? iq_decim_plan(fs, BENCH_AUDIO_FS, 40000.0, 150000.0, 96000.0, &r1, &r2)
+            : iq_decim_plan(fs, BENCH_AUDIO_FS, 250000.0, 600000.0, 400000.0, &r1, &r2);
+        const bool use_decim = (planned == 0 && r1 * r2 > 1 &&
+                                iq_decim_init(&decim, fs, r1, r2, chunk) == 0);
+        const double fs_demod = use_decim ? decim.fs_out : fs;
+
+        if (is_am) am_radio_local_init(am, fs_demod, BENCH_AUDIO_FS);
+        else       fm_radio_init(fm, fs_demod, BENCH_AUDIO_FS, 75);
+        if (!is_am && iq_iir_filter_init(&iir, fs_demod, &iir_cfg, 1) != 0) {
+            rc = -1;
+            goto out;
+        }
+
+        bench_stage_t *demod = is_am ? &st[2] : &st[1];
+        size_t out_samples = chunk;
+
+        for (int it = -1; it < iters; it++) {
+            const int8_t *src = iq + ((size_t)(it + 1) % n_chunks) * 2U * chunk;
+            double t0 = now_ms();
+            if (use_decim) {
+                n_iq = iq_decim_process_s8_cf32(&decim, src, chunk, iqf);
+            } else {
+                for (size_t i = 0; i < chunk; i++) {
+                    iqf[i] = (float)src[2 * i] / 128.0f + (float)src[2 * i + 1] / 128.0f * I;
+                }
+                n_iq = chunk;
+            }
+            double t1 = now_ms();
+            if (it >= 0 && !is_am) st[0].ms[st[0].n++] = t1 - t0;
+            out_samples = n_iq;
+
+            if (!is_am) {
+                t0 = now_ms();
+                iq_iir_filter_apply_cf32(&iir, iqf, n_iq);
+                t1 = now_ms();
+                if (it >= 0) st[3].ms[st[3].n++] = t1 - t0;
+            }
+
+            t0 = now_ms();
+            if (is_am) am_radio_local_cf32_to_pcm(am, iqf, n_iq, pcm, NULL);
+            else       fm_radio_cf32_to_pcm(fm, iqf, n_iq, pcm, NULL, (int)llround(fs_demod));
+            t1 = now_ms();
+            if (it >= 0) demod->ms[demod->n++] = t1 - t0;
+        }
+
+        if (!is_am) {
+            stage_report(o, &st[0], fs, 0, "-", 1, r1 * r2, chunk);
+            stage_report(o, &st[3], fs, 0, "-", 1, r1 * r2, out_samples);
+        }
+        /* Demod throughput is reported at its own (decimated) input rate */
+        stage_report(o, demod, fs, 0, "-", 1, r1 * r2, out_samples);
+    }
+
+out:
+    for (int s = 0; s < 4; s++) free(st[s].ms);
+    iq_decim_free(&decim);
+    iq_iir_filter_free(&iir);
+    free(iqf);
+    free(pcm);
+    free(fm);
+    free(am);
+    return rc;
+}
+
+/* ========================================================================== */
+/* Main                                                                       */
+/* ========================================================================== */
+
+int main(int argc, char **argv) {
+    bench_opts_t opts;
+    const int prc = parse_args(argc, argv, &opts);
+    if (prc != 0) return (prc > 0) ? 0 : 2;
+
+    fft_wisdom_load();
+    fprintf(stderr, "[BENCH] Kernels: iq_convert=%s pfb=%s\n", iq_convert_isa_name(), pfb_kernels_isa_name());
+    print_header(&opts);
+
+    for (int r = 0; r < opts.n_rates; r++) {
+        const double fs = opts.rates[r];
+
+        /* Largest capture of this rate across the RBW/window axes, plus room for audio */
+        size_t max_bytes = (size_t)AUDIO_CHUNK_SAMPLES * 2U * 8U;
+        for (int b = 0; b < opts.n_rbws; b++) {
+            for (int w = 0; w < opts.n_windows; w++) {
+                DesiredCfg_t d;
+                memset(&d, 0, sizeof(d));
+                d.sample_rate = fs;
+                d.rbw = opts.rbws[b];
+                d.overlap = opts.overlap;
+                d.window_type = opts.windows[w];
+                PsdConfig_t p;
+                RB_cfg_t rbc;
+                find_params_psd(d, NULL, &p, &rbc);
+                if (rbc.total_bytes > max_bytes) max_bytes = rbc.total_bytes;
+            }
+        }
+
+        int8_t *iq = (int8_t*)malloc(max_bytes);
+        if (!iq) {
+            fprintf(stderr, "[BENCH] Out of memory (%zu bytes)\n", max_bytes);
+            return 1;
+        }
+        if (opts.iq_path) {
+            if (load_recorded_iq(opts.iq_path, iq, max_bytes) != 0) {
+                free(iq);
+                return 1;
+            }
+        } else {
+            synth_iq(iq, max_bytes / 2U, fs);
+        }
+
+        for (int b = 0; b < opts.n_rbws; b++) {
+            for (int w = 0; w < opts.n_windows; w++) {
+                for (int t = 0; t < opts.n_threads; t++) {
+                    if (bench_psd_cell(&opts, iq, fs, opts.rbws[b], opts.windows[w], opts.threads[t]) != 0) {
+                        fprintf(stderr, "[BENCH] Allocation failed at %.0f Hz / %d Hz\n", fs, opts.rbws[b]);
+                    }
+                }
+            }
+        }
+
+        if (bench_audio(&opts, iq, max_bytes, fs) != 0) {
+            fprintf(stderr, "[BENCH] Audio path allocation failed at %.0f Hz\n", fs);
+        }
+        fflush(stdout);
+        free(iq);
+    }
+
+    chan_filter_free_cache();
+    return 0;
+}
+
+/** @} */
@@ -260,15 +260,20 @@ void am_radio_local_init(am_radio_local_t *r, double fs_iq, int audio_fs) {
     r->agc_release = 0.005f; // lento
 }
 
-int am_radio_local_iq_to_pcm(am_radio_local_t *r, signal_iq_t *sig, int16_t *pcm_out, am_depth_state_t *depth_st) {
+/**
+ * @brief Núcleo común de @ref am_radio_local_iq_to_pcm y @ref am_radio_local_cf32_to_pcm.
+ * @details Exactamente uno de @p iq_d / @p iq_f es no nulo; solo cambia la lectura de cada muestra.
+ */
+static int am_demod(am_radio_local_t *r, const double complex *iq_d, const float complex *iq_f,
+                    size_t n_iq, int16_t *pcm_out, am_depth_state_t *depth_st) {
     int out_idx = 0;
     const int R = r->decim_factor;
 
-    for (size_t i = 0; i < sig->n_signal; i++) {
+    for (size_t i = 0; i < n_iq; i++) {
 
         // Envelope
-        double re = creal(sig->signal_iq[i]);
-        double im = cimag(sig->signal_iq[i]);
+        double re = iq_f ? (double)crealf(iq_f[i]) : creal(iq_d[i]);
+        double im = iq_f ? (double)cimagf(iq_f[i]) : cimag(iq_d[i]);
         double env = am_env_mag(re, im);
 
         // CIC2 decimation to audio_fs
@@ -315,4 +320,13 @@ int am_radio_local_iq_to_pcm(am_radio_local_t *r, signal_iq_t *sig, int16_t *pcm
     return out_idx;
 }
 
+int am_radio_local_iq_to_pcm(am_radio_local_t *r, signal_iq_t *sig, int16_t *pcm_out, am_depth_state_t *depth_st) {
+    return am_demod(r, sig->signal_iq, NULL, sig->n_signal, pcm_out, depth_st);
+}
+
+int am_radio_local_cf32_to_pcm(am_radio_local_t *r, const float complex *iq, size_t n_iq,
+                               int16_t *pcm_out, am_depth_state_t *depth_st) {
+    return am_demod(r, NULL, iq, n_iq, pcm_out, depth_st);
+}
+
 /** @} */
\ No newline at end of file
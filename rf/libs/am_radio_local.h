@@ -99,6 +99,22 @@ int am_radio_local_iq_to_pcm(am_radio_local_t *r,
                             int16_t *pcm_out,
                             am_depth_state_t *depth_st);
 
+/**
+ * @brief Igual que @ref am_radio_local_iq_to_pcm pero sobre un buffer `float complex`.
+ * @details Ruta float32 del hilo de audio (tras @ref iq_iir_filter_apply_cf32).
+ * @param[in,out] r         Puntero al estado del radio.
+ * @param[in]     iq        Muestras IQ float32.
+ * @param[in]     n_iq      Número de muestras de @p iq.
+ * @param[out]    pcm_out   Buffer de salida para audio PCM16.
+ * @param[in,out] depth_st  Estado opcional para métricas de profundidad de modulación.
+ * @return int              Cantidad de muestras escritas en pcm_out.
+ */
+int am_radio_local_cf32_to_pcm(am_radio_local_t *r,
+                               const float complex *iq,
+                               size_t n_iq,
+                               int16_t *pcm_out,
+                               am_depth_state_t *depth_st);
+
 /** @} */
 
 #ifdef __cplusplus
@@ -1,4 +1,5 @@
 #include "audio_stream_ctx.h"
+#include "utils.h"
 
 
 void audio_stream_ctx_defaults(audio_stream_ctx_t *ctx, fm_radio_t *fm, am_radio_local_t *am) {
@@ -36,6 +37,19 @@ void audio_stream_ctx_defaults(audio_stream_ctx_t *ctx, fm_radio_t *fm, am_radio
     if (ctx->bitrate <= 0) ctx->bitrate = OPUS_BITRATE_DEFAULT;
     ctx->vbr = ctx->vbr ? 1 : 0;
 
+    // Transport is shared with server_webrtc.py, so it comes from the .env like AUDIO_TRANSPORT there
+    char *env_tr  = getenv_c("AUDIO_TRANSPORT");
+    char *env_fpp = getenv_c("OPUS_FRAMES_PER_PACKET");
+    ctx->transport = (int)opus_tx_transport_from_str(env_tr);
+    ctx->frames_per_packet = (env_fpp && env_fpp[0]) ? atoi(env_fpp) : OPUS_FRAMES_PER_PACKET_DEFAULT;
+    free(env_tr);
+    free(env_fpp);
+
+    const int max_fpp = OPUS_MAX_PACKET_MS / ctx->frame_ms;
+    if (ctx->frames_per_packet > max_fpp) ctx->frames_per_packet = max_fpp;
+    if (ctx->frames_per_packet > OPUS_TX_MAX_FRAMES) ctx->frames_per_packet = OPUS_TX_MAX_FRAMES;
+    if (ctx->frames_per_packet < 1) ctx->frames_per_packet = 1;
+
     // init current mode / fs (will be updated by main on first config)
     atomic_store(&ctx->current_mode, (int)FM_MODE);
     atomic_store(&ctx->current_fs_hz, 0.0);
@@ -57,3 +71,39 @@ void audio_stream_ctx_defaults(audio_stream_ctx_t *ctx, fm_radio_t *fm, am_radio
     ctx->iqf_cfg.bw_filter_hz = IQ_FILTER_BW_FM_HZ;
     ctx->iqf_ready = 0;
 }
+
+int audio_workspace_init(audio_workspace_t *ws, int frame_samples) {
+    if (!ws || frame_samples <= 0) return -1;
+    memset(ws, 0, sizeof(*ws));
+
+    // Widest element first so every slice stays naturally aligned
+    const size_t n = (size_t)AUDIO_CHUNK_SAMPLES;
+    const size_t iq_bytes    = n * sizeof(float complex);
+    const size_t pcm_bytes   = n * sizeof(int16_t);
+    const size_t accum_bytes = (size_t)frame_samples * sizeof(int16_t);
+    const size_t raw_bytes   = n * 2U;
+
+    uint8_t *arena = (uint8_t*)malloc(iq_bytes + pcm_bytes + accum_bytes + raw_bytes);
+    if (!arena) return -1;
+
+    ws->arena       = arena;
+    ws->arena_bytes = iq_bytes + pcm_bytes + accum_bytes + raw_bytes;
+    ws->iq          = (float complex*)arena;
+    ws->pcm_out     = (int16_t*)(arena + iq_bytes);
+    ws->pcm_accum   = (int16_t*)(arena + iq_bytes + pcm_bytes);
+    ws->raw_iq      = (int8_t*)(arena + iq_bytes + pcm_bytes + accum_bytes);
+    ws->frame_samples = frame_samples;
+
+    if (iq_decim_reserve(&ws->decim, n) != 0) {
+        audio_workspace_free(ws);
+        return -1;
+    }
+    return 0;
+}
+
+void audio_workspace_free(audio_workspace_t *ws) {
+    if (!ws) return;
+    iq_decim_free(&ws->decim);
+    free(ws->arena);
+    memset(ws, 0, sizeof(*ws));
+}
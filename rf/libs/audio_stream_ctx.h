@@ -13,10 +13,13 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
+#include <complex.h>
 #include "datatypes.h"
 #include "fm_radio.h"
 #include "iq_iir_filter.h"
 #include "am_radio_local.h"
+#include "iq_decim.h"
+#include "opus_tx.h"
 
 /**
  * @defgroup audio_module Audio Streaming Context
@@ -40,6 +43,8 @@
 #define OPUS_BITRATE_DEFAULT   32000       /**< Bitrate por defecto para el stream de voz/audio (bps). */
 #define OPUS_COMPLEXITY_DEFAULT 5          /**< Complejidad computacional del encoder (0-10). */
 #define OPUS_VBR_DEFAULT       0           /**< Modo por defecto: CBR (0). */
+#define OPUS_FRAMES_PER_PACKET_DEFAULT 1   /**< Tramas Opus por paquete de red. */
+#define OPUS_MAX_PACKET_MS     120         /**< Duración máxima de un paquete Opus (RFC 6716). */
 /**@}*/
 
 /**
@@ -53,6 +58,27 @@
 extern "C" {
 #endif
 
+/**
+ * @brief Buffers y estado de la ruta de audio, reservados una sola vez al arrancar rf_app.
+ * @details Los cuatro buffers del hilo salen de un único bloque (@ref arena) dimensionado por
+ * @ref AUDIO_CHUNK_SAMPLES y la trama Opus, que no dependen de la tasa del HackRF. Los
+ * demoduladores viven dentro de la estructura y el diezmador se reserva para el peor caso
+ * (@ref iq_decim_reserve), así que un cambio FM/AM o de sample_rate no reserva memoria
+ * ni reinicia el hilo.
+ */
+typedef struct audio_workspace {
+    void *arena;              /**< Bloque único con los buffers de abajo. */
+    size_t arena_bytes;       /**< Tamaño de @ref arena. */
+    float complex *iq;        /**< Chunk IQ float32 convertido o diezmado (AUDIO_CHUNK_SAMPLES). */
+    int16_t *pcm_out;         /**< PCM del demodulador (AUDIO_CHUNK_SAMPLES). */
+    int16_t *pcm_accum;       /**< Acumulador de trama Opus (@ref frame_samples). */
+    int8_t *raw_iq;           /**< Chunk int8 I/Q crudo (2·AUDIO_CHUNK_SAMPLES bytes). */
+    int frame_samples;        /**< Capacidad de @ref pcm_accum. */
+    fm_radio_t fm;            /**< Demodulador FM (sin memoria dinámica). */
+    am_radio_local_t am;      /**< Demodulador AM (sin memoria dinámica). */
+    iq_decim_t decim;         /**< Diezmador, reservado para R1 = 1 y el FIR más largo. */
+} audio_workspace_t;
+
 /**
  * @brief Estructura de contexto para el stream de audio.
  * * Mantiene el estado de los demoduladores, la configuración de red y las métricas
@@ -62,8 +88,10 @@ typedef struct audio_stream_ctx {
     fm_radio_t *fm_radio;       /**< Instancia del demodulador FM. */
     am_radio_local_t *am_radio; /**< Instancia del demodulador AM. */
 
-    const char *tcp_host;       /**< Dirección del servidor TCP. */
-    int tcp_port;               /**< Puerto del servidor TCP. */
+    const char *tcp_host;       /**< Dirección del gateway de audio (TCP o UDP según @ref transport). */
+    int tcp_port;               /**< Puerto del gateway de audio. */
+    int transport;              /**< @ref opus_tx_transport_t (`AUDIO_TRANSPORT` del `.env`: tcp | rtp). */
+    int frames_per_packet;      /**< Tramas por paquete (`OPUS_FRAMES_PER_PACKET`, máx. 120 ms). */
 
     int opus_sample_rate;       /**< Tasa de muestreo de salida (usualmente 48kHz). */
     int opus_channels;          /**< Número de canales (1 = Mono). */
@@ -81,6 +109,7 @@ typedef struct audio_stream_ctx {
 
     fm_dev_state_t  fm_dev;        /**< Estado de la medición de desviación FM. */
     am_depth_state_t am_depth;     /**< Estado de la medición de profundidad AM. */
+    audio_workspace_t *ws;         /**< Buffers del hilo de audio (@ref audio_workspace_init). */
 } audio_stream_ctx_t;
 
 /**
@@ -94,6 +123,20 @@ typedef struct audio_stream_ctx {
  */
 void audio_stream_ctx_defaults(audio_stream_ctx_t *ctx, fm_radio_t *fm, am_radio_local_t *am);
 
+/**
+ * @brief Reserva el workspace de audio (arena + diezmador) para tramas de @p frame_samples.
+ * @param[out] ws Workspace (se pone en cero antes de reservar).
+ * @param[in]  frame_samples Muestras PCM por trama Opus.
+ * @return 0 en éxito, -1 si los parámetros son inválidos o falla la reserva.
+ */
+int audio_workspace_init(audio_workspace_t *ws, int frame_samples);
+
+/**
+ * @brief Libera el workspace de audio.
+ * @param[in,out] ws Workspace.
+ */
+void audio_workspace_free(audio_workspace_t *ws);
+
 /** @} */
 
 #ifdef __cplusplus
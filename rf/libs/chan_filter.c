@@ -3,6 +3,7 @@
  * @brief Implementación del filtrado por dominio de frecuencia.
  */
 #include "chan_filter.h"
+#include "fft_wisdom.h"
 
 /**
  * @addtogroup chan_filter_module
@@ -41,6 +42,15 @@ static const double TRANS_FRAC    = 0.30;  /**< Fracción del ancho de banda usa
 static const double CAP_OOB_DB    = 6.0;   /**< Umbral sobre la mediana para recorte de picos (Etapa 1). */
 static const double MIN_OOB_FRAC  = 0.05;  /**< Porcentaje mínimo de bins OOB para activar Etapa 1. */
 
+// Constantes del modo por bloques (overlap-save)
+static const double OS_TAPS_PER_TRANS = 4.0; /**< Taps del kernel por cada fs/transición (M ~ 4 fs / tr). */
+static const int    OS_FFT_MIN        = 1024;   /**< Tamaño mínimo de bloque FFT. */
+static const int    OS_FFT_MAX        = 262144; /**< Tamaño máximo de bloque FFT (acota la memoria). */
+static const int    OS_AUTO_RATIO     = 4;      /**< AUTO usa bloques si N >= OS_AUTO_RATIO * L. */
+
+/** @brief Máximo de hilos con workspace propio en el modo por bloques. */
+#define OS_MAX_THREADS 16
+
 /**
  * @brief Estructura interna para caché de planes FFT y máscara de frecuencia.
  */
@@ -59,8 +69,43 @@ typedef struct {
     int last_end;           /**< Última frecuencia de fin. */
 } cache_t;
 
-static cache_t g = {0};
-static const char *g_region = "UNKNOWN";
+/* Per calling thread (one per rf_app engine): OpenMP workers only see pointers copied from it */
+static __thread cache_t g = {0};
+static __thread const char *g_region = "UNKNOWN";
+
+/**
+ * @brief Workspace por hilo del modo overlap-save (reservado fuera de la región paralela).
+ */
+typedef struct {
+    fftw_complex *in;         /**< Bloque temporal de L muestras. */
+    fftw_complex *out;        /**< Espectro del bloque. */
+    double *oob_mag;          /**< Scratch de magnitudes OOB (L). */
+    double complex *carry;    /**< D muestras originales que el bloque siguiente necesita. */
+    double complex *halo_l;   /**< D muestras previas al tramo del hilo (antes de escribir). */
+    double complex *halo_r;   /**< D muestras posteriores al tramo del hilo (antes de escribir). */
+} os_thread_ws_t;
+
+/**
+ * @brief Caché del modo overlap-save: planes de tamaño L compartidos y kernel en frecuencia.
+ * @details Los planes se ejecutan con fftw_execute_dft() sobre los buffers de cada hilo,
+ * lo que es thread-safe y evita planes thread-local.
+ */
+typedef struct {
+    int L;                  /**< Tamaño de la FFT de bloque. */
+    int D;                  /**< Semilongitud del kernel: M = 2D + 1 taps centrados. */
+    int n_threads;          /**< Workspaces reservados. */
+    fftw_plan fwd;          /**< Plan directo de tamaño L. */
+    fftw_plan inv;          /**< Plan inverso de tamaño L. */
+    double complex *H;      /**< Respuesta del kernel enventanado (incluye 1/L). */
+    os_thread_ws_t tws[OS_MAX_THREADS];
+
+    uint64_t last_fc;
+    double last_fs;
+    int last_start;
+    int last_end;
+} os_cache_t;
+
+static __thread os_cache_t gb = {0};
 
 const char* chan_filter_last_region(void) { return g_region; }
 
@@ -68,8 +113,8 @@ const char* chan_filter_last_region(void) { return g_region; }
  * @brief Libera los recursos de la caché global.
  */
 static void cache_free(void) {
-    if (g.fwd) fftw_destroy_plan(g.fwd);
-    if (g.inv) fftw_destroy_plan(g.inv);
+    fft_wisdom_destroy_plan(g.fwd);
+    fft_wisdom_destroy_plan(g.inv);
     if (g.in)  fftw_free(g.in);
     if (g.out) fftw_free(g.out);
     if (g.mask_stage2) free(g.mask_stage2);
@@ -77,7 +122,29 @@ static void cache_free(void) {
     memset(&g, 0, sizeof(g));
 }
 
-void chan_filter_free_cache(void) { cache_free(); }
+/**
+ * @brief Libera los recursos de la caché overlap-save.
+ */
+static void os_cache_free(void) {
+    fft_wisdom_destroy_plan(gb.fwd);
+    fft_wisdom_destroy_plan(gb.inv);
+    for (int t = 0; t < gb.n_threads; t++) {
+        os_thread_ws_t *w = &gb.tws[t];
+        if (w->in)  fftw_free(w->in);
+        if (w->out) fftw_free(w->out);
+        free(w->oob_mag);
+        free(w->carry);
+        free(w->halo_l);
+        free(w->halo_r);
+    }
+    free(gb.H);
+    memset(&gb, 0, sizeof(gb));
+}
+
+void chan_filter_free_cache(void) {
+    cache_free();
+    os_cache_free();
+}
 
 /**
  * @brief Determina si la caché actual es inválida para los nuevos parámetros.
@@ -97,28 +164,50 @@ static int need_rebuild(int N, const filter_t *cfg, uint64_t fc, double fs) {
 }
 
 /**
- * @brief Función de comparación para qsort.
- * @param a Puntero al primer elemento.
- * @param b Puntero al segundo elemento.
- * @return -1 si a < b, 0 si a == b, 1 si a > b.
+ * @brief Selecciona el k-ésimo menor elemento (quickselect, O(n) promedio).
+ * @details Deja v[0..k-1] <= v[k] <= v[k+1..n-1], como std::nth_element.
+ * @param v Array (se reordena).
+ * @param n Tamaño del array.
+ * @param k Índice buscado (0 <= k < n).
+ * @return Valor del k-ésimo elemento.
  */
-static int cmp_double(const void *a, const void *b) {
-    double x = *(const double*)a;
-    double y = *(const double*)b;
-    return (x < y) ? -1 : (x > y);
+static double select_kth(double *v, int n, int k) {
+    int lo = 0, hi = n - 1;
+    while (lo < hi) {
+        const double pivot = v[lo + (hi - lo) / 2];
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (v[i] < pivot) i++;
+            while (v[j] > pivot) j--;
+            if (i <= j) {
+                double t = v[i]; v[i] = v[j]; v[j] = t;
+                i++; j--;
+            }
+        }
+        if (k <= j) hi = j;
+        else if (k >= i) lo = i;
+        else break;
+    }
+    return v[k];
 }
 
 /**
  * @brief Calcula la mediana de un array de doubles.
- * @param v Puntero al array.
+ * @param v Puntero al array (se reordena).
  * @param n Tamaño del array.
  * @return Mediana del array.
  */
 static double median_of_array(double *v, int n) {
     if (!v || n <= 0) return 0.0;
-    qsort(v, (size_t)n, sizeof(double), cmp_double);
-    if (n & 1) return v[n/2];
-    return 0.5 * (v[n/2 - 1] + v[n/2]);
+    const double upper = select_kth(v, n, n / 2);
+    if (n & 1) return upper;
+
+    /* After selection the lower middle is the maximum of the left partition */
+    double lower = v[0];
+    for (int i = 1; i < n / 2; i++) {
+        if (v[i] > lower) lower = v[i];
+    }
+    return 0.5 * (lower + upper);
 }
 
 /**
@@ -168,6 +257,8 @@ int chan_filter_validate_cfg_abs(
  * @param fc_hz Frecuencia central.
  * @param fs_hz Frecuencia de muestreo.
  */
+static void fill_mask_stage2(double *mask, int N, const filter_t *cfg, uint64_t fc_hz, double fs_hz);
+
 static int build_mask_and_plans(int N, const filter_t *cfg, uint64_t fc_hz, double fs_hz) {
     if (N < 2) return -1;
 
@@ -178,13 +269,30 @@ static int build_mask_and_plans(int N, const filter_t *cfg, uint64_t fc_hz, doub
         g.out = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * (size_t)N);
         if (!g.in || !g.out) return -2;
 
-        g.fwd = fftw_plan_dft_1d(N, g.in, g.out, FFTW_FORWARD, FFTW_ESTIMATE);
-        g.inv = fftw_plan_dft_1d(N, g.out, g.in, FFTW_BACKWARD, FFTW_ESTIMATE);
+        g.fwd = fft_wisdom_plan_dft_1d(N, g.in, g.out, FFTW_FORWARD);
+        g.inv = fft_wisdom_plan_dft_1d(N, g.out, g.in, FFTW_BACKWARD);
         g.mask_stage2 = (double*)malloc(sizeof(double) * (size_t)N);
         g.oob_mag = (double*)malloc(sizeof(double) * (size_t)N);
         if (!g.fwd || !g.inv || !g.mask_stage2 || !g.oob_mag) return -3;
     }
 
+    fill_mask_stage2(g.mask_stage2, N, cfg, fc_hz, fs_hz);
+
+    g.last_fc = fc_hz; g.last_fs = fs_hz;
+    g.last_start = cfg->start_freq_hz; g.last_end = cfg->end_freq_hz;
+
+    return 0;
+}
+
+/**
+ * @brief Calcula la máscara de la Etapa 2 sobre una rejilla FFT de N bins.
+ * @param[out] mask Destino de N ganancias lineales (orden FFT).
+ * @param N Tamaño de la rejilla.
+ * @param cfg Configuración del filtro.
+ * @param fc_hz Frecuencia central.
+ * @param fs_hz Frecuencia de muestreo.
+ */
+static void fill_mask_stage2(double *mask, int N, const filter_t *cfg, uint64_t fc_hz, double fs_hz) {
     double fc = (double)fc_hz;
     double fi_off = (double)cfg->start_freq_hz - fc;
     double ff_off = (double)cfg->end_freq_hz - fc;
@@ -222,37 +330,255 @@ static int build_mask_and_plans(int N, const filter_t *cfg, uint64_t fc_hz, doub
         } else {
             g2 = 1.0 + (stop - 1.0) * raised_cos_chan_filt((f - hi1) / (hi0 - hi1));
         }
-        g.mask_stage2[k] = g2;
+        mask[k] = g2;
     }
+}
 
-    g.last_fc = fc_hz; g.last_fs = fs_hz;
-    g.last_start = cfg->start_freq_hz; g.last_end = cfg->end_freq_hz;
+/**
+ * @brief Deriva la geometría overlap-save a partir del ancho de transición.
+ * @details La transición más estrecha de la máscara (tr Hz) fija la longitud del kernel,
+ * \f$ M = 2D + 1 \approx 4 f_s / tr \f$, y el bloque es la potencia de 2
+ * \f$ L \geq 4M \f$ (al menos 75 % de muestras útiles por bloque), acotada a
+ * [OS_FFT_MIN, OS_FFT_MAX].
+ * @param cfg Configuración del filtro.
+ * @param fc_hz Frecuencia central.
+ * @param fs_hz Frecuencia de muestreo.
+ * @param[out] L Tamaño de la FFT de bloque.
+ * @param[out] D Semilongitud del kernel.
+ */
+static void os_block_geometry(const filter_t *cfg, uint64_t fc_hz, double fs_hz, int *L, int *D) {
+    double fi_off = (double)cfg->start_freq_hz - (double)fc_hz;
+    double ff_off = (double)cfg->end_freq_hz - (double)fc_hz;
+    double tr = TRANS_FRAC * (ff_off - fi_off);
+
+    /* Transitions clipped at Nyquist are narrower than tr */
+    double t_lo = fi_off - CLAMPD(fi_off - tr, -0.5 * fs_hz, 0.5 * fs_hz);
+    double t_hi = CLAMPD(ff_off + tr, -0.5 * fs_hz, 0.5 * fs_hz) - ff_off;
+    if (t_lo > 0.0 && t_lo < tr) tr = t_lo;
+    if (t_hi > 0.0 && t_hi < tr) tr = t_hi;
+
+    double taps = (tr > 0.0) ? OS_TAPS_PER_TRANS * fs_hz / tr : (double)OS_FFT_MAX;
+    int d = (int)ceil(0.5 * taps);
+
+    int l = OS_FFT_MIN;
+    while (l < OS_FFT_MAX && (double)l < 4.0 * (2.0 * d + 1.0)) l <<= 1;
+
+    /* Very narrow bands: cap the kernel so the block still yields half its samples */
+    if (d > l / 4) d = l / 4;
+
+    *L = l;
+    *D = d;
+}
 
+/** @brief Hilos del modo por bloques: los de OpenMP, acotados a OS_MAX_THREADS. */
+static int os_thread_count(void) {
+    int n = omp_get_max_threads();
+    if (n < 1) n = 1;
+    if (n > OS_MAX_THREADS) n = OS_MAX_THREADS;
+    return n;
+}
+
+/**
+ * @brief Reconstruye planes, workspaces por hilo y kernel del modo overlap-save.
+ * @details El kernel se diseña por muestreo en frecuencia: la máscara de la Etapa 2
+ * sobre la rejilla de L bins se lleva al tiempo, se trunca a 2D + 1 taps centrados con
+ * ventana de Hann y se vuelve a transformar, de modo que la convolución lineal por bloques
+ * reproduce @ref fill_mask_stage2 con transiciones suavizadas por la ventana.
+ * @return 0 en éxito, < 0 si falla la reserva o la FFTW.
+ */
+static int os_build(int L, int D, const filter_t *cfg, uint64_t fc_hz, double fs_hz) {
+    const int want_threads = os_thread_count();
+
+    if (gb.L != L || gb.D != D || gb.n_threads != want_threads) {
+        os_cache_free();
+        gb.L = L;
+        gb.D = D;
+        gb.n_threads = want_threads;
+        gb.H = (double complex*)malloc(sizeof(double complex) * (size_t)L);
+        if (!gb.H) return -2;
+
+        for (int t = 0; t < want_threads; t++) {
+            os_thread_ws_t *w = &gb.tws[t];
+            w->in      = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * (size_t)L);
+            w->out     = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * (size_t)L);
+            w->oob_mag = (double*)malloc(sizeof(double) * (size_t)L);
+            w->carry   = (double complex*)malloc(sizeof(double complex) * (size_t)(D + 1));
+            w->halo_l  = (double complex*)malloc(sizeof(double complex) * (size_t)(D + 1));
+            w->halo_r  = (double complex*)malloc(sizeof(double complex) * (size_t)(D + 1));
+            if (!w->in || !w->out || !w->oob_mag || !w->carry || !w->halo_l || !w->halo_r) return -2;
+        }
+
+        gb.fwd = fft_wisdom_plan_dft_1d(L, gb.tws[0].in, gb.tws[0].out, FFTW_FORWARD);
+        gb.inv = fft_wisdom_plan_dft_1d(L, gb.tws[0].out, gb.tws[0].in, FFTW_BACKWARD);
+        if (!gb.fwd || !gb.inv) return -3;
+    }
+
+    fftw_complex *tin = gb.tws[0].in;
+    fftw_complex *tout = gb.tws[0].out;
+
+    /* Stage 2 mask on the block grid -> centred impulse response */
+    fill_mask_stage2(gb.tws[0].oob_mag, L, cfg, fc_hz, fs_hz);
+    for (int k = 0; k < L; k++) tout[k] = gb.tws[0].oob_mag[k];
+    fftw_execute_dft(gb.inv, tout, tin);
+
+    const double invL = 1.0 / (double)L;
+    for (int n = 0; n < L; n++) {
+        int ns = (n <= L / 2) ? n : (n - L);
+        if (ns < -D || ns > D) {
+            tin[n] = 0.0;
+        } else {
+            double w = 0.5 + 0.5 * cos(M_PI * (double)ns / (double)(D + 1));
+            tin[n] *= w * invL;
+        }
+    }
+    fftw_execute_dft(gb.fwd, tin, tout);
+
+    /* The block inverse transform is left unnormalised: fold its 1/L into H */
+    for (int k = 0; k < L; k++) gb.H[k] = tout[k] * invL;
+
+    gb.last_fc = fc_hz; gb.last_fs = fs_hz;
+    gb.last_start = cfg->start_freq_hz; gb.last_end = cfg->end_freq_hz;
     return 0;
 }
 
-int chan_filter_apply_inplace_abs(
-    signal_iq_t *sig,
-    const filter_t *cfg,
-    uint64_t fc_hz,
-    double fs_hz
-) {
-    if (!sig || !sig->signal_iq || sig->n_signal < 2) return -1;
-    
-    char err[256];
-    if (chan_filter_validate_cfg_abs(cfg, fc_hz, fs_hz, err, sizeof(err)) < 0) {
-        return -4;
+/**
+ * @brief Etapa 1 (recorte de picos OOB) sobre el espectro de un bloque.
+ * @param X Espectro del bloque (L bins, orden FFT).
+ * @param mag Scratch de L doubles.
+ * @param L Tamaño del bloque.
+ * @param df Resolución del bloque (Hz).
+ * @param fi_off Borde inferior de la banda respecto a fc (Hz).
+ * @param ff_off Borde superior de la banda respecto a fc (Hz).
+ */
+static void os_flatten_oob_peaks(fftw_complex *X, double *mag, int L, double df, double fi_off, double ff_off) {
+    int oob_n = 0;
+    for (int k = 0; k < L; k++) {
+        int ks = (k <= L/2) ? k : (k - L);
+        double f = (double)ks * df;
+        if (f < fi_off || f > ff_off) {
+            mag[oob_n++] = cabs(X[k]);
+        }
+    }
+
+    if (oob_n <= 16 || ((double)oob_n / L) < MIN_OOB_FRAC) return;
+
+    double med = median_of_array(mag, oob_n);
+    if (med <= 0.0) return;
+
+    double cap = med * db_to_lin_amp_chan_filt(CAP_OOB_DB);
+    for (int k = 0; k < L; k++) {
+        int ks = (k <= L/2) ? k : (k - L);
+        double f = (double)ks * df;
+        if (f < fi_off || f > ff_off) {
+            double m = cabs(X[k]);
+            if (m > cap) X[k] *= cap / m;
+        }
     }
+}
 
+/**
+ * @brief Filtrado overlap-save in-place con bloques de tamaño fijo, paralelo por tramos.
+ * @details Cada hilo procesa un tramo contiguo de bloques en orden. Antes de escribir,
+ * se guardan las D muestras a cada lado del tramo (halos) y, dentro del tramo, las D
+ * muestras originales que necesita el bloque siguiente (carry), de modo que la salida
+ * puede sobrescribir la señal sin un segundo buffer de tamaño N.
+ */
+static int apply_block(signal_iq_t *sig, const filter_t *cfg, uint64_t fc_hz, double fs_hz, int L, int D) {
+    if (gb.L != L || gb.D != D || gb.last_fc != fc_hz || fabs(gb.last_fs - fs_hz) > 1e-9 ||
+        gb.last_start != cfg->start_freq_hz || gb.last_end != cfg->end_freq_hz ||
+        gb.n_threads != os_thread_count()) {
+        if (os_build(L, D, cfg, fc_hz, fs_hz) < 0) {
+            os_cache_free();
+            return -5;
+        }
+    }
+
+    double complex *x = sig->signal_iq;
+    const size_t N = sig->n_signal;
+    const size_t step = (size_t)(L - 2 * D);
+    const size_t n_blocks = (N + step - 1) / step;
+
+    const double fi_off = (double)cfg->start_freq_hz - (double)fc_hz;
+    const double ff_off = (double)cfg->end_freq_hz - (double)fc_hz;
+    const double df = fs_hz / (double)L;
+
+    const fftw_plan fwd = gb.fwd;
+    const fftw_plan inv = gb.inv;
+    const double complex *H = gb.H;
+    os_thread_ws_t *tws = gb.tws;
+
+    #pragma omp parallel num_threads(gb.n_threads)
+    {
+        const int tid = omp_get_thread_num();
+        const int nth = omp_get_num_threads();
+        os_thread_ws_t *w = &tws[tid];
+
+        const size_t b0 = n_blocks * (size_t)tid / (size_t)nth;
+        const size_t b1 = n_blocks * (size_t)(tid + 1) / (size_t)nth;
+        const size_t o0 = b0 * step;
+        const size_t o1 = (b1 * step < N) ? b1 * step : N;
+
+        /* Halos are captured before any thread starts overwriting the signal */
+        for (int j = 0; j < D; j++) {
+            const ptrdiff_t il = (ptrdiff_t)o0 - D + j;
+            const size_t ir = o1 + (size_t)j;
+            w->halo_l[j] = (il >= 0) ? x[il] : 0.0;
+            w->halo_r[j] = (ir < N) ? x[ir] : 0.0;
+        }
+
+        #pragma omp barrier
+
+        for (size_t b = b0; b < b1; b++) {
+            const size_t o = b * step;
+            const int first = (b == b0);
+            const int last = (b + 1 == b1);
+
+            /* Block input: [o - D, o + step + D) */
+            const double complex *left = first ? w->halo_l : w->carry;
+            for (int j = 0; j < D; j++) w->in[j] = left[j];
+            for (size_t j = 0; j < step; j++) {
+                const size_t i = o + j;
+                w->in[(size_t)D + j] = (i < N) ? x[i] : 0.0;
+            }
+            for (int j = 0; j < D; j++) {
+                const size_t i = o + step + (size_t)j;
+                w->in[(size_t)D + step + (size_t)j] = last ? w->halo_r[j] : ((i < N) ? x[i] : 0.0);
+            }
+
+            /* Original samples [o + step - D, o + step) feed the next block's left edge */
+            for (int j = 0; j < D; j++) w->carry[j] = w->in[step + (size_t)j];
+
+            fftw_execute_dft(fwd, w->in, w->out);
+            os_flatten_oob_peaks(w->out, w->oob_mag, L, df, fi_off, ff_off);
+            for (int k = 0; k < L; k++) w->out[k] *= H[k];
+            fftw_execute_dft(inv, w->out, w->in);
+
+            const size_t n_out = (o + step <= N) ? step : (N - o);
+            for (size_t j = 0; j < n_out; j++) x[o + j] = w->in[(size_t)D + j];
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Filtrado con una única FFT del tamaño de la captura (modo original).
+ */
+static int apply_whole(signal_iq_t *sig, const filter_t *cfg, uint64_t fc_hz, double fs_hz) {
     int N = (int)sig->n_signal;
     if (need_rebuild(N, cfg, fc_hz, fs_hz)) {
         if (build_mask_and_plans(N, cfg, fc_hz, fs_hz) < 0) return -5;
     }
 
+    // The cache is thread-local: parallel loops work on these copies
+    fftw_complex *const in = g.in;
+    fftw_complex *const out = g.out;
+    const double *const mask = g.mask_stage2;
+
     // Load data into FFTW input
     #pragma omp parallel for
     for (int i = 0; i < N; i++) {
-        g.in[i] = sig->signal_iq[i];
+        in[i] = sig->signal_iq[i];
     }
 
     fftw_execute(g.fwd);
@@ -270,8 +596,8 @@ int chan_filter_apply_inplace_abs(
         int ks = (k <= N/2) ? k : (k - N);
         double f = (double)ks * df;
         if (f < fi_off || f > ff_off) {
-            const double re = creal(g.out[k]);
-            const double im = cimag(g.out[k]);
+            const double re = creal(out[k]);
+            const double im = cimag(out[k]);
             g.oob_mag[oob_n++] = sqrt((re * re) + (im * im));
         }
     }
@@ -286,12 +612,12 @@ int chan_filter_apply_inplace_abs(
                 int ks = (k <= N/2) ? k : (k - N);
                 double f = (double)ks * df;
                 if (f < fi_off || f > ff_off) {
-                    const double re = creal(g.out[k]);
-                    const double im = cimag(g.out[k]);
+                    const double re = creal(out[k]);
+                    const double im = cimag(out[k]);
                     double mag = sqrt((re * re) + (im * im));
                     if (mag > cap) {
                         double s = cap / mag;
-                        g.out[k] *= s;
+                        out[k] *= s;
                     }
                 }
             }
@@ -301,7 +627,7 @@ int chan_filter_apply_inplace_abs(
     // Stage 2: Apply frequency mask
     #pragma omp parallel for
     for (int k = 0; k < N; k++) {
-        g.out[k] *= g.mask_stage2[k];
+        out[k] *= mask[k];
     }
 
     fftw_execute(g.inv);
@@ -311,9 +637,45 @@ int chan_filter_apply_inplace_abs(
     
     #pragma omp parallel for
     for (int i = 0; i < N; i++) {
-        sig->signal_iq[i] = g.in[i] * invN;
+        sig->signal_iq[i] = in[i] * invN;
     }
 
     return 0;
 }
+
+int chan_filter_apply_inplace_abs(
+    signal_iq_t *sig,
+    const filter_t *cfg,
+    uint64_t fc_hz,
+    double fs_hz
+) {
+    if (!sig || !sig->signal_iq || sig->n_signal < 2) return -1;
+    
+    char err[256];
+    if (chan_filter_validate_cfg_abs(cfg, fc_hz, fs_hz, err, sizeof(err)) < 0) {
+        return -4;
+    }
+
+    int L, D;
+    os_block_geometry(cfg, fc_hz, fs_hz, &L, &D);
+
+    int use_block = 0;
+    if (cfg->mode == CHAN_FILTER_BLOCK) use_block = 1;
+    else if (cfg->mode == CHAN_FILTER_AUTO) use_block = (sig->n_signal >= (size_t)OS_AUTO_RATIO * (size_t)L);
+
+    if (use_block) {
+        /* Transition band (and Nyquist) boundaries are independent of N */
+        double fi_off = (double)cfg->start_freq_hz - (double)fc_hz;
+        double ff_off = (double)cfg->end_freq_hz - (double)fc_hz;
+        if (ff_off <= 0.0) g_region = "NEGATIVE";
+        else if (fi_off >= 0.0) g_region = "POSITIVE";
+        else g_region = "CROSS_DC";
+
+        /* Release the whole-capture buffers: block mode keeps memory bounded by L */
+        if (g.N != 0) cache_free();
+        return apply_block(sig, cfg, fc_hz, fs_hz, L, D);
+    }
+
+    return apply_whole(sig, cfg, fc_hz, fs_hz);
+}
 /** @} */
@@ -61,6 +61,12 @@ int chan_filter_validate_cfg_abs(
  * atenuación de banda de parada con transiciones suaves (Raised Cosine).
  * 4. **Transformada Inversa:** Retorno al dominio del tiempo (IFFT) con normalización \f$ 1/N \f$.
  *
+ * Con `cfg->mode` en `CHAN_FILTER_BLOCK` (o `CHAN_FILTER_AUTO` y una captura de al menos
+ * 4 bloques) el mismo flujo se aplica por bloques overlap-save de tamaño fijo L, derivado
+ * del ancho de transición: la Etapa 2 se realiza como un kernel FIR de 2D + 1 taps diseñado
+ * sobre la misma máscara, y la Etapa 1 usa la mediana OOB de cada bloque. La memoria queda
+ * acotada por L y los bloques se reparten entre los hilos OpenMP.
+ *
  * @param[in,out] sig    Señal IQ de entrada/salida.
  * @param[in]     cfg    Definición de la banda de paso.
  * @param[in]     fc_hz  Frecuencia central (Hz).
@@ -87,8 +93,8 @@ const char* chan_filter_last_region(void);
 /**
  * @brief Libera los planes FFTW y buffers de máscara precalculados.
  *
- * Debe invocarse antes de cerrar la aplicación para limpiar la caché global
- * de la biblioteca.
+ * La caché es por hilo (un motor de rf_app por radio): cada hilo que filtra debe
+ * invocarla antes de terminar para liberar la suya.
  */
 void chan_filter_free_cache(void);
 
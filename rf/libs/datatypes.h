@@ -28,6 +28,8 @@
  * @{
  */
 
+#define RF_CAL_MAX_REFS 64 /**< Máximo de portadoras de referencia para la calibración rápida. */
+
 /**
  * @brief Estructura para el manejo de señales en cuadratura (IQ).
  */
@@ -36,6 +38,22 @@ typedef struct {
     size_t n_signal;          /**< Número total de muestras en el buffer. */
 } signal_iq_t;
 
+/**
+ * @brief Señal IQ en precisión simple (8 bytes por muestra en lugar de 16).
+ */
+typedef struct {
+    float _Complex* signal_iq; /**< Puntero al buffer de muestras complejas float32. */
+    size_t n_signal;           /**< Número total de muestras en el buffer. */
+} signal_iq_f32_t;
+
+/**
+ * @brief Precisión numérica de la ruta IQ → PSD.
+ */
+typedef enum {
+    IQ_PRECISION_F64, /**< double complex + FFTW doble precisión. */
+    IQ_PRECISION_F32  /**< float complex + FFTW precisión simple (fftwf). */
+} iq_precision_t;
+
 /**
  * @brief Tipos de ventanas de suavizado para el procesamiento espectral.
  */
@@ -58,14 +76,46 @@ typedef enum {
     PFB    /**< Polyphase Filter Bank (Banco de filtros polifase). */
 } Psd_method;
 
+/**
+ * @brief Reducción de bins de salida (en potencia lineal, antes de pasar a dBm).
+ */
+typedef enum {
+    PSD_POOL_MAX = 0, /**< Máximo por grupo de bins: conserva picos angostos. */
+    PSD_POOL_MEAN     /**< Media por grupo de bins: conserva la densidad promedio. */
+} psd_pool_t;
+
+/**
+ * @brief Recorte y reducción de la PSD entregada por los estimadores.
+ * @details Con todos los campos en 0 la salida son los `nperseg` bins completos.
+ */
+typedef struct {
+    int bin_lo;      /**< Primer bin conservado (índice tras el fftshift). */
+    int n_bins;      /**< Bins conservados desde @ref bin_lo (0 = todos). */
+    int out_bins;    /**< Bins de salida tras el pooling (0 = sin reducir). */
+    psd_pool_t pool; /**< Operador de pooling. */
+} psd_output_t;
+
+/**
+ * @brief Plan del modo zoom (conversión descendente + diezmado antes del estimador).
+ * @details Con @ref decim en 0 el estimador recibe la captura a la tasa del hardware.
+ */
+typedef struct {
+    int decim;       /**< Factor de diezmado D (0 = sin zoom). */
+    double fs_in;    /**< Tasa de la captura antes del diezmado (Hz). */
+    double shift_hz; /**< Centro de la banda respecto de la portadora nominal (desplaza el eje publicado). */
+    double nco_hz;   /**< Desplazamiento del NCO respecto de la portadora corregida por PPM. */
+} psd_zoom_t;
+
 /**
  * @brief Configuración de parámetros para el algoritmo PSD.
  */
 typedef struct {
     PsdWindowType_t window_type; /**< Tipo de ventana a aplicar. */
-    double sample_rate;          /**< Frecuencia de muestreo del hardware (Hz). */
+    double sample_rate;          /**< Frecuencia de muestreo de la señal del estimador (la del hardware, o f_s/D con zoom). */
     int nperseg;                 /**< Número de muestras por segmento. */
     int noverlap;                /**< Número de muestras solapadas entre segmentos. */
+    psd_output_t out;            /**< Recorte/reducción de la salida (ver @ref psd_output_bins). */
+    psd_zoom_t zoom;             /**< Conversión descendente previa al estimador (ver @ref iq_zoom_run). */
 } PsdConfig_t;
 
 /**
@@ -76,14 +126,57 @@ typedef struct {
     int rb_size;        /**< Número de elementos en el ring buffer. */
 } RB_cfg_t;
 
+/**
+ * @brief Estrategia de ejecución del filtro de canal.
+ */
+typedef enum {
+    CHAN_FILTER_AUTO = 0, /**< Bloques overlap-save si la captura es grande frente al bloque; si no, FFT completa. */
+    CHAN_FILTER_WHOLE,    /**< Una FFT del tamaño de toda la captura (comportamiento original). */
+    CHAN_FILTER_BLOCK     /**< Overlap-save con FFT de tamaño fijo derivado de la transición. */
+} chan_filter_mode_t;
+
 /**
  * @brief Configuración de límites de frecuencia para filtrado digital.
  */
 typedef struct {
-    int start_freq_hz; /**< Frecuencia de corte inferior (Hz). */
-    int end_freq_hz;   /**< Frecuencia de corte superior (Hz). */
+    int start_freq_hz;       /**< Frecuencia de corte inferior (Hz). */
+    int end_freq_hz;         /**< Frecuencia de corte superior (Hz). */
+    chan_filter_mode_t mode; /**< Estrategia de ejecución (por defecto AUTO). */
 } filter_t;
 
+/**
+ * @brief Detección on-device sobre la PSD (piso de ruido, ocupación por canal y picos).
+ */
+typedef struct {
+    bool enabled;          /**< Agrega el objeto "detect" al reply. */
+    bool only;             /**< Responde solo "detect", sin el arreglo `Pxx`. */
+    double threshold_db;   /**< Umbral de ocupación sobre el piso de ruido (dB). */
+    int max_peaks;         /**< Picos a reportar (top-N). */
+    double min_spacing_hz; /**< Separación mínima entre picos (0 = derivada del span). */
+    uint64_t chan_start_hz; /**< Inicio del primer canal (0 = inicio del span). */
+    double chan_width_hz;  /**< Ancho de canal del plan (0 = sin plan de canales). */
+    int chan_count;        /**< Canales del plan (0 = cubrir el span). */
+} psd_detect_cfg_t;
+
+/**
+ * @brief Cuantización de las filas del espectrograma.
+ */
+typedef enum {
+    PSD_SPEC_U8 = 0, /**< uint8 sobre un offset dinámico (0.5 dB por paso por defecto). */
+    PSD_SPEC_I16     /**< int16 absoluto (0.01 dB por paso por defecto). */
+} psd_spec_format_t;
+
+/**
+ * @brief Espectrograma: filas de la PSD por grupo de segmentos en lugar de una sola traza.
+ */
+typedef struct {
+    bool enabled;             /**< Agrega el objeto "spectrogram" al reply. */
+    int segments;             /**< Segmentos (Welch) o bloques (PFB) promediados por fila (0 = 1). */
+    int max_rows;             /**< Filas máximas (0 = default); con más segmentos se agrupan más por fila. */
+    psd_spec_format_t format; /**< Cuantización de las filas. */
+    double step_db;           /**< Paso de cuantización en dB (0 = default del formato). */
+} psd_spectrogram_cfg_t;
+
 /**
  * @brief Tipos de filtros de audio disponibles.
  */
@@ -111,6 +204,26 @@ typedef enum {
     AM_MODE   /**< Demodulación de Amplitud. */
 } rf_mode_t;
 
+/**
+ * @brief Formato de serialización del reply PSD enviado por ZMQ.
+ */
+typedef enum {
+    REPLY_FORMAT_JSON, /**< Objeto JSON con arreglo "Pxx" en doble precisión (por defecto). */
+    REPLY_FORMAT_F32,  /**< Multipart binario: cabecera fija + bins dBm en float32. */
+    REPLY_FORMAT_I16   /**< Multipart binario: cabecera fija + bins dBm cuantizados a int16. */
+} reply_format_t;
+
+/**
+ * @brief Modos de promediado de la traza PSD entre requests sucesivos.
+ */
+typedef enum {
+    PSD_AVG_OFF = 0,   /**< Cada reply es la PSD de su propia captura. */
+    PSD_AVG_LINEAR,    /**< Media acumulada en potencia lineal. */
+    PSD_AVG_EXP,       /**< Media exponencial en potencia lineal. */
+    PSD_AVG_MAX_HOLD,  /**< Máximo por bin. */
+    PSD_AVG_MIN_HOLD   /**< Mínimo por bin. */
+} psd_avg_mode_t;
+
 /**
  * @brief Configuración maestra deseada para el hardware y procesamiento.
  */
@@ -118,6 +231,9 @@ typedef struct {
     rf_mode_t rf_mode;      /**< Modo de operación actual. */
     Psd_method method_psd;  /**< Algoritmo PSD seleccionado. */
     bool calibrate;         /**< Solicita ejecutar rutina de calibración sin adquirir. */
+    bool calibrate_force;   /**< `"calibrate": "force"`: recalibra aunque el PPM en caché siga vigente. */
+    int n_cal_refs;         /**< Entradas de @ref cal_refs_hz (0 = `CAL_FM_REFS` o `legal_freqs` del ShmStore). */
+    double cal_refs_hz[RF_CAL_MAX_REFS]; /**< Portadoras FM de referencia (`"cal_refs_hz"`, Hz). */
     
     /** @name Parámetros de Hardware */
     /**@{*/
@@ -134,15 +250,63 @@ typedef struct {
     /**@{*/
     int rbw;                     /**< Resolution Bandwidth (Hz). */
     double overlap;              /**< Porcentaje de solapamiento (0.0 a 1.0). */
+    int target_averages;         /**< Segmentos Welch / bloques PFB que debe promediar la captura (0 = F_s/4 bytes). */
     PsdWindowType_t window_type; /**< Ventana aplicada al PSD. */
     double cooldown_request;     /**< Cooldown entre requests/PSD en segundos. */
     bool cooldown_request_set;   /**< Indica si cooldown_request vino explícitamente en el último JSON. */
+    iq_precision_t iq_precision; /**< Precisión de la ruta IQ/PSD (por defecto según RF_IQ_FLOAT32_DEFAULT). */
+    bool out_crop;               /**< Recorta la salida a la banda de `filter` (solo con filtro activo). */
+    int out_bins;                /**< Bins de salida tras el pooling (0 = todos). */
+    psd_pool_t out_pool;         /**< Pooling de @ref out_bins (max por defecto). */
     /**@}*/
 
     /** @name Bloque de Filtrado */
     /**@{*/
     bool filter_enabled;  /**< Habilitación del filtro digital. */
     filter_t filter_cfg;  /**< Configuración de frecuencias de corte. */
+    bool zoom;            /**< Zoom-FFT: NCO + diezmado de la banda del filtro antes del estimador. */
+    /**@}*/
+
+    /** @name Formato de Respuesta */
+    /**@{*/
+    reply_format_t reply_format; /**< Serialización del reply PSD (JSON por defecto). */
+    /**@}*/
+
+    /** @name Promediado de traza */
+    /**@{*/
+    psd_avg_mode_t avg_mode; /**< Acumulador persistente de la traza entre requests. */
+    int avg_count;           /**< Lineal: capturas antes de pasar a exponencial 1/N; exponencial: α = 1/N (0 = default). */
+    double avg_alpha;        /**< Factor exponencial explícito en (0, 1] (0 = derivar de avg_count). */
+    bool avg_reset;          /**< Reinicia la traza acumulada antes de esta captura. */
+    /**@}*/
+
+    /** @name Modo Streaming */
+    /**@{*/
+    bool stream_enabled;   /**< Publica frames PSD continuos por ZMQ PUB en lugar de un único reply. */
+    double stream_rate_hz; /**< Tasa objetivo de frames (Hz); 0 = tan rápido como permita el DSP. */
+    int stream_frames;     /**< Frames a publicar antes de detenerse; 0 = hasta el próximo request. */
+    bool stream_pipeline;  /**< Serializa y envía el frame N-1 en un hilo aparte mientras se calcula el frame N. */
+    /**@}*/
+
+    /** @name Barrido multibanda */
+    /**@{*/
+    bool sweep_enabled;     /**< Request de barrido: rf_app salta el HackRF y une los segmentos en un solo espectro. */
+    uint64_t sweep_start_hz; /**< Frecuencia inicial del barrido (Hz). */
+    uint64_t sweep_end_hz;   /**< Frecuencia final del barrido (Hz). */
+    /**@}*/
+
+    /** @name Instrumentación */
+    /**@{*/
+    bool metrics_enabled;  /**< Agrega el objeto "metrics" (tiempos por etapa) al reply JSON. */
+    bool stats_request;    /**< Request de solo lectura de acumulados (`"stats"`), sin adquirir. */
+    bool stats_reset;      /**< Reinicia los acumulados tras responder (`"stats": "reset"`). */
+    bool record;           /**< Graba la captura IQ del request como SigMF (`"record": true`). */
+    /**@}*/
+
+    /** @name Detección y espectrograma */
+    /**@{*/
+    psd_detect_cfg_t detect; /**< Piso de ruido, ocupación y picos calculados en el sensor. */
+    psd_spectrogram_cfg_t spectrogram; /**< Filas tiempo-frecuencia cuantizadas y comprimidas. */
     /**@}*/
 } DesiredCfg_t;
 
@@ -0,0 +1,234 @@
+/**
+ * @file fft_wisdom.c
+ * @brief Implementación de la caché persistente de wisdom FFTW.
+ */
+#include "fft_wisdom.h"
+#include "utils.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FFT_WISDOM_FILE_F64 "fftw_wisdom.dat"
+#define FFT_WISDOM_FILE_F32 "fftwf_wisdom.dat"
+
+/** @brief Flags usados al consultar el wisdom: cualquier plan medido igual o más riguroso sirve. */
+#define FFT_WISDOM_QUERY_FLAGS (FFTW_MEASURE | FFTW_WISDOM_ONLY)
+
+static const int default_sizes[] = {
+    256, 512, 1024, 2048, 4096, 8192, 16384, 32768, 65536, 131072
+};
+
+/**
+ * @addtogroup fft_wisdom_module
+ * @{
+ */
+
+/** @brief Serializa los planners double y float32: rf_app puede planear desde varios motores. */
+static pthread_mutex_t g_planner_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void wisdom_path(const char *file, char *out, size_t out_len) {
+    char *dir = getenv_c("FFTW_WISDOM_DIR");
+    snprintf(out, out_len, "%s/%s", dir ? dir : FFT_WISDOM_DEFAULT_DIR, file);
+    free(dir);
+}
+
+int fft_wisdom_load(void) {
+    char path[512];
+    int loaded = 0;
+
+    wisdom_path(FFT_WISDOM_FILE_F64, path, sizeof(path));
+    if (fftw_import_wisdom_from_filename(path)) {
+        printf("[RF] FFTW wisdom loaded: %s\n", path);
+        loaded++;
+    }
+
+    wisdom_path(FFT_WISDOM_FILE_F32, path, sizeof(path));
+    if (fftwf_import_wisdom_from_filename(path)) {
+        printf("[RF] FFTW wisdom loaded: %s\n", path);
+        loaded++;
+    }
+
+    if (loaded == 0) {
+        printf("[RF] No FFTW wisdom found, plans will use FFTW_ESTIMATE.\n");
+    }
+    return loaded;
+}
+
+/**
+ * @brief Exporta a un archivo temporal y lo renombra, para no dejar wisdom truncado
+ * si el proceso muere a mitad de la escritura.
+ */
+static int export_atomic(const char *path, int is_f32) {
+    char tmp[520];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    int ok = is_f32 ? fftwf_export_wisdom_to_filename(tmp)
+                    : fftw_export_wisdom_to_filename(tmp);
+    if (!ok || rename(tmp, path) != 0) {
+        fprintf(stderr, "[RF] Error: Could not write FFTW wisdom to %s\n", path);
+        remove(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+static fftw_plan plan_many_f64(int n, int howmany, fftw_complex *in, fftw_complex *out, int sign, unsigned flags) {
+    return fftw_plan_many_dft(1, &n, howmany, in, NULL, 1, n, out, NULL, 1, n, sign, flags);
+}
+
+static fftwf_plan plan_many_f32(int n, int howmany, fftwf_complex *in, fftwf_complex *out, int sign, unsigned flags) {
+    return fftwf_plan_many_dft(1, &n, howmany, in, NULL, 1, n, out, NULL, 1, n, sign, flags);
+}
+
+int fft_wisdom_generate(const int *sizes, size_t n_sizes, int patient) {
+    if (!sizes || n_sizes == 0) {
+        sizes = default_sizes;
+        n_sizes = sizeof(default_sizes) / sizeof(default_sizes[0]);
+    }
+
+    const unsigned flags = patient ? FFTW_PATIENT : FFTW_MEASURE;
+
+    /* Keep whatever was measured before so sizes accumulate across runs */
+    fft_wisdom_load();
+
+    for (size_t k = 0; k < n_sizes; k++) {
+        const int n = sizes[k];
+        if (n < 2) continue;
+
+        printf("[RF] Measuring FFT plans N=%d (%s)...\n", n, patient ? "FFTW_PATIENT" : "FFTW_MEASURE");
+
+        fftw_complex *in  = fftw_malloc(sizeof(fftw_complex) * (size_t)n);
+        fftw_complex *out = fftw_malloc(sizeof(fftw_complex) * (size_t)n);
+        fftwf_complex *inf  = fftwf_malloc(sizeof(fftwf_complex) * (size_t)n);
+        fftwf_complex *outf = fftwf_malloc(sizeof(fftwf_complex) * (size_t)n);
+
+        if (in && out && inf && outf) {
+            /* Both directions: Welch/PFB use forward, the channel filter also inverse */
+            const int signs[2] = { FFTW_FORWARD, FFTW_BACKWARD };
+            for (int s = 0; s < 2; s++) {
+                fftw_plan p = fftw_plan_dft_1d(n, in, out, signs[s], flags);
+                if (p) fftw_destroy_plan(p);
+                fftwf_plan pf = fftwf_plan_dft_1d(n, inf, outf, signs[s], flags);
+                if (pf) fftwf_destroy_plan(pf);
+            }
+        } else {
+            fprintf(stderr, "[RF] Error: Allocation failed for N=%d, skipping.\n", n);
+        }
+
+        fftw_free(in);
+        fftw_free(out);
+        fftwf_free(inf);
+        fftwf_free(outf);
+
+        /* Batched forward plans used by the Welch/PFB engines */
+        const int k = fft_wisdom_batch_size(n);
+        if (k > 1) {
+            const size_t len = (size_t)n * (size_t)k;
+            in  = fftw_malloc(sizeof(fftw_complex) * len);
+            out = fftw_malloc(sizeof(fftw_complex) * len);
+            inf  = fftwf_malloc(sizeof(fftwf_complex) * len);
+            outf = fftwf_malloc(sizeof(fftwf_complex) * len);
+            if (in && out && inf && outf) {
+                fftw_plan p = plan_many_f64(n, k, in, out, FFTW_FORWARD, flags);
+                if (p) fftw_destroy_plan(p);
+                fftwf_plan pf = plan_many_f32(n, k, inf, outf, FFTW_FORWARD, flags);
+                if (pf) fftwf_destroy_plan(pf);
+            }
+            fftw_free(in);
+            fftw_free(out);
+            fftwf_free(inf);
+            fftwf_free(outf);
+        }
+    }
+
+    char path[512];
+    int rc = 0;
+
+    wisdom_path(FFT_WISDOM_FILE_F64, path, sizeof(path));
+    if (export_atomic(path, 0) == 0) printf("[RF] FFTW wisdom saved: %s\n", path);
+    else rc = -1;
+
+    wisdom_path(FFT_WISDOM_FILE_F32, path, sizeof(path));
+    if (export_atomic(path, 1) == 0) printf("[RF] FFTW wisdom saved: %s\n", path);
+    else rc = -1;
+
+    return rc;
+}
+
+static fftw_plan plan_1d_f64(int n, fftw_complex *in, fftw_complex *out, int sign) {
+    fftw_plan p = fftw_plan_dft_1d(n, in, out, sign, FFT_WISDOM_QUERY_FLAGS);
+    if (!p) p = fftw_plan_dft_1d(n, in, out, sign, FFTW_ESTIMATE);
+    return p;
+}
+
+static fftwf_plan plan_1d_f32(int n, fftwf_complex *in, fftwf_complex *out, int sign) {
+    fftwf_plan p = fftwf_plan_dft_1d(n, in, out, sign, FFT_WISDOM_QUERY_FLAGS);
+    if (!p) p = fftwf_plan_dft_1d(n, in, out, sign, FFTW_ESTIMATE);
+    return p;
+}
+
+fftw_plan fft_wisdom_plan_dft_1d(int n, fftw_complex *in, fftw_complex *out, int sign) {
+    pthread_mutex_lock(&g_planner_lock);
+    fftw_plan p = plan_1d_f64(n, in, out, sign);
+    pthread_mutex_unlock(&g_planner_lock);
+    return p;
+}
+
+fftwf_plan fft_wisdom_plan_dft_1d_f32(int n, fftwf_complex *in, fftwf_complex *out, int sign) {
+    pthread_mutex_lock(&g_planner_lock);
+    fftwf_plan p = plan_1d_f32(n, in, out, sign);
+    pthread_mutex_unlock(&g_planner_lock);
+    return p;
+}
+
+int fft_wisdom_batch_size(int n) {
+    if (n <= 0) return 1;
+    int k = FFT_WISDOM_BATCH_POINTS / n;
+    if (k < 1) k = 1;
+    if (k > FFT_WISDOM_BATCH_MAX) k = FFT_WISDOM_BATCH_MAX;
+    return k;
+}
+
+fftw_plan fft_wisdom_plan_many_dft(int n, int howmany, fftw_complex *in, fftw_complex *out, int sign) {
+    pthread_mutex_lock(&g_planner_lock);
+    fftw_plan p = NULL;
+    if (howmany <= 1) {
+        p = plan_1d_f64(n, in, out, sign);
+    } else {
+        p = plan_many_f64(n, howmany, in, out, sign, FFT_WISDOM_QUERY_FLAGS);
+        if (!p) p = plan_many_f64(n, howmany, in, out, sign, FFTW_ESTIMATE);
+    }
+    pthread_mutex_unlock(&g_planner_lock);
+    return p;
+}
+
+fftwf_plan fft_wisdom_plan_many_dft_f32(int n, int howmany, fftwf_complex *in, fftwf_complex *out, int sign) {
+    pthread_mutex_lock(&g_planner_lock);
+    fftwf_plan p = NULL;
+    if (howmany <= 1) {
+        p = plan_1d_f32(n, in, out, sign);
+    } else {
+        p = plan_many_f32(n, howmany, in, out, sign, FFT_WISDOM_QUERY_FLAGS);
+        if (!p) p = plan_many_f32(n, howmany, in, out, sign, FFTW_ESTIMATE);
+    }
+    pthread_mutex_unlock(&g_planner_lock);
+    return p;
+}
+
+void fft_wisdom_destroy_plan(fftw_plan p) {
+    if (!p) return;
+    pthread_mutex_lock(&g_planner_lock);
+    fftw_destroy_plan(p);
+    pthread_mutex_unlock(&g_planner_lock);
+}
+
+void fft_wisdom_destroy_plan_f32(fftwf_plan p) {
+    if (!p) return;
+    pthread_mutex_lock(&g_planner_lock);
+    fftwf_destroy_plan(p);
+    pthread_mutex_unlock(&g_planner_lock);
+}
+
+/** @} */
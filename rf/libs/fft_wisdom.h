@@ -0,0 +1,116 @@
+/**
+ * @file fft_wisdom.h
+ * @brief Caché persistente de "wisdom" FFTW para planes medidos entre reinicios.
+ *
+ * Los motores Welch/PFB y el filtro de canal crean sus planes con este módulo.
+ * Si existe wisdom para el tamaño pedido (generado offline con `FFTW_MEASURE` o
+ * `FFTW_PATIENT`), el plan medido se reconstruye sin costo de medición; si no,
+ * se usa `FFTW_ESTIMATE` como antes.
+ *
+ * Los archivos viven junto a `json/persistent.json`: `json/fftw_wisdom.dat`
+ * (double) y `json/fftwf_wisdom.dat` (float32). El directorio puede cambiarse
+ * con la variable `FFTW_WISDOM_DIR` del `.env`.
+ */
+
+#ifndef FFT_WISDOM_H
+#define FFT_WISDOM_H
+
+#include <stddef.h>
+#include <complex.h>
+#include <fftw3.h>
+
+/**
+ * @defgroup fft_wisdom_module FFT Wisdom
+ * @ingroup rf_binary
+ * @brief Carga, generación offline y uso de wisdom FFTW.
+ * @{
+ */
+
+/** @brief Directorio por defecto de los archivos de wisdom (relativo a la raíz del proyecto). */
+#define FFT_WISDOM_DEFAULT_DIR "json"
+
+/** @brief Puntos objetivo por ejecución (K·n) de los planes batched de Welch/PFB. */
+#define FFT_WISDOM_BATCH_POINTS 16384
+
+/** @brief Máximo de transformadas por plan batched. */
+#define FFT_WISDOM_BATCH_MAX 64
+
+/**
+ * @brief Importa el wisdom double y float32 desde disco. Llamar una vez al arrancar,
+ * antes de crear cualquier plan.
+ * @return Número de archivos importados (0, 1 o 2). Un archivo ausente no es error.
+ */
+int fft_wisdom_load(void);
+
+/**
+ * @brief Genera wisdom medido para los tamaños dados y lo guarda en disco (modo offline).
+ * @param sizes Tamaños de FFT a medir (p. ej. los nperseg de las campañas).
+ * @param n_sizes Número de tamaños. Si es 0 se usan las potencias de 2 de 256 a 131072.
+ * @param patient Si es distinto de 0 usa `FFTW_PATIENT`; si no, `FFTW_MEASURE`.
+ * @return 0 en éxito, -1 si no se pudo escribir alguno de los archivos.
+ */
+int fft_wisdom_generate(const int *sizes, size_t n_sizes, int patient);
+
+/**
+ * @brief Crea un plan 1D complejo double usando wisdom si existe, o `FFTW_ESTIMATE` si no.
+ * @note Thread-safe: los planners de todo rf_app se serializan con un mutex del módulo.
+ * @param n Tamaño de la FFT.
+ * @param in Buffer de entrada (alineado con fftw_malloc).
+ * @param out Buffer de salida (alineado con fftw_malloc).
+ * @param sign `FFTW_FORWARD` o `FFTW_BACKWARD`.
+ * @return Plan creado o NULL.
+ */
+fftw_plan fft_wisdom_plan_dft_1d(int n, fftw_complex *in, fftw_complex *out, int sign);
+
+/**
+ * @brief Variante float32 (fftwf) de @ref fft_wisdom_plan_dft_1d.
+ * @param n Tamaño de la FFT.
+ * @param in Buffer de entrada (alineado con fftwf_malloc).
+ * @param out Buffer de salida (alineado con fftwf_malloc).
+ * @param sign `FFTW_FORWARD` o `FFTW_BACKWARD`.
+ * @return Plan creado o NULL.
+ */
+fftwf_plan fft_wisdom_plan_dft_1d_f32(int n, fftwf_complex *in, fftwf_complex *out, int sign);
+
+/**
+ * @brief Número de transformadas que los motores PSD agrupan por `fftw_execute` para tamaño @p n.
+ * @details \f$ K = \min(64, \max(1, 16384 / n)) \f$: nperseg pequeños (256-4096) amortizan
+ * el scheduling OpenMP por segmento; a partir de 16384 puntos K = 1.
+ * @param n Tamaño de la FFT.
+ * @return K >= 1.
+ */
+int fft_wisdom_batch_size(int n);
+
+/**
+ * @brief Crea un plan de @p howmany FFTs contiguas de tamaño @p n (`fftw_plan_many_dft`,
+ * distancia n, stride 1) usando wisdom si existe, o `FFTW_ESTIMATE` si no.
+ * @note Thread-safe como @ref fft_wisdom_plan_dft_1d. Con @p howmany = 1 equivale a
+ * @ref fft_wisdom_plan_dft_1d.
+ * @param n Tamaño de cada FFT.
+ * @param howmany Transformadas por ejecución.
+ * @param in Buffer de entrada de n·howmany muestras (alineado con fftw_malloc).
+ * @param out Buffer de salida de n·howmany muestras (alineado con fftw_malloc).
+ * @param sign `FFTW_FORWARD` o `FFTW_BACKWARD`.
+ * @return Plan creado o NULL.
+ */
+fftw_plan fft_wisdom_plan_many_dft(int n, int howmany, fftw_complex *in, fftw_complex *out, int sign);
+
+/**
+ * @brief Variante float32 (fftwf) de @ref fft_wisdom_plan_many_dft.
+ */
+fftwf_plan fft_wisdom_plan_many_dft_f32(int n, int howmany, fftwf_complex *in, fftwf_complex *out, int sign);
+
+/**
+ * @brief Destruye un plan bajo el mismo mutex que los planners (`fftw_destroy_plan` tampoco es thread-safe).
+ * @param p Plan (NULL = sin efecto).
+ */
+void fft_wisdom_destroy_plan(fftw_plan p);
+
+/**
+ * @brief Variante float32 (fftwf) de @ref fft_wisdom_destroy_plan.
+ */
+void fft_wisdom_destroy_plan_f32(fftwf_plan p);
+
+/** @} */
+
+#endif
@@ -0,0 +1,184 @@
+/**
+ * @file fm_cal.c
+ * @brief Implementación de las candidatas Goertzel y del NCO por bloques de la calibración.
+ */
+#include "fm_cal.h"
+#include "psd_detect.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @addtogroup fm_cal_module
+ * @{
+ */
+
+/** Muestras por bloque del NCO: la fase se reancla con cexp al inicio de cada bloque. */
+#define FM_CAL_NCO_BLOCK 1024
+
+#define FM_CAL_CHAN_BINS 5                        /**< Bins dentro del canal de cada portadora. */
+#define FM_CAL_BINS_PER_REF (FM_CAL_CHAN_BINS + 2) /**< Canal + dos guardas. */
+
+static const double k_chan_off_hz[FM_CAL_CHAN_BINS] = { -50000.0, -25000.0, 0.0, 25000.0, 50000.0 };
+static const double k_guard_off_hz = 150000.0;
+
+int fm_cal_parse_refs(const char *s, double *out, int max) {
+    if (!s || !out || max <= 0) return 0;
+    int n = 0;
+    while (*s && n < max) {
+        char *end = NULL;
+        const double v = strtod(s, &end);
+        if (end == s) {
+            s++; // separator or junk
+            continue;
+        }
+        s = end;
+        if (!(v > 0.0)) continue;
+        out[n++] = (v < 10000.0) ? v * 1e6 : v;
+    }
+    return n;
+}
+
+double fm_cal_goertzel_power(const double complex *x, const double *win, size_t n, double f_norm) {
+    if (!x || n == 0) return 0.0;
+    const double w = 2.0 * M_PI * f_norm;
+    const double c = cos(w), s = sin(w);
+    const double coeff = 2.0 * c;
+    const double *xs = (const double*)x;
+
+    // The real recurrence is linear, so I and Q run through it independently
+    double s1r = 0.0, s2r = 0.0, s1i = 0.0, s2i = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        const double g = win ? win[i] : 1.0;
+        const double s0r = g * xs[2 * i]     + coeff * s1r - s2r;
+        const double s0i = g * xs[2 * i + 1] + coeff * s1i - s2i;
+        s2r = s1r;
+        s1r = s0r;
+        s2i = s1i;
+        s1i = s0i;
+    }
+
+    // |X| = |s[N-1] - e^{-jw} s[N-2]|
+    const double re = s1r - (c * s2r + s * s2i);
+    const double im = s1i - (c * s2i - s * s2r);
+    return re * re + im * im;
+}
+
+int fm_cal_rank_refs(const signal_iq_t *sig, double fs, double fc_hz, const double *refs_hz, int n_refs,
+                     double min_snr_db, int max_out, fm_cal_cand_t *out) {
+    if (!sig || !sig->signal_iq || !refs_hz || !out || n_refs <= 0 || max_out <= 0 || !(fs > 0.0)) return 0;
+    if (n_refs > RF_CAL_MAX_REFS) n_refs = RF_CAL_MAX_REFS;
+
+    const size_t avail = sig->n_signal / FM_CAL_BLOCK;
+    if (avail == 0) return 0;
+    const size_t n_blocks = (avail < FM_CAL_BLOCKS) ? avail : FM_CAL_BLOCKS;
+    // Spread the blocks over the capture so programme audio averages out
+    const size_t stride = (n_blocks > 1) ? (sig->n_signal - FM_CAL_BLOCK) / (n_blocks - 1) : 0;
+
+    double offs[RF_CAL_MAX_REFS];
+    int n_in = 0;
+    const double edge = 0.45 * fs - k_guard_off_hz;
+    for (int r = 0; r < n_refs; r++) {
+        const double off = refs_hz[r] - fc_hz;
+        if (fabs(off) <= edge && fabs(off) >= FM_CAL_DC_GUARD_HZ) offs[n_in++] = off;
+    }
+    if (n_in == 0) return 0;
+
+    double win[FM_CAL_BLOCK];
+    for (int i = 0; i < FM_CAL_BLOCK; i++) {
+        win[i] = 0.5 - 0.5 * cos(2.0 * M_PI * (double)i / (double)(FM_CAL_BLOCK - 1));
+    }
+
+    double pw[RF_CAL_MAX_REFS * FM_CAL_BINS_PER_REF];
+    const int n_bins = n_in * FM_CAL_BINS_PER_REF;
+    const double complex *x = sig->signal_iq;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int b = 0; b < n_bins; b++) {
+        const int r = b / FM_CAL_BINS_PER_REF;
+        const int k = b % FM_CAL_BINS_PER_REF;
+        const double f = offs[r] + ((k < FM_CAL_CHAN_BINS) ? k_chan_off_hz[k]
+                                                           : ((k == FM_CAL_CHAN_BINS) ? -k_guard_off_hz : k_guard_off_hz));
+        double acc = 0.0;
+        for (size_t m = 0; m < n_blocks; m++) {
+            acc += fm_cal_goertzel_power(x + m * stride, win, FM_CAL_BLOCK, f / fs);
+        }
+        pw[b] = acc / (double)n_blocks;
+    }
+
+    // Noise floor over the guard bins only: with most listed stations on air the channel bins
+    // sit at carrier level and would drag the median up to it
+    double sel[RF_CAL_MAX_REFS * 2];
+    int n_sel = 0;
+    for (int r = 0; r < n_in; r++) {
+        sel[n_sel++] = pw[r * FM_CAL_BINS_PER_REF + FM_CAL_CHAN_BINS];
+        sel[n_sel++] = pw[r * FM_CAL_BINS_PER_REF + FM_CAL_CHAN_BINS + 1];
+    }
+    double floor_lin = psd_detect_median(sel, n_sel);
+    if (!(floor_lin > 1e-30)) floor_lin = 1e-30;
+
+    int n_out = 0;
+    for (int r = 0; r < n_in; r++) {
+        double chan = 0.0;
+        for (int k = 0; k < FM_CAL_CHAN_BINS; k++) chan += pw[r * FM_CAL_BINS_PER_REF + k];
+        chan /= (double)FM_CAL_CHAN_BINS;
+        if (!(chan > 0.0)) continue;
+
+        const fm_cal_cand_t c = { offs[r], 10.0 * log10(chan), 10.0 * log10(chan / floor_lin) };
+        if (c.snr_db < min_snr_db) continue;
+
+        // Insertion into the descending top-N
+        int pos = (n_out < max_out) ? n_out : max_out;
+        while (pos > 0 && out[pos - 1].power_db < c.power_db) pos--;
+        if (pos >= max_out) continue;
+        const int last = (n_out < max_out) ? n_out : max_out - 1;
+        memmove(&out[pos + 1], &out[pos], (size_t)(last - pos) * sizeof(out[0]));
+        out[pos] = c;
+        if (n_out < max_out) n_out++;
+    }
+    return n_out;
+}
+
+void fm_cal_mix(const double complex *in, double complex *out, size_t n, double offset_hz, double fs) {
+    if (!in || !out || n == 0 || !(fs > 0.0)) return;
+    const double w = 2.0 * M_PI * offset_hz / fs;
+    const double complex step = cexp(-I * w);
+    const long n_blocks = (long)((n + FM_CAL_NCO_BLOCK - 1) / FM_CAL_NCO_BLOCK);
+
+    #pragma omp parallel for schedule(static)
+    for (long b = 0; b < n_blocks; b++) {
+        const size_t n0 = (size_t)b * FM_CAL_NCO_BLOCK;
+        size_t n1 = n0 + FM_CAL_NCO_BLOCK;
+        if (n1 > n) n1 = n;
+        double complex ph = cexp(-I * fmod(w * (double)n0, 2.0 * M_PI));
+        for (size_t i = n0; i < n1; i++) {
+            out[i] = in[i] * ph;
+            ph *= step;
+        }
+    }
+}
+
+size_t fm_cal_mix_decimate(const double complex *in, size_t n, double offset_hz, double fs, int decim,
+                           double complex *out) {
+    if (!in || !out || decim < 1 || !(fs > 0.0)) return 0;
+    const size_t n_out = n / (size_t)decim;
+    const double w = 2.0 * M_PI * offset_hz / fs;
+    const double complex step = cexp(-I * w);
+    const double inv = 1.0 / (double)decim;
+
+    #pragma omp parallel for schedule(static)
+    for (long m = 0; m < (long)n_out; m++) {
+        const size_t n0 = (size_t)m * (size_t)decim;
+        double complex ph = cexp(-I * fmod(w * (double)n0, 2.0 * M_PI));
+        double complex acc = 0.0;
+        for (int k = 0; k < decim; k++) {
+            acc += in[n0 + (size_t)k] * ph;
+            ph *= step;
+        }
+        out[m] = acc * inv;
+    }
+    return n_out;
+}
+
+/** @} */
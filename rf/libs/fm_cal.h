@@ -0,0 +1,107 @@
+/**
+ * @file fm_cal.h
+ * @brief Kernels de la calibración rápida de PPM sobre portadoras FM de referencia.
+ *
+ * La calibración completa estima una PSD Welch de 65536 puntos sobre toda la captura solo
+ * para elegir candidatas. Con una lista de portadoras conocidas (emisoras FM legales de la
+ * zona, como en `tools/kal_sync_legal_FM.py`) basta evaluar unos pocos bins por emisora:
+ *   - Goertzel complejo por bloques de @ref FM_CAL_BLOCK muestras con ventana Hann,
+ *     promediado en potencia, en la portadora y a ±25/±50 kHz (potencia de canal) y a
+ *     ±150 kHz (guardas).
+ *   - Piso de ruido: mediana de todos los bins evaluados (@ref psd_detect_median).
+ *
+ * La validación por piloto y el ajuste fino usan además un NCO por bloques (una `cexp` por
+ * bloque y recurrencia dentro de él) en lugar de `cos`/`sin` por muestra.
+ */
+
+#ifndef FM_CAL_H
+#define FM_CAL_H
+
+#include <stddef.h>
+#include <complex.h>
+#include "datatypes.h"
+
+/**
+ * @defgroup fm_cal_module FM Calibration
+ * @ingroup rf_binary
+ * @brief Candidatas de calibración por Goertzel y mezcla a banda base.
+ * @{
+ */
+
+#define FM_CAL_BLOCK     2048   /**< Muestras por bloque Goertzel (~10 kHz de bin a 20 MS/s). */
+#define FM_CAL_BLOCKS    128    /**< Bloques promediados, repartidos a lo largo de la captura. */
+#define FM_CAL_DC_GUARD_HZ 50000.0 /**< Portadoras más cerca de DC se descartan (residuo del LO). */
+
+/**
+ * @brief Candidata de calibración.
+ */
+typedef struct {
+    double offset_hz; /**< Portadora respecto a la frecuencia sintonizada (Hz). */
+    double power_db;  /**< Potencia media del canal (dB, escala relativa). */
+    double snr_db;    /**< Potencia del canal sobre el piso estimado (dB). */
+} fm_cal_cand_t;
+
+/**
+ * @brief Lee una lista de portadoras separada por comas, espacios o punto y coma.
+ * @details Valores menores que 10000 se interpretan en MHz (`"88.9,91.9"`), el resto en Hz.
+ * @param s Texto (NULL = lista vacía).
+ * @param[out] out Frecuencias en Hz.
+ * @param max Capacidad de @p out.
+ * @return Frecuencias escritas.
+ */
+int fm_cal_parse_refs(const char *s, double *out, int max);
+
+/**
+ * @brief Potencia de un bin DFT arbitrario por Goertzel sobre entrada compleja.
+ * @param x Muestras.
+ * @param win Ventana de @p n coeficientes (NULL = rectangular).
+ * @param n Muestras del bloque.
+ * @param f_norm Frecuencia normalizada (ciclos/muestra, signo incluido).
+ * @return \f$ |X(f)|^2 \f$.
+ */
+double fm_cal_goertzel_power(const double complex *x, const double *win, size_t n, double f_norm);
+
+/**
+ * @brief Ordena por potencia las portadoras de referencia presentes en la captura.
+ * @details Solo evalúa las referencias dentro de ±0.45 @p fs (menos el ancho del canal) y fuera
+ * de @ref FM_CAL_DC_GUARD_HZ. El piso es la mediana de las guardas a ±150 kHz de cada referencia,
+ * no de los bins de canal. Los bins se reparten entre el equipo OpenMP; no reserva memoria.
+ * @param sig Captura (IQ compensada).
+ * @param fs Tasa de muestreo (Hz).
+ * @param fc_hz Frecuencia sintonizada (Hz).
+ * @param refs_hz Portadoras absolutas (Hz).
+ * @param n_refs Entradas de @p refs_hz (se usan hasta @ref RF_CAL_MAX_REFS).
+ * @param min_snr_db Relación mínima canal/piso para aceptar una portadora.
+ * @param max_out Capacidad de @p out.
+ * @param[out] out Candidatas en orden descendente de potencia.
+ * @return Candidatas escritas (0 si ninguna referencia supera el umbral).
+ */
+int fm_cal_rank_refs(const signal_iq_t *sig, double fs, double fc_hz, const double *refs_hz, int n_refs,
+                     double min_snr_db, int max_out, fm_cal_cand_t *out);
+
+/**
+ * @brief Desplaza @p offset_hz a 0 Hz: \f$ y[n] = x[n] \, e^{-j 2\pi f n / f_s} \f$.
+ * @param in Entrada.
+ * @param[out] out Salida (puede ser @p in).
+ * @param n Muestras.
+ * @param offset_hz Frecuencia a centrar (Hz).
+ * @param fs Tasa de muestreo (Hz).
+ */
+void fm_cal_mix(const double complex *in, double complex *out, size_t n, double offset_hz, double fs);
+
+/**
+ * @brief Mezcla a banda base y promedia cada @p decim muestras (boxcar).
+ * @param in Entrada.
+ * @param n Muestras de entrada.
+ * @param offset_hz Frecuencia a centrar (Hz).
+ * @param fs Tasa de muestreo (Hz).
+ * @param decim Factor de diezmado (>= 1).
+ * @param[out] out Salida (capacidad >= @p n / @p decim).
+ * @return Muestras escritas.
+ */
+size_t fm_cal_mix_decimate(const double complex *in, size_t n, double offset_hz, double fs, int decim,
+                           double complex *out);
+
+/** @} */
+
+#endif // FM_CAL_H
@@ -5,11 +5,32 @@
 
 #include "fm_radio.h"
 
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FM_RADIO_NEON 1
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#define FM_RADIO_SSE 1
+#endif
+
 /**
  * @addtogroup fm_module
  * @{
  */
 
+/** @name atan(a) minimax en [0, 1] (error máximo 1.7e-6 rad) */
+/**@{*/
+#define FM_ATAN_C0  0.99997726f
+#define FM_ATAN_C1 -0.33262347f
+#define FM_ATAN_C2  0.19354346f
+#define FM_ATAN_C3 -0.11643287f
+#define FM_ATAN_C4  0.05265332f
+#define FM_ATAN_C5 -0.01172120f
+#define FM_HALF_PI  1.57079632679f
+#define FM_PI       3.14159265359f
+#define FM_TINY     1e-30f          /**< Evita 0/0 cuando la muestra es nula (fase 0). */
+/**@}*/
+
 /**
  * @brief Diseño de filtro Biquad paso bajo (RBJ).
  * * Calcula coeficientes para una transferencia:
@@ -85,6 +106,109 @@ static inline float dc_block_process(fm_radio_t *r, float x) {
     return y;
 }
 
+/**
+ * @brief atan2 polinómico escalar (mismo polinomio y reducción que la ruta SIMD).
+ */
+static inline float fast_atan2f(float y, float x) {
+    const float ax = fabsf(x), ay = fabsf(y);
+    const float mx = fmaxf(fmaxf(ax, ay), FM_TINY);
+    const float a = fminf(ax, ay) / mx;
+    const float z = a * a;
+    float r = FM_ATAN_C5;
+    r = r * z + FM_ATAN_C4;
+    r = r * z + FM_ATAN_C3;
+    r = r * z + FM_ATAN_C2;
+    r = r * z + FM_ATAN_C1;
+    r = r * z + FM_ATAN_C0;
+    r *= a;
+    if (ay > ax) r = FM_HALF_PI - r;
+    if (x < 0.0f) r = FM_PI - r;
+    return copysignf(r, y);
+}
+
+/**
+ * @brief Discriminador de cuadratura sobre un bloque:
+ * \f$ \Delta\phi[k] = \arg\left(x[k+1] \cdot x^*[k]\right) \f$.
+ * * @param[in]  xi   Rama I, con la muestra anterior en xi[0] (n+1 valores).
+ * @param[in]  xq   Rama Q, igual que @p xi.
+ * @param[in]  n    Diferencias a calcular.
+ * @param[out] dphi Fase instantánea en radianes (n valores).
+ */
+static void fm_discriminate_block(const float *xi, const float *xq, int n, float *dphi) {
+    int k = 0;
+#if defined(FM_RADIO_NEON)
+    const float32x4_t tiny = vdupq_n_f32(FM_TINY);
+    const float32x4_t half_pi = vdupq_n_f32(FM_HALF_PI);
+    const float32x4_t pi = vdupq_n_f32(FM_PI);
+    const uint32x4_t sign = vdupq_n_u32(0x80000000u);
+    for (; k + 4 <= n; k += 4) {
+        const float32x4_t ci = vld1q_f32(xi + k + 1), cq = vld1q_f32(xq + k + 1);
+        const float32x4_t pi_ = vld1q_f32(xi + k),    pq = vld1q_f32(xq + k);
+        const float32x4_t re = vmlaq_f32(vmulq_f32(ci, pi_), cq, pq);
+        const float32x4_t im = vmlsq_f32(vmulq_f32(cq, pi_), ci, pq);
+
+        const float32x4_t ax = vabsq_f32(re), ay = vabsq_f32(im);
+        const float32x4_t mx = vmaxq_f32(vmaxq_f32(ax, ay), tiny);
+        const float32x4_t mn = vminq_f32(ax, ay);
+#if defined(__aarch64__)
+        const float32x4_t a = vdivq_f32(mn, mx);
+#else
+        float32x4_t inv = vrecpeq_f32(mx);
+        inv = vmulq_f32(vrecpsq_f32(mx, inv), inv);
+        inv = vmulq_f32(vrecpsq_f32(mx, inv), inv);
+        const float32x4_t a = vmulq_f32(mn, inv);
+#endif
+        const float32x4_t z = vmulq_f32(a, a);
+        float32x4_t r = vdupq_n_f32(FM_ATAN_C5);
+        r = vmlaq_f32(vdupq_n_f32(FM_ATAN_C4), r, z);
+        r = vmlaq_f32(vdupq_n_f32(FM_ATAN_C3), r, z);
+        r = vmlaq_f32(vdupq_n_f32(FM_ATAN_C2), r, z);
+        r = vmlaq_f32(vdupq_n_f32(FM_ATAN_C1), r, z);
+        r = vmlaq_f32(vdupq_n_f32(FM_ATAN_C0), r, z);
+        r = vmulq_f32(r, a);
+
+        r = vbslq_f32(vcgtq_f32(ay, ax), vsubq_f32(half_pi, r), r);
+        r = vbslq_f32(vcltq_f32(re, vdupq_n_f32(0.0f)), vsubq_f32(pi, r), r);
+        const uint32x4_t s = vandq_u32(vreinterpretq_u32_f32(im), sign);
+        vst1q_f32(dphi + k, vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(r), s)));
+    }
+#elif defined(FM_RADIO_SSE)
+    const __m128 tiny = _mm_set1_ps(FM_TINY);
+    const __m128 half_pi = _mm_set1_ps(FM_HALF_PI);
+    const __m128 pi = _mm_set1_ps(FM_PI);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    for (; k + 4 <= n; k += 4) {
+        const __m128 ci = _mm_loadu_ps(xi + k + 1), cq = _mm_loadu_ps(xq + k + 1);
+        const __m128 pi_ = _mm_loadu_ps(xi + k),    pq = _mm_loadu_ps(xq + k);
+        const __m128 re = _mm_add_ps(_mm_mul_ps(ci, pi_), _mm_mul_ps(cq, pq));
+        const __m128 im = _mm_sub_ps(_mm_mul_ps(cq, pi_), _mm_mul_ps(ci, pq));
+
+        const __m128 ax = _mm_andnot_ps(sign, re), ay = _mm_andnot_ps(sign, im);
+        const __m128 mx = _mm_max_ps(_mm_max_ps(ax, ay), tiny);
+        const __m128 a = _mm_div_ps(_mm_min_ps(ax, ay), mx);
+        const __m128 z = _mm_mul_ps(a, a);
+        __m128 r = _mm_set1_ps(FM_ATAN_C5);
+        r = _mm_add_ps(_mm_mul_ps(r, z), _mm_set1_ps(FM_ATAN_C4));
+        r = _mm_add_ps(_mm_mul_ps(r, z), _mm_set1_ps(FM_ATAN_C3));
+        r = _mm_add_ps(_mm_mul_ps(r, z), _mm_set1_ps(FM_ATAN_C2));
+        r = _mm_add_ps(_mm_mul_ps(r, z), _mm_set1_ps(FM_ATAN_C1));
+        r = _mm_add_ps(_mm_mul_ps(r, z), _mm_set1_ps(FM_ATAN_C0));
+        r = _mm_mul_ps(r, a);
+
+        const __m128 swap = _mm_cmpgt_ps(ay, ax);
+        r = _mm_or_ps(_mm_and_ps(swap, _mm_sub_ps(half_pi, r)), _mm_andnot_ps(swap, r));
+        const __m128 neg = _mm_cmplt_ps(re, _mm_setzero_ps());
+        r = _mm_or_ps(_mm_and_ps(neg, _mm_sub_ps(pi, r)), _mm_andnot_ps(neg, r));
+        _mm_storeu_ps(dphi + k, _mm_or_ps(r, _mm_and_ps(im, sign)));
+    }
+#endif
+    for (; k < n; k++) {
+        const float re = xi[k + 1] * xi[k] + xq[k + 1] * xq[k];
+        const float im = xq[k + 1] * xi[k] - xi[k + 1] * xq[k];
+        dphi[k] = fast_atan2f(im, re);
+    }
+}
+
 static inline float phase_diff_to_hz_local(float phase_diff_rad, int fs_demod) {
     // fi(t) = (fs / 2pi) * dphi
     return phase_diff_rad * ((float)fs_demod / (2.0f * (float)M_PI));
@@ -120,8 +244,10 @@ static inline float update_fm_deviation_ctx(fm_dev_state_t *st,
 void fm_radio_init(fm_radio_t *radio, double fs, int audio_fs, int deemph_us) {
     if (!radio) return;
 
-    radio->prev_sample = 1.0 + 0.0*I;
-    radio->iq_acc = 0.0 + 0.0*I;
+    radio->prev_i = 1.0f;
+    radio->prev_q = 0.0f;
+    radio->acc_i = 0.0f;
+    radio->acc_q = 0.0f;
     radio->pre_samples_in_acc = 0;
     radio->audio_acc = 0;
     radio->samples_in_acc = 0;
@@ -160,70 +286,125 @@ void fm_radio_init(fm_radio_t *radio, double fs, int audio_fs, int deemph_us) {
     biquad_lowpass(radio, (float)audio_fs, 12000.0f, 0.707f);
 }
 
-int fm_radio_iq_to_pcm(fm_radio_t *radio, signal_iq_t *sig, int16_t *pcm_out,
-                       fm_dev_state_t *dev_st, int fs_demod)
+/**
+ * @brief Lleva un bloque de fases a tasa de audio: promedio, métrica, de-énfasis, DC y biquad.
+ * @return Muestras PCM escritas.
+ */
+static int fm_block_to_audio(fm_radio_t *radio, const float *dphi, int n, int16_t *pcm_out,
+                             fm_dev_state_t *dev_st, int eff_fs_demod)
+{
+    int out_idx = 0;
+    for (int k = 0; k < n; k++) {
+        // 3) decimation to audio: accumulate then average
+        radio->audio_acc += dphi[k];
+        radio->samples_in_acc++;
+        if (radio->samples_in_acc < radio->decim_factor) continue;
+
+        float val = radio->audio_acc / (float)radio->samples_in_acc;
+        radio->audio_acc = 0.0f;
+        radio->samples_in_acc = 0;
+
+        // --- FM excursion metrics (using decimated avg phase diff) ---
+        if (dev_st) update_fm_deviation_ctx(dev_st, val, eff_fs_demod);
+
+        // 3) de-emphasis
+        radio->deemph_acc += radio->deemph_alpha * (val - radio->deemph_acc);
+        float a = radio->deemph_acc;
+
+        // 3b) DC blocker
+        if (radio->enable_dc_block) {
+            a = dc_block_process(radio, a);
+        }
+
+        // 3c) audio low-pass
+        if (radio->enable_lpf) {
+            a = biquad_process(radio, a);
+        }
+
+        // 4) gain + clip (NOTE: use 'a', not deemph_acc)
+        float pcm = a * radio->gain;
+        if (pcm >  32767.0f) pcm =  32767.0f;
+        if (pcm < -32768.0f) pcm = -32768.0f;
+
+        pcm_out[out_idx++] = (int16_t)pcm;
+    }
+    return out_idx;
+}
+
+/**
+ * @brief Núcleo común de @ref fm_radio_iq_to_pcm y @ref fm_radio_cf32_to_pcm.
+ * @details Exactamente uno de @p iq_d / @p iq_f es no nulo; solo cambia la lectura de cada
+ * muestra, todo lo demás ya es float32.
+ */
+static int fm_demod(fm_radio_t *radio, const double complex *iq_d, const float complex *iq_f,
+                    size_t n_iq, int16_t *pcm_out, fm_dev_state_t *dev_st, int fs_demod)
 {
-    if (!radio || !sig || !pcm_out) return 0;
 
+    int eff_fs_demod = (int)llround(radio->demod_fs_hz);
+    if (eff_fs_demod <= 0) eff_fs_demod = fs_demod;
+
+    // Slot 0 carries the previous sample so the block needs no special first element
+    float xi[FM_DEMOD_BLOCK + 1], xq[FM_DEMOD_BLOCK + 1];
+    float dphi[FM_DEMOD_BLOCK];
+    xi[0] = radio->prev_i;
+    xq[0] = radio->prev_q;
+    int nb = 0;
     int out_idx = 0;
 
-    for (size_t i = 0; i < sig->n_signal; i++) {
+    const int pre = radio->pre_decim_factor;
+    const float inv_pre = 1.0f / (float)pre;
+
+    for (size_t i = 0; i < n_iq; i++) {
         // 1) IQ pre-decimation by averaging (simple anti-noise stage)
-        radio->iq_acc += sig->signal_iq[i];
-        radio->pre_samples_in_acc++;
-        if (radio->pre_samples_in_acc < radio->pre_decim_factor) {
-            continue;
+        if (iq_f) {
+            radio->acc_i += crealf(iq_f[i]);
+            radio->acc_q += cimagf(iq_f[i]);
+        } else {
+            radio->acc_i += (float)creal(iq_d[i]);
+            radio->acc_q += (float)cimag(iq_d[i]);
         }
+        if (++radio->pre_samples_in_acc < pre) continue;
 
-        double complex x = radio->iq_acc / (double)radio->pre_samples_in_acc;
-        radio->iq_acc = 0.0 + 0.0*I;
+        xi[nb + 1] = radio->acc_i * inv_pre;
+        xq[nb + 1] = radio->acc_q * inv_pre;
+        radio->acc_i = 0.0f;
+        radio->acc_q = 0.0f;
         radio->pre_samples_in_acc = 0;
 
-        // 2) FM demod: phase difference
-        double complex diff = x * conj(radio->prev_sample);
-        double angle = atan2(cimag(diff), creal(diff));
-        radio->prev_sample = x;
+        if (++nb < FM_DEMOD_BLOCK) continue;
 
-        // 3) decimation to audio: accumulate then average
-        radio->audio_acc += angle;
-        radio->samples_in_acc++;
+        // 2) FM demod: phase difference over the whole block
+        fm_discriminate_block(xi, xq, nb, dphi);
+        out_idx += fm_block_to_audio(radio, dphi, nb, pcm_out + out_idx, dev_st, eff_fs_demod);
+        xi[0] = xi[nb];
+        xq[0] = xq[nb];
+        nb = 0;
+    }
 
-        if (radio->samples_in_acc >= radio->decim_factor) {
-            float val = (float)(radio->audio_acc / (double)radio->samples_in_acc);
-            radio->audio_acc = 0;
-            radio->samples_in_acc = 0;
-
-            // --- FM excursion metrics (using decimated avg phase diff) ---
-            if (dev_st) {
-                int eff_fs_demod = (int)llround(radio->demod_fs_hz);
-                if (eff_fs_demod <= 0) eff_fs_demod = fs_demod;
-                update_fm_deviation_ctx(dev_st, val, eff_fs_demod);
-            }
-
-            // 3) de-emphasis
-            radio->deemph_acc += radio->deemph_alpha * (val - radio->deemph_acc);
-            float a = radio->deemph_acc;
-
-            // 3b) DC blocker
-            if (radio->enable_dc_block) {
-                a = dc_block_process(radio, a);
-            }
-
-            // 3c) audio low-pass
-            if (radio->enable_lpf) {
-                a = biquad_process(radio, a);
-            }
-
-            // 4) gain + clip (NOTE: use 'a', not deemph_acc)
-            double pcm = (double)a * (double)radio->gain;
-            if (pcm >  32767.0) pcm =  32767.0;
-            if (pcm < -32768.0) pcm = -32768.0;
-
-            pcm_out[out_idx++] = (int16_t)pcm;
-        }
+    if (nb > 0) {
+        fm_discriminate_block(xi, xq, nb, dphi);
+        out_idx += fm_block_to_audio(radio, dphi, nb, pcm_out + out_idx, dev_st, eff_fs_demod);
+        xi[0] = xi[nb];
+        xq[0] = xq[nb];
     }
+    radio->prev_i = xi[0];
+    radio->prev_q = xq[0];
 
     return out_idx;
 }
 
+int fm_radio_iq_to_pcm(fm_radio_t *radio, signal_iq_t *sig, int16_t *pcm_out,
+                       fm_dev_state_t *dev_st, int fs_demod)
+{
+    if (!radio || !sig || !sig->signal_iq || !pcm_out) return 0;
+    return fm_demod(radio, sig->signal_iq, NULL, sig->n_signal, pcm_out, dev_st, fs_demod);
+}
+
+int fm_radio_cf32_to_pcm(fm_radio_t *radio, const float complex *iq, size_t n_iq, int16_t *pcm_out,
+                         fm_dev_state_t *dev_st, int fs_demod)
+{
+    if (!radio || !iq || !pcm_out) return 0;
+    return fm_demod(radio, NULL, iq, n_iq, pcm_out, dev_st, fs_demod);
+}
+
 /** @} */
\ No newline at end of file
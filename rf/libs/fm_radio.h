@@ -28,20 +28,23 @@
  */
 
 #define DEV_EMA_ALPHA 0.10f  /**< Factor de suavizado para la métrica de desviación. */
+#define FM_DEMOD_BLOCK 256   /**< Muestras pre-diezmadas por bloque del discriminador vectorial. */
 
 /**
  * @brief Estructura de estado del demodulador FM.
  * * Mantiene los registros necesarios para el discriminador de fase y la cadena de filtrado.
  */
 typedef struct {
-    double _Complex prev_sample; /**< Almacena la muestra anterior para el cálculo de \f$ \Delta\phi \f$. */
+    float prev_i;                /**< Rama I de la muestra anterior para el cálculo de \f$ \Delta\phi \f$. */
+    float prev_q;                /**< Rama Q de la muestra anterior. */
 
-    double _Complex iq_acc;      /**< Acumulador complejo para pre-diezmado IQ. */
+    float acc_i;                 /**< Acumulador I para pre-diezmado IQ. */
+    float acc_q;                 /**< Acumulador Q para pre-diezmado IQ. */
     int pre_decim_factor;        /**< Factor de pre-diezmado IQ antes del discriminador FM. */
     int pre_samples_in_acc;      /**< Contador de muestras acumuladas para pre-diezmado. */
     double demod_fs_hz;          /**< Tasa efectiva de demodulación tras pre-diezmado. */
 
-    double audio_acc;           /**< Acumulador para diezmado. */
+    float audio_acc;            /**< Acumulador para diezmado. */
     int samples_in_acc;         /**< Contador de muestras acumuladas. */
     int decim_factor;           /**< Factor de diezmado \f$ M = f_{in} / f_{out} \f$. */
 
@@ -79,6 +82,10 @@ void fm_radio_init(fm_radio_t *radio, double fs, int audio_fs, int deemph_us);
 
 /**
  * @brief Procesa un bloque IQ y genera muestras de audio PCM de 16 bits.
+ * * Trabaja en float32 por bloques de @ref FM_DEMOD_BLOCK muestras pre-diezmadas: el
+ * producto \f$ x[n] \cdot x^*[n-1] \f$ y su fase (atan2 polinómico, error < 2e-6 rad)
+ * se calculan con NEON/SSE sobre el bloque completo; de-énfasis, DC blocker y biquad
+ * siguen siendo recursivos a tasa de audio.
  * * @param[in,out] radio     Contexto de estado del radio.
  * @param[in]     sig       Buffer de señal IQ de entrada.
  * @param[out]    pcm_out   Buffer de salida para muestras PCM16.
@@ -88,6 +95,21 @@ void fm_radio_init(fm_radio_t *radio, double fs, int audio_fs, int deemph_us);
  */
 int fm_radio_iq_to_pcm(fm_radio_t *radio, signal_iq_t *sig, int16_t *pcm_out, fm_dev_state_t *dev_st, int fs_demod);
 
+/**
+ * @brief Igual que @ref fm_radio_iq_to_pcm pero sobre un buffer `float complex`.
+ * @details Ruta del hilo de audio: el IQ llega de @ref iq_decim_process_s8_cf32 y de
+ * @ref iq_iir_filter_apply_cf32 sin pasar por `double complex`.
+ * @param[in,out] radio     Contexto de estado del radio.
+ * @param[in]     iq        Muestras IQ float32.
+ * @param[in]     n_iq      Número de muestras de @p iq.
+ * @param[out]    pcm_out   Buffer de salida para muestras PCM16.
+ * @param[in,out] dev_st    Métricas de desviación FM (opcional).
+ * @param[in]     fs_demod  Tasa de muestreo de la etapa de demodulación.
+ * @return int              Número de muestras de audio escritas en pcm_out.
+ */
+int fm_radio_cf32_to_pcm(fm_radio_t *radio, const float complex *iq, size_t n_iq, int16_t *pcm_out,
+                         fm_dev_state_t *dev_st, int fs_demod);
+
 /** @} */
 
 #endif
\ No newline at end of file
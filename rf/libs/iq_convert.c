@@ -0,0 +1,67 @@
+/**
+ * @file iq_convert.c
+ * @brief Implementación de los kernels de conversión IQ int8 → float32.
+ */
+#include "iq_convert.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define IQ_CONVERT_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define IQ_CONVERT_SSE2 1
+#endif
+
+/**
+ * @addtogroup iq_convert_module
+ * @{
+ */
+
+const char *iq_convert_isa_name(void) {
+#if defined(IQ_CONVERT_NEON)
+    return "neon";
+#elif defined(IQ_CONVERT_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+void iq_convert_s8_to_cf32(const int8_t *src, float complex *dst, size_t n_samples) {
+    if (!src || !dst || n_samples == 0) return;
+
+    /* float complex is laid out as {re, im}: the interleaved I/Q order is preserved */
+    float *out = (float *)dst;
+    const size_t n_values = n_samples * 2U;
+    size_t i = 0;
+
+#if defined(IQ_CONVERT_NEON)
+    // 16 int8 -> 16 float32 per iteration (8 complex samples)
+    for (; i + 16 <= n_values; i += 16) {
+        int8x16_t v8 = vld1q_s8(src + i);
+        int16x8_t lo16 = vmovl_s8(vget_low_s8(v8));
+        int16x8_t hi16 = vmovl_s8(vget_high_s8(v8));
+        vst1q_f32(out + i,      vcvtq_f32_s32(vmovl_s16(vget_low_s16(lo16))));
+        vst1q_f32(out + i + 4,  vcvtq_f32_s32(vmovl_s16(vget_high_s16(lo16))));
+        vst1q_f32(out + i + 8,  vcvtq_f32_s32(vmovl_s16(vget_low_s16(hi16))));
+        vst1q_f32(out + i + 12, vcvtq_f32_s32(vmovl_s16(vget_high_s16(hi16))));
+    }
+#elif defined(IQ_CONVERT_SSE2)
+    // Sign-extend via unpack + arithmetic shift (SSE2 has no pmovsx)
+    for (; i + 16 <= n_values; i += 16) {
+        __m128i v8 = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i lo16 = _mm_srai_epi16(_mm_unpacklo_epi8(v8, v8), 8);
+        __m128i hi16 = _mm_srai_epi16(_mm_unpackhi_epi8(v8, v8), 8);
+        _mm_storeu_ps(out + i,      _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(lo16, lo16), 16)));
+        _mm_storeu_ps(out + i + 4,  _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(lo16, lo16), 16)));
+        _mm_storeu_ps(out + i + 8,  _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(hi16, hi16), 16)));
+        _mm_storeu_ps(out + i + 12, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(hi16, hi16), 16)));
+    }
+#endif
+
+    for (; i < n_values; i++) {
+        out[i] = (float)src[i];
+    }
+}
+
+/** @} */
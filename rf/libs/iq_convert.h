@@ -0,0 +1,42 @@
+/**
+ * @file iq_convert.h
+ * @brief Kernels vectorizados de conversión de muestras IQ int8 a complejos float32.
+ *
+ * El HackRF entrega pares I/Q intercalados de 8 bits. Estos kernels los expanden a
+ * `float complex` (8 bytes por muestra en lugar de 16 con `double complex`), usando
+ * NEON en ARM (Raspberry Pi), SSE2 en x86-64 y un lazo escalar como respaldo.
+ */
+
+#ifndef IQ_CONVERT_H
+#define IQ_CONVERT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <complex.h>
+
+/**
+ * @defgroup iq_convert_module IQ Convert
+ * @ingroup rf_binary
+ * @brief Conversión int8 → float32 complejo con SIMD seleccionado en compilación.
+ * @{
+ */
+
+/**
+ * @brief Convierte @p n_samples pares I/Q int8 intercalados a `float complex`.
+ * @details No aplica escalado (mantiene la escala digital cruda [-128, 127]) para que
+ * la PSD resultante sea idéntica a la ruta `double complex`.
+ * @param[in]  src Buffer intercalado [I0, Q0, I1, Q1, ...] de 2 * @p n_samples bytes.
+ * @param[out] dst Destino con capacidad para @p n_samples muestras.
+ * @param[in]  n_samples Número de muestras complejas.
+ */
+void iq_convert_s8_to_cf32(const int8_t *src, float complex *dst, size_t n_samples);
+
+/**
+ * @brief Nombre del kernel compilado ("neon", "sse2" o "scalar"), para logs.
+ * @return Cadena estática.
+ */
+const char *iq_convert_isa_name(void);
+
+/** @} */
+
+#endif
@@ -0,0 +1,307 @@
+/**
+ * @file iq_decim.c
+ * @brief Implementación del diezmador CIC + FIR polifásico de la ruta de audio.
+ */
+#include "iq_decim.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define IQ_DECIM_NEON 1
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#define IQ_DECIM_SSE 1
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/**
+ * @addtogroup iq_decim_module
+ * @{
+ */
+
+int iq_decim_plan(double fs_in, int audio_fs, double fs_lo, double fs_hi, double fs_pref, int *r1, int *r2) {
+    if (!r1 || !r2 || !(fs_in > 0.0) || audio_fs <= 0) return -1;
+
+    const long t0 = lround(fs_in / (double)audio_fs);
+    static const int dt_order[] = { 0, -1, 1, -2, 2 };
+
+    /* The nearest overall ratio keeps the audio rate error minimal; neighbours only as fallback */
+    for (size_t o = 0; o < sizeof(dt_order) / sizeof(dt_order[0]); o++) {
+        const long T = t0 + dt_order[o];
+        if (T < 1) continue;
+
+        int best_r1 = 0, best_r2 = 0;
+        double best_err = 0.0;
+
+        for (long k = 1; k <= T; k++) {
+            if (T % k) continue;
+            const double fs_mid = fs_in * (double)k / (double)T;
+            if (fs_mid < fs_lo || fs_mid > fs_hi) continue;
+
+            const long D = T / k;
+            int f2 = 1;
+            for (int c = IQ_DECIM_FIR_MAX_R; c >= 2; c--) {
+                if (D % c == 0) { f2 = c; break; }
+            }
+            const long f1 = D / f2;
+            if (f1 > IQ_DECIM_CIC_MAX_R) continue;
+
+            const double err = fabs(fs_mid - fs_pref);
+            if (best_r1 == 0 || err < best_err) {
+                best_r1 = (int)f1;
+                best_r2 = f2;
+                best_err = err;
+            }
+        }
+
+        if (best_r1 > 0) {
+            *r1 = best_r1;
+            *r2 = best_r2;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Diseña el FIR anti-alias de la segunda etapa (sinc con ventana Blackman).
+ * @details Corte en 0.4 f_out; ganancia DC unitaria. Se almacena invertido en el tiempo
+ * para que cada salida sea un producto punto contiguo sobre la historia.
+ */
+static void design_fir(float *taps, int n_taps, int r2) {
+    const double fc = 0.4 / (double)r2; /* normalised to the CIC output rate */
+    const double mid = 0.5 * (double)(n_taps - 1);
+    double sum = 0.0;
+
+    for (int n = 0; n < n_taps; n++) {
+        const double t = (double)n - mid;
+        const double x = 2.0 * fc * t;
+        const double sinc = (fabs(x) < 1e-12) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+        const double a = 2.0 * M_PI * (double)n / (double)(n_taps - 1);
+        const double w = 0.42 - 0.5 * cos(a) + 0.08 * cos(2.0 * a);
+        const double h = 2.0 * fc * sinc * w;
+        taps[n_taps - 1 - n] = (float)h;
+        sum += h;
+    }
+
+    if (sum != 0.0) {
+        const float inv = (float)(1.0 / sum);
+        for (int n = 0; n < n_taps; n++) taps[n] *= inv;
+    }
+}
+
+/** Taps, historia I e historia Q en un solo bloque: [taps_cap | hist_cap | hist_cap]. */
+static int decim_alloc(iq_decim_t *d, int taps_cap, size_t hist_cap) {
+    float *block = (float*)malloc(sizeof(float) * ((size_t)taps_cap + 2U * hist_cap));
+    if (!block) return -1;
+    free(d->taps);
+    d->taps = block;
+    d->taps_cap = taps_cap;
+    d->hist_i = block + taps_cap;
+    d->hist_q = d->hist_i + hist_cap;
+    d->hist_cap = hist_cap;
+    return 0;
+}
+
+int iq_decim_reserve(iq_decim_t *d, size_t max_in_samples) {
+    if (!d || max_in_samples == 0) return -1;
+    const int n_taps = IQ_DECIM_FIR_TAPS_PER_PHASE * IQ_DECIM_FIR_MAX_R;
+    const size_t need = (size_t)(n_taps - 1) + max_in_samples + 1;
+    if (n_taps <= d->taps_cap && need <= d->hist_cap) return 0;
+    return decim_alloc(d, n_taps, need);
+}
+
+int iq_decim_init(iq_decim_t *d, double fs_in, int r1, int r2, size_t max_in_samples) {
+    if (!d || !(fs_in > 0.0) || r1 < 1 || r1 > IQ_DECIM_CIC_MAX_R ||
+        r2 < 1 || r2 > IQ_DECIM_FIR_MAX_R || max_in_samples == 0) return -1;
+
+    const int n_taps = (r2 > 1) ? IQ_DECIM_FIR_TAPS_PER_PHASE * r2 : 0;
+    const size_t need = (size_t)(n_taps > 0 ? n_taps - 1 : 0) + max_in_samples / (size_t)r1 + 1;
+
+    // A CIC-only plan needs no FIR storage; otherwise grow only past the reserved capacity
+    if (n_taps > 0 && (n_taps > d->taps_cap || need > d->hist_cap)) {
+        const int taps_cap = (n_taps > d->taps_cap) ? n_taps : d->taps_cap;
+        const size_t hist_cap = (need > d->hist_cap) ? need : d->hist_cap;
+        if (decim_alloc(d, taps_cap, hist_cap) != 0) {
+            iq_decim_free(d);
+            return -1;
+        }
+    }
+
+    d->cic_r = r1;
+    d->fir_r = r2;
+    d->n_taps = n_taps;
+    d->fs_in = fs_in;
+    d->fs_out = fs_in / ((double)r1 * (double)r2);
+
+    double gain = 128.0;
+    for (int s = 0; s < IQ_DECIM_CIC_ORDER; s++) gain *= (double)r1;
+    d->cic_scale = (float)(1.0 / gain);
+
+    if (n_taps > 0) design_fir(d->taps, n_taps, r2);
+
+    iq_decim_reset(d);
+    return 0;
+}
+
+void iq_decim_reset(iq_decim_t *d) {
+    if (!d) return;
+    memset(d->integ, 0, sizeof(d->integ));
+    memset(d->comb, 0, sizeof(d->comb));
+    d->cic_phase = 0;
+    d->fir_phase = 0;
+    if (d->n_taps > 0 && d->hist_i && d->hist_q) {
+        memset(d->hist_i, 0, sizeof(float) * (size_t)(d->n_taps - 1));
+        memset(d->hist_q, 0, sizeof(float) * (size_t)(d->n_taps - 1));
+    }
+}
+
+void iq_decim_free(iq_decim_t *d) {
+    if (!d) return;
+    free(d->taps);
+    memset(d, 0, sizeof(*d));
+}
+
+/**
+ * @brief Productos punto simultáneos de las ramas I y Q con los taps.
+ * @param taps Coeficientes (n múltiplo de 4).
+ * @param xi Historia rama I.
+ * @param xq Historia rama Q.
+ * @param n Número de taps.
+ * @param[out] yi Resultado I.
+ * @param[out] yq Resultado Q.
+ */
+static inline void fir_dot2(const float *taps, const float *xi, const float *xq, int n, float *yi, float *yq) {
+    int t = 0;
+#if defined(IQ_DECIM_NEON)
+    float32x4_t ai = vdupq_n_f32(0.0f);
+    float32x4_t aq = vdupq_n_f32(0.0f);
+    for (; t + 4 <= n; t += 4) {
+        const float32x4_t h = vld1q_f32(taps + t);
+        ai = vmlaq_f32(ai, h, vld1q_f32(xi + t));
+        aq = vmlaq_f32(aq, h, vld1q_f32(xq + t));
+    }
+    float si[4], sq[4];
+    vst1q_f32(si, ai);
+    vst1q_f32(sq, aq);
+    float acc_i = (si[0] + si[1]) + (si[2] + si[3]);
+    float acc_q = (sq[0] + sq[1]) + (sq[2] + sq[3]);
+#elif defined(IQ_DECIM_SSE)
+    __m128 ai = _mm_setzero_ps();
+    __m128 aq = _mm_setzero_ps();
+    for (; t + 4 <= n; t += 4) {
+        const __m128 h = _mm_loadu_ps(taps + t);
+        ai = _mm_add_ps(ai, _mm_mul_ps(h, _mm_loadu_ps(xi + t)));
+        aq = _mm_add_ps(aq, _mm_mul_ps(h, _mm_loadu_ps(xq + t)));
+    }
+    float si[4], sq[4];
+    _mm_storeu_ps(si, ai);
+    _mm_storeu_ps(sq, aq);
+    float acc_i = (si[0] + si[1]) + (si[2] + si[3]);
+    float acc_q = (sq[0] + sq[1]) + (sq[2] + sq[3]);
+#else
+    float acc_i = 0.0f, acc_q = 0.0f;
+#endif
+    for (; t < n; t++) {
+        acc_i += taps[t] * xi[t];
+        acc_q += taps[t] * xq[t];
+    }
+    *yi = acc_i;
+    *yq = acc_q;
+}
+
+/**
+ * @brief Núcleo común de @ref iq_decim_process_s8 y @ref iq_decim_process_s8_cf32.
+ * @details Exactamente uno de @p dst_d / @p dst_f es no nulo; la rama por salida es siempre
+ * la misma y el predictor la resuelve sin coste.
+ */
+static size_t decim_process(iq_decim_t *d, const int8_t *src, size_t n_samples,
+                            double complex *dst_d, float complex *dst_f) {
+
+    const int R1 = d->cic_r;
+    const int keep = (d->n_taps > 0) ? d->n_taps - 1 : 0;
+    const float scale = d->cic_scale;
+
+    uint32_t i0 = d->integ[0][0], i1 = d->integ[0][1], i2 = d->integ[0][2];
+    uint32_t q0 = d->integ[1][0], q1 = d->integ[1][1], q2 = d->integ[1][2];
+    int phase = d->cic_phase;
+    size_t n_cic = 0;
+    size_t n_out = 0;
+
+    /* ===== Stage 1: integer CIC, integrators at the input rate (wrap-around is exact) ===== */
+    for (size_t n = 0; n < n_samples; n++) {
+        i0 += (uint32_t)(int32_t)src[2 * n];
+        i1 += i0;
+        i2 += i1;
+        q0 += (uint32_t)(int32_t)src[2 * n + 1];
+        q1 += q0;
+        q2 += q1;
+
+        if (++phase < R1) continue;
+        phase = 0;
+
+        /* Combs at the decimated rate */
+        uint32_t ci = i2, cq = q2;
+        for (int s = 0; s < IQ_DECIM_CIC_ORDER; s++) {
+            const uint32_t pi = d->comb[0][s];
+            const uint32_t pq = d->comb[1][s];
+            d->comb[0][s] = ci;
+            d->comb[1][s] = cq;
+            ci -= pi;
+            cq -= pq;
+        }
+
+        const float yi = (float)(int32_t)ci * scale;
+        const float yq = (float)(int32_t)cq * scale;
+
+        if (keep == 0) {
+            if (dst_f) dst_f[n_out++] = yi + yq * I;
+            else       dst_d[n_out++] = (double)yi + (double)yq * I;
+        } else {
+            d->hist_i[keep + n_cic] = yi;
+            d->hist_q[keep + n_cic] = yq;
+            n_cic++;
+        }
+    }
+
+    d->integ[0][0] = i0; d->integ[0][1] = i1; d->integ[0][2] = i2;
+    d->integ[1][0] = q0; d->integ[1][1] = q1; d->integ[1][2] = q2;
+    d->cic_phase = phase;
+
+    if (keep == 0) return n_out;
+
+    /* ===== Stage 2: polyphase FIR, only retained outputs are evaluated ===== */
+    size_t pos = (size_t)d->fir_phase;
+    while (pos < n_cic) {
+        float yi, yq;
+        fir_dot2(d->taps, d->hist_i + pos, d->hist_q + pos, d->n_taps, &yi, &yq);
+        if (dst_f) dst_f[n_out++] = yi + yq * I;
+        else       dst_d[n_out++] = (double)yi + (double)yq * I;
+        pos += (size_t)d->fir_r;
+    }
+    d->fir_phase = (int)(pos - n_cic);
+
+    memmove(d->hist_i, d->hist_i + n_cic, sizeof(float) * (size_t)keep);
+    memmove(d->hist_q, d->hist_q + n_cic, sizeof(float) * (size_t)keep);
+
+    return n_out;
+}
+
+size_t iq_decim_process_s8(iq_decim_t *d, const int8_t *src, size_t n_samples, double complex *dst) {
+    if (!d || !src || !dst || n_samples == 0 || d->cic_r < 1) return 0;
+    return decim_process(d, src, n_samples, dst, NULL);
+}
+
+size_t iq_decim_process_s8_cf32(iq_decim_t *d, const int8_t *src, size_t n_samples, float complex *dst) {
+    if (!d || !src || !dst || n_samples == 0 || d->cic_r < 1) return 0;
+    return decim_process(d, src, n_samples, NULL, dst);
+}
+
+/** @} */
@@ -0,0 +1,131 @@
+/**
+ * @file iq_decim.h
+ * @brief Diezmador IQ multietapa (CIC entero + FIR polifásico float32) para la ruta de audio.
+ *
+ * Reduce la tasa del HackRF (MS/s) a una tasa intermedia de cientos o decenas de kHz
+ * antes del filtro IIR y de los demoduladores AM/FM:
+ *   1. CIC de orden 3 en aritmética entera modular sobre los int8 crudos (sin conversión
+ *      a flotante a la tasa completa).
+ *   2. FIR polifásico float32 (ventana Blackman, corte 0.4 f_out) que solo evalúa las salidas
+ *      retenidas, con el producto punto vectorizado (NEON/SSE) y respaldo escalar.
+ *
+ * La tasa de salida se elige de modo que el diezmado restante del demodulador hacia
+ * audio sea entero: \f$ f_{out} = f_{in} / D \f$ con \f$ D \cdot k \approx f_{in} / f_{audio} \f$.
+ */
+
+#ifndef IQ_DECIM_H
+#define IQ_DECIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <complex.h>
+
+/**
+ * @defgroup iq_decim_module IQ Decimator
+ * @ingroup rf_binary
+ * @brief Front-end de diezmado para los demoduladores de audio.
+ * @{
+ */
+
+#define IQ_DECIM_CIC_ORDER  3   /**< Orden del CIC (crecimiento de bits 3·log2(R1) sobre 8 bits). */
+#define IQ_DECIM_CIC_MAX_R  256 /**< Máximo R1 para que el CIC quepa en 32 bits. */
+#define IQ_DECIM_FIR_MAX_R  8   /**< Máximo factor de la etapa FIR. */
+#define IQ_DECIM_FIR_TAPS_PER_PHASE 16 /**< Taps por fase del FIR polifásico. */
+
+/**
+ * @brief Estado del diezmador multietapa.
+ */
+typedef struct {
+    int cic_r;              /**< Factor de la etapa CIC (R1). */
+    int fir_r;              /**< Factor de la etapa FIR (R2). */
+    double fs_in;           /**< Tasa de entrada (Hz). */
+    double fs_out;          /**< Tasa de salida \f$ f_{in} / (R_1 R_2) \f$. */
+
+    uint32_t integ[2][IQ_DECIM_CIC_ORDER]; /**< Integradores CIC I/Q (módulo 2^32). */
+    uint32_t comb[2][IQ_DECIM_CIC_ORDER];  /**< Retardos de los peines CIC I/Q. */
+    int cic_phase;          /**< Muestras acumuladas desde la última salida CIC. */
+    float cic_scale;        /**< \f$ 1 / (128 R_1^N) \f$: normaliza a [-1, 1) como la ruta previa. */
+
+    float *taps;            /**< Coeficientes FIR invertidos en el tiempo (n_taps); inicio del bloque único. */
+    int n_taps;             /**< Longitud del FIR (múltiplo de 4). */
+    int taps_cap;           /**< Capacidad de taps. */
+    float *hist_i;          /**< Historia + bloque CIC, rama I (dentro del bloque de taps). */
+    float *hist_q;          /**< Historia + bloque CIC, rama Q (dentro del bloque de taps). */
+    size_t hist_cap;        /**< Capacidad de hist_i/hist_q. */
+    int fir_phase;          /**< Índice de la próxima salida FIR dentro del bloque. */
+} iq_decim_t;
+
+/**
+ * @brief Elige los factores de diezmado para una tasa de entrada y un rango de salida.
+ * @details Busca \f$ T \approx f_{in}/f_{audio} \f$ (probando T, T±1, T±2) con un divisor k tal que
+ * \f$ f_{in} k / T \f$ caiga en [@p fs_lo, @p fs_hi] (el más cercano a @p fs_pref), y factoriza
+ * \f$ D = T / k = R_1 R_2 \f$ con \f$ R_2 \le 8 \f$ y \f$ R_1 \le 256 \f$.
+ * @param fs_in Tasa de entrada (Hz).
+ * @param audio_fs Tasa de audio final (Hz).
+ * @param fs_lo Tasa intermedia mínima aceptable (Hz).
+ * @param fs_hi Tasa intermedia máxima aceptable (Hz).
+ * @param fs_pref Tasa intermedia preferida (Hz).
+ * @param[out] r1 Factor CIC.
+ * @param[out] r2 Factor FIR.
+ * @return 0 si hay solución, -1 si no (el llamador debe omitir el diezmador).
+ */
+int iq_decim_plan(double fs_in, int audio_fs, double fs_lo, double fs_hi, double fs_pref, int *r1, int *r2);
+
+/**
+ * @brief Reserva los buffers para el peor caso (R1 = 1, R2 = @ref IQ_DECIM_FIR_MAX_R).
+ * @details Tras esta llamada ningún @ref iq_decim_init con el mismo @p max_in_samples reserva
+ * memoria, de modo que los cambios de modo o de tasa no tocan el heap.
+ * @param d Estado, antes del primer @ref iq_decim_init (un crecimiento posterior descarta los taps).
+ * @param max_in_samples Máximo de muestras IQ por llamada a @ref iq_decim_process_s8.
+ * @return 0 en éxito, -1 si falla la reserva.
+ */
+int iq_decim_reserve(iq_decim_t *d, size_t max_in_samples);
+
+/**
+ * @brief Inicializa (o reconfigura) el diezmador. Solo reserva si el FIR o el bloque superan la capacidad.
+ * @param d Estado.
+ * @param fs_in Tasa de entrada (Hz).
+ * @param r1 Factor CIC (1..IQ_DECIM_CIC_MAX_R).
+ * @param r2 Factor FIR (1..IQ_DECIM_FIR_MAX_R).
+ * @param max_in_samples Máximo de muestras IQ por llamada a @ref iq_decim_process_s8.
+ * @return 0 en éxito, -1 si los parámetros son inválidos o falla la reserva.
+ */
+int iq_decim_init(iq_decim_t *d, double fs_in, int r1, int r2, size_t max_in_samples);
+
+/**
+ * @brief Reinicia los estados CIC/FIR sin liberar memoria.
+ * @param d Estado.
+ */
+void iq_decim_reset(iq_decim_t *d);
+
+/**
+ * @brief Libera los buffers del diezmador.
+ * @param d Estado.
+ */
+void iq_decim_free(iq_decim_t *d);
+
+/**
+ * @brief Diezma un bloque de pares I/Q int8 intercalados.
+ * @param d Estado.
+ * @param src Buffer [I0, Q0, I1, Q1, ...] de 2·@p n_samples bytes.
+ * @param n_samples Muestras IQ de entrada (<= max_in_samples).
+ * @param[out] dst Salida complejo double (capacidad >= n_samples / (R1 R2) + 1).
+ * @return Número de muestras escritas en @p dst.
+ */
+size_t iq_decim_process_s8(iq_decim_t *d, const int8_t *src, size_t n_samples, double complex *dst);
+
+/**
+ * @brief Igual que @ref iq_decim_process_s8 pero con salida `float complex`.
+ * @details El CIC y el FIR ya trabajan en float32: esta variante entrega el resultado sin
+ * ensancharlo a double, para la ruta de audio float32 (@ref iq_iir_filter_apply_cf32).
+ * @param d Estado.
+ * @param src Buffer [I0, Q0, I1, Q1, ...] de 2·@p n_samples bytes.
+ * @param n_samples Muestras IQ de entrada (<= max_in_samples).
+ * @param[out] dst Salida complejo float (capacidad >= n_samples / (R1 R2) + 1).
+ * @return Número de muestras escritas en @p dst.
+ */
+size_t iq_decim_process_s8_cf32(iq_decim_t *d, const int8_t *src, size_t n_samples, float complex *dst);
+
+/** @} */
+
+#endif
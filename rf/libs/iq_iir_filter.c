@@ -7,6 +7,16 @@
  */
 #include "iq_iir_filter.h"
 
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define IQ_IIR_NEON 1
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#define IQ_IIR_SSE 1
+#endif
+
+#define IQ_IIR_STAGE_SAMPLES 256 /**< Muestras float32 preparadas por tramo en la ruta double complex. */
+
 /**
  * @addtogroup iq_iir_filter_module
  * @{
@@ -120,35 +130,26 @@ static float butterworth_Q(int N, int k) {
 }
 
 /**
- * @brief Gestiona la asignación y liberación de memoria para las secciones del filtro.
- * * @param[in,out] st       Puntero al estado del filtro.
- * @param[in]     sections Cantidad de secciones biquad a alojar.
+ * @brief Reserva coeficientes y estados para @ref IQ_IIR_MAX_SECTIONS secciones en un solo bloque.
+ * @details Se llama una vez por filtro: cualquier orden posterior (clamp 2..12) cabe en el bloque,
+ * así que reconfigurar por cambio de modo o de tasa no toca el heap.
+ * @param[in,out] st Puntero al estado del filtro.
  * @return int 0 en éxito, -1 si falló el sistema de memoria.
  */
-static int alloc_sections(iq_iir_filter_t *st, int sections) {
-    // free old if any
-    free(st->b0); free(st->b1); free(st->b2); free(st->a1); free(st->a2);
-    free(st->z1_i); free(st->z2_i); free(st->z1_q); free(st->z2_q);
-
-    st->b0 = st->b1 = st->b2 = st->a1 = st->a2 = NULL;
-    st->z1_i = st->z2_i = st->z1_q = st->z2_q = NULL;
-
-    st->b0   = (float*)calloc((size_t)sections, sizeof(float));
-    st->b1   = (float*)calloc((size_t)sections, sizeof(float));
-    st->b2   = (float*)calloc((size_t)sections, sizeof(float));
-    st->a1   = (float*)calloc((size_t)sections, sizeof(float));
-    st->a2   = (float*)calloc((size_t)sections, sizeof(float));
-
-    st->z1_i = (float*)calloc((size_t)sections, sizeof(float));
-    st->z2_i = (float*)calloc((size_t)sections, sizeof(float));
-    st->z1_q = (float*)calloc((size_t)sections, sizeof(float));
-    st->z2_q = (float*)calloc((size_t)sections, sizeof(float));
-
-    if (!st->b0 || !st->b1 || !st->b2 || !st->a1 || !st->a2 ||
-        !st->z1_i || !st->z2_i || !st->z1_q || !st->z2_q) {
-        return -1;
-    }
-
+static int reserve_sections(iq_iir_filter_t *st) {
+    const size_t n = IQ_IIR_MAX_SECTIONS;
+    float *block = (float*)calloc(9U * n, sizeof(float));
+    if (!block) return -1;
+
+    st->b0   = block;
+    st->b1   = block + 1U * n;
+    st->b2   = block + 2U * n;
+    st->a1   = block + 3U * n;
+    st->a2   = block + 4U * n;
+    st->z1_i = block + 5U * n;
+    st->z2_i = block + 6U * n;
+    st->z1_q = block + 7U * n;
+    st->z2_q = block + 8U * n;
     return 0;
 }
 
@@ -178,14 +179,14 @@ int iq_iir_filter_config(iq_iir_filter_t *st, double fs_hz, const filter_audio_t
 
     // Orden: usarlo como Butterworth par
     int N = cfg->order_fliter;
-    N = clamp_int(N, 2, 12);
+    N = clamp_int(N, 2, 2 * IQ_IIR_MAX_SECTIONS);
     if (N % 2) N += 1; // forzar par
     st->order = N;
 
     int sections = N / 2;
-    if (sections != st->sections || st->b0 == NULL) {
+    if (st->b0 == NULL && reserve_sections(st) != 0) return -1;
+    if (sections != st->sections) {
         st->sections = sections;
-        if (alloc_sections(st, sections) != 0) return -1;
         iq_iir_filter_reset(st);
     }
 
@@ -221,8 +222,7 @@ void iq_iir_filter_reset(iq_iir_filter_t *st) {
 void iq_iir_filter_free(iq_iir_filter_t *st) {
     if (!st) return;
 
-    free(st->b0); free(st->b1); free(st->b2); free(st->a1); free(st->a2);
-    free(st->z1_i); free(st->z2_i); free(st->z1_q); free(st->z2_q);
+    free(st->b0); // single block: see reserve_sections()
 
     memset(st, 0, sizeof(*st));
 }
@@ -258,28 +258,244 @@ static inline float biquad_df2t(float x, float b0, float b1, float b2, float a1,
     return y;
 }
 
-void iq_iir_filter_apply_inplace(iq_iir_filter_t *st, signal_iq_t *sig) {
-    if (!st || !sig || !sig->signal_iq) return;
+#if defined(IQ_IIR_NEON) || defined(IQ_IIR_SSE)
+/**
+ * @brief Etapa DC blocker sobre un bloque, con I/Q en un par de lanes.
+ * @details Misma recurrencia que @ref dc_block_1p: \f$ y[n] = (x[n] - x[n-1]) + r\,y[n-1] \f$.
+ * @param[in,out] st Contexto (estados DC).
+ * @param[in,out] p  Pares I/Q intercalados.
+ * @param[in]     n  Número de muestras complejas.
+ */
+static void dc_block_pairs(iq_iir_filter_t *st, float *p, size_t n) {
+#if defined(IQ_IIR_NEON)
+    const float32x2_t r = vdup_n_f32(st->dc_r);
+    float32x2_t x1 = { st->dc_x1_i, st->dc_x1_q };
+    float32x2_t y1 = { st->dc_y1_i, st->dc_y1_q };
+    for (size_t k = 0; k < n; ++k) {
+        const float32x2_t x = vld1_f32(p + 2 * k);
+        y1 = vadd_f32(vsub_f32(x, x1), vmul_f32(r, y1));
+        x1 = x;
+        vst1_f32(p + 2 * k, y1);
+    }
+    st->dc_x1_i = vget_lane_f32(x1, 0); st->dc_x1_q = vget_lane_f32(x1, 1);
+    st->dc_y1_i = vget_lane_f32(y1, 0); st->dc_y1_q = vget_lane_f32(y1, 1);
+#elif defined(IQ_IIR_SSE)
+    const __m128 r = _mm_set1_ps(st->dc_r);
+    __m128 x1 = _mm_setr_ps(st->dc_x1_i, st->dc_x1_q, 0.0f, 0.0f);
+    __m128 y1 = _mm_setr_ps(st->dc_y1_i, st->dc_y1_q, 0.0f, 0.0f);
+    for (size_t k = 0; k < n; ++k) {
+        const __m128 x = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)(p + 2 * k));
+        y1 = _mm_add_ps(_mm_sub_ps(x, x1), _mm_mul_ps(r, y1));
+        x1 = x;
+        _mm_storel_pi((__m64*)(p + 2 * k), y1);
+    }
+    float sx[4], sy[4];
+    _mm_storeu_ps(sx, x1);
+    _mm_storeu_ps(sy, y1);
+    st->dc_x1_i = sx[0]; st->dc_x1_q = sx[1];
+    st->dc_y1_i = sy[0]; st->dc_y1_q = sy[1];
+#endif
+}
 
-    // Solo hacemos LP para baseband (independiente del enum), porque es lo que necesitas para canal
-    // Si quieres apagarlo, lo controlas en rf_audio.c (no acá).
-    for (size_t n = 0; n < sig->n_signal; ++n) {
-        float xi = (float)creal(sig->signal_iq[n]);
-        float xq = (float)cimag(sig->signal_iq[n]);
+#if defined(IQ_IIR_NEON)
+/** @brief Paso DF2T de cuatro lanes (@ref biquad_df2t en orden de operaciones idéntico). */
+static inline float32x4_t bq_step4(float32x4_t x, float32x4_t b0, float32x4_t b1, float32x4_t b2,
+                                   float32x4_t a1, float32x4_t a2, float32x4_t *z1, float32x4_t *z2) {
+    const float32x4_t y = vaddq_f32(vmulq_f32(b0, x), *z1);
+    *z1 = vaddq_f32(vsubq_f32(vmulq_f32(b1, x), vmulq_f32(a1, y)), *z2);
+    *z2 = vsubq_f32(vmulq_f32(b2, x), vmulq_f32(a2, y));
+    return y;
+}
+#elif defined(IQ_IIR_SSE)
+/** @brief Paso DF2T de cuatro lanes (@ref biquad_df2t en orden de operaciones idéntico). */
+static inline __m128 bq_step4(__m128 x, __m128 b0, __m128 b1, __m128 b2,
+                              __m128 a1, __m128 a2, __m128 *z1, __m128 *z2) {
+    const __m128 y = _mm_add_ps(_mm_mul_ps(b0, x), *z1);
+    *z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, x), _mm_mul_ps(a1, y)), *z2);
+    *z2 = _mm_sub_ps(_mm_mul_ps(b2, x), _mm_mul_ps(a2, y));
+    return y;
+}
+#endif
+
+/**
+ * @brief Dos secciones biquad consecutivas en una sola pasada sobre el bloque.
+ * @details Cada recurrencia DF2T es una cadena serie de latencia fija, así que una sección
+ * sola deja la unidad vectorial ociosa. Se empaquetan [I_s, Q_s, I_{s+1}, Q_{s+1}] en un
+ * registro de cuatro lanes con un desfase de una muestra (frente de onda): en el paso @p k
+ * la sección @p s filtra la muestra k mientras la sección s+1 filtra la salida de @p s en
+ * k-1, que ya está en el registro. Las dos cadenas avanzan con las mismas instrucciones.
+ * El primer paso (solo @p s) y el último (solo s+1) restauran el estado de la mitad que no
+ * tenía dato válido.
+ * @param[in,out] st Contexto (coeficientes y estados de las secciones @p s y s+1).
+ * @param[in]     s  Primera sección del par.
+ * @param[in,out] p  Pares I/Q intercalados.
+ * @param[in]     n  Número de muestras complejas (>= 1).
+ */
+static void biquad_two_sections(iq_iir_filter_t *st, int s, float *p, size_t n) {
+    const int t = s + 1;
+#if defined(IQ_IIR_NEON)
+    const float32x4_t b0 = vcombine_f32(vdup_n_f32(st->b0[s]), vdup_n_f32(st->b0[t]));
+    const float32x4_t b1 = vcombine_f32(vdup_n_f32(st->b1[s]), vdup_n_f32(st->b1[t]));
+    const float32x4_t b2 = vcombine_f32(vdup_n_f32(st->b2[s]), vdup_n_f32(st->b2[t]));
+    const float32x4_t a1 = vcombine_f32(vdup_n_f32(st->a1[s]), vdup_n_f32(st->a1[t]));
+    const float32x4_t a2 = vcombine_f32(vdup_n_f32(st->a2[s]), vdup_n_f32(st->a2[t]));
+    float32x4_t z1 = { st->z1_i[s], st->z1_q[s], st->z1_i[t], st->z1_q[t] };
+    float32x4_t z2 = { st->z2_i[s], st->z2_q[s], st->z2_i[t], st->z2_q[t] };
+
+    // Prologue: section s alone on sample 0; keep section s+1 state untouched
+    float32x4_t o1 = z1, o2 = z2;
+    float32x4_t y = bq_step4(vcombine_f32(vld1_f32(p), vdup_n_f32(0.0f)), b0, b1, b2, a1, a2, &z1, &z2);
+    z1 = vcombine_f32(vget_low_f32(z1), vget_high_f32(o1));
+    z2 = vcombine_f32(vget_low_f32(z2), vget_high_f32(o2));
+
+    for (size_t k = 1; k < n; ++k) {
+        y = bq_step4(vcombine_f32(vld1_f32(p + 2 * k), vget_low_f32(y)), b0, b1, b2, a1, a2, &z1, &z2);
+        vst1_f32(p + 2 * (k - 1), vget_high_f32(y));
+    }
+
+    // Epilogue: section s+1 alone on the last output of section s
+    o1 = z1; o2 = z2;
+    y = bq_step4(vcombine_f32(vdup_n_f32(0.0f), vget_low_f32(y)), b0, b1, b2, a1, a2, &z1, &z2);
+    z1 = vcombine_f32(vget_low_f32(o1), vget_high_f32(z1));
+    z2 = vcombine_f32(vget_low_f32(o2), vget_high_f32(z2));
+    vst1_f32(p + 2 * (n - 1), vget_high_f32(y));
+
+    float s1[4], s2[4];
+    vst1q_f32(s1, z1);
+    vst1q_f32(s2, z2);
+#else
+    const __m128 b0 = _mm_setr_ps(st->b0[s], st->b0[s], st->b0[t], st->b0[t]);
+    const __m128 b1 = _mm_setr_ps(st->b1[s], st->b1[s], st->b1[t], st->b1[t]);
+    const __m128 b2 = _mm_setr_ps(st->b2[s], st->b2[s], st->b2[t], st->b2[t]);
+    const __m128 a1 = _mm_setr_ps(st->a1[s], st->a1[s], st->a1[t], st->a1[t]);
+    const __m128 a2 = _mm_setr_ps(st->a2[s], st->a2[s], st->a2[t], st->a2[t]);
+    __m128 z1 = _mm_setr_ps(st->z1_i[s], st->z1_q[s], st->z1_i[t], st->z1_q[t]);
+    __m128 z2 = _mm_setr_ps(st->z2_i[s], st->z2_q[s], st->z2_i[t], st->z2_q[t]);
+    const __m128 zero = _mm_setzero_ps();
+
+    // Prologue: section s alone on sample 0; keep section s+1 state untouched
+    __m128 o1 = z1, o2 = z2;
+    __m128 y = bq_step4(_mm_loadl_pi(zero, (const __m64*)p), b0, b1, b2, a1, a2, &z1, &z2);
+    z1 = _mm_shuffle_ps(z1, o1, _MM_SHUFFLE(3, 2, 1, 0));
+    z2 = _mm_shuffle_ps(z2, o2, _MM_SHUFFLE(3, 2, 1, 0));
+
+    for (size_t k = 1; k < n; ++k) {
+        const __m128 x = _mm_movelh_ps(_mm_loadl_pi(zero, (const __m64*)(p + 2 * k)), y);
+        y = bq_step4(x, b0, b1, b2, a1, a2, &z1, &z2);
+        _mm_storeh_pi((__m64*)(p + 2 * (k - 1)), y);
+    }
+
+    // Epilogue: section s+1 alone on the last output of section s
+    o1 = z1; o2 = z2;
+    y = bq_step4(_mm_movelh_ps(zero, y), b0, b1, b2, a1, a2, &z1, &z2);
+    z1 = _mm_shuffle_ps(o1, z1, _MM_SHUFFLE(3, 2, 1, 0));
+    z2 = _mm_shuffle_ps(o2, z2, _MM_SHUFFLE(3, 2, 1, 0));
+    _mm_storeh_pi((__m64*)(p + 2 * (n - 1)), y);
+
+    float s1[4], s2[4];
+    _mm_storeu_ps(s1, z1);
+    _mm_storeu_ps(s2, z2);
+#endif
+    st->z1_i[s] = s1[0]; st->z1_q[s] = s1[1]; st->z1_i[t] = s1[2]; st->z1_q[t] = s1[3];
+    st->z2_i[s] = s2[0]; st->z2_q[s] = s2[1]; st->z2_i[t] = s2[2]; st->z2_q[t] = s2[3];
+}
+
+/**
+ * @brief Una sección biquad DF2T sobre un bloque, con I/Q en un par de lanes.
+ * @details Mismas ecuaciones que @ref biquad_df2t; los cinco coeficientes y los dos
+ * registros de estado quedan en registros durante todo el bloque. Solo se usa para la
+ * sección sobrante de un número impar de secciones.
+ * @param[in,out] st Contexto (coeficientes y estados de la sección @p s).
+ * @param[in]     s  Índice de la sección.
+ * @param[in,out] p  Pares I/Q intercalados.
+ * @param[in]     n  Número de muestras complejas.
+ */
+static void biquad_pairs(iq_iir_filter_t *st, int s, float *p, size_t n) {
+#if defined(IQ_IIR_NEON)
+    const float32x2_t b0 = vdup_n_f32(st->b0[s]), b1 = vdup_n_f32(st->b1[s]), b2 = vdup_n_f32(st->b2[s]);
+    const float32x2_t a1 = vdup_n_f32(st->a1[s]), a2 = vdup_n_f32(st->a2[s]);
+    float32x2_t z1 = { st->z1_i[s], st->z1_q[s] };
+    float32x2_t z2 = { st->z2_i[s], st->z2_q[s] };
+    for (size_t k = 0; k < n; ++k) {
+        const float32x2_t x = vld1_f32(p + 2 * k);
+        const float32x2_t y = vadd_f32(vmul_f32(b0, x), z1);
+        z1 = vadd_f32(vsub_f32(vmul_f32(b1, x), vmul_f32(a1, y)), z2);
+        z2 = vsub_f32(vmul_f32(b2, x), vmul_f32(a2, y));
+        vst1_f32(p + 2 * k, y);
+    }
+    st->z1_i[s] = vget_lane_f32(z1, 0); st->z1_q[s] = vget_lane_f32(z1, 1);
+    st->z2_i[s] = vget_lane_f32(z2, 0); st->z2_q[s] = vget_lane_f32(z2, 1);
+#elif defined(IQ_IIR_SSE)
+    const __m128 b0 = _mm_set1_ps(st->b0[s]), b1 = _mm_set1_ps(st->b1[s]), b2 = _mm_set1_ps(st->b2[s]);
+    const __m128 a1 = _mm_set1_ps(st->a1[s]), a2 = _mm_set1_ps(st->a2[s]);
+    __m128 z1 = _mm_setr_ps(st->z1_i[s], st->z1_q[s], 0.0f, 0.0f);
+    __m128 z2 = _mm_setr_ps(st->z2_i[s], st->z2_q[s], 0.0f, 0.0f);
+    for (size_t k = 0; k < n; ++k) {
+        const __m128 x = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)(p + 2 * k));
+        const __m128 y = _mm_add_ps(_mm_mul_ps(b0, x), z1);
+        z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, x), _mm_mul_ps(a1, y)), z2);
+        z2 = _mm_sub_ps(_mm_mul_ps(b2, x), _mm_mul_ps(a2, y));
+        _mm_storel_pi((__m64*)(p + 2 * k), y);
+    }
+    float s1[4], s2[4];
+    _mm_storeu_ps(s1, z1);
+    _mm_storeu_ps(s2, z2);
+    st->z1_i[s] = s1[0]; st->z1_q[s] = s1[1];
+    st->z2_i[s] = s2[0]; st->z2_q[s] = s2[1];
+#endif
+}
+#endif
+
+void iq_iir_filter_apply_cf32(iq_iir_filter_t *st, float complex *iq, size_t n) {
+    if (!st || !iq || n == 0 || !st->b0) return;
+
+    // float complex is laid out as [re, im]: the block is already an interleaved I/Q pair array
+    float *p = (float*)iq;
+#if defined(IQ_IIR_NEON) || defined(IQ_IIR_SSE)
+    if (st->enable_dc) dc_block_pairs(st, p, n);
+
+    int s = 0;
+    for (; s + 1 < st->sections; s += 2) biquad_two_sections(st, s, p, n);
+    if (s < st->sections) biquad_pairs(st, s, p, n);
+#else
+    // Without SIMD the per-sample cascade is faster: the out-of-order core overlaps sections
+    for (size_t k = 0; k < n; ++k) {
+        float xi = p[2 * k];
+        float xq = p[2 * k + 1];
 
-        // DC blocker
         if (st->enable_dc) {
             xi = dc_block_1p(xi, &st->dc_x1_i, &st->dc_y1_i, st->dc_r);
             xq = dc_block_1p(xq, &st->dc_x1_q, &st->dc_y1_q, st->dc_r);
         }
-
-        // Cascada biquads
         for (int s = 0; s < st->sections; ++s) {
             xi = biquad_df2t(xi, st->b0[s], st->b1[s], st->b2[s], st->a1[s], st->a2[s], &st->z1_i[s], &st->z2_i[s]);
             xq = biquad_df2t(xq, st->b0[s], st->b1[s], st->b2[s], st->a1[s], st->a2[s], &st->z1_q[s], &st->z2_q[s]);
         }
 
-        sig->signal_iq[n] = (double)xi + (double)xq * I;
+        p[2 * k]     = xi;
+        p[2 * k + 1] = xq;
+    }
+#endif
+}
+
+void iq_iir_filter_apply_inplace(iq_iir_filter_t *st, signal_iq_t *sig) {
+    if (!st || !sig || !sig->signal_iq) return;
+
+    // Solo hacemos LP para baseband (independiente del enum), porque es lo que necesitas para canal
+    // Si quieres apagarlo, lo controlas en rf_audio.c (no acá).
+    // double complex buffers go through the float32 block kernel in short stack-resident stages
+    float complex stage[IQ_IIR_STAGE_SAMPLES];
+    for (size_t n0 = 0; n0 < sig->n_signal; n0 += IQ_IIR_STAGE_SAMPLES) {
+        size_t cnt = sig->n_signal - n0;
+        if (cnt > IQ_IIR_STAGE_SAMPLES) cnt = IQ_IIR_STAGE_SAMPLES;
+
+        for (size_t k = 0; k < cnt; ++k) {
+            stage[k] = (float)creal(sig->signal_iq[n0 + k]) + (float)cimag(sig->signal_iq[n0 + k]) * I;
+        }
+        iq_iir_filter_apply_cf32(st, stage, cnt);
+        for (size_t k = 0; k < cnt; ++k) {
+            sig->signal_iq[n0 + k] = (double)crealf(stage[k]) + (double)cimagf(stage[k]) * I;
+        }
     }
 }
 
@@ -17,6 +17,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <complex.h>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -32,6 +33,8 @@ extern "C" {
  * @brief Filtro IIR Butterworth de precisión para señales en cuadratura (IQ).
  */
 
+#define IQ_IIR_MAX_SECTIONS 6 /**< Secciones para el orden máximo (12); todas se reservan en el init. */
+
 /**
  * @brief Estado interno del filtro IIR.
  * * Almacena los coeficientes y registros de estado para procesar señales IQ. 
@@ -81,13 +84,15 @@ typedef struct {
  * @param[in]  cfg             Configuración de audio (contiene orden y ancho de banda).
  * @param[in]  enable_dc_block Indica si se debe activar el filtro eliminador de DC.
  * @return int 0 en caso de éxito, -1 si falla la reserva de memoria.
+ * @note Es la única llamada que reserva: coeficientes y estados de @ref IQ_IIR_MAX_SECTIONS
+ * secciones en un solo bloque.
  */
 int  iq_iir_filter_init(iq_iir_filter_t *st, double fs_hz, const filter_audio_t *cfg, int enable_dc_block);
 
 /**
  * @brief Reconfigura dinámicamente los parámetros del filtro.
  * * Calcula nuevos coeficientes si cambian la frecuencia de muestreo, el orden o 
- * el ancho de banda. Si el orden cambia, se reasigna memoria automáticamente.
+ * el ancho de banda. Si el orden cambia se reinician los estados; no reserva memoria.
  *
  * @param[in,out] st    Puntero al estado del filtro.
  * @param[in]     fs_hz Nueva frecuencia de muestreo.
@@ -125,6 +130,22 @@ void iq_iir_filter_free(iq_iir_filter_t *st);
  */
 void iq_iir_filter_apply_inplace(iq_iir_filter_t *st, signal_iq_t *sig);
 
+/**
+ * @brief Filtra "in-place" un bloque IQ float32 sección por sección.
+ * @details Recorre el bloque completo por cada etapa (DC y luego cada biquad) en lugar de
+ * pasar cada muestra por toda la cascada: así los coeficientes de la sección viven en
+ * registros durante todo el bloque. I y Q van empaquetados en un par de lanes SIMD
+ * (NEON `float32x2_t`, SSE mitad baja de `__m128`, lazo escalar como respaldo), de modo
+ * que cada muestra compleja es una sola operación vectorial por tap.
+ * Es la ruta del hilo de audio; @ref iq_iir_filter_apply_inplace la reutiliza para buffers
+ * `double complex`.
+ *
+ * @param[in,out] st Contexto del filtro.
+ * @param[in,out] iq Muestras complejas float32 (I/Q intercalados).
+ * @param[in]     n  Número de muestras complejas.
+ */
+void iq_iir_filter_apply_cf32(iq_iir_filter_t *st, float complex *iq, size_t n);
+
 /** @} */
 
 #ifdef __cplusplus
@@ -0,0 +1,263 @@
+/**
+ * @file iq_record.c
+ * @brief Implementación de la grabación y lectura SigMF de capturas IQ.
+ */
+#include "iq_record.h"
+#include "utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cjson/cJSON.h>
+
+/**
+ * @addtogroup iq_record_module
+ * @{
+ */
+
+static const char *const k_data_ext = ".sigmf-data";
+static const char *const k_meta_ext = ".sigmf-meta";
+
+static int ends_with(const char *s, const char *suffix) {
+    const size_t n = strlen(s), m = strlen(suffix);
+    return n >= m && strcmp(s + n - m, suffix) == 0;
+}
+
+static int ensure_dir(const char *dir) {
+    struct stat st;
+    if (stat(dir, &st) == 0) return S_ISDIR(st.st_mode) ? 0 : -1;
+    return (mkdir(dir, 0755) == 0 || errno == EEXIST) ? 0 : -1;
+}
+
+static int write_meta(const char *path, const SDR_cfg_t *cfg, const char *datetime) {
+    cJSON *root = cJSON_CreateObject();
+    if (!root) return -1;
+
+    cJSON *global = cJSON_AddObjectToObject(root, "global");
+    cJSON *captures = cJSON_AddArrayToObject(root, "captures");
+    cJSON *annotations = cJSON_AddArrayToObject(root, "annotations");
+    cJSON *cap = cJSON_CreateObject();
+    if (!global || !captures || !annotations || !cap) {
+        cJSON_Delete(cap);
+        cJSON_Delete(root);
+        return -1;
+    }
+
+    cJSON_AddStringToObject(global, "core:datatype", "ci8");
+    cJSON_AddNumberToObject(global, "core:sample_rate", cfg->sample_rate);
+    cJSON_AddStringToObject(global, "core:version", "1.0.0");
+    cJSON_AddStringToObject(global, "core:hw", "HackRF One");
+    cJSON_AddStringToObject(global, "core:recorder", "rf_app");
+    cJSON_AddBoolToObject(global, "rf:amp_enabled", cfg->amp_enabled);
+    cJSON_AddNumberToObject(global, "rf:lna_gain", cfg->lna_gain);
+    cJSON_AddNumberToObject(global, "rf:vga_gain", cfg->vga_gain);
+    cJSON_AddNumberToObject(global, "rf:ppm_error", (double)cfg->ppm_error);
+    cJSON_AddNumberToObject(global, "rf:center_freq_corrected", (double)cfg->center_freq_corrected);
+
+    cJSON_AddNumberToObject(cap, "core:sample_start", 0);
+    cJSON_AddNumberToObject(cap, "core:frequency", (double)cfg->center_freq);
+    cJSON_AddStringToObject(cap, "core:datetime", datetime);
+    cJSON_AddItemToArray(captures, cap);
+
+    char *text = cJSON_Print(root);
+    cJSON_Delete(root);
+    if (!text) return -1;
+
+    int rc = -1;
+    FILE *fp = fopen(path, "w");
+    if (fp) {
+        const size_t len = strlen(text);
+        rc = (fwrite(text, 1, len, fp) == len) ? 0 : -1;
+        if (fclose(fp) != 0) rc = -1;
+    }
+    free(text);
+    return rc;
+}
+
+int iq_record_write(const char *dir, const SDR_cfg_t *cfg, const uint8_t *const spans[2],
+                    const size_t lens[2], char *out_base, size_t out_len) {
+    if (!cfg || !spans || !lens) return -1;
+
+    const size_t total = lens[0] + lens[1];
+    if (total == 0) return -1;
+
+    char *env_dir = NULL;
+    if (!dir) {
+        env_dir = getenv_c("RF_RECORD_DIR");
+        dir = env_dir ? env_dir : IQ_RECORD_DEFAULT_DIR;
+    }
+
+    char base[IQ_RECORD_PATH_MAX];
+    char data_path[IQ_RECORD_PATH_MAX + 16];
+    char meta_path[IQ_RECORD_PATH_MAX + 16];
+    char datetime[40];
+    {
+        struct timespec ts;
+        struct tm tm_utc;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        gmtime_r(&ts.tv_sec, &tm_utc);
+        const int ms = (int)(ts.tv_nsec / 1000000L);
+        char stamp[24];
+        strftime(stamp, sizeof(stamp), "%Y%m%dT%H%M%S", &tm_utc);
+        strftime(datetime, sizeof(datetime), "%Y-%m-%dT%H:%M:%S", &tm_utc);
+        snprintf(datetime + strlen(datetime), sizeof(datetime) - strlen(datetime), ".%03dZ", ms);
+        snprintf(base, sizeof(base), "%s/rf_%" PRIu64 "Hz_%s%03dZ", dir, cfg->center_freq, stamp, ms);
+    }
+    snprintf(data_path, sizeof(data_path), "%s%s", base, k_data_ext);
+    snprintf(meta_path, sizeof(meta_path), "%s%s", base, k_meta_ext);
+
+    if (ensure_dir(dir) != 0) {
+        fprintf(stderr, "[RF] Error: Recording directory '%s' unavailable: %s\n", dir, strerror(errno));
+        free(env_dir);
+        return -1;
+    }
+    free(env_dir);
+
+    int fd = open(data_path, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "[RF] Error: Cannot create %s: %s\n", data_path, strerror(errno));
+        return -1;
+    }
+
+    int rc = -1;
+    if (ftruncate(fd, (off_t)total) == 0) {
+        uint8_t *map = (uint8_t*)mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map != MAP_FAILED) {
+            memcpy(map, spans[0], lens[0]);
+            if (lens[1] > 0) memcpy(map + lens[0], spans[1], lens[1]);
+            rc = munmap(map, total);
+        }
+    }
+    if (close(fd) != 0) rc = -1;
+    if (rc == 0) rc = write_meta(meta_path, cfg, datetime);
+
+    if (rc != 0) {
+        fprintf(stderr, "[RF] Error: Recording %s failed: %s\n", base, strerror(errno));
+        unlink(data_path);
+        unlink(meta_path);
+        return -1;
+    }
+
+    if (out_base && out_len > 0) snprintf(out_base, out_len, "%s", base);
+    return 0;
+}
+
+static char *read_text_file(const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) return NULL;
+
+    char *buf = NULL;
+    if (fseek(fp, 0, SEEK_END) == 0) {
+        const long len = ftell(fp);
+        if (len > 0 && fseek(fp, 0, SEEK_SET) == 0) {
+            buf = (char*)malloc((size_t)len + 1);
+            if (buf && fread(buf, 1, (size_t)len, fp) == (size_t)len) {
+                buf[len] = '\0';
+            } else {
+                free(buf);
+                buf = NULL;
+            }
+        }
+    }
+    fclose(fp);
+    return buf;
+}
+
+static double json_number(const cJSON *obj, const char *key, double fallback) {
+    const cJSON *v = cJSON_GetObjectItemCaseSensitive(obj, key);
+    return cJSON_IsNumber(v) ? v->valuedouble : fallback;
+}
+
+static int parse_meta(const char *path, SDR_cfg_t *cfg) {
+    char *text = read_text_file(path);
+    if (!text) return 1; // no metadata: not an error, the caller sees zeros
+
+    cJSON *root = cJSON_Parse(text);
+    free(text);
+    if (!root) {
+        fprintf(stderr, "[RF] Error: Invalid SigMF metadata %s\n", path);
+        return -1;
+    }
+
+    int rc = 0;
+    const cJSON *global = cJSON_GetObjectItemCaseSensitive(root, "global");
+    const cJSON *dtype = cJSON_GetObjectItemCaseSensitive(global, "core:datatype");
+    if (cJSON_IsString(dtype) && strcmp(dtype->valuestring, "ci8") != 0) {
+        fprintf(stderr, "[RF] Error: Unsupported SigMF datatype '%s' (expected ci8)\n", dtype->valuestring);
+        rc = -1;
+    } else {
+        cfg->sample_rate = json_number(global, "core:sample_rate", 0.0);
+        cfg->lna_gain = (int)json_number(global, "rf:lna_gain", 0.0);
+        cfg->vga_gain = (int)json_number(global, "rf:vga_gain", 0.0);
+        cfg->ppm_error = (float)json_number(global, "rf:ppm_error", 0.0);
+        const cJSON *amp = cJSON_GetObjectItemCaseSensitive(global, "rf:amp_enabled");
+        cfg->amp_enabled = cJSON_IsTrue(amp);
+
+        const cJSON *captures = cJSON_GetObjectItemCaseSensitive(root, "captures");
+        const cJSON *cap0 = cJSON_IsArray(captures) ? cJSON_GetArrayItem(captures, 0) : NULL;
+        cfg->center_freq = (uint64_t)json_number(cap0, "core:frequency", 0.0);
+        cfg->center_freq_corrected = (uint64_t)json_number(global, "rf:center_freq_corrected",
+                                                           (double)cfg->center_freq);
+    }
+    cJSON_Delete(root);
+    return rc;
+}
+
+int iq_record_open(const char *path, iq_record_file_t *f) {
+    if (!path || !f) return -1;
+    memset(f, 0, sizeof(*f));
+
+    snprintf(f->base, sizeof(f->base), "%s", path);
+    const char *exts[2] = { k_data_ext, k_meta_ext };
+    for (int i = 0; i < 2; i++) {
+        if (ends_with(f->base, exts[i])) f->base[strlen(f->base) - strlen(exts[i])] = '\0';
+    }
+
+    char data_path[IQ_RECORD_PATH_MAX + 16];
+    char meta_path[IQ_RECORD_PATH_MAX + 16];
+    snprintf(data_path, sizeof(data_path), "%s%s", f->base, k_data_ext);
+    snprintf(meta_path, sizeof(meta_path), "%s%s", f->base, k_meta_ext);
+
+    if (parse_meta(meta_path, &f->cfg) < 0) return -1;
+
+    int fd = open(data_path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "[RF] Error: Cannot open %s: %s\n", data_path, strerror(errno));
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 2) {
+        fprintf(stderr, "[RF] Error: Empty or unreadable recording %s\n", data_path);
+        close(fd);
+        return -1;
+    }
+
+    const size_t n_bytes = (size_t)st.st_size & ~(size_t)1;
+    void *map = mmap(NULL, n_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "[RF] Error: mmap %s failed: %s\n", data_path, strerror(errno));
+        return -1;
+    }
+    (void)madvise(map, n_bytes, MADV_SEQUENTIAL);
+
+    f->data = (const uint8_t*)map;
+    f->n_bytes = n_bytes;
+    return 0;
+}
+
+void iq_record_close(iq_record_file_t *f) {
+    if (!f) return;
+    if (f->data) munmap((void*)f->data, f->n_bytes);
+    f->data = NULL;
+    f->n_bytes = 0;
+}
+
+/** @} */
@@ -0,0 +1,75 @@
+/**
+ * @file iq_record.h
+ * @brief Grabación y lectura de capturas IQ crudas en formato SigMF.
+ *
+ * Cada grabación son dos archivos con la misma base:
+ *   - `<base>.sigmf-data`: bytes int8 I,Q intercalados tal como llegan del HackRF (`ci8`).
+ *   - `<base>.sigmf-meta`: JSON SigMF 1.0 con `core:sample_rate`, `core:frequency`,
+ *     `core:datetime` y los parámetros de @ref SDR_cfg_t bajo el espacio de nombres `rf:`.
+ *
+ * Los datos se escriben y se leen por `mmap`: la grabación copia la captura del ring buffer
+ * directamente al mapeo del archivo y la lectura entrega punteros al mapeo sin copiar.
+ */
+
+#ifndef IQ_RECORD_H
+#define IQ_RECORD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sdr_HAL.h"
+
+/**
+ * @defgroup iq_record_module IQ Recording
+ * @ingroup rf_binary
+ * @brief Capturas IQ SigMF en disco.
+ * @{
+ */
+
+#define IQ_RECORD_DEFAULT_DIR "recordings" /**< Directorio si `RF_RECORD_DIR` no está en el `.env`. */
+#define IQ_RECORD_PATH_MAX 512             /**< Longitud máxima de una ruta base. */
+
+/**
+ * @brief Grabación abierta en solo lectura.
+ */
+typedef struct {
+    const uint8_t *data;  /**< Bytes IQ mapeados (NULL si no hay archivo abierto). */
+    size_t n_bytes;       /**< Bytes válidos (múltiplo de 2). */
+    SDR_cfg_t cfg;        /**< Configuración de adquisición leída del `.sigmf-meta`. */
+    char base[IQ_RECORD_PATH_MAX]; /**< Ruta base, sin extensión. */
+} iq_record_file_t;
+
+/**
+ * @brief Graba una captura (uno o dos tramos contiguos) con sus metadatos.
+ * @details Crea `<dir>/rf_<fc>_<UTC>.sigmf-data` y su `.sigmf-meta`. El directorio se crea si no
+ * existe. Con @p dir NULL se usa `RF_RECORD_DIR` del `.env` o @ref IQ_RECORD_DEFAULT_DIR.
+ * @param dir Directorio destino (NULL = configuración).
+ * @param cfg Configuración de adquisición de la captura.
+ * @param spans Tramos de bytes IQ (p. ej. los de @ref rb_peek_regions).
+ * @param lens Bytes de cada tramo.
+ * @param[out] out_base Ruta base escrita (puede ser NULL).
+ * @param out_len Capacidad de @p out_base.
+ * @return 0 en éxito, -1 en error (no quedan archivos a medias).
+ */
+int iq_record_write(const char *dir, const SDR_cfg_t *cfg, const uint8_t *const spans[2],
+                    const size_t lens[2], char *out_base, size_t out_len);
+
+/**
+ * @brief Abre una grabación SigMF y mapea sus datos.
+ * @details Acepta la ruta base o cualquiera de los dos archivos. Sin `.sigmf-meta` la captura se
+ * abre igual con `sample_rate` y `center_freq` en 0 (el llamador decide si es aceptable).
+ * Solo se admite `core:datatype` = `ci8`.
+ * @param path Ruta de la grabación.
+ * @param[out] f Grabación abierta.
+ * @return 0 en éxito, -1 en error.
+ */
+int iq_record_open(const char *path, iq_record_file_t *f);
+
+/**
+ * @brief Desmapea una grabación abierta con @ref iq_record_open.
+ * @param f Grabación.
+ */
+void iq_record_close(iq_record_file_t *f);
+
+/** @} */
+
+#endif
@@ -0,0 +1,96 @@
+/**
+ * @file iq_zoom.h
+ * @brief Zoom-FFT: conversión digital descendente (NCO + FIR diezmador) de la banda del filtro.
+ *
+ * Para una RBW fina sobre un span angosto, estimar la PSD a la tasa completa exige un `nperseg`
+ * proporcional a \f$ f_s / RBW \f$. En modo zoom la banda `[start_freq_hz, end_freq_hz]` del
+ * filtro se lleva a banda base y se diezma antes del estimador:
+ *   1. NCO: \f$ x[n] \, e^{-j 2\pi f_{nco} n / f_s} \f$ centra la banda en 0 Hz (in situ).
+ *   2. FIR pasa-bajos (sinc con ventana Blackman, corte \f$ f_{out}/2 \f$) evaluado solo en las
+ *      salidas retenidas, con \f$ D = \lfloor 0.75 \, f_s / B \rfloor \f$.
+ *
+ * Welch/PFB corren luego a \f$ f_{out} = f_s / D \f$: la misma RBW cuesta una FFT D veces más
+ * chica. El FIR diezmador es también el filtro de canal, así que @ref chan_filter_apply_inplace_abs
+ * no se aplica en este modo.
+ */
+
+#ifndef IQ_ZOOM_H
+#define IQ_ZOOM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <complex.h>
+#include "datatypes.h"
+
+/**
+ * @defgroup iq_zoom_module IQ Zoom
+ * @ingroup rf_binary
+ * @brief Conversión descendente y diezmado de la banda del filtro para la PSD.
+ * @{
+ */
+
+#define IQ_ZOOM_TAPS_PER_PHASE  32    /**< Taps del FIR por unidad de diezmado (transición ≈ 0.17 f_out). */
+#define IQ_ZOOM_MAX_DECIM       4096  /**< Máximo factor de diezmado. */
+#define IQ_ZOOM_USABLE_FRACTION 0.75  /**< Fracción de \f$ f_{out} \f$ que puede ocupar la banda (el resto es transición). */
+
+/**
+ * @brief FIR diezmador listo para @ref iq_zoom_run.
+ */
+typedef struct {
+    double *taps;   /**< Coeficientes (simétricos, ganancia DC unitaria). */
+    int n_taps;     /**< Longitud del FIR (IQ_ZOOM_TAPS_PER_PHASE·D + 1). */
+    int taps_cap;   /**< Capacidad de @ref taps. */
+    int decim;      /**< Factor D para el que se diseñaron los taps. */
+    double w_nco;   /**< Paso de fase del NCO (rad/muestra). */
+} iq_zoom_t;
+
+/**
+ * @brief Planifica el zoom de la banda @p band dentro de la captura.
+ * @details La banda se valida con @ref chan_filter_validate_cfg_abs contra la portadora corregida.
+ * Devuelve -1 (y deja @p out en cero) si la banda es inválida o tan ancha que D < 2.
+ * @param fs_hz Tasa de la captura (Hz).
+ * @param fc_hz Portadora nominal (eje publicado).
+ * @param fc_corrected_hz Portadora corregida por PPM (eje del DSP).
+ * @param band Banda a ampliar (frecuencias absolutas).
+ * @param[out] out Plan (ver @ref psd_zoom_t).
+ * @return 0 si el zoom aplica, -1 si no.
+ */
+int iq_zoom_plan(double fs_hz, uint64_t fc_hz, uint64_t fc_corrected_hz, const filter_t *band, psd_zoom_t *out);
+
+/**
+ * @brief Diseña (o reutiliza) los taps para @p plan. Solo reserva si crece el FIR.
+ * @param z Estado.
+ * @param plan Plan de @ref iq_zoom_plan (decim >= 2).
+ * @return 0 en éxito, -1 si el plan es inválido o falla la reserva.
+ */
+int iq_zoom_prepare(iq_zoom_t *z, const psd_zoom_t *plan);
+
+/**
+ * @brief Muestras de salida que produce @ref iq_zoom_run para @p n_in muestras de entrada.
+ * @param z Estado preparado.
+ * @param n_in Muestras de entrada.
+ * @return \f$ \lfloor (n_{in} - L) / D \rfloor + 1 \f$, o 0 si la captura es más corta que el FIR.
+ */
+size_t iq_zoom_output_len(const iq_zoom_t *z, size_t n_in);
+
+/**
+ * @brief Mezcla y diezma una captura.
+ * @details El NCO se aplica in situ sobre @p sig (la señal queda desplazada). Cada salida m es el
+ * producto del FIR con la ventana [m·D, m·D + L) de la entrada, de modo que las salidas son
+ * independientes y se reparten entre los hilos OpenMP sin estado compartido.
+ * @param z Estado preparado.
+ * @param[in,out] sig Captura a la tasa completa.
+ * @param[out] out Salida (capacidad >= @ref iq_zoom_output_len).
+ * @return Muestras escritas en @p out.
+ */
+size_t iq_zoom_run(const iq_zoom_t *z, signal_iq_t *sig, double complex *out);
+
+/**
+ * @brief Libera los taps.
+ * @param z Estado.
+ */
+void iq_zoom_free(iq_zoom_t *z);
+
+/** @} */
+
+#endif
@@ -0,0 +1,290 @@
+/**
+ * @file json_writer.c
+ * @brief Implementación del serializador JSON directo y de su pool de buffers.
+ */
+#include "json_writer.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @addtogroup json_writer_module
+ * @{
+ */
+
+/** Primer tamaño de un buffer: cubre los replies de estado y los espectros chicos. */
+#define JW_MIN_CAP 4096
+/** Peor caso de un bin: "-1.2345678901234567e+300," (fallback %1.17g). */
+#define JW_MAX_VALUE_CHARS 26
+
+static const int64_t k_pow10[JW_MAX_DECIMALS + 1] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+
+/**
+ * @brief Garantiza espacio para @p extra bytes más el NUL final en el buffer en curso.
+ * @return Puntero a la posición de escritura, o NULL si falló la reserva.
+ */
+static char *jw_room(json_writer_t *w, size_t extra) {
+    if (w->failed || !w->cur) return NULL;
+    const size_t need = w->len + extra + 1U;
+    if (w->cur->cap >= need) return w->cur->data + w->len;
+
+    size_t cap = w->cur->cap * 2U;
+    if (cap < need) cap = need;
+    jw_buf_t *b = (jw_buf_t*)realloc(w->cur, sizeof(jw_buf_t) + cap);
+    if (!b) {
+        w->failed = true;
+        return NULL;
+    }
+    b->cap = cap;
+    for (int i = 0; i < JW_POOL_LEN; i++) {
+        if (w->pool[i] == w->cur) w->pool[i] = b;
+    }
+    if (w->spill == w->cur) w->spill = b;
+    w->cur = b;
+    return b->data + w->len;
+}
+
+static void put_raw(json_writer_t *w, const char *s, size_t n) {
+    char *p = jw_room(w, n);
+    if (!p) return;
+    memcpy(p, s, n);
+    w->len += n;
+}
+
+static void put_string(json_writer_t *w, const char *s) {
+    static const char hex[] = "0123456789abcdef";
+    if (!s) s = "";
+    // Worst case every byte becomes \u00XX
+    char *p = jw_room(w, 6U * strlen(s) + 2U);
+    if (!p) return;
+    char *o = p;
+    *o++ = '"';
+    for (const unsigned char *c = (const unsigned char*)s; *c; c++) {
+        switch (*c) {
+            case '"':  *o++ = '\\'; *o++ = '"';  break;
+            case '\\': *o++ = '\\'; *o++ = '\\'; break;
+            case '\b': *o++ = '\\'; *o++ = 'b';  break;
+            case '\f': *o++ = '\\'; *o++ = 'f';  break;
+            case '\n': *o++ = '\\'; *o++ = 'n';  break;
+            case '\r': *o++ = '\\'; *o++ = 'r';  break;
+            case '\t': *o++ = '\\'; *o++ = 't';  break;
+            default:
+                if (*c < 0x20) {
+                    memcpy(o, "\\u00", 4);
+                    o += 4;
+                    *o++ = hex[*c >> 4];
+                    *o++ = hex[*c & 15];
+                } else {
+                    *o++ = (char)*c;
+                }
+        }
+    }
+    *o++ = '"';
+    w->len += (size_t)(o - p);
+}
+
+static void put_key(json_writer_t *w, const char *key) {
+    if (!w->first) put_raw(w, ",", 1);
+    w->first = false;
+    put_string(w, key);
+    put_raw(w, ":", 1);
+}
+
+/** @brief Número con el criterio de cJSON: %1.15g, o %1.17g si no reproduce el double. */
+static int format_number(char *dst, size_t cap, double d) {
+    if (!isfinite(d)) return snprintf(dst, cap, "null");
+    int n = snprintf(dst, cap, "%1.15g", d);
+    if (strtod(dst, NULL) != d) n = snprintf(dst, cap, "%1.17g", d);
+    return n;
+}
+
+/** @brief Punto fijo: round(|v|·10^d) en enteros, sin ceros a la derecha. @p dst tiene JW_MAX_VALUE_CHARS. */
+static char *format_fixed(char *dst, double v, int decimals) {
+    if (!isfinite(v)) {
+        memcpy(dst, "null", 4);
+        return dst + 4;
+    }
+    if (fabs(v) >= 1e12) return dst + format_number(dst, JW_MAX_VALUE_CHARS, v);
+
+    const int64_t scale = k_pow10[decimals];
+    int64_t q = llround(v * (double)scale);
+    if (q < 0) {
+        *dst++ = '-';
+        q = -q;
+    }
+    int64_t ip = q / scale, fp = q % scale;
+
+    char tmp[20];
+    int n = 0;
+    do {
+        tmp[n++] = (char)('0' + (int)(ip % 10));
+        ip /= 10;
+    } while (ip);
+    while (n) *dst++ = tmp[--n];
+
+    if (fp) {
+        *dst++ = '.';
+        for (int i = decimals - 1; i >= 0; i--) {
+            dst[i] = (char)('0' + (int)(fp % 10));
+            fp /= 10;
+        }
+        dst += decimals;
+        while (dst[-1] == '0') dst--;
+    }
+    return dst;
+}
+
+int jw_begin(json_writer_t *w) {
+    if (!w) return -1;
+    w->cur = NULL;
+    w->len = 0;
+    w->first = true;
+    w->failed = false;
+
+    for (int i = 0; i < JW_POOL_LEN && !w->cur; i++) {
+        if (!w->pool[i]) {
+            w->pool[i] = (jw_buf_t*)malloc(sizeof(jw_buf_t) + JW_MIN_CAP);
+            if (!w->pool[i]) break;
+            atomic_init(&w->pool[i]->state, 0);
+            w->pool[i]->cap = JW_MIN_CAP;
+        }
+        if (atomic_load_explicit(&w->pool[i]->state, memory_order_acquire) == 0) w->cur = w->pool[i];
+    }
+    if (!w->cur) {
+        // Every pooled buffer is still queued in ZMQ: this reply is sent by copy
+        if (!w->spill) {
+            w->spill = (jw_buf_t*)malloc(sizeof(jw_buf_t) + JW_MIN_CAP);
+            if (!w->spill) return -1;
+            atomic_init(&w->spill->state, 0);
+            w->spill->cap = JW_MIN_CAP;
+        }
+        w->cur = w->spill;
+    }
+
+    put_raw(w, "{", 1);
+    return w->failed ? -1 : 0;
+}
+
+void jw_reserve(json_writer_t *w, size_t extra) {
+    if (w) (void)jw_room(w, extra);
+}
+
+void jw_key_string(json_writer_t *w, const char *key, const char *value) {
+    if (!w) return;
+    put_key(w, key);
+    put_string(w, value);
+}
+
+void jw_key_number(json_writer_t *w, const char *key, double value) {
+    if (!w) return;
+    char tmp[32];
+    put_key(w, key);
+    const int n = format_number(tmp, sizeof(tmp), value);
+    if (n > 0) put_raw(w, tmp, (size_t)n);
+}
+
+void jw_key_int64(json_writer_t *w, const char *key, int64_t value) {
+    if (!w) return;
+    char tmp[24];
+    put_key(w, key);
+    const int n = snprintf(tmp, sizeof(tmp), "%lld", (long long)value);
+    if (n > 0) put_raw(w, tmp, (size_t)n);
+}
+
+void jw_key_bool(json_writer_t *w, const char *key, bool value) {
+    if (!w) return;
+    put_key(w, key);
+    if (value) put_raw(w, "true", 4);
+    else put_raw(w, "false", 5);
+}
+
+void jw_key_object(json_writer_t *w, const char *key) {
+    if (!w) return;
+    put_key(w, key);
+    put_raw(w, "{", 1);
+    w->first = true;
+}
+
+void jw_object_end(json_writer_t *w) {
+    if (!w) return;
+    put_raw(w, "}", 1);
+    w->first = false;
+}
+
+void jw_key_fixed_array(json_writer_t *w, const char *key, const double *v, int n, int decimals) {
+    if (!w) return;
+    if (decimals < 0) decimals = 0;
+    if (decimals > JW_MAX_DECIMALS) decimals = JW_MAX_DECIMALS;
+    put_key(w, key);
+    if (n < 0 || (n > 0 && !v)) n = 0;
+
+    // One reservation for the whole array, then unchecked writes
+    char *p = jw_room(w, (size_t)n * JW_MAX_VALUE_CHARS + 2U);
+    if (!p) return;
+    char *o = p;
+    *o++ = '[';
+    for (int i = 0; i < n; i++) {
+        if (i) *o++ = ',';
+        o = format_fixed(o, v[i], decimals);
+    }
+    *o++ = ']';
+    w->len += (size_t)(o - p);
+}
+
+void jw_splice(json_writer_t *w, const cJSON *obj) {
+    if (!w || !obj || !obj->child) return;
+    char *s = cJSON_PrintUnformatted(obj);
+    if (!s) {
+        w->failed = true;
+        return;
+    }
+    const size_t n = strlen(s);
+    if (n > 2) {
+        if (!w->first) put_raw(w, ",", 1);
+        w->first = false;
+        put_raw(w, s + 1, n - 2);
+    }
+    free(s);
+}
+
+int jw_end(json_writer_t *w) {
+    if (!w) return -1;
+    put_raw(w, "}", 1);
+    if (w->failed || !w->cur) return -1;
+    w->cur->data[w->len] = '\0';
+    return 0;
+}
+
+char *jw_data(json_writer_t *w, size_t *len) {
+    if (len) *len = (w && w->cur) ? w->len : 0;
+    return (w && w->cur) ? w->cur->data : NULL;
+}
+
+void *jw_handoff(json_writer_t *w) {
+    if (!w || !w->cur || w->cur == w->spill) return NULL;
+    atomic_store_explicit(&w->cur->state, 1, memory_order_release);
+    return w->cur;
+}
+
+void jw_release(void *data, void *hint) {
+    (void)data;
+    jw_buf_t *b = (jw_buf_t*)hint;
+    if (!b) return;
+    if (atomic_exchange_explicit(&b->state, 0, memory_order_acq_rel) == 2) free(b);
+}
+
+void jw_free(json_writer_t *w) {
+    if (!w) return;
+    for (int i = 0; i < JW_POOL_LEN; i++) {
+        jw_buf_t *b = w->pool[i];
+        // In flight: ZMQ still references it, jw_release frees it
+        if (b && atomic_exchange_explicit(&b->state, 2, memory_order_acq_rel) != 1) free(b);
+    }
+    free(w->spill);
+    memset(w, 0, sizeof(*w));
+}
+
+/** @} */
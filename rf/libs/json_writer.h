@@ -0,0 +1,159 @@
+/**
+ * @file json_writer.h
+ * @brief Serializador JSON directo a un buffer reutilizable, con entrega sin copia a ZMQ.
+ *
+ * El reply PSD en JSON es casi todo el arreglo `Pxx`: con cJSON cada bin es un nodo en el
+ * heap, el árbol se imprime a una cadena nueva, ZMQ la copia y todo se libera. El writer
+ * escribe las claves y los bins directamente sobre un buffer que crece por realloc y se
+ * conserva entre replies; los bins usan un formateador de punto fijo (los dBm no necesitan
+ * 17 cifras significativas).
+ *
+ * Los buffers forman un pool pequeño: al enviar, el buffer se entrega a ZMQ con
+ * `zmq_msg_init_data` (@ref jw_handoff + @ref jw_release) y vuelve al pool cuando el hilo de
+ * E/S de ZMQ termina con él. Si todos están en vuelo, el reply se escribe en un buffer de
+ * reserva que el llamador envía copiando.
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <cjson/cJSON.h>
+
+/**
+ * @defgroup json_writer_module JSON Writer
+ * @ingroup rf_binary
+ * @brief Serialización JSON sin árbol intermedio para los replies PSD.
+ * @{
+ */
+
+#define JW_POOL_LEN      2 /**< Buffers que pueden estar en vuelo en ZMQ a la vez. */
+#define JW_MAX_DECIMALS  6 /**< Máximo de decimales de @ref jw_key_fixed_array. */
+
+/**
+ * @brief Buffer del writer. Vive en el heap para que el callback de ZMQ pueda liberarlo
+ * aunque el writer ya no exista.
+ */
+typedef struct {
+    atomic_int state; /**< 0 = libre, 1 = en vuelo en ZMQ, 2 = huérfano (lo libera @ref jw_release). */
+    size_t cap;       /**< Capacidad de @ref data. */
+    char data[];      /**< Texto JSON. */
+} jw_buf_t;
+
+/**
+ * @brief Estado del writer (reutilizable entre replies).
+ */
+typedef struct {
+    jw_buf_t *pool[JW_POOL_LEN]; /**< Buffers que se entregan a ZMQ sin copia. */
+    jw_buf_t *spill;             /**< Buffer de reserva (nunca sale del writer). */
+    jw_buf_t *cur;               /**< Buffer del reply en curso. */
+    size_t len;                  /**< Bytes escritos en @ref cur. */
+    bool first;                  /**< El próximo miembro no lleva coma. */
+    bool failed;                 /**< Falló una reserva: @ref jw_end devuelve -1. */
+} json_writer_t;
+
+/**
+ * @brief Empieza un objeto JSON en un buffer libre del pool (o en el de reserva).
+ * @param w Writer.
+ * @return 0 en éxito, -1 si falló la reserva.
+ */
+int jw_begin(json_writer_t *w);
+
+/**
+ * @brief Reserva espacio para al menos @p extra bytes más (evita reallocs en arreglos largos).
+ * @param w Writer.
+ * @param extra Bytes adicionales previstos.
+ */
+void jw_reserve(json_writer_t *w, size_t extra);
+
+/**
+ * @brief Agrega `"key": "value"` con el escapado de JSON.
+ */
+void jw_key_string(json_writer_t *w, const char *key, const char *value);
+
+/**
+ * @brief Agrega `"key": número` con la misma precisión que cJSON (15 o 17 cifras).
+ */
+void jw_key_number(json_writer_t *w, const char *key, double value);
+
+/**
+ * @brief Agrega `"key": entero` sin pasar por double (índices de muestra y marcas en ns).
+ */
+void jw_key_int64(json_writer_t *w, const char *key, int64_t value);
+
+/**
+ * @brief Agrega `"key": true|false`.
+ */
+void jw_key_bool(json_writer_t *w, const char *key, bool value);
+
+/**
+ * @brief Abre `"key": {`; los miembros siguientes van dentro hasta @ref jw_object_end.
+ */
+void jw_key_object(json_writer_t *w, const char *key);
+
+/**
+ * @brief Cierra el objeto abierto por @ref jw_key_object.
+ */
+void jw_object_end(json_writer_t *w);
+
+/**
+ * @brief Agrega `"key": [v0, v1, ...]` con @p decimals decimales fijos (sin ceros a la derecha).
+ * @details Los valores no finitos se escriben como `null`, igual que cJSON. Magnitudes de
+ * 1e12 o más usan @ref jw_key_number.
+ * @param w Writer.
+ * @param key Clave.
+ * @param v Valores.
+ * @param n Número de valores.
+ * @param decimals Decimales (0 a @ref JW_MAX_DECIMALS).
+ */
+void jw_key_fixed_array(json_writer_t *w, const char *key, const double *v, int n, int decimals);
+
+/**
+ * @brief Copia los miembros de un objeto cJSON al objeto en curso.
+ * @details Para las secciones que ya construyen cJSON (detecciones, espectrograma, métricas).
+ * @param w Writer.
+ * @param obj Objeto cJSON (NULL o vacío no escribe nada).
+ */
+void jw_splice(json_writer_t *w, const cJSON *obj);
+
+/**
+ * @brief Cierra el objeto.
+ * @param w Writer.
+ * @return 0 si el texto está completo, -1 si alguna reserva falló.
+ */
+int jw_end(json_writer_t *w);
+
+/**
+ * @brief Texto del reply cerrado por @ref jw_end.
+ * @param w Writer.
+ * @param[out] len Bytes del texto (sin NUL).
+ * @return Puntero al texto (válido hasta el próximo @ref jw_begin o @ref jw_handoff).
+ */
+char *jw_data(json_writer_t *w, size_t *len);
+
+/**
+ * @brief Marca el buffer en curso como propiedad de ZMQ.
+ * @return Hint para `zmq_msg_init_data` junto con @ref jw_release, o NULL si el texto está en el
+ * buffer de reserva y el llamador debe enviarlo copiando.
+ */
+void *jw_handoff(json_writer_t *w);
+
+/**
+ * @brief Devuelve un buffer al pool (firma de `zmq_free_fn`; puede correr en el hilo de E/S de ZMQ).
+ * @param data Texto entregado.
+ * @param hint Valor devuelto por @ref jw_handoff.
+ */
+void jw_release(void *data, void *hint);
+
+/**
+ * @brief Libera los buffers; los que siguen en vuelo los libera @ref jw_release.
+ * @param w Writer.
+ */
+void jw_free(json_writer_t *w);
+
+/** @} */
+
+#endif
@@ -142,19 +142,23 @@ int ensure_tx_with_retry(audio_stream_ctx_t *ctx, opus_tx_t **ptx, volatile bool
     cfg.bitrate     = ctx->bitrate;
     cfg.complexity  = ctx->complexity;
     cfg.vbr         = ctx->vbr;
+    cfg.frame_samples     = (ctx->opus_sample_rate * ctx->frame_ms) / 1000;
+    cfg.frames_per_packet = ctx->frames_per_packet;
+    cfg.transport         = (opus_tx_transport_t)ctx->transport;
 
     while (running_flag && *running_flag) {
         opus_tx_t *tx = opus_tx_create(ctx->tcp_host, ctx->tcp_port, &cfg);
         if (tx) {
             *ptx = tx;
             fprintf(stderr,
-                    "[AUDIO] Connected Opus TX to %s:%d (sr=%d ch=%d frame_ms=%d bitrate=%d vbr=%d cplx=%d)\n",
-                    ctx->tcp_host, ctx->tcp_port,
-                    cfg.sample_rate, cfg.channels, ctx->frame_ms, cfg.bitrate, cfg.vbr, cfg.complexity);
+                    "[AUDIO] Opus TX %s -> %s:%d (sr=%d ch=%d frame_ms=%d frames/packet=%d bitrate=%d vbr=%d cplx=%d)\n",
+                    (cfg.transport == OPUS_TX_RTP) ? "rtp" : "tcp", ctx->tcp_host, ctx->tcp_port,
+                    cfg.sample_rate, cfg.channels, ctx->frame_ms, cfg.frames_per_packet,
+                    cfg.bitrate, cfg.vbr, cfg.complexity);
             return 0;
         }
 
-        fprintf(stderr, "[AUDIO] Waiting socket...\n");
+        fprintf(stderr, "[AUDIO] Opus TX setup failed. Retrying...\n");
 
         sleep_cancelable_ms(RECONNECT_DELAY_MS, running_flag);
     }
@@ -1,6 +1,6 @@
 /**
  * @file net_audio_retry.h
- * @brief Gestión de reintentos y robustez para la transmisión de audio sobre TCP.
+ * @brief Gestión de reintentos y robustez para la transmisión de audio sobre TCP/UDP.
  *
  * Este módulo proporciona utilidades para manejar conexiones persistentes,
  * envío de datos garantizado y mecanismos de reconexión automática en caso de fallos.
@@ -81,14 +81,15 @@ void sleep_cancelable_ms(int total_ms, volatile bool *running_flag);
 
 
 /**
- * @brief Asegura que el transmisor Opus esté conectado, reintentando si es necesario.
- * * Si el puntero al transmisor (*ptx) es nulo, entra en un bucle de reintento hasta que
- * logra establecer la conexión o hasta que el flag de ejecución se apague.
+ * @brief Asegura que exista el transmisor Opus, reintentando si no se pudo crear.
+ * * Si el puntero al transmisor (*ptx) es nulo, lo crea con el transporte y las tramas por
+ * paquete de @p ctx. La conexión la hace el hilo emisor del transmisor, así que esta
+ * función no espera a la red: solo reintenta si falla la creación (memoria, codificador).
  *
  * @param[in]  ctx          Contexto que contiene los parámetros de audio y red.
  * @param[out] ptx          Doble puntero donde se almacenará la instancia de @ref opus_tx_t creada.
  * @param[in]  running_flag Bandera que controla la continuidad del bucle de reintentos.
- * @return int 0 si el transmisor está listo/conectado, -1 si el proceso fue cancelado.
+ * @return int 0 si el transmisor está listo, -1 si el proceso fue cancelado.
  */
 int ensure_tx_with_retry(audio_stream_ctx_t *ctx, opus_tx_t **ptx, volatile bool *running_flag);
 
@@ -1,16 +1,28 @@
 /**
  * @file opus_tx.c
  * @brief Implementación interna del transmisor Opus.
- * * Contiene la lógica de red y el encapsulamiento de datos para la transmisión.
+ * * Contiene la lógica de red y el encapsulamiento de datos para la transmisión: el
+ * empaquetado TCP/RTP, la cola SPSC hacia el hilo emisor y el propio hilo emisor.
  */
 
 #include "opus_tx.h"
+#include "net_audio_retry.h"
+
+#include <poll.h>
+#include <strings.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/eventfd.h>
 
 /**
  * @addtogroup opus_module
  * @{
  */
 
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
 /**
  * @brief Cabecera de red para tramas Opus.
  * * Se envía de forma binaria antes de cada payload Opus para permitir
@@ -26,81 +38,289 @@ typedef struct {
 } OpusFrameHeader;
 #pragma pack(pop)
 
+#define RTP_HEADER_BYTES 12      /**< Cabecera RTP fija (sin CSRC ni extensiones). */
+#define RTP_CLOCK_HZ     48000   /**< RFC 7587: el reloj RTP de Opus es siempre 48 kHz. */
+#define TX_WAIT_SLICE_MS 100     /**< Espera máxima del emisor antes de revisar `running`. */
+
+/** Mayor paquete en cola: tramas TCP con cabecera, o RTP + paquete Opus repaquetizado. */
+#define OPUS_TX_SLOT_BYTES (OPUS_TX_MAX_FRAMES * (sizeof(OpusFrameHeader) + OPUS_TX_MAX_FRAME_BYTES))
+
+/** @brief Paquete listo para enviar. */
+typedef struct {
+    uint32_t len;                       /**< Bytes válidos de @ref data. */
+    uint8_t data[OPUS_TX_SLOT_BYTES];   /**< Paquete tal como sale al socket. */
+} opus_tx_slot_t;
+
 /**
  * @brief Contexto interno del transmisor.
  * * Mantiene el estado de la conexión, el contador de secuencia y el estado del codificador.
+ * El hilo de audio escribe `head` y el emisor escribe `tail` (cola SPSC sin locks).
  */
 struct opus_tx {
-    int sock_fd;        /**< Descriptor del socket TCP. */
-    uint32_t seq;       /**< Contador para el número de secuencia. */
-    OpusEncoder *enc;   /**< Puntero al estado del codificador Opus. */
-    opus_tx_cfg_t cfg;  /**< Copia local de la configuración. */
+    _Atomic int sock_fd;        /**< Descriptor del socket (-1 = desconectado; lo maneja el emisor). */
+    uint32_t seq;               /**< Contador para el número de secuencia (cabecera TCP, por trama). */
+    OpusEncoder *enc;           /**< Puntero al estado del codificador Opus. */
+    OpusRepacketizer *rp;       /**< Une varias tramas en un paquete Opus (RTP). */
+    opus_tx_cfg_t cfg;          /**< Copia local de la configuración. */
+    char host[256];             /**< Destino. */
+    int port;                   /**< Puerto destino. */
+
+    uint8_t frames[OPUS_TX_MAX_FRAMES][OPUS_TX_MAX_FRAME_BYTES]; /**< Tramas del paquete en curso. */
+    int frame_len[OPUS_TX_MAX_FRAMES]; /**< Bytes de cada trama en curso. */
+    int n_frames;               /**< Tramas reunidas del paquete en curso. */
+
+    uint16_t rtp_seq;           /**< Secuencia RTP (por paquete). */
+    uint32_t rtp_ts;            /**< Timestamp RTP del paquete en curso (reloj de 48 kHz). */
+    uint32_t rtp_ssrc;          /**< SSRC del stream. */
+    bool rtp_marker;            /**< Marcar el próximo paquete (inicio o tras descarte). */
+
+    opus_tx_slot_t *slots;      /**< Cola de @ref OPUS_TX_QUEUE_SLOTS paquetes. */
+    atomic_uint head;           /**< Paquetes encolados (productor). */
+    atomic_uint tail;           /**< Paquetes consumidos (emisor). */
+    int wake_fd;                /**< eventfd: hay paquetes o hay que salir. */
+    pthread_t thread;           /**< Hilo emisor. */
+    volatile bool running;      /**< El emisor sigue activo. */
 };
 
 /**
- * @brief Garantiza el envío de un bloque completo de datos a través de TCP.
- * * Debido a la naturaleza de los sockets de flujo, una llamada a `send` puede no
- * enviar todos los bytes solicitados. Esta función itera hasta completar el envío.
- * * @param[in] fd  Descriptor del socket.
- * @param[in] buf Puntero a los datos a enviar.
- * @param[in] n   Cantidad de bytes a transmitir.
- * * @return int 0 en caso de éxito, -1 si la conexión se cierra o falla.
+ * @brief Conecta un socket UDP al destino (solo fija la dirección por defecto de `send`).
+ * @return Descriptor, o -1 si no se pudo resolver o crear.
+ */
+static int connect_udp(const char *host, int port) {
+    char port_str[16];
+    snprintf(port_str, sizeof(port_str), "%d", port);
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    struct addrinfo *res = NULL;
+    if (getaddrinfo(host, port_str, &hints, &res) != 0) return -1;
+
+    int fd = -1;
+    for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) continue;
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+static bool tx_connect(opus_tx_t *tx) {
+    const int fd = (tx->cfg.transport == OPUS_TX_RTP) ? connect_udp(tx->host, tx->port)
+                                                      : connect_tcp_net_audio(tx->host, tx->port);
+    if (fd < 0) return false;
+
+    // Whatever piled up while disconnected is stale audio
+    atomic_store_explicit(&tx->tail, atomic_load_explicit(&tx->head, memory_order_acquire),
+                          memory_order_release);
+    atomic_store(&tx->sock_fd, fd);
+    fprintf(stderr, "[AUDIO] Connected Opus %s to %s:%d (frames/packet=%d)\n",
+            (tx->cfg.transport == OPUS_TX_RTP) ? "RTP/UDP" : "TCP",
+            tx->host, tx->port, tx->cfg.frames_per_packet);
+    return true;
+}
+
+static void tx_disconnect(opus_tx_t *tx) {
+    const int fd = atomic_exchange(&tx->sock_fd, -1);
+    if (fd >= 0) close(fd);
+}
+
+/** @return 0 enviado o descartable (UDP), -1 si la conexión TCP cayó. */
+static int tx_send_slot(opus_tx_t *tx, int fd, const opus_tx_slot_t *slot) {
+    if (tx->cfg.transport == OPUS_TX_RTP) {
+        // Datagrams are fire-and-forget: ECONNREFUSED only means nobody listens yet
+        (void)send(fd, slot->data, slot->len, MSG_DONTWAIT | MSG_NOSIGNAL);
+        return 0;
+    }
+    return send_all_net_audio(fd, slot->data, slot->len);
+}
+
+/**
+ * @brief Hilo emisor: conecta, vacía la cola y reconecta sin tocar el hilo de audio.
  */
-static int send_all(int fd, const void *buf, size_t n) {
-    const uint8_t *p = (const uint8_t*)buf;
-    while (n > 0) {
-        ssize_t w = send(fd, p, n, 0);
-        if (w <= 0) return -1;
-        p += (size_t)w;
-        n -= (size_t)w;
+static void *tx_sender_fn(void *arg) {
+    opus_tx_t *tx = (opus_tx_t*)arg;
+    bool warned = false;
+
+    while (tx->running) {
+        int fd = atomic_load(&tx->sock_fd);
+        if (fd < 0) {
+            if (!tx_connect(tx)) {
+                if (!warned) fprintf(stderr, "[AUDIO] Waiting socket...\n");
+                warned = true;
+                // The queue fills up meanwhile, so the producer reports the drops
+                sleep_cancelable_ms(RECONNECT_DELAY_MS, &tx->running);
+                continue;
+            }
+            warned = false;
+            fd = atomic_load(&tx->sock_fd);
+        }
+
+        struct pollfd pfd = { .fd = tx->wake_fd, .events = POLLIN, .revents = 0 };
+        if (poll(&pfd, 1, TX_WAIT_SLICE_MS) > 0) {
+            uint64_t v;
+            (void)read(tx->wake_fd, &v, sizeof(v));
+        }
+
+        unsigned tail = atomic_load_explicit(&tx->tail, memory_order_relaxed);
+        const unsigned head = atomic_load_explicit(&tx->head, memory_order_acquire);
+        while (tail != head && tx->running) {
+            const opus_tx_slot_t *slot = &tx->slots[tail & (OPUS_TX_QUEUE_SLOTS - 1)];
+            if (tx_send_slot(tx, fd, slot) != 0) {
+                fprintf(stderr, "[AUDIO] WARN: Opus TCP send failed. Reconnecting...\n");
+                tx_disconnect(tx);
+                break;
+            }
+            tail++;
+            atomic_store_explicit(&tx->tail, tail, memory_order_release);
+        }
     }
+    return NULL;
+}
+
+/** @return Slot libre del productor, o NULL si la cola está llena. */
+static opus_tx_slot_t *queue_reserve(opus_tx_t *tx) {
+    const unsigned head = atomic_load_explicit(&tx->head, memory_order_relaxed);
+    const unsigned tail = atomic_load_explicit(&tx->tail, memory_order_acquire);
+    if (head - tail >= OPUS_TX_QUEUE_SLOTS) return NULL;
+    return &tx->slots[head & (OPUS_TX_QUEUE_SLOTS - 1)];
+}
+
+static void queue_commit(opus_tx_t *tx) {
+    atomic_fetch_add_explicit(&tx->head, 1U, memory_order_release);
+    const uint64_t one = 1;
+    (void)write(tx->wake_fd, &one, sizeof(one));
+}
+
+/** @brief TCP: las tramas en curso, cada una con su cabecera, como un solo envío. */
+static int build_tcp(opus_tx_t *tx, opus_tx_slot_t *slot) {
+    size_t off = 0;
+    for (int i = 0; i < tx->n_frames; i++) {
+        OpusFrameHeader h;
+        h.magic      = htonl(0x4F505530);
+        h.seq        = htonl(tx->seq++);
+        h.sample_rate= htonl((uint32_t)tx->cfg.sample_rate);
+        h.channels   = htons((uint16_t)tx->cfg.channels);
+        h.payload_len= htons((uint16_t)tx->frame_len[i]);
+        if (!slot) continue; // dropped: the sequence still advances so the receiver sees the gap
+
+        memcpy(slot->data + off, &h, sizeof(h));
+        off += sizeof(h);
+        memcpy(slot->data + off, tx->frames[i], (size_t)tx->frame_len[i]);
+        off += (size_t)tx->frame_len[i];
+    }
+    if (slot) slot->len = (uint32_t)off;
     return 0;
 }
 
 /**
- * @brief Crea un socket TCP y se conecta al destino especificado.
- * * Realiza la resolución de dirección (vía aton/pton) y establece la comunicación.
- * * @param[in] host Cadena con la dirección IP de destino.
- * @param[in] port Puerto de destino.
- * * @return int Descriptor del socket conectado, o -1 en caso de error.
+ * @brief RTP: une las tramas en un paquete Opus (código 3) bajo una cabecera RFC 3550.
+ * @return Tramas incluidas (una trama con otra configuración TOC queda para el siguiente paquete).
  */
-static int connect_tcp(const char *host, int port) {
-    int fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (fd < 0) return -1;
-
-    struct sockaddr_in addr;
-    memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons((uint16_t)port);
-    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
-        close(fd);
-        return -1;
+static int build_rtp(opus_tx_t *tx, opus_tx_slot_t *slot, int first, int *out_frames) {
+    opus_repacketizer_init(tx->rp);
+    int n = 0;
+    for (int i = first; i < tx->n_frames; i++) {
+        if (opus_repacketizer_cat(tx->rp, tx->frames[i], tx->frame_len[i]) != OPUS_OK) {
+            if (n == 0) return -1;
+            break;
+        }
+        n++;
     }
-    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
-        close(fd);
-        return -1;
+    *out_frames = n;
+
+    const uint32_t ts = tx->rtp_ts;
+    const uint16_t seq = tx->rtp_seq++;
+    const uint32_t ts_per_frame = (uint32_t)tx->cfg.frame_samples * (RTP_CLOCK_HZ / (uint32_t)tx->cfg.sample_rate);
+    tx->rtp_ts += (uint32_t)n * ts_per_frame;
+    if (!slot) {
+        // Lost packet: seq/ts still advance so the jitter buffer conceals the gap
+        tx->rtp_marker = true;
+        return 0;
     }
-    return fd;
+
+    const opus_int32 len = opus_repacketizer_out(tx->rp, slot->data + RTP_HEADER_BYTES,
+                                                 (opus_int32)(sizeof(slot->data) - RTP_HEADER_BYTES));
+    if (len < 0) return -1;
+
+    uint8_t *h = slot->data;
+    h[0] = 0x80; // V=2, no padding/extension/CSRC
+    h[1] = (uint8_t)((tx->rtp_marker ? 0x80 : 0x00) | OPUS_RTP_PAYLOAD_TYPE);
+    h[2] = (uint8_t)(seq >> 8);
+    h[3] = (uint8_t)seq;
+    h[4] = (uint8_t)(ts >> 24);
+    h[5] = (uint8_t)(ts >> 16);
+    h[6] = (uint8_t)(ts >> 8);
+    h[7] = (uint8_t)ts;
+    h[8]  = (uint8_t)(tx->rtp_ssrc >> 24);
+    h[9]  = (uint8_t)(tx->rtp_ssrc >> 16);
+    h[10] = (uint8_t)(tx->rtp_ssrc >> 8);
+    h[11] = (uint8_t)tx->rtp_ssrc;
+    slot->len = (uint32_t)(RTP_HEADER_BYTES + len);
+    tx->rtp_marker = false;
+    return 0;
+}
+
+/** @return 0 encolado, 1 descartado por cola llena, -1 error de empaquetado. */
+static int flush_packet(opus_tx_t *tx) {
+    int rc = 0;
+    if (tx->cfg.transport == OPUS_TX_RTP) {
+        int first = 0;
+        while (first < tx->n_frames) {
+            opus_tx_slot_t *slot = queue_reserve(tx);
+            int used = 0;
+            if (build_rtp(tx, slot, first, &used) != 0) {
+                rc = -1;
+                break;
+            }
+            if (slot) queue_commit(tx);
+            else rc = 1;
+            first += used;
+        }
+    } else {
+        opus_tx_slot_t *slot = queue_reserve(tx);
+        build_tcp(tx, slot);
+        if (slot) queue_commit(tx);
+        else rc = 1;
+    }
+    tx->n_frames = 0;
+    return rc;
+}
+
+opus_tx_transport_t opus_tx_transport_from_str(const char *name) {
+    if (name && (strcasecmp(name, "rtp") == 0 || strcasecmp(name, "udp") == 0)) return OPUS_TX_RTP;
+    return OPUS_TX_TCP;
 }
 
 opus_tx_t* opus_tx_create(const char *host, int port, const opus_tx_cfg_t *cfg) {
-    if (!host || !cfg) return NULL;
+    if (!host || !cfg || port <= 0 || port > 65535) return NULL;
+    if (cfg->frame_samples <= 0 || cfg->sample_rate <= 0 || RTP_CLOCK_HZ % cfg->sample_rate != 0) return NULL;
 
     opus_tx_t *tx = (opus_tx_t*)calloc(1, sizeof(*tx));
     if (!tx) return NULL;
 
     tx->cfg = *cfg;
-    tx->sock_fd = connect_tcp(host, port);
-    if (tx->sock_fd < 0) {
-        free(tx);
-        return NULL;
-    }
+    if (tx->cfg.frames_per_packet < 1) tx->cfg.frames_per_packet = 1;
+    if (tx->cfg.frames_per_packet > OPUS_TX_MAX_FRAMES) tx->cfg.frames_per_packet = OPUS_TX_MAX_FRAMES;
+    snprintf(tx->host, sizeof(tx->host), "%s", host);
+    tx->port = port;
+    atomic_init(&tx->sock_fd, -1);
+    atomic_init(&tx->head, 0U);
+    atomic_init(&tx->tail, 0U);
+    tx->wake_fd = -1;
 
     int err = 0;
     tx->enc = opus_encoder_create(cfg->sample_rate, cfg->channels, OPUS_APPLICATION_AUDIO, &err);
-    if (!tx->enc || err != OPUS_OK) {
-        close(tx->sock_fd);
-        free(tx);
+    tx->rp = opus_repacketizer_create();
+    tx->slots = (opus_tx_slot_t*)malloc(sizeof(opus_tx_slot_t) * OPUS_TX_QUEUE_SLOTS);
+    tx->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (!tx->enc || err != OPUS_OK || !tx->rp || !tx->slots || tx->wake_fd < 0) {
+        opus_tx_destroy(tx);
         return NULL;
     }
 
@@ -108,38 +328,57 @@ opus_tx_t* opus_tx_create(const char *host, int port, const opus_tx_cfg_t *cfg)
     opus_encoder_ctl(tx->enc, OPUS_SET_COMPLEXITY(cfg->complexity));
     opus_encoder_ctl(tx->enc, OPUS_SET_VBR(cfg->vbr));
 
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
     tx->seq = 0;
+    tx->rtp_ssrc = (uint32_t)now.tv_nsec ^ ((uint32_t)getpid() << 16);
+    tx->rtp_seq = (uint16_t)(now.tv_nsec >> 8);
+    tx->rtp_ts = (uint32_t)now.tv_sec * 7919U;
+    tx->rtp_marker = true;
+
+    tx->running = true;
+    if (pthread_create(&tx->thread, NULL, tx_sender_fn, tx) != 0) {
+        tx->running = false;
+        opus_tx_destroy(tx);
+        return NULL;
+    }
     return tx;
 }
 
 int opus_tx_send_frame(opus_tx_t *tx, const int16_t *pcm, int frame_samples) {
-    if (!tx || !pcm) return -1;
+    if (!tx || !pcm || frame_samples != tx->cfg.frame_samples) return -1;
 
-    uint8_t opus_out[1500];
-    int n = opus_encode(tx->enc, pcm, frame_samples, opus_out, (opus_int32)sizeof(opus_out));
+    const int n = opus_encode(tx->enc, pcm, frame_samples, tx->frames[tx->n_frames],
+                              (opus_int32)OPUS_TX_MAX_FRAME_BYTES);
     if (n < 0) return -1;
+    tx->frame_len[tx->n_frames++] = n;
 
-    OpusFrameHeader h;
-    h.magic      = htonl(0x4F505530);
-    h.seq        = htonl(tx->seq++);
-    h.sample_rate= htonl((uint32_t)tx->cfg.sample_rate);
-    h.channels   = htons((uint16_t)tx->cfg.channels);
-    h.payload_len= htons((uint16_t)n);
-
-    if (send_all(tx->sock_fd, &h, sizeof(h)) != 0) return -1;
-    if (send_all(tx->sock_fd, opus_out, (size_t)n) != 0) return -1;
-    return 0;
+    if (tx->n_frames < tx->cfg.frames_per_packet) return 0;
+    return flush_packet(tx);
 }
 
 void opus_tx_destroy(opus_tx_t *tx) {
     if (!tx) return;
-    if (tx->sock_fd >= 0) close(tx->sock_fd);
+    if (tx->running) {
+        tx->running = false;
+        const uint64_t one = 1;
+        (void)write(tx->wake_fd, &one, sizeof(one));
+        pthread_join(tx->thread, NULL);
+    }
+    tx_disconnect(tx);
+    if (tx->wake_fd >= 0) close(tx->wake_fd);
+    if (tx->rp) opus_repacketizer_destroy(tx->rp);
     if (tx->enc) opus_encoder_destroy(tx->enc);
+    free(tx->slots);
     free(tx);
 }
 
 int opus_tx_fd(const opus_tx_t *tx) {
-    return tx ? tx->sock_fd : -1;
+    return tx ? atomic_load(&tx->sock_fd) : -1;
+}
+
+bool opus_tx_connected(const opus_tx_t *tx) {
+    return opus_tx_fd(tx) >= 0;
 }
 
 /** @} */
@@ -1,8 +1,13 @@
 /**
  * @file opus_tx.h
- * @brief Interfaz para la transmisión de audio codificado en Opus sobre TCP.
+ * @brief Interfaz para la transmisión de audio codificado en Opus sobre TCP o RTP/UDP.
  * * Este módulo proporciona una abstracción para inicializar un codificador Opus,
- * establecer una conexión TCP y enviar tramas de audio con una cabecera personalizada.
+ * establecer la conexión y enviar tramas de audio, ya sea con la cabecera propia sobre TCP
+ * o como RTP (RFC 7587) sobre UDP.
+ *
+ * El hilo de audio solo codifica y encola: un hilo emisor propio del transmisor hace
+ * la conexión, las reconexiones y los `send`, así que una caída o un atasco de red
+ * descarta paquetes en la cola en vez de frenar la demodulación.
  */
 
 #pragma once
@@ -15,6 +20,8 @@
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
+#include <stdatomic.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -23,10 +30,26 @@ extern "C" {
 /**
  * @defgroup opus_module Opus Module
  * @ingroup rf_binary
- * @brief Modulo para la transmision de audio codificado en Opus sobre TCP
+ * @brief Modulo para la transmision de audio codificado en Opus sobre TCP o RTP/UDP
  * @{}
  */
 
+/** @name Cola de envío */
+/**@{*/
+#define OPUS_TX_QUEUE_SLOTS    32  /**< Paquetes en cola hacia el hilo emisor (potencia de dos). */
+#define OPUS_TX_MAX_FRAMES     6   /**< Máximo de tramas por paquete (el límite de Opus es 120 ms). */
+#define OPUS_TX_MAX_FRAME_BYTES 1275 /**< Mayor trama Opus codificada (RFC 6716). */
+#define OPUS_RTP_PAYLOAD_TYPE  96  /**< Payload type dinámico del stream RTP. */
+/**@}*/
+
+/**
+ * @brief Transporte del stream Opus.
+ */
+typedef enum {
+    OPUS_TX_TCP = 0, /**< Cabecera @ref OpusFrameHeader por trama sobre TCP. */
+    OPUS_TX_RTP = 1  /**< RTP/Opus (RFC 7587) sobre UDP. */
+} opus_tx_transport_t;
+
 /**
  * @brief Estructura opaca que representa el contexto del transmisor Opus.
  */
@@ -42,48 +65,69 @@ typedef struct {
     int bitrate;        /**< Tasa de bits en bps (ej. 64000). */
     int complexity;     /**< Complejidad computacional (0-10). */
     int vbr;            /**< Variable Bitrate: 1 para habilitar, 0 para CBR (Constant Bitrate). */
+    int frame_samples;  /**< Muestras por canal de cada trama (ej. 960 para 20 ms a 48 kHz). */
+    int frames_per_packet; /**< Tramas por paquete/envío (1..@ref OPUS_TX_MAX_FRAMES). */
+    opus_tx_transport_t transport; /**< TCP o RTP/UDP. */
 } opus_tx_cfg_t;
 
 /**
- * @brief Crea una instancia del transmisor e inicia la conexión de red.
- * * Reserva memoria para el contexto, inicializa el motor Opus con la configuración
- * proporcionada e intenta establecer una conexión TCP con el host remoto.
+ * @brief Crea una instancia del transmisor y arranca su hilo emisor.
+ * * Reserva memoria para el contexto y la cola, inicializa el motor Opus con la configuración
+ * proporcionada y lanza el hilo que se conecta (y reconecta) al host remoto. No espera
+ * a la red: la función retorna aunque el destino todavía no responda.
  * * @param[in] host Dirección IP o nombre de dominio del servidor destino.
- * @param[in] port Puerto TCP de destino.
+ * @param[in] port Puerto TCP/UDP de destino.
  * @param[in] cfg  Puntero a la estructura de configuración del codificador.
- * * @return opus_tx_t* Puntero al contexto creado, o NULL en caso de error (red, memoria o parámetros).
+ * * @return opus_tx_t* Puntero al contexto creado, o NULL en caso de error (memoria, codificador, hilo o parámetros).
  * @note La memoria retornada debe ser liberada con opus_tx_destroy().
  */
 opus_tx_t* opus_tx_create(const char *host, int port, const opus_tx_cfg_t *cfg);
 
 /**
- * @brief Codifica y envía una trama de audio PCM.
- * * Toma una muestra de audio en crudo, la comprime usando el formato Opus y la
- * transmite a través del socket TCP precedida por una cabecera de protocolo @ref OpusFrameHeader.
+ * @brief Codifica una trama de audio PCM y la encola para el hilo emisor.
+ * * Comprime la trama con Opus y la agrega al paquete en curso; al reunir
+ * `frames_per_packet` tramas el paquete pasa a la cola sin bloquear. En TCP cada trama
+ * conserva su cabecera @ref OpusFrameHeader y el paquete es un solo `send`; en RTP las
+ * tramas se juntan en un único paquete Opus (repacketizer) bajo una cabecera RTP.
  * * @param[in,out] tx            Contexto del transmisor.
  * @param[in]     pcm           Puntero al buffer con muestras de audio (int16_t).
  * @param[in]     frame_samples Número de muestras por canal (ej. 960 para 20ms a 48kHz).
- * * @return int 0 si la operación fue exitosa, -1 si ocurrió un error en la codificación o envío.
+ * * @return int 0 si la trama quedó en curso o encolada, 1 si el paquete se descartó porque
+ * la cola estaba llena (red caída o lenta), -1 si falló la codificación.
  */
 int  opus_tx_send_frame(opus_tx_t *tx, const int16_t *pcm, int frame_samples);
 
 /**
  * @brief Cierra la conexión y libera los recursos asociados.
- * * Finaliza la conexión TCP, destruye el codificador interno de Opus y libera
- * la memoria del contexto.
+ * * Detiene el hilo emisor, cierra el socket, destruye el codificador interno de Opus y
+ * libera la memoria del contexto.
  * * @param[in] tx Contexto a destruir. Si es NULL, la función no hace nada.
  */
 void opus_tx_destroy(opus_tx_t *tx);
 
 /**
  * @brief Obtiene el descriptor de archivo (socket) asociado al transmisor.
- * * Útil para integrar el transmisor en bucles de eventos (select/poll/epoll)
- * o para configurar opciones de socket adicionales.
+ * * Útil para configurar opciones de socket adicionales. Lo gestiona el hilo emisor y
+ * cambia en cada reconexión.
  * * @param[in] tx Contexto del transmisor.
- * @return int Descriptor del socket, o -1 si el contexto es inválido.
+ * @return int Descriptor del socket, o -1 si el contexto es inválido o no hay conexión.
  */
 int  opus_tx_fd(const opus_tx_t *tx);
 
+/**
+ * @brief Indica si el hilo emisor tiene hoy un socket conectado.
+ * @param[in] tx Contexto del transmisor.
+ * @return true si está conectado.
+ */
+bool opus_tx_connected(const opus_tx_t *tx);
+
+/**
+ * @brief Interpreta el nombre del transporte ("tcp" o "rtp"/"udp").
+ * @param[in] name Texto (NULL o desconocido = TCP).
+ * @return Transporte.
+ */
+opus_tx_transport_t opus_tx_transport_from_str(const char *name);
+
 /** @} */
 
 #ifdef __cplusplus
@@ -47,11 +47,15 @@ char* strdup_lowercase(const char *str) {
  */
 static void set_default_config(DesiredCfg_t *target) {
     if (!target) return;
+    // Zero padding too: rf_app fingerprints requests with memcmp
+    memset(target, 0, sizeof(*target));
 
     // Core Settings
     target->rf_mode        = PSD_MODE;      // Default: PSD
     target->method_psd     = WELCH;         // Default: Welch
     target->calibrate      = false;
+    target->calibrate_force = false;
+    target->n_cal_refs     = 0;             // Default: CAL_FM_REFS or the cached legal_freqs
     
     // Hardware Settings
     target->center_freq    = 98000000ULL;   // Default: 98 MHz
@@ -65,14 +69,57 @@ static void set_default_config(DesiredCfg_t *target) {
     // PSD Settings
     target->rbw            = 100000;        // Default: 100 kHz
     target->overlap        = 0.5;           // Standard 50% default
+    target->target_averages = 0;            // Default: Fs/4 bytes per capture
     target->window_type    = HAMMING_TYPE;  // Default: 0
     target->cooldown_request = 1.0;         // Default: 1 second
     target->cooldown_request_set = false;
+#ifdef RF_IQ_FLOAT32_DEFAULT
+    target->iq_precision   = IQ_PRECISION_F32; // Build-time default: float32 pipeline
+#else
+    target->iq_precision   = IQ_PRECISION_F64;
+#endif
 
     // Filter Settings
     target->filter_enabled = false;         // Default: Filter NULL/Off
     target->filter_cfg.start_freq_hz = 0;
     target->filter_cfg.end_freq_hz   = 0;
+    target->filter_cfg.mode          = CHAN_FILTER_AUTO;
+    target->zoom = false;
+
+    // Reply Settings
+    target->reply_format   = REPLY_FORMAT_JSON; // Default: JSON "Pxx"
+
+    // Streaming Settings
+    target->stream_enabled = false;         // Default: one request, one capture
+    target->stream_rate_hz = 0.0;
+    target->stream_frames  = 0;
+    target->stream_pipeline = true;         // Default: double-buffered send
+
+    // Sweep Settings
+    target->sweep_enabled  = false;         // Default: single capture at center_freq
+    target->sweep_start_hz = 0;
+    target->sweep_end_hz   = 0;
+
+    // Trace Averaging
+    target->avg_mode  = PSD_AVG_OFF;        // Default: every reply is its own capture
+    target->avg_count = 0;
+    target->avg_alpha = 0.0;
+    target->avg_reset = false;
+
+    // Instrumentation
+    target->metrics_enabled = false;
+    target->stats_request   = false;
+    target->stats_reset     = false;
+    target->record          = false;
+
+    // Output Reduction
+    target->out_crop = false;               // Default: full span, all nperseg bins
+    target->out_bins = 0;
+    target->out_pool = PSD_POOL_MAX;
+
+    // On-device Detection
+    memset(&target->detect, 0, sizeof(target->detect)); // Default: off, full Pxx only
+    memset(&target->spectrogram, 0, sizeof(target->spectrogram)); // Default: off, u8 rows
 }
 
 int parse_config_rf(const char *json_string, DesiredCfg_t *target) {
@@ -88,7 +135,33 @@ int parse_config_rf(const char *json_string, DesiredCfg_t *target) {
     } 
 
     cJSON *calib = cJSON_GetObjectItemCaseSensitive(root, "calibrate");
-    if (cJSON_IsBool(calib)) target->calibrate = cJSON_IsTrue(calib);
+    if (cJSON_IsBool(calib)) {
+        target->calibrate = cJSON_IsTrue(calib);
+    } else if (cJSON_IsString(calib) && calib->valuestring && strcasecmp(calib->valuestring, "force") == 0) {
+        target->calibrate = true;
+        target->calibrate_force = true;
+    }
+
+    cJSON *cal_refs = cJSON_GetObjectItemCaseSensitive(root, "cal_refs_hz");
+    if (cJSON_IsArray(cal_refs)) {
+        const cJSON *ref = NULL;
+        cJSON_ArrayForEach(ref, cal_refs) {
+            if (target->n_cal_refs >= RF_CAL_MAX_REFS) break;
+            // MHz values (as kal_sync_legal_FM.get_legal_freqs returns them) are accepted too
+            if (cJSON_IsNumber(ref) && ref->valuedouble > 0.0) {
+                target->cal_refs_hz[target->n_cal_refs++] =
+                    (ref->valuedouble < 10000.0) ? ref->valuedouble * 1e6 : ref->valuedouble;
+            }
+        }
+    }
+
+    cJSON *stats = cJSON_GetObjectItemCaseSensitive(root, "stats");
+    if (cJSON_IsBool(stats)) {
+        target->stats_request = cJSON_IsTrue(stats);
+    } else if (cJSON_IsString(stats) && stats->valuestring && strcasecmp(stats->valuestring, "reset") == 0) {
+        target->stats_request = true;
+        target->stats_reset = true;
+    }
 
     // 2. Parse Core Hardware Parameters FIRST (Required for clamping logic)
     cJSON *cf = cJSON_GetObjectItemCaseSensitive(root, "center_freq_hz");
@@ -124,6 +197,16 @@ int parse_config_rf(const char *json_string, DesiredCfg_t *target) {
         if (target->filter_cfg.end_freq_hz < target->filter_cfg.start_freq_hz) {
              target->filter_cfg.end_freq_hz = target->filter_cfg.start_freq_hz;
         }
+
+        cJSON *fmode = cJSON_GetObjectItemCaseSensitive(filt_obj, "mode");
+        if (cJSON_IsString(fmode) && fmode->valuestring) {
+            if (strcasecmp(fmode->valuestring, "whole") == 0)      target->filter_cfg.mode = CHAN_FILTER_WHOLE;
+            else if (strcasecmp(fmode->valuestring, "block") == 0) target->filter_cfg.mode = CHAN_FILTER_BLOCK;
+            else                                                   target->filter_cfg.mode = CHAN_FILTER_AUTO;
+        }
+
+        cJSON *zoom = cJSON_GetObjectItemCaseSensitive(filt_obj, "zoom");
+        if (cJSON_IsBool(zoom)) target->zoom = cJSON_IsTrue(zoom);
     }
 
     // 4. Engine Mode / Demodulation
@@ -146,6 +229,9 @@ int parse_config_rf(const char *json_string, DesiredCfg_t *target) {
     cJSON *ov = cJSON_GetObjectItemCaseSensitive(root, "overlap");
     if (cJSON_IsNumber(ov)) target->overlap = ov->valuedouble;
 
+    cJSON *avgs = cJSON_GetObjectItemCaseSensitive(root, "target_averages");
+    if (cJSON_IsNumber(avgs) && avgs->valuedouble >= 1.0) target->target_averages = (int)avgs->valuedouble;
+
     cJSON *win = cJSON_GetObjectItemCaseSensitive(root, "window");
     if (cJSON_IsString(win)) {
         char *clean_win = strdup_lowercase(win->valuestring);
@@ -153,6 +239,12 @@ int parse_config_rf(const char *json_string, DesiredCfg_t *target) {
         free(clean_win);
     }
 
+    cJSON *prec = cJSON_GetObjectItemCaseSensitive(root, "iq_precision");
+    if (cJSON_IsString(prec) && prec->valuestring) {
+        if (strcasecmp(prec->valuestring, "f32") == 0)      target->iq_precision = IQ_PRECISION_F32;
+        else if (strcasecmp(prec->valuestring, "f64") == 0) target->iq_precision = IQ_PRECISION_F64;
+    }
+
     cJSON *cooldown = cJSON_GetObjectItemCaseSensitive(root, "cooldown_request");
     if (cJSON_IsNumber(cooldown) && cooldown->valuedouble >= 0.0) {
         target->cooldown_request = cooldown->valuedouble;
@@ -175,6 +267,159 @@ int parse_config_rf(const char *json_string, DesiredCfg_t *target) {
     cJSON *ppm = cJSON_GetObjectItemCaseSensitive(root, "ppm_error");
     if (cJSON_IsNumber(ppm)) target->ppm_error = (float)ppm->valuedouble;
 
+    // 7. Reply serialization
+    cJSON *fmt = cJSON_GetObjectItemCaseSensitive(root, "reply_format");
+    if (cJSON_IsString(fmt) && fmt->valuestring) {
+        if (strcasecmp(fmt->valuestring, "f32") == 0)      target->reply_format = REPLY_FORMAT_F32;
+        else if (strcasecmp(fmt->valuestring, "i16") == 0) target->reply_format = REPLY_FORMAT_I16;
+        else target->reply_format = REPLY_FORMAT_JSON;
+    }
+
+    // 8. Continuous streaming (PUB socket)
+    cJSON *stream = cJSON_GetObjectItemCaseSensitive(root, "stream");
+    if (cJSON_IsObject(stream)) {
+        target->stream_enabled = true;
+
+        cJSON *rate = cJSON_GetObjectItemCaseSensitive(stream, "rate_hz");
+        if (cJSON_IsNumber(rate) && rate->valuedouble > 0.0) target->stream_rate_hz = rate->valuedouble;
+
+        cJSON *frames = cJSON_GetObjectItemCaseSensitive(stream, "frames");
+        if (cJSON_IsNumber(frames) && frames->valuedouble > 0.0) target->stream_frames = (int)frames->valuedouble;
+
+        cJSON *pipeline = cJSON_GetObjectItemCaseSensitive(stream, "pipeline");
+        if (cJSON_IsBool(pipeline)) target->stream_pipeline = cJSON_IsTrue(pipeline);
+    } else if (cJSON_IsBool(stream)) {
+        target->stream_enabled = cJSON_IsTrue(stream);
+    }
+
+    // 9. Multi-band sweep (PSD only: no demodulation, no channel filter, no streaming)
+    cJSON *sweep = cJSON_GetObjectItemCaseSensitive(root, "sweep");
+    if (cJSON_IsObject(sweep)) {
+        cJSON *s_start = cJSON_GetObjectItemCaseSensitive(sweep, "start_freq_hz");
+        cJSON *s_end   = cJSON_GetObjectItemCaseSensitive(sweep, "end_freq_hz");
+        if (cJSON_IsNumber(s_start) && cJSON_IsNumber(s_end) &&
+            s_start->valuedouble > 0.0 && s_end->valuedouble > s_start->valuedouble) {
+            target->sweep_enabled  = true;
+            target->sweep_start_hz = (uint64_t)s_start->valuedouble;
+            target->sweep_end_hz   = (uint64_t)s_end->valuedouble;
+            target->center_freq    = target->sweep_start_hz;
+            target->rf_mode        = PSD_MODE;
+            target->filter_enabled = false;
+            target->zoom           = false;
+            target->stream_enabled = false;
+        } else {
+            printf("[PARSER] Warning: sweep requires 0 < start_freq_hz < end_freq_hz; ignored.\n");
+        }
+    }
+
+    // 10. Per-stage timing in the reply
+    cJSON *metrics = cJSON_GetObjectItemCaseSensitive(root, "metrics");
+    if (cJSON_IsBool(metrics)) target->metrics_enabled = cJSON_IsTrue(metrics);
+
+    // 10b. Raw IQ snapshot of this request's capture
+    cJSON *record = cJSON_GetObjectItemCaseSensitive(root, "record");
+    if (cJSON_IsBool(record)) target->record = cJSON_IsTrue(record);
+
+    // 11. Persistent trace averaging across requests
+    cJSON *avg = cJSON_GetObjectItemCaseSensitive(root, "average");
+    cJSON *avg_mode = cJSON_IsObject(avg) ? cJSON_GetObjectItemCaseSensitive(avg, "mode") : avg;
+    if (cJSON_IsString(avg_mode) && avg_mode->valuestring) {
+        const char *s = avg_mode->valuestring;
+        if (strcasecmp(s, "linear") == 0)                                     target->avg_mode = PSD_AVG_LINEAR;
+        else if (strcasecmp(s, "exp") == 0 || strcasecmp(s, "exponential") == 0) target->avg_mode = PSD_AVG_EXP;
+        else if (strcasecmp(s, "max_hold") == 0)                              target->avg_mode = PSD_AVG_MAX_HOLD;
+        else if (strcasecmp(s, "min_hold") == 0)                              target->avg_mode = PSD_AVG_MIN_HOLD;
+        else target->avg_mode = PSD_AVG_OFF;
+    }
+    if (cJSON_IsObject(avg)) {
+        cJSON *count = cJSON_GetObjectItemCaseSensitive(avg, "count");
+        if (cJSON_IsNumber(count) && count->valuedouble >= 1.0) target->avg_count = (int)count->valuedouble;
+
+        cJSON *alpha = cJSON_GetObjectItemCaseSensitive(avg, "alpha");
+        if (cJSON_IsNumber(alpha) && alpha->valuedouble > 0.0 && alpha->valuedouble <= 1.0) {
+            target->avg_alpha = alpha->valuedouble;
+        }
+
+        cJSON *reset = cJSON_GetObjectItemCaseSensitive(avg, "reset");
+        if (cJSON_IsBool(reset)) target->avg_reset = cJSON_IsTrue(reset);
+    }
+
+    // 11b. Output reduction: crop to the filter band and/or pool to N display bins
+    cJSON *output = cJSON_GetObjectItemCaseSensitive(root, "output");
+    if (cJSON_IsObject(output)) {
+        cJSON *crop = cJSON_GetObjectItemCaseSensitive(output, "crop");
+        if (cJSON_IsBool(crop)) target->out_crop = cJSON_IsTrue(crop);
+
+        cJSON *bins = cJSON_GetObjectItemCaseSensitive(output, "bins");
+        if (cJSON_IsNumber(bins) && bins->valuedouble >= 1.0) target->out_bins = (int)bins->valuedouble;
+
+        cJSON *pool = cJSON_GetObjectItemCaseSensitive(output, "pool");
+        if (cJSON_IsString(pool) && pool->valuestring) {
+            target->out_pool = (strcasecmp(pool->valuestring, "mean") == 0) ? PSD_POOL_MEAN : PSD_POOL_MAX;
+        }
+    }
+
+    // 12. On-device detection: noise floor, occupancy per channel and top-N peaks
+    cJSON *detect = cJSON_GetObjectItemCaseSensitive(root, "detect");
+    if (cJSON_IsTrue(detect)) {
+        target->detect.enabled = true;
+    } else if (cJSON_IsObject(detect)) {
+        target->detect.enabled = true;
+
+        cJSON *thr = cJSON_GetObjectItemCaseSensitive(detect, "threshold_db");
+        if (cJSON_IsNumber(thr) && thr->valuedouble > 0.0) target->detect.threshold_db = thr->valuedouble;
+
+        cJSON *peaks = cJSON_GetObjectItemCaseSensitive(detect, "peaks");
+        if (cJSON_IsNumber(peaks) && peaks->valuedouble >= 1.0) target->detect.max_peaks = (int)peaks->valuedouble;
+
+        cJSON *spacing = cJSON_GetObjectItemCaseSensitive(detect, "min_spacing_hz");
+        if (cJSON_IsNumber(spacing) && spacing->valuedouble > 0.0) target->detect.min_spacing_hz = spacing->valuedouble;
+
+        cJSON *only = cJSON_GetObjectItemCaseSensitive(detect, "only");
+        if (cJSON_IsBool(only)) target->detect.only = cJSON_IsTrue(only);
+
+        cJSON *chans = cJSON_GetObjectItemCaseSensitive(detect, "channels");
+        if (cJSON_IsObject(chans)) {
+            cJSON *width = cJSON_GetObjectItemCaseSensitive(chans, "width_hz");
+            cJSON *start = cJSON_GetObjectItemCaseSensitive(chans, "start_hz");
+            cJSON *count = cJSON_GetObjectItemCaseSensitive(chans, "count");
+            if (cJSON_IsNumber(width) && width->valuedouble > 0.0) {
+                target->detect.chan_width_hz = width->valuedouble;
+                if (cJSON_IsNumber(start) && start->valuedouble > 0.0) {
+                    target->detect.chan_start_hz = (uint64_t)start->valuedouble;
+                }
+                if (cJSON_IsNumber(count) && count->valuedouble >= 1.0) {
+                    target->detect.chan_count = (int)count->valuedouble;
+                }
+            } else {
+                printf("[PARSER] Warning: detect.channels requires width_hz > 0; channel plan ignored.\n");
+            }
+        }
+    }
+
+    // 12b. Spectrogram rows (time resolution from the estimator's own segments)
+    cJSON *spec = cJSON_GetObjectItemCaseSensitive(root, "spectrogram");
+    if (cJSON_IsTrue(spec)) {
+        target->spectrogram.enabled = true;
+    } else if (cJSON_IsObject(spec)) {
+        target->spectrogram.enabled = true;
+
+        cJSON *segs = cJSON_GetObjectItemCaseSensitive(spec, "segments");
+        if (cJSON_IsNumber(segs) && segs->valuedouble >= 1.0) target->spectrogram.segments = (int)segs->valuedouble;
+
+        cJSON *rows = cJSON_GetObjectItemCaseSensitive(spec, "max_rows");
+        if (cJSON_IsNumber(rows) && rows->valuedouble >= 1.0) target->spectrogram.max_rows = (int)rows->valuedouble;
+
+        cJSON *fmt = cJSON_GetObjectItemCaseSensitive(spec, "format");
+        if (cJSON_IsString(fmt) && fmt->valuestring) {
+            target->spectrogram.format = (strcasecmp(fmt->valuestring, "i16") == 0) ? PSD_SPEC_I16 : PSD_SPEC_U8;
+        }
+
+        cJSON *step = cJSON_GetObjectItemCaseSensitive(spec, "step_db");
+        if (cJSON_IsNumber(step) && step->valuedouble > 0.0) target->spectrogram.step_db = step->valuedouble;
+    }
+    if (target->sweep_enabled) target->spectrogram.enabled = false;
+
     cJSON_Delete(root);
     return 0;
 }
@@ -206,6 +451,10 @@ void print_config_summary_DEBUG(DesiredCfg_t *des, SDR_cfg_t *hw, PsdConfig_t *p
     printf("  Window        : %s\n", window_names[psd->window_type]);
     printf("  RBW           : %d Hz\n", des->rbw);
     printf("  Overlap       : %.1f%%\n", des->overlap * 100.0);
+    if (des->target_averages > 0) {
+        printf("  Averages      : %d (%.2f ms)\n", des->target_averages,
+               1e3 * (double)rb->total_bytes / (2.0 * hw->sample_rate));
+    }
 
     printf("\n--- FILTERING ---\n");
     if (des->filter_enabled) {
@@ -213,6 +462,9 @@ void print_config_summary_DEBUG(DesiredCfg_t *des, SDR_cfg_t *hw, PsdConfig_t *p
         printf("  Range         : %d Hz -> %d Hz\n", 
                 des->filter_cfg.start_freq_hz, 
                 des->filter_cfg.end_freq_hz);
+        if (psd->zoom.decim > 1) {
+            printf("  Zoom          : D=%d (%.1f kHz)\n", psd->zoom.decim, psd->sample_rate / 1e3);
+        }
     } else {
         printf("  Status        : [BYPASSED]\n");
     }
@@ -258,7 +510,12 @@ void print_config_summary_DEPLOY(DesiredCfg_t *des, SDR_cfg_t *hw, PsdConfig_t *
            w_n[psd->window_type % 8],
             (double)rb->total_bytes / (1024.0 * 1024.0));
 
-    if (des->filter_enabled) {
+    if (des->filter_enabled && psd->zoom.decim > 1) {
+        printf(" | FILT:%d-%dHz | ZOOM:D%d\n",
+               des->filter_cfg.start_freq_hz,
+               des->filter_cfg.end_freq_hz,
+               psd->zoom.decim);
+    } else if (des->filter_enabled) {
         printf(" | FILT:%d-%dHz\n", 
                des->filter_cfg.start_freq_hz, 
                des->filter_cfg.end_freq_hz);
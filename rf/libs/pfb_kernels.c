@@ -0,0 +1,256 @@
+/**
+ * @file pfb_kernels.c
+ * @brief Implementación de los kernels SIMD del PFB (plegado polifásico y |X|²).
+ */
+#include "pfb_kernels.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define PFB_K_AVX 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define PFB_K_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PFB_K_NEON 1
+#if defined(__aarch64__)
+#define PFB_K_NEON_F64 1
+#endif
+#endif
+
+/**
+ * @addtogroup pfb_kernels_module
+ * @{
+ */
+
+const char *pfb_kernels_isa_name(void) {
+#if defined(PFB_K_AVX)
+    return "avx";
+#elif defined(PFB_K_SSE2)
+    return "sse2";
+#elif defined(PFB_K_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+void pfb_fold_cf64(const double complex *x, const double *h, int M, int T, double complex *out) {
+    if (!x || !h || !out || M <= 0 || T <= 0) return;
+
+    /* double complex is {re, im}: each real tap scales two consecutive doubles */
+    const double *xd = (const double *)x;
+    double *od = (double *)out;
+    int m = 0;
+
+#if defined(PFB_K_AVX)
+    // 4 complex per iteration; taps broadcast to [h0, h0, h1, h1]
+    for (; m + 4 <= M; m += 4) {
+        __m256d a0 = _mm256_setzero_pd();
+        __m256d a1 = _mm256_setzero_pd();
+        for (int t = 0; t < T; t++) {
+            const size_t base = (size_t)t * (size_t)M + (size_t)m;
+            const double *xt = xd + 2U * base;
+            const double *ht = h + base;
+            const __m256d h01 = _mm256_permute_pd(_mm256_broadcast_pd((const __m128d *)ht), 0xC);
+            const __m256d h23 = _mm256_permute_pd(_mm256_broadcast_pd((const __m128d *)(ht + 2)), 0xC);
+            a0 = _mm256_add_pd(a0, _mm256_mul_pd(_mm256_loadu_pd(xt), h01));
+            a1 = _mm256_add_pd(a1, _mm256_mul_pd(_mm256_loadu_pd(xt + 4), h23));
+        }
+        _mm256_storeu_pd(od + 2U * (size_t)m, a0);
+        _mm256_storeu_pd(od + 2U * (size_t)m + 4, a1);
+    }
+#elif defined(PFB_K_SSE2)
+    // One complex per register, 2 per iteration
+    for (; m + 2 <= M; m += 2) {
+        __m128d a0 = _mm_setzero_pd();
+        __m128d a1 = _mm_setzero_pd();
+        for (int t = 0; t < T; t++) {
+            const size_t base = (size_t)t * (size_t)M + (size_t)m;
+            const double *xt = xd + 2U * base;
+            const __m128d hp = _mm_loadu_pd(h + base);
+            a0 = _mm_add_pd(a0, _mm_mul_pd(_mm_loadu_pd(xt), _mm_unpacklo_pd(hp, hp)));
+            a1 = _mm_add_pd(a1, _mm_mul_pd(_mm_loadu_pd(xt + 2), _mm_unpackhi_pd(hp, hp)));
+        }
+        _mm_storeu_pd(od + 2U * (size_t)m, a0);
+        _mm_storeu_pd(od + 2U * (size_t)m + 2, a1);
+    }
+#elif defined(PFB_K_NEON_F64)
+    // De-interleave 2 complex into re/im lanes
+    for (; m + 2 <= M; m += 2) {
+        float64x2x2_t acc;
+        acc.val[0] = vdupq_n_f64(0.0);
+        acc.val[1] = vdupq_n_f64(0.0);
+        for (int t = 0; t < T; t++) {
+            const size_t base = (size_t)t * (size_t)M + (size_t)m;
+            const float64x2x2_t v = vld2q_f64(xd + 2U * base);
+            const float64x2_t hv = vld1q_f64(h + base);
+            acc.val[0] = vaddq_f64(acc.val[0], vmulq_f64(v.val[0], hv));
+            acc.val[1] = vaddq_f64(acc.val[1], vmulq_f64(v.val[1], hv));
+        }
+        vst2q_f64(od + 2U * (size_t)m, acc);
+    }
+#endif
+
+    for (; m < M; m++) {
+        double re = 0.0, im = 0.0;
+        for (int t = 0; t < T; t++) {
+            const size_t base = (size_t)t * (size_t)M + (size_t)m;
+            re += xd[2U * base] * h[base];
+            im += xd[2U * base + 1] * h[base];
+        }
+        od[2U * (size_t)m] = re;
+        od[2U * (size_t)m + 1] = im;
+    }
+}
+
+void pfb_fold_cf32(const float complex *x, const float *h, int M, int T, float complex *out) {
+    if (!x || !h || !out || M <= 0 || T <= 0) return;
+
+    const float *xf = (const float *)x;
+    float *of = (float *)out;
+    int m = 0;
+
+#if defined(PFB_K_AVX)
+    // 4 complex per register; taps expanded to [h0, h0, h1, h1 | h2, h2, h3, h3]
+    for (; m + 4 <= M; m += 4) {
+        __m256 a = _mm256_setzero_ps();
+        for (int t = 0; t < T; t++) {
+            const size_t base = (size_t)t * (size_t)M + (size_t)m;
+            const __m128 q = _mm_loadu_ps(h + base);
+            const __m256 hb = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_unpacklo_ps(q, q)),
+                                                   _mm_unpackhi_ps(q, q), 1);
+            a = _mm256_add_ps(a, _mm256_mul_ps(_mm256_loadu_ps(xf + 2U * base), hb));
+        }
+        _mm256_storeu_ps(of + 2U * (size_t)m, a);
+    }
+#elif defined(PFB_K_SSE2)
+    for (; m + 4 <= M; m += 4) {
+        __m128 a0 = _mm_setzero_ps();
+        __m128 a1 = _mm_setzero_ps();
+        for (int t = 0; t < T; t++) {
+            const size_t base = (size_t)t * (size_t)M + (size_t)m;
+            const float *xt = xf + 2U * base;
+            const __m128 q = _mm_loadu_ps(h + base);
+            a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_loadu_ps(xt), _mm_unpacklo_ps(q, q)));
+            a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_loadu_ps(xt + 4), _mm_unpackhi_ps(q, q)));
+        }
+        _mm_storeu_ps(of + 2U * (size_t)m, a0);
+        _mm_storeu_ps(of + 2U * (size_t)m + 4, a1);
+    }
+#elif defined(PFB_K_NEON)
+    for (; m + 4 <= M; m += 4) {
+        float32x4x2_t acc;
+        acc.val[0] = vdupq_n_f32(0.0f);
+        acc.val[1] = vdupq_n_f32(0.0f);
+        for (int t = 0; t < T; t++) {
+            const size_t base = (size_t)t * (size_t)M + (size_t)m;
+            const float32x4x2_t v = vld2q_f32(xf + 2U * base);
+            const float32x4_t hv = vld1q_f32(h + base);
+            acc.val[0] = vaddq_f32(acc.val[0], vmulq_f32(v.val[0], hv));
+            acc.val[1] = vaddq_f32(acc.val[1], vmulq_f32(v.val[1], hv));
+        }
+        vst2q_f32(of + 2U * (size_t)m, acc);
+    }
+#endif
+
+    for (; m < M; m++) {
+        float re = 0.0f, im = 0.0f;
+        for (int t = 0; t < T; t++) {
+            const size_t base = (size_t)t * (size_t)M + (size_t)m;
+            re += xf[2U * base] * h[base];
+            im += xf[2U * base + 1] * h[base];
+        }
+        of[2U * (size_t)m] = re;
+        of[2U * (size_t)m + 1] = im;
+    }
+}
+
+void pfb_accum_power_cf64(const double complex *X, double *acc, int n) {
+    if (!X || !acc || n <= 0) return;
+
+    const double *xd = (const double *)X;
+    int k = 0;
+
+#if defined(PFB_K_AVX)
+    // Square 4 complex, regroup 128-bit halves so hadd yields bins in order
+    for (; k + 4 <= n; k += 4) {
+        const __m256d v0 = _mm256_loadu_pd(xd + 2U * (size_t)k);
+        const __m256d v1 = _mm256_loadu_pd(xd + 2U * (size_t)k + 4);
+        const __m256d s0 = _mm256_mul_pd(v0, v0);
+        const __m256d s1 = _mm256_mul_pd(v1, v1);
+        const __m256d lo = _mm256_permute2f128_pd(s0, s1, 0x20);
+        const __m256d hi = _mm256_permute2f128_pd(s0, s1, 0x31);
+        _mm256_storeu_pd(acc + k, _mm256_add_pd(_mm256_loadu_pd(acc + k), _mm256_hadd_pd(lo, hi)));
+    }
+#elif defined(PFB_K_SSE2)
+    for (; k + 2 <= n; k += 2) {
+        const __m128d v0 = _mm_loadu_pd(xd + 2U * (size_t)k);
+        const __m128d v1 = _mm_loadu_pd(xd + 2U * (size_t)k + 2);
+        const __m128d s0 = _mm_mul_pd(v0, v0);
+        const __m128d s1 = _mm_mul_pd(v1, v1);
+        const __m128d p = _mm_add_pd(_mm_unpacklo_pd(s0, s1), _mm_unpackhi_pd(s0, s1));
+        _mm_storeu_pd(acc + k, _mm_add_pd(_mm_loadu_pd(acc + k), p));
+    }
+#elif defined(PFB_K_NEON_F64)
+    for (; k + 2 <= n; k += 2) {
+        const float64x2x2_t v = vld2q_f64(xd + 2U * (size_t)k);
+        const float64x2_t p = vaddq_f64(vmulq_f64(v.val[0], v.val[0]), vmulq_f64(v.val[1], v.val[1]));
+        vst1q_f64(acc + k, vaddq_f64(vld1q_f64(acc + k), p));
+    }
+#endif
+
+    for (; k < n; k++) {
+        const double re = xd[2U * (size_t)k];
+        const double im = xd[2U * (size_t)k + 1];
+        acc[k] += (re * re) + (im * im);
+    }
+}
+
+void pfb_accum_power_cf32(const float complex *X, double *acc, int n) {
+    if (!X || !acc || n <= 0) return;
+
+    const float *xf = (const float *)X;
+    int k = 0;
+
+#if defined(PFB_K_AVX) || defined(PFB_K_SSE2)
+    // De-interleave 4 complex into re/im, square in float, widen to double
+    for (; k + 4 <= n; k += 4) {
+        const __m128 a = _mm_loadu_ps(xf + 2U * (size_t)k);
+        const __m128 b = _mm_loadu_ps(xf + 2U * (size_t)k + 4);
+        const __m128 re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        const __m128 p = _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+#if defined(PFB_K_AVX)
+        _mm256_storeu_pd(acc + k, _mm256_add_pd(_mm256_loadu_pd(acc + k), _mm256_cvtps_pd(p)));
+#else
+        _mm_storeu_pd(acc + k,     _mm_add_pd(_mm_loadu_pd(acc + k),     _mm_cvtps_pd(p)));
+        _mm_storeu_pd(acc + k + 2, _mm_add_pd(_mm_loadu_pd(acc + k + 2), _mm_cvtps_pd(_mm_movehl_ps(p, p))));
+#endif
+    }
+#elif defined(PFB_K_NEON)
+    for (; k + 4 <= n; k += 4) {
+        const float32x4x2_t v = vld2q_f32(xf + 2U * (size_t)k);
+        const float32x4_t p = vaddq_f32(vmulq_f32(v.val[0], v.val[0]), vmulq_f32(v.val[1], v.val[1]));
+#if defined(PFB_K_NEON_F64)
+        vst1q_f64(acc + k,     vaddq_f64(vld1q_f64(acc + k),     vcvt_f64_f32(vget_low_f32(p))));
+        vst1q_f64(acc + k + 2, vaddq_f64(vld1q_f64(acc + k + 2), vcvt_high_f64_f32(p)));
+#else
+        float tmp[4];
+        vst1q_f32(tmp, p);
+        acc[k]     += (double)tmp[0];
+        acc[k + 1] += (double)tmp[1];
+        acc[k + 2] += (double)tmp[2];
+        acc[k + 3] += (double)tmp[3];
+#endif
+    }
+#endif
+
+    for (; k < n; k++) {
+        const float re = xf[2U * (size_t)k];
+        const float im = xf[2U * (size_t)k + 1];
+        acc[k] += (double)(re * re + im * im);
+    }
+}
+
+/** @} */
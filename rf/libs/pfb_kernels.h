@@ -0,0 +1,65 @@
+/**
+ * @file pfb_kernels.h
+ * @brief Kernels vectorizados del banco de filtros polifásico y de la acumulación de potencia.
+ *
+ * El PFB calcula por bloque \f$ y[m] = \sum_{t=0}^{T-1} x[tM + m] \, h[tM + m] \f$ antes de
+ * cada FFT de M puntos, y tras la FFT acumula \f$ |X[k]|^2 \f$. Ambos lazos son el costo
+ * dominante fuera de FFTW. Los kernels recorren la tabla tap-major (`h` contiguo por tap)
+ * manteniendo la suma de los T taps en registros, sin memset previo de la salida.
+ *
+ * El ISA se elige en compilación: AVX (si el compilador lo habilita, p. ej. con
+ * `-DRF_SIMD_NATIVE=ON`), SSE2 en x86-64, NEON en ARM (doble precisión solo en AArch64)
+ * y un lazo escalar como respaldo. Los kernels evitan FMA para reproducir la ruta escalar.
+ */
+
+#ifndef PFB_KERNELS_H
+#define PFB_KERNELS_H
+
+#include <stddef.h>
+#include <complex.h>
+
+/**
+ * @defgroup pfb_kernels_module PFB Kernels
+ * @ingroup rf_binary
+ * @brief Plegado polifásico y |X|² con SIMD seleccionado en compilación.
+ * @{
+ */
+
+/**
+ * @brief Plegado polifásico en doble precisión: `out[m] = Σ_t x[t*M + m] · h[t*M + m]`.
+ * @param[in]  x Bloque de entrada de @p M · @p T muestras.
+ * @param[in]  h Prototipo tap-major de @p M · @p T coeficientes reales.
+ * @param[in]  M Canales (tamaño de la FFT).
+ * @param[in]  T Taps por canal.
+ * @param[out] out Entrada de la FFT (@p M muestras); se sobrescribe.
+ */
+void pfb_fold_cf64(const double complex *x, const double *h, int M, int T, double complex *out);
+
+/**
+ * @brief Plegado polifásico en float32 (misma disposición que @ref pfb_fold_cf64).
+ */
+void pfb_fold_cf32(const float complex *x, const float *h, int M, int T, float complex *out);
+
+/**
+ * @brief Acumula la potencia de un espectro: `acc[k] += re² + im²`.
+ * @param[in]     X Salida de la FFT (@p n bins).
+ * @param[in,out] acc Acumulador por bin.
+ * @param[in]     n Número de bins.
+ */
+void pfb_accum_power_cf64(const double complex *X, double *acc, int n);
+
+/**
+ * @brief Acumula la potencia de un espectro float32 en acumuladores double.
+ * @details El cuadrado se calcula en float (como la ruta escalar) y se suma en double.
+ */
+void pfb_accum_power_cf32(const float complex *X, double *acc, int n);
+
+/**
+ * @brief Nombre del kernel compilado ("avx", "sse2", "neon" o "scalar"), para logs.
+ * @return Cadena estática.
+ */
+const char *pfb_kernels_isa_name(void);
+
+/** @} */
+
+#endif
@@ -3,6 +3,11 @@
  * @brief Implementación de algoritmos de estimación espectral y pre-procesamiento IQ.
  */
 #include "psd.h"
+#include "fft_wisdom.h"
+#include "pfb_kernels.h"
+
+#include <pthread.h>
+#include <stdint.h>
 
 /**
  * @addtogroup psd_module
@@ -45,152 +50,233 @@ signal_iq_t* load_iq_from_buffer(const int8_t* buffer, size_t buffer_size) {
     return signal_data;
 }
 
+/** @brief Muestras por bloque en la carga fusionada float32 (el bloque int8 queda en L1). */
+#define IQ_LOAD_CHUNK_SAMPLES 4096
+
 /**
- * @brief Compensación ciega básica de IQ imbalance por bloque.
- *
- * Esta rutina realiza:
- *   1) Remoción de DC en I y Q
- *   2) Balance de ganancia entre ramas I/Q
- *   3) Decorrelación lineal de Q respecto de I
- *
- * Es una compensación global, ciega y de segundo orden.
- * No corrige efectos dependientes de frecuencia.
- *
- * @param signal_data Puntero a la estructura con las muestras IQ.
+ * @brief Acumuladores enteros de los momentos IQ (exactos sobre int8).
  */
-void iq_compensation(signal_iq_t* signal_data)
-{
-    if (signal_data == NULL || signal_data->signal_iq == NULL || signal_data->n_signal == 0)
-        return;
-
-    const size_t N = signal_data->n_signal;
-    double complex* x = signal_data->signal_iq;
+typedef struct {
+    int64_t sI, sQ, sII, sQQ, sIQ;
+} iq_moments_acc_t;
+
+static void moments_from_acc(const iq_moments_acc_t* a, size_t n, iq_moments_t* stats) {
+    stats->sum_i  = (double)a->sI;
+    stats->sum_q  = (double)a->sQ;
+    stats->sum_ii = (double)a->sII;
+    stats->sum_qq = (double)a->sQQ;
+    stats->sum_iq = (double)a->sIQ;
+    stats->n      = n;
+}
 
-    /* ---------------------------------------------
-     * Parámetro de robustez numérica
-     * --------------------------------------------- */
-    const double eps = 1e-20;
+/**
+ * @brief Convierte un tramo int8 a double complex acumulando sus momentos.
+ */
+static void load_span_f64(const int8_t* src, size_t n_samples, double complex* x, iq_moments_acc_t* acc) {
+    int64_t sI = 0, sQ = 0, sII = 0, sQQ = 0, sIQ = 0;
 
-    double meanI = 0.0;
-    double meanQ = 0.0;
+    #pragma omp parallel for reduction(+:sI, sQ, sII, sQQ, sIQ)
+    for (size_t i = 0; i < n_samples; i++) {
+        const int I_n = src[2 * i];
+        const int Q_n = src[2 * i + 1];
+        x[i] = (double)I_n + (double)Q_n * I;
+        sI  += I_n;
+        sQ  += Q_n;
+        sII += I_n * I_n;
+        sQQ += Q_n * Q_n;
+        sIQ += I_n * Q_n;
+    }
 
-    double pI = 0.0;
-    double pQ = 0.0;
+    acc->sI += sI; acc->sQ += sQ; acc->sII += sII; acc->sQQ += sQQ; acc->sIQ += sIQ;
+}
 
-    double crossIQ = 0.0;
+/**
+ * @brief Convierte un tramo int8 a float complex por bloques, acumulando sus momentos.
+ */
+static void load_span_f32(const int8_t* src, size_t n_samples, float complex* x, iq_moments_acc_t* acc) {
+    const size_t n_chunks = (n_samples + IQ_LOAD_CHUNK_SAMPLES - 1) / IQ_LOAD_CHUNK_SAMPLES;
+    int64_t sI = 0, sQ = 0, sII = 0, sQQ = 0, sIQ = 0;
 
-    /* =========================================================
-     * 1) Remoción de DC offset
-     * =========================================================
-     * Calculamos la media de I y Q:
-     *   meanI = (1/N) sum I[n]
-     *   meanQ = (1/N) sum Q[n]
-     * y luego las restamos para centrar la nube IQ en el origen.
+    /*
+     * Each chunk is converted with the SIMD kernel and its moments are taken from
+     * the int8 source while it is still hot in L1.
      */
-    #pragma omp parallel for reduction(+:meanI, meanQ)
-    for (size_t n = 0; n < N; n++) {
-        meanI += creal(x[n]);
-        meanQ += cimag(x[n]);
+    #pragma omp parallel for reduction(+:sI, sQ, sII, sQQ, sIQ) schedule(static)
+    for (size_t c = 0; c < n_chunks; c++) {
+        const size_t s0 = c * IQ_LOAD_CHUNK_SAMPLES;
+        const size_t cnt = (n_samples - s0 < IQ_LOAD_CHUNK_SAMPLES) ? (n_samples - s0) : IQ_LOAD_CHUNK_SAMPLES;
+        const int8_t *chunk = src + 2U * s0;
+
+        iq_convert_s8_to_cf32(chunk, x + s0, cnt);
+
+        for (size_t j = 0; j < cnt; j++) {
+            const int I_n = chunk[2 * j];
+            const int Q_n = chunk[2 * j + 1];
+            sI  += I_n;
+            sQ  += Q_n;
+            sII += I_n * I_n;
+            sQQ += Q_n * Q_n;
+            sIQ += I_n * Q_n;
+        }
     }
 
-    meanI /= (double)N;
-    meanQ /= (double)N;
+    acc->sI += sI; acc->sQ += sQ; acc->sII += sII; acc->sQQ += sQQ; acc->sIQ += sIQ;
+}
 
-    #pragma omp parallel for
-    for (size_t n = 0; n < N; n++) {
-        const double I_n = creal(x[n]) - meanI;
-        const double Q_n = cimag(x[n]) - meanQ;
-        x[n] = I_n + I * Q_n;
-    }
+/**
+ * @brief Valida un par de tramos y devuelve el total de muestras IQ (0 si son inválidos).
+ * @details Cada tramo debe contener pares I/Q completos para no partir una muestra.
+ */
+static size_t spans_total_samples(const int8_t* const spans[2], const size_t span_bytes[2]) {
+    if (!spans || !span_bytes || !spans[0] || span_bytes[0] == 0) return 0;
+    if ((span_bytes[0] & 1U) || (span_bytes[1] & 1U)) return 0;
+    if (span_bytes[1] > 0 && !spans[1]) return 0;
+    return (span_bytes[0] + span_bytes[1]) / 2U;
+}
 
-    /* =========================================================
-     * 2) Estimación de potencia por rama
-     * =========================================================
-     * Calculamos:
-     *   pI = sum I[n]^2
-     *   pQ = sum Q[n]^2
-     * para estimar el desbalance de ganancia entre ramas.
-     */
-    #pragma omp parallel for reduction(+:pI, pQ)
+int load_iq_spans_into_signal_stats(const int8_t* const spans[2], const size_t span_bytes[2],
+                                    signal_iq_t* signal_data, iq_moments_t* stats) {
+    if (!signal_data || !signal_data->signal_iq || !stats) return -1;
+
+    const size_t n_samples = spans_total_samples(spans, span_bytes);
+    if (n_samples == 0 || signal_data->n_signal < n_samples) return -1;
+
+    iq_moments_acc_t acc = {0};
+    const size_t n0 = span_bytes[0] / 2U;
+    load_span_f64(spans[0], n0, signal_data->signal_iq, &acc);
+    if (span_bytes[1] > 0) load_span_f64(spans[1], span_bytes[1] / 2U, signal_data->signal_iq + n0, &acc);
+
+    moments_from_acc(&acc, n_samples, stats);
+    signal_data->n_signal = n_samples;
+    return 0;
+}
+
+int load_iq_into_signal_stats(const int8_t* buffer, size_t buffer_size, signal_iq_t* signal_data, iq_moments_t* stats) {
+    const int8_t* spans[2] = { buffer, NULL };
+    const size_t span_bytes[2] = { buffer_size & ~(size_t)1U, 0 };
+    return load_iq_spans_into_signal_stats(spans, span_bytes, signal_data, stats);
+}
+
+int load_iq_spans_into_signal_f32_stats(const int8_t* const spans[2], const size_t span_bytes[2],
+                                        signal_iq_f32_t* signal_data, iq_moments_t* stats) {
+    if (!signal_data || !signal_data->signal_iq || !stats) return -1;
+
+    const size_t n_samples = spans_total_samples(spans, span_bytes);
+    if (n_samples == 0 || signal_data->n_signal < n_samples) return -1;
+
+    iq_moments_acc_t acc = {0};
+    const size_t n0 = span_bytes[0] / 2U;
+    load_span_f32(spans[0], n0, signal_data->signal_iq, &acc);
+    if (span_bytes[1] > 0) load_span_f32(spans[1], span_bytes[1] / 2U, signal_data->signal_iq + n0, &acc);
+
+    moments_from_acc(&acc, n_samples, stats);
+    signal_data->n_signal = n_samples;
+    return 0;
+}
+
+int load_iq_into_signal_f32_stats(const int8_t* buffer, size_t buffer_size, signal_iq_f32_t* signal_data, iq_moments_t* stats) {
+    const int8_t* spans[2] = { buffer, NULL };
+    const size_t span_bytes[2] = { buffer_size & ~(size_t)1U, 0 };
+    return load_iq_spans_into_signal_f32_stats(spans, span_bytes, signal_data, stats);
+}
+
+/**
+ * @brief Deriva los coeficientes de corrección IQ a partir de los momentos crudos.
+ *
+ * Tras remover DC y escalar Q por g, las estimaciones secuenciales de la
+ * implementación original equivalen a:
+ * \f[
+ * p_I = \sum I^2 - N\bar{I}^2,\quad p_Q = \sum Q^2 - N\bar{Q}^2,\quad
+ * \rho = \frac{g\,(\sum IQ - N\bar{I}\bar{Q})}{p_I}
+ * \f]
+ * Si alguna rama es degenerada solo se remueve DC (g = 1, rho = 0).
+ */
+static void iq_comp_coeffs(const iq_moments_t* m, double* meanI, double* meanQ, double* gain, double* rho) {
+    const double eps = 1e-20;
+    const double N = (double)m->n;
+
+    *meanI = m->sum_i / N;
+    *meanQ = m->sum_q / N;
+
+    const double pI = m->sum_ii - N * (*meanI) * (*meanI);
+    const double pQ = m->sum_qq - N * (*meanQ) * (*meanQ);
+
+    *gain = 1.0;
+    *rho  = 0.0;
+    if (pI <= eps || pQ <= eps) return;
+
+    *gain = sqrt(pI / pQ);
+    const double crossIQ = (*gain) * (m->sum_iq - N * (*meanI) * (*meanQ));
+    *rho = crossIQ / (pI + eps);
+}
+
+/**
+ * @brief Acumula los momentos de primer y segundo orden de una señal double.
+ */
+static void iq_collect_moments(const signal_iq_t* signal_data, iq_moments_t* m) {
+    const size_t N = signal_data->n_signal;
+    const double complex* x = signal_data->signal_iq;
+    double sI = 0.0, sQ = 0.0, sII = 0.0, sQQ = 0.0, sIQ = 0.0;
+
+    #pragma omp parallel for reduction(+:sI, sQ, sII, sQQ, sIQ)
     for (size_t n = 0; n < N; n++) {
         const double I_n = creal(x[n]);
         const double Q_n = cimag(x[n]);
-        pI += I_n * I_n;
-        pQ += Q_n * Q_n;
+        sI  += I_n;
+        sQ  += Q_n;
+        sII += I_n * I_n;
+        sQQ += Q_n * Q_n;
+        sIQ += I_n * Q_n;
     }
 
-    /* Protección ante casos degenerados */
-    if (pI <= eps || pQ <= eps)
+    m->sum_i = sI; m->sum_q = sQ;
+    m->sum_ii = sII; m->sum_qq = sQQ; m->sum_iq = sIQ;
+    m->n = N;
+}
+
+void iq_compensation_apply(signal_iq_t* signal_data, const iq_moments_t* stats)
+{
+    if (signal_data == NULL || signal_data->signal_iq == NULL || signal_data->n_signal == 0 ||
+        stats == NULL || stats->n == 0)
         return;
 
-    /* =========================================================
-     * 3) Balance de ganancia
-     * =========================================================
-     * Si queremos que ambas ramas tengan energía similar:
-     *   g = sqrt(pI / pQ)
-     * y escalamos Q:
-     *   Q <- g * Q
-     *
-     * Se deja I fija y se corrige solo Q, siguiendo la lógica
-     * de tu implementación original.
-     */
-    const double gain = sqrt(pI / pQ);
+    double meanI, meanQ, gain, rho;
+    iq_comp_coeffs(stats, &meanI, &meanQ, &gain, &rho);
 
+    const size_t N = signal_data->n_signal;
+    double complex* x = signal_data->signal_iq;
+
+    /* DC removal, Q gain balance and linear decorrelation in a single sweep */
     #pragma omp parallel for
     for (size_t n = 0; n < N; n++) {
-        const double I_n = creal(x[n]);
-        const double Q_n = cimag(x[n]) * gain;
+        const double I_n = creal(x[n]) - meanI;
+        const double Q_n = (cimag(x[n]) - meanQ) * gain - rho * I_n;
         x[n] = I_n + I * Q_n;
     }
+}
 
-    /* =========================================================
-     * 4) Recalcular correlación cruzada después del escalado
-     * =========================================================
-     * Esta es la mejora clave frente a tu versión original:
-     * crossIQ debe calcularse sobre la señal ya balanceada
-     * en ganancia.
-     *
-     *   crossIQ = sum I[n] * Q[n]
-     */
-    crossIQ = 0.0;
+/**
+ * @brief Compensación ciega básica de IQ imbalance por bloque.
+ *
+ * Esta rutina realiza:
+ *   1) Remoción de DC en I y Q
+ *   2) Balance de ganancia entre ramas I/Q
+ *   3) Decorrelación lineal de Q respecto de I
+ *
+ * Es una compensación global, ciega y de segundo orden.
+ * No corrige efectos dependientes de frecuencia. Se ejecuta en dos pasadas:
+ * una de estadísticas (@ref iq_collect_moments) y otra de aplicación.
+ *
+ * @param signal_data Puntero a la estructura con las muestras IQ.
+ */
+void iq_compensation(signal_iq_t* signal_data)
+{
+    if (signal_data == NULL || signal_data->signal_iq == NULL || signal_data->n_signal == 0)
+        return;
 
-    #pragma omp parallel for reduction(+:crossIQ)
-    for (size_t n = 0; n < N; n++) {
-        const double I_n = creal(x[n]);
-        const double Q_n = cimag(x[n]);
-        crossIQ += I_n * Q_n;
-    }
-
-    /* =========================================================
-     * 5) Estimar coeficiente de decorrelación
-     * =========================================================
-     * Interpretamos rho como el coeficiente de regresión lineal
-     * de Q sobre I:
-     *
-     *   rho = sum(I*Q) / sum(I^2)
-     *
-     * Así, la parte de Q explicada linealmente por I se sustrae
-     * en el siguiente paso.
-     */
-    const double rho = crossIQ / (pI + eps);
-
-    /* =========================================================
-     * 6) Decorrelación lineal (corrección aproximada de fase)
-     * =========================================================
-     * Aplicamos:
-     *   Q <- Q - rho * I
-     *
-     * Esto reduce la fuga lineal de I dentro de Q, que suele
-     * interpretarse como una aproximación al desbalance de fase
-     * o a la falta de ortogonalidad entre ramas.
-     */
-    #pragma omp parallel for
-    for (size_t n = 0; n < N; n++) {
-        const double I_n = creal(x[n]);
-        const double Q_n = cimag(x[n]);
-        const double Q_corr = Q_n - rho * I_n;
-        x[n] = I_n + I * Q_corr;
-    }
+    iq_moments_t stats;
+    iq_collect_moments(signal_data, &stats);
+    iq_compensation_apply(signal_data, &stats);
 }
 
 void free_signal_iq(signal_iq_t* signal) {
@@ -203,12 +289,6 @@ void free_signal_iq(signal_iq_t* signal) {
     }
 }
 
-typedef struct {
-    int nperseg;
-    PsdWindowType_t window_type;
-    double *window;
-    double u_norm;
-} welch_window_cache_t;
 
 /**
  * @brief Restringe un valor de punto flotante a un rango específico [lo, hi].
@@ -255,8 +335,22 @@ int find_params_psd(DesiredCfg_t desired, SDR_cfg_t *hack_cfg, PsdConfig_t *psd_
     double enbw_factor = get_window_enbw_factor(desired.window_type);
     
     double safe_rbw = (desired.rbw > 0) ? (double)desired.rbw : 1000.0;
+
+    // Calculate PPM-corrected frequency for internal DSP processing
+    // Formula: f_corrected = f_nominal * (1 + PPM/1e6)
+    double correction = 1.0 + ((double)desired.ppm_error / 1000000.0);
+    const uint64_t fc_corrected = (uint64_t)((double)desired.center_freq * correction);
+
+    // Zoom: the estimator sees the filter band decimated to fs/D, same RBW with a D times smaller FFT
+    double fs_psd = desired.sample_rate;
+    memset(&psd_cfg->zoom, 0, sizeof(psd_cfg->zoom));
+    if (desired.zoom && desired.filter_enabled && !desired.sweep_enabled &&
+        iq_zoom_plan(desired.sample_rate, desired.center_freq, fc_corrected,
+                     &desired.filter_cfg, &psd_cfg->zoom) == 0) {
+        fs_psd = desired.sample_rate / (double)psd_cfg->zoom.decim;
+    }
     
-    double required_nperseg_val = enbw_factor * desired.sample_rate / safe_rbw;
+    double required_nperseg_val = enbw_factor * fs_psd / safe_rbw;
     int exponent = (int)ceil(log2(required_nperseg_val));
     
     psd_cfg->nperseg = (int)pow(2, exponent);
@@ -270,7 +364,32 @@ int find_params_psd(DesiredCfg_t desired, SDR_cfg_t *hack_cfg, PsdConfig_t *psd_
     }
 
     psd_cfg->window_type = desired.window_type;
-    psd_cfg->sample_rate = desired.sample_rate;
+    psd_cfg->sample_rate = fs_psd;
+
+    // Output reduction (a sweep stitches hops from full-resolution bins: never reduced).
+    // Zoom always crops: outside the band there is only the decimator's transition.
+    memset(&psd_cfg->out, 0, sizeof(psd_cfg->out));
+    if (!desired.sweep_enabled) {
+        const int n = psd_cfg->nperseg;
+        int lo = 0, hi = n;
+        if ((desired.out_crop || psd_cfg->zoom.decim > 1) && desired.filter_enabled && fs_psd > 0.0) {
+            const double df = fs_psd / (double)n;
+            const double f0 = (double)desired.center_freq + psd_cfg->zoom.shift_hz - fs_psd / 2.0;
+            lo = (int)floor(((double)desired.filter_cfg.start_freq_hz - f0) / df);
+            hi = (int)ceil(((double)desired.filter_cfg.end_freq_hz - f0) / df);
+            if (lo < 0) lo = 0;
+            if (hi > n) hi = n;
+            if (hi <= lo) { lo = 0; hi = n; }
+        }
+        if (lo > 0 || hi < n) {
+            psd_cfg->out.bin_lo = lo;
+            psd_cfg->out.n_bins = hi - lo;
+        }
+        if (desired.out_bins > 0 && desired.out_bins < hi - lo) {
+            psd_cfg->out.out_bins = desired.out_bins;
+            psd_cfg->out.pool = desired.out_pool;
+        }
+    }
 
     // Map to HW config
     if (hack_cfg) {
@@ -280,19 +399,31 @@ int find_params_psd(DesiredCfg_t desired, SDR_cfg_t *hack_cfg, PsdConfig_t *psd_
         hack_cfg->lna_gain = desired.lna_gain;
         hack_cfg->vga_gain = desired.vga_gain;
         hack_cfg->ppm_error = desired.ppm_error;
-        
-        // Calculate PPM-corrected frequency for internal DSP processing
-        // Formula: f_corrected = f_nominal * (1 + PPM/1e6)
-        double correction = 1.0 + ((double)desired.ppm_error / 1000000.0);
-        hack_cfg->center_freq_corrected = (uint64_t)((double)desired.center_freq * correction);
+        hack_cfg->center_freq_corrected = fc_corrected;
     }
 
     // Target smaller IQ chunk for lower latency/load.
-    // Use Fs/4 bytes as requested, but keep coherence with PSD needs:
+    // Use Fs/4 bytes by default, or exactly target_averages segments/blocks, but keep coherence with PSD needs:
     // - Ensure at least one FFT segment worth of interleaved IQ bytes.
     // - Ensure an even number of bytes (I,Q pairs).
-    const double target_chunk_bytes = desired.sample_rate / 4.0;
+    // - With zoom, one segment is nperseg decimated samples plus the FIR history.
+    double target_chunk_bytes = desired.sample_rate / 4.0;
+    if (desired.target_averages > 0) {
+        const double k = (double)desired.target_averages;
+        const double n = (double)psd_cfg->nperseg;
+        double est_samples = (desired.method_psd == PFB)
+            ? (k + (double)PFB_TAPS_PER_CHANNEL) * n
+            : (k - 1.0) * (n - (double)psd_cfg->noverlap) + n;
+        if (psd_cfg->zoom.decim > 1) {
+            est_samples = (est_samples + (double)IQ_ZOOM_TAPS_PER_PHASE + 1.0) * (double)psd_cfg->zoom.decim;
+        }
+        target_chunk_bytes = 2.0 * est_samples;
+        if (target_chunk_bytes > (double)PSD_TARGET_MAX_BYTES) target_chunk_bytes = (double)PSD_TARGET_MAX_BYTES;
+    }
     size_t min_chunk_bytes = (size_t)psd_cfg->nperseg * 2U;
+    if (psd_cfg->zoom.decim > 1) {
+        min_chunk_bytes = ((size_t)psd_cfg->nperseg + IQ_ZOOM_TAPS_PER_PHASE + 1U) * (size_t)psd_cfg->zoom.decim * 2U;
+    }
     if (min_chunk_bytes < 2048U) min_chunk_bytes = 2048U;
 
     rb_cfg->total_bytes = (size_t)target_chunk_bytes;
@@ -302,9 +433,9 @@ int find_params_psd(DesiredCfg_t desired, SDR_cfg_t *hack_cfg, PsdConfig_t *psd_
 }
 
 /**
- * @brief Conversión de densidad de potencia lineal a dBm.
+ * @brief Conversión de un bin de densidad de potencia lineal a dBm.
  *
- * Convierte valores de potencia normalizados (W/Hz) a escala logarítmica dBm,
+ * Convierte un valor de potencia normalizado (W/Hz) a escala logarítmica dBm,
  * asumiendo una impedancia de carga de 50 Ω:
  * \f[
  * P_{dBm} = 10 \log_{10}(P_{W} \cdot 1000)
@@ -314,18 +445,15 @@ int find_params_psd(DesiredCfg_t desired, SDR_cfg_t *hack_cfg, PsdConfig_t *psd_
  * Los valores obtenidos representan potencia relativa al ADC y no potencia
  * RF absoluta sin una calibración del sistema.
  */
-static void convert_to_dbm_inplace(double* psd, int length) {
-    #pragma omp parallel for
-    for (int i = 0; i < length; i++) {
-        // Convert normalized power to Watts (assuming 50 Ohm)
-        double p_watts = psd[i] / IMPEDANCE_50_OHM;
-        
-        // Prevent log(0) or negative values
-        if (p_watts < POWER_FLOOR_WATTS) p_watts = POWER_FLOOR_WATTS;
-        
-        // Convert Watts to dBm
-        psd[i] = 10.0 * log10(p_watts * 1000.0);
-    }
+static inline double psd_lin_to_dbm(double p_lin) {
+    // Convert normalized power to Watts (assuming 50 Ohm)
+    double p_watts = p_lin / IMPEDANCE_50_OHM;
+
+    // Prevent log(0) or negative values
+    if (p_watts < POWER_FLOOR_WATTS) p_watts = POWER_FLOOR_WATTS;
+
+    // Convert Watts to dBm
+    return 10.0 * log10(p_watts * 1000.0);
 }
 
 double get_window_enbw_factor(PsdWindowType_t type) {
@@ -402,218 +530,235 @@ static void generate_window(PsdWindowType_t window_type, double* window_buffer,
 }
 
 /**
- * @brief Realiza un desplazamiento circular para centrar la frecuencia cero (DC).
- * * Los algoritmos de FFT devuelven los datos en el orden estándar de salida:
- * [0 a Fs/2] seguido de [-Fs/2 a 0]. Esta función intercambia la primera mitad 
- * del búfer con la segunda para obtener un eje de frecuencias ordenado de:
- * \f[ [-F_s/2, \dots, 0, \dots, F_s/2] \f]
- * * 
- * * La operación consiste en un swap de bloques:
- * - El bloque \f$ [0, \frac{n}{2}-1] \f$ se mueve al final.
- * - El bloque \f$ [\frac{n}{2}, n-1] \f$ se mueve al principio.
- * * @param data Puntero al arreglo de datos (double) que se desea desplazar.
- * @param n    Número de elementos en el arreglo (debe coincidir con el tamaño de la FFT).
- * * @note Utiliza asignación dinámica temporal mediante `malloc` para evitar el 
- * desbordamiento de pila (stack overflow) en FFTs de gran tamaño, a diferencia de `alloca`.
+ * @brief Invierte @p n elementos en su lugar.
+ * @param p Arreglo.
+ * @param n Número de elementos.
  */
-static void fftshift(double* data, int n) {
-    int half = n / 2;
-    static __thread double *tl_fftshift_tmp = NULL;
-    static __thread int tl_fftshift_half = 0;
-    if (tl_fftshift_half < half) {
-        double *new_tmp = (double*)realloc(tl_fftshift_tmp, (size_t)half * sizeof(double));
-        if (!new_tmp) return;
-        tl_fftshift_tmp = new_tmp;
-        tl_fftshift_half = half;
+static void reverse_doubles(double *p, int n) {
+    for (int i = 0, j = n - 1; i < j; i++, j--) {
+        const double t = p[i];
+        p[i] = p[j];
+        p[j] = t;
     }
-    double* temp = tl_fftshift_tmp;
-    if (!temp) return; // Fail silently or handle error
-
-    memcpy(temp, data, half * sizeof(double));
-    memcpy(data, &data[half], (n - half) * sizeof(double));
-    memcpy(&data[n - half], temp, half * sizeof(double));
 }
 
-void execute_welch_psd(signal_iq_t* signal_data, const PsdConfig_t* config, double* f_out, double* p_out) {
-    if (!signal_data || !config || !f_out || !p_out) return;
-
-    double complex* signal = signal_data->signal_iq;
-    size_t n_signal = signal_data->n_signal;
-    int nperseg = config->nperseg;
-    int noverlap = config->noverlap;
-    double fs = config->sample_rate;
-    
-    int nfft = nperseg;
-    int step = nperseg - noverlap;
-    if (step < 1) step = 1;
-    
-    // Ensure we don't calculate negative segments
-    int k_segments = 0;
-    if (n_signal >= (size_t)nperseg) {
-        k_segments = (int)((n_signal - nperseg) / step) + 1;
-    }
-
-    static __thread welch_window_cache_t tl_window_cache = {0};
-    if (tl_window_cache.window == NULL ||
-        tl_window_cache.nperseg != nperseg ||
-        tl_window_cache.window_type != config->window_type) {
-        double *new_window = (double*)realloc(tl_window_cache.window, (size_t)nperseg * sizeof(double));
-        if (!new_window) return;
-        tl_window_cache.window = new_window;
-        tl_window_cache.nperseg = nperseg;
-        tl_window_cache.window_type = config->window_type;
-
-        generate_window(config->window_type, tl_window_cache.window, nperseg);
-
-        /*
-         * tl_window_cache is thread-local. OpenMP worker threads must not
-         * access that TLS symbol directly here, or they will see their own
-         * uninitialized per-thread cache instead of the caller thread's window.
-         */
-        const double *window_cache = tl_window_cache.window;
-        double u_norm = 0.0;
-        #pragma omp parallel for reduction(+:u_norm)
-        for (int i = 0; i < nperseg; i++) {
-            u_norm += window_cache[i] * window_cache[i];
+/**
+ * @brief fftshift y escala en una sola pasada, en su lugar y sin búfer temporal.
+ * * Los algoritmos de FFT devuelven los datos en el orden estándar de salida:
+ * [0 a Fs/2] seguido de [-Fs/2 a 0]. Tras el desplazamiento el eje queda ordenado como
+ * \f[ [-F_s/2, \dots, 0, \dots, F_s/2] \f]
+ * es decir \f$ y[i] = s \cdot x[(i + \lfloor n/2 \rfloor) \bmod n] \f$.
+ * * Con @p n par (el caso normal) es un intercambio de mitades elemento a elemento que ya
+ * aplica la escala; con @p n impar se rota mediante tres inversiones.
+ * @param data  Arreglo en orden FFT; sale centrado y escalado.
+ * @param n     Número de elementos (tamaño de la FFT).
+ * @param scale Factor de normalización.
+ */
+static void psd_shift_scale_inplace(double *data, int n, double scale) {
+    const int half = n / 2;
+    if ((n & 1) == 0) {
+        for (int i = 0; i < half; i++) {
+            const double lo = data[i];
+            data[i] = data[i + half] * scale;
+            data[i + half] = lo * scale;
         }
-        tl_window_cache.u_norm = u_norm / nperseg;
+        return;
     }
+    reverse_doubles(data, half);
+    reverse_doubles(data + half, n - half);
+    reverse_doubles(data, n);
+    for (int i = 0; i < n; i++) data[i] *= scale;
+}
 
-    const double *window = tl_window_cache.window;
-    const double u_norm = tl_window_cache.u_norm;
-
-    // Reset Output
-    memset(p_out, 0, nfft * sizeof(double));
-
-    /*
-     * FFTW plan cache (thread-local):
-     * - Reuse plan/buffers across calls to reduce planning overhead and CPU heat.
-     * - Watchdog: if nfft changes, rebuild only for that worker thread.
-     */
-    static __thread int tl_welch_nfft = 0;
-    static __thread double complex* tl_welch_in = NULL;
-    static __thread double complex* tl_welch_out = NULL;
-    static __thread fftw_plan tl_welch_plan = NULL;
-    static __thread double *tl_welch_accum = NULL;
-    static __thread int tl_welch_accum_nfft = 0;
-
-    // Welch Averaging Loop - Parallelized
-    #pragma omp parallel
-    {
-        // Per-thread watchdog: rebuild plan only when FFT size changes
-        if (tl_welch_plan == NULL || tl_welch_nfft != nfft) {
-            #pragma omp critical(fftw_welch_plan_guard)
-            {
-                if (tl_welch_plan) {
-                    fftw_destroy_plan(tl_welch_plan);
-                    tl_welch_plan = NULL;
-                }
-                if (tl_welch_in) {
-                    fftw_free(tl_welch_in);
-                    tl_welch_in = NULL;
-                }
-                if (tl_welch_out) {
-                    fftw_free(tl_welch_out);
-                    tl_welch_out = NULL;
-                }
-
-                tl_welch_in = fftw_alloc_complex(nfft);
-                tl_welch_out = fftw_alloc_complex(nfft);
-                if (tl_welch_in && tl_welch_out) {
-                    tl_welch_plan = fftw_plan_dft_1d(nfft, tl_welch_in, tl_welch_out, FFTW_FORWARD, FFTW_ESTIMATE);
-                }
-
-                if (!tl_welch_plan) {
-                    if (tl_welch_in) {
-                        fftw_free(tl_welch_in);
-                        tl_welch_in = NULL;
-                    }
-                    if (tl_welch_out) {
-                        fftw_free(tl_welch_out);
-                        tl_welch_out = NULL;
-                    }
-                    tl_welch_nfft = 0;
-                } else {
-                    tl_welch_nfft = nfft;
-                }
-            }
-        }
+int psd_output_bins(const PsdConfig_t *cfg) {
+    if (!cfg) return 0;
+    const psd_output_t *o = &cfg->out;
+    const int len = (o->n_bins > 0) ? o->n_bins : cfg->nperseg;
+    return (o->out_bins > 0 && o->out_bins < len) ? o->out_bins : len;
+}
 
-        double complex* local_fft_in = tl_welch_in;
-        double complex* local_fft_out = tl_welch_out;
-        fftw_plan local_plan = tl_welch_plan;
-        if (tl_welch_accum == NULL || tl_welch_accum_nfft != nfft) {
-            double *new_accum = (double*)realloc(tl_welch_accum, (size_t)nfft * sizeof(double));
-            if (!new_accum) {
-                local_plan = NULL;
-            } else {
-                tl_welch_accum = new_accum;
-                tl_welch_accum_nfft = nfft;
-            }
-        }
-        double *local_accum = tl_welch_accum;
-        if (local_accum) {
-            memset(local_accum, 0, (size_t)nfft * sizeof(double));
-        }
+void psd_output_span(const PsdConfig_t *cfg, double *lo_hz, double *hi_hz) {
+    if (!cfg || cfg->nperseg <= 0) return;
+    const double df = cfg->sample_rate / (double)cfg->nperseg;
+    const int lo = (cfg->out.n_bins > 0) ? cfg->out.bin_lo : 0;
+    const int len = (cfg->out.n_bins > 0) ? cfg->out.n_bins : cfg->nperseg;
+    const double f0 = cfg->zoom.shift_hz - cfg->sample_rate / 2.0;
+    if (lo_hz) *lo_hz = f0 + (double)lo * df;
+    if (hi_hz) *hi_hz = f0 + (double)(lo + len) * df;
+}
 
-        // [PATCH C] Use dynamic scheduling to handle load imbalance
-        #pragma omp for schedule(dynamic, 1)
-        for (int k = 0; k < k_segments; k++) {
-            if (!local_plan || !local_fft_in || !local_fft_out || !local_accum) continue;
+/**
+ * @brief Cierre de un estimador: normalización, fftshift, recorte/pooling y dBm en una pasada.
+ * @details Se prepara antes de la reducción de las filas por hilo, y cada bin reducido pasa
+ * por @ref psd_finalize_store, que lo escribe ya escalado en su posición desplazada. Sin
+ * pooling (lo habitual) el bin sale directamente en dBm dentro de la ventana recortada, así
+ * que no quedan pasadas extra sobre los `nperseg` bins. Con pooling el bin se guarda lineal
+ * y desplazado, y @ref psd_finalize_end reduce los grupos y convierte solo los M de salida.
+ */
+typedef struct {
+    int n;        /**< Bins de la FFT. */
+    int shift;    /**< El bin FFT i va al índice centrado (i + shift) mod n. */
+    int lo;       /**< Primer bin conservado (centrado). */
+    int len;      /**< Bins conservados. */
+    int m;        /**< Bins de salida (@ref psd_output_bins). */
+    psd_pool_t pool; /**< Operador de pooling. */
+    double scale; /**< Normalización de la densidad. */
+    int direct;   /**< 1 = sin pooling: dBm directo en la salida recortada. */
+} psd_finalize_t;
 
-            size_t start = k * step;
-            
-            for (int i = 0; i < nperseg; i++) {
-                if ((start + i) < n_signal) {
-                    local_fft_in[i] = signal[start + i] * window[i];
-                } else {
-                    local_fft_in[i] = 0;
-                }
-            }
+/**
+ * @brief Prepara el cierre de una traza.
+ * @param fz Plan.
+ * @param n Bins de la FFT.
+ * @param scale Normalización (1 si no hay segmentos).
+ * @param o Recorte/reducción pedidos.
+ */
+static void psd_finalize_begin(psd_finalize_t *fz, int n, double scale, const psd_output_t *o) {
+    fz->n = n;
+    fz->shift = n - n / 2;
+    fz->lo = (o->n_bins > 0) ? o->bin_lo : 0;
+    fz->len = (o->n_bins > 0) ? o->n_bins : n;
+    fz->m = (o->out_bins > 0 && o->out_bins < fz->len) ? o->out_bins : fz->len;
+    fz->pool = o->pool;
+    fz->scale = scale;
+    fz->direct = (fz->m == fz->len);
+}
 
-            fftw_execute(local_plan);
+/**
+ * @brief Escribe un bin reducido en su destino final (llamar desde el bucle de reducción).
+ * @param fz Plan.
+ * @param p Traza de salida.
+ * @param i Bin en orden FFT.
+ * @param acc Potencia acumulada sin normalizar.
+ */
+static inline void psd_finalize_store(const psd_finalize_t *fz, double *p, int i, double acc) {
+    int k = i + fz->shift;
+    if (k >= fz->n) k -= fz->n;
+    if (!fz->direct) {
+        p[k] = acc * fz->scale;
+        return;
+    }
+    k -= fz->lo;
+    if ((unsigned)k < (unsigned)fz->len) p[k] = psd_lin_to_dbm(acc * fz->scale);
+}
 
-            // Accumulate Magnitude Squared safely
-            for (int i = 0; i < nfft; i++) {
-                const double re = creal(local_fft_out[i]);
-                const double im = cimag(local_fft_out[i]);
-                local_accum[i] += (re * re) + (im * im);
-            }
+/**
+ * @brief Reduce los grupos de bins de una traza lineal ya centrada y la pasa a dBm.
+ * @details El grupo j cubre los bins [lo + j·len/M, lo + (j+1)·len/M). Se hace in situ y en
+ * orden creciente, lo que es seguro porque cada grupo empieza en un índice >= j.
+ * @param fz Plan.
+ * @param p Traza lineal centrada; sale con @c m valores en dBm.
+ */
+static void psd_pool_to_dbm(const psd_finalize_t *fz, double *p) {
+    for (int j = 0; j < fz->m; j++) {
+        const int a = fz->lo + (int)(((int64_t)j * fz->len) / fz->m);
+        const int b = fz->lo + (int)(((int64_t)(j + 1) * fz->len) / fz->m);
+        double acc = p[a];
+        if (fz->pool == PSD_POOL_MEAN) {
+            for (int i = a + 1; i < b; i++) acc += p[i];
+            acc /= (double)(b - a);
+        } else {
+            for (int i = a + 1; i < b; i++) if (p[i] > acc) acc = p[i];
         }
+        p[j] = psd_lin_to_dbm(acc);
+    }
+}
 
-        if (local_accum) {
-            #pragma omp critical(welch_accum_reduce)
-            {
-                for (int i = 0; i < nfft; i++) {
-                    p_out[i] += local_accum[i];
-                }
-            }
-        }
+/**
+ * @brief Eje de frecuencia de salida de un plan, calculado una vez por (fs, n, recorte, M).
+ * @details Caché por hilo como los planes FFTW: mientras la configuración no cambie cada
+ * llamada solo copia el eje. Cada valor es el centro del bin o grupo, relativo a la portadora.
+ * @param fz Plan.
+ * @param fs Frecuencia de muestreo.
+ * @return Eje de @c m valores, o NULL si falla la reserva.
+ */
+static const double *psd_freq_axis(const psd_finalize_t *fz, double fs) {
+    static __thread double *tl_axis = NULL;
+    static __thread int tl_axis_cap = 0;
+    static __thread int tl_axis_n = 0, tl_axis_lo = -1, tl_axis_len = 0, tl_axis_m = 0;
+    static __thread double tl_axis_fs = 0.0;
+
+    if (tl_axis && tl_axis_n == fz->n && tl_axis_lo == fz->lo && tl_axis_len == fz->len &&
+        tl_axis_m == fz->m && tl_axis_fs == fs) {
+        return tl_axis;
+    }
+    if (tl_axis_cap < fz->m) {
+        double *na = (double*)realloc(tl_axis, (size_t)fz->m * sizeof(double));
+        if (!na) return NULL;
+        tl_axis = na;
+        tl_axis_cap = fz->m;
     }
 
-    // Normalization
-    if (k_segments > 0 && u_norm > 0) {
-        double scale = 1.0 / (fs * u_norm * k_segments * nperseg);
-        
-        #pragma omp parallel for
-        for (int i = 0; i < nfft; i++) {
-            p_out[i] *= scale;
+    const double df = fs / fz->n;
+    for (int j = 0; j < fz->m; j++) {
+        if (fz->direct) {
+            tl_axis[j] = -fs / 2.0 + (fz->lo + j) * df;
+        } else {
+            const int a = fz->lo + (int)(((int64_t)j * fz->len) / fz->m);
+            const int b = fz->lo + (int)(((int64_t)(j + 1) * fz->len) / fz->m);
+            tl_axis[j] = -fs / 2.0 + 0.5 * (double)(a + b - 1) * df;
         }
     }
+    tl_axis_n = fz->n;
+    tl_axis_lo = fz->lo;
+    tl_axis_len = fz->len;
+    tl_axis_m = fz->m;
+    tl_axis_fs = fs;
+    return tl_axis;
+}
 
-    // Shift zero frequency to center
-    fftshift(p_out, nfft);
-
-    convert_to_dbm_inplace(p_out, nfft);
+/**
+ * @brief Termina el cierre tras la reducción: pooling (si aplica) y eje de frecuencia.
+ * @param fz Plan.
+ * @param p Traza escrita por @ref psd_finalize_store.
+ * @param f Eje de frecuencia de salida (NULL = no calcularlo).
+ * @param fs Frecuencia de muestreo.
+ */
+static void psd_finalize_end(const psd_finalize_t *fz, double *p, double *f, double fs) {
+    if (!fz->direct) psd_pool_to_dbm(fz, p);
+    if (!f) return;
+    const double *axis = psd_freq_axis(fz, fs);
+    if (axis) memcpy(f, axis, (size_t)fz->m * sizeof(double));
+}
 
-    // Generate Frequency Axis
-    double df = fs / nfft;
-    
-    #pragma omp parallel for
-    for (int i = 0; i < nfft; i++) {
-        f_out[i] = -fs / 2.0 + i * df;
+/**
+ * @brief Cierre completo de una traza lineal en orden FFT que no pasa por una reducción.
+ * @param p Densidad sin normalizar en orden FFT; sale en dBm con @ref psd_output_bins valores.
+ * @param n Bins de la FFT.
+ * @param scale Normalización.
+ * @param o Recorte/reducción pedidos.
+ */
+static void psd_finalize_inplace(double *p, int n, double scale, const psd_output_t *o) {
+    psd_finalize_t fz;
+    psd_finalize_begin(&fz, n, scale, o);
+    psd_shift_scale_inplace(p, n, scale);
+    if (fz.direct) {
+        for (int j = 0; j < fz.len; j++) p[j] = psd_lin_to_dbm(p[fz.lo + j]);
+    } else {
+        psd_pool_to_dbm(&fz, p);
     }
-
+}
+
+/**
+ * @brief Normaliza y cierra las filas del espectrograma con el mismo recorte/pooling que la traza.
+ * @param s Espectrograma planificado.
+ * @param n_units Segmentos o bloques de la captura.
+ * @param unit_scale Escala de un segmento (la de la traza multiplicada por el número de segmentos).
+ * @param n Bins de la FFT.
+ * @param o Recorte/reducción pedidos.
+ */
+static void psd_spectrogram_finalize(psd_spectrogram_t *s, int n_units, double unit_scale, int n,
+                                     const psd_output_t *o) {
+    // Rows are independent: each thread closes whole rows (scale + shift + dBm in place)
+    #pragma omp parallel for schedule(static)
+    for (int r = 0; r < s->n_rows; r++) {
+        double *row = s->rows + (size_t)r * (size_t)s->row_stride;
+        const int u0 = r * s->seg_per_row;
+        const int nu = (n_units - u0 < s->seg_per_row) ? n_units - u0 : s->seg_per_row;
+        psd_finalize_inplace(row, n, unit_scale / (double)nu, o);
+    }
+    const int len = (o->n_bins > 0) ? o->n_bins : n;
+    s->n_bins = (o->out_bins > 0 && o->out_bins < len) ? o->out_bins : len;
 }
 
 /**
@@ -665,12 +810,351 @@ static double bessi0(double x) {
  */
 static void generate_kaiser_proto(double* h, int len, double beta) {
     double denom = bessi0(beta);
+    #pragma omp parallel for
     for (int n = 0; n < len; n++) {
         double x = 2.0 * n / (len - 1) - 1.0;
         h[n] = bessi0(beta * sqrt(1 - x * x)) / denom;
     }
 }
 
+/** @brief Entradas de la caché de tablas (ventanas Welch + prototipos PFB). */
+#define PSD_TABLE_CACHE_SLOTS 8
+
+/** @brief Alineación de las tablas (línea de caché; cubre AVX-512/NEON). */
+#define PSD_TABLE_ALIGN 64
+
+/**
+ * @brief Tipo de tabla de coeficientes.
+ */
+typedef enum {
+    PSD_TABLE_WINDOW, /**< Ventana Welch de nperseg puntos. */
+    PSD_TABLE_PFB     /**< Prototipo Kaiser del PFB en disposición polifásica tap-major. */
+} psd_table_kind_t;
+
+/**
+ * @brief Tabla de coeficientes de solo lectura compartida entre hilos.
+ * @details `coef[t * n + m]` es el coeficiente de la fase @p m en el tap @p t (para ventanas
+ * `taps = 1`). Se construye una sola vez fuera de la región paralela; los workers solo la leen.
+ */
+typedef struct {
+    psd_table_kind_t kind;
+    PsdWindowType_t window_type; /**< Solo PSD_TABLE_WINDOW. */
+    int n;                       /**< nperseg (Welch) o canales M (PFB). */
+    int taps;                    /**< 1 (Welch) o taps por canal T (PFB). */
+    double beta;                 /**< Beta Kaiser (solo PFB). */
+    double *coef;                /**< n·taps coeficientes en doble precisión, alineados. */
+    float *coef_f32;             /**< Misma tabla en float32 para las rutas F32. */
+    double u_norm;               /**< \f$ \frac{1}{n}\sum w^2 \f$ (solo ventanas). */
+    unsigned refs;               /**< Usuarios activos: una tabla en uso nunca se desaloja. */
+    uint64_t last_use;           /**< Reloj lógico para el reemplazo LRU. */
+} psd_table_t;
+
+static psd_table_t g_psd_tables[PSD_TABLE_CACHE_SLOTS];
+static pthread_mutex_t g_psd_tables_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t g_psd_tables_clock = 0;
+
+static void psd_table_clear(psd_table_t *t) {
+    free(t->coef);
+    free(t->coef_f32);
+    memset(t, 0, sizeof(*t));
+}
+
+static int psd_table_build(psd_table_t *t, psd_table_kind_t kind, PsdWindowType_t window_type,
+                           int n, int taps, double beta) {
+    const size_t len = (size_t)n * (size_t)taps;
+    void *c = NULL, *cf = NULL;
+    if (posix_memalign(&c, PSD_TABLE_ALIGN, len * sizeof(double)) != 0) return -1;
+    if (posix_memalign(&cf, PSD_TABLE_ALIGN, len * sizeof(float)) != 0) {
+        free(c);
+        return -1;
+    }
+    t->coef = (double*)c;
+    t->coef_f32 = (float*)cf;
+
+    if (kind == PSD_TABLE_PFB) {
+        // Tap-major polyphase layout is the prototype itself: h[t*M + m] feeds phase m of tap t
+        generate_kaiser_proto(t->coef, (int)len, beta);
+    } else {
+        generate_window(window_type, t->coef, n);
+    }
+
+    const double *coef = t->coef;
+    float *coef_f32 = t->coef_f32;
+    double sum_sq = 0.0;
+    #pragma omp parallel for reduction(+:sum_sq)
+    for (size_t i = 0; i < len; i++) {
+        coef_f32[i] = (float)coef[i];
+        sum_sq += coef[i] * coef[i];
+    }
+
+    t->kind = kind;
+    t->window_type = window_type;
+    t->n = n;
+    t->taps = taps;
+    t->beta = beta;
+    t->u_norm = sum_sq / (double)len;
+    t->refs = 0;
+    return 0;
+}
+
+/**
+ * @brief Obtiene (o construye) una tabla de coeficientes de la caché de proceso.
+ * @details La búsqueda y la construcción ocurren en el hilo llamador, antes de la región
+ * OpenMP; la tabla queda fijada hasta @ref psd_table_release. Si todas las entradas están
+ * en uso o falla la reserva devuelve NULL.
+ */
+static const psd_table_t *psd_table_acquire(psd_table_kind_t kind, PsdWindowType_t window_type,
+                                            int n, int taps, double beta) {
+    if (n <= 0 || taps <= 0) return NULL;
+    if (kind == PSD_TABLE_PFB) window_type = KAISER_TYPE;
+    else beta = 0.0;
+
+    pthread_mutex_lock(&g_psd_tables_lock);
+    psd_table_t *hit = NULL, *victim = NULL;
+    for (int i = 0; i < PSD_TABLE_CACHE_SLOTS; i++) {
+        psd_table_t *t = &g_psd_tables[i];
+        if (t->coef && t->kind == kind && t->window_type == window_type &&
+            t->n == n && t->taps == taps && t->beta == beta) {
+            hit = t;
+            break;
+        }
+        if (t->refs == 0 && (!victim || !t->coef || (victim->coef && t->last_use < victim->last_use))) {
+            victim = t;
+        }
+    }
+
+    if (!hit && victim) {
+        psd_table_clear(victim);
+        if (psd_table_build(victim, kind, window_type, n, taps, beta) == 0) {
+            hit = victim;
+        } else {
+            psd_table_clear(victim);
+        }
+    }
+    if (hit) {
+        hit->refs++;
+        hit->last_use = ++g_psd_tables_clock;
+    }
+    pthread_mutex_unlock(&g_psd_tables_lock);
+    return hit;
+}
+
+/** @brief Libera la referencia tomada con @ref psd_table_acquire. */
+static void psd_table_release(const psd_table_t *table) {
+    if (!table) return;
+    pthread_mutex_lock(&g_psd_tables_lock);
+    psd_table_t *t = (psd_table_t*)table;
+    if (t->refs > 0) t->refs--;
+    pthread_mutex_unlock(&g_psd_tables_lock);
+}
+
+
+/** @brief Stride (en doubles) de las filas de acumulación: múltiplo de 64 bytes para evitar false sharing. */
+static size_t psd_accum_stride(int n) {
+    return ((size_t)n + 7U) & ~(size_t)7U;
+}
+
+/**
+ * @brief Filas de acumulación por hilo OpenMP (una por hilo del equipo), reutilizadas entre llamadas.
+ * @details El buffer es `__thread` del hilo que invoca el motor PSD; los workers solo lo ven a
+ * través del puntero devuelto, nunca vía TLS. Cada worker escribe su fila y, tras la barrera del
+ * lazo, la reducción por bins reemplaza a la sección `omp critical`.
+ */
+static double *psd_accum_rows(size_t n_doubles) {
+    static __thread double *tl_rows = NULL;
+    static __thread size_t tl_rows_cap = 0;
+    if (tl_rows_cap < n_doubles) {
+        void *p = NULL;
+        if (posix_memalign(&p, PSD_TABLE_ALIGN, n_doubles * sizeof(double)) != 0) return NULL;
+        free(tl_rows);
+        tl_rows = (double*)p;
+        tl_rows_cap = n_doubles;
+    }
+    return tl_rows;
+}
+
+void execute_welch_psd(signal_iq_t* signal_data, const PsdConfig_t* config, double* f_out, double* p_out) {
+    execute_welch_psd_rows(signal_data, config, f_out, p_out, NULL);
+}
+
+void execute_welch_psd_rows(signal_iq_t* signal_data, const PsdConfig_t* config, double* f_out, double* p_out,
+                            psd_spectrogram_t* spec) {
+    if (!signal_data || !config || !f_out || !p_out) return;
+
+    double complex* signal = signal_data->signal_iq;
+    size_t n_signal = signal_data->n_signal;
+    int nperseg = config->nperseg;
+    int noverlap = config->noverlap;
+    double fs = config->sample_rate;
+    
+    int nfft = nperseg;
+    int step = nperseg - noverlap;
+    if (step < 1) step = 1;
+    
+    // Ensure we don't calculate negative segments
+    int k_segments = 0;
+    if (n_signal >= (size_t)nperseg) {
+        k_segments = (int)((n_signal - nperseg) / step) + 1;
+    }
+
+    // Shared read-only window: built once per (type, nperseg), never per thread
+    const psd_table_t *win_table = psd_table_acquire(PSD_TABLE_WINDOW, config->window_type, nperseg, 1, 0.0);
+    if (!win_table) return;
+    const double *window = win_table->coef;
+    const double u_norm = win_table->u_norm;
+
+    // Reset Output
+    memset(p_out, 0, nfft * sizeof(double));
+
+    /*
+     * FFTW plan cache (thread-local):
+     * - Reuse plan/buffers across calls to reduce planning overhead and CPU heat.
+     * - Watchdog: if nfft or the batch size changes, rebuild only for that worker thread.
+     */
+    static __thread int tl_welch_n = 0;
+    static __thread int tl_welch_batch = 0;
+    static __thread double complex* tl_welch_in = NULL;
+    static __thread double complex* tl_welch_out = NULL;
+    static __thread fftw_plan tl_welch_plan = NULL;
+
+    const int n_units = k_segments;
+    // Spectrogram rows are the work items: one thread owns a row, so rows need no reduction
+    if (spec && psd_spectrogram_plan(spec, n_units, nfft, step, fs) != 0) spec = NULL;
+    const int seg_per_row = spec ? spec->seg_per_row : 0;
+    // K segments per fftw_execute; per-thread accumulator rows are reduced without a critical section
+    const int batch = spec ? psd_spectrogram_batch(fft_wisdom_batch_size(nfft), seg_per_row)
+                           : fft_wisdom_batch_size(nfft);
+    const int n_batches = spec ? spec->n_rows : (n_units + batch - 1) / batch;
+    const int n_rows = omp_get_max_threads();
+    const size_t stride = psd_accum_stride(nfft);
+    double *rows = psd_accum_rows((size_t)n_rows * stride);
+    if (!rows) {
+        if (spec) spec->n_rows = 0;
+        psd_table_release(win_table);
+        return;
+    }
+
+    // Normalization, fftshift, crop and dBm are applied as each bin is reduced
+    const int have_norm = (k_segments > 0 && u_norm > 0);
+    const double scale = have_norm ? 1.0 / (fs * u_norm * k_segments * nperseg) : 1.0;
+    psd_finalize_t fz;
+    psd_finalize_begin(&fz, nfft, scale, &config->out);
+
+    // Welch Averaging Loop - Parallelized
+    #pragma omp parallel
+    {
+        // Per-thread watchdog: rebuild plan only when FFT size or batch changes
+        if (tl_welch_plan == NULL || tl_welch_n != nfft || tl_welch_batch != batch) {
+            #pragma omp critical(fftw_welch_plan_guard)
+            {
+                if (tl_welch_plan) {
+                    fft_wisdom_destroy_plan(tl_welch_plan);
+                    tl_welch_plan = NULL;
+                }
+                if (tl_welch_in) {
+                    fftw_free(tl_welch_in);
+                    tl_welch_in = NULL;
+                }
+                if (tl_welch_out) {
+                    fftw_free(tl_welch_out);
+                    tl_welch_out = NULL;
+                }
+
+                tl_welch_in = fftw_alloc_complex((size_t)nfft * (size_t)batch);
+                tl_welch_out = fftw_alloc_complex((size_t)nfft * (size_t)batch);
+                if (tl_welch_in && tl_welch_out) {
+                    tl_welch_plan = fft_wisdom_plan_many_dft(nfft, batch, tl_welch_in, tl_welch_out, FFTW_FORWARD);
+                }
+
+                if (!tl_welch_plan) {
+                    if (tl_welch_in) {
+                        fftw_free(tl_welch_in);
+                        tl_welch_in = NULL;
+                    }
+                    if (tl_welch_out) {
+                        fftw_free(tl_welch_out);
+                        tl_welch_out = NULL;
+                    }
+                    tl_welch_n = 0;
+                    tl_welch_batch = 0;
+                } else {
+                    tl_welch_n = nfft;
+                    tl_welch_batch = batch;
+                }
+            }
+        }
+
+        double complex* local_fft_in = tl_welch_in;
+        double complex* local_fft_out = tl_welch_out;
+        fftw_plan local_plan = tl_welch_plan;
+        const int tid = omp_get_thread_num();
+        double *local_accum = (tid < n_rows) ? rows + (size_t)tid * stride : NULL;
+        if (local_accum) {
+            memset(local_accum, 0, (size_t)nfft * sizeof(double));
+        }
+
+        // [PATCH C] Use dynamic scheduling to handle load imbalance
+        #pragma omp for schedule(dynamic, 1)
+        for (int kb = 0; kb < n_batches; kb++) {
+            if (!local_plan || !local_fft_in || !local_fft_out || !local_accum) continue;
+
+            // Work item: one batch of segments, or every segment of one spectrogram row
+            const int u_begin = spec ? kb * seg_per_row : kb * batch;
+            const int u_span = spec ? seg_per_row : batch;
+            const int u_end = (k_segments - u_begin < u_span) ? k_segments : u_begin + u_span;
+            double *dst = spec ? spec->rows + (size_t)kb * (size_t)spec->row_stride : local_accum;
+            if (spec) memset(dst, 0, (size_t)nfft * sizeof(double));
+
+            for (int k0 = u_begin; k0 < u_end; k0 += batch) {
+                const int nk = (u_end - k0 < batch) ? u_end - k0 : batch;
+                for (int j = 0; j < nk; j++) {
+                    const size_t start = (size_t)(k0 + j) * step;
+                    double complex *seg = local_fft_in + (size_t)j * nfft;
+                    for (int i = 0; i < nperseg; i++) {
+                        if ((start + i) < n_signal) {
+                            seg[i] = signal[start + i] * window[i];
+                        } else {
+                            seg[i] = 0;
+                        }
+                    }
+                }
+                // Short final batch: the spare slots are transformed but never accumulated
+                if (nk < batch) {
+                    memset(local_fft_in + (size_t)nk * nfft, 0, (size_t)(batch - nk) * nfft * sizeof(double complex));
+                }
+
+                fftw_execute(local_plan);
+
+                // Accumulate Magnitude Squared safely
+                for (int j = 0; j < nk; j++) {
+                    pfb_accum_power_cf64(local_fft_out + (size_t)j * nfft, dst, nfft);
+                }
+            }
+            if (spec) {
+                for (int i = 0; i < nfft; i++) local_accum[i] += dst[i];
+            }
+        }
+
+        // Lock-free reduction: after the loop barrier every thread sums a slice of bins over all rows
+        const int n_team = (omp_get_num_threads() < n_rows) ? omp_get_num_threads() : n_rows;
+        #pragma omp for
+        for (int i = 0; i < nfft; i++) {
+            double acc = 0.0;
+            for (int r = 0; r < n_team; r++) acc += rows[(size_t)r * stride + i];
+            psd_finalize_store(&fz, p_out, i, acc);
+        }
+    }
+
+    if (spec) {
+        if (have_norm) psd_spectrogram_finalize(spec, k_segments, scale * k_segments, nfft, &config->out);
+        else spec->n_rows = 0;
+    }
+
+    psd_table_release(win_table);
+
+    // Pooling (if requested) and the cached frequency axis
+    psd_finalize_end(&fz, p_out, f_out, fs);
+}
 
 void execute_pfb_psd(
     signal_iq_t* signal_data,
@@ -678,6 +1162,11 @@ void execute_pfb_psd(
     double* f_out,
     double* p_out
 ) {
+    execute_pfb_psd_rows(signal_data, config, f_out, p_out, NULL);
+}
+
+void execute_pfb_psd_rows(signal_iq_t* signal_data, const PsdConfig_t* config, double* f_out, double* p_out,
+                          psd_spectrogram_t* spec) {
     if (!signal_data || !config || !f_out || !p_out) return;
 
     const int M = config->nperseg;              // Number of channels
@@ -693,45 +1182,58 @@ void execute_pfb_psd(
     /*
      * FFTW plan cache (thread-local):
      * - Reuse plan/buffers across calls to reduce planning overhead and CPU heat.
-     * - Watchdog: if M (FFT size) changes, rebuild only for that worker thread.
+     * - Watchdog: if M (FFT size) or the batch size changes, rebuild only for that worker thread.
      */
-    static __thread int tl_pfb_m = 0;
+    static __thread int tl_pfb_n = 0;
+    static __thread int tl_pfb_batch = 0;
     static __thread double complex* tl_pfb_in = NULL;
     static __thread double complex* tl_pfb_out = NULL;
     static __thread fftw_plan tl_pfb_plan = NULL;
-    static __thread double *tl_pfb_accum = NULL;
-    static __thread int tl_pfb_accum_m = 0;
 
     // -------------------------------------------------
-    // Prototype filter
+    // Prototype filter (shared, tap-major polyphase layout)
     // -------------------------------------------------
-    double* h = (double*)malloc(L * sizeof(double));
-    if (!h) return; 
-    generate_kaiser_proto(h, L, KAISER_BETA);
-
-    // Polyphase components
-    double* poly[T];
-    for (int t = 0; t < T; t++) {
-        poly[t] = (double*)malloc(M * sizeof(double));
-        for (int m = 0; m < M; m++) {
-            poly[t][m] = h[t * M + m];
-        }
-    }
+    if (N < (size_t)L) return;
+    int blocks = (int)((N - L) / M);
+    if (blocks <= 0) return;
+
+    const psd_table_t *proto = psd_table_acquire(PSD_TABLE_PFB, KAISER_TYPE, M, T, KAISER_BETA);
+    if (!proto) return;
+    const double *poly = proto->coef;
 
     // -------------------------------------------------
     // PFB Processing
     // -------------------------------------------------
-    int blocks = (N - L) / M;
-    if (blocks <= 0) goto cleanup;
+    const int n_units = blocks;
+    // Spectrogram rows are the work items: one thread owns a row, so rows need no reduction
+    if (spec && psd_spectrogram_plan(spec, n_units, M, M, fs) != 0) spec = NULL;
+    const int blk_per_row = spec ? spec->seg_per_row : 0;
+    // K blocks per fftw_execute; per-thread accumulator rows are reduced without a critical section
+    const int batch = spec ? psd_spectrogram_batch(fft_wisdom_batch_size(M), blk_per_row)
+                           : fft_wisdom_batch_size(M);
+    const int n_batches = spec ? spec->n_rows : (n_units + batch - 1) / batch;
+    const int n_rows = omp_get_max_threads();
+    const size_t stride = psd_accum_stride(M);
+    double *rows = psd_accum_rows((size_t)n_rows * stride);
+    if (!rows) {
+        if (spec) spec->n_rows = 0;
+        psd_table_release(proto);
+        return;
+    }
+
+    // Normalization, fftshift, crop and dBm are applied as each bin is reduced
+    const double scale = 1.0 / (blocks * fs * M);
+    psd_finalize_t fz;
+    psd_finalize_begin(&fz, M, scale, &config->out);
 
     #pragma omp parallel
     {
-        // Per-thread watchdog: rebuild plan only when FFT size changes
-        if (tl_pfb_plan == NULL || tl_pfb_m != M) {
+        // Per-thread watchdog: rebuild plan only when FFT size or batch changes
+        if (tl_pfb_plan == NULL || tl_pfb_n != M || tl_pfb_batch != batch) {
             #pragma omp critical(fftw_pfb_plan_guard)
             {
                 if (tl_pfb_plan) {
-                    fftw_destroy_plan(tl_pfb_plan);
+                    fft_wisdom_destroy_plan(tl_pfb_plan);
                     tl_pfb_plan = NULL;
                 }
                 if (tl_pfb_in) {
@@ -743,10 +1245,10 @@ void execute_pfb_psd(
                     tl_pfb_out = NULL;
                 }
 
-                tl_pfb_in = fftw_alloc_complex(M);
-                tl_pfb_out = fftw_alloc_complex(M);
+                tl_pfb_in = fftw_alloc_complex((size_t)M * (size_t)batch);
+                tl_pfb_out = fftw_alloc_complex((size_t)M * (size_t)batch);
                 if (tl_pfb_in && tl_pfb_out) {
-                    tl_pfb_plan = fftw_plan_dft_1d(M, tl_pfb_in, tl_pfb_out, FFTW_FORWARD, FFTW_ESTIMATE);
+                    tl_pfb_plan = fft_wisdom_plan_many_dft(M, batch, tl_pfb_in, tl_pfb_out, FFTW_FORWARD);
                 }
 
                 if (!tl_pfb_plan) {
@@ -758,91 +1260,408 @@ void execute_pfb_psd(
                         fftw_free(tl_pfb_out);
                         tl_pfb_out = NULL;
                     }
-                    tl_pfb_m = 0;
+                    tl_pfb_n = 0;
+                    tl_pfb_batch = 0;
                 } else {
-                    tl_pfb_m = M;
+                    tl_pfb_n = M;
+                    tl_pfb_batch = batch;
                 }
             }
         }
 
-        double complex* local_fft_in  = tl_pfb_in;
+        double complex* local_fft_in = tl_pfb_in;
         double complex* local_fft_out = tl_pfb_out;
         fftw_plan local_plan = tl_pfb_plan;
-        if (tl_pfb_accum == NULL || tl_pfb_accum_m != M) {
-            double *new_accum = (double*)realloc(tl_pfb_accum, (size_t)M * sizeof(double));
-            if (!new_accum) {
-                local_plan = NULL;
-            } else {
-                tl_pfb_accum = new_accum;
-                tl_pfb_accum_m = M;
-            }
-        }
-        double *local_accum = tl_pfb_accum;
+        const int tid = omp_get_thread_num();
+        double *local_accum = (tid < n_rows) ? rows + (size_t)tid * stride : NULL;
         if (local_accum) {
             memset(local_accum, 0, (size_t)M * sizeof(double));
         }
 
         // [PATCH C] Use dynamic scheduling to handle load imbalance
         #pragma omp for schedule(dynamic, 1)
-        for (int b = 0; b < blocks; b++) {
+        for (int kb = 0; kb < n_batches; kb++) {
             if (!local_plan || !local_fft_in || !local_fft_out || !local_accum) continue;
 
-            memset(local_fft_in, 0, M * sizeof(double complex));
+            // Work item: one batch of blocks, or every block of one spectrogram row
+            const int u_begin = spec ? kb * blk_per_row : kb * batch;
+            const int u_span = spec ? blk_per_row : batch;
+            const int u_end = (blocks - u_begin < u_span) ? blocks : u_begin + u_span;
+            double *dst = spec ? spec->rows + (size_t)kb * (size_t)spec->row_stride : local_accum;
+            if (spec) memset(dst, 0, (size_t)M * sizeof(double));
+
+            for (int b0 = u_begin; b0 < u_end; b0 += batch) {
+                const int nb = (u_end - b0 < batch) ? u_end - b0 : batch;
+                for (int j = 0; j < nb; j++) {
+                    pfb_fold_cf64(x + (size_t)(b0 + j) * M, poly, M, T, local_fft_in + (size_t)j * M);
+                }
+                if (nb < batch) {
+                    memset(local_fft_in + (size_t)nb * M, 0, (size_t)(batch - nb) * M * sizeof(double complex));
+                }
 
-            for (int t = 0; t < T; t++) {
-                size_t offset = b * M + t * M;
-                for (int m = 0; m < M; m++) {
-                    local_fft_in[m] += x[offset + m] * poly[t][m];
+                fftw_execute(local_plan);
+
+                for (int j = 0; j < nb; j++) {
+                    pfb_accum_power_cf64(local_fft_out + (size_t)j * M, dst, M);
                 }
             }
+            if (spec) {
+                for (int i = 0; i < M; i++) local_accum[i] += dst[i];
+            }
+        }
+
+        // Lock-free reduction: after the loop barrier every thread sums a slice of bins over all rows
+        const int n_team = (omp_get_num_threads() < n_rows) ? omp_get_num_threads() : n_rows;
+        #pragma omp for
+        for (int i = 0; i < M; i++) {
+            double acc = 0.0;
+            for (int r = 0; r < n_team; r++) acc += rows[(size_t)r * stride + i];
+            psd_finalize_store(&fz, p_out, i, acc);
+        }
+    }
+
+    psd_table_release(proto);
 
-            fftw_execute(local_plan);
+    if (spec) psd_spectrogram_finalize(spec, blocks, scale * blocks, M, &config->out);
 
-            for (int k = 0; k < M; k++) {
-                const double re = creal(local_fft_out[k]);
-                const double im = cimag(local_fft_out[k]);
-                local_accum[k] += (re * re) + (im * im);
+    // --- Pooling (if requested) and the cached frequency axis ---
+    psd_finalize_end(&fz, p_out, f_out, fs);
+}
+
+int load_iq_into_signal_f32(const int8_t* buffer, size_t buffer_size, signal_iq_f32_t* signal_data) {
+    if (!buffer || buffer_size == 0 || !signal_data || !signal_data->signal_iq) return -1;
+
+    const size_t n_samples = buffer_size / 2U;
+    if (signal_data->n_signal < n_samples) return -1;
+
+    iq_convert_s8_to_cf32(buffer, signal_data->signal_iq, n_samples);
+
+    signal_data->n_signal = n_samples;
+    return 0;
+}
+
+void iq_compensation_f32_apply(signal_iq_f32_t* signal_data, const iq_moments_t* stats)
+{
+    if (signal_data == NULL || signal_data->signal_iq == NULL || signal_data->n_signal == 0 ||
+        stats == NULL || stats->n == 0)
+        return;
+
+    double meanI, meanQ, gain, rho;
+    iq_comp_coeffs(stats, &meanI, &meanQ, &gain, &rho);
+
+    const size_t N = signal_data->n_signal;
+    float complex* x = signal_data->signal_iq;
+    const float mI = (float)meanI;
+    const float mQ = (float)meanQ;
+    const float g  = (float)gain;
+    const float r  = (float)rho;
+
+    #pragma omp parallel for
+    for (size_t n = 0; n < N; n++) {
+        const float I_n = crealf(x[n]) - mI;
+        const float Q_n = (cimagf(x[n]) - mQ) * g - r * I_n;
+        x[n] = I_n + I * Q_n;
+    }
+}
+
+void iq_compensation_f32(signal_iq_f32_t* signal_data)
+{
+    if (signal_data == NULL || signal_data->signal_iq == NULL || signal_data->n_signal == 0)
+        return;
+
+    const size_t N = signal_data->n_signal;
+    const float complex* x = signal_data->signal_iq;
+    double sI = 0.0, sQ = 0.0, sII = 0.0, sQQ = 0.0, sIQ = 0.0;
+
+    #pragma omp parallel for reduction(+:sI, sQ, sII, sQQ, sIQ)
+    for (size_t n = 0; n < N; n++) {
+        const double I_n = crealf(x[n]);
+        const double Q_n = cimagf(x[n]);
+        sI  += I_n;
+        sQ  += Q_n;
+        sII += I_n * I_n;
+        sQQ += Q_n * Q_n;
+        sIQ += I_n * Q_n;
+    }
+
+    iq_moments_t stats = { sI, sQ, sII, sQQ, sIQ, N };
+    iq_compensation_f32_apply(signal_data, &stats);
+}
+
+void execute_welch_psd_f32(signal_iq_f32_t* signal_data, const PsdConfig_t* config, double* f_out, double* p_out) {
+    if (!signal_data || !config || !f_out || !p_out) return;
+
+    const float complex* signal = signal_data->signal_iq;
+    size_t n_signal = signal_data->n_signal;
+    int nperseg = config->nperseg;
+    int noverlap = config->noverlap;
+    double fs = config->sample_rate;
+
+    int nfft = nperseg;
+    int step = nperseg - noverlap;
+    if (step < 1) step = 1;
+
+    int k_segments = 0;
+    if (n_signal >= (size_t)nperseg) {
+        k_segments = (int)((n_signal - nperseg) / step) + 1;
+    }
+
+    const psd_table_t *win_table = psd_table_acquire(PSD_TABLE_WINDOW, config->window_type, nperseg, 1, 0.0);
+    if (!win_table) return;
+    const float *window = win_table->coef_f32;
+    const double u_norm = win_table->u_norm;
+
+    memset(p_out, 0, nfft * sizeof(double));
+
+    static __thread int tl_welchf_n = 0;
+    static __thread int tl_welchf_batch = 0;
+    static __thread float complex* tl_welchf_in = NULL;
+    static __thread float complex* tl_welchf_out = NULL;
+    static __thread fftwf_plan tl_welchf_plan = NULL;
+
+    const int n_units = k_segments;
+    // K segments per fftw_execute; per-thread accumulator rows are reduced without a critical section
+    const int batch = fft_wisdom_batch_size(nfft);
+    const int n_batches = (n_units + batch - 1) / batch;
+    const int n_rows = omp_get_max_threads();
+    const size_t stride = psd_accum_stride(nfft);
+    double *rows = psd_accum_rows((size_t)n_rows * stride);
+    if (!rows) {
+        psd_table_release(win_table);
+        return;
+    }
+
+    // Normalization, fftshift, crop and dBm are applied as each bin is reduced
+    const double scale = (k_segments > 0 && u_norm > 0) ? 1.0 / (fs * u_norm * k_segments * nperseg) : 1.0;
+    psd_finalize_t fz;
+    psd_finalize_begin(&fz, nfft, scale, &config->out);
+
+    #pragma omp parallel
+    {
+        // Per-thread watchdog: rebuild plan only when FFT size or batch changes
+        if (tl_welchf_plan == NULL || tl_welchf_n != nfft || tl_welchf_batch != batch) {
+            #pragma omp critical(fftw_welch_plan_guard)
+            {
+                if (tl_welchf_plan) {
+                    fft_wisdom_destroy_plan_f32(tl_welchf_plan);
+                    tl_welchf_plan = NULL;
+                }
+                if (tl_welchf_in) {
+                    fftwf_free(tl_welchf_in);
+                    tl_welchf_in = NULL;
+                }
+                if (tl_welchf_out) {
+                    fftwf_free(tl_welchf_out);
+                    tl_welchf_out = NULL;
+                }
+
+                tl_welchf_in = fftwf_alloc_complex((size_t)nfft * (size_t)batch);
+                tl_welchf_out = fftwf_alloc_complex((size_t)nfft * (size_t)batch);
+                if (tl_welchf_in && tl_welchf_out) {
+                    tl_welchf_plan = fft_wisdom_plan_many_dft_f32(nfft, batch, tl_welchf_in, tl_welchf_out, FFTW_FORWARD);
+                }
+
+                if (!tl_welchf_plan) {
+                    if (tl_welchf_in) {
+                        fftwf_free(tl_welchf_in);
+                        tl_welchf_in = NULL;
+                    }
+                    if (tl_welchf_out) {
+                        fftwf_free(tl_welchf_out);
+                        tl_welchf_out = NULL;
+                    }
+                    tl_welchf_n = 0;
+                    tl_welchf_batch = 0;
+                } else {
+                    tl_welchf_n = nfft;
+                    tl_welchf_batch = batch;
+                }
             }
         }
 
+        float complex* local_fft_in = tl_welchf_in;
+        float complex* local_fft_out = tl_welchf_out;
+        fftwf_plan local_plan = tl_welchf_plan;
+        const int tid = omp_get_thread_num();
+        double *local_accum = (tid < n_rows) ? rows + (size_t)tid * stride : NULL;
         if (local_accum) {
-            #pragma omp critical(pfb_accum_reduce)
-            {
-                for (int k = 0; k < M; k++) {
-                    p_out[k] += local_accum[k];
+            memset(local_accum, 0, (size_t)nfft * sizeof(double));
+        }
+
+        #pragma omp for schedule(dynamic, 1)
+        for (int kb = 0; kb < n_batches; kb++) {
+            if (!local_plan || !local_fft_in || !local_fft_out || !local_accum) continue;
+
+            const int k0 = kb * batch;
+            const int nk = (k_segments - k0 < batch) ? k_segments - k0 : batch;
+            for (int j = 0; j < nk; j++) {
+                const float complex *src = signal + (size_t)(k0 + j) * step;
+                float complex *seg = local_fft_in + (size_t)j * nfft;
+                for (int i = 0; i < nperseg; i++) {
+                    seg[i] = src[i] * window[i];
                 }
             }
+            if (nk < batch) {
+                memset(local_fft_in + (size_t)nk * nfft, 0, (size_t)(batch - nk) * nfft * sizeof(float complex));
+            }
+
+            fftwf_execute(local_plan);
+
+            for (int j = 0; j < nk; j++) {
+                pfb_accum_power_cf32(local_fft_out + (size_t)j * nfft, local_accum, nfft);
+            }
+        }
+
+        // Lock-free reduction: after the loop barrier every thread sums a slice of bins over all rows
+        const int n_team = (omp_get_num_threads() < n_rows) ? omp_get_num_threads() : n_rows;
+        #pragma omp for
+        for (int i = 0; i < nfft; i++) {
+            double acc = 0.0;
+            for (int r = 0; r < n_team; r++) acc += rows[(size_t)r * stride + i];
+            psd_finalize_store(&fz, p_out, i, acc);
         }
     }
 
-    // -------------------------------------------------
-    // Normalization
-    // -------------------------------------------------
-    double scale = 1.0 / (blocks * fs * M);
-    
-    #pragma omp parallel for
-    for (int i = 0; i < M; i++) {
-        p_out[i] *= scale;
+    psd_table_release(win_table);
+
+    psd_finalize_end(&fz, p_out, f_out, fs);
+}
+
+void execute_pfb_psd_f32(
+    signal_iq_f32_t* signal_data,
+    const PsdConfig_t* config,
+    double* f_out,
+    double* p_out
+) {
+    if (!signal_data || !config || !f_out || !p_out) return;
+
+    const int M = config->nperseg;
+    const int T = PFB_TAPS_PER_CHANNEL;
+    const int L = M * T;
+    const double fs = config->sample_rate;
+
+    size_t N = signal_data->n_signal;
+    const float complex* x = signal_data->signal_iq;
+
+    memset(p_out, 0, M * sizeof(double));
+
+    static __thread int tl_pfbf_n = 0;
+    static __thread int tl_pfbf_batch = 0;
+    static __thread float complex* tl_pfbf_in = NULL;
+    static __thread float complex* tl_pfbf_out = NULL;
+    static __thread fftwf_plan tl_pfbf_plan = NULL;
+
+    if (N < (size_t)L) return;
+    int blocks = (int)((N - L) / M);
+    if (blocks <= 0) return;
+
+    // Shared prototype, stored tap-major in float: poly[t*M + m] = h[t*M + m]
+    const psd_table_t *proto = psd_table_acquire(PSD_TABLE_PFB, KAISER_TYPE, M, T, KAISER_BETA);
+    if (!proto) return;
+    const float *poly = proto->coef_f32;
+
+    const int n_units = blocks;
+    // K blocks per fftw_execute; per-thread accumulator rows are reduced without a critical section
+    const int batch = fft_wisdom_batch_size(M);
+    const int n_batches = (n_units + batch - 1) / batch;
+    const int n_rows = omp_get_max_threads();
+    const size_t stride = psd_accum_stride(M);
+    double *rows = psd_accum_rows((size_t)n_rows * stride);
+    if (!rows) {
+        psd_table_release(proto);
+        return;
     }
 
-    // --- FFT Shift ---
-    fftshift(p_out, M);
+    // Normalization, fftshift, crop and dBm are applied as each bin is reduced
+    const double scale = 1.0 / (blocks * fs * M);
+    psd_finalize_t fz;
+    psd_finalize_begin(&fz, M, scale, &config->out);
 
-    convert_to_dbm_inplace(p_out, M);
+    #pragma omp parallel
+    {
+        // Per-thread watchdog: rebuild plan only when FFT size or batch changes
+        if (tl_pfbf_plan == NULL || tl_pfbf_n != M || tl_pfbf_batch != batch) {
+            #pragma omp critical(fftw_pfb_plan_guard)
+            {
+                if (tl_pfbf_plan) {
+                    fft_wisdom_destroy_plan_f32(tl_pfbf_plan);
+                    tl_pfbf_plan = NULL;
+                }
+                if (tl_pfbf_in) {
+                    fftwf_free(tl_pfbf_in);
+                    tl_pfbf_in = NULL;
+                }
+                if (tl_pfbf_out) {
+                    fftwf_free(tl_pfbf_out);
+                    tl_pfbf_out = NULL;
+                }
 
-    // -------------------------------------------------
-    // Frequency axis
-    // -------------------------------------------------
-    double df = fs / M;
-    
-    #pragma omp parallel for
-    for (int i = 0; i < M; i++) {
-        f_out[i] = -fs / 2.0 + i * df;
+                tl_pfbf_in = fftwf_alloc_complex((size_t)M * (size_t)batch);
+                tl_pfbf_out = fftwf_alloc_complex((size_t)M * (size_t)batch);
+                if (tl_pfbf_in && tl_pfbf_out) {
+                    tl_pfbf_plan = fft_wisdom_plan_many_dft_f32(M, batch, tl_pfbf_in, tl_pfbf_out, FFTW_FORWARD);
+                }
+
+                if (!tl_pfbf_plan) {
+                    if (tl_pfbf_in) {
+                        fftwf_free(tl_pfbf_in);
+                        tl_pfbf_in = NULL;
+                    }
+                    if (tl_pfbf_out) {
+                        fftwf_free(tl_pfbf_out);
+                        tl_pfbf_out = NULL;
+                    }
+                    tl_pfbf_n = 0;
+                    tl_pfbf_batch = 0;
+                } else {
+                    tl_pfbf_n = M;
+                    tl_pfbf_batch = batch;
+                }
+            }
+        }
+
+        float complex* local_fft_in = tl_pfbf_in;
+        float complex* local_fft_out = tl_pfbf_out;
+        fftwf_plan local_plan = tl_pfbf_plan;
+        const int tid = omp_get_thread_num();
+        double *local_accum = (tid < n_rows) ? rows + (size_t)tid * stride : NULL;
+        if (local_accum) {
+            memset(local_accum, 0, (size_t)M * sizeof(double));
+        }
+
+        #pragma omp for schedule(dynamic, 1)
+        for (int kb = 0; kb < n_batches; kb++) {
+            if (!local_plan || !local_fft_in || !local_fft_out || !local_accum) continue;
+
+            const int b0 = kb * batch;
+            const int nb = (blocks - b0 < batch) ? blocks - b0 : batch;
+            for (int j = 0; j < nb; j++) {
+                pfb_fold_cf32(x + (size_t)(b0 + j) * M, poly, M, T, local_fft_in + (size_t)j * M);
+            }
+            if (nb < batch) {
+                memset(local_fft_in + (size_t)nb * M, 0, (size_t)(batch - nb) * M * sizeof(float complex));
+            }
+
+            fftwf_execute(local_plan);
+
+            for (int j = 0; j < nb; j++) {
+                pfb_accum_power_cf32(local_fft_out + (size_t)j * M, local_accum, M);
+            }
+        }
+
+        // Lock-free reduction: after the loop barrier every thread sums a slice of bins over all rows
+        const int n_team = (omp_get_num_threads() < n_rows) ? omp_get_num_threads() : n_rows;
+        #pragma omp for
+        for (int i = 0; i < M; i++) {
+            double acc = 0.0;
+            for (int r = 0; r < n_team; r++) acc += rows[(size_t)r * stride + i];
+            psd_finalize_store(&fz, p_out, i, acc);
+        }
     }
 
-cleanup:
-    for (int t = 0; t < T; t++) free(poly[t]);
-    free(h);
+    psd_table_release(proto);
+
+    psd_finalize_end(&fz, p_out, f_out, fs);
 }
 
 /** @} */
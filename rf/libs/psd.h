@@ -9,6 +9,9 @@
 #include "datatypes.h"
 #include "parser.h"
 #include "sdr_HAL.h"
+#include "iq_convert.h"
+#include "iq_zoom.h"
+#include "psd_spectrogram.h"
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
@@ -55,6 +58,27 @@
  */
 #define POWER_FLOOR_WATTS 1.0e-20
 
+/**
+ * @brief Tope de la captura derivada de `target_averages` (bytes IQ int8).
+ * Deja al ring (128 MiB) espacio para el doble buffer del streaming.
+ */
+#define PSD_TARGET_MAX_BYTES ((size_t)64U << 20)
+
+/**
+ * @brief Momentos crudos de primer y segundo orden de una captura IQ.
+ *
+ * Suficientes para derivar los tres coeficientes de @ref iq_compensation
+ * (media DC, balance de ganancia y decorrelación) sin volver a recorrer la señal.
+ */
+typedef struct {
+    double sum_i;  /**< \f$ \sum I_n \f$ */
+    double sum_q;  /**< \f$ \sum Q_n \f$ */
+    double sum_ii; /**< \f$ \sum I_n^2 \f$ */
+    double sum_qq; /**< \f$ \sum Q_n^2 \f$ */
+    double sum_iq; /**< \f$ \sum I_n Q_n \f$ */
+    size_t n;      /**< Número de muestras acumuladas. */
+} iq_moments_t;
+
 /**
  * @brief Carga y convierte un búfer de bytes interleaved en señal compleja IQ.
  * @param buffer Puntero a datos [I0, Q0, I1, Q1, ...].
@@ -72,6 +96,38 @@ signal_iq_t* load_iq_from_buffer(const int8_t* buffer, size_t buffer_size);
  */
 int load_iq_into_signal(const int8_t* buffer, size_t buffer_size, signal_iq_t* signal_data);
 
+/**
+ * @brief Igual que @ref load_iq_into_signal, pero acumula en la misma pasada los momentos IQ.
+ * @details Los momentos se calculan sobre los int8 originales en enteros de 64 bits (exactos),
+ * de modo que @ref iq_compensation_apply puede corregir la señal en una sola pasada adicional.
+ * @param buffer Puntero a datos [I0, Q0, I1, Q1, ...].
+ * @param buffer_size Tamaño total en bytes.
+ * @param signal_data Estructura destino con capacidad suficiente en signal_iq.
+ * @param[out] stats Momentos de la captura.
+ * @return 0 en éxito, -1 si hay error o la capacidad no alcanza.
+ */
+int load_iq_into_signal_stats(const int8_t* buffer, size_t buffer_size, signal_iq_t* signal_data, iq_moments_t* stats);
+
+/**
+ * @brief Aplica la compensación IQ con coeficientes derivados de @p stats (una sola pasada).
+ * @param[in,out] signal_data Señal a corregir in-place.
+ * @param[in] stats Momentos de la misma señal (ver @ref load_iq_into_signal_stats).
+ */
+void iq_compensation_apply(signal_iq_t* signal_data, const iq_moments_t* stats);
+
+/**
+ * @brief Variante de @ref load_iq_into_signal_stats que lee hasta dos tramos contiguos.
+ * @details Pensada para consumir directamente las regiones de @ref rb_peek_regions sin copiar
+ * la captura a un búfer lineal. Cada tramo debe tener un número par de bytes.
+ * @param spans Punteros a los tramos (spans[1] puede ser NULL si span_bytes[1] es 0).
+ * @param span_bytes Bytes de cada tramo.
+ * @param signal_data Estructura destino con capacidad suficiente en signal_iq.
+ * @param[out] stats Momentos de la captura completa.
+ * @return 0 en éxito, -1 si hay error o la capacidad no alcanza.
+ */
+int load_iq_spans_into_signal_stats(const int8_t* const spans[2], const size_t span_bytes[2],
+                                    signal_iq_t* signal_data, iq_moments_t* stats);
+
 /**
  * @brief Compensación de desequilibrios IQ (IQ Imbalance Compensation).
  *
@@ -107,6 +163,9 @@ int load_iq_into_signal(const int8_t* buffer, size_t buffer_size, signal_iq_t* s
  *
  * @note Esta compensación mejora significativamente el rechazo de la imagen espectral,
  * pero no sustituye una calibración analógica completa del receptor.
+ * @note Los coeficientes se derivan de momentos crudos en una pasada de estadísticas y
+ * se aplican en una segunda pasada. Si los datos vienen de un búfer int8, preferir
+ * @ref load_iq_into_signal_stats + @ref iq_compensation_apply (la señal se toca dos veces).
  */
 void iq_compensation(signal_iq_t* signal_data);
 
@@ -143,10 +202,38 @@ double get_window_enbw_factor(PsdWindowType_t type);
  *
  * @return 0 en caso de éxito.
  *
+ * Con `out_crop` (y filtro activo) y/o `out_bins`, también fija `psd_cfg->out`: los estimadores
+ * entregan entonces solo los bins de la banda del filtro, reducidos por pooling en potencia lineal.
+ * El `nperseg` (y por tanto el RBW) no cambia; en un barrido la salida nunca se reduce.
+ *
+ * Con `zoom` (y filtro activo) planifica @ref iq_zoom_plan: \f$ F_s \f$ en la fórmula pasa a ser
+ * \f$ F_s / D \f$, de modo que el mismo RBW sale de una FFT D veces más chica, y la salida se
+ * recorta siempre a la banda. La captura del ring no cambia de tamaño.
+ *
+ * Sin `target_averages` la captura es de \f$ F_s/4 \f$ bytes. Con `target_averages = K` se
+ * dimensiona para exactamente K promedios a la tasa del estimador: \f$ (K-1) \cdot hop + N_{perseg} \f$
+ * muestras en Welch, \f$ (K + T) \cdot M \f$ en PFB (T = @ref PFB_TAPS_PER_CHANNEL), por D más la
+ * historia del FIR con zoom, acotada a @ref PSD_TARGET_MAX_BYTES.
+ *
  * @note El RBW resultante es aproximado y depende del tipo de ventana seleccionada.
  */
 int find_params_psd(DesiredCfg_t desired, SDR_cfg_t *hack_cfg, PsdConfig_t *psd_cfg, RB_cfg_t *rb_cfg);
 
+/**
+ * @brief Bins que entregan los estimadores con la configuración dada (`nperseg` sin reducción).
+ * @param cfg Configuración PSD.
+ */
+int psd_output_bins(const PsdConfig_t *cfg);
+
+/**
+ * @brief Límites de frecuencia de la salida, relativos a la portadora nominal (Hz).
+ * @details Con zoom incluyen el desplazamiento del centro de la banda (`zoom.shift_hz`).
+ * @param cfg Configuración PSD.
+ * @param[out] lo_hz Borde inferior del primer bin conservado (-fs/2 sin recorte).
+ * @param[out] hi_hz Borde superior del último bin conservado (+fs/2 sin recorte).
+ */
+void psd_output_span(const PsdConfig_t *cfg, double *lo_hz, double *hi_hz);
+
 /**
  * @brief Estimación de PSD mediante Banco de Filtros Polifásicos (PFB).
  *
@@ -174,13 +261,27 @@ int find_params_psd(DesiredCfg_t desired, SDR_cfg_t *hack_cfg, PsdConfig_t *psd_
  * @param[in]  signal_data Señal IQ compleja de entrada.
  * @param[in]  config      Configuración PSD (M se interpreta como número de canales).
  * @param[out] f_out       Eje de frecuencias centrado en DC (Hz).
- * @param[out] p_out       PSD estimada en dBm.
+ * @param[out] p_out       PSD estimada en dBm (@ref psd_output_bins valores; buffer de `nperseg`).
  *
  * @note La potencia resultante es una densidad espectral relativa a la escala
  * digital del sistema. No representa potencia RF absoluta sin calibración.
  */
 void execute_pfb_psd(signal_iq_t* signal_data, const PsdConfig_t* config, double* f_out, double* p_out);
 
+/**
+ * @brief @ref execute_pfb_psd que además entrega filas de espectrograma.
+ * @details Con @p spec no NULL los bloques se reparten por filas de @ref psd_spectrogram_plan:
+ * cada hilo transforma todos los bloques de una fila, los acumula en la fila y los suma a su
+ * traza. La traza resultante es la misma que sin espectrograma.
+ * @param[in]     signal_data Señal IQ compleja de entrada.
+ * @param[in]     config      Configuración PSD.
+ * @param[out]    f_out       Eje de frecuencias (Hz).
+ * @param[out]    p_out       PSD estimada en dBm.
+ * @param[in,out] spec        Espectrograma (`cfg` fijado por el llamador; NULL = solo la traza).
+ */
+void execute_pfb_psd_rows(signal_iq_t* signal_data, const PsdConfig_t* config, double* f_out, double* p_out,
+                          psd_spectrogram_t* spec);
+
 /**
  * @brief Estimación de la Densidad Espectral de Potencia mediante el método de Welch.
  *
@@ -216,7 +317,7 @@ void execute_pfb_psd(signal_iq_t* signal_data, const PsdConfig_t* config, double
  * @param[in]  signal_data Señal IQ compleja de entrada.
  * @param[in]  config      Parámetros de segmentación, solape y ventana.
  * @param[out] f_out       Eje de frecuencias en Hz.
- * @param[out] p_out       PSD estimada en dBm.
+ * @param[out] p_out       PSD estimada en dBm (@ref psd_output_bins valores; buffer de `nperseg`).
  *
  * @note Los valores en dBm son relativos a la escala digital del ADC.
  * Para obtener potencia RF absoluta es necesaria una calibración externa
@@ -224,6 +325,92 @@ void execute_pfb_psd(signal_iq_t* signal_data, const PsdConfig_t* config, double
  */
 void execute_welch_psd(signal_iq_t* signal_data, const PsdConfig_t* config, double* f_out, double* p_out);
 
+/**
+ * @brief @ref execute_welch_psd que además entrega filas de espectrograma.
+ * @details Igual que @ref execute_pfb_psd_rows, con segmentos en lugar de bloques: la fila r
+ * promedia los periodogramas $ P_k $ con $ k \in [rK, (r+1)K) $.
+ * @param[in]     signal_data Señal IQ compleja de entrada.
+ * @param[in]     config      Parámetros de segmentación, solape y ventana.
+ * @param[out]    f_out       Eje de frecuencias (Hz).
+ * @param[out]    p_out       PSD estimada en dBm.
+ * @param[in,out] spec        Espectrograma (`cfg` fijado por el llamador; NULL = solo la traza).
+ */
+void execute_welch_psd_rows(signal_iq_t* signal_data, const PsdConfig_t* config, double* f_out, double* p_out,
+                            psd_spectrogram_t* spec);
+
+/**
+ * @name Ruta float32 (fftwf)
+ * Variantes en precisión simple de la cadena IQ → PSD. Reducen a la mitad el
+ * tráfico de memoria por muestra respecto a `double complex` y mantienen la misma
+ * semántica de nperseg/RBW, normalización y salida en dBm (doble precisión).
+ * @{
+ */
+
+/**
+ * @brief Convierte un búfer IQ int8 intercalado a float32 complejo usando @ref iq_convert_s8_to_cf32.
+ * @param buffer Puntero a datos [I0, Q0, I1, Q1, ...].
+ * @param buffer_size Tamaño total en bytes.
+ * @param signal_data Estructura destino con capacidad suficiente en signal_iq.
+ * @return 0 en éxito, -1 si hay error o la capacidad no alcanza.
+ */
+int load_iq_into_signal_f32(const int8_t* buffer, size_t buffer_size, signal_iq_f32_t* signal_data);
+
+/**
+ * @brief Carga float32 fusionada con la acumulación de momentos IQ (por bloques en L1).
+ * @param buffer Puntero a datos [I0, Q0, I1, Q1, ...].
+ * @param buffer_size Tamaño total en bytes.
+ * @param signal_data Estructura destino con capacidad suficiente en signal_iq.
+ * @param[out] stats Momentos de la captura.
+ * @return 0 en éxito, -1 si hay error o la capacidad no alcanza.
+ */
+int load_iq_into_signal_f32_stats(const int8_t* buffer, size_t buffer_size, signal_iq_f32_t* signal_data, iq_moments_t* stats);
+
+/**
+ * @brief Variante float32 de @ref iq_compensation_apply.
+ * @param[in,out] signal_data Señal float32 a corregir in-place.
+ * @param[in] stats Momentos de la misma señal.
+ */
+void iq_compensation_f32_apply(signal_iq_f32_t* signal_data, const iq_moments_t* stats);
+
+/**
+ * @brief Variante float32 de @ref load_iq_spans_into_signal_stats.
+ * @param spans Punteros a los tramos.
+ * @param span_bytes Bytes de cada tramo (pares).
+ * @param signal_data Estructura destino float32.
+ * @param[out] stats Momentos de la captura completa.
+ * @return 0 en éxito, -1 si hay error o la capacidad no alcanza.
+ */
+int load_iq_spans_into_signal_f32_stats(const int8_t* const spans[2], const size_t span_bytes[2],
+                                        signal_iq_f32_t* signal_data, iq_moments_t* stats);
+
+/**
+ * @brief Compensación de desequilibrio IQ sobre una señal float32.
+ * @details Misma corrección que @ref iq_compensation (DC, ganancia y decorrelación);
+ * las estadísticas se acumulan en doble precisión.
+ * @param[in,out] signal_data Señal float32 a corregir in-place.
+ */
+void iq_compensation_f32(signal_iq_f32_t* signal_data);
+
+/**
+ * @brief Variante float32 de @ref execute_welch_psd (FFT con fftwf, acumulación en double).
+ * @param[in]  signal_data Señal IQ float32 de entrada.
+ * @param[in]  config      Parámetros de segmentación, solape y ventana.
+ * @param[out] f_out       Eje de frecuencias en Hz.
+ * @param[out] p_out       PSD estimada en dBm (@ref psd_output_bins valores; buffer de `nperseg`).
+ */
+void execute_welch_psd_f32(signal_iq_f32_t* signal_data, const PsdConfig_t* config, double* f_out, double* p_out);
+
+/**
+ * @brief Variante float32 de @ref execute_pfb_psd (FFT con fftwf, acumulación en double).
+ * @param[in]  signal_data Señal IQ float32 de entrada.
+ * @param[in]  config      Configuración PSD (M se interpreta como número de canales).
+ * @param[out] f_out       Eje de frecuencias centrado en DC (Hz).
+ * @param[out] p_out       PSD estimada en dBm (@ref psd_output_bins valores; buffer de `nperseg`).
+ */
+void execute_pfb_psd_f32(signal_iq_f32_t* signal_data, const PsdConfig_t* config, double* f_out, double* p_out);
+
+/** @} */
+
 /** @} */ // Fin de psd_module
 
 #endif
@@ -0,0 +1,127 @@
+/**
+ * @file psd_avg.c
+ * @brief Implementación del promediado persistente de trazas PSD.
+ */
+#include "psd_avg.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @addtogroup psd_avg_module
+ * @{
+ */
+
+/** @brief Piso lineal (mW) antes de volver a dBm, coherente con el piso del estimador. */
+#define PSD_AVG_LIN_FLOOR 1e-30
+
+static inline double dbm_to_lin(double dbm) {
+    return pow(10.0, dbm * 0.1);
+}
+
+static inline double lin_to_dbm(double lin) {
+    return 10.0 * log10(lin > PSD_AVG_LIN_FLOOR ? lin : PSD_AVG_LIN_FLOOR);
+}
+
+static bool same_key(const psd_avg_t *a, psd_avg_mode_t mode, const PsdConfig_t *cfg, Psd_method method,
+                     uint64_t center_freq, int n_bins) {
+    return a->count > 0 &&
+           a->mode == mode &&
+           a->n_bins == n_bins &&
+           a->method == method &&
+           a->center_freq == center_freq &&
+           a->cfg.window_type == cfg->window_type &&
+           a->cfg.sample_rate == cfg->sample_rate &&
+           a->cfg.nperseg == cfg->nperseg &&
+           a->cfg.noverlap == cfg->noverlap &&
+           memcmp(&a->cfg.out, &cfg->out, sizeof(cfg->out)) == 0 &&
+           memcmp(&a->cfg.zoom, &cfg->zoom, sizeof(cfg->zoom)) == 0;
+}
+
+/** @brief Factor exponencial efectivo para la captura número @p k (1-based). */
+static double effective_alpha(const psd_avg_params_t *p, uint32_t k) {
+    if (p->mode == PSD_AVG_LINEAR) {
+        // Running mean until the configured count, then a 1/count exponential tail
+        if (p->count > 0 && k > (uint32_t)p->count) return 1.0 / (double)p->count;
+        return 1.0 / (double)k;
+    }
+    if (p->alpha > 0.0 && p->alpha <= 1.0) return p->alpha;
+    if (p->count > 0) return 1.0 / (double)p->count;
+    return PSD_AVG_DEFAULT_ALPHA;
+}
+
+int psd_avg_apply(psd_avg_t *a, const psd_avg_params_t *p, const PsdConfig_t *cfg, Psd_method method,
+                  uint64_t center_freq, double *psd_dbm, int n_bins) {
+    if (!a || !p || !cfg || !psd_dbm || n_bins <= 0) return -1;
+    if (p->mode == PSD_AVG_OFF) {
+        a->count = 0;
+        return 0;
+    }
+
+    if (p->reset || !same_key(a, p->mode, cfg, method, center_freq, n_bins)) {
+        if (a->capacity < n_bins) {
+            double *acc = (double*)realloc(a->acc, (size_t)n_bins * sizeof(double));
+            if (!acc) return -1;
+            a->acc = acc;
+            a->capacity = n_bins;
+        }
+        a->mode = p->mode;
+        a->cfg = *cfg;
+        a->method = method;
+        a->center_freq = center_freq;
+        a->n_bins = n_bins;
+        a->count = 0;
+    }
+
+    double *acc = a->acc;
+    const uint32_t k = ++a->count;
+
+    if (k == 1) {
+        if (p->mode == PSD_AVG_MAX_HOLD || p->mode == PSD_AVG_MIN_HOLD) {
+            memcpy(acc, psd_dbm, (size_t)n_bins * sizeof(double));
+        } else {
+            #pragma omp parallel for
+            for (int i = 0; i < n_bins; i++) acc[i] = dbm_to_lin(psd_dbm[i]);
+        }
+        return 1;
+    }
+
+    switch (p->mode) {
+        case PSD_AVG_MAX_HOLD:
+            for (int i = 0; i < n_bins; i++) {
+                if (psd_dbm[i] > acc[i]) acc[i] = psd_dbm[i];
+                psd_dbm[i] = acc[i];
+            }
+            break;
+        case PSD_AVG_MIN_HOLD:
+            for (int i = 0; i < n_bins; i++) {
+                if (psd_dbm[i] < acc[i]) acc[i] = psd_dbm[i];
+                psd_dbm[i] = acc[i];
+            }
+            break;
+        default: {
+            const double alpha = effective_alpha(p, k);
+            #pragma omp parallel for
+            for (int i = 0; i < n_bins; i++) {
+                const double v = acc[i] + alpha * (dbm_to_lin(psd_dbm[i]) - acc[i]);
+                acc[i] = v;
+                psd_dbm[i] = lin_to_dbm(v);
+            }
+            break;
+        }
+    }
+    return (k > (uint32_t)INT32_MAX) ? INT32_MAX : (int)k;
+}
+
+void psd_avg_reset(psd_avg_t *a) {
+    if (a) a->count = 0;
+}
+
+void psd_avg_free(psd_avg_t *a) {
+    if (!a) return;
+    free(a->acc);
+    memset(a, 0, sizeof(*a));
+}
+
+/** @} */
@@ -0,0 +1,88 @@
+/**
+ * @file psd_avg.h
+ * @brief Promediado persistente de trazas PSD entre requests (estilo analizador de espectro).
+ *
+ * El estimador Welch/PFB promedia segmentos dentro de una sola captura. Este módulo
+ * conserva un acumulador entre capturas sucesivas con la misma configuración espectral
+ * y la misma frecuencia central, de modo que la varianza baja con el número de
+ * requests y no solo con la longitud de cada captura:
+ *   - Lineal: media acumulada en potencia lineal; al alcanzar `count` capturas continúa
+ *     como exponencial con \f$ \alpha = 1/count \f$.
+ *   - Exponencial: \f$ \bar{P}_k = (1-\alpha)\bar{P}_{k-1} + \alpha P_k \f$.
+ *   - Max-hold y min-hold: extremo por bin (comparación directa en dBm).
+ *
+ * Cualquier cambio de ventana, tasa, nperseg, solapamiento, método, frecuencia central o
+ * modo reinicia el acumulador. El módulo no es thread-safe: pertenece al hilo principal.
+ */
+
+#ifndef PSD_AVG_H
+#define PSD_AVG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "datatypes.h"
+
+/**
+ * @defgroup psd_avg_module PSD Averaging
+ * @ingroup rf_binary
+ * @brief Acumuladores de traza persistentes entre capturas.
+ * @{
+ */
+
+#define PSD_AVG_DEFAULT_ALPHA 0.25 /**< \f$ \alpha \f$ exponencial si el request no indica `alpha` ni `count`. */
+
+/**
+ * @brief Estado persistente de la traza promediada.
+ */
+typedef struct {
+    psd_avg_mode_t mode;    /**< Modo del acumulador actual. */
+    PsdConfig_t cfg;        /**< Configuración espectral con la que se inició. */
+    Psd_method method;      /**< Estimador con el que se inició. */
+    uint64_t center_freq;   /**< Frecuencia central nominal con la que se inició (Hz). */
+    double *acc;            /**< Potencia lineal (promedios) o dBm (holds), un valor por bin. */
+    int n_bins;             /**< Bins válidos en @ref acc. */
+    int capacity;           /**< Capacidad reservada de @ref acc. */
+    uint32_t count;         /**< Capturas acumuladas desde el último reinicio. */
+} psd_avg_t;
+
+/**
+ * @brief Parámetros de promediado de un request.
+ */
+typedef struct {
+    psd_avg_mode_t mode;    /**< Modo pedido (@ref PSD_AVG_OFF = sin acumulador). */
+    int count;              /**< Lineal: capturas hasta pasar a exponencial; exponencial: \f$ \alpha = 1/count \f$ (0 = sin límite / default). */
+    double alpha;           /**< Factor exponencial explícito en (0, 1] (0 = derivar de @ref count). */
+    bool reset;             /**< Reinicia el acumulador antes de sumar esta captura. */
+} psd_avg_params_t;
+
+/**
+ * @brief Combina una traza nueva con el acumulador y deja el resultado en @p psd_dbm.
+ * @param a Estado persistente.
+ * @param p Parámetros del request.
+ * @param cfg Configuración espectral de la captura.
+ * @param method Estimador usado en la captura.
+ * @param center_freq Frecuencia central nominal de la captura (Hz).
+ * @param[in,out] psd_dbm Traza de la captura en dBm; se reemplaza por la traza promediada.
+ * @param n_bins Número de bins.
+ * @return Capturas acumuladas incluida esta (1 tras un reinicio), 0 si el modo es
+ *         @ref PSD_AVG_OFF, -1 si falla la reserva (la traza queda sin modificar).
+ */
+int psd_avg_apply(psd_avg_t *a, const psd_avg_params_t *p, const PsdConfig_t *cfg, Psd_method method,
+                  uint64_t center_freq, double *psd_dbm, int n_bins);
+
+/**
+ * @brief Descarta la traza acumulada sin liberar memoria.
+ * @param a Estado.
+ */
+void psd_avg_reset(psd_avg_t *a);
+
+/**
+ * @brief Libera el acumulador.
+ * @param a Estado.
+ */
+void psd_avg_free(psd_avg_t *a);
+
+/** @} */
+
+#endif
@@ -0,0 +1,202 @@
+/**
+ * @file psd_detect.c
+ * @brief Implementación de la detección de ocupación y picos sobre la PSD.
+ */
+#include "psd_detect.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/**
+ * @addtogroup psd_detect_module
+ * @{
+ */
+
+static inline void swap_d(double *a, double *b) {
+    const double t = *a;
+    *a = *b;
+    *b = t;
+}
+
+/** @brief Deja en v[k] el k-ésimo menor (Hoare con pivote mediana de tres). */
+static void select_kth(double *v, int n, int k) {
+    int lo = 0, hi = n - 1;
+    while (hi > lo) {
+        const int mid = lo + (hi - lo) / 2;
+        if (v[mid] < v[lo]) swap_d(&v[mid], &v[lo]);
+        if (v[hi] < v[lo]) swap_d(&v[hi], &v[lo]);
+        if (v[hi] < v[mid]) swap_d(&v[hi], &v[mid]);
+        const double pivot = v[mid];
+
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (v[i] < pivot) i++;
+            while (v[j] > pivot) j--;
+            if (i <= j) {
+                swap_d(&v[i], &v[j]);
+                i++;
+                j--;
+            }
+        }
+        if (k <= j) hi = j;
+        else if (k >= i) lo = i;
+        else return;
+    }
+}
+
+double psd_detect_median(double *v, int n) {
+    if (!v || n <= 0) return 0.0;
+
+    const int k = n / 2;
+    select_kth(v, n, k);
+    if (n & 1) return v[k];
+
+    // Even count: the lower middle is the largest value left of k
+    double lower = v[0];
+    for (int i = 1; i < k; i++) {
+        if (v[i] > lower) lower = v[i];
+    }
+    return 0.5 * (lower + v[k]);
+}
+
+int psd_detect_peaks(const double *psd, int n, double threshold, int min_dist, int max_peaks,
+                     int *idx, double *pwr) {
+    if (!psd || !idx || !pwr || max_peaks <= 0) return 0;
+    for (int k = 0; k < max_peaks; ++k) {
+        idx[k] = -1;
+        pwr[k] = -1e300;
+    }
+
+    for (int i = 1; i < n - 1; ++i) {
+        if (psd[i] < threshold) continue;
+        if (!(psd[i] > psd[i - 1] && psd[i] >= psd[i + 1])) continue;
+
+        int too_close = 0;
+        for (int k = 0; k < max_peaks; ++k) {
+            if (idx[k] >= 0 && abs(i - idx[k]) < min_dist) {
+                too_close = 1;
+                break;
+            }
+        }
+        if (too_close) continue;
+
+        int pos = -1;
+        for (int k = 0; k < max_peaks; ++k) {
+            if (psd[i] > pwr[k]) {
+                pos = k;
+                break;
+            }
+        }
+        if (pos >= 0) {
+            for (int m = max_peaks - 1; m > pos; --m) {
+                pwr[m] = pwr[m - 1];
+                idx[m] = idx[m - 1];
+            }
+            pwr[pos] = psd[i];
+            idx[pos] = i;
+        }
+    }
+
+    int found = 0;
+    while (found < max_peaks && idx[found] >= 0) found++;
+    return found;
+}
+
+int psd_detect_run(const psd_detect_cfg_t *cfg, const double *psd, int n, double start_hz, double end_hz,
+                   double *scratch, psd_detect_result_t *out) {
+    if (!cfg || !psd || !scratch || !out || n < 3 || end_hz <= start_hz) return -1;
+
+    const double df = (end_hz - start_hz) / (double)n;
+    const double thr_db = (cfg->threshold_db > 0.0) ? cfg->threshold_db : PSD_DETECT_DEFAULT_THRESHOLD_DB;
+
+    memcpy(scratch, psd, (size_t)n * sizeof(double));
+    out->noise_floor_dbm = psd_detect_median(scratch, n);
+    out->threshold_dbm = out->noise_floor_dbm + thr_db;
+    const double thr = out->threshold_dbm;
+
+    int above = 0;
+    for (int i = 0; i < n; i++) above += (psd[i] > thr);
+    out->occupancy = (double)above / (double)n;
+
+    // Peaks: same spacing rule as the calibration candidates unless the request sets one
+    int max_peaks = (cfg->max_peaks > 0) ? cfg->max_peaks : PSD_DETECT_DEFAULT_PEAKS;
+    if (max_peaks > PSD_DETECT_MAX_PEAKS) max_peaks = PSD_DETECT_MAX_PEAKS;
+    int min_dist = (cfg->min_spacing_hz > 0.0) ? (int)ceil(cfg->min_spacing_hz / df)
+                                               : (int)llround(300.0 * ((double)n / 65536.0));
+    if (min_dist < 1) min_dist = 1;
+    if (cfg->min_spacing_hz <= 0.0 && min_dist < 8) min_dist = 8;
+
+    int idx[PSD_DETECT_MAX_PEAKS];
+    double pw[PSD_DETECT_MAX_PEAKS];
+    out->n_peaks = psd_detect_peaks(psd, n, thr, min_dist, max_peaks, idx, pw);
+    for (int k = 0; k < out->n_peaks; k++) {
+        out->peaks[k].bin = idx[k];
+        out->peaks[k].freq_hz = start_hz + (double)idx[k] * df;
+        out->peaks[k].power_dbm = pw[k];
+    }
+
+    out->n_channels = 0;
+    if (cfg->chan_width_hz <= 0.0) return 0;
+
+    const double w = cfg->chan_width_hz;
+    const double c0 = (cfg->chan_start_hz > 0) ? (double)cfg->chan_start_hz : start_hz;
+    int n_ch = (cfg->chan_count > 0) ? cfg->chan_count : (int)floor((end_hz - c0) / w + 1e-9);
+    if (n_ch > PSD_DETECT_MAX_CHANNELS) n_ch = PSD_DETECT_MAX_CHANNELS;
+
+    for (int c = 0; c < n_ch; c++) {
+        const double f_lo = c0 + (double)c * w;
+        const double f_hi = f_lo + w;
+        int b_lo = (int)ceil((f_lo - start_hz) / df);
+        int b_hi = (int)ceil((f_hi - start_hz) / df);
+        if (b_lo < 0) b_lo = 0;
+        if (b_hi > n) b_hi = n;
+        if (b_hi <= b_lo) continue; // channel outside the span
+
+        int occ = 0;
+        double max_db = -1e300, sum_lin = 0.0;
+        for (int i = b_lo; i < b_hi; i++) {
+            occ += (psd[i] > thr);
+            if (psd[i] > max_db) max_db = psd[i];
+            sum_lin += pow(10.0, psd[i] / 10.0);
+        }
+
+        psd_channel_t *ch = &out->channels[out->n_channels++];
+        ch->center_hz = f_lo + 0.5 * w;
+        ch->occupancy = (double)occ / (double)(b_hi - b_lo);
+        ch->max_dbm = max_db;
+        ch->power_dbm = 10.0 * log10(sum_lin * df + 1e-300);
+    }
+    return 0;
+}
+
+int psd_detect_add_json(cJSON *parent, const psd_detect_result_t *r) {
+    if (!parent || !r) return -1;
+
+    cJSON *obj = cJSON_AddObjectToObject(parent, "detect");
+    if (!obj) return -1;
+
+    cJSON_AddNumberToObject(obj, "noise_floor_dbm", r->noise_floor_dbm);
+    cJSON_AddNumberToObject(obj, "threshold_dbm", r->threshold_dbm);
+    cJSON_AddNumberToObject(obj, "occupancy", r->occupancy);
+
+    cJSON *peaks = cJSON_AddArrayToObject(obj, "peaks");
+    if (!peaks) return -1;
+    for (int k = 0; k < r->n_peaks; k++) {
+        const double row[2] = { r->peaks[k].freq_hz, r->peaks[k].power_dbm };
+        cJSON_AddItemToArray(peaks, cJSON_CreateDoubleArray(row, 2));
+    }
+
+    if (r->n_channels > 0) {
+        cJSON *chans = cJSON_AddArrayToObject(obj, "channels");
+        if (!chans) return -1;
+        for (int c = 0; c < r->n_channels; c++) {
+            const psd_channel_t *ch = &r->channels[c];
+            const double row[4] = { ch->center_hz, ch->occupancy, ch->max_dbm, ch->power_dbm };
+            cJSON_AddItemToArray(chans, cJSON_CreateDoubleArray(row, 4));
+        }
+    }
+    return 0;
+}
+
+/** @} */
@@ -0,0 +1,122 @@
+/**
+ * @file psd_detect.h
+ * @brief Detección de señales sobre la PSD en el sensor: piso de ruido, ocupación y picos.
+ *
+ * El servidor recibía siempre el arreglo `Pxx` completo y hacía toda la detección. Este
+ * módulo resume una PSD en dBm en unos pocos números:
+ *   - Piso de ruido: mediana de los bins (selección en tiempo lineal, sin ordenar).
+ *   - Ocupación: fracción de bins por encima de piso + umbral, global y por canal de un plan
+ *     uniforme (inicio, ancho, número de canales), junto con el máximo y la potencia integrada
+ *     de cada canal.
+ *   - Top-N picos: máximos locales sobre el umbral, con separación mínima entre picos (el mismo
+ *     criterio que usa la calibración para elegir candidatos).
+ *
+ * Con `only` el reply lleva solo este resumen y el uplink por PSD baja de decenas de kB a
+ * unos cientos de bytes.
+ */
+
+#ifndef PSD_DETECT_H
+#define PSD_DETECT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <cjson/cJSON.h>
+#include "datatypes.h"
+
+/**
+ * @defgroup psd_detect_module PSD Detection
+ * @ingroup rf_binary
+ * @brief Resumen de ocupación y picos calculado sobre la PSD.
+ * @{
+ */
+
+#define PSD_DETECT_MAX_PEAKS 64            /**< Máximo de picos reportables. */
+#define PSD_DETECT_MAX_CHANNELS 512        /**< Máximo de canales por plan. */
+#define PSD_DETECT_DEFAULT_THRESHOLD_DB 6.0 /**< Umbral sobre el piso si el request no lo indica. */
+#define PSD_DETECT_DEFAULT_PEAKS 10        /**< Picos reportados si el request no lo indica. */
+
+/**
+ * @brief Pico detectado.
+ */
+typedef struct {
+    int bin;          /**< Índice del bin en la PSD. */
+    double freq_hz;   /**< Frecuencia absoluta del bin (Hz). */
+    double power_dbm; /**< Densidad del bin (dBm/Hz, misma escala que `Pxx`). */
+} psd_peak_t;
+
+/**
+ * @brief Estado de un canal del plan.
+ */
+typedef struct {
+    double center_hz; /**< Frecuencia central del canal (Hz). */
+    double occupancy; /**< Fracción de bins del canal sobre el umbral (0..1). */
+    double max_dbm;   /**< Bin más alto del canal. */
+    double power_dbm; /**< Potencia integrada del canal (dBm). */
+} psd_channel_t;
+
+/**
+ * @brief Resultado de @ref psd_detect_run.
+ */
+typedef struct {
+    double noise_floor_dbm;                      /**< Mediana de los bins. */
+    double threshold_dbm;                        /**< Piso + umbral. */
+    double occupancy;                            /**< Fracción de bins del span sobre el umbral. */
+    int n_peaks;                                 /**< Entradas válidas de @ref peaks (orden descendente). */
+    psd_peak_t peaks[PSD_DETECT_MAX_PEAKS];      /**< Picos detectados. */
+    int n_channels;                              /**< Entradas válidas de @ref channels. */
+    psd_channel_t channels[PSD_DETECT_MAX_CHANNELS]; /**< Canales del plan que caen dentro del span. */
+} psd_detect_result_t;
+
+/**
+ * @brief Mediana en tiempo lineal esperado (selección in situ; reordena @p v).
+ * @param[in,out] v Valores (se permutan).
+ * @param n Número de valores.
+ * @return Mediana (promedio de los dos centrales si @p n es par), 0 si @p n <= 0.
+ */
+double psd_detect_median(double *v, int n);
+
+/**
+ * @brief Top-N máximos locales por encima de @p threshold con separación mínima.
+ * @details Recorre los bins una vez e inserta cada máximo local en una lista ordenada de
+ * tamaño @p max_peaks, descartando los que quedan a menos de @p min_dist bins de un pico ya
+ * retenido. Las entradas sin pico quedan con índice -1 y potencia -1e300.
+ * @param psd PSD en dB.
+ * @param n Número de bins.
+ * @param threshold Umbral absoluto (misma escala que @p psd).
+ * @param min_dist Separación mínima en bins.
+ * @param max_peaks Capacidad de @p idx y @p pwr.
+ * @param[out] idx Índices de los picos, de mayor a menor.
+ * @param[out] pwr Valores de los picos.
+ * @return Número de picos encontrados.
+ */
+int psd_detect_peaks(const double *psd, int n, double threshold, int min_dist, int max_peaks,
+                     int *idx, double *pwr);
+
+/**
+ * @brief Calcula piso de ruido, ocupación, plan de canales y picos de una PSD.
+ * @param cfg Configuración de detección del request.
+ * @param psd PSD en dBm/Hz (bins uniformes sobre [@p start_hz, @p end_hz)).
+ * @param n Número de bins.
+ * @param start_hz Frecuencia del primer bin.
+ * @param end_hz Límite superior del span.
+ * @param scratch Buffer de al menos @p n doubles (para la mediana).
+ * @param[out] out Resultado.
+ * @return 0 en éxito, -1 si los parámetros son inválidos.
+ */
+int psd_detect_run(const psd_detect_cfg_t *cfg, const double *psd, int n, double start_hz, double end_hz,
+                   double *scratch, psd_detect_result_t *out);
+
+/**
+ * @brief Agrega el objeto `"detect"` a @p parent.
+ * @details Claves `noise_floor_dbm`, `threshold_dbm`, `occupancy`, `peaks` (`[freq_hz, dbm]` por
+ * pico) y, con plan de canales, `channels` (`[fc_hz, occupancy, max_dbm, power_dbm]` por canal).
+ * @param parent Objeto JSON destino.
+ * @param r Resultado de @ref psd_detect_run.
+ * @return 0 en éxito, -1 si falla la reserva.
+ */
+int psd_detect_add_json(cJSON *parent, const psd_detect_result_t *r);
+
+/** @} */
+
+#endif
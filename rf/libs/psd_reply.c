@@ -0,0 +1,69 @@
+/**
+ * @file psd_reply.c
+ * @brief Implementación del empaquetado binario del reply PSD.
+ */
+#include "psd_reply.h"
+
+/**
+ * @addtogroup psd_reply_module
+ * @{
+ */
+
+size_t psd_reply_payload_bytes(reply_format_t fmt, int n_bins) {
+    if (n_bins <= 0) return 0;
+    if (fmt == REPLY_FORMAT_F32) return (size_t)n_bins * sizeof(float);
+    if (fmt == REPLY_FORMAT_I16) return (size_t)n_bins * sizeof(int16_t);
+    return 0;
+}
+
+/**
+ * @brief Cuantiza linealmente los bins dBm a int16 usando el rango dinámico del frame.
+ * @details El rango [min, max] se mapea a [-32767, 32767]; el paso resultante se
+ * publica en la cabecera para que el receptor reconstruya los dB.
+ */
+static void encode_i16(const double *psd_dbm, int n_bins, psd_reply_header_t *hdr, int16_t *out) {
+    double lo = psd_dbm[0];
+    double hi = psd_dbm[0];
+    for (int i = 1; i < n_bins; i++) {
+        if (psd_dbm[i] < lo) lo = psd_dbm[i];
+        if (psd_dbm[i] > hi) hi = psd_dbm[i];
+    }
+
+    double offset = 0.5 * (hi + lo);
+    double scale  = (hi - lo) / 65534.0;
+    if (!(scale > 0.0)) scale = 1.0;
+    double inv_scale = 1.0 / scale;
+
+    for (int i = 0; i < n_bins; i++) {
+        long q = lrint((psd_dbm[i] - offset) * inv_scale);
+        if (q > 32767) q = 32767;
+        if (q < -32767) q = -32767;
+        out[i] = (int16_t)q;
+    }
+
+    hdr->q_scale_db  = (float)scale;
+    hdr->q_offset_db = (float)offset;
+}
+
+int psd_reply_encode(const double *psd_dbm, int n_bins, reply_format_t fmt,
+                     psd_reply_header_t *hdr, void *payload) {
+    if (!psd_dbm || n_bins <= 0 || !hdr || !payload) return -1;
+    if (fmt != REPLY_FORMAT_F32 && fmt != REPLY_FORMAT_I16) return -1;
+
+    hdr->magic    = PSD_REPLY_MAGIC;
+    hdr->version  = PSD_REPLY_VERSION;
+    hdr->format   = (uint8_t)fmt;
+    hdr->n_bins   = (uint32_t)n_bins;
+
+    if (fmt == REPLY_FORMAT_F32) {
+        float *out = (float *)payload;
+        for (int i = 0; i < n_bins; i++) out[i] = (float)psd_dbm[i];
+        hdr->q_scale_db  = 0.0f;
+        hdr->q_offset_db = 0.0f;
+    } else {
+        encode_i16(psd_dbm, n_bins, hdr, (int16_t *)payload);
+    }
+    return 0;
+}
+
+/** @} */
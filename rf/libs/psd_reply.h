@@ -0,0 +1,101 @@
+/**
+ * @file psd_reply.h
+ * @brief Serialización binaria del reply PSD (cabecera fija + bins).
+ *
+ * Alternativa compacta al JSON con arreglo "Pxx": el reply se envía como un
+ * mensaje ZMQ multipart de dos frames. El primer frame es una cabecera de tamaño
+ * fijo (@ref psd_reply_header_t, little-endian) y el segundo contiene los bins en
+ * dBm como float32 o como int16 cuantizados linealmente. Un tercer frame opcional
+ * (@ref psd_reply_capture_t) ubica la captura en el tiempo.
+ */
+
+#ifndef PSD_REPLY_H
+#define PSD_REPLY_H
+
+#include "datatypes.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+/**
+ * @defgroup psd_reply_module PSD Reply
+ * @ingroup rf_binary
+ * @brief Empaquetado binario de resultados PSD para transporte ZMQ.
+ * @{
+ */
+
+/** @brief Valor mágico de la cabecera ("PSD0" en little-endian). */
+#define PSD_REPLY_MAGIC   0x30445350u
+/** @brief Versión del layout de la cabecera binaria. */
+#define PSD_REPLY_VERSION 1
+
+/**
+ * @brief Cabecera fija (48 bytes) del reply PSD binario.
+ *
+ * Para @ref REPLY_FORMAT_I16 cada bin se reconstruye como
+ * \f$ dBm_i = q_{offset} + q_i \cdot q_{scale} \f$.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;         /**< @ref PSD_REPLY_MAGIC. */
+    uint16_t version;       /**< @ref PSD_REPLY_VERSION. */
+    uint8_t  format;        /**< Valor de @ref reply_format_t (F32 o I16). */
+    uint8_t  rf_mode;       /**< Valor de @ref rf_mode_t. */
+    uint32_t n_bins;        /**< Número de bins en el frame de datos. */
+    uint32_t nperseg;       /**< Tamaño de segmento FFT usado en la estimación. */
+    double   start_freq_hz; /**< Frecuencia del primer bin (Hz, nominal). */
+    double   end_freq_hz;   /**< Frecuencia final del span (Hz, nominal). */
+    float    metric;        /**< Excursión FM (Hz) o profundidad AM (%); 0 en modo PSD. */
+    float    q_scale_db;    /**< Escala dB por paso de cuantización (solo I16). */
+    float    q_offset_db;   /**< Offset dB de la cuantización (solo I16). */
+    uint32_t seq;           /**< Secuencia del frame en modo streaming (0 en REQ/REP). */
+} psd_reply_header_t;
+
+_Static_assert(sizeof(psd_reply_header_t) == 48, "psd_reply_header_t debe medir 48 bytes");
+
+/** @brief Valor mágico del frame de captura ("CAP0" en little-endian). */
+#define PSD_REPLY_CAPTURE_MAGIC 0x30504143u
+
+#define PSD_REPLY_CAPTURE_VALID 0x01u /**< @ref psd_reply_capture_t::flags: la captura se ubicó. */
+#define PSD_REPLY_CAPTURE_GPS   0x02u /**< @ref psd_reply_capture_t::flags: `t_utc_ns` viene del GPS. */
+
+/**
+ * @brief Frame opcional (40 bytes) con la línea de tiempo de la primera muestra.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;           /**< @ref PSD_REPLY_CAPTURE_MAGIC. */
+    uint8_t  flags;           /**< @ref PSD_REPLY_CAPTURE_VALID | @ref PSD_REPLY_CAPTURE_GPS. */
+    uint8_t  reserved[3];     /**< Ceros. */
+    uint64_t sample_index;    /**< Índice de la primera muestra en el stream. */
+    int64_t  t_mono_ns;       /**< `CLOCK_MONOTONIC` del nodo en la primera muestra. */
+    int64_t  t_utc_ns;        /**< UTC de la primera muestra (ns desde 1970). */
+    uint64_t dropped_samples; /**< Muestras perdidas dentro de la captura. */
+} psd_reply_capture_t;
+
+_Static_assert(sizeof(psd_reply_capture_t) == 40, "psd_reply_capture_t debe medir 40 bytes");
+
+/**
+ * @brief Tamaño en bytes del frame de datos para un formato y número de bins.
+ * @param fmt Formato binario (F32 o I16).
+ * @param n_bins Número de bins.
+ * @return Bytes requeridos, o 0 si el formato no es binario.
+ */
+size_t psd_reply_payload_bytes(reply_format_t fmt, int n_bins);
+
+/**
+ * @brief Convierte los bins dBm al formato binario y completa los campos de cuantización.
+ * @details Los campos de frecuencia, modo y métrica de la cabecera quedan a cargo del llamador;
+ * esta función escribe magic, version, format, n_bins y q_scale_db/q_offset_db (no toca seq).
+ * @param[in]  psd_dbm Arreglo de bins en dBm.
+ * @param[in]  n_bins Número de bins.
+ * @param[in]  fmt Formato binario (F32 o I16).
+ * @param[out] hdr Cabecera a completar.
+ * @param[out] payload Buffer de al menos @ref psd_reply_payload_bytes bytes.
+ * @return 0 en éxito, -1 si los argumentos son inválidos.
+ */
+int psd_reply_encode(const double *psd_dbm, int n_bins, reply_format_t fmt,
+                     psd_reply_header_t *hdr, void *payload);
+
+/** @} */
+
+#endif
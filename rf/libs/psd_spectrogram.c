@@ -0,0 +1,201 @@
+/**
+ * @file psd_spectrogram.c
+ * @brief Implementación del plan de filas y la codificación delta + PackBits del espectrograma.
+ */
+#include "psd_spectrogram.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @addtogroup psd_spectrogram_module
+ * @{
+ */
+
+static int grow_bytes(void **buf, size_t *cap, size_t need) {
+    if (*cap >= need) return 0;
+    void *p = realloc(*buf, need);
+    if (!p) return -1;
+    *buf = p;
+    *cap = need;
+    return 0;
+}
+
+int psd_spectrogram_plan(psd_spectrogram_t *s, int n_units, int nfft, int hop, double fs) {
+    if (!s) return -1;
+    s->n_rows = 0;
+    s->n_bins = 0;
+    if (n_units <= 0 || nfft <= 0 || hop <= 0 || !(fs > 0.0)) return -1;
+
+    int max_rows = (s->cfg.max_rows > 0) ? s->cfg.max_rows : PSD_SPEC_DEFAULT_ROWS;
+    if (max_rows > PSD_SPEC_MAX_ROWS) max_rows = PSD_SPEC_MAX_ROWS;
+    const int cell_rows = PSD_SPEC_MAX_CELLS / nfft;
+    if (max_rows > cell_rows) max_rows = (cell_rows > 0) ? cell_rows : 1;
+
+    int k = (s->cfg.segments > 0) ? s->cfg.segments : 1;
+    if ((n_units + k - 1) / k > max_rows) k = (n_units + max_rows - 1) / max_rows;
+    const int n_rows = (n_units + k - 1) / k;
+
+    const size_t need = (size_t)n_rows * (size_t)nfft;
+    if (s->rows_cap < need) {
+        double *p = (double*)realloc(s->rows, need * sizeof(double));
+        if (!p) return -1;
+        s->rows = p;
+        s->rows_cap = need;
+    }
+
+    s->seg_per_row = k;
+    s->n_rows = n_rows;
+    s->row_stride = nfft;
+    s->dt_s = (double)k * (double)hop / fs;
+    return 0;
+}
+
+int psd_spectrogram_batch(int batch, int seg_per_row) {
+    if (batch < 1) batch = 1;
+    if (seg_per_row <= batch) return (seg_per_row > 0) ? seg_per_row : 1;
+    const int chunks = (seg_per_row + batch - 1) / batch;
+    return (seg_per_row + chunks - 1) / chunks;
+}
+
+/**
+ * @brief PackBits: cabecera n en [0, 127] = n + 1 literales; n en [129, 255] = el byte siguiente
+ * repetido 257 - n veces. Corridas de 3 o más bytes se codifican como repetición.
+ * @return Bytes escritos en @p dst (como máximo n + ceil(n / 128)).
+ */
+static size_t packbits_encode(const uint8_t *src, size_t n, uint8_t *dst) {
+    size_t i = 0, o = 0;
+    while (i < n) {
+        size_t run = 1;
+        while (i + run < n && run < 128 && src[i + run] == src[i]) run++;
+        if (run >= 3) {
+            dst[o++] = (uint8_t)(257 - run);
+            dst[o++] = src[i];
+            i += run;
+            continue;
+        }
+
+        const size_t start = i;
+        size_t len = 0;
+        while (i < n && len < 128) {
+            if (i + 2 < n && src[i] == src[i + 1] && src[i] == src[i + 2]) break;
+            i++;
+            len++;
+        }
+        dst[o++] = (uint8_t)(len - 1);
+        memcpy(dst + o, src + start, len);
+        o += len;
+    }
+    return o;
+}
+
+static size_t base64_encode(const uint8_t *src, size_t n, char *dst) {
+    static const char tbl[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t o = 0, i = 0;
+    for (; i + 3 <= n; i += 3) {
+        const uint32_t v = ((uint32_t)src[i] << 16) | ((uint32_t)src[i + 1] << 8) | src[i + 2];
+        dst[o++] = tbl[(v >> 18) & 63];
+        dst[o++] = tbl[(v >> 12) & 63];
+        dst[o++] = tbl[(v >> 6) & 63];
+        dst[o++] = tbl[v & 63];
+    }
+    if (i < n) {
+        uint32_t v = (uint32_t)src[i] << 16;
+        if (i + 1 < n) v |= (uint32_t)src[i + 1] << 8;
+        dst[o++] = tbl[(v >> 18) & 63];
+        dst[o++] = tbl[(v >> 12) & 63];
+        dst[o++] = (i + 1 < n) ? tbl[(v >> 6) & 63] : '=';
+        dst[o++] = '=';
+    }
+    dst[o] = '\0';
+    return o;
+}
+
+static inline uint32_t quantize(double v, double offset, double step, long lo, long hi) {
+    long q = lround((v - offset) / step);
+    if (q < lo) q = lo;
+    if (q > hi) q = hi;
+    return (uint32_t)q;
+}
+
+int psd_spectrogram_add_json(cJSON *parent, psd_spectrogram_t *s) {
+    if (!parent || !s || s->n_rows <= 0 || s->n_bins <= 0 || !s->rows) return -1;
+
+    const bool wide = (s->cfg.format == PSD_SPEC_I16);
+    const double step = (s->cfg.step_db > 0.0) ? s->cfg.step_db
+                                               : (wide ? PSD_SPEC_I16_STEP_DB : PSD_SPEC_U8_STEP_DB);
+    const int nr = s->n_rows, nb = s->n_bins;
+    const size_t cells = (size_t)nr * (size_t)nb;
+    const size_t q_bytes = cells * (wide ? 2U : 1U);
+
+    // u8 rows sit on the floor of the whole frame (or 255 steps under its peak if the frame is
+    // wider than that: the deep floor clips, not the signals); i16 covers ±327 dB at the default step
+    double offset = 0.0;
+    if (!wide) {
+        double mn = s->rows[0], mx = s->rows[0];
+        for (int r = 0; r < nr; r++) {
+            const double *row = s->rows + (size_t)r * (size_t)s->row_stride;
+            for (int i = 0; i < nb; i++) {
+                if (row[i] < mn) mn = row[i];
+                if (row[i] > mx) mx = row[i];
+            }
+        }
+        offset = floor(mn / step) * step;
+        const double top = ceil(mx / step) * step - 255.0 * step;
+        if (top > offset) offset = top;
+    }
+    const long q_lo = wide ? -32768 : 0;
+    const long q_hi = wide ? 32767 : 255;
+
+    if (grow_bytes((void**)&s->q, &s->q_cap, q_bytes) != 0 ||
+        grow_bytes((void**)&s->enc, &s->enc_cap, q_bytes + q_bytes / 128U + 1U) != 0) return -1;
+
+    // Row-to-row delta modulo the word size; i16 bytes are split in low/high planes
+    for (int r = 0; r < nr; r++) {
+        const double *row = s->rows + (size_t)r * (size_t)s->row_stride;
+        const double *prev = (r > 0) ? row - s->row_stride : NULL;
+        for (int i = 0; i < nb; i++) {
+            const size_t k = (size_t)r * (size_t)nb + (size_t)i;
+            uint32_t d = quantize(row[i], offset, step, q_lo, q_hi);
+            if (prev) d -= quantize(prev[i], offset, step, q_lo, q_hi);
+            if (wide) {
+                s->q[k] = (uint8_t)(d & 0xFFu);
+                s->q[cells + k] = (uint8_t)((d >> 8) & 0xFFu);
+            } else {
+                s->q[k] = (uint8_t)d;
+            }
+        }
+    }
+
+    const size_t enc_len = packbits_encode(s->q, q_bytes, s->enc);
+    if (grow_bytes((void**)&s->b64, &s->b64_cap, 4U * ((enc_len + 2U) / 3U) + 1U) != 0) return -1;
+    base64_encode(s->enc, enc_len, s->b64);
+
+    cJSON *obj = cJSON_AddObjectToObject(parent, "spectrogram");
+    if (!obj) return -1;
+    cJSON_AddNumberToObject(obj, "rows", nr);
+    cJSON_AddNumberToObject(obj, "bins", nb);
+    cJSON_AddNumberToObject(obj, "segments_per_row", s->seg_per_row);
+    cJSON_AddNumberToObject(obj, "dt_s", s->dt_s);
+    cJSON *t = cJSON_AddArrayToObject(obj, "t_s");
+    if (!t) return -1;
+    for (int r = 0; r < nr; r++) cJSON_AddItemToArray(t, cJSON_CreateNumber((double)r * s->dt_s));
+    cJSON_AddStringToObject(obj, "format", wide ? "i16" : "u8");
+    cJSON_AddStringToObject(obj, "encoding", "delta_packbits");
+    cJSON_AddNumberToObject(obj, "q_offset_db", offset);
+    cJSON_AddNumberToObject(obj, "q_scale_db", step);
+    cJSON_AddStringToObject(obj, "data", s->b64);
+    return 0;
+}
+
+void psd_spectrogram_free(psd_spectrogram_t *s) {
+    if (!s) return;
+    free(s->rows);
+    free(s->q);
+    free(s->enc);
+    free(s->b64);
+    memset(s, 0, sizeof(*s));
+}
+
+/** @} */
@@ -0,0 +1,103 @@
+/**
+ * @file psd_spectrogram.h
+ * @brief Espectrograma a partir de los segmentos de Welch/PFB, con codificación compacta.
+ *
+ * Los estimadores calculan un periodograma por segmento (Welch) o por bloque (PFB) y lo
+ * promedian en una sola traza. Con un @ref psd_spectrogram_t los mismos periodogramas se
+ * acumulan además por grupos de K segmentos consecutivos: cada grupo es una fila con su
+ * índice temporal (\f$ t_r = r \cdot K \cdot hop / f_s \f$), con el mismo recorte/pooling y
+ * la misma escala dBm que la traza.
+ *
+ * Para el uplink las filas se cuantizan (uint8 sobre un offset dinámico o int16 absoluto),
+ * se restan de la fila anterior (módulo 2^8 / 2^16; en int16 los bytes bajos y altos van en
+ * planos separados) y se comprimen con PackBits. Un espectro estable deja filas delta casi
+ * nulas, que PackBits reduce a unos pocos bytes por corrida. El resultado viaja en base64
+ * dentro del JSON.
+ */
+
+#ifndef PSD_SPECTROGRAM_H
+#define PSD_SPECTROGRAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <cjson/cJSON.h>
+#include "datatypes.h"
+
+/**
+ * @defgroup psd_spectrogram_module PSD Spectrogram
+ * @ingroup rf_binary
+ * @brief Filas tiempo-frecuencia de la PSD y su codificación para el uplink.
+ * @{
+ */
+
+#define PSD_SPEC_DEFAULT_ROWS 64       /**< Filas si el request no indica `max_rows`. */
+#define PSD_SPEC_MAX_ROWS     1024     /**< Máximo de filas por reply. */
+#define PSD_SPEC_MAX_CELLS    (1 << 22) /**< Tope de filas × nperseg acumuladas (32 MB en doble). */
+#define PSD_SPEC_U8_STEP_DB   0.5      /**< Paso por defecto de @ref PSD_SPEC_U8. */
+#define PSD_SPEC_I16_STEP_DB  0.01     /**< Paso por defecto de @ref PSD_SPEC_I16. */
+
+/**
+ * @brief Filas del espectrograma y buffers de codificación (reutilizables entre requests).
+ */
+typedef struct {
+    psd_spectrogram_cfg_t cfg; /**< Request (entrada; la fija el llamador antes del estimador). */
+
+    int seg_per_row;  /**< K efectivo (>= cfg.segments si hubo que agrupar más por @ref PSD_SPEC_MAX_CELLS). */
+    int n_rows;       /**< Filas válidas (0 = sin espectrograma). */
+    int n_bins;       /**< Bins por fila tras recorte/pooling. */
+    int row_stride;   /**< Doubles entre filas consecutivas de @ref rows (nperseg). */
+    double dt_s;      /**< Periodo entre filas (s). */
+    double *rows;     /**< Filas en dBm; la fila r empieza en `rows + r * row_stride`. */
+    size_t rows_cap;  /**< Capacidad de @ref rows (doubles). */
+
+    uint8_t *q;       /**< Filas cuantizadas y diferenciadas. */
+    size_t q_cap;     /**< Capacidad de @ref q. */
+    uint8_t *enc;     /**< Salida PackBits. */
+    size_t enc_cap;   /**< Capacidad de @ref enc. */
+    char *b64;        /**< Salida base64 (terminada en NUL). */
+    size_t b64_cap;   /**< Capacidad de @ref b64. */
+} psd_spectrogram_t;
+
+/**
+ * @brief Fija K y el número de filas para una captura y reserva las filas.
+ * @details La invocan los estimadores antes de su región paralela. K parte de `cfg.segments`
+ * y crece lo necesario para no superar `cfg.max_rows` ni @ref PSD_SPEC_MAX_CELLS.
+ * @param s Espectrograma (con `cfg` fijado).
+ * @param n_units Segmentos o bloques de la captura.
+ * @param nfft Tamaño de la FFT.
+ * @param hop Muestras entre segmentos consecutivos.
+ * @param fs Tasa de la señal del estimador (Hz).
+ * @return 0 en éxito, -1 si no hay segmentos o falla la reserva (queda `n_rows = 0`).
+ */
+int psd_spectrogram_plan(psd_spectrogram_t *s, int n_units, int nfft, int hop, double fs);
+
+/**
+ * @brief Tamaño de lote de FFTs que no cruza el límite entre filas.
+ * @details Con K menor que @p batch usa K; con K mayor reparte cada fila en lotes iguales,
+ * de modo que el último lote de la fila no transforme segmentos ociosos.
+ * @param batch Lote preferido (@ref fft_wisdom_batch_size).
+ * @param seg_per_row K.
+ * @return Lote a usar (>= 1).
+ */
+int psd_spectrogram_batch(int batch, int seg_per_row);
+
+/**
+ * @brief Agrega el objeto `"spectrogram"` a @p parent.
+ * @details Claves `rows`, `bins`, `segments_per_row`, `dt_s`, `t_s` (inicio de cada fila, s),
+ * `format` (`"u8"` / `"i16"`), `encoding` (`"delta_packbits"`), `q_offset_db`, `q_scale_db`
+ * y `data` (base64). Cada valor se reconstruye como `q_offset_db + q * q_scale_db`.
+ * @param parent Objeto JSON destino.
+ * @param s Espectrograma con filas válidas.
+ * @return 0 en éxito, -1 si no hay filas o falla la reserva.
+ */
+int psd_spectrogram_add_json(cJSON *parent, psd_spectrogram_t *s);
+
+/**
+ * @brief Libera las filas y los buffers de codificación.
+ * @param s Espectrograma.
+ */
+void psd_spectrogram_free(psd_spectrogram_t *s);
+
+/** @} */
+
+#endif
@@ -0,0 +1,211 @@
+/**
+ * @file rf_affinity.c
+ * @brief Implementación de la ubicación de hilos de rf_app.
+ */
+#define _GNU_SOURCE
+#include "rf_affinity.h"
+#include "utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <omp.h>
+
+/**
+ * @addtogroup rf_affinity_module
+ * @{
+ */
+
+static int env_int(const char *key, int fallback) {
+    char *v = getenv_c(key);
+    if (!v) return fallback;
+    char *end = NULL;
+    long n = strtol(v, &end, 10);
+    int ok = (end != v);
+    free(v);
+    return ok ? (int)n : fallback;
+}
+
+static int online_cpus(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1) return 1;
+    return (n > RF_AFFINITY_MAX_CPUS) ? RF_AFFINITY_MAX_CPUS : (int)n;
+}
+
+static int add_cpu(int *out, int n, int max, int cpu) {
+    for (int i = 0; i < n; i++) {
+        if (out[i] == cpu) return n;
+    }
+    if (n < max) out[n++] = cpu;
+    return n;
+}
+
+int rf_affinity_parse_cpus(const char *s, int *out, int max) {
+    if (!s || !out || max <= 0) return -1;
+
+    int n = 0;
+    const char *p = s;
+    while (*p) {
+        while (*p == ' ' || *p == ',') p++;
+        if (!*p) break;
+
+        char *end = NULL;
+        long lo = strtol(p, &end, 10);
+        if (end == p || lo < 0) return -1;
+        long hi = lo;
+        p = end;
+        if (*p == '-') {
+            p++;
+            hi = strtol(p, &end, 10);
+            if (end == p || hi < lo) return -1;
+            p = end;
+        }
+        if (*p && *p != ',' && *p != ' ') return -1;
+        for (long c = lo; c <= hi && c < CPU_SETSIZE; c++) n = add_cpu(out, n, max, (int)c);
+    }
+    return n;
+}
+
+void rf_affinity_load(rf_affinity_cfg_t *cfg) {
+    if (!cfg) return;
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->io_cpu = -1;
+
+    char *cpus = getenv_c("RF_PSD_CPUS");
+    if (cpus) {
+        int n = rf_affinity_parse_cpus(cpus, cfg->psd_cpus, RF_AFFINITY_MAX_CPUS);
+        if (n < 0) {
+            fprintf(stderr, "[RF] Warning: Invalid RF_PSD_CPUS '%s', worker pinning disabled.\n", cpus);
+            n = 0;
+        }
+        cfg->n_psd_cpus = n;
+        free(cpus);
+    }
+
+    const int n_online = online_cpus();
+    cfg->io_cpu = env_int("RF_IO_CPU", -1);
+    if (cfg->io_cpu >= n_online) {
+        fprintf(stderr, "[RF] Warning: RF_IO_CPU=%d not online (%d CPUs), ignored.\n", cfg->io_cpu, n_online);
+        cfg->io_cpu = -1;
+    }
+
+    // A reserved I/O core without an explicit list leaves the remaining cores to the team
+    if (cfg->io_cpu >= 0 && cfg->n_psd_cpus == 0) {
+        for (int c = 0; c < n_online; c++) {
+            if (c != cfg->io_cpu) cfg->n_psd_cpus = add_cpu(cfg->psd_cpus, cfg->n_psd_cpus, RF_AFFINITY_MAX_CPUS, c);
+        }
+    }
+    for (int i = 0; i < cfg->n_psd_cpus; i++) {
+        if (cfg->psd_cpus[i] == cfg->io_cpu) {
+            fprintf(stderr, "[RF] Warning: RF_IO_CPU=%d is also in RF_PSD_CPUS; the core is shared.\n", cfg->io_cpu);
+            break;
+        }
+    }
+
+    cfg->psd_threads = env_int("RF_PSD_THREADS", cfg->n_psd_cpus > 0 ? cfg->n_psd_cpus : RF_AFFINITY_DEFAULT_THREADS);
+    if (cfg->psd_threads < 1) cfg->psd_threads = 1;
+
+    cfg->io_fifo_prio = env_int("RF_IO_FIFO_PRIO", 0);
+    if (cfg->io_fifo_prio < 0) cfg->io_fifo_prio = 0;
+    if (cfg->io_fifo_prio > 0) {
+        const int pmin = sched_get_priority_min(SCHED_FIFO);
+        const int pmax = sched_get_priority_max(SCHED_FIFO);
+        if (cfg->io_fifo_prio < pmin) cfg->io_fifo_prio = pmin;
+        if (cfg->io_fifo_prio > pmax) cfg->io_fifo_prio = pmax;
+    }
+}
+
+int rf_affinity_apply_psd(const rf_affinity_cfg_t *cfg) {
+    if (!cfg) return -1;
+
+    omp_set_dynamic(0);
+    omp_set_num_threads(cfg->psd_threads);
+    if (cfg->n_psd_cpus <= 0) return 0;
+
+    const int *cpus = cfg->psd_cpus;
+    const int n_cpus = cfg->n_psd_cpus;
+    int failures = 0;
+
+    #pragma omp parallel reduction(+:failures)
+    {
+        const int tid = omp_get_thread_num();
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (tid == 0) {
+            // The master keeps the whole team set: threads it creates later inherit it
+            for (int i = 0; i < n_cpus; i++) CPU_SET(cpus[i], &set);
+        } else {
+            CPU_SET(cpus[tid % n_cpus], &set);
+        }
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) failures++;
+    }
+
+    if (failures > 0) {
+        fprintf(stderr, "[RF] Warning: %d OpenMP worker(s) could not be pinned.\n", failures);
+        return -1;
+    }
+    return 0;
+}
+
+void rf_affinity_split(const rf_affinity_cfg_t *all, int slot, int n_slots, rf_affinity_cfg_t *out) {
+    if (!all || !out) return;
+    const rf_affinity_cfg_t src = *all;
+    *out = src;
+    if (n_slots <= 1 || slot < 0 || slot >= n_slots) return;
+
+    out->psd_threads = (src.psd_threads + slot) / n_slots;
+    if (out->psd_threads < 1) out->psd_threads = 1;
+    if (src.n_psd_cpus <= 0) return;
+
+    const int lo = (src.n_psd_cpus * slot) / n_slots;
+    const int hi = (src.n_psd_cpus * (slot + 1)) / n_slots;
+    out->n_psd_cpus = 0;
+    if (hi > lo) {
+        for (int i = lo; i < hi; i++) out->psd_cpus[out->n_psd_cpus++] = src.psd_cpus[i];
+    } else {
+        out->psd_cpus[out->n_psd_cpus++] = src.psd_cpus[slot % src.n_psd_cpus];
+    }
+}
+
+int rf_affinity_apply_io_thread(const rf_affinity_cfg_t *cfg) {
+    if (!cfg) return -1;
+    int rc = 0;
+
+    if (cfg->io_cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cfg->io_cpu, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) rc = -1;
+    }
+    if (cfg->io_fifo_prio > 0) {
+        struct sched_param sp;
+        memset(&sp, 0, sizeof(sp));
+        sp.sched_priority = cfg->io_fifo_prio;
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) != 0) rc = -1;
+    }
+    return rc;
+}
+
+void rf_affinity_log(const rf_affinity_cfg_t *cfg) {
+    if (!cfg) return;
+
+    char list[256] = "any";
+    if (cfg->n_psd_cpus > 0) {
+        size_t off = 0;
+        list[0] = '\0';
+        for (int i = 0; i < cfg->n_psd_cpus && off < sizeof(list) - 8; i++) {
+            off += (size_t)snprintf(list + off, sizeof(list) - off, "%s%d", i ? "," : "", cfg->psd_cpus[i]);
+        }
+    }
+    char io[32] = "unpinned";
+    if (cfg->io_cpu >= 0) snprintf(io, sizeof(io), "cpu %d", cfg->io_cpu);
+
+    printf("[RF] Threads | PSD team: %d on [%s] | I/O (USB + audio): %s, %s\n",
+           cfg->psd_threads, list, io, cfg->io_fifo_prio > 0 ? "SCHED_FIFO" : "SCHED_OTHER");
+}
+
+/** @} */
@@ -0,0 +1,103 @@
+/**
+ * @file rf_affinity.h
+ * @brief Tamaño del equipo OpenMP, afinidad de CPU y prioridad de los hilos de rf_app.
+ *
+ * En la Raspberry Pi los cuatro núcleos se reparten entre el pool OpenMP (PSD, compensación IQ,
+ * filtro de canal), el hilo USB de libhackrf que ejecuta `rx_callback`, el hilo de audio y
+ * gps-lte. Este módulo permite dejar un núcleo reservado para la ruta de E/S (callback USB +
+ * audio), fijar cada worker OpenMP a su núcleo y, opcionalmente, dar SCHED_FIFO a la ruta de
+ * E/S para que los workers no la desalojen (escrituras parciales en `rb_write`).
+ *
+ * Variables del `.env` (todas opcionales):
+ *   - `RF_PSD_THREADS`: hilos del equipo OpenMP (default 3, o el número de `RF_PSD_CPUS`).
+ *   - `RF_PSD_CPUS`: núcleos del equipo, p. ej. `0-2` o `0,1,2` (worker i → núcleo i mod N).
+ *   - `RF_IO_CPU`: núcleo reservado para el callback USB y el hilo de audio (-1 = sin fijar).
+ *     Si se define sin `RF_PSD_CPUS`, el equipo usa los núcleos restantes.
+ *   - `RF_IO_FIFO_PRIO`: prioridad SCHED_FIFO (1-99) de la ruta de E/S; 0 = SCHED_OTHER.
+ *     Requiere CAP_SYS_NICE; si falla se registra un aviso y se sigue sin tiempo real.
+ *
+ * Con varios HackRF cada motor tiene su propio equipo OpenMP: @ref rf_affinity_split reparte
+ * entre ellos los hilos y los núcleos del equipo configurado.
+ */
+
+#ifndef RF_AFFINITY_H
+#define RF_AFFINITY_H
+
+#include <stdbool.h>
+
+/**
+ * @defgroup rf_affinity_module RF Affinity
+ * @ingroup rf_binary
+ * @brief Ubicación de hilos: pool PSD y núcleo de E/S.
+ * @{
+ */
+
+#define RF_AFFINITY_MAX_CPUS 64        /**< Máximo de núcleos listados en `RF_PSD_CPUS`. */
+#define RF_AFFINITY_DEFAULT_THREADS 3  /**< Equipo OpenMP por defecto (Pi de 4 núcleos menos uno). */
+
+/**
+ * @brief Configuración de ubicación de hilos.
+ */
+typedef struct {
+    int psd_threads;                    /**< Hilos del equipo OpenMP. */
+    int psd_cpus[RF_AFFINITY_MAX_CPUS]; /**< Núcleos del equipo (vacío = sin fijar). */
+    int n_psd_cpus;                     /**< Entradas válidas de @ref psd_cpus. */
+    int io_cpu;                         /**< Núcleo de la ruta de E/S, -1 = sin fijar. */
+    int io_fifo_prio;                   /**< Prioridad SCHED_FIFO de la ruta de E/S, 0 = desactivado. */
+} rf_affinity_cfg_t;
+
+/**
+ * @brief Lee la configuración desde el `.env` y completa los valores derivados.
+ * @param[out] cfg Configuración resultante.
+ */
+void rf_affinity_load(rf_affinity_cfg_t *cfg);
+
+/**
+ * @brief Parsea una lista de núcleos (`"0-2"`, `"0,2,3"`, `"1,3-5"`).
+ * @param s Cadena de entrada.
+ * @param[out] out Núcleos parseados (sin duplicados, en orden de aparición).
+ * @param max Capacidad de @p out.
+ * @return Número de núcleos, o -1 si la cadena es inválida.
+ */
+int rf_affinity_parse_cpus(const char *s, int *out, int max);
+
+/**
+ * @brief Fija el tamaño del equipo OpenMP y, si hay núcleos configurados, fija cada worker.
+ * @details Abre una región paralela en la que cada worker se fija a `psd_cpus[tid % N]`; el hilo
+ * maestro queda en el conjunto completo para que los hilos que cree después lo hereden. El pool
+ * de libgomp reutiliza esos hilos en las regiones siguientes. Llamar una vez al arrancar, antes de
+ * cualquier región paralela.
+ * @param cfg Configuración.
+ * @return 0 en éxito, -1 si falló alguna afinidad (el equipo sigue funcionando).
+ */
+int rf_affinity_apply_psd(const rf_affinity_cfg_t *cfg);
+
+/**
+ * @brief Parte del equipo PSD que corresponde a un motor cuando rf_app maneja varios radios.
+ * @details Los hilos y los núcleos se reparten en tramos contiguos casi iguales (el motor k
+ * recibe \f$ \lfloor (T + k) / n \rfloor \f$ de T hilos, al menos 1). Si hay menos núcleos que
+ * motores, el motor k comparte `psd_cpus[k mod N]`. La ruta de E/S no cambia.
+ * @param all Configuración completa (`.env`).
+ * @param slot Índice del motor (0..n_slots-1).
+ * @param n_slots Motores en el proceso (1 = copia sin cambios).
+ * @param[out] out Configuración del motor (puede ser @p all).
+ */
+void rf_affinity_split(const rf_affinity_cfg_t *all, int slot, int n_slots, rf_affinity_cfg_t *out);
+
+/**
+ * @brief Aplica al hilo llamador el núcleo y la prioridad de la ruta de E/S.
+ * @details No reserva memoria ni escribe logs: es seguro llamarlo desde `rx_callback`.
+ * @param cfg Configuración.
+ * @return 0 si se aplicó todo lo pedido (o no había nada que aplicar), -1 si alguna llamada falló.
+ */
+int rf_affinity_apply_io_thread(const rf_affinity_cfg_t *cfg);
+
+/**
+ * @brief Imprime la configuración efectiva (una línea).
+ * @param cfg Configuración.
+ */
+void rf_affinity_log(const rf_affinity_cfg_t *cfg);
+
+/** @} */
+
+#endif
@@ -0,0 +1,116 @@
+/**
+ * @file rf_metrics.c
+ * @brief Implementación de la instrumentación por etapa del procesamiento RF.
+ */
+#include "rf_metrics.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @addtogroup rf_metrics_module
+ * @{
+ */
+
+static const char *const k_stage_names[RF_STAGE_COUNT] = {
+    "acq_wait", "rb_read", "iq_load", "iq_comp", "filter", "psd", "serialize"
+};
+
+void rf_metrics_begin(rf_req_metrics_t *m) {
+    if (!m) return;
+    memset(m, 0, sizeof(*m));
+    m->start_ns = rf_metrics_now_ns();
+}
+
+void rf_metrics_end(rf_req_metrics_t *m) {
+    if (m) m->end_ns = rf_metrics_now_ns();
+}
+
+double rf_metrics_elapsed_ms(const rf_req_metrics_t *m) {
+    if (!m || m->start_ns == 0) return 0.0;
+    const uint64_t end = m->end_ns ? m->end_ns : rf_metrics_now_ns();
+    return (double)(end - m->start_ns) * 1e-6;
+}
+
+void rf_metrics_commit(rf_metrics_totals_t *tot, const rf_req_metrics_t *m) {
+    if (!tot || !m) return;
+
+    for (int s = 0; s < RF_STAGE_COUNT; s++) {
+        const double v = m->stage_ms[s];
+        if (v <= 0.0) continue;
+        tot->count[s]++;
+        tot->total_ms[s] += v;
+        if (v > tot->max_ms[s]) tot->max_ms[s] = v;
+    }
+
+    const double req_ms = rf_metrics_elapsed_ms(m);
+    tot->requests++;
+    tot->samples += m->samples;
+    tot->total_req_ms += req_ms;
+    if (req_ms > tot->max_req_ms) tot->max_req_ms = req_ms;
+    if (m->cfg_cache_hit) tot->cfg_cache_hits++;
+    else                  tot->cfg_cache_misses++;
+}
+
+const char *rf_metrics_stage_name(rf_stage_t stage) {
+    if ((int)stage < 0 || stage >= RF_STAGE_COUNT) return "unknown";
+    return k_stage_names[stage];
+}
+
+int rf_metrics_add_request_json(cJSON *parent, const rf_req_metrics_t *m) {
+    if (!parent || !m) return -1;
+
+    cJSON *obj = cJSON_CreateObject();
+    if (!obj) return -1;
+
+    char key[32];
+    double dsp_ms = 0.0;
+    for (int s = 0; s < RF_STAGE_COUNT; s++) {
+        snprintf(key, sizeof(key), "%s_ms", rf_metrics_stage_name((rf_stage_t)s));
+        cJSON_AddNumberToObject(obj, key, m->stage_ms[s]);
+        if (s >= RF_STAGE_IQ_LOAD && s <= RF_STAGE_PSD) dsp_ms += m->stage_ms[s];
+    }
+
+    cJSON_AddNumberToObject(obj, "total_ms", rf_metrics_elapsed_ms(m));
+    cJSON_AddNumberToObject(obj, "samples", (double)m->samples);
+    // Throughput of the DSP chain alone (load..PSD), in MS/s
+    cJSON_AddNumberToObject(obj, "msps", (dsp_ms > 0.0) ? (double)m->samples / (dsp_ms * 1e3) : 0.0);
+    cJSON_AddNumberToObject(obj, "rb_dropped_bytes", (double)m->rb_dropped_bytes);
+    cJSON_AddBoolToObject(obj, "config_cache_hit", m->cfg_cache_hit);
+
+    cJSON_AddItemToObject(parent, "metrics", obj);
+    return 0;
+}
+
+cJSON *rf_metrics_totals_json(const rf_metrics_totals_t *tot) {
+    if (!tot) return NULL;
+
+    cJSON *obj = cJSON_CreateObject();
+    if (!obj) return NULL;
+
+    cJSON_AddNumberToObject(obj, "requests", (double)tot->requests);
+    cJSON_AddNumberToObject(obj, "samples", (double)tot->samples);
+    cJSON_AddNumberToObject(obj, "avg_request_ms",
+                            tot->requests ? tot->total_req_ms / (double)tot->requests : 0.0);
+    cJSON_AddNumberToObject(obj, "max_request_ms", tot->max_req_ms);
+    cJSON_AddNumberToObject(obj, "config_cache_hits", (double)tot->cfg_cache_hits);
+    cJSON_AddNumberToObject(obj, "config_cache_misses", (double)tot->cfg_cache_misses);
+
+    cJSON *stages = cJSON_AddObjectToObject(obj, "stages");
+    if (!stages) {
+        cJSON_Delete(obj);
+        return NULL;
+    }
+
+    for (int s = 0; s < RF_STAGE_COUNT; s++) {
+        cJSON *st = cJSON_AddObjectToObject(stages, rf_metrics_stage_name((rf_stage_t)s));
+        if (!st) continue;
+        cJSON_AddNumberToObject(st, "count", (double)tot->count[s]);
+        cJSON_AddNumberToObject(st, "avg_ms", tot->count[s] ? tot->total_ms[s] / (double)tot->count[s] : 0.0);
+        cJSON_AddNumberToObject(st, "max_ms", tot->max_ms[s]);
+        cJSON_AddNumberToObject(st, "total_ms", tot->total_ms[s]);
+    }
+    return obj;
+}
+
+/** @} */
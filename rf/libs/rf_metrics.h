@@ -0,0 +1,145 @@
+/**
+ * @file rf_metrics.h
+ * @brief Temporizadores monotónicos y contadores por etapa del procesamiento de un request.
+ *
+ * Cada request PSD se descompone en etapas (espera de adquisición, lectura del ring
+ * buffer, carga IQ, compensación, filtrado, PSD y serialización). El bucle principal
+ * mide cada etapa con @ref rf_metrics_lap y acumula los totales con @ref rf_metrics_commit.
+ * Los resultados se exponen en el objeto `"metrics"` del reply JSON (request con
+ * `"metrics": true`) o con un request `{"stats": true}`.
+ *
+ * El módulo no es thread-safe: los acumuladores pertenecen al hilo principal. Los contadores
+ * del callback USB y del hilo de audio son atómicos y viven en sus propios módulos.
+ */
+
+#ifndef RF_METRICS_H
+#define RF_METRICS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <cjson/cJSON.h>
+
+/**
+ * @defgroup rf_metrics_module RF Metrics
+ * @ingroup rf_binary
+ * @brief Instrumentación ligera de latencia y throughput por etapa.
+ * @{
+ */
+
+/**
+ * @brief Etapas instrumentadas de un request PSD.
+ */
+typedef enum {
+    RF_STAGE_ACQ_WAIT = 0, /**< Espera hasta tener la captura completa en el ring buffer. */
+    RF_STAGE_RB_READ,      /**< Peek + commit de la captura en el ring buffer. */
+    RF_STAGE_IQ_LOAD,      /**< Conversión int8 → complejo (con momentos IQ). */
+    RF_STAGE_IQ_COMP,      /**< Compensación DC / desbalance IQ. */
+    RF_STAGE_FILTER,       /**< Filtro de canal (solo si está habilitado). */
+    RF_STAGE_PSD,          /**< Estimador Welch o PFB. */
+    RF_STAGE_SERIALIZE,    /**< Construcción y envío del reply. */
+    RF_STAGE_COUNT
+} rf_stage_t;
+
+/**
+ * @brief Tiempos de un request individual.
+ */
+typedef struct {
+    double stage_ms[RF_STAGE_COUNT]; /**< Milisegundos por etapa (0 si no se ejecutó). */
+    uint64_t start_ns;               /**< Instante de inicio del request (monotónico). */
+    uint64_t end_ns;                 /**< Instante de fin fijado con @ref rf_metrics_end (0 = en curso). */
+    size_t samples;                  /**< Muestras IQ procesadas. */
+    size_t rb_dropped_bytes;         /**< Bytes descartados por el ring buffer durante el request. */
+    bool cfg_cache_hit;              /**< La configuración derivada salió de la caché de huellas. */
+} rf_req_metrics_t;
+
+/**
+ * @brief Acumulados desde el arranque (o el último reset).
+ */
+typedef struct {
+    uint64_t requests;                /**< Requests completados. */
+    uint64_t samples;                 /**< Muestras IQ procesadas en total. */
+    uint64_t count[RF_STAGE_COUNT];   /**< Ejecuciones de cada etapa. */
+    double total_ms[RF_STAGE_COUNT];  /**< Tiempo total por etapa. */
+    double max_ms[RF_STAGE_COUNT];    /**< Peor caso por etapa. */
+    double total_req_ms;              /**< Tiempo total de requests. */
+    double max_req_ms;                /**< Peor request. */
+    uint64_t cfg_cache_hits;          /**< Requests que reutilizaron la configuración derivada. */
+    uint64_t cfg_cache_misses;        /**< Requests que recalcularon la configuración. */
+} rf_metrics_totals_t;
+
+/**
+ * @brief Reloj monotónico en nanosegundos.
+ */
+static inline uint64_t rf_metrics_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Suma a @p stage el tiempo transcurrido desde @p *t y reinicia @p *t al instante actual.
+ * @param m Métricas del request (NULL = sin efecto salvo avanzar @p t).
+ * @param stage Etapa a la que se imputa el intervalo.
+ * @param[in,out] t Marca de tiempo del inicio del intervalo.
+ */
+static inline void rf_metrics_lap(rf_req_metrics_t *m, rf_stage_t stage, uint64_t *t) {
+    const uint64_t now = rf_metrics_now_ns();
+    if (m) m->stage_ms[stage] += (double)(now - *t) * 1e-6;
+    *t = now;
+}
+
+/**
+ * @brief Reinicia las métricas de un request y fija su instante de inicio.
+ * @param m Métricas del request.
+ */
+void rf_metrics_begin(rf_req_metrics_t *m);
+
+/**
+ * @brief Congela el tiempo total del request (cuando se acumula más tarde, p. ej. en otro hilo).
+ * @param m Métricas del request.
+ */
+void rf_metrics_end(rf_req_metrics_t *m);
+
+/**
+ * @brief Tiempo total del request hasta ahora, o hasta @ref rf_metrics_end si ya terminó (ms).
+ * @param m Métricas del request.
+ */
+double rf_metrics_elapsed_ms(const rf_req_metrics_t *m);
+
+/**
+ * @brief Acumula un request en los totales.
+ * @param tot Acumulados.
+ * @param m Métricas del request terminado.
+ */
+void rf_metrics_commit(rf_metrics_totals_t *tot, const rf_req_metrics_t *m);
+
+/**
+ * @brief Nombre estable de la etapa (clave JSON).
+ * @param stage Etapa.
+ * @return Cadena estática, p. ej. "acq_wait".
+ */
+const char *rf_metrics_stage_name(rf_stage_t stage);
+
+/**
+ * @brief Agrega el objeto `"metrics"` de un request a @p parent.
+ * @details Claves `<etapa>_ms`, `total_ms`, `samples`, `msps` (sobre las etapas DSP),
+ * `rb_dropped_bytes` y `config_cache_hit`.
+ * @param parent Objeto JSON destino.
+ * @param m Métricas del request.
+ * @return 0 en éxito, -1 si falla la reserva.
+ */
+int rf_metrics_add_request_json(cJSON *parent, const rf_req_metrics_t *m);
+
+/**
+ * @brief Crea el objeto JSON de acumulados: por etapa `count`, `avg_ms`, `max_ms`, `total_ms`,
+ * más `config_cache_hits` / `config_cache_misses`.
+ * @param tot Acumulados.
+ * @return Objeto cJSON (el llamador lo libera o lo adjunta), NULL si falla la reserva.
+ */
+cJSON *rf_metrics_totals_json(const rf_metrics_totals_t *tot);
+
+/** @} */
+
+#endif
@@ -2,8 +2,16 @@
  * @file ring_buffer.c
  * @brief Lógica de gestión de memoria y sincronización del búfer circular.
  */
+#define _GNU_SOURCE
 #include "ring_buffer.h"
 
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+
 /**
  * @addtogroup rb_module
  * @{
@@ -11,21 +19,99 @@
 
 /* * Nota de implementación:
  * Esta implementación utiliza índices incrementales (head/tail) y aplica 
- * la operación módulo (%) sobre el tamaño del búfer para determinar el 
+ * una máscara (size - 1, con size potencia de dos) para determinar el 
  * índice real del arreglo. Esto permite diferenciar entre un búfer 
  * completamente vacío y uno completamente lleno.
  */
 
+/**
+ * @internal
+ * Menor potencia de dos >= @p n (n > 0).
+ */
+static size_t rb_round_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+/**
+ * @internal
+ * Inicializa los contadores y el estado de despertar por umbral (común a ambos modos de memoria).
+ */
+static void rb_init_wakeup(ring_buffer_t *rb) {
+    atomic_init(&rb->dropped, 0);
+    atomic_init(&rb->wake_threshold, 0);
+    rb->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+}
+
 void rb_init(ring_buffer_t *rb, size_t size) {
+    size = rb_round_pow2(size ? size : 1);
     // USE CALLOC: Allocates memory and automatically sets it to 0
     rb->buffer = calloc(1, size); 
     rb->size = size;
+    rb->mask = size - 1;
+    rb->mirrored = 0;
+    atomic_init(&rb->head, 0);
+    atomic_init(&rb->tail, 0);
+    rb_init_wakeup(rb);
+}
+
+int rb_init_mirrored(ring_buffer_t *rb, size_t size) {
+#ifdef MFD_CLOEXEC
+    const long page = sysconf(_SC_PAGESIZE);
+    if (page <= 0 || size == 0) return -1;
+    size = ((size + (size_t)page - 1) / (size_t)page) * (size_t)page;
+    size = rb_round_pow2(size); // pages are a power of two: still page-aligned
+
+    int fd = memfd_create("rf_ring_buffer", MFD_CLOEXEC);
+    if (fd < 0) return -1;
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    // Reserve 2x address space, then map the same pages into both halves
+    uint8_t *base = mmap(NULL, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+
+    if (mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+        mmap(base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, 2 * size);
+        close(fd);
+        return -1;
+    }
+    close(fd);
+
+    // memfd pages start zeroed, same as calloc in rb_init
+    rb->buffer = base;
+    rb->size = size;
+    rb->mask = size - 1;
+    rb->mirrored = 1;
     atomic_init(&rb->head, 0);
     atomic_init(&rb->tail, 0);
+    rb_init_wakeup(rb);
+    return 0;
+#else
+    (void)rb;
+    (void)size;
+    return -1;
+#endif
 }
 
 void rb_free(ring_buffer_t *rb) {
-    if (rb->buffer) {
+    if (rb->wake_fd >= 0) {
+        close(rb->wake_fd);
+        rb->wake_fd = -1;
+    }
+    if (rb->buffer && rb->mirrored) {
+        memset(rb->buffer, 0, rb->size);
+        munmap(rb->buffer, 2 * rb->size);
+        rb->buffer = NULL;
+        rb->mirrored = 0;
+    } else if (rb->buffer) {
         // REQUESTED: Put to 0 (Secure Erase) before freeing
         memset(rb->buffer, 0, rb->size); 
         free(rb->buffer);
@@ -59,19 +145,37 @@ size_t rb_write(ring_buffer_t *rb, const void *data, size_t len) {
     size_t space_free = rb->size - (head - tail);
     size_t to_write = MIN(len, space_free);
 
+    if (to_write < len) {
+        atomic_fetch_add_explicit(&rb->dropped, len - to_write, memory_order_relaxed);
+    }
     if (to_write == 0) {
         return 0;
     }
 
-    // Circular logic using modulo
-    size_t head_idx = head % rb->size;
-    size_t chunk1 = MIN(to_write, rb->size - head_idx);
+    // Circular logic using modulo (the mirror makes any span contiguous)
+    size_t head_idx = head & rb->mask;
+    size_t chunk1 = rb->mirrored ? to_write : MIN(to_write, rb->size - head_idx);
     size_t chunk2 = to_write - chunk1;
 
     memcpy(rb->buffer + head_idx, data, chunk1);
     if (chunk2 > 0) memcpy(rb->buffer, (uint8_t*)data + chunk1, chunk2);
 
     atomic_store_explicit(&rb->head, head + to_write, memory_order_release);
+
+    /*
+     * Threshold wakeup: seq_cst pairs with the consumer's threshold store + head
+     * re-check, so either it sees the new head or we see its threshold.
+     */
+    atomic_thread_fence(memory_order_seq_cst);
+    size_t thr = atomic_load_explicit(&rb->wake_threshold, memory_order_relaxed);
+    if (thr != 0 && head + to_write - tail >= thr) {
+        // Only the writer that clears the threshold signals (one syscall per wait)
+        if (atomic_compare_exchange_strong(&rb->wake_threshold, &thr, 0) && rb->wake_fd >= 0) {
+            const uint64_t one = 1;
+            ssize_t wr = write(rb->wake_fd, &one, sizeof(one));
+            (void)wr;
+        }
+    }
     return to_write;
 }
 
@@ -90,8 +194,8 @@ size_t rb_read(ring_buffer_t *rb, void *data, size_t len) {
         return 0;
     }
 
-    size_t tail_idx = tail % rb->size;
-    size_t chunk1 = MIN(to_read, rb->size - tail_idx);
+    size_t tail_idx = tail & rb->mask;
+    size_t chunk1 = rb->mirrored ? to_read : MIN(to_read, rb->size - tail_idx);
     size_t chunk2 = to_read - chunk1;
 
     memcpy(data, rb->buffer + tail_idx, chunk1);
@@ -101,10 +205,100 @@ size_t rb_read(ring_buffer_t *rb, void *data, size_t len) {
     return to_read;
 }
 
+size_t rb_peek_regions(ring_buffer_t *rb, size_t len, rb_regions_t *out) {
+    if (!out) return 0;
+    memset(out, 0, sizeof(*out));
+
+    const size_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+    const size_t head = atomic_load_explicit(&rb->head, memory_order_acquire);
+    size_t to_peek = MIN(len, head - tail);
+    if (to_peek == 0) {
+        return 0;
+    }
+
+    size_t tail_idx = tail & rb->mask;
+    size_t chunk1 = rb->mirrored ? to_peek : MIN(to_peek, rb->size - tail_idx);
+
+    out->ptr[0] = rb->buffer + tail_idx;
+    out->len[0] = chunk1;
+    if (to_peek > chunk1) {
+        out->ptr[1] = rb->buffer;
+        out->len[1] = to_peek - chunk1;
+    }
+    return to_peek;
+}
+
+void rb_commit_read(ring_buffer_t *rb, size_t len) {
+    const size_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+    const size_t head = atomic_load_explicit(&rb->head, memory_order_acquire);
+    size_t to_commit = MIN(len, head - tail);
+    atomic_store_explicit(&rb->tail, tail + to_commit, memory_order_release);
+}
+
 size_t rb_available(ring_buffer_t *rb) {
     const size_t head = atomic_load_explicit(&rb->head, memory_order_acquire);
     const size_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
     return head - tail;
 }
 
+size_t rb_dropped(ring_buffer_t *rb) {
+    return atomic_load_explicit(&rb->dropped, memory_order_relaxed);
+}
+
+static int64_t rb_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+int rb_wait_available(ring_buffer_t *rb, size_t need, int timeout_ms) {
+    if (need > rb->size) need = rb->size;
+    if (rb_available(rb) >= need) return 1;
+
+    if (rb->wake_fd < 0) {
+        // No eventfd: degrade to short sleeps
+        const int64_t deadline = rb_now_ms() + timeout_ms;
+        while (rb_available(rb) < need && rb_now_ms() < deadline) usleep(2000);
+        return rb_available(rb) >= need;
+    }
+
+    const int64_t deadline = rb_now_ms() + timeout_ms;
+    for (;;) {
+        atomic_store_explicit(&rb->wake_threshold, need, memory_order_seq_cst);
+        atomic_thread_fence(memory_order_seq_cst);
+
+        // Re-check after publishing the threshold so a concurrent write is not missed
+        if (rb_available(rb) >= need) break;
+
+        int64_t left = deadline - rb_now_ms();
+        if (left <= 0) break;
+
+        struct pollfd pfd = { .fd = rb->wake_fd, .events = POLLIN, .revents = 0 };
+        int prc = poll(&pfd, 1, (int)left);
+
+        uint64_t cnt;
+        ssize_t rd = read(rb->wake_fd, &cnt, sizeof(cnt));
+        (void)rd;
+
+        if (prc < 0 && errno != EINTR) break;
+        if (rb_available(rb) >= need) break;
+        if (prc > 0 && atomic_load(&rb->wake_threshold) == 0 && rb_available(rb) < need) {
+            // Woken by rb_wake() or a reset/discard raced the write: let the caller re-evaluate
+            break;
+        }
+    }
+
+    atomic_store_explicit(&rb->wake_threshold, 0, memory_order_relaxed);
+    return rb_available(rb) >= need;
+}
+
+void rb_wake(ring_buffer_t *rb) {
+    atomic_store(&rb->wake_threshold, 0);
+    if (rb->wake_fd >= 0) {
+        const uint64_t one = 1;
+        ssize_t wr = write(rb->wake_fd, &one, sizeof(one));
+        (void)wr;
+    }
+}
+
 /** @} */
@@ -32,18 +32,43 @@
  */
 typedef struct {
     uint8_t *buffer;      /**< Puntero al bloque de memoria principal. */
-    size_t size;          /**< Tamaño total del búfer en bytes. */
+    size_t size;          /**< Tamaño total del búfer en bytes (potencia de dos). */
+    size_t mask;          /**< size - 1: índice físico = posición & mask. */
     atomic_size_t head;   /**< Índice/Posición de escritura acumulada. */
     atomic_size_t tail;   /**< Índice/Posición de lectura acumulada. */
+    int mirrored;         /**< 1 si el búfer está mapeado dos veces de forma contigua (ver @ref rb_init_mirrored). */
+    atomic_size_t wake_threshold; /**< Bytes que espera el consumidor (0 = nadie esperando). */
+    int wake_fd;          /**< eventfd señalado por el productor al cruzar el umbral (-1 si no hay). */
+    atomic_size_t dropped; /**< Bytes acumulados que @ref rb_write no pudo almacenar (búfer lleno). */
 } ring_buffer_t;
 
+/**
+ * @struct rb_regions_t
+ * @brief Hasta dos tramos contiguos de datos pendientes, en orden FIFO.
+ */
+typedef struct {
+    const uint8_t *ptr[2]; /**< Inicio de cada tramo (ptr[1] es NULL si len[1] es 0). */
+    size_t len[2];         /**< Bytes de cada tramo. */
+} rb_regions_t;
+
 /**
  * @brief Inicializa el búfer circular y su mutex.
  * @param rb Puntero a la estructura del búfer.
- * @param size Capacidad deseada en bytes.
+ * @param size Capacidad deseada en bytes (se redondea a la potencia de dos siguiente).
  */
 void rb_init(ring_buffer_t *rb, size_t size);
 
+/**
+ * @brief Inicializa el búfer en modo espejo: la misma memoria se mapea dos veces seguidas.
+ * @details Cualquier lectura o escritura de hasta @p size bytes es contigua a partir de su
+ * índice, por lo que @ref rb_peek_regions siempre devuelve un único tramo. El tamaño se
+ * redondea a la potencia de dos siguiente (múltiplo de página). Requiere Linux (memfd + mmap).
+ * @param rb Puntero a la estructura del búfer.
+ * @param size Capacidad deseada en bytes.
+ * @return 0 en éxito, -1 si el sistema no lo soporta (usar @ref rb_init como respaldo).
+ */
+int rb_init_mirrored(ring_buffer_t *rb, size_t size);
+
 /**
  * @brief Libera la memoria y destruye el mutex.
  * @note Realiza un borrado seguro de los datos (memset a 0) antes de liberar.
@@ -69,6 +94,24 @@ size_t rb_write(ring_buffer_t *rb, const void *data, size_t len);
  */
 size_t rb_read(ring_buffer_t *rb, void *data, size_t len);
 
+/**
+ * @brief Expone sin copiar hasta @p len bytes pendientes de lectura.
+ * @details Los tramos siguen siendo válidos hasta @ref rb_commit_read: el productor solo
+ * escribe en espacio libre y nunca los pisa. Solo debe usarlo el único consumidor.
+ * @param rb Puntero al búfer.
+ * @param len Bytes deseados.
+ * @param[out] out Tramos contiguos (uno en modo espejo o si no hay vuelta del índice).
+ * @return size_t Bytes expuestos (mínimo entre @p len y lo disponible).
+ */
+size_t rb_peek_regions(ring_buffer_t *rb, size_t len, rb_regions_t *out);
+
+/**
+ * @brief Marca como leídos @p len bytes previamente obtenidos con @ref rb_peek_regions.
+ * @param rb Puntero al búfer.
+ * @param len Bytes consumidos (se acota a lo disponible).
+ */
+void rb_commit_read(ring_buffer_t *rb, size_t len);
+
 /**
  * @brief Devuelve la cantidad de bytes disponibles para lectura.
  * @param rb Puntero al búfer.
@@ -76,6 +119,31 @@ size_t rb_read(ring_buffer_t *rb, void *data, size_t len);
  */
 size_t rb_available(ring_buffer_t *rb);
 
+/**
+ * @brief Bytes descartados por @ref rb_write desde la inicialización (contador monótono).
+ * @param rb Puntero al búfer.
+ * @return Total de bytes no almacenados por falta de espacio.
+ */
+size_t rb_dropped(ring_buffer_t *rb);
+
+/**
+ * @brief Bloquea al consumidor hasta que haya al menos @p need bytes o venza el plazo.
+ * @details El consumidor registra el umbral y duerme en un eventfd. @ref rb_write solo
+ * hace la llamada al sistema cuando el umbral se cruza (una vez por espera), sin mutex
+ * ni variables de condición en el camino del productor.
+ * @param rb Puntero al búfer.
+ * @param need Bytes requeridos.
+ * @param timeout_ms Plazo máximo en milisegundos.
+ * @return 1 si hay @p need bytes disponibles, 0 si venció el plazo o hubo @ref rb_wake.
+ */
+int rb_wait_available(ring_buffer_t *rb, size_t need, int timeout_ms);
+
+/**
+ * @brief Despierta a un consumidor bloqueado en @ref rb_wait_available (p. ej. al apagar).
+ * @param rb Puntero al búfer.
+ */
+void rb_wake(ring_buffer_t *rb);
+
 /**
  * @brief Reinicia los índices y limpia el contenido del búfer.
  * @param rb Puntero al búfer.
@@ -0,0 +1,120 @@
+/**
+ * @file rx_timing.c
+ * @brief Implementación de la línea de tiempo de muestras y de la ubicación de capturas.
+ */
+#include "rx_timing.h"
+
+/**
+ * @addtogroup rx_timing_module
+ * @{
+ */
+
+/** Tramas más nuevas que el consumidor no usa: el productor puede estar reescribiéndolas. */
+#define RX_TIMING_GUARD 64
+
+void rx_timing_reset(rx_timing_t *t, double fs) {
+    if (!t) return;
+    atomic_store_explicit(&t->reset_fs, fs, memory_order_relaxed);
+    atomic_fetch_add_explicit(&t->reset_epoch, 1U, memory_order_release);
+}
+
+void rx_timing_stamp(rx_timing_t *t, int64_t now_ns, size_t n_bytes, size_t written, uint64_t rb_head) {
+    if (!t || n_bytes < 2) return;
+
+    const unsigned want = atomic_load_explicit(&t->reset_epoch, memory_order_acquire);
+    if (want != t->epoch) {
+        t->epoch = want;
+        t->fs = atomic_load_explicit(&t->reset_fs, memory_order_relaxed);
+        t->anchored = false;
+    }
+
+    const uint64_t n = (uint64_t)(n_bytes / 2U);
+    const bool timed = t->fs > 0.0;
+    if (!t->anchored) {
+        t->anchor_ns = timed ? now_ns - (int64_t)((double)n * 1e9 / t->fs) : now_ns;
+        t->samples = 0;
+        t->lag_floor = 0.0;
+        t->anchored = true;
+    } else if (timed) {
+        // Samples the radio produced by now vs samples delivered: the excess over the floor is loss
+        const double expected = (double)(now_ns - t->anchor_ns) * 1e-9 * t->fs;
+        const double lag = expected - (double)(t->samples + n);
+        t->lag_floor += (double)n * RX_TIMING_DRIFT_PPM * 1e-6;
+        if (lag < t->lag_floor) t->lag_floor = lag;
+        const double excess = lag - t->lag_floor;
+        if (excess > (double)RX_TIMING_GAP_TRANSFERS * (double)n) {
+            const uint64_t gap = (uint64_t)excess;
+            t->samples += gap;
+            t->dropped += gap;
+            t->lag_floor = lag - (double)gap;
+            atomic_fetch_add_explicit(&t->gaps, gap, memory_order_relaxed);
+        }
+    }
+
+    if (written > 0) {
+        const uint64_t k = atomic_load_explicit(&t->n_stamps, memory_order_relaxed);
+        rx_stamp_t *st = &t->stamps[k & (RX_TIMING_STAMPS - 1U)];
+        st->rb_end = rb_head;
+        st->rb_len = (uint32_t)written;
+        st->epoch = t->epoch;
+        st->sample0 = t->samples;
+        st->dropped = t->dropped;
+        st->fs = t->fs;
+        st->t0_ns = timed ? t->anchor_ns + (int64_t)(((double)t->samples + t->lag_floor) * 1e9 / t->fs) : now_ns;
+        atomic_store_explicit(&t->n_stamps, k + 1U, memory_order_release);
+    }
+
+    // Bytes the ring could not take are lost after this transfer's written part
+    t->dropped += (uint64_t)((n_bytes - written) / 2U);
+    t->samples += n;
+}
+
+/**
+ * @brief Busca hacia atrás (desde la más nueva) la transferencia que contiene @p pos.
+ * @return Índice absoluto de la transferencia, o -1 si no está en la tabla o cambió de época.
+ */
+static int64_t find_stamp(const rx_timing_t *t, uint64_t newest, uint64_t oldest, uint32_t epoch,
+                          uint64_t pos, rx_stamp_t *out) {
+    for (uint64_t k = newest + 1U; k-- > oldest; ) {
+        const rx_stamp_t st = t->stamps[k & (RX_TIMING_STAMPS - 1U)];
+        if (st.epoch != epoch) return -1;
+        if (pos >= st.rb_end) return -1; // newer than every stamp: not written yet
+        if (pos + st.rb_len >= st.rb_end) {
+            *out = st;
+            return (int64_t)k;
+        }
+    }
+    return -1;
+}
+
+int rx_timing_lookup(const rx_timing_t *t, uint64_t rb_pos, size_t n_bytes, rx_capture_meta_t *out) {
+    if (!out) return -1;
+    out->valid = false;
+    if (!t || n_bytes == 0) return -1;
+
+    const uint64_t n = atomic_load_explicit(&t->n_stamps, memory_order_acquire);
+    if (n == 0) return -1;
+    const uint64_t newest = n - 1U;
+    const uint64_t oldest = (n > RX_TIMING_STAMPS - RX_TIMING_GUARD) ? n - (RX_TIMING_STAMPS - RX_TIMING_GUARD) : 0;
+    const uint32_t epoch = t->stamps[newest & (RX_TIMING_STAMPS - 1U)].epoch;
+
+    rx_stamp_t first = {0}, last = {0};
+    const int64_t ka = find_stamp(t, newest, oldest, epoch, rb_pos, &first);
+    const int64_t kb = find_stamp(t, newest, oldest, epoch, rb_pos + n_bytes - 1U, &last);
+    if (ka < 0 || kb < 0) return -1;
+
+    // The producer may have lapped the first stamp while we copied it
+    const uint64_t n2 = atomic_load_explicit(&t->n_stamps, memory_order_acquire);
+    if (n2 - (uint64_t)ka >= RX_TIMING_STAMPS - RX_TIMING_GUARD) return -1;
+
+    const uint64_t into = (rb_pos - (first.rb_end - first.rb_len)) / 2U;
+    out->sample_index = first.sample0 + into;
+    out->t_mono_ns = first.t0_ns + ((first.fs > 0.0) ? (int64_t)((double)into * 1e9 / first.fs) : 0);
+    out->t_utc_ns = 0;
+    out->gps = false;
+    out->dropped = last.dropped - first.dropped;
+    out->valid = true;
+    return 0;
+}
+
+/** @} */
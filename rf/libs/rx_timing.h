@@ -0,0 +1,114 @@
+/**
+ * @file rx_timing.h
+ * @brief Marcas de tiempo por transferencia USB, contador de muestras y detección de pérdidas.
+ *
+ * El HackRF no entrega marcas de hardware: @ref rx_callback registra por cada
+ * `hackrf_transfer` el instante `CLOCK_MONOTONIC` de llegada, la posición del ring buffer
+ * tras escribirla y el índice de muestra acumulado. La línea de tiempo de la muestra s es
+ *   \f$ t(s) = t_0 + (s + L_{min}) / f_s \f$
+ * donde \f$ L_{min} \f$ es el menor retraso observado entre las muestras contadas y el reloj
+ * (el retardo base del USB). Si una transferencia llega con un retraso mayor que
+ * @ref RX_TIMING_GAP_TRANSFERS transferencias sobre ese piso, libhackrf ya no pudo tenerla en
+ * vuelo: las muestras faltantes se cuentan como perdidas y el contador salta para que la
+ * línea de tiempo siga alineada. El piso se relaja @ref RX_TIMING_DRIFT_PPM para absorber la
+ * deriva entre el cristal del HackRF y el reloj del sistema.
+ *
+ * El productor (hilo USB) solo escribe en su tabla circular y publica con un contador atómico;
+ * el consumidor la lee sin locks para ubicar la primera muestra de cada captura.
+ */
+
+#ifndef RX_TIMING_H
+#define RX_TIMING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @defgroup rx_timing_module RX Timing
+ * @ingroup rf_binary
+ * @brief Metadatos temporales exactos a la muestra de cada captura.
+ * @{
+ */
+
+#define RX_TIMING_STAMPS         4096  /**< Transferencias recordadas (potencia de dos; cubre el ring de 128 MiB). */
+#define RX_TIMING_GAP_TRANSFERS  4     /**< Retraso (en transferencias) sobre el piso que se considera pérdida. */
+#define RX_TIMING_DRIFT_PPM      50.0  /**< Relajación del piso por muestra: deriva de reloj tolerada. */
+
+/**
+ * @brief Una transferencia registrada.
+ */
+typedef struct {
+    uint64_t rb_end;      /**< Posición acumulada del ring buffer tras escribirla. */
+    uint32_t rb_len;      /**< Bytes que efectivamente entraron al ring. */
+    uint32_t epoch;       /**< Época de la línea de tiempo (cambia con @ref rx_timing_reset). */
+    uint64_t sample0;     /**< Índice de la primera muestra escrita. */
+    uint64_t dropped;     /**< Muestras perdidas acumuladas antes de @ref sample0. */
+    int64_t  t0_ns;       /**< Instante monotónico estimado de @ref sample0. */
+    double   fs;          /**< Tasa de la época (Hz). */
+} rx_stamp_t;
+
+/**
+ * @brief Estado compartido entre el hilo USB y el consumidor.
+ */
+typedef struct {
+    rx_stamp_t stamps[RX_TIMING_STAMPS]; /**< Tabla circular (solo la escribe el productor). */
+    atomic_uint_fast64_t n_stamps;       /**< Transferencias publicadas. */
+    atomic_uint reset_epoch;             /**< Época pedida por @ref rx_timing_reset. */
+    _Atomic double reset_fs;             /**< Tasa de la época pedida. */
+    atomic_uint_fast64_t gaps;           /**< Pérdidas detectadas por tiempo desde el arranque. */
+
+    /* Private to the producer */
+    uint32_t epoch;       /**< Época vigente. */
+    double fs;            /**< Tasa de la época (Hz). */
+    int64_t anchor_ns;    /**< \f$ t_0 \f$. */
+    uint64_t samples;     /**< Muestras contadas (incluye saltos por pérdida). */
+    uint64_t dropped;     /**< Muestras perdidas acumuladas (tiempo + ring lleno). */
+    double lag_floor;     /**< \f$ L_{min} \f$ (muestras). */
+    bool anchored;        /**< Hay \f$ t_0 \f$ para la época vigente. */
+} rx_timing_t;
+
+/**
+ * @brief Metadatos de una captura.
+ */
+typedef struct {
+    bool valid;            /**< La captura cae dentro de la tabla y de una sola época. */
+    uint64_t sample_index; /**< Índice de la primera muestra en la línea de tiempo del stream. */
+    int64_t t_mono_ns;     /**< `CLOCK_MONOTONIC` estimado de la primera muestra. */
+    int64_t t_utc_ns;      /**< UTC de la primera muestra (0 si no se pudo estimar). */
+    bool gps;              /**< @ref t_utc_ns viene de un fix GPS (si no, del reloj del sistema). */
+    uint64_t dropped;      /**< Muestras perdidas dentro de la captura. */
+} rx_capture_meta_t;
+
+/**
+ * @brief Nueva línea de tiempo a partir de la próxima transferencia (llamar al re-sintonizar,
+ * al reiniciar el ring buffer o al arrancar la RX).
+ * @param t Estado.
+ * @param fs Tasa de muestreo de la nueva época (Hz).
+ */
+void rx_timing_reset(rx_timing_t *t, double fs);
+
+/**
+ * @brief Registra una transferencia. Solo para el hilo productor; sin reservas ni locks.
+ * @param t Estado.
+ * @param now_ns `CLOCK_MONOTONIC` al entrar al callback.
+ * @param n_bytes Bytes de la transferencia (I/Q de 8 bits).
+ * @param written Bytes que aceptó el ring buffer (el resto se contó como descarte).
+ * @param rb_head Posición acumulada del ring tras la escritura.
+ */
+void rx_timing_stamp(rx_timing_t *t, int64_t now_ns, size_t n_bytes, size_t written, uint64_t rb_head);
+
+/**
+ * @brief Ubica una captura del ring buffer en la línea de tiempo.
+ * @param t Estado.
+ * @param rb_pos Posición acumulada del primer byte de la captura (`tail` del ring).
+ * @param n_bytes Bytes de la captura.
+ * @param[out] out Metadatos (`t_utc_ns` a cargo del llamador).
+ * @return 0 si la captura se ubicó, -1 si sus transferencias ya no están en la tabla.
+ */
+int rx_timing_lookup(const rx_timing_t *t, uint64_t rb_pos, size_t n_bytes, rx_capture_meta_t *out);
+
+/** @} */
+
+#endif
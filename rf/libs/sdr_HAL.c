@@ -4,7 +4,14 @@
  */
 
 #include "sdr_HAL.h"
+#include "iq_record.h"
 #include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
 /**
  * @addtogroup sdr_module
@@ -43,4 +50,185 @@ void hackrf_apply_cfg(hackrf_device* dev, SDR_cfg_t *cfg) {
     tune_freq_with_ppm(dev, cfg->center_freq, cfg->ppm_error);
 }
 
+int hackrf_retune(hackrf_device* dev, SDR_cfg_t *cfg, uint64_t center_freq) {
+    if (!dev || !cfg) return HACKRF_ERROR_INVALID_PARAM;
+
+    // Silent on purpose: a sweep hops hundreds of times per request
+    double correction = 1.0 + ((double)cfg->ppm_error / 1000000.0);
+    cfg->center_freq = center_freq;
+    cfg->center_freq_corrected = (uint64_t)((double)center_freq * correction);
+    return hackrf_set_freq(dev, cfg->center_freq_corrected);
+}
+
+int sdr_hackrf_open(const char *serial, hackrf_device **dev) {
+    if (!dev) return HACKRF_ERROR_INVALID_PARAM;
+    *dev = NULL;
+    if (!serial || serial[0] == '\0') return hackrf_open(dev);
+    return hackrf_open_by_serial(serial, dev);
+}
+
+int sdr_hackrf_list(char serials[][SDR_SERIAL_LEN], int max) {
+    if (!serials || max <= 0) return -1;
+    hackrf_device_list_t *list = hackrf_device_list();
+    if (!list) return -1;
+
+    int n = 0;
+    for (int i = 0; i < list->devicecount && n < max; i++) {
+        const char *sn = list->serial_numbers[i];
+        if (!sn) continue;
+        snprintf(serials[n++], SDR_SERIAL_LEN, "%s", sn);
+    }
+    hackrf_device_list_free(list);
+    return n;
+}
+
+struct sdr_replay {
+    iq_record_file_t file;         /**< Grabación mapeada. */
+    bool realtime;                 /**< Pacing a la tasa grabada. */
+    bool loop;                     /**< Reinicio al final del archivo. */
+    size_t pos;                    /**< Próximo byte a entregar (persistente entre start/stop). */
+    hackrf_sample_block_cb_fn cb;  /**< Callback de RX activo. */
+    void *rx_ctx;                  /**< Contexto del callback. */
+    pthread_t thread;              /**< Hilo de reproducción. */
+    bool thread_started;           /**< @ref thread pendiente de join. */
+    atomic_bool running;           /**< Orden de parada desde @ref sdr_replay_stop_rx. */
+    atomic_bool streaming;         /**< Estado visible para @ref sdr_replay_is_streaming. */
+};
+
+static void timespec_add_ns(struct timespec *t, uint64_t ns) {
+    ns += (uint64_t)t->tv_nsec;
+    t->tv_sec += (time_t)(ns / 1000000000ULL);
+    t->tv_nsec = (long)(ns % 1000000000ULL);
+}
+
+static void *replay_thread_fn(void *arg) {
+    sdr_replay_t *r = (sdr_replay_t*)arg;
+    const size_t block = SDR_REPLAY_TRANSFER_BYTES;
+    const uint64_t period_ns = r->realtime
+        ? (uint64_t)llround((double)(block / 2U) * 1e9 / r->file.cfg.sample_rate) : 0;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    while (atomic_load(&r->running)) {
+        if (r->pos >= r->file.n_bytes) {
+            if (!r->loop) break;
+            r->pos = 0;
+        }
+        size_t len = r->file.n_bytes - r->pos;
+        if (len > block) len = block;
+
+        hackrf_transfer transfer;
+        memset(&transfer, 0, sizeof(transfer));
+        transfer.buffer = (uint8_t*)(uintptr_t)(r->file.data + r->pos);
+        transfer.buffer_length = (int)block;
+        transfer.valid_length = (int)len;
+        transfer.rx_ctx = r->rx_ctx;
+
+        if (period_ns > 0) {
+            timespec_add_ns(&deadline, period_ns);
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            // More than a second behind (consumer stalled): restart the clock instead of bursting
+            if (now.tv_sec > deadline.tv_sec + 1) deadline = now;
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+        }
+
+        r->pos += len;
+        if (r->cb(&transfer) != 0) break;
+    }
+
+    if (r->pos >= r->file.n_bytes) r->pos = 0;
+    atomic_store(&r->streaming, false);
+    return NULL;
+}
+
+int sdr_replay_open(const char *path, bool realtime, bool loop, sdr_replay_t **out) {
+    if (!path || !out) return -1;
+    *out = NULL;
+
+    sdr_replay_t *r = (sdr_replay_t*)calloc(1, sizeof(*r));
+    if (!r) return -1;
+    if (iq_record_open(path, &r->file) != 0) {
+        free(r);
+        return -1;
+    }
+    if (r->file.cfg.sample_rate <= 0.0) {
+        fprintf(stderr, "[HAL] Replay %s has no sample rate metadata%s\n", r->file.base,
+                realtime ? "; playing as fast as possible" : "");
+        realtime = false;
+    }
+
+    r->realtime = realtime;
+    r->loop = loop;
+    atomic_init(&r->running, false);
+    atomic_init(&r->streaming, false);
+
+    printf("[HAL] Replay: %s | %.3f s @ %.0f Sps | Fc: %" PRIu64 " Hz | %s%s\n",
+           r->file.base,
+           (r->file.cfg.sample_rate > 0.0) ? (double)(r->file.n_bytes / 2U) / r->file.cfg.sample_rate : 0.0,
+           r->file.cfg.sample_rate, r->file.cfg.center_freq,
+           r->realtime ? "real-time" : "as fast as possible", r->loop ? ", loop" : "");
+    *out = r;
+    return 0;
+}
+
+const SDR_cfg_t *sdr_replay_cfg(const sdr_replay_t *r) {
+    return r ? &r->file.cfg : NULL;
+}
+
+void sdr_replay_apply_cfg(const sdr_replay_t *r, SDR_cfg_t *cfg) {
+    if (!r || !cfg) return;
+    const SDR_cfg_t *rec = &r->file.cfg;
+
+    if (rec->sample_rate > 0.0) cfg->sample_rate = rec->sample_rate;
+    if (rec->center_freq != 0) {
+        cfg->center_freq = rec->center_freq;
+        cfg->center_freq_corrected = rec->center_freq_corrected;
+    } else {
+        cfg->center_freq_corrected = cfg->center_freq;
+    }
+    cfg->ppm_error = rec->ppm_error;
+    cfg->lna_gain = rec->lna_gain;
+    cfg->vga_gain = rec->vga_gain;
+    cfg->amp_enabled = rec->amp_enabled;
+}
+
+int sdr_replay_start_rx(sdr_replay_t *r, hackrf_sample_block_cb_fn cb, void *rx_ctx) {
+    if (!r || !cb) return -1;
+    sdr_replay_stop_rx(r);
+
+    r->cb = cb;
+    r->rx_ctx = rx_ctx;
+    atomic_store(&r->running, true);
+    atomic_store(&r->streaming, true);
+    if (pthread_create(&r->thread, NULL, replay_thread_fn, r) != 0) {
+        atomic_store(&r->running, false);
+        atomic_store(&r->streaming, false);
+        return -1;
+    }
+    r->thread_started = true;
+    return 0;
+}
+
+void sdr_replay_stop_rx(sdr_replay_t *r) {
+    if (!r) return;
+    atomic_store(&r->running, false);
+    if (r->thread_started) {
+        pthread_join(r->thread, NULL);
+        r->thread_started = false;
+    }
+}
+
+bool sdr_replay_is_streaming(const sdr_replay_t *r) {
+    return r && atomic_load(&r->streaming);
+}
+
+void sdr_replay_close(sdr_replay_t *r) {
+    if (!r) return;
+    sdr_replay_stop_rx(r);
+    iq_record_close(&r->file);
+    free(r);
+}
+
 /** @} */
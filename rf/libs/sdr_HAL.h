@@ -28,6 +28,8 @@
 #define IN_MHZ(x) ((int64_t)(x) * 1000000)
 #endif
 
+#define SDR_SERIAL_LEN 40 /**< Capacidad de un número de serie HackRF (32 dígitos hex + margen). */
+
 /**
  * @struct SDR_cfg_t
  * @brief Estructura que contiene los parámetros de configuración del SDR.
@@ -51,6 +53,103 @@ typedef struct {
  */
 void hackrf_apply_cfg(hackrf_device* dev, SDR_cfg_t *cfg);
 
+/**
+ * @brief Re-sintoniza solo la frecuencia central (con corrección PPM), sin tocar ganancias
+ * ni tasa de muestreo. Pensada para saltos rápidos de un barrido con RX activo.
+ * @param dev Puntero al dispositivo HackRF abierto.
+ * @param cfg Configuración vigente; se actualizan `center_freq` y `center_freq_corrected`.
+ * @param center_freq Nueva frecuencia nominal en Hz.
+ * @return Código de retorno de `hackrf_set_freq` (HACKRF_SUCCESS en éxito).
+ */
+int hackrf_retune(hackrf_device* dev, SDR_cfg_t *cfg, uint64_t center_freq);
+
+/**
+ * @brief Abre un HackRF por número de serie.
+ * @details Acepta el serial completo o su sufijo, como `hackrf_info`/`hackrf_open_by_serial`.
+ * @param serial Número de serie; NULL o "" abre el primer dispositivo libre.
+ * @param[out] dev Dispositivo abierto.
+ * @return Código de libhackrf (HACKRF_SUCCESS en éxito).
+ */
+int sdr_hackrf_open(const char *serial, hackrf_device **dev);
+
+/**
+ * @brief Enumera los HackRF conectados.
+ * @param[out] serials Números de serie encontrados.
+ * @param max Capacidad de @p serials.
+ * @return Dispositivos copiados en @p serials, o -1 si falló la enumeración.
+ */
+int sdr_hackrf_list(char serials[][SDR_SERIAL_LEN], int max);
+
+/**
+ * @name Fuente de reproducción (replay)
+ * Sustituto del HackRF que alimenta el mismo callback de RX desde una grabación SigMF
+ * (@ref iq_record_write). Un hilo propio entrega bloques de @ref SDR_REPLAY_TRANSFER_BYTES como
+ * `hackrf_transfer` apuntando al mapeo del archivo (sin copias), a la tasa de la grabación o
+ * tan rápido como el consumidor lo permita. La posición se conserva entre start/stop; al
+ * final del archivo se reinicia (modo loop) o la RX se detiene como si se perdiera el USB.
+ * @{
+ */
+
+#define SDR_REPLAY_TRANSFER_BYTES 262144 /**< Tamaño de bloque, igual al transfer USB de libhackrf. */
+
+/** @brief Fuente de reproducción (opaca). */
+typedef struct sdr_replay sdr_replay_t;
+
+/**
+ * @brief Abre una grabación como fuente de RX.
+ * @param path Ruta base o archivo `.sigmf-data` / `.sigmf-meta`.
+ * @param realtime true = a la tasa de muestreo grabada; false = tan rápido como sea posible.
+ * @param loop Reinicia desde el principio al llegar al final.
+ * @param[out] out Fuente creada.
+ * @return 0 en éxito, -1 en error.
+ */
+int sdr_replay_open(const char *path, bool realtime, bool loop, sdr_replay_t **out);
+
+/**
+ * @brief Configuración de adquisición leída de la grabación.
+ * @param r Fuente.
+ */
+const SDR_cfg_t *sdr_replay_cfg(const sdr_replay_t *r);
+
+/**
+ * @brief Aplica la configuración a la fuente, al estilo de @ref hackrf_apply_cfg.
+ * @details La grabación no se puede re-sintonizar: fija en @p cfg la tasa, las frecuencias
+ * (nominal y corregida) y las ganancias grabadas para que el DSP use el eje correcto.
+ * @param r Fuente.
+ * @param[in,out] cfg Configuración del request.
+ */
+void sdr_replay_apply_cfg(const sdr_replay_t *r, SDR_cfg_t *cfg);
+
+/**
+ * @brief Arranca el hilo de reproducción (equivalente a `hackrf_start_rx`).
+ * @param r Fuente.
+ * @param cb Callback de RX; un retorno distinto de cero detiene la reproducción.
+ * @param rx_ctx Contexto entregado en `transfer->rx_ctx`.
+ * @return 0 en éxito, -1 en error.
+ */
+int sdr_replay_start_rx(sdr_replay_t *r, hackrf_sample_block_cb_fn cb, void *rx_ctx);
+
+/**
+ * @brief Detiene y espera al hilo de reproducción (equivalente a `hackrf_stop_rx`).
+ * @param r Fuente.
+ */
+void sdr_replay_stop_rx(sdr_replay_t *r);
+
+/**
+ * @brief Indica si el hilo sigue entregando bloques.
+ * @param r Fuente.
+ * @return false tras @ref sdr_replay_stop_rx, al final del archivo sin loop o si el callback pidió parar.
+ */
+bool sdr_replay_is_streaming(const sdr_replay_t *r);
+
+/**
+ * @brief Detiene la reproducción, desmapea la grabación y libera la fuente.
+ * @param r Fuente (NULL = sin efecto).
+ */
+void sdr_replay_close(sdr_replay_t *r);
+
+/** @} */
+
 /** @} */
 
 #endif
\ No newline at end of file
@@ -34,12 +34,12 @@
 char *getenv_c(const char *key);
 
 /**
- * @brief Agrega/actualiza una clave en /dev/shm/persistent.json de forma segura.
+ * @brief Agrega/actualiza una clave del estado compartido (@ref kv_store_module).
  *
- * Implementa protección concurrente con file-lock exclusivo (flock) y
- * persistencia con fsync, emulando el patrón de ShmStore en Python.
+ * Escribe el slot de la clave en `/dev/shm/bacn_kv` bajo el lock de escritores y
+ * reescribe el snapshot `/dev/shm/persistent.json`, igual que ShmStore en Python.
  *
- * @param key Clave JSON a insertar/actualizar.
+ * @param key Clave a insertar/actualizar.
  * @param value_text Valor en texto. Si es JSON válido (número, bool, objeto, array,
  *                   string con comillas), se guarda tipado. Si no, se guarda como string.
  * @return int 0 en éxito, -1 en error.
@@ -47,13 +47,13 @@ char *getenv_c(const char *key);
 int shm_add_to_persistent(const char *key, const char *value_text);
 
 /**
- * @brief Consulta una clave en /dev/shm/persistent.json de forma segura.
+ * @brief Consulta una clave del estado compartido (@ref kv_store_module).
  *
- * Usa lock compartido (flock) para lectura concurrente segura.
+ * Lectura sin locks ni parseo (seqlock del slot).
  * - Si el valor es string JSON, retorna el contenido sin comillas.
  * - En otros tipos (número/bool/objeto/array), retorna JSON serializado.
  *
- * @param key Clave JSON a consultar.
+ * @param key Clave a consultar.
  * @return char* Memoria dinámica con el valor; liberar con free().
  *               Retorna NULL si no existe o hay error.
  */
@@ -1,6 +1,6 @@
 /**
  * @file zmq_util.c
- * @brief Detalles de implementación para la gestión síncrona de sockets ZMQ REP.
+ * @brief Detalles de implementación del canal de control ZMQ ROUTER y del socket PUB.
  */
 
 #define _GNU_SOURCE
@@ -13,14 +13,16 @@
 
 /**
  * @brief Ayudante interno para configurar opciones de socket y conectar.
- * Configura un socket REP con timeouts cortos, HWM mínimo y reconexión automática.
+ * Configura un socket ROUTER con timeouts cortos, HWM acotado y reconexión automática,
+ * conectado a cada endpoint de la lista `pair->addr`.
  * @param pair La instancia a configurar.
- * @return Código de resultado ZMQ (0 éxito, -1 error).
+ * @return Código de resultado ZMQ (0 éxito, -1 si algún endpoint falló).
  */
 static int internal_connect(zpair_t *pair) {
     if (pair->socket) zmq_close(pair->socket);
+    pair->n_peers = 0; // a new socket cannot route replies to the old peers
 
-    pair->socket = zmq_socket(pair->context, ZMQ_REP);
+    pair->socket = zmq_socket(pair->context, ZMQ_ROUTER);
     if (!pair->socket) return -1;
 
     int linger = 0;
@@ -29,7 +31,8 @@ static int internal_connect(zpair_t *pair) {
     int immediate = 1;
     zmq_setsockopt(pair->socket, ZMQ_IMMEDIATE, &immediate, sizeof(immediate));
 
-    int hwm = 1;
+    // Several clients may queue behind a capture; replies to vanished peers are dropped by ROUTER
+    int hwm = ZPAIR_HWM;
     zmq_setsockopt(pair->socket, ZMQ_SNDHWM, &hwm, sizeof(hwm));
     zmq_setsockopt(pair->socket, ZMQ_RCVHWM, &hwm, sizeof(hwm));
 
@@ -45,7 +48,176 @@ static int internal_connect(zpair_t *pair) {
     zmq_setsockopt(pair->socket, ZMQ_RCVTIMEO, &timeout, sizeof(timeout));
     zmq_setsockopt(pair->socket, ZMQ_SNDTIMEO, &timeout, sizeof(timeout));
 
-    return zmq_connect(pair->socket, pair->addr);
+    char *list = strdup(pair->addr);
+    if (!list) return -1;
+    int rc = 0;
+    char *save = NULL;
+    for (char *ep = strtok_r(list, ",", &save); ep; ep = strtok_r(NULL, ",", &save)) {
+        while (*ep == ' ') ep++;
+        if (*ep == '\0') continue;
+        if (zmq_connect(pair->socket, ep) != 0) {
+            if (pair->verbose) fprintf(stderr, "[ZMQ] Connect failed on %s: %s\n", ep, zmq_strerror(zmq_errno()));
+            rc = -1;
+        }
+    }
+    free(list);
+    return rc;
+}
+
+/**
+ * @brief Envía un mensaje a un peer con el sobre REQ: [identidad][""][frames...].
+ * @return Bytes de payload enviados, o -1 si falló.
+ */
+static int send_envelope(zpair_t *pair, const zpair_peer_t *peer) {
+    if (zmq_send(pair->socket, peer->id, peer->len, ZMQ_SNDMORE) < 0 ||
+        zmq_send(pair->socket, "", 0, ZMQ_SNDMORE) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static int send_to_peer(zpair_t *pair, const zpair_peer_t *peer,
+                        const void *const *parts, const size_t *lens, int nparts) {
+    if (send_envelope(pair, peer) != 0) return -1;
+
+    int total = 0;
+    for (int i = 0; i < nparts; ++i) {
+        int flags = (i < nparts - 1) ? ZMQ_SNDMORE : 0;
+        int rc = zmq_send(pair->socket, parts[i], lens[i], flags);
+        if (rc < 0) {
+            if (pair->verbose) fprintf(stderr, "[ZMQ] Send error (part %d/%d): %s\n",
+                                       i + 1, nparts, zmq_strerror(zmq_errno()));
+            return -1;
+        }
+        total += rc;
+    }
+    return total;
+}
+
+static int send_text_to_peer(zpair_t *pair, const zpair_peer_t *peer, const char *text) {
+    const void *parts[1] = { text };
+    const size_t lens[1] = { strlen(text) };
+    return send_to_peer(pair, peer, parts, lens, 1);
+}
+
+/**
+ * @brief Lee un mensaje del socket en `pair->rx` (identidad + último frame como payload).
+ * @return 1 si leyó un mensaje, 0 si no había (EAGAIN), -1 si falló el socket.
+ */
+static int read_message(zpair_t *pair, int flags) {
+    zpair_slot_t *m = &pair->rx;
+    int id_len = zmq_recv(pair->socket, m->peers[0].id, ZPAIR_ID_MAX, flags);
+    if (id_len < 0) {
+        int err = zmq_errno();
+        if (err == EAGAIN) return 0;
+        if (pair->verbose) fprintf(stderr, "[ZMQ] Recv error: %s\n", zmq_strerror(err));
+        if (err == EFSM || err == ETERM) internal_connect(pair);
+        return -1;
+    }
+    m->peers[0].len = (id_len > ZPAIR_ID_MAX) ? ZPAIR_ID_MAX : (size_t)id_len;
+    m->n_peers = 1;
+    m->len = 0;
+    m->data[0] = '\0';
+
+    // The remaining frames are the empty delimiter and the body; keep the last one
+    int more = 0;
+    size_t more_len = sizeof(more);
+    zmq_getsockopt(pair->socket, ZMQ_RCVMORE, &more, &more_len);
+    while (more) {
+        int len = zmq_recv(pair->socket, m->data, ZBUF_SIZE - 1, 0);
+        if (len < 0) return -1;
+        if (len > ZBUF_SIZE - 1) {
+            if (pair->verbose) fprintf(stderr, "[ZMQ] Request truncated (%d bytes)\n", len);
+            len = ZBUF_SIZE - 1;
+        }
+        m->len = len;
+        m->data[len] = '\0';
+        more_len = sizeof(more);
+        zmq_getsockopt(pair->socket, ZMQ_RCVMORE, &more, &more_len);
+    }
+    return 1;
+}
+
+static bool same_payload(const zpair_slot_t *m, const char *data, int len) {
+    return m->len == len && memcmp(m->data, data, (size_t)len) == 0;
+}
+
+static bool add_peer(zpair_peer_t *peers, int *n_peers, const zpair_peer_t *peer) {
+    if (*n_peers >= ZPAIR_MAX_PEERS) return false;
+    peers[(*n_peers)++] = *peer;
+    return true;
+}
+
+/**
+ * @brief Decide el destino de `pair->rx`: consulta, coalescencia o cola.
+ */
+static void dispatch(zpair_t *pair) {
+    zpair_slot_t *m = &pair->rx;
+    const zpair_peer_t *peer = &m->peers[0];
+
+    if (m->len == 0) {
+        send_text_to_peer(pair, peer, "{\"status\":\"error\",\"reason\":\"empty_request\"}");
+        return;
+    }
+
+    // 1. Status/metrics queries never wait for the acquisition
+    if (pair->query) {
+        int n = pair->query(m->data, pair->reply, sizeof(pair->reply), pair->query_user);
+        if (n > 0) {
+            send_text_to_peer(pair, peer, pair->reply);
+            return;
+        }
+    }
+
+    // 2. Same payload as the request in flight: one acquisition, one reply per peer
+    if (pair->n_peers > 0 && same_payload(m, pair->buffer, pair->len) &&
+        add_peer(pair->peers, &pair->n_peers, peer)) {
+        pair->coalesced++;
+        return;
+    }
+
+    // 3. Same payload as a queued request
+    for (int i = 0; i < pair->q_count; i++) {
+        zpair_slot_t *q = &pair->queue[(pair->q_head + i) % ZPAIR_QUEUE_LEN];
+        if (same_payload(m, q->data, q->len) && add_peer(q->peers, &q->n_peers, peer)) {
+            pair->coalesced++;
+            return;
+        }
+    }
+
+    if (pair->q_count >= ZPAIR_QUEUE_LEN) {
+        pair->rejected++;
+        send_text_to_peer(pair, peer, "{\"status\":\"error\",\"reason\":\"busy\"}");
+        return;
+    }
+
+    zpair_slot_t *q = &pair->queue[(pair->q_head + pair->q_count) % ZPAIR_QUEUE_LEN];
+    memcpy(q->data, m->data, (size_t)m->len + 1U);
+    q->len = m->len;
+    q->peers[0] = *peer;
+    q->n_peers = 1;
+    pair->q_count++;
+}
+
+/**
+ * @brief Pasa el request más antiguo de la cola a `pair->buffer` y a los peers en curso.
+ * @return Longitud del request, o 0 si la cola está vacía.
+ */
+static int pop_request(zpair_t *pair) {
+    if (pair->q_count == 0) return 0;
+    if (pair->n_peers > 0 && pair->verbose) {
+        fprintf(stderr, "[ZMQ] Previous request left without reply (%d peers)\n", pair->n_peers);
+    }
+
+    zpair_slot_t *q = &pair->queue[pair->q_head];
+    memcpy(pair->buffer, q->data, (size_t)q->len + 1U);
+    pair->len = q->len;
+    memcpy(pair->peers, q->peers, (size_t)q->n_peers * sizeof(q->peers[0]));
+    pair->n_peers = q->n_peers;
+
+    pair->q_head = (pair->q_head + 1) % ZPAIR_QUEUE_LEN;
+    pair->q_count--;
+    return pair->len;
 }
 
 zpair_t* zpair_init(const char *ipc_addr, int verbose) {
@@ -62,21 +234,52 @@ zpair_t* zpair_init(const char *ipc_addr, int verbose) {
     return pair;
 }
 
-int zpair_recv(zpair_t *pair) {
+void zpair_set_query(zpair_t *pair, zpair_query_fn fn, void *user) {
+    if (!pair) return;
+    pair->query = fn;
+    pair->query_user = user;
+}
+
+int zpair_service(zpair_t *pair) {
     if (!pair || !pair->socket) return -1;
 
-    int len = zmq_recv(pair->socket, pair->buffer, ZBUF_SIZE - 1, 0);
-    if (len >= 0) {
-        pair->buffer[len] = '\0';
-        return len;
+    // Bounded so that a flood of queries cannot starve the acquisition loop
+    int n = 0;
+    while (n < 4 * ZPAIR_HWM) {
+        int rc = read_message(pair, ZMQ_DONTWAIT);
+        if (rc < 0) return -1;
+        if (rc == 0) break;
+        dispatch(pair);
+        n++;
     }
+    return n;
+}
+
+int zpair_queue_depth(const zpair_t *pair) {
+    return pair ? pair->q_count : 0;
+}
 
-    int err = zmq_errno();
-    if (err == EAGAIN) return 0;
+bool zpair_busy(const zpair_t *pair) {
+    return pair && pair->n_peers > 0;
+}
+
+int zpair_recv(zpair_t *pair) {
+    if (!pair || !pair->socket) return -1;
 
-    if (pair->verbose) fprintf(stderr, "[ZMQ] Recv error: %s\n", zmq_strerror(err));
-    if (err == EFSM || err == ETERM) internal_connect(pair);
-    return -1;
+    if (pair->q_count == 0) {
+        // Block (up to RCVTIMEO) for the first message, then take whatever came with it
+        int rc = read_message(pair, 0);
+        if (rc <= 0) return rc;
+        dispatch(pair);
+        zpair_service(pair);
+    }
+    return pop_request(pair);
+}
+
+int zpair_try_recv(zpair_t *pair) {
+    if (!pair || !pair->socket) return -1;
+    if (zpair_service(pair) < 0 && pair->q_count == 0) return -1;
+    return pop_request(pair);
 }
 
 int zpair_reconnect(zpair_t *pair) {
@@ -85,17 +288,70 @@ int zpair_reconnect(zpair_t *pair) {
 }
 
 int zpair_send(zpair_t *pair, const char *json_payload) {
-    if (!pair || !pair->socket || !json_payload) return -1;
+    if (!json_payload) return -1;
+    const void *parts[1] = { json_payload };
+    const size_t lens[1] = { strlen(json_payload) };
+    return zpair_send_parts(pair, parts, lens, 1);
+}
 
-    int rc = zmq_send(pair->socket, json_payload, strlen(json_payload), 0);
-    if (rc >= 0) {
-        printf("[RF]>>>>>zmq\n");
-        return rc;
+int zpair_send_parts(zpair_t *pair, const void *const *parts, const size_t *lens, int nparts) {
+    if (!pair || !pair->socket || !parts || !lens || nparts <= 0) return -1;
+    if (pair->n_peers == 0) {
+        if (pair->verbose) fprintf(stderr, "[ZMQ] Send without a pending request\n");
+        return -1;
     }
 
-    if (pair->verbose) fprintf(stderr, "[ZMQ] Send error: %s\n", zmq_strerror(zmq_errno()));
-    internal_connect(pair);
-    return -1;
+    int total = -1;
+    for (int p = 0; p < pair->n_peers; ++p) {
+        int rc = send_to_peer(pair, &pair->peers[p], parts, lens, nparts);
+        if (rc < 0) {
+            internal_connect(pair);
+            return -1;
+        }
+        total = rc;
+    }
+    if (pair->n_peers > 1) printf("[RF]>>>>>zmq x%d\n", pair->n_peers);
+    else printf("[RF]>>>>>zmq\n");
+    pair->n_peers = 0;
+    return total;
+}
+
+int zpair_send_zc(zpair_t *pair, void *data, size_t len, zmq_free_fn *ffn, void *hint) {
+    if (!data || !ffn) return -1;
+    if (!pair || !pair->socket || pair->n_peers == 0) {
+        if (pair && pair->verbose) fprintf(stderr, "[ZMQ] Send without a pending request\n");
+        ffn(data, hint);
+        return -1;
+    }
+
+    zmq_msg_t msg;
+    if (zmq_msg_init_data(&msg, data, len, ffn, hint) != 0) {
+        ffn(data, hint);
+        return -1;
+    }
+
+    // Coalesced peers share the buffer: each copy only bumps its reference count
+    int rc = (int)len;
+    for (int p = 0; p < pair->n_peers && rc >= 0; ++p) {
+        zmq_msg_t part;
+        zmq_msg_init(&part);
+        if (zmq_msg_copy(&part, &msg) != 0 || send_envelope(pair, &pair->peers[p]) != 0 ||
+            zmq_msg_send(&part, pair->socket, 0) < 0) {
+            if (pair->verbose) fprintf(stderr, "[ZMQ] Send error: %s\n", zmq_strerror(zmq_errno()));
+            rc = -1;
+        }
+        zmq_msg_close(&part);
+    }
+    zmq_msg_close(&msg);
+    if (rc < 0) {
+        internal_connect(pair);
+        return -1;
+    }
+
+    if (pair->n_peers > 1) printf("[RF]>>>>>zmq x%d\n", pair->n_peers);
+    else printf("[RF]>>>>>zmq\n");
+    pair->n_peers = 0;
+    return rc;
 }
 
 void zpair_close(zpair_t *pair) {
@@ -106,4 +362,73 @@ void zpair_close(zpair_t *pair) {
     free(pair);
 }
 
+zpub_t* zpub_init(const char *addr, int verbose) {
+    if (!addr) return NULL;
+
+    zpub_t *pub = calloc(1, sizeof(zpub_t));
+    if (!pub) return NULL;
+
+    pub->addr = strdup(addr);
+    pub->context = zmq_ctx_new();
+    pub->verbose = verbose;
+    pub->socket = pub->context ? zmq_socket(pub->context, ZMQ_PUB) : NULL;
+    if (!pub->addr || !pub->socket) {
+        zpub_close(pub);
+        return NULL;
+    }
+
+    int linger = 0;
+    zmq_setsockopt(pub->socket, ZMQ_LINGER, &linger, sizeof(linger));
+
+    // Keep only a few frames queued per subscriber: stale spectra are dropped, not buffered
+    int hwm = 4;
+    zmq_setsockopt(pub->socket, ZMQ_SNDHWM, &hwm, sizeof(hwm));
+
+    if (zmq_bind(pub->socket, pub->addr) != 0) {
+        fprintf(stderr, "[ZMQ] PUB bind failed on %s: %s\n", pub->addr, zmq_strerror(zmq_errno()));
+        zpub_close(pub);
+        return NULL;
+    }
+    return pub;
+}
+
+int zpub_send_parts(zpub_t *pub, const void *const *parts, const size_t *lens, int nparts) {
+    if (!pub || !pub->socket || !parts || !lens || nparts <= 0) return -1;
+
+    int total = 0;
+    for (int i = 0; i < nparts; ++i) {
+        int flags = ZMQ_DONTWAIT | ((i < nparts - 1) ? ZMQ_SNDMORE : 0);
+        int rc = zmq_send(pub->socket, parts[i], lens[i], flags);
+        if (rc < 0) {
+            if (pub->verbose) fprintf(stderr, "[ZMQ] PUB send error: %s\n", zmq_strerror(zmq_errno()));
+            return -1;
+        }
+        total += rc;
+    }
+    return total;
+}
+
+int zpub_send_zc(zpub_t *pub, void *data, size_t len, zmq_free_fn *ffn, void *hint) {
+    if (!data || !ffn) return -1;
+    zmq_msg_t msg;
+    if (!pub || !pub->socket || zmq_msg_init_data(&msg, data, len, ffn, hint) != 0) {
+        ffn(data, hint);
+        return -1;
+    }
+    if (zmq_msg_send(&msg, pub->socket, ZMQ_DONTWAIT) < 0) {
+        if (pub->verbose) fprintf(stderr, "[ZMQ] PUB send error: %s\n", zmq_strerror(zmq_errno()));
+        zmq_msg_close(&msg);
+        return -1;
+    }
+    return (int)len;
+}
+
+void zpub_close(zpub_t *pub) {
+    if (!pub) return;
+    if (pub->socket) zmq_close(pub->socket);
+    if (pub->context) zmq_ctx_term(pub->context);
+    free(pub->addr);
+    free(pub);
+}
+
 /** @} */
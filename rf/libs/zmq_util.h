@@ -1,15 +1,24 @@
 /**
  * @file zmq_util.h
- * @brief Utilidad de sockets ZeroMQ REP para comunicación síncrona de payloads JSON.
+ * @brief Utilidad de sockets ZeroMQ para el canal de control y el streaming de PSD.
  *
- * Proporciona un envoltorio de alto nivel alrededor de ZMQ_REP para manejar un
- * flujo estricto request/reply 1:1 sin colas de aplicación ni hilo listener.
+ * El canal de control es un socket ROUTER que se conecta (`connect`) a uno o más
+ * endpoints REQ enlazados por Python. Cada request llega con la identidad de su
+ * peer y el reply se enruta de vuelta a esa identidad, de modo que varios clientes
+ * (orchestrator, campaign_runner, herramientas) comparten el motor sin cerrar y
+ * reabrir sockets. Mientras el motor procesa un request, @ref zpair_service:
+ *   - responde en el acto las consultas (estado, métricas) mediante @ref zpair_query_fn;
+ *   - agrega al request en curso los peers que piden exactamente el mismo payload
+ *     (una sola adquisición, un reply para cada uno);
+ *   - encola el resto (con la misma coalescencia entre requests encolados) hasta
+ *     @ref ZPAIR_QUEUE_LEN y rechaza con `"busy"` cuando la cola está llena.
  */
 
 #ifndef ZMQ_UTIL_H
 #define ZMQ_UTIL_H
 
 #include <zmq.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -18,61 +27,227 @@
 /**
  * @defgroup zmq_module ZMQ
  * @ingroup rf_binary
- * @brief Utilidad de sockets ZeroMQ REP para comunicación síncrona de payloads JSON
+ * @brief Canal de control ZeroMQ ROUTER (JSON request/reply) y publicación PUB de PSD
  * @{
  */
 
 /** @brief Tamaño máximo del búfer de mensajes. */
 #define ZBUF_SIZE 65536 
 
+#define ZPAIR_QUEUE_LEN  8   /**< Requests distintos que pueden esperar detrás del request en curso. */
+#define ZPAIR_MAX_PEERS  8   /**< Peers que pueden compartir (coalescer) un mismo request. */
+#define ZPAIR_ID_MAX     255 /**< Longitud máxima de una identidad de routing ZMQ. */
+#define ZPAIR_HWM        64  /**< HWM de envío/recepción del ROUTER (mensajes por peer). */
+
+/**
+ * @brief Atiende una consulta sin pasar por la cola de adquisición.
+ * @param req Request recibido (terminado en NUL).
+ * @param[out] reply Reply a enviar (terminado en NUL).
+ * @param cap Capacidad de @p reply.
+ * @param user Contexto registrado con @ref zpair_set_query.
+ * @return Longitud de @p reply si el request era una consulta, 0 si debe encolarse.
+ */
+typedef int (*zpair_query_fn)(const char *req, char *reply, size_t cap, void *user);
+
+/**
+ * @brief Identidad de routing de un peer REQ.
+ */
+typedef struct {
+    unsigned char id[ZPAIR_ID_MAX]; /**< Bytes de la identidad. */
+    size_t len;                     /**< Longitud de @ref id. */
+} zpair_peer_t;
+
+/**
+ * @brief Request encolado junto con los peers que lo esperan.
+ */
+typedef struct {
+    char data[ZBUF_SIZE];                   /**< Payload (terminado en NUL). */
+    int len;                                /**< Longitud de @ref data. */
+    zpair_peer_t peers[ZPAIR_MAX_PEERS];    /**< Peers a los que se enviará el reply. */
+    int n_peers;                            /**< Peers válidos en @ref peers. */
+} zpair_slot_t;
+
 /**
  * @struct zpair_t
- * @brief Estructura de gestión para una conexión ZMQ REP síncrona.
+ * @brief Canal de control: socket ROUTER, request en curso y cola de espera.
  */
 typedef struct {
     void *context;          /**< Manejador del contexto ZeroMQ. */
-    void *socket;           /**< Manejador del socket ZeroMQ. */
-    char *addr;             /**< Cadena con la dirección del endpoint. */
-    char buffer[ZBUF_SIZE]; /**< Búfer interno para datos entrantes. */
+    void *socket;           /**< Manejador del socket ZMQ_ROUTER. */
+    char *addr;             /**< Endpoints (separados por coma) a los que se conecta el ROUTER. */
+    char buffer[ZBUF_SIZE]; /**< Request en curso (terminado en NUL). */
     int verbose;            /**< Bandera para habilitar logs por stderr. */
+
+    int len;                /**< Longitud del request en curso. */
+    zpair_peer_t peers[ZPAIR_MAX_PEERS]; /**< Peers del request en curso: reciben el próximo reply. */
+    int n_peers;            /**< Peers válidos en @ref peers (0 = ningún reply pendiente). */
+    zpair_slot_t queue[ZPAIR_QUEUE_LEN]; /**< Cola circular de requests en espera. */
+    int q_head;             /**< Índice del request más antiguo de @ref queue. */
+    int q_count;            /**< Requests en @ref queue. */
+    zpair_slot_t rx;        /**< Mensaje recién leído del socket. */
+    char reply[ZBUF_SIZE];  /**< Reply de las consultas de @ref query. */
+
+    zpair_query_fn query;   /**< Manejador de consultas (NULL = todo se encola). */
+    void *query_user;       /**< Contexto de @ref query. */
+    unsigned long coalesced; /**< Peers agregados a un request existente desde el arranque. */
+    unsigned long rejected;  /**< Requests rechazados por cola llena desde el arranque. */
 } zpair_t;
 
 /**
- * @brief Reserva memoria e inicializa una nueva conexión ZMQ REP.
- * @param ipc_addr Dirección de conexión (ej. "ipc:///tmp/feed.ipc").
+ * @struct zpub_t
+ * @brief Socket ZMQ PUB para publicación continua de frames PSD (modo streaming).
+ *
+ * A diferencia de @ref zpair_t, el PUB hace `bind` (es el extremo estable) y
+ * descarta frames cuando un suscriptor lento alcanza el HWM, sin bloquear al motor.
+ */
+typedef struct {
+    void *context;          /**< Manejador del contexto ZeroMQ. */
+    void *socket;           /**< Manejador del socket ZMQ_PUB. */
+    char *addr;             /**< Cadena con la dirección del endpoint (bind). */
+    int verbose;            /**< Bandera para habilitar logs por stderr. */
+} zpub_t;
+
+/**
+ * @brief Reserva memoria e inicializa el canal de control ZMQ ROUTER.
+ * @param ipc_addr Endpoint o lista separada por comas (ej. "ipc:///tmp/a,ipc:///tmp/b").
  * @param verbose Habilita o deshabilita la salida de errores por consola.
  * @return Puntero a zpair_t si tiene éxito, NULL en caso de fallo de memoria.
  */
 zpair_t* zpair_init(const char *ipc_addr, int verbose);
 
 /**
- * @brief Espera un request y lo guarda en `pair->buffer`.
+ * @brief Registra el manejador de consultas que @ref zpair_service responde en el acto.
+ * @param pair Puntero a la instancia de zpair_t inicializada.
+ * @param fn Manejador (NULL lo desactiva).
+ * @param user Contexto pasado a @p fn.
+ */
+void zpair_set_query(zpair_t *pair, zpair_query_fn fn, void *user);
+
+/**
+ * @brief Lee sin bloquear todo lo pendiente en el socket: responde consultas, coalesce
+ * duplicados y encola el resto.
+ * @details El motor la llama mientras espera muestras, para que los clientes no queden
+ * bloqueados detrás de una captura larga.
+ * @param pair Puntero a la instancia de zpair_t inicializada.
+ * @return Número de mensajes leídos, o -1 si falló el socket.
+ */
+int zpair_service(zpair_t *pair);
+
+/**
+ * @brief Número de requests en espera detrás del request en curso.
+ * @param pair Puntero a la instancia de zpair_t.
+ * @return Requests encolados.
+ */
+int zpair_queue_depth(const zpair_t *pair);
+
+/**
+ * @brief Indica si hay un request tomado por el motor que aún no recibió reply.
+ * @param pair Puntero a la instancia de zpair_t.
+ * @return true si hay peers esperando el reply en curso.
+ */
+bool zpair_busy(const zpair_t *pair);
+
+/**
+ * @brief Toma el siguiente request (de la cola o esperando el socket) y lo guarda en `pair->buffer`.
  * @param pair Puntero a la instancia de zpair_t inicializada.
- * @return Número de bytes recibidos; `0` si venció el timeout; `-1` si falló.
+ * @return Número de bytes del request; `0` si venció el timeout (o solo llegaron consultas); `-1` si falló.
  */
 int zpair_recv(zpair_t *pair);
 
 /**
- * @brief Recrea el socket para resetear el estado interno REQ/REP tras errores.
+ * @brief Toma sin bloquear el siguiente request y lo guarda en `pair->buffer`.
+ * @details Se usa durante el modo streaming para detectar un cambio de configuración
+ * sin esperar el timeout de recepción. Las consultas se responden igual que en
+ * @ref zpair_service.
+ * @param pair Puntero a la instancia de zpair_t inicializada.
+ * @return Número de bytes recibidos; `0` si no hay request pendiente; `-1` si falló.
+ */
+int zpair_try_recv(zpair_t *pair);
+
+/**
+ * @brief Recrea el socket tras errores. La cola se conserva; los peers del request
+ * en curso se descartan (sus REQ vencen por timeout).
  * @param pair Puntero a la instancia activa de zpair_t.
  * @return `0` en éxito, `-1` en error.
  */
 int zpair_reconnect(zpair_t *pair);
 
 /**
- * @brief Envía un payload JSON como reply del request actual.
+ * @brief Envía un payload JSON como reply del request actual a todos sus peers.
  * @param pair Puntero a la instancia activa de zpair_t.
  * @param json_payload Cadena de texto a transmitir.
  * @return Número de bytes enviados, o -1 en caso de fallo.
  */
 int zpair_send(zpair_t *pair, const char *json_payload);
 
+/**
+ * @brief Envía un reply multipart (ZMQ_SNDMORE) compuesto por varios frames binarios.
+ * @details Se usa para replies binarios (cabecera fija + bins) sin pasar por texto.
+ * Cada peer recibe todos los frames como un único mensaje lógico.
+ * @param pair Puntero a la instancia activa de zpair_t.
+ * @param parts Arreglo de punteros a los datos de cada frame.
+ * @param lens Arreglo con el tamaño en bytes de cada frame.
+ * @param nparts Número de frames (>= 1).
+ * @return Total de bytes enviados, o -1 en caso de fallo.
+ */
+int zpair_send_parts(zpair_t *pair, const void *const *parts, const size_t *lens, int nparts);
+
+/**
+ * @brief Envía @p data como reply del request actual sin copiarlo (`zmq_msg_init_data`).
+ * @details Los peers coalescidos comparten el mismo buffer. @p ffn se invoca exactamente una vez,
+ * desde el hilo de E/S de ZMQ cuando el último peer terminó de enviarse, o en el acto si falla.
+ * @param pair Puntero a la instancia activa de zpair_t.
+ * @param data Payload (debe seguir vivo hasta @p ffn).
+ * @param len Bytes de @p data.
+ * @param ffn Liberador del buffer.
+ * @param hint Contexto de @p ffn.
+ * @return Bytes enviados, o -1 en caso de fallo.
+ */
+int zpair_send_zc(zpair_t *pair, void *data, size_t len, zmq_free_fn *ffn, void *hint);
+
 /**
  * @brief Cierra sockets y libera memoria.
  * @param pair Puntero a la instancia de zpair_t a destruir.
  */
 void zpair_close(zpair_t *pair);
 
+/**
+ * @brief Crea un socket ZMQ PUB y lo enlaza (bind) a la dirección dada.
+ * @param addr Dirección de publicación (ej. "ipc:///tmp/rf_psd_stream").
+ * @param verbose Habilita o deshabilita la salida de errores por consola.
+ * @return Puntero a zpub_t si tiene éxito, NULL si falló la creación o el bind.
+ */
+zpub_t* zpub_init(const char *addr, int verbose);
+
+/**
+ * @brief Publica un mensaje multipart en el socket PUB (no bloqueante).
+ * @param pub Puntero a la instancia activa de zpub_t.
+ * @param parts Arreglo de punteros a los datos de cada frame.
+ * @param lens Arreglo con el tamaño en bytes de cada frame.
+ * @param nparts Número de frames (>= 1).
+ * @return Total de bytes enviados, o -1 en caso de fallo.
+ */
+int zpub_send_parts(zpub_t *pub, const void *const *parts, const size_t *lens, int nparts);
+
+/**
+ * @brief Publica @p data como un frame sin copiarlo (no bloqueante).
+ * @details @p ffn se invoca exactamente una vez (al terminar el envío, al descartarse el frame
+ * por HWM o en el acto si falla).
+ * @param pub Puntero a la instancia activa de zpub_t.
+ * @param data Payload (debe seguir vivo hasta @p ffn).
+ * @param len Bytes de @p data.
+ * @param ffn Liberador del buffer.
+ * @param hint Contexto de @p ffn.
+ * @return Bytes enviados, o -1 en caso de fallo.
+ */
+int zpub_send_zc(zpub_t *pub, void *data, size_t len, zmq_free_fn *ffn, void *hint);
+
+/**
+ * @brief Cierra el socket PUB y libera memoria.
+ * @param pub Puntero a la instancia de zpub_t a destruir.
+ */
+void zpub_close(zpub_t *pub);
+
 /** @} */ 
 
 #endif
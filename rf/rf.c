@@ -25,6 +25,7 @@
 #include <unistd.h>
 #include <math.h>
 #include <string.h>
+#include <strings.h>
 #include <inttypes.h>
 #include <pthread.h>
 #include <time.h>
@@ -33,6 +34,7 @@
 #include <sys/time.h>
 #include <errno.h>
 #include <stdatomic.h>
+#include <semaphore.h>
 #include <sys/socket.h>
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
@@ -49,11 +51,24 @@
 #include "utils.h"
 #include "parser.h"
 #include "chan_filter.h"
+#include "iq_zoom.h"
 #include "audio_stream_ctx.h"
 #include "am_radio_local.h"
 #include "net_audio_retry.h"
 #include "iq_iir_filter.h"
 #include "opus_tx.h"
+#include "psd_reply.h"
+#include "fft_wisdom.h"
+#include "iq_decim.h"
+#include "rf_metrics.h"
+#include "psd_avg.h"
+#include "rf_affinity.h"
+#include "iq_record.h"
+#include "psd_detect.h"
+#include "json_writer.h"
+#include "rx_timing.h"
+#include "gps_time_shm.h"
+#include "fm_cal.h"
 
 #ifndef NO_COMMON_LIBS
     #include "bacn_gpio.h"
@@ -71,55 +86,57 @@
 static int    IQ_FILTER_ENABLE        = 1;      /**< Interruptor para habilitar/deshabilitar el filtrado IIR en datos IQ crudos. */
 static float  IQ_FILTER_BW_AM_HZ      = 20000.0f; /**< Ancho de banda en Hz para el pre-filtro de demodulación AM. */
 
-/** @} */
+static int    AUDIO_DECIM_ENABLE      = 1;         /**< Diezmador CIC + FIR antes del IIR y los demoduladores. */
+static double AUDIO_DECIM_FM_LO_HZ    = 250000.0;  /**< Tasa intermedia mínima para FM (canal WBFM de 200 kHz). */
+static double AUDIO_DECIM_FM_HI_HZ    = 600000.0;  /**< Tasa intermedia máxima para FM. */
+static double AUDIO_DECIM_FM_PREF_HZ  = 400000.0;  /**< Tasa intermedia preferida para FM. */
+static double AUDIO_DECIM_AM_LO_HZ    = 40000.0;   /**< Tasa intermedia mínima para AM (canal de 20 kHz). */
+static double AUDIO_DECIM_AM_HI_HZ    = 150000.0;  /**< Tasa intermedia máxima para AM. */
+static double AUDIO_DECIM_AM_PREF_HZ  = 96000.0;   /**< Tasa intermedia preferida para AM. */
+static int    JSON_PXX_DECIMALS       = 3;         /**< Decimales de los bins dBm de `Pxx` en el reply JSON (0.001 dB). */
+static int    RB_WAIT_SLICE_MS        = 100;       /**< Tramo máximo (ms) de espera por umbral en los ring buffers antes de revisar las banderas de salida. */
+
+static double SWEEP_USABLE_FRACTION   = 0.75;      /**< Fracción central de cada salto que se conserva (evita el roll-off del filtro de banda base). */
+static double SWEEP_SETTLE_MS         = 2.0;       /**< Muestras descartadas tras cada salto mientras el PLL se estabiliza. */
+static size_t SWEEP_SETTLE_MIN_BYTES  = 1U << 20;  /**< Mínimo descartado por salto: transferencias USB en vuelo con la frecuencia anterior. */
+static int    SWEEP_MAX_HOPS          = 600;       /**< Límite de saltos por request (1 MHz a 6 GHz con 10 MHz de paso útil). */
+
+static double CAL_CACHE_MAX_AGE_S     = 6.0 * 3600.0; /**< Vigencia del PPM calibrado antes de repetir la calibración. */
+static double CAL_CACHE_MAX_DTEMP_C   = 5.0;       /**< Deriva térmica (°C) desde la última calibración que invalida el PPM en caché. */
+static double CAL_FAST_VALIDATE_S     = 0.1;       /**< Tramo de la captura que demodula cada candidata de referencia (búsqueda rápida). */
+static const char *CAL_TEMP_PATH      = "/sys/class/thermal/thermal_zone0/temp"; /**< Sensor (m°C) próximo al oscilador del HackRF. */
+
+static double RF_IDLE_STANDBY_S       = 15.0;      /**< Inactividad tras la que se detiene el RX y el HackRF queda en espera (abierto y configurado). */
+static double RF_IDLE_CLOSE_S         = 0.0;       /**< Inactividad tras la que se cierra el HackRF en espera (0 = no se cierra). */
+static double RF_STANDBY_PROBE_S      = 5.0;       /**< Periodo de la sonda de salud en espera; un request dentro del periodo no la repite. */
+static double GPS_TIME_REOPEN_S       = 1.0;       /**< Intervalo mínimo entre intentos de mapear el segmento de hora GPS mientras no exista. */
 
-/**
- * @name Comunicación y Manejadores de Hardware
- * Interfaces para mensajería de red y hardware físico SDR.
- * @{
- */
-zpair_t *zmq_channel = NULL;          /**< Par de sockets ZMQ para comando y control de red/IPC. */
-hackrf_device* device = NULL;         /**< Puntero a la instancia inicializada del hardware HackRF. */
 /** @} */
 
-/**
- * @name Sistema de Buffers
- * Buffers circulares utilizados para desacoplar el muestreo de hardware de alta velocidad de los hilos de procesamiento.
- * @{
- */
-ring_buffer_t rb;                     /**< Buffer circular primario para muestras IQ crudas del HackRF. */
-ring_buffer_t audio_rb;               /**< Buffer circular para muestras de audio demoduladas, listas para transmitir. */
-/** @} */
+#define RF_MAX_RADIOS 4 /**< HackRF simultáneos por proceso (un motor y su hilo cada uno). */
 
 /**
- * @name Estado Global e Hilos (Threading)
- * Banderas y primitivas que gestionan el flujo de ejecución y la seguridad entre hilos.
+ * @name Estado Global del Proceso
+ * Lo que comparten todos los motores; el estado de cada radio vive en @ref rf_engine_t.
  * @{
  */
-atomic_bool   audio_enabled = false;  /**< Bandera atómica que indica si el subsistema de audio está activo. */
-atomic_bool   calibration_running = false; /**< Indica calibración en curso para evitar cierre concurrente de HW. */
-volatile bool stop_streaming = true;  /**< Señal para detener la adquisición de datos del hardware. */
 volatile bool keep_running = true;    /**< Bandera maestra de salida para el bucle principal de la aplicación. */
-
-pthread_t       audio_thread;         /**< Identificador del hilo para la tarea de red/audio Opus. */
-volatile bool   audio_thread_running = false; /**< Bandera de estado para el ciclo de vida del hilo de audio. */
-
-pthread_cond_t  rb_cond  = PTHREAD_COND_INITIALIZER;
-pthread_mutex_t rb_mutex = PTHREAD_MUTEX_INITIALIZER;
-pthread_cond_t  audio_rb_cond  = PTHREAD_COND_INITIALIZER;
-pthread_mutex_t audio_rb_mutex = PTHREAD_MUTEX_INITIALIZER;
-
+rf_affinity_cfg_t g_affinity;         /**< Tamaño del pool OpenMP y núcleo/prioridad de la ruta de E/S (`.env`). */
 /** @} */
 
 /**
- * @name Estructuras de Configuración
- * Instantáneas de los ajustes deseados, de hardware y de procesamiento.
- * @{
+ * @brief Última configuración derivada, indexada por la huella del request que la produjo.
+ * @details Un request idéntico al activo reutiliza hack/psd/rb sin repetir @ref find_params_psd,
+ * el resumen de despliegue ni la conmutación de antena.
  */
-SDR_cfg_t    current_hw_cfg = {0};    /**< Estado actual real del hardware para comparaciones de sintonización optimizada. */
-/** @} */
+typedef struct {
+    bool valid;        /**< Hay una entrada almacenada. */
+    DesiredCfg_t key;  /**< Huella del request (ver @ref request_fingerprint). */
+    SDR_cfg_t hack;    /**< Configuración de hardware derivada. */
+    PsdConfig_t psd;   /**< Configuración PSD derivada. */
+    RB_cfg_t rb;       /**< Configuración de buffer derivada. */
+} rf_cfg_cache_t;
 
-static double g_request_cooldown_s = 1.0;
 #ifndef RF_DEBUG_LOGS
 #define RF_DEBUG_LOGS 0
 #endif
@@ -131,13 +148,12 @@ static double g_request_cooldown_s = 1.0;
 #endif
 
 int rx_callback(hackrf_transfer* transfer);
-static int cmp_double_asc(const void *a, const void *b);
 
 typedef struct {
-    int8_t *linear_buffer;
-    size_t linear_capacity_bytes;
     signal_iq_t sig;
     size_t sig_capacity_samples;
+    signal_iq_f32_t sig_f32;
+    size_t sig_f32_capacity_samples;
     double *freq;
     double *psd;
     int spectrum_capacity;
@@ -147,31 +163,132 @@ typedef struct {
     size_t aux_sig_capacity_samples;
     int16_t *pcm;
     size_t pcm_capacity_samples;
+    uint8_t *reply_bins;
+    size_t reply_bins_capacity_bytes;
+    double *sweep_psd;
+    size_t sweep_capacity_bins;
+    iq_zoom_t zoom;
+    psd_spectrogram_t spec;
+    json_writer_t jw;
+    rx_capture_meta_t cap;
 } rf_processing_workspace_t;
 
+/**
+ * @brief Motor de un HackRF: dispositivo, ring buffers, canal de control y estado de requests.
+ * @details rf_app crea uno por radio de `HACKRF_SERIALS`. El motor 0 corre en el hilo principal
+ * y cada uno de los demás en su propio hilo, con su equipo OpenMP (@ref rf_affinity_split), su
+ * socket de control y su hilo de audio. @ref rx_callback recibe el motor en `transfer->rx_ctx`,
+ * así que cada radio escribe solo en sus buffers.
+ */
+typedef struct rf_engine {
+    int id;                               /**< Índice del radio (0 = principal). */
+    char serial[SDR_SERIAL_LEN];          /**< Número de serie ("" = primer HackRF libre). */
+    char ipc_addr[512];                   /**< Endpoints ZMQ del canal de control. */
+    char pub_addr[256];                   /**< Endpoint PUB del modo streaming. */
+    char ppm_key[32];                     /**< Clave del ShmStore donde se guarda el PPM calibrado. */
+    rf_affinity_cfg_t affinity;           /**< Parte del equipo PSD de este motor. */
+    pthread_t thread;                     /**< Hilo del motor (no se usa en el motor 0). */
+    bool thread_started;                  /**< @ref thread pendiente de join. */
+
+    /** @name Hardware y adquisición */
+    /**@{*/
+    hackrf_device *device;                /**< HackRF abierto, o NULL. */
+    sdr_replay_t *replay;                 /**< Fuente SigMF (`--replay`, solo motor 0); sustituye al HackRF. */
+    SDR_cfg_t current_hw_cfg;             /**< Estado real del hardware para la sintonización perezosa. */
+    ring_buffer_t rb;                     /**< Ring de muestras IQ crudas del radio. */
+    ring_buffer_t audio_rb;               /**< Copia de las muestras para el hilo de audio. */
+    rx_timing_t rx_timing;                /**< Marcas por transferencia del ring principal (escribe @ref rx_callback). */
+    gps_time_shm_t *gps_time;             /**< Hora GPS publicada por gps-lte (se mapea al primer uso). */
+    uint64_t gps_time_retry_ns;           /**< Próximo intento de mapear @ref gps_time (reloj monotónico). */
+    volatile bool stop_streaming;         /**< @ref rx_callback descarta transferencias mientras esté activo. */
+    atomic_bool audio_enabled;            /**< El callback clona las muestras en @ref audio_rb. */
+    atomic_bool calibration_running;      /**< Calibración en curso: evita cerrar el HW por inactividad. */
+    bool standby;                         /**< RX detenido con @ref device abierto y @ref current_hw_cfg vigente. */
+    double standby_probe_s;               /**< Última sonda de salud correcta en espera (reloj monotónico, s). */
+    uint64_t standby_resumes;             /**< Requests atendidos reanudando desde la espera. */
+    bool recovery_pending;                /**< Reapertura fallida: la sonda ociosa la reintenta. */
+    SDR_cfg_t recovery_cfg;               /**< Configuración a reaplicar cuando la recuperación tenga éxito. */
+    pthread_t rx_pinned_thread;           /**< Último hilo USB fijado al núcleo de E/S (solo el callback). */
+    bool rx_pinned;                       /**< @ref rx_pinned_thread es válido. */
+    atomic_bool rx_pin_failed;            /**< El callback no pudo fijar su hilo; el motor lo registra una vez. */
+    bool rx_pin_logged;                   /**< El aviso de @ref rx_pin_failed ya se escribió. */
+    /**@}*/
+
+    /** @name Control y requests */
+    /**@{*/
+    zpair_t *zmq_channel;                 /**< Canal de comando y control. */
+    zpub_t *zmq_stream;                   /**< Socket PUB del streaming (se crea en el primer request "stream"). */
+    double request_cooldown_s;            /**< Cooldown vigente entre PSDs. */
+    rf_metrics_totals_t metrics;          /**< Acumulados por etapa. */
+    psd_avg_t psd_avg;                    /**< Traza promediada entre requests. */
+    rf_cfg_cache_t cfg_cache;             /**< Configuración derivada del último request. */
+    rf_processing_workspace_t proc_ws;    /**< Workspace de los requests. */
+    rf_processing_workspace_t stream_ws;  /**< Segundo workspace del pipeline de streaming. */
+    rf_processing_workspace_t calibration_ws; /**< Workspace de la calibración. */
+    float last_cal_ppm;                   /**< PPM suavizado de las calibraciones previas. */
+    bool has_last_cal_ppm;                /**< @ref last_cal_ppm es válido. */
+    double cal_refs_hz[RF_CAL_MAX_REFS];  /**< Portadoras FM de referencia de `CAL_FM_REFS`. */
+    int n_cal_refs;                       /**< Entradas de @ref cal_refs_hz. */
+    bool cal_cached;                      /**< Hay un PPM calibrado en caché (@ref cal_ppm). */
+    float cal_ppm;                        /**< Último PPM calibrado con éxito. */
+    double cal_unix_s;                    /**< Hora (Unix) de @ref cal_ppm. */
+    double cal_temp_c;                    /**< Temperatura al calibrar (NAN si no hay sensor). */
+    /**@}*/
+
+    /** @name Audio */
+    /**@{*/
+    audio_workspace_t audio_ws;           /**< Buffers y demoduladores del hilo de audio. */
+    audio_stream_ctx_t audio_ctx;         /**< Destino Opus, modo y métricas AM/FM. */
+    pthread_t audio_thread;               /**< Hilo de demodulación y envío Opus. */
+    bool audio_thread_created;            /**< @ref audio_thread pendiente de join. */
+    volatile bool audio_thread_running;   /**< Ciclo de vida del hilo de audio. */
+    atomic_uint_fast64_t audio_underruns; /**< Esperas del hilo de audio que vencieron sin un bloque IQ completo. */
+    atomic_uint_fast64_t audio_tx_dropped; /**< Paquetes Opus descartados porque la cola del emisor estaba llena. */
+    /**@}*/
+} rf_engine_t;
+
+static rf_engine_t g_engines[RF_MAX_RADIOS]; /**< Motores del proceso (solo los primeros @ref g_n_engines). */
+static int g_n_engines = 0;                  /**< Radios configurados. */
+
 static void rf_workspace_release(rf_processing_workspace_t *ws) {
     if (!ws) return;
-    free(ws->linear_buffer);
     free(ws->sig.signal_iq);
+    free(ws->sig_f32.signal_iq);
     free(ws->freq);
     free(ws->psd);
     free(ws->scratch);
     free(ws->aux_sig);
     free(ws->pcm);
+    free(ws->reply_bins);
+    free(ws->sweep_psd);
+    iq_zoom_free(&ws->zoom);
+    psd_spectrogram_free(&ws->spec);
+    jw_free(&ws->jw);
     memset(ws, 0, sizeof(*ws));
 }
 
-static int rf_workspace_ensure(rf_processing_workspace_t *ws, size_t iq_bytes, int nperseg) {
+static int rf_workspace_ensure_spectrum(rf_processing_workspace_t *ws, size_t iq_bytes, int nperseg) {
     if (!ws || iq_bytes == 0 || nperseg <= 0) return -1;
 
-    const size_t iq_samples = iq_bytes / 2U;
-    if (ws->linear_capacity_bytes < iq_bytes) {
-        int8_t *new_linear = (int8_t*)realloc(ws->linear_buffer, iq_bytes);
-        if (!new_linear) return -1;
-        ws->linear_buffer = new_linear;
-        ws->linear_capacity_bytes = iq_bytes;
+    if (ws->spectrum_capacity < nperseg) {
+        double *new_freq = (double*)realloc(ws->freq, (size_t)nperseg * sizeof(double));
+        if (!new_freq) return -1;
+        ws->freq = new_freq;
+
+        double *new_psd = (double*)realloc(ws->psd, (size_t)nperseg * sizeof(double));
+        if (!new_psd) return -1;
+        ws->psd = new_psd;
+
+        ws->spectrum_capacity = nperseg;
     }
 
+    return 0;
+}
+
+static int rf_workspace_ensure(rf_processing_workspace_t *ws, size_t iq_bytes, int nperseg) {
+    if (rf_workspace_ensure_spectrum(ws, iq_bytes, nperseg) != 0) return -1;
+
+    const size_t iq_samples = iq_bytes / 2U;
     if (ws->sig_capacity_samples < iq_samples) {
         double complex *new_sig = (double complex*)realloc(ws->sig.signal_iq, iq_samples * sizeof(double complex));
         if (!new_sig) return -1;
@@ -180,17 +297,20 @@ static int rf_workspace_ensure(rf_processing_workspace_t *ws, size_t iq_bytes, i
     }
     ws->sig.n_signal = iq_samples;
 
-    if (ws->spectrum_capacity < nperseg) {
-        double *new_freq = (double*)realloc(ws->freq, (size_t)nperseg * sizeof(double));
-        if (!new_freq) return -1;
-        ws->freq = new_freq;
+    return 0;
+}
 
-        double *new_psd = (double*)realloc(ws->psd, (size_t)nperseg * sizeof(double));
-        if (!new_psd) return -1;
-        ws->psd = new_psd;
+static int rf_workspace_ensure_f32(rf_processing_workspace_t *ws, size_t iq_bytes, int nperseg) {
+    if (rf_workspace_ensure_spectrum(ws, iq_bytes, nperseg) != 0) return -1;
 
-        ws->spectrum_capacity = nperseg;
+    const size_t iq_samples = iq_bytes / 2U;
+    if (ws->sig_f32_capacity_samples < iq_samples) {
+        float complex *new_sig = (float complex*)realloc(ws->sig_f32.signal_iq, iq_samples * sizeof(float complex));
+        if (!new_sig) return -1;
+        ws->sig_f32.signal_iq = new_sig;
+        ws->sig_f32_capacity_samples = iq_samples;
     }
+    ws->sig_f32.n_signal = iq_samples;
 
     return 0;
 }
@@ -228,15 +348,115 @@ static int rf_workspace_ensure_pcm(rf_processing_workspace_t *ws, size_t samples
     return 0;
 }
 
+static int rf_workspace_ensure_reply_bins(rf_processing_workspace_t *ws, size_t bytes) {
+    if (!ws || bytes == 0) return -1;
+    if (ws->reply_bins_capacity_bytes < bytes) {
+        uint8_t *new_bins = (uint8_t*)realloc(ws->reply_bins, bytes);
+        if (!new_bins) return -1;
+        ws->reply_bins = new_bins;
+        ws->reply_bins_capacity_bytes = bytes;
+    }
+    return 0;
+}
+
+static int rf_workspace_ensure_sweep(rf_processing_workspace_t *ws, size_t bins) {
+    if (!ws || bins == 0) return -1;
+    if (ws->sweep_capacity_bins < bins) {
+        double *new_sweep = (double*)realloc(ws->sweep_psd, bins * sizeof(double));
+        if (!new_sweep) return -1;
+        ws->sweep_psd = new_sweep;
+        ws->sweep_capacity_bins = bins;
+    }
+    return 0;
+}
+
 static double median_of_double_workspace(rf_processing_workspace_t *ws, const double *v, int n) {
     if (!ws || !v || n <= 0) return 0.0;
     if (rf_workspace_ensure_scratch(ws, (size_t)n) != 0) return 0.0;
     memcpy(ws->scratch, v, (size_t)n * sizeof(double));
-    qsort(ws->scratch, (size_t)n, sizeof(double), cmp_double_asc);
-    return (n & 1) ? ws->scratch[n / 2] : 0.5 * (ws->scratch[n / 2 - 1] + ws->scratch[n / 2]);
+    return psd_detect_median(ws->scratch, n);
+}
+
+/** @brief Temperatura de @ref CAL_TEMP_PATH en °C, o NAN si no hay sensor. */
+static double read_board_temp_c(void) {
+    FILE *f = fopen(CAL_TEMP_PATH, "r");
+    if (!f) return NAN;
+    long milli_c = 0;
+    const int ok = fscanf(f, "%ld", &milli_c) == 1;
+    fclose(f);
+    return ok ? (double)milli_c / 1000.0 : NAN;
+}
+
+/**
+ * @brief Indica si el PPM en caché del motor sigue vigente.
+ * @details Vigente mientras tenga menos de @ref CAL_CACHE_MAX_AGE_S y, si hay lectura de
+ * temperatura ahora y al calibrar, no se haya desplazado más de @ref CAL_CACHE_MAX_DTEMP_C.
+ * @param[out] age_s Antigüedad de la calibración en caché.
+ */
+static bool calibration_cache_fresh(const rf_engine_t *e, double temp_c, double *age_s) {
+    if (!e->cal_cached) return false;
+    *age_s = (double)time(NULL) - e->cal_unix_s;
+    if (*age_s < 0.0 || *age_s > CAL_CACHE_MAX_AGE_S) return false;
+    if (isfinite(temp_c) && isfinite(e->cal_temp_c) && fabs(temp_c - e->cal_temp_c) > CAL_CACHE_MAX_DTEMP_C) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Recupera del ShmStore la última calibración (`<ppm_key>`, `_unix_s`, `_temp_c`).
+ * @details También siembra el PPM suavizado, de modo que la búsqueda fina arranca en una
+ * ventana estrecha alrededor del valor previo.
+ */
+static void calibration_cache_load(rf_engine_t *e) {
+    char key[64];
+    char *ppm = shm_consult_persistent(e->ppm_key);
+    snprintf(key, sizeof(key), "%s_unix_s", e->ppm_key);
+    char *unix_s = shm_consult_persistent(key);
+    snprintf(key, sizeof(key), "%s_temp_c", e->ppm_key);
+    char *temp_c = shm_consult_persistent(key);
+
+    const float v = ppm ? strtof(ppm, NULL) : 0.0f;
+    if (v != 0.0f && unix_s) {
+        e->cal_cached = true;
+        e->cal_ppm = v;
+        e->cal_unix_s = strtod(unix_s, NULL);
+        e->cal_temp_c = temp_c ? strtod(temp_c, NULL) : NAN;
+        e->last_cal_ppm = v;
+        e->has_last_cal_ppm = true;
+        printf("[RF] Radio %d: cached calibration %.3f ppm from %.0f s ago\n", e->id, (double)v,
+               (double)time(NULL) - e->cal_unix_s);
+    }
+    free(ppm);
+    free(unix_s);
+    free(temp_c);
+}
+
+/**
+ * @brief Portadoras de referencia para la calibración rápida.
+ * @details En orden: `cal_refs_hz` del request, `CAL_FM_REFS` del `.env` y `legal_freqs` del
+ * ShmStore (las emisoras legales que cachea `kal_sync_legal_FM.py`, en MHz).
+ * @param[out] buf Almacenamiento para la lista del ShmStore.
+ * @param[out] refs Lista elegida.
+ * @return Entradas de @p refs (0 = sin referencias, barrido completo).
+ */
+static int calibration_refs(const rf_engine_t *e, const DesiredCfg_t *d, double *buf, const double **refs) {
+    if (d->n_cal_refs > 0) {
+        *refs = d->cal_refs_hz;
+        return d->n_cal_refs;
+    }
+    if (e->n_cal_refs > 0) {
+        *refs = e->cal_refs_hz;
+        return e->n_cal_refs;
+    }
+    char *legal = shm_consult_persistent("legal_freqs");
+    const int n = fm_cal_parse_refs(legal, buf, RF_CAL_MAX_REFS);
+    free(legal);
+    *refs = buf;
+    return n;
 }
 
-static inline float calibration_finish(float final_ppm) {
+static inline float calibration_finish(rf_engine_t *e, float final_ppm) {
     printf("final_ppm = %.3f\n", final_ppm);
     printf("calibration done\n");
     
@@ -244,88 +464,101 @@ static inline float calibration_finish(float final_ppm) {
     if (final_ppm != 0.0f) {
         char ppm_str[64];
         snprintf(ppm_str, sizeof(ppm_str), "%.6f", (double)final_ppm);
-        if (shm_add_to_persistent("ppm_error", ppm_str) == 0) {
-            printf("[SHM] ppm_error guardado en ShmStore: %.6f\n", final_ppm);
+        if (shm_add_to_persistent(e->ppm_key, ppm_str) == 0) {
+            printf("[SHM] %s guardado en ShmStore: %.6f\n", e->ppm_key, final_ppm);
         } else {
             printf("[SHM] Error guardando ppm_error en ShmStore\n");
         }
+
+        // Timestamp and temperature let later requests reuse this value until it drifts
+        e->cal_cached = true;
+        e->cal_ppm = final_ppm;
+        e->cal_unix_s = (double)time(NULL);
+        e->cal_temp_c = read_board_temp_c();
+        char key[64];
+        snprintf(key, sizeof(key), "%s_unix_s", e->ppm_key);
+        snprintf(ppm_str, sizeof(ppm_str), "%.0f", e->cal_unix_s);
+        (void)shm_add_to_persistent(key, ppm_str);
+        snprintf(key, sizeof(key), "%s_temp_c", e->ppm_key);
+        snprintf(ppm_str, sizeof(ppm_str), "%.1f", e->cal_temp_c);
+        (void)shm_add_to_persistent(key, ppm_str);
     } else {
         printf("[SHM] Calibración falló (ppm=0.0), no se guarda en ShmStore\n");
     }
     
-    atomic_store(&calibration_running, false);
+    atomic_store(&e->calibration_running, false);
     return final_ppm;
 }
 
-static int cmp_double_asc(const void *a, const void *b) {
-    double x = *(const double*)a;
-    double y = *(const double*)b;
-    return (x < y) ? -1 : (x > y);
+/** @brief Interpolación lineal sobre una grilla uniforme \f$ x_i = x_0 + i \, dx \f$ (sin búsqueda). */
+static double interp_uniform(const double *y, int n, double x0, double dx, double xq) {
+    if (!y || n <= 0 || !(dx > 0.0)) return 0.0;
+    const double t = (xq - x0) / dx;
+    if (t <= 0.0) return y[0];
+    if (t >= (double)(n - 1)) return y[n - 1];
+    const int lo = (int)t;
+    const double frac = t - (double)lo;
+    return y[lo] + frac * (y[lo + 1] - y[lo]);
 }
 
-static double interp_linear(const double *x, const double *y, int n, double xq) {
-    if (!x || !y || n <= 0) return 0.0;
-    if (xq <= x[0]) return y[0];
-    if (xq >= x[n - 1]) return y[n - 1];
-
-    int lo = 0;
-    int hi = n - 1;
-    while (hi - lo > 1) {
-        int mid = lo + (hi - lo) / 2;
-        if (x[mid] <= xq) lo = mid;
-        else hi = mid;
-    }
-
-    double x0 = x[lo], x1 = x[hi];
-    double y0 = y[lo], y1 = y[hi];
-    double t = (xq - x0) / (x1 - x0 + 1e-20);
-    return y0 + t * (y1 - y0);
+/** @brief Reloj monotónico en segundos. */
+static inline double monotonic_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
 }
 
-static float g_last_cal_ppm = 0.0f;
-static int g_has_last_cal_ppm = 0;
-static rf_processing_workspace_t g_calibration_ws = {0};
-
-static void invalidate_hackrf_state(const char *reason) {
+static void invalidate_hackrf_state(rf_engine_t *e, const char *reason) {
     if (reason && reason[0] != '\0') {
         fprintf(stderr, "[RF] Invalidating HackRF state: %s\n", reason);
     }
 
-    stop_streaming = true;
+    e->stop_streaming = true;
+    e->standby = false;
 
-    if (device != NULL) {
-        int stream_state = hackrf_is_streaming(device);
+    if (e->replay) sdr_replay_stop_rx(e->replay);
+
+    if (e->device != NULL) {
+        int stream_state = hackrf_is_streaming(e->device);
         if (stream_state == HACKRF_TRUE) {
-            (void)hackrf_stop_rx(device);
+            (void)hackrf_stop_rx(e->device);
             usleep(100000);
         }
-        (void)hackrf_close(device);
-        device = NULL;
+        (void)hackrf_close(e->device);
+        e->device = NULL;
     }
 
-    memset(&current_hw_cfg, 0, sizeof(SDR_cfg_t));
-    rb_reset(&rb);
-    rb_reset(&audio_rb);
+    memset(&e->current_hw_cfg, 0, sizeof(SDR_cfg_t));
+    rb_reset(&e->rb);
+    rb_reset(&e->audio_rb);
+    rx_timing_reset(&e->rx_timing, 0.0);
 }
 
-static int ensure_hackrf_session_is_healthy(void) {
-    if (device == NULL) return 0;
+static int ensure_hackrf_session_is_healthy(rf_engine_t *e) {
+    if (e->replay) {
+        // End of a non-looping recording: the next start_rx replays it from the start
+        if (!e->stop_streaming && !sdr_replay_is_streaming(e->replay)) invalidate_hackrf_state(e, "replay_ended");
+        return 0;
+    }
+    if (e->device == NULL) return 0;
+    // The standby probe already vouched for the device recently
+    if (e->standby && monotonic_s() - e->standby_probe_s < RF_STANDBY_PROBE_S) return 0;
 
     uint8_t board_id = BOARD_ID_UNDETECTED;
-    int rc = hackrf_board_id_read(device, &board_id);
+    int rc = hackrf_board_id_read(e->device, &board_id);
     if (rc != HACKRF_SUCCESS) {
         fprintf(stderr, "[RF] HackRF health check failed: %s\n",
                 hackrf_error_name((enum hackrf_error)rc));
-        invalidate_hackrf_state("board_id_read_failed");
+        invalidate_hackrf_state(e, "board_id_read_failed");
         return -1;
     }
 
-    if (!stop_streaming) {
-        int stream_state = hackrf_is_streaming(device);
+    if (!e->stop_streaming) {
+        int stream_state = hackrf_is_streaming(e->device);
         if (stream_state != HACKRF_TRUE) {
             fprintf(stderr, "[RF] HackRF streaming lost: %s\n",
                     hackrf_error_name((enum hackrf_error)stream_state));
-            invalidate_hackrf_state("streaming_stopped");
+            invalidate_hackrf_state(e, "streaming_stopped");
             return -1;
         }
     }
@@ -333,30 +566,116 @@ static int ensure_hackrf_session_is_healthy(void) {
     return 0;
 }
 
+/**
+ * @brief Pasa el HackRF a espera: detiene el RX y apaga el amplificador sin cerrar el dispositivo.
+ * @details @ref rf_engine_t::current_hw_cfg se conserva, de modo que un request con la misma
+ * configuración reanuda solo con `hackrf_start_rx` (sin abrir, sintonizar ni esperar al PLL).
+ */
+static void hackrf_enter_standby(rf_engine_t *e) {
+    e->stop_streaming = true;
+    if (hackrf_is_streaming(e->device) == HACKRF_TRUE) (void)hackrf_stop_rx(e->device);
+    (void)hackrf_set_amp_enable(e->device, 0);
+
+    rb_reset(&e->rb);
+    rb_reset(&e->audio_rb);
+    rx_timing_reset(&e->rx_timing, e->current_hw_cfg.sample_rate);
+    e->standby = true;
+    e->standby_probe_s = monotonic_s();
+    printf("[RF] Radio %d in standby (RX stopped, %" PRIu64 " Hz kept)\n", e->id, e->current_hw_cfg.center_freq);
+}
+
+/** @brief Sale de la espera restaurando el amplificador de la configuración en caché. */
+static void hackrf_leave_standby(rf_engine_t *e) {
+    if (!e->standby) return;
+    if (e->device && e->current_hw_cfg.amp_enabled) (void)hackrf_set_amp_enable(e->device, 1);
+    e->standby = false;
+}
+
+
+/**
+ * @brief Espera hasta que el ring buffer principal acumule al menos @p need bytes.
+ * @details Usa el despertar por umbral de @ref rb_wait_available (sin mutex en
+ * @ref rx_callback), en tramos cortos para reaccionar a @ref keep_running y atender
+ * el canal de control con @ref zpair_service entre tramos.
+ * @param[in] need Bytes requeridos.
+ * @param[in] timeout_s Tiempo máximo de espera en segundos.
+ * @return true si los datos están disponibles, false si venció el timeout o se pidió salir.
+ */
+static bool wait_for_rb_bytes(rf_engine_t *e, size_t need, int timeout_s) {
+    int left_ms = timeout_s * 1000;
+    while (keep_running && left_ms > 0) {
+        const int slice = (left_ms < RB_WAIT_SLICE_MS) ? left_ms : RB_WAIT_SLICE_MS;
+        if (rb_wait_available(&e->rb, need, slice)) return true;
+        // Other clients get status/metrics answers (and queue or coalesce) while we wait
+        if (e->zmq_channel) zpair_service(e->zmq_channel);
+        left_ms -= slice;
+    }
+    return rb_available(&e->rb) >= need;
+}
+
+/**
+ * @brief Arranca la RX desde el HackRF o desde la grabación de @ref rf_engine_t::replay.
+ * @return 0 en éxito, -1 si falló.
+ */
+static int source_start_rx(rf_engine_t *e) {
+    if (e->replay) return sdr_replay_start_rx(e->replay, rx_callback, e);
+    return (hackrf_start_rx(e->device, rx_callback, e) == HACKRF_SUCCESS) ? 0 : -1;
+}
+
+/**
+ * @brief Graba como SigMF los próximos @p total_bytes del ring buffer sin consumirlos.
+ * @param[in] hack Configuración de adquisición de la captura.
+ * @param[in] total_bytes Bytes de la captura del request.
+ * @param[out] out_base Ruta base escrita, o cadena vacía si falló.
+ * @param[in] out_len Capacidad de @p out_base.
+ * @return 0 en éxito, -1 si falló (el request sigue sin grabación).
+ */
+static int record_capture(rf_engine_t *e, const SDR_cfg_t *hack, size_t total_bytes, char *out_base, size_t out_len) {
+    out_base[0] = '\0';
+    rb_regions_t regions;
+    if (rb_peek_regions(&e->rb, total_bytes, &regions) < total_bytes) return -1;
+
+    const uint8_t *const spans[2] = { regions.ptr[0], regions.ptr[1] };
+    if (iq_record_write(NULL, hack, spans, regions.len, out_base, out_len) != 0) {
+        out_base[0] = '\0';
+        return -1;
+    }
+    printf("[RF] Recorded %zu bytes to %s.sigmf-data\n", total_bytes, out_base);
+    return 0;
+}
 
-static float calibrate_hackrf(void) {
+/**
+ * @brief Estima el error del oscilador en PPM sobre emisoras FM con piloto estéreo.
+ * @details Con portadoras de referencia (@p refs) las candidatas salen de @ref fm_cal_rank_refs
+ * y cada una se valida sobre @ref CAL_FAST_VALIDATE_S de la captura; sin referencias, o si
+ * ninguna supera el piso, se usa el barrido Welch de toda la banda.
+ * @param refs Portadoras absolutas (Hz), o NULL.
+ * @param n_refs Entradas de @p refs.
+ * @return PPM estimado (0 si falló).
+ */
+static float calibrate_hackrf(rf_engine_t *e, const double *refs, int n_refs) {
     float final_ppm = 0.0f;
     RF_TRACE("calibrating\n");
     RF_TRACE("[CALDBG] enter calibrate_hackrf\n");
 
-    if (atomic_exchange(&calibration_running, true)) {
+    if (atomic_exchange(&e->calibration_running, true)) {
         RF_TRACE("[CALDBG] calibration already running, skipping\n");
-        return calibration_finish(final_ppm);
+        return calibration_finish(e, final_ppm);
     }
 
-    if (!stop_streaming) {
+    if (!e->stop_streaming) {
         RF_TRACE("[CALDBG] stop_streaming=false, RX busy, skipping calibration\n");
-        return calibration_finish(final_ppm);
+        return calibration_finish(e, final_ppm);
     }
 
-    if (device == NULL) {
+    if (e->device == NULL) {
         RF_TRACE("[CALDBG] device is NULL, opening HackRF\n");
-        if (hackrf_open(&device) != HACKRF_SUCCESS) {
+        if (sdr_hackrf_open(e->serial, &e->device) != HACKRF_SUCCESS) {
             RF_TRACE("[CALDBG] hackrf_open failed\n");
-            return calibration_finish(final_ppm);
+            return calibration_finish(e, final_ppm);
         }
 
-        SDR_cfg_t cfg_to_apply = current_hw_cfg;
+        SDR_cfg_t cfg_to_apply = e->current_hw_cfg;
         if (cfg_to_apply.center_freq == 0 || cfg_to_apply.sample_rate <= 0.0) {
             cfg_to_apply.center_freq = 98000000ULL;
             cfg_to_apply.sample_rate = 20000000.0;
@@ -367,13 +686,14 @@ static float calibrate_hackrf(void) {
             RF_TRACE("[CALDBG] applying default cfg for calibration\n");
         }
 
-        hackrf_apply_cfg(device, &cfg_to_apply);
-        memcpy(&current_hw_cfg, &cfg_to_apply, sizeof(SDR_cfg_t));
+        hackrf_apply_cfg(e->device, &cfg_to_apply);
+        memcpy(&e->current_hw_cfg, &cfg_to_apply, sizeof(SDR_cfg_t));
     }
+    hackrf_leave_standby(e);
 
-    const double fs = (current_hw_cfg.sample_rate > 0.0) ? current_hw_cfg.sample_rate : 20000000.0;
-    const uint64_t fc = (current_hw_cfg.center_freq > 0) ? current_hw_cfg.center_freq : 98000000ULL;
-    RF_TRACE("[CALDBG] using fs=%.3f Hz fc=%" PRIu64 " Hz ppm=%.6f\n", fs, fc, current_hw_cfg.ppm_error);
+    const double fs = (e->current_hw_cfg.sample_rate > 0.0) ? e->current_hw_cfg.sample_rate : 20000000.0;
+    const uint64_t fc = (e->current_hw_cfg.center_freq > 0) ? e->current_hw_cfg.center_freq : 98000000ULL;
+    RF_TRACE("[CALDBG] using fs=%.3f Hz fc=%" PRIu64 " Hz ppm=%.6f\n", fs, fc, e->current_hw_cfg.ppm_error);
 
     size_t iq_samples = (size_t)(fs * 0.5); // ~0.5 s (balance entre robustez y memoria)
     if (iq_samples < 262144U) iq_samples = 262144U;
@@ -381,116 +701,105 @@ static float calibrate_hackrf(void) {
     const size_t iq_bytes = iq_samples * 2U;
     RF_TRACE("[CALDBG] capture plan: iq_samples=%zu iq_bytes=%zu\n", iq_samples, iq_bytes);
 
-    rb_reset(&rb);
-    stop_streaming = false;
+    rb_reset(&e->rb);
+    rx_timing_reset(&e->rx_timing, fs);
+    e->stop_streaming = false;
     RF_TRACE("[CALDBG] starting RX for calibration\n");
-    if (hackrf_start_rx(device, rx_callback, NULL) != HACKRF_SUCCESS) {
-        stop_streaming = true;
+    if (hackrf_start_rx(e->device, rx_callback, e) != HACKRF_SUCCESS) {
+        e->stop_streaming = true;
         RF_TRACE("[CALDBG] hackrf_start_rx failed\n");
-        return calibration_finish(final_ppm);
+        return calibration_finish(e, final_ppm);
     }
 
-    struct timespec ts_timeout;
-    clock_gettime(CLOCK_REALTIME, &ts_timeout);
-    ts_timeout.tv_sec += 6;
+    wait_for_rb_bytes(e, iq_bytes, 6);
+    RF_TRACE("[CALDBG] rb_available after wait=%zu\n", rb_available(&e->rb));
 
-    pthread_mutex_lock(&rb_mutex);
-    while (keep_running && rb_available(&rb) < iq_bytes) {
-        int rc = pthread_cond_timedwait(&rb_cond, &rb_mutex, &ts_timeout);
-        if (rc == ETIMEDOUT) break;
-    }
-    pthread_mutex_unlock(&rb_mutex);
-    RF_TRACE("[CALDBG] rb_available after wait=%zu\n", rb_available(&rb));
-
-    if (rb_available(&rb) < iq_bytes) {
-        stop_streaming = true;
-        hackrf_stop_rx(device);
+    if (rb_available(&e->rb) < iq_bytes) {
+        e->stop_streaming = true;
+        hackrf_stop_rx(e->device);
         RF_TRACE("[CALDBG] insufficient IQ bytes, timeout path\n");
-        return calibration_finish(final_ppm);
+        return calibration_finish(e, final_ppm);
     }
 
-    if (rf_workspace_ensure(&g_calibration_ws, iq_bytes, 65536) != 0) {
-        stop_streaming = true;
-        hackrf_stop_rx(device);
+    if (rf_workspace_ensure(&e->calibration_ws, iq_bytes, 65536) != 0) {
+        e->stop_streaming = true;
+        hackrf_stop_rx(e->device);
         RF_TRACE("[CALDBG] calibration workspace allocation failed\n");
-        return calibration_finish(final_ppm);
+        return calibration_finish(e, final_ppm);
     }
 
-    rb_read(&rb, g_calibration_ws.linear_buffer, iq_bytes);
-    stop_streaming = true;
-    hackrf_stop_rx(device);
+    e->stop_streaming = true;
+    hackrf_stop_rx(e->device);
+
+    rb_regions_t cal_regions;
+    rb_peek_regions(&e->rb, iq_bytes, &cal_regions);
+    const int8_t *cal_spans[2] = { (const int8_t*)cal_regions.ptr[0], (const int8_t*)cal_regions.ptr[1] };
+    iq_moments_t cal_stats;
+    int cal_load_rc = load_iq_spans_into_signal_stats(cal_spans, cal_regions.len, &e->calibration_ws.sig, &cal_stats);
+    rb_commit_read(&e->rb, iq_bytes);
     RF_TRACE("[CALDBG] read IQ buffer and stopped RX\n");
 
-    if (load_iq_into_signal(g_calibration_ws.linear_buffer, iq_bytes, &g_calibration_ws.sig) != 0 ||
-        !g_calibration_ws.sig.signal_iq || g_calibration_ws.sig.n_signal < 4096) {
+    if (cal_load_rc != 0 ||
+        !e->calibration_ws.sig.signal_iq || e->calibration_ws.sig.n_signal < 4096) {
         RF_TRACE("[CALDBG] load_iq_into_signal failed or n_signal too small\n");
-        return calibration_finish(final_ppm);
+        return calibration_finish(e, final_ppm);
     }
-    RF_TRACE("[CALDBG] IQ loaded: n_signal=%zu\n", g_calibration_ws.sig.n_signal);
+    RF_TRACE("[CALDBG] IQ loaded: n_signal=%zu\n", e->calibration_ws.sig.n_signal);
 
-    iq_compensation(&g_calibration_ws.sig);
+    iq_compensation_apply(&e->calibration_ws.sig, &cal_stats);
     RF_TRACE("[CALDBG] iq_compensation done\n");
 
-    PsdConfig_t sweep_cfg = {0};
-    int nperseg = 65536;
-    while ((size_t)nperseg > g_calibration_ws.sig.n_signal && nperseg > 2048) nperseg >>= 1;
-    sweep_cfg.nperseg = nperseg;
-    sweep_cfg.noverlap = nperseg / 2;
-    sweep_cfg.sample_rate = fs;
-    sweep_cfg.window_type = HAMMING_TYPE;
-
-    if (rf_workspace_ensure(&g_calibration_ws, iq_bytes, nperseg) != 0) {
-        return calibration_finish(final_ppm);
-    }
-    execute_welch_psd(&g_calibration_ws.sig, &sweep_cfg, g_calibration_ws.freq, g_calibration_ws.psd);
-    RF_TRACE("[CALDBG] sweep welch done nperseg=%d\n", nperseg);
-
-    double sweep_median_db = median_of_double_workspace(&g_calibration_ws, g_calibration_ws.psd, nperseg);
-    double sweep_thresh_db = sweep_median_db + 5.0;
-    RF_TRACE("[CALDBG] sweep median=%.3f dB threshold=%.3f dB\n", sweep_median_db, sweep_thresh_db);
-
-    int top_idx[6] = {-1, -1, -1, -1, -1, -1};
-    double top_pow[6] = {-1e300, -1e300, -1e300, -1e300, -1e300, -1e300};
-    int min_peak_dist = (int)llround(300.0 * ((double)nperseg / 65536.0));
-    if (min_peak_dist < 8) min_peak_dist = 8;
-
-    for (int i = 1; i < nperseg - 1; ++i) {
-        if (g_calibration_ws.psd[i] < sweep_thresh_db) continue;
-        if (!(g_calibration_ws.psd[i] > g_calibration_ws.psd[i - 1] && g_calibration_ws.psd[i] >= g_calibration_ws.psd[i + 1])) continue;
-
-        int too_close = 0;
-        for (int k = 0; k < 6; ++k) {
-            if (top_idx[k] >= 0 && abs(i - top_idx[k]) < min_peak_dist) {
-                too_close = 1;
-                break;
-            }
+    // Candidates: Goertzel on the reference carriers when there are any, else a full-band sweep
+    int n_cand = 0;
+    double cand_off[6];
+    double cand_pow[6];
+    if (n_refs > 0) {
+        fm_cal_cand_t ref_cand[6];
+        n_cand = fm_cal_rank_refs(&e->calibration_ws.sig, fs, (double)fc, refs, n_refs, 5.0, 6, ref_cand);
+        for (int c = 0; c < n_cand; ++c) {
+            cand_off[c] = ref_cand[c].offset_hz;
+            cand_pow[c] = ref_cand[c].power_db;
         }
-        if (too_close) continue;
-
-        int pos = -1;
-        for (int k = 0; k < 6; ++k) {
-            if (g_calibration_ws.psd[i] > top_pow[k]) {
-                pos = k;
-                break;
-            }
+        RF_TRACE("[CALDBG] reference carriers above floor: %d of %d\n", n_cand, n_refs);
+    }
+    const bool fast = n_cand > 0;
+
+    if (!fast) {
+        PsdConfig_t sweep_cfg = {0};
+        int nperseg = 65536;
+        while ((size_t)nperseg > e->calibration_ws.sig.n_signal && nperseg > 2048) nperseg >>= 1;
+        sweep_cfg.nperseg = nperseg;
+        sweep_cfg.noverlap = nperseg / 2;
+        sweep_cfg.sample_rate = fs;
+        sweep_cfg.window_type = HAMMING_TYPE;
+
+        if (rf_workspace_ensure(&e->calibration_ws, iq_bytes, nperseg) != 0) {
+            return calibration_finish(e, final_ppm);
         }
-        if (pos >= 0) {
-            for (int m = 5; m > pos; --m) {
-                top_pow[m] = top_pow[m - 1];
-                top_idx[m] = top_idx[m - 1];
-            }
-            top_pow[pos] = g_calibration_ws.psd[i];
-            top_idx[pos] = i;
+        execute_welch_psd(&e->calibration_ws.sig, &sweep_cfg, e->calibration_ws.freq, e->calibration_ws.psd);
+        RF_TRACE("[CALDBG] sweep welch done nperseg=%d\n", nperseg);
+
+        double sweep_median_db = median_of_double_workspace(&e->calibration_ws, e->calibration_ws.psd, nperseg);
+        double sweep_thresh_db = sweep_median_db + 5.0;
+        RF_TRACE("[CALDBG] sweep median=%.3f dB threshold=%.3f dB\n", sweep_median_db, sweep_thresh_db);
+
+        int top_idx[6];
+        double top_pow[6];
+        int min_peak_dist = (int)llround(300.0 * ((double)nperseg / 65536.0));
+        if (min_peak_dist < 8) min_peak_dist = 8;
+        (void)psd_detect_peaks(e->calibration_ws.psd, nperseg, sweep_thresh_db, min_peak_dist, 6, top_idx, top_pow);
+
+        // Offsets are kept apart: the pilot check below reuses the workspace frequency axis
+        for (int c = 0; c < 6; ++c) {
+            if (top_idx[c] < 0) continue;
+            cand_off[n_cand] = e->calibration_ws.freq[top_idx[c]];
+            cand_pow[n_cand] = top_pow[c];
+            n_cand++;
         }
     }
 
-    for (int c = 0; c < 6; ++c) {
-        if (top_idx[c] >= 0) {
-            RF_TRACE("[CALDBG] cand[%d]: idx=%d f=%.3fHz p=%.3fdB\n",
-                     c, top_idx[c], (double)fc + g_calibration_ws.freq[top_idx[c]], top_pow[c]);
-        } else {
-            RF_TRACE("[CALDBG] cand[%d]: none\n", c);
-        }
+    for (int c = 0; c < n_cand; ++c) {
+        RF_TRACE("[CALDBG] cand[%d]: f=%.3fHz p=%.3fdB\n", c, (double)fc + cand_off[c], cand_pow[c]);
     }
 
     int best_k = -1;
@@ -499,33 +808,25 @@ static float calibrate_hackrf(void) {
     double best_sweep = -1e300;
 
     double strongest_sweep = -1e300;
-    for (int c = 0; c < 6; ++c) {
-        if (top_idx[c] >= 0 && top_pow[c] > strongest_sweep) strongest_sweep = top_pow[c];
+    for (int c = 0; c < n_cand; ++c) {
+        if (cand_pow[c] > strongest_sweep) strongest_sweep = cand_pow[c];
     }
     const double sweep_gate_db = 8.0; // descarta candidatos muy débiles respecto al más fuerte
     RF_TRACE("[CALDBG] strongest_sweep=%.3f dB gate=%.3f dB\n", strongest_sweep, sweep_gate_db);
 
-    for (int c = 0; c < 6; ++c) {
-        if (top_idx[c] < 0) continue;
+    // Known carriers only need a short stretch to show the stereo pilot
+    size_t n_val = e->calibration_ws.sig.n_signal;
+    if (fast && (double)n_val > fs * CAL_FAST_VALIDATE_S) n_val = (size_t)(fs * CAL_FAST_VALIDATE_S);
 
-        double cand_freq = (double)fc + g_calibration_ws.freq[top_idx[c]];
-        double offset_hz = cand_freq - (double)fc;
+    for (int c = 0; c < n_cand; ++c) {
+        double offset_hz = cand_off[c];
 
-        if (rf_workspace_ensure_aux_sig(&g_calibration_ws, g_calibration_ws.sig.n_signal) != 0) continue;
+        if (rf_workspace_ensure_aux_sig(&e->calibration_ws, n_val) != 0) continue;
         signal_iq_t cand_sig = {
-            .n_signal = g_calibration_ws.sig.n_signal,
-            .signal_iq = g_calibration_ws.aux_sig
+            .n_signal = n_val,
+            .signal_iq = e->calibration_ws.aux_sig
         };
-
-        double phase = 0.0;
-        double dphi = -2.0 * M_PI * (offset_hz / fs);
-        for (size_t n = 0; n < g_calibration_ws.sig.n_signal; ++n) {
-            double complex rot = cos(phase) + I * sin(phase);
-            cand_sig.signal_iq[n] = g_calibration_ws.sig.signal_iq[n] * rot;
-            phase += dphi;
-            if (phase > M_PI) phase -= 2.0 * M_PI;
-            if (phase < -M_PI) phase += 2.0 * M_PI;
-        }
+        fm_cal_mix(e->calibration_ws.sig.signal_iq, cand_sig.signal_iq, n_val, offset_hz, fs);
 
         fm_radio_t fm = {0};
         const int cal_audio_fs = 200000;
@@ -534,25 +835,25 @@ static float calibrate_hackrf(void) {
         fm.enable_dc_block = 0;
         fm.gain = 4000.0f;
 
-        if (rf_workspace_ensure_pcm(&g_calibration_ws, cand_sig.n_signal) != 0) continue;
+        if (rf_workspace_ensure_pcm(&e->calibration_ws, cand_sig.n_signal) != 0) continue;
 
-        int n_audio = fm_radio_iq_to_pcm(&fm, &cand_sig, g_calibration_ws.pcm, NULL, (int)llround(fs));
+        int n_audio = fm_radio_iq_to_pcm(&fm, &cand_sig, e->calibration_ws.pcm, NULL, (int)llround(fs));
         if (n_audio < 2048) {
             RF_TRACE("[CALDBG] cand[%d] rejected: n_audio=%d\n", c, n_audio);
             continue;
         }
-        RF_TRACE("[CALDBG] cand[%d] demod ok: n_audio=%d fs_audio_eff_pre=%.3f\n", c, n_audio, fs * ((double)n_audio / (double)g_calibration_ws.sig.n_signal));
+        RF_TRACE("[CALDBG] cand[%d] demod ok: n_audio=%d fs_audio_eff_pre=%.3f\n", c, n_audio, fs * ((double)n_audio / (double)n_val));
 
-        if (rf_workspace_ensure_aux_sig(&g_calibration_ws, (size_t)n_audio) != 0) continue;
+        if (rf_workspace_ensure_aux_sig(&e->calibration_ws, (size_t)n_audio) != 0) continue;
         signal_iq_t audio_sig = {
             .n_signal = (size_t)n_audio,
-            .signal_iq = g_calibration_ws.aux_sig
+            .signal_iq = e->calibration_ws.aux_sig
         };
         for (int n = 0; n < n_audio; ++n) {
-            audio_sig.signal_iq[n] = (double)g_calibration_ws.pcm[n] + I * 0.0;
+            audio_sig.signal_iq[n] = (double)e->calibration_ws.pcm[n] + I * 0.0;
         }
 
-        double fs_audio_eff = fs * ((double)n_audio / (double)g_calibration_ws.sig.n_signal);
+        double fs_audio_eff = fs * ((double)n_audio / (double)n_val);
         if (!(fs_audio_eff > 0.0)) fs_audio_eff = (double)cal_audio_fs;
 
         PsdConfig_t aud_cfg = {0};
@@ -563,30 +864,30 @@ static float calibrate_hackrf(void) {
         aud_cfg.sample_rate = fs_audio_eff;
         aud_cfg.window_type = HAMMING_TYPE;
 
-        if (rf_workspace_ensure(&g_calibration_ws, iq_bytes, aud_nperseg) != 0) {
+        if (rf_workspace_ensure(&e->calibration_ws, iq_bytes, aud_nperseg) != 0) {
             continue;
         }
 
-        execute_welch_psd(&audio_sig, &aud_cfg, g_calibration_ws.freq, g_calibration_ws.psd);
+        execute_welch_psd(&audio_sig, &aud_cfg, e->calibration_ws.freq, e->calibration_ws.psd);
 
         double max_lin = 0.0;
         double pilot_freq_hz = 0.0;
-        if (rf_workspace_ensure_scratch(&g_calibration_ws, (size_t)aud_nperseg) != 0) continue;
-        double *pilot_lin = g_calibration_ws.scratch;
+        if (rf_workspace_ensure_scratch(&e->calibration_ws, (size_t)aud_nperseg) != 0) continue;
+        double *pilot_lin = e->calibration_ws.scratch;
         int cnt_db = 0;
         for (int i = 0; i < aud_nperseg; ++i) {
-            if (g_calibration_ws.freq[i] >= 18000.0 && g_calibration_ws.freq[i] <= 20000.0) {
-                double plin = pow(10.0, g_calibration_ws.psd[i] / 10.0);
+            if (e->calibration_ws.freq[i] >= 18000.0 && e->calibration_ws.freq[i] <= 20000.0) {
+                double plin = pow(10.0, e->calibration_ws.psd[i] / 10.0);
                 pilot_lin[cnt_db] = plin;
                 if (plin > max_lin) {
                     max_lin = plin;
-                    pilot_freq_hz = g_calibration_ws.freq[i];
+                    pilot_freq_hz = e->calibration_ws.freq[i];
                 }
                 cnt_db++;
             }
         }
 
-        double median_lin = median_of_double_workspace(&g_calibration_ws, pilot_lin, cnt_db);
+        double median_lin = median_of_double_workspace(&e->calibration_ws, pilot_lin, cnt_db);
 
         double snr_db = -1e300;
         if (cnt_db > 0 && median_lin > 0.0 && max_lin > 0.0) {
@@ -594,55 +895,42 @@ static float calibrate_hackrf(void) {
         }
 
         int stereo = (snr_db > 8.0) ? 1 : 0;
-        int strong_enough = (top_pow[c] >= (strongest_sweep - sweep_gate_db)) ? 1 : 0;
+        int strong_enough = (cand_pow[c] >= (strongest_sweep - sweep_gate_db)) ? 1 : 0;
          RF_TRACE("[CALDBG] cand[%d] pilot: freq=%.3fHz bins=%d max_lin=%.6e med_lin=%.6e snr=%.3fdB stereo=%d\n",
              c, pilot_freq_hz, cnt_db, max_lin, median_lin, snr_db, stereo);
-        RF_TRACE("[CALDBG] cand[%d] sweep=%.3f strong_enough=%d\n", c, top_pow[c], strong_enough);
+        RF_TRACE("[CALDBG] cand[%d] sweep=%.3f strong_enough=%d\n", c, cand_pow[c], strong_enough);
 
         if (!strong_enough) {
             continue;
         }
 
         if ((stereo > best_stereo) ||
-            (stereo == best_stereo && top_pow[c] > best_sweep) ||
-            (stereo == best_stereo && fabs(top_pow[c] - best_sweep) < 1e-9 && snr_db > best_snr)) {
+            (stereo == best_stereo && cand_pow[c] > best_sweep) ||
+            (stereo == best_stereo && fabs(cand_pow[c] - best_sweep) < 1e-9 && snr_db > best_snr)) {
             best_stereo = stereo;
             best_snr = snr_db;
-            best_sweep = top_pow[c];
+            best_sweep = cand_pow[c];
             best_k = c;
             RF_TRACE("[CALDBG] cand[%d] is new best\n", c);
         }
     }
 
     RF_TRACE("[CALDBG] best_k=%d best_stereo=%d best_snr=%.3f best_sweep=%.3f\n", best_k, best_stereo, best_snr, best_sweep);
-    if (best_k >= 0 && top_idx[best_k] >= 0) {
-        double best_freq = (double)fc + g_calibration_ws.freq[top_idx[best_k]];
-        double best_offset = best_freq - (double)fc;
+    if (best_k >= 0) {
+        double best_offset = cand_off[best_k];
+        double best_freq = (double)fc + best_offset;
         RF_TRACE("[CALDBG] best_freq=%.3fHz best_offset=%.3fHz\n", best_freq, best_offset);
 
         int decim = 100;
-        size_t n_dec = g_calibration_ws.sig.n_signal / (size_t)decim;
+        size_t n_dec = e->calibration_ws.sig.n_signal / (size_t)decim;
         if (n_dec >= 4096) {
-            if (rf_workspace_ensure_aux_sig(&g_calibration_ws, n_dec) == 0) {
+            if (rf_workspace_ensure_aux_sig(&e->calibration_ws, n_dec) == 0) {
                 signal_iq_t bb_dec = {
                     .n_signal = n_dec,
-                    .signal_iq = g_calibration_ws.aux_sig
+                    .signal_iq = e->calibration_ws.aux_sig
                 };
-                double phase = 0.0;
-                double dphi = -2.0 * M_PI * (best_offset / fs);
-                size_t out = 0;
-                for (size_t i = 0; i + (size_t)decim <= g_calibration_ws.sig.n_signal; i += (size_t)decim) {
-                    double complex acc = 0.0 + I * 0.0;
-                    for (int m = 0; m < decim; ++m) {
-                        double complex rot = cos(phase) + I * sin(phase);
-                        acc += g_calibration_ws.sig.signal_iq[i + (size_t)m] * rot;
-                        phase += dphi;
-                        if (phase > M_PI) phase -= 2.0 * M_PI;
-                        if (phase < -M_PI) phase += 2.0 * M_PI;
-                    }
-                    bb_dec.signal_iq[out++] = acc / (double)decim;
-                }
-                bb_dec.n_signal = out;
+                bb_dec.n_signal = fm_cal_mix_decimate(e->calibration_ws.sig.signal_iq, e->calibration_ws.sig.n_signal,
+                                                      best_offset, fs, decim, bb_dec.signal_iq);
 
                 if (bb_dec.n_signal >= 4096) {
                     PsdConfig_t bb_cfg = {0};
@@ -653,16 +941,16 @@ static float calibrate_hackrf(void) {
                     bb_cfg.sample_rate = fs / (double)decim;
                     bb_cfg.window_type = HAMMING_TYPE;
 
-                    if (rf_workspace_ensure(&g_calibration_ws, iq_bytes, bb_nperseg) == 0 &&
-                        rf_workspace_ensure_scratch(&g_calibration_ws, (size_t)bb_nperseg) == 0) {
-                        double *p_bb_lin = g_calibration_ws.scratch;
-                        execute_welch_psd(&bb_dec, &bb_cfg, g_calibration_ws.freq, g_calibration_ws.psd);
+                    if (rf_workspace_ensure(&e->calibration_ws, iq_bytes, bb_nperseg) == 0 &&
+                        rf_workspace_ensure_scratch(&e->calibration_ws, (size_t)bb_nperseg) == 0) {
+                        double *p_bb_lin = e->calibration_ws.scratch;
+                        execute_welch_psd(&bb_dec, &bb_cfg, e->calibration_ws.freq, e->calibration_ws.psd);
                         for (int i = 0; i < bb_nperseg; ++i) {
-                            p_bb_lin[i] = pow(10.0, g_calibration_ws.psd[i] / 10.0);
+                            p_bb_lin[i] = pow(10.0, e->calibration_ws.psd[i] / 10.0);
                         }
 
-                        double f0 = g_calibration_ws.freq[0];
-                        double f1 = g_calibration_ws.freq[bb_nperseg - 1];
+                        double f0 = e->calibration_ws.freq[0];
+                        double f1 = e->calibration_ws.freq[bb_nperseg - 1];
                         double df = (f1 - f0) / (double)(bb_nperseg - 1);
 
                         if (df > 0.0) {
@@ -673,8 +961,8 @@ static float calibrate_hackrf(void) {
                             const int N_U = 1000;
                             double delta_center = 0.0;
                             double delta_span = 4000.0; // +/- 4 kHz (~40 ppm @100MHz)
-                            if (g_has_last_cal_ppm) {
-                                delta_center = -((double)g_last_cal_ppm * best_freq) / 1000000.0;
+                            if (e->has_last_cal_ppm) {
+                                delta_center = -((double)e->last_cal_ppm * best_freq) / 1000000.0;
                                 delta_span = 2500.0;
                             }
                             if (delta_center > 10000.0) delta_center = 10000.0;
@@ -698,12 +986,12 @@ static float calibrate_hackrf(void) {
 
                                     if (fl < f0 || fl > f1 || fr < f0 || fr > f1) continue;
 
-                                    double pl = interp_linear(g_calibration_ws.freq, p_bb_lin, bb_nperseg, fl);
-                                    double pr = interp_linear(g_calibration_ws.freq, p_bb_lin, bb_nperseg, fr);
+                                    double pl = interp_uniform(p_bb_lin, bb_nperseg, f0, df, fl);
+                                    double pr = interp_uniform(p_bb_lin, bb_nperseg, f0, df, fr);
                                     double denom = (pl + pr);
                                     if (denom < 1e-20) denom = 1e-20;
-                                    double e = (pl - pr);
-                                    cost += (e * e) / (denom * denom);
+                                    double diff = (pl - pr);
+                                    cost += (diff * diff) / (denom * denom);
                                     ncost++;
                                 }
 
@@ -724,18 +1012,18 @@ static float calibrate_hackrf(void) {
                                 final_ppm = 0.0f;
                             }
 
-                            if (!g_has_last_cal_ppm) {
-                                g_last_cal_ppm = final_ppm;
-                                g_has_last_cal_ppm = 1;
-                                RF_TRACE("[CALDBG] lock first ppm=%.6f\n", g_last_cal_ppm);
+                            if (!e->has_last_cal_ppm) {
+                                e->last_cal_ppm = final_ppm;
+                                e->has_last_cal_ppm = 1;
+                                RF_TRACE("[CALDBG] lock first ppm=%.6f\n", e->last_cal_ppm);
                             } else {
-                                float delta_ppm = fabsf(final_ppm - g_last_cal_ppm);
+                                float delta_ppm = fabsf(final_ppm - e->last_cal_ppm);
                                 if (delta_ppm > 20.0f) {
-                                    RF_TRACE("[CALDBG] ppm outlier detected (delta=%.3f), keep last=%.6f\n", delta_ppm, g_last_cal_ppm);
-                                    final_ppm = g_last_cal_ppm;
+                                    RF_TRACE("[CALDBG] ppm outlier detected (delta=%.3f), keep last=%.6f\n", delta_ppm, e->last_cal_ppm);
+                                    final_ppm = e->last_cal_ppm;
                                 } else {
-                                    g_last_cal_ppm = 0.7f * g_last_cal_ppm + 0.3f * final_ppm;
-                                    final_ppm = g_last_cal_ppm;
+                                    e->last_cal_ppm = 0.7f * e->last_cal_ppm + 0.3f * final_ppm;
+                                    final_ppm = e->last_cal_ppm;
                                     RF_TRACE("[CALDBG] ppm smoothed -> %.6f\n", final_ppm);
                                 }
                             }
@@ -762,7 +1050,7 @@ static float calibrate_hackrf(void) {
     }
 
     RF_TRACE("[CALDBG] calibration pipeline end final_ppm=%.6f\n", final_ppm);
-    return calibration_finish(final_ppm);
+    return calibration_finish(e, final_ppm);
 }
 
 /**
@@ -786,7 +1074,7 @@ static inline void msleep_int(int ms) {
 
 /**
  * @brief Resuelve la frecuencia de muestreo IQ para demodulación en tiempo de ejecución.
- * @details Prioriza el valor atómico actualizado por el hilo principal con la configuración
+ * @details Prioriza el valor atómico actualizado por el hilo del motor con la configuración
  * activa de HackRF. Si aún no está disponible, reconstruye la tasa a partir del estado
  * del demodulador (decimation_factor * audio_fs), evitando asumir 2 MS/s fijos.
  */
@@ -823,78 +1111,195 @@ void handle_sigint(int sig) {
  * @brief Función de retorno (Callback) activada por libhackrf cuando hay nuevas muestras disponibles.
  * @details Esta función se ejecuta en el contexto del hilo del controlador HackRF. Realiza 
  * un procesamiento mínimo para evitar la pérdida de muestras:
- * 1. Escribe los datos IQ crudos en el buffer primario (@ref rb).
- * 2. Si @ref audio_enabled es verdadero, clona los datos en @ref audio_rb.
+ * 1. Escribe los datos IQ crudos en el buffer primario (@ref rf_engine_t::rb) y registra la transferencia
+ *    en @ref rf_engine_t::rx_timing (instante, posición del ring e índice de muestra).
+ * 2. Si @ref rf_engine_t::audio_enabled es verdadero, clona los datos en @ref rf_engine_t::audio_rb.
  * @param[in] transfer Puntero a la estructura hackrf_transfer que contiene los bytes crudos.
  * @return 0 para continuar la transmisión, distinto de cero para detenerla.
  * @note Ejecución de alta frecuencia; evite llamadas bloqueantes o lógica pesada aquí.
  */
 int rx_callback(hackrf_transfer* transfer) {
-    if (stop_streaming) return 0; 
+    rf_engine_t *e = (rf_engine_t*)transfer->rx_ctx;
+    // libhackrf spawns a new USB thread on every start_rx: pin it on its first transfer
+    if (!e->rx_pinned || !pthread_equal(e->rx_pinned_thread, pthread_self())) {
+        // No logging on the USB thread: the engine reports the failure after the acquisition
+        if (rf_affinity_apply_io_thread(&e->affinity) != 0) atomic_store(&e->rx_pin_failed, true);
+        e->rx_pinned_thread = pthread_self();
+        e->rx_pinned = true;
+    }
+
+    if (e->stop_streaming) return 0; 
     if (transfer->valid_length > 0) {
-        rb_write(&rb, transfer->buffer, transfer->valid_length);
-        if (atomic_load(&audio_enabled)) {
-            rb_write(&audio_rb, transfer->buffer, transfer->valid_length);
-            pthread_mutex_lock(&audio_rb_mutex);
-            pthread_cond_signal(&audio_rb_cond);
-            pthread_mutex_unlock(&audio_rb_mutex);
-        }
-        // Signal the main thread that data is available
-        pthread_mutex_lock(&rb_mutex);
-        pthread_cond_signal(&rb_cond);
-        pthread_mutex_unlock(&rb_mutex);
+        const int64_t now_ns = (int64_t)rf_metrics_now_ns();
+        const size_t written = rb_write(&e->rb, transfer->buffer, transfer->valid_length);
+        rx_timing_stamp(&e->rx_timing, now_ns, (size_t)transfer->valid_length, written,
+                        atomic_load_explicit(&e->rb.head, memory_order_relaxed));
+        if (atomic_load(&e->audio_enabled)) {
+            rb_write(&e->audio_rb, transfer->buffer, transfer->valid_length);
+        }
+        // Consumers are woken by rb_write() itself once their threshold is crossed
     }
     return 0;
 }
 
 /**
  * @brief Intenta recuperar el dispositivo HackRF tras una pérdida de conexión.
- * @details Esta función detiene las transmisiones existentes, cierra el dispositivo e intenta 
- * volver a abrirlo hasta 3 veces con un retraso de 1 segundo entre intentos.
- * @return 0 si tiene éxito, -1 si el dispositivo no pudo recuperarse.
- * @note Esta es una llamada bloqueante.
+ * @details Cierra el dispositivo y hace un único intento de reapertura, sin esperas. Si falla
+ * deja @ref rf_engine_t::recovery_pending activo y @ref standby_probe lo reintenta cada
+ * @ref RF_STANDBY_PROBE_S en el hueco ocioso, en lugar de bloquear el canal de control. Si
+ * tiene éxito reaplica la configuración previa y deja el radio en espera, listo para una
+ * reanudación rápida.
+ * @return 0 si tiene éxito, -1 si el dispositivo no pudo reabrirse.
  */
-int recover_hackrf(void) {
+int recover_hackrf(rf_engine_t *e) {
+    // invalidate_hackrf_state() clears current_hw_cfg: a retry restores the one saved by the first attempt
+    SDR_cfg_t cfg = e->recovery_pending ? e->recovery_cfg : e->current_hw_cfg;
     printf("\n[RECOVERY] Initiating Hardware Reset sequence...\n");
-    invalidate_hackrf_state("recover_hackrf");
+    invalidate_hackrf_state(e, "recover_hackrf");
+
+    if (sdr_hackrf_open(e->serial, &e->device) != HACKRF_SUCCESS) {
+        fprintf(stderr, "[RECOVERY] Radio %d: re-open failed, retrying in %.0fs.\n", e->id, RF_STANDBY_PROBE_S);
+        e->device = NULL;
+        e->recovery_cfg = cfg;
+        e->recovery_pending = true;
+        e->standby_probe_s = monotonic_s();
+        return -1;
+    }
+    printf("[RECOVERY] Device Re-opened successfully.\n");
+    e->recovery_pending = false;
+    if (cfg.center_freq != 0 && cfg.sample_rate > 0.0) {
+        hackrf_apply_cfg(e->device, &cfg);
+        e->current_hw_cfg = cfg;
+        hackrf_enter_standby(e);
+    }
+    return 0;
+}
 
-    int attempts = 0;
-    while (attempts < 3 && keep_running) {
-        usleep(1000000); 
-        if (hackrf_open(&device) == HACKRF_SUCCESS) {
-            printf("[RECOVERY] Device Re-opened successfully.\n");
-            memset(&current_hw_cfg, 0, sizeof(SDR_cfg_t)); 
-            return 0;
-        }
-        attempts++;
-        fprintf(stderr, "[RECOVERY] Attempt %d failed.\n", attempts);
+/**
+ * @brief Sonda de salud del radio en espera, ejecutada en el hueco ocioso del bucle del motor.
+ * @details Una lectura de `board_id` cada @ref RF_STANDBY_PROBE_S. Corre entre requests en el
+ * propio hilo del motor, así nunca compite con un request por el dispositivo ni lo retrasa;
+ * un fallo dispara @ref recover_hackrf (un intento, sin esperas). Con una recuperación
+ * pendiente, cada periodo es un nuevo intento de reapertura hasta que uno tiene éxito o un
+ * request abre el dispositivo por su cuenta.
+ */
+static void standby_probe(rf_engine_t *e) {
+    if (e->recovery_pending && e->device != NULL) e->recovery_pending = false; // A request re-opened it
+    const double t = monotonic_s();
+    if (t - e->standby_probe_s < RF_STANDBY_PROBE_S) return;
+    if (e->recovery_pending) {
+        (void)recover_hackrf(e);
+        return;
+    }
+
+    uint8_t board_id = BOARD_ID_UNDETECTED;
+    const int rc = hackrf_board_id_read(e->device, &board_id);
+    if (rc == HACKRF_SUCCESS) {
+        e->standby_probe_s = t;
+        return;
     }
-    return -1;
+    fprintf(stderr, "[RF] Radio %d: standby probe failed: %s\n", e->id, hackrf_error_name((enum hackrf_error)rc));
+    (void)recover_hackrf(e);
 }
 
 /**
- * @brief Envía un objeto JSON ya construido como reply del request actual.
- * @param[in] root Objeto cJSON a serializar.
- * @return 0 si el reply fue enviado, -1 si falló.
+ * @brief Destino de un payload PSD: reply del REQ actual o socket PUB de streaming.
+ */
+typedef enum {
+    RF_SINK_REPLY,  /**< Reply síncrono por @ref rf_engine_t::zmq_channel. */
+    RF_SINK_STREAM  /**< Frame publicado por @ref rf_engine_t::zmq_stream. */
+} rf_sink_t;
+
+/**
+ * @brief Opciones de serialización y destino para @ref publish_results.
+ */
+typedef struct {
+    reply_format_t format; /**< JSON, F32 o I16. */
+    rf_sink_t sink;        /**< Destino del payload. */
+    uint32_t seq;          /**< Secuencia de frame (solo streaming). */
+    rf_req_metrics_t *metrics; /**< Métricas del request: recibe la etapa serialize (NULL = sin medir). */
+    bool include_metrics;  /**< Agrega el objeto "metrics" al reply JSON. */
+    uint32_t avg_count;    /**< Capturas combinadas en la traza (0 = sin promediado persistente). */
+    const char *record;    /**< Ruta base de la grabación SigMF del request ("" = falló, NULL = no pedida). */
+    const psd_detect_cfg_t *detect; /**< Detección on-device (NULL o deshabilitada = solo `Pxx`). */
+} rf_publish_opts_t;
+
+/**
+ * @brief Envía un mensaje multipart al destino indicado.
+ * @return Bytes enviados, o -1 si falló.
  */
-static int send_json_reply(cJSON *root) {
-    if (!zmq_channel || !root) return -1;
+static int sink_send_parts(rf_engine_t *e, rf_sink_t sink, const void *const *parts, const size_t *lens, int nparts) {
+    if (sink == RF_SINK_STREAM) return zpub_send_parts(e->zmq_stream, parts, lens, nparts);
+    return zpair_send_parts(e->zmq_channel, parts, lens, nparts);
+}
+
+/**
+ * @brief Serializa un objeto JSON y lo envía al destino indicado.
+ * @return 0 si fue enviado, -1 si falló.
+ */
+static int send_json_sink(rf_engine_t *e, rf_sink_t sink, cJSON *root) {
+    if (!root) return -1;
+    if (sink == RF_SINK_REPLY && !e->zmq_channel) return -1;
+    if (sink == RF_SINK_STREAM && !e->zmq_stream) return -1;
 
     char *json_string = cJSON_PrintUnformatted(root);
     if (!json_string) return -1;
 
-    int rc = zpair_send(zmq_channel, json_string);
+    int rc;
+    if (sink == RF_SINK_STREAM) {
+        const void *parts[1] = { json_string };
+        const size_t lens[1] = { strlen(json_string) };
+        rc = zpub_send_parts(e->zmq_stream, parts, lens, 1);
+    } else {
+        rc = zpair_send(e->zmq_channel, json_string);
+    }
     free(json_string);
     return (rc >= 0) ? 0 : -1;
 }
 
+/**
+ * @brief Envía el texto cerrado en @p w al destino indicado.
+ * @details El buffer se entrega a ZMQ sin copia (@ref jw_handoff); si todos los buffers del
+ * pool siguen en vuelo, el texto está en el de reserva y se envía copiando.
+ * @return 0 si fue enviado, -1 si falló.
+ */
+static int send_writer_sink(rf_engine_t *e, rf_sink_t sink, json_writer_t *w) {
+    if (sink == RF_SINK_REPLY && !e->zmq_channel) return -1;
+    if (sink == RF_SINK_STREAM && !e->zmq_stream) return -1;
+
+    size_t len = 0;
+    char *data = jw_data(w, &len);
+    if (!data) return -1;
+
+    int rc;
+    void *hint = jw_handoff(w);
+    if (hint) {
+        rc = (sink == RF_SINK_STREAM) ? zpub_send_zc(e->zmq_stream, data, len, jw_release, hint)
+                                      : zpair_send_zc(e->zmq_channel, data, len, jw_release, hint);
+    } else {
+        const void *parts[1] = { data };
+        const size_t lens[1] = { len };
+        rc = sink_send_parts(e, sink, parts, lens, 1);
+    }
+    return (rc >= 0) ? 0 : -1;
+}
+
+/**
+ * @brief Envía un objeto JSON ya construido como reply del request actual.
+ * @param[in] root Objeto cJSON a serializar.
+ * @return 0 si el reply fue enviado, -1 si falló.
+ */
+static int send_json_reply(rf_engine_t *e, cJSON *root) {
+    return send_json_sink(e, RF_SINK_REPLY, root);
+}
+
 /**
  * @brief Envía un reply de estado simple.
  * @param[in] status Estado semántico del reply.
  * @param[in] reason Motivo opcional de error o contexto adicional.
  * @return 0 si el reply fue enviado, -1 si falló.
  */
-static int send_status_reply(const char *status, const char *reason) {
+static int send_status_reply(rf_engine_t *e, const char *status, const char *reason) {
     cJSON *root = cJSON_CreateObject();
     if (!root) return -1;
 
@@ -903,108 +1308,921 @@ static int send_status_reply(const char *status, const char *reason) {
         cJSON_AddStringToObject(root, "reason", reason);
     }
 
-    int rc = send_json_reply(root);
+    int rc = send_json_reply(e, root);
+    cJSON_Delete(root);
+    return rc;
+}
+
+/**
+ * @brief Construye el reply de `{"stats": true}`: acumulados por etapa y contadores de
+ * descarte del ring buffer, de under-runs del hilo de audio y de paquetes Opus sin enviar.
+ * @return Objeto cJSON (el llamador lo libera), o NULL si falló la reserva.
+ */
+static cJSON *stats_reply_json(rf_engine_t *e) {
+    cJSON *root = cJSON_CreateObject();
+    if (!root) return NULL;
+
+    cJSON_AddStringToObject(root, "status", "ok");
+    cJSON *stats = rf_metrics_totals_json(&e->metrics);
+    if (stats) {
+        cJSON_AddNumberToObject(stats, "rb_dropped_bytes", (double)rb_dropped(&e->rb));
+        cJSON_AddNumberToObject(stats, "audio_rb_dropped_bytes", (double)rb_dropped(&e->audio_rb));
+        cJSON_AddNumberToObject(stats, "audio_underruns", (double)atomic_load(&e->audio_underruns));
+        cJSON_AddNumberToObject(stats, "audio_tx_dropped_packets", (double)atomic_load(&e->audio_tx_dropped));
+        cJSON_AddItemToObject(root, "stats", stats);
+    }
+    return root;
+}
+
+/**
+ * @brief Responde un request `{"stats": true}` con @ref stats_reply_json.
+ * @param[in] reset Reinicia los acumulados por etapa después de responder.
+ * @return 0 si el reply fue enviado, -1 si falló.
+ */
+static int send_stats_reply(rf_engine_t *e, bool reset) {
+    cJSON *root = stats_reply_json(e);
+    if (!root) return -1;
+
+    int rc = send_json_reply(e, root);
     cJSON_Delete(root);
+    if (reset) memset(&e->metrics, 0, sizeof(e->metrics));
     return rc;
 }
 
+/**
+ * @brief Consultas que el canal de control responde sin esperar a la adquisición en curso.
+ * @details `{"stats": true | "reset"}` devuelve @ref stats_reply_json; `{"status": true}`
+ * devuelve el estado del motor (índice y serie del radio, request en curso, cola y sintonía).
+ * Corre en el hilo del motor (dentro de @ref zpair_recv / @ref zpair_service), igual que su bucle.
+ * @return Longitud de @p reply, o 0 si @p req no es una consulta.
+ */
+static int control_query(const char *req, char *reply, size_t cap, void *user) {
+    rf_engine_t *e = (rf_engine_t*)user;
+    // Cheap pre-filter: most traffic is acquisition requests
+    if (!strstr(req, "\"stats\"") && !strstr(req, "\"status\"")) return 0;
+
+    cJSON *in = cJSON_Parse(req);
+    if (!cJSON_IsObject(in)) {
+        cJSON_Delete(in);
+        return 0;
+    }
+    const cJSON *st = cJSON_GetObjectItemCaseSensitive(in, "stats");
+    const bool stats = cJSON_IsTrue(st) ||
+                       (cJSON_IsString(st) && st->valuestring && strcasecmp(st->valuestring, "reset") == 0);
+    const bool reset = stats && cJSON_IsString(st);
+    const bool status = !stats && cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(in, "status"));
+    cJSON_Delete(in);
+    if (!stats && !status) return 0;
+
+    cJSON *root = NULL;
+    if (stats) {
+        root = stats_reply_json(e);
+    } else if ((root = cJSON_CreateObject()) != NULL) {
+        cJSON_AddStringToObject(root, "status", "ok");
+        cJSON *eng = cJSON_AddObjectToObject(root, "engine");
+        if (eng) {
+            cJSON_AddNumberToObject(eng, "radio", e->id);
+            cJSON_AddStringToObject(eng, "serial", e->serial);
+            cJSON_AddBoolToObject(eng, "busy", zpair_busy(e->zmq_channel));
+            cJSON_AddNumberToObject(eng, "queue_depth", zpair_queue_depth(e->zmq_channel));
+            cJSON_AddNumberToObject(eng, "coalesced", (double)e->zmq_channel->coalesced);
+            cJSON_AddNumberToObject(eng, "rejected", (double)e->zmq_channel->rejected);
+            cJSON_AddBoolToObject(eng, "radio_open", e->device != NULL || sdr_replay_is_streaming(e->replay));
+            cJSON_AddBoolToObject(eng, "calibrating", atomic_load(&e->calibration_running));
+            cJSON_AddBoolToObject(eng, "standby", e->standby);
+            cJSON_AddNumberToObject(eng, "standby_resumes", (double)e->standby_resumes);
+            cJSON_AddBoolToObject(eng, "recovery_pending", e->recovery_pending);
+            cJSON_AddNumberToObject(eng, "center_freq", (double)e->current_hw_cfg.center_freq);
+            cJSON_AddNumberToObject(eng, "sample_rate", e->current_hw_cfg.sample_rate);
+        }
+    }
+    if (!root) return 0;
+
+    const bool ok = cJSON_PrintPreallocated(root, reply, (int)cap, false);
+    cJSON_Delete(root);
+    if (!ok) return 0;
+    if (reset) memset(&e->metrics, 0, sizeof(e->metrics));
+    return (int)strlen(reply);
+}
+
+/**
+ * @brief Huella de un request: la configuración sin los campos que solo afectan a esa captura.
+ * @details El parser deja a cero el padding, así que dos huellas se comparan con memcmp.
+ * @param[in] d Configuración parseada (cooldown ya resuelto).
+ * @param[out] key Huella.
+ */
+static void request_fingerprint(const DesiredCfg_t *d, DesiredCfg_t *key) {
+    memcpy(key, d, sizeof(*key));
+    key->avg_reset = false;
+    key->record = false;
+    key->metrics_enabled = false;
+    key->cooldown_request = 0.0;
+    key->cooldown_request_set = false;
+}
+
 /**
  * @brief Aplica al request actual la configuración DSP/HW y el estado de audio.
+ * @details Si la huella coincide con la del request anterior se reutilizan las configuraciones
+ * derivadas (@ref rf_engine_t::cfg_cache). La resintonía se decide después contra @ref rf_engine_t::current_hw_cfg.
  * @param[in,out] desired Configuración parseada desde el request.
  * @param[out] out_hack Configuración de hardware derivada.
  * @param[out] out_psd Configuración PSD derivada.
  * @param[out] out_rb Configuración de buffer derivada.
+ * @return true si la configuración salió de la caché.
  */
-static void apply_runtime_request(
+static bool apply_runtime_request(rf_engine_t *e, 
     DesiredCfg_t *desired,
     SDR_cfg_t *out_hack,
     PsdConfig_t *out_psd,
     RB_cfg_t *out_rb
 ) {
-    if (!desired || !out_hack || !out_psd || !out_rb) return;
+    if (!desired || !out_hack || !out_psd || !out_rb) return false;
 
     if (desired->rf_mode == PSD_MODE) {
-        atomic_store(&audio_enabled, false);
+        atomic_store(&e->audio_enabled, false);
     } else {
-        if (!atomic_load(&audio_enabled)) {
-            rb_reset(&audio_rb);
+        if (!atomic_load(&e->audio_enabled)) {
+            rb_reset(&e->audio_rb);
         }
-        atomic_store(&audio_enabled, true);
+        atomic_store(&e->audio_enabled, true);
     }
 
-    find_params_psd(*desired, out_hack, out_psd, out_rb);
-
     if (desired->cooldown_request_set) {
-        g_request_cooldown_s = desired->cooldown_request;
+        e->request_cooldown_s = desired->cooldown_request;
+    }
+    desired->cooldown_request = e->request_cooldown_s;
+
+    DesiredCfg_t key;
+    request_fingerprint(desired, &key);
+    if (e->cfg_cache.valid && memcmp(&key, &e->cfg_cache.key, sizeof(key)) == 0) {
+        *out_hack = e->cfg_cache.hack;
+        *out_psd  = e->cfg_cache.psd;
+        *out_rb   = e->cfg_cache.rb;
+        RF_TRACE("[RF] Config cache hit\n");
+        return true;
     }
-    desired->cooldown_request = g_request_cooldown_s;
+
+    find_params_psd(*desired, out_hack, out_psd, out_rb);
 
     print_config_summary_DEPLOY(desired, out_hack, out_psd, out_rb);
 
+    // The antenna switch is wired to the first radio only
     #ifndef NO_COMMON_LIBS
-        select_ANTENNA(desired->antenna_port);
+        if (e->id == 0) select_ANTENNA(desired->antenna_port);
+        else printf("[GPIO] radio %d: antenna port %d ignored (no switch)\n", e->id, desired->antenna_port);
     #else
         printf("[GPIO] selected port: %d\n", desired->antenna_port);
     #endif
+
+    memcpy(&e->cfg_cache.key, &key, sizeof(key));
+    e->cfg_cache.hack  = *out_hack;
+    e->cfg_cache.psd   = *out_psd;
+    e->cfg_cache.rb    = *out_rb;
+    e->cfg_cache.valid = true;
+    return false;
+}
+
+/**
+ * @brief Envía el PSD como reply multipart binario (cabecera fija + bins).
+ * @details Frame 0: @ref psd_reply_header_t. Frame 1: bins float32 o int16 cuantizados.
+ * Frame 2 (opcional): @ref psd_reply_capture_t cuando la captura se ubicó en la línea de tiempo.
+ * El buffer de bins se reutiliza desde el workspace para no reservar memoria por request.
+ * @return 0 si el reply fue enviado, -1 si falló.
+ */
+static int publish_results_binary(rf_engine_t *e, const double *psd_array, int length, int nperseg, double start_freq,
+                                  double end_freq, int rf_mode, float metric, const rf_publish_opts_t *opts, rf_processing_workspace_t *ws) {
+    reply_format_t fmt = opts->format;
+    size_t payload_bytes = psd_reply_payload_bytes(fmt, length);
+    if (payload_bytes == 0 || rf_workspace_ensure_reply_bins(ws, payload_bytes) != 0) return -1;
+
+    psd_reply_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.rf_mode       = (uint8_t)rf_mode;
+    hdr.nperseg       = (uint32_t)nperseg;
+    hdr.start_freq_hz = start_freq;
+    hdr.end_freq_hz   = end_freq;
+    hdr.metric        = metric;
+    hdr.seq           = opts->seq;
+
+    if (psd_reply_encode(psd_array, length, fmt, &hdr, ws->reply_bins) != 0) return -1;
+
+    psd_reply_capture_t cap;
+    memset(&cap, 0, sizeof(cap));
+    cap.magic           = PSD_REPLY_CAPTURE_MAGIC;
+    cap.flags           = (uint8_t)(PSD_REPLY_CAPTURE_VALID | (ws->cap.gps ? PSD_REPLY_CAPTURE_GPS : 0U));
+    cap.sample_index    = ws->cap.sample_index;
+    cap.t_mono_ns       = ws->cap.t_mono_ns;
+    cap.t_utc_ns        = ws->cap.t_utc_ns;
+    cap.dropped_samples = ws->cap.dropped;
+
+    const void *parts[3] = { &hdr, ws->reply_bins, &cap };
+    const size_t lens[3] = { sizeof(hdr), payload_bytes, sizeof(cap) };
+    const int n_parts = ws->cap.valid ? 3 : 2;
+    return (sink_send_parts(e, opts->sink, parts, lens, n_parts) >= 0) ? 0 : -1;
+}
+
+/**
+ * @brief Serializa un espectro con su span de frecuencias y lo envía al destino indicado.
+ * @details Núcleo común de @ref publish_results y del barrido multibanda: JSON con
+ * `start_freq_hz`, `end_freq_hz`, métrica del modo y `Pxx`, o @ref publish_results_binary
+ * si el request pidió un formato binario.
+ * @param[in] psd_array Bins en dBm.
+ * @param[in] length Número de bins.
+ * @param[in] nperseg Tamaño de segmento FFT de la estimación (no coincide con @p length si hubo
+ *            recorte, pooling o barrido).
+ * @param[in] start_freq Frecuencia nominal del primer bin (Hz).
+ * @param[in] end_freq Frecuencia nominal final del span (Hz).
+ * @param[in] rf_mode Modo de operación (ej. FM_MODE, AM_MODE, PSD_MODE).
+ * @param[in] am_depth Profundidad de modulación AM calculada.
+ * @param[in] fm_dev Desviación de frecuencia FM calculada.
+ * @param[in] opts Formato, destino y secuencia del payload (NULL = JSON como reply).
+ * @param[in,out] ws Workspace reutilizable para el buffer de bins binarios.
+ * @return 0 si el reply fue enviado, -1 si falló.
+ */
+static int publish_spectrum(rf_engine_t *e, const double *psd_array, int length, int nperseg, double start_freq,
+                            double end_freq, int rf_mode, float am_depth, float fm_dev, const rf_publish_opts_t *opts, rf_processing_workspace_t *ws) {
+    static const rf_publish_opts_t default_opts = { REPLY_FORMAT_JSON, RF_SINK_REPLY, 0, NULL, false, 0, NULL, NULL };
+    if (!opts) opts = &default_opts;
+    if (!psd_array || length <= 0) return -1;
+
+    uint64_t t = rf_metrics_now_ns();
+
+    // Detection-only and spectrogram replies are always JSON: the binary frame has no room for them
+    const psd_detect_cfg_t *det = (opts->detect && opts->detect->enabled && ws) ? opts->detect : NULL;
+    const bool spec = ws && ws->spec.n_rows > 0;
+
+    if (opts->format != REPLY_FORMAT_JSON && ws && !(det && det->only) && !spec) {
+        float metric = 0.0f;
+        if (rf_mode == FM_MODE) metric = fm_dev;
+        else if (rf_mode == AM_MODE) metric = am_depth * 100.0f;
+        int brc = publish_results_binary(e, psd_array, length, nperseg, start_freq, end_freq, rf_mode, metric, opts, ws);
+        rf_metrics_lap(opts->metrics, RF_STAGE_SERIALIZE, &t);
+        return brc;
+    }
+
+    // Without a workspace the writer is a one-off: jw_free leaves the in-flight buffer to jw_release
+    json_writer_t fallback = {0};
+    json_writer_t *w = ws ? &ws->jw : &fallback;
+    if (jw_begin(w) != 0) {
+        jw_free(&fallback);
+        return -1;
+    }
+
+    jw_key_string(w, "status", "ok");
+    jw_key_number(w, "start_freq_hz", start_freq);
+    jw_key_number(w, "end_freq_hz", end_freq);
+
+    if (rf_mode == FM_MODE) {
+        jw_key_number(w, "excursion_hz", (double)fm_dev);
+    } else if (rf_mode == AM_MODE){
+        jw_key_number(w, "depth", (double)am_depth * 100.0);
+    }
+
+    if (opts->sink == RF_SINK_STREAM) {
+        jw_key_number(w, "seq", (double)opts->seq);
+    }
+    if (opts->avg_count > 0) {
+        jw_key_number(w, "avg_count", (double)opts->avg_count);
+    }
+    if (opts->record) {
+        if (opts->record[0]) jw_key_string(w, "record", opts->record);
+        else jw_key_bool(w, "record", false);
+    }
+    if (ws && ws->cap.valid) {
+        jw_key_object(w, "capture");
+        jw_key_int64(w, "sample_index", (int64_t)ws->cap.sample_index);
+        jw_key_int64(w, "t_mono_ns", ws->cap.t_mono_ns);
+        jw_key_int64(w, "t_utc_ns", ws->cap.t_utc_ns);
+        jw_key_string(w, "time_source", ws->cap.gps ? "gps" : "system");
+        jw_key_int64(w, "dropped_samples", (int64_t)ws->cap.dropped);
+        jw_object_end(w);
+    }
+
+    // Detections, spectrogram and metrics keep their cJSON builders: small objects spliced in
+    if (det) {
+        psd_detect_result_t det_res;
+        cJSON *extra = cJSON_CreateObject();
+        if (extra && rf_workspace_ensure_scratch(ws, (size_t)length) == 0 &&
+            psd_detect_run(det, psd_array, length, start_freq, end_freq, ws->scratch, &det_res) == 0) {
+            psd_detect_add_json(extra, &det_res);
+            jw_splice(w, extra);
+        }
+        cJSON_Delete(extra);
+    }
+    if (!(det && det->only)) {
+        jw_key_fixed_array(w, "Pxx", psd_array, length, JSON_PXX_DECIMALS);
+    }
+    if (spec) {
+        cJSON *extra = cJSON_CreateObject();
+        if (extra && psd_spectrogram_add_json(extra, &ws->spec) == 0) jw_splice(w, extra);
+        cJSON_Delete(extra);
+    }
+
+    // The reply can only carry the build part of serialize; the send lands in the totals
+    rf_metrics_lap(opts->metrics, RF_STAGE_SERIALIZE, &t);
+    if (opts->include_metrics && opts->metrics) {
+        cJSON *extra = cJSON_CreateObject();
+        if (extra) {
+            rf_metrics_add_request_json(extra, opts->metrics);
+            jw_splice(w, extra);
+        }
+        cJSON_Delete(extra);
+    }
+
+    int rc = (jw_end(w) == 0) ? send_writer_sink(e, opts->sink, w) : -1;
+    jw_free(&fallback);
+    rf_metrics_lap(opts->metrics, RF_STAGE_SERIALIZE, &t);
+    return rc;
 }
 
 /**
- * @brief Serializa los datos de PSD y metadatos de RF en JSON y los envía vía ZMQ.
- * @details Utiliza cJSON para construir una carga útil que contiene los límites de frecuencia, 
+ * @brief Serializa los datos de PSD y metadatos de RF y los envía vía ZMQ.
+ * @details Por defecto utiliza cJSON para construir una carga útil que contiene los límites de frecuencia, 
  * métricas específicas del modo (profundidad AM o excursión FM) y el arreglo de PSD crudo.
+ * Si el request pidió un formato binario, delega en @ref publish_results_binary.
+ * En modo streaming el payload se publica por @ref rf_engine_t::zmq_stream e incluye la secuencia del frame.
  * @param[in] psd_array Arreglo de valores de densidad espectral de potencia en doble precisión.
- * @param[in] length Tamaño del arreglo psd_array.
+ * @param[in] psd_cfg Configuración PSD: fija el número de bins y el span (recorte/pooling de salida).
  * @param[in] local_hack Configuración actual del hardware para cálculos de frecuencia.
  * @param[in] rf_mode Modo de operación actual (ej. FM_MODE, AM_MODE, PSD_MODE).
  * @param[in] am_depth Profundidad de modulación AM calculada.
  * @param[in] fm_dev Desviación de frecuencia FM calculada.
+ * @param[in] opts Formato, destino y secuencia del payload (NULL = JSON como reply).
+ * @param[in,out] ws Workspace reutilizable para el buffer de bins binarios.
  * @return 0 si el reply fue enviado, -1 si falló.
  */
-int publish_results(double* psd_array, int length, SDR_cfg_t *local_hack, uint64_t original_center_freq, int rf_mode, float am_depth, float fm_dev) {
-    if (!zmq_channel || !psd_array || length <= 0) return -1;
-    
-    cJSON *root = cJSON_CreateObject();
-    if (!root) return -1;
+int publish_results(rf_engine_t *e, double* psd_array, const PsdConfig_t *psd_cfg, SDR_cfg_t *local_hack, uint64_t original_center_freq, int rf_mode, float am_depth, float fm_dev,
+                    const rf_publish_opts_t *opts, rf_processing_workspace_t *ws) {
+    if (!local_hack || !psd_cfg) return -1;
+
     double fs = local_hack->sample_rate;
     /* Use original center_freq (without PPM correction) for frequency labels.
        This ensures the payload reports nominal frequencies, not corrected ones. */
-    double start_freq = (double)original_center_freq - (fs / 2.0);
-    double end_freq   = (double)original_center_freq + (fs / 2.0);
-    
-    cJSON_AddStringToObject(root, "status", "ok");
-    cJSON_AddNumberToObject(root, "start_freq_hz", start_freq);
-    cJSON_AddNumberToObject(root, "end_freq_hz", end_freq);
-    
-    if (rf_mode == FM_MODE) {
-        cJSON_AddNumberToObject(root, "excursion_hz", (double)fm_dev);
-    } else if (rf_mode == AM_MODE){
-        cJSON_AddNumberToObject(root, "depth", (double)am_depth * 100.0);
-    }
-    
-    cJSON_AddItemToObject(root, "Pxx", cJSON_CreateDoubleArray(psd_array, length));
+    double lo_off = -fs / 2.0, hi_off = fs / 2.0;
+    psd_output_span(psd_cfg, &lo_off, &hi_off);
+    double start_freq = (double)original_center_freq + lo_off;
+    double end_freq   = (double)original_center_freq + hi_off;
 
-    int rc = send_json_reply(root);
-    cJSON_Delete(root);
-    return rc;
+    return publish_spectrum(e, psd_array, psd_output_bins(psd_cfg), psd_cfg->nperseg, start_freq, end_freq, rf_mode, am_depth, fm_dev, opts, ws);
 }
 
 /**
- * @brief Hilo principal de procesamiento y transmisión de audio.
- * @details Implementa el siguiente flujo de trabajo (pipeline):
- * - **Adquisición**: Extrae muestras IQ de 8 bits desde @ref audio_rb.
- * - **Filtrado**: Aplica un filtro de paso de banda IIR mediante @ref iq_iir_filter_apply_inplace.
- * - **Demodulación**: Alterna entre @ref am_radio_local_iq_to_pcm y @ref fm_radio_iq_to_pcm.
- * - **Resampleo/Enmarcado**: Almacena PCM en un buffer para coincidir con el tamaño de trama de Opus (ej. 20ms).
- * - **Red**: Transmite vía @ref opus_tx_send_frame con lógica de reconexión automática.
- * * @param[in,out] arg Puntero a una estructura @ref audio_stream_ctx_t.
- * @return NULL al finalizar el hilo.
- * @warning Se bloquea en @ref ensure_tx_with_retry si la red está caída.
+ * @brief Completa la hora UTC de una captura ya ubicada por @ref rx_timing_lookup.
+ * @details Con un fix GPS reciente en @ref rf_engine_t::gps_time (publicado por gps-lte) la hora se
+ * extrapola desde el instante monotónico del fix; si no, desde `CLOCK_REALTIME`.
+ * @param[in,out] cap Metadatos con `t_mono_ns` válido.
  */
-void* audio_thread_fn(void* arg) {
-    audio_stream_ctx_t *ctx = (audio_stream_ctx_t*)arg;
-    if (!ctx || !ctx->fm_radio || !ctx->am_radio) {
-        fprintf(stderr, "[AUDIO] FATAL: ctx or radios NULL\n");
-        return NULL;
+static void rx_capture_fill_utc(rf_engine_t *e, rx_capture_meta_t *cap) {
+    // gps-lte may start after rf_app: keep trying to map until the segment exists, at most once per interval
+    if (!e->gps_time) {
+        const uint64_t now_ns = rf_metrics_now_ns();
+        if (now_ns >= e->gps_time_retry_ns) {
+            e->gps_time = gps_time_shm_open(false);
+            e->gps_time_retry_ns = now_ns + (uint64_t)(GPS_TIME_REOPEN_S * 1e9);
+        }
+    }
+
+    gps_time_fix_t fix;
+    if (gps_time_shm_read(e->gps_time, &fix) == 0) {
+        const int64_t age = cap->t_mono_ns - fix.mono_ns;
+        if (age > -GPS_TIME_MAX_AGE_NS && age < GPS_TIME_MAX_AGE_NS) {
+            cap->t_utc_ns = fix.utc_ns + age;
+            cap->gps = true;
+            return;
+        }
+    }
+
+    struct timespec rt;
+    clock_gettime(CLOCK_REALTIME, &rt);
+    const int64_t mono_now = (int64_t)rf_metrics_now_ns();
+    cap->t_utc_ns = (int64_t)rt.tv_sec * 1000000000LL + (int64_t)rt.tv_nsec - (mono_now - cap->t_mono_ns);
+    cap->gps = false;
+}
+
+/**
+ * @brief Lee una captura del ring buffer y calcula su PSD en el workspace.
+ * @details Convierte la captura directamente desde el ring (@ref rb_peek_regions +
+ * @ref load_iq_spans_into_signal_stats) y encadena @ref iq_compensation_apply, el filtro
+ * de canal opcional y el estimador PSD seleccionado. El resultado queda en `ws->psd`.
+ * Con `iq_precision = F32` usa la ruta float32 (@ref load_iq_spans_into_signal_f32_stats y fftwf);
+ * el filtro de canal solo existe en doble precisión, así que un request con filtro
+ * activo se procesa por la ruta F64. Con zoom (`psd->zoom.decim > 1`) la captura pasa por
+ * @ref iq_zoom_run hacia `ws->aux_sig` en lugar del filtro de canal y el estimador corre a f_s/D.
+ * Con `spectrogram.enabled` el estimador F64 deja además las filas tiempo-frecuencia en `ws->spec`
+ * (ver @ref psd_spectrogram_t); `ws->spec.n_rows` queda en 0 en cualquier otro caso.
+ * `ws->cap` recibe el índice, la hora y las pérdidas de la primera muestra (@ref rx_timing_lookup).
+ * @param[in] desired Configuración del request activo.
+ * @param[in] hack Configuración de hardware derivada.
+ * @param[in] psd Configuración PSD derivada.
+ * @param[in] total_bytes Bytes IQ a consumir del ring buffer.
+ * @param[in,out] ws Workspace reutilizable.
+ * @param[in] log_buffer Imprime el tamaño del buffer lineal (desactivado en streaming).
+ * @param[in,out] m Métricas del request: se imputan rb_read, iq_load, iq_comp, filter y psd (NULL = sin medir).
+ * @return NULL en éxito, o el motivo de error para el reply de estado.
+ */
+static const char *compute_psd_from_rb(rf_engine_t *e, const DesiredCfg_t *desired, const SDR_cfg_t *hack, PsdConfig_t *psd,
+                                       size_t total_bytes, rf_processing_workspace_t *ws, bool log_buffer,
+                                       rf_req_metrics_t *m) {
+    const bool use_spec = desired->spectrogram.enabled && !desired->sweep_enabled;
+    const bool use_f32 = (desired->iq_precision == IQ_PRECISION_F32) && !desired->filter_enabled && !use_spec;
+    ws->spec.n_rows = 0;
+    ws->cap.valid = false;
+
+    int ws_rc = use_f32 ? rf_workspace_ensure_f32(ws, total_bytes, psd->nperseg)
+                        : rf_workspace_ensure(ws, total_bytes, psd->nperseg);
+    if (ws_rc != 0) {
+        fprintf(stderr, "[RF] Error: Workspace allocation failed (%zu bytes, nperseg=%d).\n",
+                total_bytes, psd->nperseg);
+        return "workspace_allocation_failed";
+    }
+
+    if (log_buffer) {
+        size_t iq_points = total_bytes / 2; /* interleaved I,Q each 1 byte */
+        double buf_mb = (double)total_bytes / (1024.0 * 1024.0);
+        fprintf(stderr, "[RF] capture: %zu bytes (%zu IQ points), %.3f MB; PSD nperseg=%d\n",
+                total_bytes, iq_points, buf_mb, psd->nperseg);
+        if (psd->zoom.decim > 1) {
+            fprintf(stderr, "[RF] zoom: D=%d, %.1f kHz around %+.0f Hz\n",
+                    psd->zoom.decim, psd->sample_rate / 1e3, psd->zoom.shift_hz);
+        }
+    }
+    // Convert straight from the ring: no intermediate linear copy of the capture
+    uint64_t t = rf_metrics_now_ns();
+    rb_regions_t regions;
+    const uint64_t rb_pos = (uint64_t)atomic_load_explicit(&e->rb.tail, memory_order_relaxed);
+    const size_t peeked = rb_peek_regions(&e->rb, total_bytes, &regions);
+    rf_metrics_lap(m, RF_STAGE_RB_READ, &t);
+    const int8_t *spans[2] = { (const int8_t*)regions.ptr[0], (const int8_t*)regions.ptr[1] };
+    if (peeked < total_bytes) {
+        fprintf(stderr, "[RF] Error: Ring buffer holds %zu of %zu bytes.\n", peeked, total_bytes);
+        return "signal_load_failed";
+    }
+    if (rx_timing_lookup(&e->rx_timing, rb_pos, total_bytes, &ws->cap) == 0) rx_capture_fill_utc(e, &ws->cap);
+
+    if (m) m->samples += total_bytes / 2U;
+
+    iq_moments_t iq_stats;
+    if (use_f32) {
+        int load_rc = load_iq_spans_into_signal_f32_stats(spans, regions.len, &ws->sig_f32, &iq_stats);
+        rf_metrics_lap(m, RF_STAGE_IQ_LOAD, &t);
+        rb_commit_read(&e->rb, total_bytes);
+        rf_metrics_lap(m, RF_STAGE_RB_READ, &t);
+        if (load_rc != 0) {
+            fprintf(stderr, "[RF] Error: Failed to load IQ signal into float32 workspace.\n");
+            return "signal_load_failed";
+        }
+        iq_compensation_f32_apply(&ws->sig_f32, &iq_stats);
+        rf_metrics_lap(m, RF_STAGE_IQ_COMP, &t);
+        if (desired->method_psd == PFB) {
+            execute_pfb_psd_f32(&ws->sig_f32, psd, ws->freq, ws->psd);
+        } else {
+            execute_welch_psd_f32(&ws->sig_f32, psd, ws->freq, ws->psd);
+        }
+        rf_metrics_lap(m, RF_STAGE_PSD, &t);
+        return NULL;
+    }
+
+    int load_rc = load_iq_spans_into_signal_stats(spans, regions.len, &ws->sig, &iq_stats);
+    rf_metrics_lap(m, RF_STAGE_IQ_LOAD, &t);
+    rb_commit_read(&e->rb, total_bytes);
+    rf_metrics_lap(m, RF_STAGE_RB_READ, &t);
+    if (load_rc != 0) {
+        fprintf(stderr, "[RF] Error: Failed to load IQ signal into reusable workspace.\n");
+        return "signal_load_failed";
+    }
+
+    iq_compensation_apply(&ws->sig, &iq_stats);
+    rf_metrics_lap(m, RF_STAGE_IQ_COMP, &t);
+
+    // Zoom: the decimating low-pass is the channel filter, the estimator runs at fs/D
+    signal_iq_t *est_sig = &ws->sig;
+    signal_iq_t zoom_sig = { NULL, 0 };
+    if (psd->zoom.decim > 1) {
+        if (iq_zoom_prepare(&ws->zoom, &psd->zoom) != 0) {
+            fprintf(stderr, "[RF] Error: Zoom FIR allocation failed (D=%d).\n", psd->zoom.decim);
+            return "workspace_allocation_failed";
+        }
+        const size_t n_zoom = iq_zoom_output_len(&ws->zoom, ws->sig.n_signal);
+        if (n_zoom < (size_t)psd->nperseg) {
+            fprintf(stderr, "[RF] Error: Zoom yields %zu samples, below nperseg=%d.\n", n_zoom, psd->nperseg);
+            return "signal_load_failed";
+        }
+        if (rf_workspace_ensure_aux_sig(ws, n_zoom) != 0) {
+            fprintf(stderr, "[RF] Error: Workspace allocation failed (%zu zoom samples).\n", n_zoom);
+            return "workspace_allocation_failed";
+        }
+        zoom_sig.signal_iq = ws->aux_sig;
+        zoom_sig.n_signal = iq_zoom_run(&ws->zoom, &ws->sig, ws->aux_sig);
+        est_sig = &zoom_sig;
+        rf_metrics_lap(m, RF_STAGE_FILTER, &t);
+    } else if (desired->filter_enabled) {
+        chan_filter_apply_inplace_abs(&ws->sig, &desired->filter_cfg,
+                                      hack->center_freq_corrected, hack->sample_rate);
+        rf_metrics_lap(m, RF_STAGE_FILTER, &t);
+    }
+
+    psd_spectrogram_t *spec = NULL;
+    if (use_spec) {
+        ws->spec.cfg = desired->spectrogram;
+        spec = &ws->spec;
+    }
+    if (desired->method_psd == PFB) {
+        execute_pfb_psd_rows(est_sig, psd, ws->freq, ws->psd, spec);
+    } else {
+        execute_welch_psd_rows(est_sig, psd, ws->freq, ws->psd, spec);
+    }
+    rf_metrics_lap(m, RF_STAGE_PSD, &t);
+    return NULL;
+}
+
+/**
+ * @brief Combina la PSD recién calculada con la traza persistente del request.
+ * @details Con `average.mode` distinto de off, @ref psd_avg_apply reemplaza @p bins por la
+ * traza promediada (o max/min-hold). El acumulador se reinicia solo si cambia la
+ * configuración espectral o la frecuencia central, o si @p reset lo pide.
+ * @param[in] desired Request activo.
+ * @param[in] psd Configuración PSD de la captura.
+ * @param[in,out] bins Traza en dBm.
+ * @param[in] reset Reinicia el acumulador antes de sumar esta captura.
+ * @return Capturas combinadas (0 = sin promediado o si la reserva falla).
+ */
+static uint32_t apply_trace_average(rf_engine_t *e, const DesiredCfg_t *desired, const PsdConfig_t *psd, double *bins, bool reset) {
+    const psd_avg_params_t params = { desired->avg_mode, desired->avg_count, desired->avg_alpha, reset };
+    int n = psd_avg_apply(&e->psd_avg, &params, psd, desired->method_psd, desired->center_freq, bins,
+                         psd_output_bins(psd));
+    if (n < 0) {
+        fprintf(stderr, "[RF] Warning: Trace averaging buffer allocation failed, replying raw PSD.\n");
+        return 0;
+    }
+    return (uint32_t)n;
+}
+
+/**
+ * @brief Publica un mensaje de estado JSON en el socket PUB de streaming.
+ */
+static void publish_stream_status(rf_engine_t *e, const char *status, const char *reason, uint32_t frames) {
+    cJSON *root = cJSON_CreateObject();
+    if (!root) return;
+    cJSON_AddStringToObject(root, "status", status);
+    if (reason) cJSON_AddStringToObject(root, "reason", reason);
+    cJSON_AddNumberToObject(root, "frames", (double)frames);
+    send_json_sink(e, RF_SINK_STREAM, root);
+    cJSON_Delete(root);
+}
+
+/**
+ * @brief Frame PSD calculado y pendiente de publicación en el pipeline de streaming.
+ */
+typedef struct {
+    rf_processing_workspace_t *ws; /**< Workspace dueño de los bins (uno por slot). */
+    rf_req_metrics_t metrics;      /**< Métricas del frame (serialize se imputa en el hilo emisor). */
+    rf_publish_opts_t opts;        /**< Formato, destino y secuencia del frame. */
+    float am_depth;                /**< Métrica AM capturada al cerrar el frame. */
+    float fm_dev;                  /**< Métrica FM capturada al cerrar el frame. */
+    bool committed;                /**< Métricas ya acumuladas en @ref rf_engine_t::metrics. */
+} rf_stream_slot_t;
+
+/**
+ * @brief Doble buffer de streaming: el hilo del motor calcula el frame N en un slot
+ * mientras el hilo emisor serializa y envía el frame N-1 desde el otro.
+ * @details Los slots se alternan estrictamente; `free_sem[k]` indica que el slot k puede
+ * reescribirse y `ready` cuenta frames publicables. El socket PUB solo lo usa el emisor
+ * mientras el pipeline está activo. Un `ready` sin frame nuevo (`n_posted` sin cambios)
+ * detiene al emisor después de vaciar la cola.
+ */
+typedef struct {
+    rf_stream_slot_t slot[2];
+    sem_t free_sem[2];
+    sem_t ready;
+    atomic_uint n_posted;          /**< Frames entregados al emisor. */
+    unsigned n_sent;               /**< Frames enviados (solo hilo emisor). */
+    pthread_t thread;
+    bool running;
+    rf_engine_t *e;                /**< Motor dueño del socket PUB y de las métricas. */
+    const DesiredCfg_t *desired;
+    const SDR_cfg_t *hack;
+    const PsdConfig_t *psd;
+} rf_stream_pipe_t;
+
+static void *stream_sender_fn(void *arg) {
+    rf_stream_pipe_t *p = (rf_stream_pipe_t*)arg;
+    for (;;) {
+        sem_wait(&p->ready);
+        if (p->n_sent == atomic_load(&p->n_posted)) break; // stop token
+
+        const int k = (int)(p->n_sent & 1U);
+        rf_stream_slot_t *sl = &p->slot[k];
+        publish_results(p->e, sl->ws->psd, p->psd, (SDR_cfg_t*)p->hack, p->desired->center_freq,
+                        (int)p->desired->rf_mode, sl->am_depth, sl->fm_dev, &sl->opts, sl->ws);
+        rf_metrics_end(&sl->metrics);
+        p->n_sent++;
+        sem_post(&p->free_sem[k]);
+    }
+    return NULL;
+}
+
+static int stream_pipe_start(rf_stream_pipe_t *p, rf_engine_t *e, const DesiredCfg_t *desired, const SDR_cfg_t *hack,
+                             const PsdConfig_t *psd, rf_processing_workspace_t *ws0, rf_processing_workspace_t *ws1) {
+    memset(p, 0, sizeof(*p));
+    p->e = e;
+    p->desired = desired;
+    p->hack = hack;
+    p->psd = psd;
+    p->slot[0].ws = ws0;
+    p->slot[1].ws = ws1;
+    p->slot[0].committed = p->slot[1].committed = true;
+    atomic_init(&p->n_posted, 0);
+
+    sem_init(&p->free_sem[0], 0, 1);
+    sem_init(&p->free_sem[1], 0, 1);
+    sem_init(&p->ready, 0, 0);
+    if (pthread_create(&p->thread, NULL, stream_sender_fn, p) != 0) {
+        sem_destroy(&p->free_sem[0]);
+        sem_destroy(&p->free_sem[1]);
+        sem_destroy(&p->ready);
+        return -1;
+    }
+    p->running = true;
+    return 0;
+}
+
+/** @brief Acumula las métricas del slot si su frame ya fue enviado. */
+static void stream_slot_commit(rf_engine_t *e, rf_stream_slot_t *sl) {
+    if (sl->committed) return;
+    rf_metrics_commit(&e->metrics, &sl->metrics);
+    sl->committed = true;
+}
+
+/** @brief Vacía la cola, detiene el emisor y acumula las métricas pendientes. */
+static void stream_pipe_stop(rf_stream_pipe_t *p) {
+    if (!p->running) return;
+    sem_post(&p->ready);
+    pthread_join(p->thread, NULL);
+    stream_slot_commit(p->e, &p->slot[0]);
+    stream_slot_commit(p->e, &p->slot[1]);
+    sem_destroy(&p->free_sem[0]);
+    sem_destroy(&p->free_sem[1]);
+    sem_destroy(&p->ready);
+    p->running = false;
+}
+
+/**
+ * @brief Modo streaming: publica frames PSD consecutivos por @ref rf_engine_t::zmq_stream.
+ * @details Responde primero el REQ con `status:"streaming"` y la dirección PUB. Luego
+ * mantiene el radio activo y calcula PSD back-to-back sobre muestras contiguas del
+ * ring buffer (sin `rb_discard_all` por frame). Si el consumidor se retrasa más de dos
+ * capturas, se descarta el backlog para acotar la latencia. Con `stream_rate_hz > 0`
+ * los frames se espacian a esa tasa.
+ *
+ * Con `stream.pipeline` (por defecto) la serialización y el envío del frame N-1 corren en
+ * un hilo emisor (@ref rf_stream_pipe_t) mientras el pool OpenMP calcula el frame N en el
+ * otro workspace; la captura N+1 se acumula en el ring buffer en paralelo a ambos.
+ *
+ * El modo termina al alcanzar `stream_frames`, al llegar un request nuevo por el
+ * canal de control (queda en `zmq_channel->buffer` para el bucle principal) o ante un
+ * timeout de adquisición.
+ * @return true si quedó un request pendiente de procesar.
+ */
+static bool run_psd_stream(rf_engine_t *e, DesiredCfg_t *desired, SDR_cfg_t *hack, PsdConfig_t *psd, RB_cfg_t *rbc,
+                           rf_processing_workspace_t *ws, audio_stream_ctx_t *audio_ctx) {
+    if (!e->zmq_stream) {
+        e->zmq_stream = zpub_init(e->pub_addr, 0);
+        if (!e->zmq_stream) {
+            send_status_reply(e, "error", "stream_unavailable");
+            return false;
+        }
+    }
+
+    cJSON *ack = cJSON_CreateObject();
+    if (ack) {
+        cJSON_AddStringToObject(ack, "status", "streaming");
+        cJSON_AddStringToObject(ack, "pub_addr", e->zmq_stream->addr);
+        cJSON_AddNumberToObject(ack, "rate_hz", desired->stream_rate_hz);
+        cJSON_AddNumberToObject(ack, "frames", (double)desired->stream_frames);
+        cJSON_AddBoolToObject(ack, "pipeline", desired->stream_pipeline);
+        send_json_reply(e, ack);
+        cJSON_Delete(ack);
+    }
+    printf("[RF_STREAM] Started | rate: %.2f Hz | frames: %d | pipeline: %s | PUB: %s\n",
+           desired->stream_rate_hz, desired->stream_frames, desired->stream_pipeline ? "on" : "off",
+           e->zmq_stream->addr);
+
+    rf_stream_pipe_t pipe;
+    bool pipelined = desired->stream_pipeline &&
+                     stream_pipe_start(&pipe, e, desired, hack, psd, ws, &e->stream_ws) == 0;
+    if (desired->stream_pipeline && !pipelined) {
+        fprintf(stderr, "[RF_STREAM] Warning: sender thread unavailable, publishing inline.\n");
+    }
+
+    const double period_ms = (desired->stream_rate_hz > 0.0) ? 1000.0 / desired->stream_rate_hz : 0.0;
+    rf_req_metrics_t inline_m;
+    uint32_t seq = 0;
+    uint64_t next_frame_ms = now_ms();
+    const char *end_status = "stream_end";
+    const char *end_reason = NULL;
+    bool pending = false;
+
+    rb_discard_all(&e->rb);
+
+    while (keep_running && (desired->stream_frames <= 0 || (int)seq < desired->stream_frames)) {
+        if (zpair_try_recv(e->zmq_channel) > 0) {
+            printf("[RF_STREAM] New request received, leaving stream after %u frames.\n", seq);
+            end_reason = "new_request";
+            pending = true;
+            break;
+        }
+
+        if (period_ms > 0.0) {
+            uint64_t now = now_ms();
+            if (now < next_frame_ms) {
+                uint64_t wait_ms = next_frame_ms - now;
+                msleep_int((int)(wait_ms > 50 ? 50 : wait_ms));
+                continue;
+            }
+            next_frame_ms += (uint64_t)period_ms;
+            if (next_frame_ms < now) next_frame_ms = now + (uint64_t)period_ms;
+        }
+
+        // Pick this frame's workspace; in pipeline mode wait until its previous frame was sent
+        rf_stream_slot_t *sl = NULL;
+        rf_processing_workspace_t *fws = ws;
+        rf_req_metrics_t *fm = &inline_m;
+        if (pipelined) {
+            sl = &pipe.slot[seq & 1U];
+            sem_wait(&pipe.free_sem[seq & 1U]);
+            stream_slot_commit(e, sl);
+            fws = sl->ws;
+            fm = &sl->metrics;
+        }
+
+        // Bound latency: never analyse data older than two captures
+        if (rb_available(&e->rb) > 2 * rbc->total_bytes) {
+            rb_discard_all(&e->rb);
+        }
+
+        rf_metrics_begin(fm);
+        const size_t dropped0 = rb_dropped(&e->rb);
+        uint64_t t_wait = fm->start_ns;
+        const bool got = wait_for_rb_bytes(e, rbc->total_bytes, 5);
+        rf_metrics_lap(fm, RF_STAGE_ACQ_WAIT, &t_wait);
+
+        const char *err = NULL;
+        if (!got) {
+            if (!keep_running) {
+                if (sl) sem_post(&pipe.free_sem[seq & 1U]);
+                break;
+            }
+            fprintf(stderr, "[RF_STREAM] Error: Acquisition Timeout (buffer empty).\n");
+            invalidate_hackrf_state(e, "stream_acquisition_timeout");
+            err = "acquisition_timeout";
+        } else {
+            err = compute_psd_from_rb(e, desired, hack, psd, rbc->total_bytes, fws, false, fm);
+        }
+        if (err) {
+            if (sl) sem_post(&pipe.free_sem[seq & 1U]);
+            end_status = "error";
+            end_reason = err;
+            break;
+        }
+        fm->rb_dropped_bytes = rb_dropped(&e->rb) - dropped0;
+        const uint32_t avg_count = apply_trace_average(e, desired, psd, fws->psd, desired->avg_reset && seq == 0);
+
+        const rf_publish_opts_t opts = { desired->reply_format, RF_SINK_STREAM, seq, fm, desired->metrics_enabled,
+                                         avg_count, NULL, &desired->detect };
+        if (pipelined) {
+            sl->opts = opts;
+            sl->am_depth = audio_ctx->am_depth.depth_ema;
+            sl->fm_dev = audio_ctx->fm_dev.dev_ema_hz;
+            sl->committed = false;
+            atomic_fetch_add(&pipe.n_posted, 1);
+            sem_post(&pipe.ready);
+        } else {
+            publish_results(e, fws->psd, psd, hack, desired->center_freq, (int)desired->rf_mode,
+                            audio_ctx->am_depth.depth_ema, audio_ctx->fm_dev.dev_ema_hz, &opts, fws);
+            rf_metrics_commit(&e->metrics, fm);
+        }
+        seq++;
+    }
+
+    // Frames already handed to the sender go out before the status message
+    if (pipelined) stream_pipe_stop(&pipe);
+
+    if (!end_reason) printf("[RF_STREAM] Finished after %u frames.\n", seq);
+    publish_stream_status(e, end_status, end_reason, seq);
+    return pending;
+}
+
+/**
+ * @brief Barrido multibanda: salta el HackRF dentro de rf_app y responde un único espectro.
+ * @details Con la RX activa, cada salto re-sintoniza solo la frecuencia (@ref hackrf_retune),
+ * descarta del ring buffer las muestras de asentamiento del PLL (@ref SWEEP_SETTLE_MS, como
+ * mínimo @ref SWEEP_SETTLE_MIN_BYTES), calcula el PSD del segmento y conserva los B bins
+ * centrales (@ref SWEEP_USABLE_FRACTION de nperseg). El paso entre saltos es exactamente
+ * B·Δf, así que los segmentos se unen sin solape ni huecos sobre una rejilla uniforme
+ * que empieza en `sweep_start_hz`. Ganancias, tasa y `nperseg` se aplican una sola vez.
+ * @return 0 si se envió el reply (de datos o de error), -1 si falló el envío.
+ */
+static int run_psd_sweep(rf_engine_t *e, DesiredCfg_t *desired, SDR_cfg_t *hack, PsdConfig_t *psd, RB_cfg_t *rbc,
+                         rf_processing_workspace_t *ws, rf_req_metrics_t *m) {
+    const double fs = hack->sample_rate;
+    const int nperseg = psd->nperseg;
+    const double df = fs / (double)nperseg;
+    const double span = (double)(desired->sweep_end_hz - desired->sweep_start_hz);
+
+    int bins_per_hop = (int)((double)nperseg * SWEEP_USABLE_FRACTION) & ~1;
+    if (bins_per_hop < 2) bins_per_hop = 2;
+    const double step_hz = (double)bins_per_hop * df;
+    const int n_hops = (int)ceil(span / step_hz);
+    const size_t n_bins = (size_t)ceil(span / df);
+
+    if (n_hops < 1 || n_hops > SWEEP_MAX_HOPS) {
+        fprintf(stderr, "[RF_SWEEP] Error: %d hops exceed the limit (%d).\n", n_hops, SWEEP_MAX_HOPS);
+        return send_status_reply(e, "error", "sweep_too_wide");
+    }
+    if (rf_workspace_ensure_sweep(ws, (size_t)n_hops * (size_t)bins_per_hop) != 0) {
+        return send_status_reply(e, "error", "workspace_allocation_failed");
+    }
+
+    size_t settle_bytes = (size_t)(fs * 2.0 * SWEEP_SETTLE_MS / 1000.0);
+    if (settle_bytes < SWEEP_SETTLE_MIN_BYTES) settle_bytes = SWEEP_SETTLE_MIN_BYTES;
+    settle_bytes &= ~(size_t)1;
+
+    printf("[RF_SWEEP] %" PRIu64 "-%" PRIu64 " Hz | %d hops x %d bins | step %.0f Hz | RBW bin %.1f Hz\n",
+           desired->sweep_start_hz, desired->sweep_end_hz, n_hops, bins_per_hop, step_hz, df);
+
+    const int k0 = nperseg / 2 - bins_per_hop / 2;
+    uint64_t hop_fc = 0;
+    const char *err = NULL;
+
+    for (int h = 0; h < n_hops && keep_running; h++) {
+        const double fc = (double)desired->sweep_start_hz + (double)(bins_per_hop / 2) * df + (double)h * step_hz;
+        hop_fc = (uint64_t)llround(fc);
+
+        if (hackrf_retune(e->device, hack, hop_fc) != HACKRF_SUCCESS) {
+            invalidate_hackrf_state(e, "sweep_retune_failed");
+            return send_status_reply(e, "error", "sweep_retune_failed");
+        }
+
+        // Only samples captured after the retune count; the head of those is PLL settling
+        rb_discard_all(&e->rb);
+        uint64_t t_wait = rf_metrics_now_ns();
+        const bool got = wait_for_rb_bytes(e, settle_bytes + rbc->total_bytes, 5);
+        rf_metrics_lap(m, RF_STAGE_ACQ_WAIT, &t_wait);
+        if (!got) {
+            if (!keep_running) break;
+            fprintf(stderr, "[RF_SWEEP] Error: Acquisition timeout at hop %d (%" PRIu64 " Hz).\n", h, hop_fc);
+            invalidate_hackrf_state(e, "sweep_acquisition_timeout");
+            return send_status_reply(e, "error", "acquisition_timeout");
+        }
+        rb_commit_read(&e->rb, settle_bytes);
+
+        err = compute_psd_from_rb(e, desired, hack, psd, rbc->total_bytes, ws, false, m);
+        if (err) break;
+
+        memcpy(ws->sweep_psd + (size_t)h * (size_t)bins_per_hop, ws->psd + k0,
+               (size_t)bins_per_hop * sizeof(double));
+    }
+
+    // The radio stays on the last hop (also after an error): the next regular request must retune to its own center
+    e->current_hw_cfg.center_freq = hack->center_freq;
+    e->current_hw_cfg.center_freq_corrected = hack->center_freq_corrected;
+
+    if (err) return send_status_reply(e, "error", err);
+    if (!keep_running) return -1;
+
+    // Each hop has its own first sample: the stitched spectrum carries no single capture time
+    ws->cap.valid = false;
+
+    const double start_freq = (double)desired->sweep_start_hz;
+    rf_publish_opts_t opts = { desired->reply_format, RF_SINK_REPLY, 0, m, desired->metrics_enabled, 0, NULL,
+                               &desired->detect };
+    int rc = publish_spectrum(e, ws->sweep_psd, (int)n_bins, nperseg, start_freq, start_freq + (double)n_bins * df,
+                              PSD_MODE, 0.0f, 0.0f, &opts, ws);
+    if (rc != 0) fprintf(stderr, "[RF_SWEEP] Error: Failed to send sweep reply.\n");
+    return rc;
+}
+
+/**
+ * @brief Hilo principal de procesamiento y transmisión de audio.
+ * @details Implementa el siguiente flujo de trabajo (pipeline):
+ * - **Adquisición**: Extrae muestras IQ de 8 bits desde @ref rf_engine_t::audio_rb.
+ * - **Diezmado**: CIC + FIR con salida float32 (@ref iq_decim_process_s8_cf32).
+ * - **Filtrado**: Aplica un filtro de paso de banda IIR por bloques mediante @ref iq_iir_filter_apply_cf32.
+ * - **Demodulación**: Alterna entre @ref am_radio_local_cf32_to_pcm y @ref fm_radio_cf32_to_pcm.
+ * - **Resampleo/Enmarcado**: Almacena PCM en un buffer para coincidir con el tamaño de trama de Opus (ej. 20ms).
+ * - **Red**: Codifica y encola vía @ref opus_tx_send_frame; el hilo emisor del transmisor
+ *   envía y reconecta por su cuenta (TCP o RTP/UDP).
+ * * @param[in,out] arg Motor (@ref rf_engine_t) cuyo `audio_ctx` y `audio_rb` se usan.
+ * @return NULL al finalizar el hilo.
+ * @note Una red caída o lenta nunca frena este hilo: los paquetes que no caben en la cola
+ * del emisor se descartan y se cuentan en @ref rf_engine_t::audio_tx_dropped.
+ */
+void* audio_thread_fn(void* arg) {
+    rf_engine_t *e = (rf_engine_t*)arg;
+    audio_stream_ctx_t *ctx = e ? &e->audio_ctx : NULL;
+    if (!ctx || !ctx->fm_radio || !ctx->am_radio || !ctx->ws || !ctx->ws->arena) {
+        fprintf(stderr, "[AUDIO] FATAL: ctx, radios or workspace NULL\n");
+        return NULL;
     }
 
     // sanity: Opus expects one of the standard rates; we use 48000
@@ -1016,36 +2234,44 @@ void* audio_thread_fn(void* arg) {
     }
 
     const int frame_samples = (ctx->opus_sample_rate * ctx->frame_ms) / 1000; // e.g., 960 @48k/20ms
-    if (frame_samples <= 0) {
+    if (frame_samples <= 0 || frame_samples > ctx->ws->frame_samples) {
         fprintf(stderr, "[AUDIO] FATAL: invalid frame_samples\n");
         return NULL;
     }
 
-    int8_t  *raw_iq_chunk = (int8_t*)malloc((size_t)AUDIO_CHUNK_SAMPLES * 2);
-    int16_t *pcm_out      = (int16_t*)malloc((size_t)AUDIO_CHUNK_SAMPLES * sizeof(int16_t));
+    // Every buffer comes from the workspace reserved by engine_init(): mode/fs switches never allocate
+    audio_workspace_t *aws = ctx->ws;
+    int8_t  *raw_iq_chunk = aws->raw_iq;
+    int16_t *pcm_out      = aws->pcm_out;
+    int16_t *pcm_accum    = aws->pcm_accum;
 
-    signal_iq_t audio_sig;
-    audio_sig.n_signal = AUDIO_CHUNK_SAMPLES;
-    audio_sig.signal_iq = (double complex*)malloc((size_t)AUDIO_CHUNK_SAMPLES * sizeof(double complex));
+    // float32 IQ end to end: decimator -> IIR block filter -> demod, no double complex hop
+    float complex *audio_iq = aws->iq;
+    size_t audio_n = 0;
 
-    int16_t *pcm_accum = (int16_t*)malloc((size_t)frame_samples * sizeof(int16_t));
     int accum_len = 0;
 
-    if (!raw_iq_chunk || !pcm_out || !audio_sig.signal_iq || !pcm_accum) {
-        fprintf(stderr, "[AUDIO] FATAL: malloc failed\n");
-        free(raw_iq_chunk);
-        free(pcm_out);
-        free(audio_sig.signal_iq);
-        free(pcm_accum);
-        return NULL;
-    }
+    // Decimating front-end: IIR + demod run at fs_demod instead of the HackRF rate
+    iq_decim_t *decim = &aws->decim;
+    int    decim_active = 0;
+    int    demod_mode   = -1;
+    double demod_fs_in  = 0.0;
+    double fs_demod     = 0.0;
 
     opus_tx_t *tx = NULL;
 
     // local helper: (re)connect opus tx
 
 
-    audio_thread_running = true;
+    // Share the reserved I/O core with the USB callback, without real-time priority:
+    // demod + Opus must never delay a USB transfer
+    rf_affinity_cfg_t audio_aff = e->affinity;
+    audio_aff.io_fifo_prio = 0;
+    if (rf_affinity_apply_io_thread(&audio_aff) != 0) {
+        fprintf(stderr, "[AUDIO] Warning: could not pin audio thread to cpu %d\n", audio_aff.io_cpu);
+    }
+
+    e->audio_thread_running = true;
 
     // track mode/fs changes to reconfig IQ filter cleanly
     int    last_mode = -1;
@@ -1055,49 +2281,74 @@ void* audio_thread_fn(void* arg) {
     uint64_t last_metrics_ms = now_ms();
     const uint64_t METRICS_EVERY_MS = 500;
 
-    while (audio_thread_running) {
+    while (e->audio_thread_running) {
 
-        // Ensure TCP/Opus encoder is ready (infinite retries, 3s)
-        if (ensure_tx_with_retry(ctx, &tx, &audio_thread_running) != 0) {
+        // Ensure the Opus encoder/sender exists (the sender thread owns the connection)
+        if (ensure_tx_with_retry(ctx, &tx, &e->audio_thread_running) != 0) {
             // thread stopping
             break;
         }
 
         // Wait for enough IQ bytes
-        if (rb_available(&audio_rb) < (size_t)(AUDIO_CHUNK_SAMPLES * 2)) {
-            struct timespec ts_timeout;
-            clock_gettime(CLOCK_REALTIME, &ts_timeout);
-            ts_timeout.tv_nsec += 10000000L;
-            if (ts_timeout.tv_nsec >= 1000000000L) {
-                ts_timeout.tv_sec += 1;
-                ts_timeout.tv_nsec -= 1000000000L;
+        if (!rb_wait_available(&e->audio_rb, (size_t)(AUDIO_CHUNK_SAMPLES * 2), RB_WAIT_SLICE_MS)) {
+            // A whole slice without one chunk while audio is live is an under-run
+            if (e->audio_thread_running && atomic_load(&e->audio_enabled) && !e->stop_streaming) {
+                atomic_fetch_add_explicit(&e->audio_underruns, 1, memory_order_relaxed);
             }
+            continue;
+        }
+        if (!e->audio_thread_running) continue;
 
-            pthread_mutex_lock(&audio_rb_mutex);
-            while (audio_thread_running && rb_available(&audio_rb) < (size_t)(AUDIO_CHUNK_SAMPLES * 2)) {
-                int rc = pthread_cond_timedwait(&audio_rb_cond, &audio_rb_mutex, &ts_timeout);
-                if (rc == ETIMEDOUT) break;
+        // Drain one chunk
+        rb_read(&e->audio_rb, raw_iq_chunk, AUDIO_CHUNK_SAMPLES * 2);
+
+        // Read current mode/fs (set by main thread)
+        int mode = atomic_load(&ctx->current_mode);
+        double fs_in_hz = resolve_demod_fs_hz(ctx, mode);
+
+        // ===== DECIMATOR + DEMOD (RE)CONFIG =====
+        if (mode != demod_mode || fabs(fs_in_hz - demod_fs_in) > 1e-6) {
+            int r1 = 1, r2 = 1;
+            int planned = -1;
+            if (AUDIO_DECIM_ENABLE) {
+                planned = (mode == AM_MODE)
+                    ? iq_decim_plan(fs_in_hz, ctx->opus_sample_rate, AUDIO_DECIM_AM_LO_HZ,
+                                    AUDIO_DECIM_AM_HI_HZ, AUDIO_DECIM_AM_PREF_HZ, &r1, &r2)
+                    : iq_decim_plan(fs_in_hz, ctx->opus_sample_rate, AUDIO_DECIM_FM_LO_HZ,
+                                    AUDIO_DECIM_FM_HI_HZ, AUDIO_DECIM_FM_PREF_HZ, &r1, &r2);
             }
-            pthread_mutex_unlock(&audio_rb_mutex);
 
-            if (!audio_thread_running || rb_available(&audio_rb) < (size_t)(AUDIO_CHUNK_SAMPLES * 2)) {
-                continue;
+            decim_active = (planned == 0 && r1 * r2 > 1 &&
+                            iq_decim_init(decim, fs_in_hz, r1, r2, AUDIO_CHUNK_SAMPLES) == 0);
+            fs_demod = decim_active ? decim->fs_out : fs_in_hz;
+
+            if (mode == AM_MODE) {
+                am_radio_local_init(ctx->am_radio, fs_demod, ctx->opus_sample_rate);
+            } else {
+                fm_radio_init(ctx->fm_radio, fs_demod, ctx->opus_sample_rate, 75);
             }
-        }
 
-        // Drain one chunk
-        rb_read(&audio_rb, raw_iq_chunk, AUDIO_CHUNK_SAMPLES * 2);
+            fprintf(stderr, "[AUDIO] fs_in=%.0f Hz -> fs_demod=%.0f Hz (CIC R=%d, FIR R=%d)\n",
+                    fs_in_hz, fs_demod, decim_active ? r1 : 1, decim_active ? r2 : 1);
 
-        // Convert int8 IQ -> complex double (normalized)
-        for (int i = 0; i < AUDIO_CHUNK_SAMPLES; ++i) {
-            double real = ((double)raw_iq_chunk[2*i]) / 128.0;
-            double imag = ((double)raw_iq_chunk[2*i + 1]) / 128.0;
-            audio_sig.signal_iq[i] = real + imag * I;
+            demod_mode = mode;
+            demod_fs_in = fs_in_hz;
         }
 
-        // Read current mode/fs (set by main thread)
-        int mode = atomic_load(&ctx->current_mode);
-        double fs_hz = resolve_demod_fs_hz(ctx, mode);
+        if (decim_active) {
+            audio_n = iq_decim_process_s8_cf32(decim, raw_iq_chunk, AUDIO_CHUNK_SAMPLES, audio_iq);
+            if (audio_n == 0) continue;
+        } else {
+            // Convert int8 IQ -> complex float (normalized)
+            for (int i = 0; i < AUDIO_CHUNK_SAMPLES; ++i) {
+                float real = (float)raw_iq_chunk[2*i] / 128.0f;
+                float imag = (float)raw_iq_chunk[2*i + 1] / 128.0f;
+                audio_iq[i] = real + imag * I;
+            }
+            audio_n = AUDIO_CHUNK_SAMPLES;
+        }
+
+        double fs_hz = fs_demod;
 
         // ===== IQ CHANNEL FILTER =====
         if (IQ_FILTER_ENABLE) {
@@ -1124,20 +2375,21 @@ void* audio_thread_fn(void* arg) {
             }
 
             if (ctx->iqf_ready) {
-                iq_iir_filter_apply_inplace(&ctx->iqf, &audio_sig);
+                iq_iir_filter_apply_cf32(&ctx->iqf, audio_iq, audio_n);
             }
         }
 
         // ===== Demod IQ -> PCM (FM or AM) =====
         int samples_gen = 0;
         if (mode == AM_MODE) {
-            samples_gen = am_radio_local_iq_to_pcm(ctx->am_radio, &audio_sig, pcm_out, &ctx->am_depth);
+            samples_gen = am_radio_local_cf32_to_pcm(ctx->am_radio, audio_iq, audio_n, pcm_out, &ctx->am_depth);
         } else {
             // default: FM
             // >>> FIX: pass metrics state + fs_demod <<<
-            samples_gen = fm_radio_iq_to_pcm(
+            samples_gen = fm_radio_cf32_to_pcm(
                 ctx->fm_radio,
-                &audio_sig,
+                audio_iq,
+                audio_n,
                 pcm_out,
                 &ctx->fm_dev,
                 (int)llround(fs_hz)
@@ -1178,12 +2430,15 @@ void* audio_thread_fn(void* arg) {
             idx += take;
 
             if (accum_len == frame_samples) {
-                if (opus_tx_send_frame(tx, pcm_accum, frame_samples) != 0) {
-                    fprintf(stderr, "[AUDIO] WARN: opus_tx_send_frame failed. Reconnecting in 3s...\n");
+                const int tx_rc = opus_tx_send_frame(tx, pcm_accum, frame_samples);
+                if (tx_rc > 0) {
+                    atomic_fetch_add_explicit(&e->audio_tx_dropped, 1, memory_order_relaxed);
+                } else if (tx_rc < 0) {
+                    fprintf(stderr, "[AUDIO] WARN: opus_tx_send_frame failed. Restarting Opus TX in 2s...\n");
                     opus_tx_destroy(tx);
                     tx = NULL;
                     accum_len = 0;
-                    sleep_cancelable_ms(RECONNECT_DELAY_MS, &audio_thread_running);
+                    sleep_cancelable_ms(RECONNECT_DELAY_MS, &e->audio_thread_running);
                     break;
                 }
                 accum_len = 0;
@@ -1198,87 +2453,180 @@ void* audio_thread_fn(void* arg) {
         ctx->iqf_ready = 0;
     }
 
-    free(raw_iq_chunk);
-    free(pcm_out);
-    free(audio_sig.signal_iq);
-    free(pcm_accum);
+    // The workspace (buffers + decimator) outlives the thread: engine_free() releases it after the join
     return NULL;
 }
 /** @} */
 
 /**
- * @brief Punto de entrada de la aplicación y Máquina de Estados del Hardware.
- * @details Gestiona el ciclo de vida de alto nivel:
- * 1. Inicializa ZMQ y el hardware HackRF.
- * 2. **Estado Inactivo (Idle)**: Cierra la radio si no se reciben comandos en 15s para ahorrar energía/calor.
- * 3. **Estado Activo**: Detecta cambios de configuración, realiza "Sintonización Perezosa" (lazy tuning), 
- * y gestiona el bucle de procesamiento de PSD a alta velocidad.
- * 4. **Limpieza**: Asegura el cierre de hilos y liberación del hardware ante SIGINT/SIGTERM.
+ * @brief Modo offline: `rf_app --fftw-wisdom [--patient] [N ...]`.
+ * @details Mide planes FFTW para los tamaños dados (por defecto potencias de 2 de 256
+ * a 131072) y los guarda junto a `json/persistent.json` para los siguientes arranques.
  */
-int main() {
+static int run_wisdom_generator(int argc, char **argv) {
+    int patient = 0;
+    int sizes[64];
+    size_t n_sizes = 0;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--patient") == 0) {
+            patient = 1;
+            continue;
+        }
+        int n = atoi(argv[i]);
+        if (n < 2) {
+            fprintf(stderr, "[RF] Error: Invalid FFT size '%s'\n", argv[i]);
+            return 1;
+        }
+        if (n_sizes < sizeof(sizes) / sizeof(sizes[0])) sizes[n_sizes++] = n;
+    }
 
-    // 1. Force OpenMP to yield CPU instead of spinning
-    // must be set before OpenMP runtime initializes
-    setenv("OMP_WAIT_POLICY", "PASSIVE", 1); 
-    
-    // 2. Prevent OpenMP from binding threads to specific cores (let OS scheduler decide)
-    setenv("OMP_PROC_BIND", "FALSE", 1); 
+    return fft_wisdom_generate(sizes, n_sizes, patient) == 0 ? 0 : 1;
+}
 
-    // 3. Limit threads to Cores - 1 (Assuming Pi has 4 cores, use 3)
-    omp_set_num_threads(3);
+/**
+ * @brief Nombre de variable de `.env` del motor @p id: `KEY` para el 0, `KEY_<id>` para el resto.
+ */
+static void engine_env_name(char *out, size_t cap, const char *key, int id) {
+    if (id == 0) snprintf(out, cap, "%s", key);
+    else snprintf(out, cap, "%s_%d", key, id);
+}
 
-    // Desactiva el buffering de stdout completamente
-    setvbuf(stdout, NULL, _IONBF, 0);
-    setvbuf(stderr, NULL, _IONBF, 0);
-    
-    signal(SIGINT, handle_sigint);
-    signal(SIGTERM, handle_sigint);
-    signal(SIGPIPE, SIG_IGN); // Added to prevent crash on broken TCP audio pipes
+/**
+ * @brief Resuelve un endpoint ZMQ del motor @p id.
+ * @details Usa `KEY_<id>` si está definido; si no, el endpoint del motor 0 (o @p def) con el
+ * sufijo `_<id>`, de modo que dos radios nunca comparten socket.
+ */
+static void engine_env_addr(char *out, size_t cap, const char *key, int id, const char *def) {
+    char name[64];
+    engine_env_name(name, sizeof(name), key, id);
+    char *v = getenv_c(name);
+    if (v && v[0]) {
+        snprintf(out, cap, "%s", v);
+    } else {
+        char *base = (id == 0) ? NULL : getenv_c(key);
+        const char *b = (base && base[0]) ? base : def;
+        if (id == 0) snprintf(out, cap, "%s", b);
+        else snprintf(out, cap, "%s_%d", b, id);
+        free(base);
+    }
+    free(v);
+}
 
-    char *ipc_addr = getenv_c("IPC_ADDR");
-    if (!ipc_addr) ipc_addr = strdup("ipc:///tmp/rf_engine");
-    
-    printf("[RF] Starting Engine. IPC=%s\n", ipc_addr);
+/**
+ * @brief Radios a manejar según `HACKRF_SERIALS` (lista separada por comas o `all`).
+ * @details Sin la variable (o con `--replay`) hay un único motor que abre el primer HackRF libre.
+ * Llamar después de `hackrf_init()`.
+ * @param[out] serials Números de serie ("" = primer HackRF libre).
+ * @param replay El proceso reproduce una grabación.
+ * @return Motores a crear (1..@ref RF_MAX_RADIOS).
+ */
+static int engine_serials(char serials[][SDR_SERIAL_LEN], bool replay) {
+    serials[0][0] = '\0';
+    char *env = replay ? NULL : getenv_c("HACKRF_SERIALS");
+    int n = 0;
+    if (env && strcasecmp(env, "all") == 0) {
+        n = sdr_hackrf_list(serials, RF_MAX_RADIOS);
+        if (n <= 0) fprintf(stderr, "[RF] Warning: HACKRF_SERIALS=all found no device\n");
+    } else if (env) {
+        char *save = NULL;
+        for (char *tok = strtok_r(env, ", ", &save); tok && n < RF_MAX_RADIOS; tok = strtok_r(NULL, ", ", &save)) {
+            snprintf(serials[n++], SDR_SERIAL_LEN, "%s", tok);
+        }
+    }
+    free(env);
+    if (n <= 0) {
+        serials[0][0] = '\0';
+        n = 1;
+    }
+    return n;
+}
 
-    zmq_channel = zpair_init(ipc_addr, 0);
-    if (!zmq_channel) return 1;
+/**
+ * @brief Prepara un motor: endpoints, canal de control, ring buffers y workspace de audio.
+ * @param e Motor (a cero).
+ * @param id Índice del radio.
+ * @param serial Número de serie ("" = primer HackRF libre).
+ * @return 0 en éxito, -1 si falló.
+ */
+static int engine_init(rf_engine_t *e, int id, const char *serial) {
+    e->id = id;
+    // No eventfd yet: engine_free() on a half-built engine must not close fd 0
+    e->rb.wake_fd = -1;
+    e->audio_rb.wake_fd = -1;
+    snprintf(e->serial, sizeof(e->serial), "%.*s", SDR_SERIAL_LEN - 1, serial ? serial : "");
+    e->stop_streaming = true;
+    e->request_cooldown_s = 1.0;
+    atomic_init(&e->audio_enabled, false);
+    atomic_init(&e->calibration_running, false);
+    atomic_init(&e->rx_pin_failed, false);
+    atomic_init(&e->audio_underruns, 0);
+    atomic_init(&e->audio_tx_dropped, 0);
+    if (id == 0) snprintf(e->ppm_key, sizeof(e->ppm_key), "ppm_error");
+    else snprintf(e->ppm_key, sizeof(e->ppm_key), "ppm_error_%d", id);
+    e->cal_temp_c = NAN;
+    calibration_cache_load(e);
+
+    // Reference carriers for the fast calibration (the legal FM stations around the node)
+    char *cal_refs = getenv_c("CAL_FM_REFS");
+    e->n_cal_refs = fm_cal_parse_refs(cal_refs, e->cal_refs_hz, RF_CAL_MAX_REFS);
+    free(cal_refs);
+
+    // The control ROUTER connects to every client endpoint: realtime/tools and the campaign runner
+    char ipc_main[256], ipc_campaign[256];
+    engine_env_addr(ipc_main, sizeof(ipc_main), "IPC_ADDR", id, "ipc:///tmp/rf_engine");
+    engine_env_addr(ipc_campaign, sizeof(ipc_campaign), "IPC_ADDR_CAMPAIGN", id, "ipc:///tmp/rf_engine_campaign");
+    snprintf(e->ipc_addr, sizeof(e->ipc_addr), "%s,%s", ipc_main, ipc_campaign);
+    engine_env_addr(e->pub_addr, sizeof(e->pub_addr), "PSD_PUB_ADDR", id, "ipc:///tmp/rf_psd_stream");
+
+    printf("[RF] Starting Engine %d (serial %s). IPC=%s\n", id, e->serial[0] ? e->serial : "any", e->ipc_addr);
+
+    e->zmq_channel = zpair_init(e->ipc_addr, 0);
+    if (!e->zmq_channel) return -1;
+    zpair_set_query(e->zmq_channel, control_query, e);
 
-    printf("[RF] Initializing HackRF Library...\n");
-    while (hackrf_init() != HACKRF_SUCCESS) {
-        fprintf(stderr, "[RF] Error: HackRF Init failed. Retrying in 5s...\n");
-        sleep(5);
+    // --- AUDIO & RING BUFFER INIT ---
+    size_t FIXED_BUFFER_SIZE = (size_t)128 * 1024 * 1024; // power of two: ring indices are masked
+    if (rb_init_mirrored(&e->rb, FIXED_BUFFER_SIZE) == 0) {
+        printf("[RF] Ring buffer: %zu MB (mirrored mapping)\n", e->rb.size / (1024 * 1024));
+    } else {
+        rb_init(&e->rb, FIXED_BUFFER_SIZE);
     }
-    printf("[RF] HackRF Library Initialized.\n");
 
-    // --- AUDIO & RING BUFFER INIT ---
-    size_t FIXED_BUFFER_SIZE = 100 * 1024 * 1024; 
-    rb_init(&rb, FIXED_BUFFER_SIZE);
-    
     // Audio ring buffer initialization
     size_t AUDIO_BUFFER_SIZE = AUDIO_CHUNK_SAMPLES * 2 * 8;
-    rb_init(&audio_rb, AUDIO_BUFFER_SIZE);
-
-    // Audio resource allocation
-    fm_radio_t *radio_ptr = (fm_radio_t*)malloc(sizeof(fm_radio_t));
-    am_radio_local_t *am_ptr = (am_radio_local_t*)malloc(sizeof(am_radio_local_t));
-    if (!radio_ptr || !am_ptr) {
-        fprintf(stderr, "[RF] FATAL: malloc radio resources failed\n");
-        return 1;
+    rb_init(&e->audio_rb, AUDIO_BUFFER_SIZE);
+
+    // Audio streaming context setup: radios and buffers live in one workspace reserved here once
+    audio_stream_ctx_t *audio_ctx = &e->audio_ctx;
+    audio_stream_ctx_defaults(audio_ctx, &e->audio_ws.fm, &e->audio_ws.am);
+    if (id > 0) {
+        // Each radio streams to its own gateway port
+        char name[64];
+        engine_env_name(name, sizeof(name), "AUDIO_TCP_PORT", id);
+        const char *env_port = getenv(name);
+        const int port = (env_port && env_port[0]) ? atoi(env_port) : audio_ctx->tcp_port + id;
+        if (port > 0 && port < 65536) audio_ctx->tcp_port = port;
     }
-    memset(radio_ptr, 0, sizeof(fm_radio_t));
-    memset(am_ptr, 0, sizeof(am_radio_local_t));
-
-    bool audio_thread_created = false;
-    double last_radio_sample_rate = 0.0;
-    rf_processing_workspace_t proc_ws = {0};
+    if (audio_workspace_init(&e->audio_ws, (audio_ctx->opus_sample_rate * audio_ctx->frame_ms) / 1000) != 0) {
+        fprintf(stderr, "[RF] FATAL: audio workspace allocation failed\n");
+        return -1;
+    }
+    audio_ctx->ws = &e->audio_ws;
 
-    // Audio streaming context setup
-    audio_stream_ctx_t audio_ctx;
-    audio_stream_ctx_defaults(&audio_ctx, radio_ptr, am_ptr);
+    fprintf(stderr, "[AUDIO] Radio %d stream target %s %s:%d (Opus sr=%d ch=%d)\n", id,
+            (audio_ctx->transport == OPUS_TX_RTP) ? "RTP/UDP" : "TCP",
+            audio_ctx->tcp_host, audio_ctx->tcp_port,
+            audio_ctx->opus_sample_rate, audio_ctx->opus_channels);
+    return 0;
+}
 
-    fprintf(stderr, "[AUDIO] Stream target TCP %s:%d (Opus sr=%d ch=%d)\n",
-            audio_ctx.tcp_host, audio_ctx.tcp_port,
-            audio_ctx.opus_sample_rate, audio_ctx.opus_channels);
+/**
+ * @brief Bucle de requests de un motor hasta que @ref keep_running se desactiva.
+ * @param e Motor preparado por @ref engine_init.
+ */
+static void engine_run(rf_engine_t *e) {
+    double last_radio_sample_rate = 0.0;
 
     struct timespec last_activity_time;
     clock_gettime(CLOCK_MONOTONIC, &last_activity_time);
@@ -1287,20 +2635,33 @@ int main() {
     RB_cfg_t local_rb;
     PsdConfig_t local_psd;
     DesiredCfg_t local_desired;
-    static struct timespec last_psd_run = {0};
+    struct timespec last_psd_run = {0};
+    bool pending_request = false;
 
     while (keep_running) {
-        int req_len = zpair_recv(zmq_channel);
+        int req_len = pending_request ? (int)strlen(e->zmq_channel->buffer) : zpair_recv(e->zmq_channel);
+        pending_request = false;
         if (req_len == 0) {
             struct timespec now;
             clock_gettime(CLOCK_MONOTONIC, &now);
             double elapsed = (now.tv_sec - last_activity_time.tv_sec) +
                              (now.tv_nsec - last_activity_time.tv_nsec) / 1e9;
 
-            if (elapsed >= 15.0 && device != NULL && !atomic_load(&calibration_running)) {
-                printf("[RF] Idle timeout (%.1fs). Closing radio.\n", elapsed);
-                invalidate_hackrf_state("idle_timeout");
+            if (elapsed >= RF_IDLE_STANDBY_S && !atomic_load(&e->calibration_running)) {
+                if (sdr_replay_is_streaming(e->replay)) {
+                    printf("[RF] Idle timeout (%.1fs). Closing radio.\n", elapsed);
+                    invalidate_hackrf_state(e, "idle_timeout");
+                } else if (e->device != NULL && !e->standby) {
+                    hackrf_enter_standby(e);
+                } else if (e->standby && RF_IDLE_CLOSE_S > 0.0 && elapsed >= RF_IDLE_CLOSE_S) {
+                    printf("[RF] Idle timeout (%.1fs). Closing radio.\n", elapsed);
+                    invalidate_hackrf_state(e, "idle_timeout");
+                } else if (e->recovery_pending && RF_IDLE_CLOSE_S > 0.0 && elapsed >= RF_IDLE_CLOSE_S) {
+                    // The radio would be closed by now anyway: the next request re-opens it
+                    e->recovery_pending = false;
+                }
             }
+            if (e->standby || e->recovery_pending) standby_probe(e);
             continue;
         }
 
@@ -1310,18 +2671,44 @@ int main() {
         }
 
         printf("[RF]<<<<<zmq\n");
-        if (parse_config_rf(zmq_channel->buffer, &local_desired) != 0) {
-            send_status_reply("error", "invalid_request");
+        rf_req_metrics_t req_metrics;
+        rf_metrics_begin(&req_metrics);
+        if (parse_config_rf(e->zmq_channel->buffer, &local_desired) != 0) {
+            send_status_reply(e, "error", "invalid_request");
+            continue;
+        }
+
+        if (local_desired.stats_request) {
+            send_stats_reply(e, local_desired.stats_reset);
+            continue;
+        }
+
+        if (e->replay && (local_desired.calibrate || local_desired.sweep_enabled)) {
+            // Both need a tunable front-end
+            send_status_reply(e, "error", "replay_unsupported");
             continue;
         }
 
         if (local_desired.calibrate) {
-            float cal_ppm = calibrate_hackrf();
+            const double temp_c = read_board_temp_c();
+            double age_s = 0.0;
+            const bool cached = !local_desired.calibrate_force && calibration_cache_fresh(e, temp_c, &age_s);
+            float cal_ppm = e->cal_ppm;
+            if (!cached) {
+                double shm_refs[RF_CAL_MAX_REFS];
+                const double *refs = shm_refs;
+                const int n_refs = calibration_refs(e, &local_desired, shm_refs, &refs);
+                cal_ppm = calibrate_hackrf(e, refs, n_refs);
+            }
+            if (cached) printf("[RF] Calibration cached: ppm=%.3f age=%.0fs\n", (double)cal_ppm, age_s);
             cJSON *response = cJSON_CreateObject();
             if (response) {
                 cJSON_AddStringToObject(response, "status", "calibration_complete");
                 cJSON_AddNumberToObject(response, "ppm_error", (double)cal_ppm);
-                if (send_json_reply(response) == 0) {
+                cJSON_AddBoolToObject(response, "cached", cached);
+                if (cached) cJSON_AddNumberToObject(response, "age_s", age_s);
+                if (isfinite(temp_c)) cJSON_AddNumberToObject(response, "temp_c", temp_c);
+                if (send_json_reply(e, response) == 0) {
                     printf("[RF] Respuesta de calibración enviada: ppm=%.6f\n", cal_ppm);
                 } else {
                     printf("[RF] Error al enviar respuesta de calibración\n");
@@ -1332,103 +2719,136 @@ int main() {
             continue;
         }
 
-        apply_runtime_request(&local_desired, &local_hack, &local_psd, &local_rb);
+        if (e->replay) {
+            // A recording cannot be retuned: analyse it at its own rate and frequency
+            const SDR_cfg_t *rec = sdr_replay_cfg(e->replay);
+            if ((rec->sample_rate > 0.0 && fabs(local_desired.sample_rate - rec->sample_rate) > 1e-6) ||
+                (rec->center_freq != 0 && local_desired.center_freq != rec->center_freq)) {
+                printf("[RF] Replay: request overridden to recorded %" PRIu64 " Hz @ %.0f Sps\n",
+                       rec->center_freq, rec->sample_rate);
+            }
+            if (rec->sample_rate > 0.0) local_desired.sample_rate = rec->sample_rate;
+            if (rec->center_freq != 0) local_desired.center_freq = rec->center_freq;
+        }
+
+        req_metrics.cfg_cache_hit = apply_runtime_request(e, &local_desired, &local_hack, &local_psd, &local_rb);
+        if (e->replay) sdr_replay_apply_cfg(e->replay, &local_hack);
 
-        atomic_store(&audio_ctx.current_mode, (int)local_desired.rf_mode);
-        atomic_store(&audio_ctx.current_fs_hz, (double)local_hack.sample_rate);
+        atomic_store(&e->audio_ctx.current_mode, (int)local_desired.rf_mode);
+        atomic_store(&e->audio_ctx.current_fs_hz, (double)local_hack.sample_rate);
         clock_gettime(CLOCK_MONOTONIC, &last_activity_time);
 
-        if (ensure_hackrf_session_is_healthy() != 0) {
-            send_status_reply("error", "hackrf_unavailable");
+        if (ensure_hackrf_session_is_healthy(e) != 0) {
+            send_status_reply(e, "error", "hackrf_unavailable");
             clock_gettime(CLOCK_MONOTONIC, &last_activity_time);
             continue;
         }
 
-        if (device == NULL) {
-            if (hackrf_open(&device) != HACKRF_SUCCESS || ensure_hackrf_session_is_healthy() != 0 || device == NULL) {
-                invalidate_hackrf_state("hackrf_open_failed");
-                send_status_reply("error", "hackrf_open_failed");
+        if (e->device == NULL && !e->replay) {
+            if (sdr_hackrf_open(e->serial, &e->device) != HACKRF_SUCCESS || ensure_hackrf_session_is_healthy(e) != 0 || e->device == NULL) {
+                invalidate_hackrf_state(e, "hackrf_open_failed");
+                send_status_reply(e, "error", "hackrf_open_failed");
                 clock_gettime(CLOCK_MONOTONIC, &last_activity_time);
                 continue;
             }
         }
 
-        bool needs_tune = (local_hack.center_freq != current_hw_cfg.center_freq ||
-                           local_hack.sample_rate != current_hw_cfg.sample_rate ||
-                           local_hack.lna_gain    != current_hw_cfg.lna_gain    ||
-                           local_hack.vga_gain    != current_hw_cfg.vga_gain    ||
-                   fabs((double)local_hack.ppm_error - (double)current_hw_cfg.ppm_error) > 1e-6);
+        bool needs_tune = (local_hack.center_freq != e->current_hw_cfg.center_freq ||
+                           local_hack.sample_rate != e->current_hw_cfg.sample_rate ||
+                           local_hack.lna_gain    != e->current_hw_cfg.lna_gain    ||
+                           local_hack.vga_gain    != e->current_hw_cfg.vga_gain    ||
+                   fabs((double)local_hack.ppm_error - (double)e->current_hw_cfg.ppm_error) > 1e-6);
 
         if (needs_tune) {
             printf("[HAL] Tuning: %" PRIu64 " Hz | LNA: %u | VGA: %u\n", 
                     local_hack.center_freq, local_hack.lna_gain, local_hack.vga_gain);
-            hackrf_apply_cfg(device, &local_hack);
-            memcpy(&current_hw_cfg, &local_hack, sizeof(SDR_cfg_t));
-            
-            usleep(150000); 
-            rb_reset(&rb); 
-            rb_reset(&audio_rb); // Also reset audio buffer on tune
+            if (!e->replay) {
+                hackrf_apply_cfg(e->device, &local_hack);
+                usleep(150000);
+            }
+            memcpy(&e->current_hw_cfg, &local_hack, sizeof(SDR_cfg_t));
+
+            rb_reset(&e->rb); 
+            rb_reset(&e->audio_rb); // Also reset audio buffer on tune
+            rx_timing_reset(&e->rx_timing, local_hack.sample_rate);
+        }
+        if (e->standby) {
+            // Warm resume: the device is open and, unless retuned above, already configured
+            hackrf_leave_standby(e);
+            e->standby_resumes++;
         }
 
         // --- AUDIO THREAD & RADIO INIT ---
-        // Initialize or re-init radios only if sample_rate changed
-        if (!audio_thread_created || fabs(last_radio_sample_rate - local_hack.sample_rate) > 1e-6) {
-            fm_radio_init(radio_ptr, local_hack.sample_rate, audio_ctx.opus_sample_rate, 75);
-            am_radio_local_init(am_ptr, local_hack.sample_rate, audio_ctx.opus_sample_rate);
+        // The audio thread (re)initializes the demodulators at its decimated rate
+        // whenever mode/sample_rate change; here only the metrics window is reset.
+        if (!e->audio_thread_created || fabs(last_radio_sample_rate - local_hack.sample_rate) > 1e-6) {
             last_radio_sample_rate = local_hack.sample_rate;
 
             // Reset metrics window state
-            memset(&audio_ctx.fm_dev, 0, sizeof(audio_ctx.fm_dev));
-            memset(&audio_ctx.am_depth, 0, sizeof(audio_ctx.am_depth));
-            audio_ctx.am_depth.env_min = 1e9f;
-            audio_ctx.am_depth.report_samples = (uint32_t)audio_ctx.opus_sample_rate;
+            memset(&e->audio_ctx.fm_dev, 0, sizeof(e->audio_ctx.fm_dev));
+            memset(&e->audio_ctx.am_depth, 0, sizeof(e->audio_ctx.am_depth));
+            e->audio_ctx.am_depth.env_min = 1e9f;
+            e->audio_ctx.am_depth.report_samples = (uint32_t)e->audio_ctx.opus_sample_rate;
         }
 
         // Start audio thread once
-        if (!audio_thread_created) {
-            if (pthread_create(&audio_thread, NULL, audio_thread_fn, (void*)&audio_ctx) == 0) {
-                audio_thread_created = true;
+        if (!e->audio_thread_created) {
+            if (pthread_create(&e->audio_thread, NULL, audio_thread_fn, e) == 0) {
+                e->audio_thread_created = true;
             } else {
-                fprintf(stderr, "[RF] Warning: failed to create audio thread\n");
+                fprintf(stderr, "[RF] Warning: radio %d: failed to create audio thread\n", e->id);
             }
         }
 
-        if (stop_streaming) {
-            rb_reset(&rb);
-            rb_reset(&audio_rb);
-            stop_streaming = false;
-            if (hackrf_start_rx(device, rx_callback, NULL) != HACKRF_SUCCESS) {
-                invalidate_hackrf_state("rx_start_failed");
-                send_status_reply("error", "rx_start_failed");
+        if (e->stop_streaming) {
+            rb_reset(&e->rb);
+            rb_reset(&e->audio_rb);
+            rx_timing_reset(&e->rx_timing, local_hack.sample_rate);
+            e->stop_streaming = false;
+            if (source_start_rx(e) != 0) {
+                invalidate_hackrf_state(e, "rx_start_failed");
+                send_status_reply(e, "error", "rx_start_failed");
                 clock_gettime(CLOCK_MONOTONIC, &last_activity_time);
                 continue;
             }
         }
 
+        if (local_desired.sweep_enabled) {
+            if (run_psd_sweep(e, &local_desired, &local_hack, &local_psd, &local_rb, &e->proc_ws, &req_metrics) == 0) {
+                rf_metrics_commit(&e->metrics, &req_metrics);
+            }
+            clock_gettime(CLOCK_MONOTONIC, &last_activity_time);
+            continue;
+        }
+
+        if (local_desired.stream_enabled) {
+            pending_request = run_psd_stream(e, &local_desired, &local_hack, &local_psd, &local_rb,
+                                             &e->proc_ws, &e->audio_ctx);
+            clock_gettime(CLOCK_MONOTONIC, &last_activity_time);
+            continue;
+        }
+
         /*
          * Enforce request-scoped capture semantics:
          * discard any unread IQ accumulated before this request so the reply can
          * only be built from samples captured after the request arrived.
          */
-        rb_discard_all(&rb);
-
-        struct timespec ts_timeout;
-        clock_gettime(CLOCK_REALTIME, &ts_timeout);
-        ts_timeout.tv_sec += 5;
-
-        pthread_mutex_lock(&rb_mutex);
-        while (keep_running && rb_available(&rb) < local_rb.total_bytes) {
-            int rc = pthread_cond_timedwait(&rb_cond, &rb_mutex, &ts_timeout);
-            if (rc == ETIMEDOUT) {
-                break;
-            }
+        rb_discard_all(&e->rb);
+
+        const size_t dropped0 = rb_dropped(&e->rb);
+        uint64_t t_wait = rf_metrics_now_ns();
+        const bool acquired = wait_for_rb_bytes(e, local_rb.total_bytes, 5);
+        rf_metrics_lap(&req_metrics, RF_STAGE_ACQ_WAIT, &t_wait);
+        if (!e->rx_pin_logged && atomic_load(&e->rx_pin_failed)) {
+            fprintf(stderr, "[RF] Warning: radio %d could not pin its USB thread (cpu %d, fifo prio %d)\n",
+                    e->id, e->affinity.io_cpu, e->affinity.io_fifo_prio);
+            e->rx_pin_logged = true;
         }
-        pthread_mutex_unlock(&rb_mutex);
 
-        if (rb_available(&rb) < local_rb.total_bytes && keep_running) {
+        if (!acquired && keep_running) {
             fprintf(stderr, "[RF] Error: Acquisition Timeout (buffer empty).\n");
-            invalidate_hackrf_state("acquisition_timeout");
-            send_status_reply("error", "acquisition_timeout");
+            invalidate_hackrf_state(e, "acquisition_timeout");
+            send_status_reply(e, "error", "acquisition_timeout");
             clock_gettime(CLOCK_MONOTONIC, &last_activity_time);
             continue;
         }
@@ -1455,86 +2875,208 @@ int main() {
             }
         }
 
-        if (rf_workspace_ensure(&proc_ws, local_rb.total_bytes, local_psd.nperseg) == 0) {
-            size_t buf_bytes = local_rb.total_bytes;
-            size_t iq_points = buf_bytes / 2; /* interleaved I,Q each 1 byte */
-            double buf_mb = (double)buf_bytes / (1024.0 * 1024.0);
-            fprintf(stderr, "[RF] linear_buffer: %zu bytes (%zu IQ points), %.3f MB; PSD nperseg=%d\n",
-                    buf_bytes, iq_points, buf_mb, local_psd.nperseg);
-            rb_read(&rb, proc_ws.linear_buffer, local_rb.total_bytes);
+        char record_base[IQ_RECORD_PATH_MAX];
+        if (local_desired.record) {
+            (void)record_capture(e, &local_hack, local_rb.total_bytes, record_base, sizeof(record_base));
+        }
+
+        const char *psd_err = compute_psd_from_rb(e, &local_desired, &local_hack, &local_psd,
+                                                  local_rb.total_bytes, &e->proc_ws, true, &req_metrics);
+        if (psd_err == NULL) {
+            req_metrics.rb_dropped_bytes = rb_dropped(&e->rb) - dropped0;
+            const uint32_t avg_count = apply_trace_average(e, &local_desired, &local_psd, e->proc_ws.psd,
+                                                           local_desired.avg_reset);
+            rf_publish_opts_t reply_opts = { local_desired.reply_format, RF_SINK_REPLY, 0,
+                                             &req_metrics, local_desired.metrics_enabled, avg_count,
+                                             local_desired.record ? record_base : NULL, &local_desired.detect };
+            if (publish_results(e, 
+                e->proc_ws.psd,
+                &local_psd,
+                &local_hack,
+                local_desired.center_freq,
+                (int)local_desired.rf_mode,
+                e->audio_ctx.am_depth.depth_ema,
+                e->audio_ctx.fm_dev.dev_ema_hz,
+                &reply_opts,
+                &e->proc_ws
+            ) != 0) {
+                fprintf(stderr, "[RF] Error: Failed to send PSD reply.\n");
+                clock_gettime(CLOCK_MONOTONIC, &last_activity_time);
+                continue;
+            }
+            rf_metrics_commit(&e->metrics, &req_metrics);
+
+            {
+                uint64_t tuned_fc = local_hack.center_freq_corrected;
+                if (tuned_fc == 0) tuned_fc = local_hack.center_freq;
+                printf("[RF_PSD] Acquisition | PPM Error: %.3f | Fc_nom: %" PRIu64 " Hz | Fc_tuned: %" PRIu64 " Hz\n",
+                       local_hack.ppm_error, local_hack.center_freq, tuned_fc);
+            }
+
+            clock_gettime(CLOCK_MONOTONIC, &last_psd_run);
+        } else {
+            send_status_reply(e, "error", psd_err);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &last_activity_time);
+    }
 
-            if (load_iq_into_signal(proc_ws.linear_buffer, local_rb.total_bytes, &proc_ws.sig) == 0) {
-                iq_compensation(&proc_ws.sig);
-                if (local_desired.filter_enabled) {
-                    chan_filter_apply_inplace_abs(&proc_ws.sig, &local_desired.filter_cfg,
-                                                  local_hack.center_freq_corrected, local_hack.sample_rate);
-                }
+    printf("[RF] Engine %d stopping...\n", e->id);
+    // Thread-local filter plans belong to this engine's thread
+    chan_filter_free_cache();
+}
 
-                if (local_desired.method_psd == PFB) {
-                    execute_pfb_psd(&proc_ws.sig, &local_psd, proc_ws.freq, proc_ws.psd);
-                } else {
-                    execute_welch_psd(&proc_ws.sig, &local_psd, proc_ws.freq, proc_ws.psd);
-                }
+/**
+ * @brief Libera los recursos de un motor (hilo de audio incluido).
+ */
+static void engine_free(rf_engine_t *e) {
+    e->audio_thread_running = false; // Flag for audio thread to exit
+    rb_wake(&e->audio_rb);
+    if (e->audio_thread_created) pthread_join(e->audio_thread, NULL);
+    e->audio_thread_created = false;
+
+    zpair_close(e->zmq_channel);
+    zpub_close(e->zmq_stream);
+    e->zmq_channel = NULL;
+    e->zmq_stream = NULL;
+    rb_free(&e->rb);
+    rb_free(&e->audio_rb);
+    rf_workspace_release(&e->proc_ws);
+    rf_workspace_release(&e->calibration_ws);
+    rf_workspace_release(&e->stream_ws);
+    psd_avg_free(&e->psd_avg);
+
+    if (e->device) {
+        hackrf_stop_rx(e->device);
+        hackrf_close(e->device);
+        e->device = NULL;
+    }
+    if (e->replay) {
+        sdr_replay_close(e->replay);
+        e->replay = NULL;
+    }
+    audio_workspace_free(&e->audio_ws);
+}
 
-                if (publish_results(
-                    proc_ws.psd,
-                    local_psd.nperseg,
-                    &local_hack,
-                    local_desired.center_freq,
-                    (int)local_desired.rf_mode,
-                    audio_ctx.am_depth.depth_ema,
-                    audio_ctx.fm_dev.dev_ema_hz
-                ) != 0) {
-                    fprintf(stderr, "[RF] Error: Failed to send PSD reply.\n");
-                    clock_gettime(CLOCK_MONOTONIC, &last_activity_time);
-                    continue;
-                }
+/**
+ * @brief Hilo de los motores 1..n-1: fija su parte del equipo PSD y corre su bucle.
+ */
+static void *engine_thread_fn(void *arg) {
+    rf_engine_t *e = (rf_engine_t*)arg;
+    rf_affinity_apply_psd(&e->affinity);
+    engine_run(e);
+    return NULL;
+}
 
-                {
-                    uint64_t tuned_fc = local_hack.center_freq_corrected;
-                    if (tuned_fc == 0) tuned_fc = local_hack.center_freq;
-                    printf("[RF_PSD] Acquisition | PPM Error: %.3f | Fc_nom: %" PRIu64 " Hz | Fc_tuned: %" PRIu64 " Hz\n",
-                           local_hack.ppm_error, local_hack.center_freq, tuned_fc);
-                }
+/**
+ * @brief Punto de entrada de la aplicación y Máquina de Estados del Hardware.
+ * @details Gestiona el ciclo de vida de alto nivel:
+ * 1. Inicializa ZMQ y el hardware HackRF.
+ * 2. **Estado Inactivo (Idle)**: Tras 15 s sin comandos detiene la RX y apaga el amplificador, dejando el
+ * HackRF abierto y configurado en espera (una sonda de salud lo vigila) para reanudar sin reabrir ni
+ * resintonizar; el cierre completo solo ocurre tras @ref RF_IDLE_CLOSE_S (0 = nunca).
+ * 3. **Estado Activo**: Detecta cambios de configuración, realiza "Sintonización Perezosa" (lazy tuning), 
+ * y gestiona el bucle de procesamiento de PSD a alta velocidad.
+ * 4. **Limpieza**: Asegura el cierre de hilos y liberación del hardware ante SIGINT/SIGTERM.
+ */
+int main(int argc, char **argv) {
+
+    if (argc > 1 && strcmp(argv[1], "--fftw-wisdom") == 0) {
+        return run_wisdom_generator(argc, argv);
+    }
+
+    // Offline source: rf_app --replay <capture[.sigmf-data]> [--replay-fast] [--replay-loop]
+    const char *replay_path = NULL;
+    bool replay_fast = false, replay_loop = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) replay_path = argv[++i];
+        else if (strcmp(argv[i], "--replay-fast") == 0) replay_fast = true;
+        else if (strcmp(argv[i], "--replay-loop") == 0) replay_loop = true;
+    }
+
+    // 1. Force OpenMP to yield CPU instead of spinning
+    // must be set before OpenMP runtime initializes
+    setenv("OMP_WAIT_POLICY", "PASSIVE", 1); 
+    
+    // 2. Prevent OpenMP from binding threads on its own: placement comes from RF_PSD_CPUS
+    setenv("OMP_PROC_BIND", "FALSE", 1); 
+
+    // 3. Team size and pinning from .env (default 3 = Pi cores - 1, unpinned), split per radio below
+    rf_affinity_load(&g_affinity);
+    rf_affinity_log(&g_affinity);
+
+    // Desactiva el buffering de stdout completamente
+    setvbuf(stdout, NULL, _IONBF, 0);
+    setvbuf(stderr, NULL, _IONBF, 0);
+    
+    signal(SIGINT, handle_sigint);
+    signal(SIGTERM, handle_sigint);
+    signal(SIGPIPE, SIG_IGN); // Added to prevent crash on broken TCP audio pipes
+
+    // Measured FFT plans from previous runs (before any planner is invoked)
+    fft_wisdom_load();
+
+    if (!replay_path) {
+        printf("[RF] Initializing HackRF Library...\n");
+        while (hackrf_init() != HACKRF_SUCCESS) {
+            fprintf(stderr, "[RF] Error: HackRF Init failed. Retrying in 5s...\n");
+            sleep(5);
+        }
+        printf("[RF] HackRF Library Initialized.\n");
+    }
 
-                clock_gettime(CLOCK_MONOTONIC, &last_psd_run);
+    // One engine per radio: its own device, ring buffers, control socket and OpenMP team
+    char serials[RF_MAX_RADIOS][SDR_SERIAL_LEN];
+    const int n_radios = engine_serials(serials, replay_path != NULL);
+    int rc = 0;
+    for (int k = 0; k < n_radios; k++) {
+        // Radio k keeps its id (endpoints, ports, PPM key); a failed radio frees its slot for the next one
+        rf_engine_t *e = &g_engines[g_n_engines];
+        rf_affinity_split(&g_affinity, k, n_radios, &e->affinity);
+        if (engine_init(e, k, serials[k]) != 0) {
+            // Losing an extra radio must not take down the others
+            fprintf(stderr, "[RF] %s: engine %d (serial %s) init failed\n", k == 0 ? "FATAL" : "Error",
+                    k, serials[k][0] ? serials[k] : "any");
+            engine_free(e);
+            memset(e, 0, sizeof(*e));
+            if (k == 0) {
+                rc = 1;
+                break;
+            }
+            continue;
+        }
+        g_n_engines++;
+    }
+
+    if (rc == 0 && replay_path &&
+        sdr_replay_open(replay_path, !replay_fast, replay_loop, &g_engines[0].replay) != 0) {
+        fprintf(stderr, "[RF] FATAL: cannot open replay source %s\n", replay_path);
+        rc = 1;
+    }
+
+    if (rc == 0) {
+        for (int k = 1; k < g_n_engines; k++) {
+            rf_engine_t *e = &g_engines[k];
+            if (pthread_create(&e->thread, NULL, engine_thread_fn, e) == 0) {
+                e->thread_started = true;
             } else {
-                fprintf(stderr, "[RF] Error: Failed to load IQ signal into reusable workspace.\n");
-                send_status_reply("error", "signal_load_failed");
+                fprintf(stderr, "[RF] Error: failed to start engine %d (serial %s)\n", e->id, e->serial);
             }
-        } else {
-            fprintf(stderr, "[RF] Error: Workspace allocation failed (%zu bytes, nperseg=%d).\n",
-                    local_rb.total_bytes, local_psd.nperseg);
-            send_status_reply("error", "workspace_allocation_failed");
         }
 
-        clock_gettime(CLOCK_MONOTONIC, &last_activity_time);
+        // Engine 0 keeps the main thread (and, with a single radio, the whole PSD team)
+        rf_affinity_apply_psd(&g_engines[0].affinity);
+        engine_run(&g_engines[0]);
     }
 
     // --- CLEANUP ---
     printf("[RF] Shutting down...\n");
-    audio_thread_running = false; // Flag for audio thread to exit
-    pthread_mutex_lock(&audio_rb_mutex);
-    pthread_cond_broadcast(&audio_rb_cond);
-    pthread_mutex_unlock(&audio_rb_mutex);
-    if (audio_thread_created) pthread_join(audio_thread, NULL);
-    
-    zpair_close(zmq_channel);
-    rb_free(&rb);
-    rb_free(&audio_rb);
-    rf_workspace_release(&proc_ws);
-    rf_workspace_release(&g_calibration_ws);
-    
-    if (device) { 
-        hackrf_stop_rx(device); 
-        hackrf_close(device); 
+    keep_running = false;
+    for (int k = 1; k < g_n_engines; k++) {
+        if (g_engines[k].thread_started) pthread_join(g_engines[k].thread, NULL);
     }
-    hackrf_exit();
-    
-    if (ipc_addr) free(ipc_addr);
-    if (radio_ptr) free(radio_ptr);
-    if (am_ptr) free(am_ptr);
-    chan_filter_free_cache();
-    
-    return 0;
+    for (int k = 0; k < g_n_engines; k++) engine_free(&g_engines[k]);
+    if (!replay_path) hackrf_exit();
+
+    return rc;
 }
@@ -45,6 +45,9 @@ HDR_SIZE = struct.calcsize(HDR_FMT)
 MAGIC    = 0x4F505530
 DEFAULT_FRAME_MS = 20
 RETRY_SECONDS = 5
+# rf_app can send RTP/Opus over UDP to the same port instead of OPU0 frames over TCP
+RTP_MODE = cfg.AUDIO_TRANSPORT in ("rtp", "udp")
+RTP_JITTER_MS = 60
 
 Gst.init(None)
 
@@ -58,6 +61,19 @@ appsrc name=opussrc is-live=true format=time do-timestamp=true !
   wb.sink_0
 """
 
+# RTP ingest: the jitter buffer reorders/conceals using the sensor's seq/timestamps,
+# and the repayloader gives webrtcbin a clean, continuous stream of its own
+PIPELINE_DESC_RTP = f"""
+webrtcbin name=wb bundle-policy=max-bundle stun-server="{STUN_SERVER}"
+udpsrc name=rtpsrc address={TCP_HOST} port={TCP_PORT}
+  caps="application/x-rtp,media=audio,encoding-name=OPUS,clock-rate=48000,payload={PT}" !
+  rtpjitterbuffer latency={RTP_JITTER_MS} drop-on-latency=true !
+  rtpopusdepay !
+  rtpopuspay pt={PT} !
+  queue !
+  wb.sink_0
+"""
+
 class Publisher:
     """
     Maneja el pipeline de GStreamer para procesar y transmitir audio Opus vía WebRTC.
@@ -75,12 +91,13 @@ class Publisher:
         self.glib_loop = GLib.MainLoop()
         self.glib_thread = threading.Thread(target=self.glib_loop.run, daemon=True)
         
-        self.pipe = Gst.parse_launch(PIPELINE_DESC)
+        self.pipe = Gst.parse_launch(PIPELINE_DESC_RTP if RTP_MODE else PIPELINE_DESC)
         self.webrtc = self.pipe.get_by_name("wb")
         self.appsrc = self.pipe.get_by_name("opussrc")
         
-        caps = Gst.Caps.from_string("audio/x-opus, rate=(int)48000, channels=(int)1, channel-mapping-family=(int)0")
-        self.appsrc.set_property("caps", caps)
+        if self.appsrc is not None:
+            caps = Gst.Caps.from_string("audio/x-opus, rate=(int)48000, channels=(int)1, channel-mapping-family=(int)0")
+            self.appsrc.set_property("caps", caps)
 
         self.webrtc.connect("on-negotiation-needed", self.on_negotiation_needed)
         self.webrtc.connect("on-ice-candidate", self.on_ice_candidate)
@@ -149,7 +166,7 @@ class Publisher:
         GLib.idle_add(lambda: self.webrtc.emit("add-ice-candidate", int(mline), cand) and False)
 
     def push_opus_frame(self, opus_bytes: bytes):
-        if not self._running: return
+        if not self._running or self.appsrc is None: return
         dur_ns = int(DEFAULT_FRAME_MS * 1e6)
         def _do():
             if not self._running: return False
@@ -279,8 +296,11 @@ async def main():
     for sig in (signal.SIGINT, signal.SIGTERM):
         loop.add_signal_handler(sig, ask_exit)
 
-    # Start TCP server
-    tcp_task = asyncio.create_task(tcp_reader_task())
+    # Start TCP server (in RTP mode each Publisher pipeline reads UDP itself)
+    if RTP_MODE:
+        log.info(f"[RTP] Ingesting RTP/Opus on udp://{TCP_HOST}:{TCP_PORT}")
+    else:
+        asyncio.create_task(tcp_reader_task())
     
     try:
         # Connection Retry Loop
@@ -5,8 +5,8 @@ Módulo de Utilidades de E/S e Integridad de Datos.
 Este módulo provee herramientas para el manejo seguro de archivos y persistencia:
 
 1. **Escritura Atómica**: Evita la corrupción de archivos en caso de fallos.
-2. **ShmStore**: Almacenamiento basado en RAM (/dev/shm) con bloqueo de archivos 
-   (file locking) para comunicación segura entre procesos.
+2. **ShmStore**: Almacén clave/valor en memoria compartida (/dev/shm/bacn_kv),
+   compartido con los binarios C, con lecturas sin lock y snapshot JSON durable.
 3. **Temporizadores**: Control de flujo basado en tiempo.
 """
 
@@ -18,9 +18,11 @@ import logging
 import json
 import time
 import fcntl
+import mmap
+import struct
 from typing import Any 
 from typing import Optional
-from typing import Callable
+from typing import Tuple
 
 # Configuración del logger local
 log = logging.getLogger(__name__)
@@ -70,108 +72,217 @@ def atomic_write_bytes(target_path: Path, data: bytes) -> None:
         raise
 
 
+#: Layout de ``kv_shm_t`` (common/kv_store.h): cabecera de 64 bytes y slots fijos.
+KV_SHM_PATH = "/dev/shm/bacn_kv"
+KV_MAGIC = 0x30564B42
+KV_VERSION = 1
+KV_SLOTS = 64
+KV_SLOT_SIZE = 4096
+KV_KEY_MAX = 48
+KV_HEADER = struct.Struct("<IIII48x")
+#: ``seq``, ``type``, ``len`` y ``key`` de ``kv_slot_t``.
+KV_SLOT_HEADER = struct.Struct("<IBxH48s")
+KV_VALUE_MAX = KV_SLOT_SIZE - KV_SLOT_HEADER.size
+_KV_EMPTY, _KV_STRING, _KV_JSON, _KV_SNAPSHOT = 0, 1, 2, 3
+_KV_SEQ = struct.Struct("<I")
+
+
+def _kv_hash(key: bytes) -> int:
+    """FNV-1a de 32 bits, igual que ``kv_hash`` en C."""
+    h = 2166136261
+    for c in key:
+        h = ((h ^ c) * 16777619) & 0xFFFFFFFF
+    return h
+
+
 class ShmStore:
     """
     Almacenamiento de persistencia rápida en memoria compartida (RAM).
 
-    Utiliza el sistema de archivos `/dev/shm` de Linux para almacenar un objeto 
-    JSON. Es ideal para compartir variables de estado entre el motor de RF y 
-    los scripts de Python sin desgastar la tarjeta SD.
-
-    
+    Mapea el segmento ``/dev/shm/bacn_kv`` que comparten rf_app y ltegps_app
+    (common/kv_store.h): slots de tamaño fijo direccionados por hash de la
+    clave y protegidos por un seqlock. Las consultas copian el slot sin locks
+    ni parseo del archivo; las escrituras se serializan con ``flock`` sobre el
+    segmento y reescriben el snapshot JSON, que queda como copia durable y se
+    importa si el segmento no existe (p. ej. tras un reinicio).
 
     Atributos:
-        filepath (str): Ruta completa al archivo en la memoria compartida.
+        filepath (str): Ruta del snapshot JSON en la memoria compartida.
     """
 
+    _segment: Optional[Tuple[int, mmap.mmap]] = None
+
     def __init__(self, filename: str = "persistent.json"):
         """
         Inicializa el almacenamiento en RAM.
 
         Args:
-            filename (str): Nombre del archivo JSON persistente.
+            filename (str): Nombre del snapshot JSON persistente.
         """
         self.filepath = os.path.join("/dev/shm", filename)
-        
-        # Inicializa el archivo si no existe (ej. tras un reinicio del sistema)
-        if not os.path.exists(self.filepath):
-            self._write_file({})
+        # The segment is mapped once per process and shared by every instance
+        if ShmStore._segment is None:
+            ShmStore._segment = self._open_segment()
+        self._fd, self._mm = ShmStore._segment
+
+    def _open_segment(self) -> Tuple[int, mmap.mmap]:
+        """Mapea el segmento; si es nuevo o su layout no coincide, lo inicializa desde el snapshot."""
+        size = KV_HEADER.size + KV_SLOTS * KV_SLOT_SIZE
+        fd = os.open(KV_SHM_PATH, os.O_RDWR | os.O_CREAT, 0o666)
+        try:
+            os.fchmod(fd, 0o666)
+        except OSError:
+            pass
+        fcntl.flock(fd, fcntl.LOCK_EX)
+        try:
+            resize = os.fstat(fd).st_size != size
+            if resize:
+                os.ftruncate(fd, size)
+            mm = mmap.mmap(fd, size, mmap.MAP_SHARED, mmap.PROT_READ | mmap.PROT_WRITE)
+            if resize or KV_HEADER.unpack_from(mm, 0) != (KV_MAGIC, KV_VERSION, KV_SLOTS, KV_SLOT_SIZE):
+                mm[:] = bytes(size)
+                KV_HEADER.pack_into(mm, 0, 0, KV_VERSION, KV_SLOTS, KV_SLOT_SIZE)
+                for key, value in self._read_file().items():
+                    try:
+                        self._set_slot_locked(mm, key, value)
+                    except ValueError as e:
+                        log.warning("ShmStore: %s no se importó del snapshot: %s", key, e)
+                _KV_SEQ.pack_into(mm, 0, KV_MAGIC)
+        finally:
+            fcntl.flock(fd, fcntl.LOCK_UN)
+        return fd, mm
+
+    @staticmethod
+    def _slot_offset(index: int) -> int:
+        return KV_HEADER.size + (index % KV_SLOTS) * KV_SLOT_SIZE
+
+    def _read_slot(self, off: int):
+        """Copia consistente de un slot: ``(type, key, value_bytes)`` o ``None`` si sigue en escritura."""
+        mm = self._mm
+        for _ in range(1024):
+            s1 = _KV_SEQ.unpack_from(mm, off)[0]
+            if s1 & 1:
+                continue
+            _, kind, length, key = KV_SLOT_HEADER.unpack_from(mm, off)
+            start = off + KV_SLOT_HEADER.size
+            value = mm[start:start + min(length, KV_VALUE_MAX)]
+            if _KV_SEQ.unpack_from(mm, off)[0] == s1:
+                return kind, key.split(b"\0", 1)[0], value
+        return None
+
+    def _find(self, key: bytes):
+        """Sondeo lineal como ``kv_get``: devuelve ``(type, value_bytes)`` o ``None``."""
+        h = _kv_hash(key)
+        for n in range(KV_SLOTS):
+            slot = self._read_slot(self._slot_offset(h + n))
+            if slot is None or slot[0] == _KV_EMPTY:
+                return None
+            if slot[1] == key:
+                return slot[0], slot[2]
+        return None
+
+    @staticmethod
+    def _encode_key(key: str) -> bytes:
+        raw = key.encode("utf-8")
+        if not raw or len(raw) >= KV_KEY_MAX or b"\0" in raw:
+            raise ValueError(f"Clave inválida para ShmStore: {key!r}")
+        return raw
+
+    def _set_slot_locked(self, mm: mmap.mmap, key: str, value: Any) -> bool:
+        """
+        Escribe un slot (con el lock de escritores tomado).
 
-    def _read_file(self) -> dict:
+        Returns:
+            bool: True si el slot cambió.
         """
-        Lee el contenido JSON de forma segura con un bloqueo compartido.
+        raw_key = self._encode_key(key)
+        if isinstance(value, str):
+            kind, data = _KV_STRING, value.encode("utf-8")
+        else:
+            kind, data = _KV_JSON, json.dumps(value, separators=(",", ":")).encode("utf-8")
+        if len(data) > KV_VALUE_MAX:
+            kind, data = _KV_SNAPSHOT, b""
+
+        h = _kv_hash(raw_key)
+        for n in range(KV_SLOTS):
+            off = self._slot_offset(h + n)
+            seq, cur_kind, cur_len, cur_key = KV_SLOT_HEADER.unpack_from(mm, off)
+            cur_key = cur_key.split(b"\0", 1)[0]
+            if cur_kind != _KV_EMPTY and cur_key != raw_key:
+                continue
+            start = off + KV_SLOT_HEADER.size
+            if (cur_kind == kind and kind != _KV_SNAPSHOT and cur_len == len(data)
+                    and mm[start:start + cur_len] == data):
+                return False
+            _KV_SEQ.pack_into(mm, off, (seq + 1) & 0xFFFFFFFF)
+            KV_SLOT_HEADER.pack_into(mm, off, (seq + 1) & 0xFFFFFFFF, kind, len(data), raw_key)
+            mm[start:start + len(data)] = data
+            _KV_SEQ.pack_into(mm, off, (seq + 2) & 0xFFFFFFFF)
+            return True
+        raise ValueError("ShmStore lleno: no hay slots libres.")
+
+    def _snapshot_locked(self, big_values: dict) -> dict:
+        """Reconstruye el diccionario completo desde los slots (los valores grandes vienen del snapshot)."""
+        data, old = {}, None
+        for i in range(KV_SLOTS):
+            off = self._slot_offset(i)
+            _, kind, length, key = KV_SLOT_HEADER.unpack_from(self._mm, off)
+            if kind == _KV_EMPTY:
+                continue
+            name = key.split(b"\0", 1)[0].decode("utf-8")
+            start = off + KV_SLOT_HEADER.size
+            raw = bytes(self._mm[start:start + length])
+            if kind == _KV_STRING:
+                data[name] = raw.decode("utf-8")
+            elif kind == _KV_JSON:
+                data[name] = json.loads(raw)
+            elif name in big_values:
+                data[name] = big_values[name]
+            else:
+                if old is None:
+                    old = self._read_file()
+                if name in old:
+                    data[name] = old[name]
+        return data
+
+    def _update(self, values: dict):
+        """Aplica varias claves bajo un único lock y reescribe el snapshot si algo cambió."""
+        fcntl.flock(self._fd, fcntl.LOCK_EX)
+        try:
+            changed = False
+            for key, value in values.items():
+                changed |= self._set_slot_locked(self._mm, key, value)
+            if changed:
+                self._write_file(self._snapshot_locked(values))
+        finally:
+            fcntl.flock(self._fd, fcntl.LOCK_UN)
 
-        Utiliza `fcntl.LOCK_SH` para permitir múltiples lectores simultáneos 
-        pero bloquear a cualquier escritor.
+    def _read_file(self) -> dict:
+        """
+        Lee el snapshot JSON.
 
         Returns:
             dict: Datos cargados del archivo o diccionario vacío si hay error.
         """
-        if not os.path.exists(self.filepath):
-            return {}
-            
         try:
             with open(self.filepath, 'r') as f:
-                # Espera permiso de lectura (bloqueo compartido)
-                fcntl.flock(f, fcntl.LOCK_SH) 
-                try:
-                    return json.load(f)
-                finally:
-                    fcntl.flock(f, fcntl.LOCK_UN)
+                data = json.load(f)
+            return data if isinstance(data, dict) else {}
         except (json.JSONDecodeError, IOError):
             return {}
 
     def _write_file(self, data: dict):
         """
-        Escribe datos JSON de forma segura con un bloqueo exclusivo.
-
-        Utiliza `fcntl.LOCK_EX` para evitar que otros procesos lean o escriban 
-        mientras se actualiza el archivo.
+        Reescribe el snapshot JSON de forma atómica (temporal + rename).
 
         Args:
             data (dict): Diccionario de datos a persistir.
         """
-        with open(self.filepath, 'a+') as f:
-            fcntl.flock(f, fcntl.LOCK_EX) # Bloqueo exclusivo
-            try:
-                f.seek(0)
-                f.truncate(0)
-                json.dump(data, f)
-                f.flush()
-                os.fsync(f.fileno()) # Persistencia inmediata en RAM
-            finally:
-                fcntl.flock(f, fcntl.LOCK_UN)
-
-    def _update_file(self, updater: Callable[[dict], None]):
-        """
-        Aplica una actualización read-modify-write bajo un único lock exclusivo.
-
-        Evita condiciones de carrera entre múltiples procesos que actualicen
-        claves distintas casi al mismo tiempo.
-
-        Args:
-            updater (Callable[[dict], None]): Función que muta el diccionario actual.
-        """
-        with open(self.filepath, 'a+') as f:
-            fcntl.flock(f, fcntl.LOCK_EX)
-            try:
-                f.seek(0)
-                try:
-                    current_data = json.load(f)
-                    if not isinstance(current_data, dict):
-                        current_data = {}
-                except (json.JSONDecodeError, ValueError):
-                    current_data = {}
-
-                updater(current_data)
-
-                f.seek(0)
-                f.truncate(0)
-                json.dump(current_data, f)
-                f.flush()
-                os.fsync(f.fileno())
-            finally:
-                fcntl.flock(f, fcntl.LOCK_UN)
+        atomic_write_bytes(Path(self.filepath), json.dumps(data).encode("utf-8"))
+        try:
+            os.chmod(self.filepath, 0o666)
+        except OSError:
+            pass
 
     def add_to_persistent(self, key: str, value: Any):
         """
@@ -181,10 +292,7 @@ class ShmStore:
             key (str): Nombre de la clave.
             value (Any): Valor a almacenar.
         """
-        def _setter(current_data: dict):
-            current_data[key] = value
-
-        self._update_file(_setter)
+        self._update({key: value})
 
     def consult_persistent(self, key: str) -> Optional[Any]:
         """
@@ -196,9 +304,19 @@ class ShmStore:
         Returns:
             Any | None: El valor encontrado o None si la clave no existe.
         """
-        current_data = self._read_file()
-        return current_data.get(key, None)
-    
+        try:
+            found = self._find(self._encode_key(key))
+        except ValueError:
+            return None
+        if found is None:
+            return None
+        kind, raw = found
+        if kind == _KV_STRING:
+            return raw.decode("utf-8")
+        if kind == _KV_JSON:
+            return json.loads(raw)
+        return self._read_file().get(key, None)
+
     def update_from_dict(self, data_dict: dict):
         """
         Actualiza múltiples valores de forma atómica mediante un diccionario.
@@ -208,15 +326,23 @@ class ShmStore:
         """
         if not isinstance(data_dict, dict):
             return
-
-        def _merger(current_data: dict):
-            current_data.update(data_dict)
-
-        self._update_file(_merger)
+        self._update(data_dict)
 
     def clear_persistent(self):
         """Limpia todo el almacenamiento, dejándolo como un objeto vacío `{}`."""
-        self._write_file({})
+        fcntl.flock(self._fd, fcntl.LOCK_EX)
+        try:
+            for i in range(KV_SLOTS):
+                off = self._slot_offset(i)
+                seq, kind, _, _ = KV_SLOT_HEADER.unpack_from(self._mm, off)
+                if kind == _KV_EMPTY:
+                    continue
+                _KV_SEQ.pack_into(self._mm, off, (seq + 1) & 0xFFFFFFFF)
+                KV_SLOT_HEADER.pack_into(self._mm, off, (seq + 1) & 0xFFFFFFFF, _KV_EMPTY, 0, b"")
+                _KV_SEQ.pack_into(self._mm, off, (seq + 2) & 0xFFFFFFFF)
+            self._write_file({})
+        finally:
+            fcntl.flock(self._fd, fcntl.LOCK_UN)
 
 
 class ElapsedTimer:
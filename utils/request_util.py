@@ -15,13 +15,117 @@ import zmq.asyncio
 import json
 import re
 import os
+import struct
+import base64
+import numpy as np
 from dataclasses import dataclass
 
+#: Layout de ``psd_reply_header_t`` (rf/libs/psd_reply.h), little-endian, 48 bytes.
+PSD_REPLY_HEADER = struct.Struct("<IHBBIIddfffI")
+PSD_REPLY_MAGIC = 0x30445350
+_PSD_REPLY_DTYPES = {1: np.dtype("<f4"), 2: np.dtype("<i2")}
+#: Layout de ``psd_reply_capture_t`` (tercer frame opcional), little-endian, 40 bytes.
+PSD_REPLY_CAPTURE = struct.Struct("<IB3xQqqQ")
+PSD_REPLY_CAPTURE_MAGIC = 0x30504143
+
+
+def decode_psd_reply(frames: list) -> dict:
+    """
+    Reconstruye el dict de reply PSD a partir de un mensaje multipart binario.
+
+    Acepta los formatos ``reply_format: "f32"`` e ``"i16"`` del motor C y
+    devuelve las mismas llaves que el reply JSON (``status``, ``start_freq_hz``,
+    ``end_freq_hz``, ``excursion_hz``/``depth`` y ``Pxx``). Si el motor ubicó la
+    captura en el tiempo, un tercer frame se decodifica en ``capture`` con las
+    mismas llaves que el reply JSON.
+    """
+    if len(frames) not in (2, 3) or len(frames[0]) != PSD_REPLY_HEADER.size:
+        raise ValueError("Reply binario PSD con número de frames o cabecera inválidos.")
+
+    (magic, _version, fmt, rf_mode, n_bins, nperseg, start_hz, end_hz,
+     metric, q_scale, q_offset, seq) = PSD_REPLY_HEADER.unpack(frames[0])
+    if magic != PSD_REPLY_MAGIC or fmt not in _PSD_REPLY_DTYPES:
+        raise ValueError("Cabecera PSD binaria desconocida.")
+
+    bins = np.frombuffer(frames[1], dtype=_PSD_REPLY_DTYPES[fmt], count=n_bins)
+    if fmt == 2:
+        pxx = bins.astype(np.float64) * q_scale + q_offset
+    else:
+        pxx = bins.astype(np.float64)
+
+    out = {
+        "status": "ok",
+        "start_freq_hz": start_hz,
+        "end_freq_hz": end_hz,
+        "nperseg": nperseg,
+        "seq": seq,
+        "Pxx": pxx.tolist(),
+    }
+    if rf_mode == 1:
+        out["excursion_hz"] = metric
+    elif rf_mode == 2:
+        out["depth"] = metric
+
+    if len(frames) == 3 and len(frames[2]) == PSD_REPLY_CAPTURE.size:
+        cap_magic, flags, sample_index, t_mono, t_utc, dropped = PSD_REPLY_CAPTURE.unpack(frames[2])
+        if cap_magic == PSD_REPLY_CAPTURE_MAGIC and flags & 0x01:
+            out["capture"] = {
+                "sample_index": sample_index,
+                "t_mono_ns": t_mono,
+                "t_utc_ns": t_utc,
+                "time_source": "gps" if flags & 0x02 else "system",
+                "dropped_samples": dropped,
+            }
+    return out
+
+
+def _packbits_decode(data: bytes) -> bytes:
+    """Expande PackBits: cabecera 0..127 = n + 1 literales, 129..255 = byte repetido 257 - n veces."""
+    out = bytearray()
+    i, n = 0, len(data)
+    while i < n:
+        h = data[i]
+        i += 1
+        if h < 128:
+            out += data[i:i + h + 1]
+            i += h + 1
+        elif h > 128:
+            out += bytes([data[i]]) * (257 - h)
+            i += 1
+    return bytes(out)
+
+
+def decode_spectrogram(spec: dict) -> np.ndarray:
+    """
+    Reconstruye las filas del objeto ``"spectrogram"`` del reply (rf/libs/psd_spectrogram.h).
+
+    Deshace base64, PackBits y la diferencia entre filas (módulo 2^8 o 2^16) y devuelve
+    una matriz ``rows × bins`` en dBm (``q_offset_db + q * q_scale_db``).
+    """
+    if spec.get("encoding") != "delta_packbits":
+        raise ValueError(f"Codificación de espectrograma desconocida: {spec.get('encoding')}.")
+    rows, bins = int(spec["rows"]), int(spec["bins"])
+    raw = np.frombuffer(_packbits_decode(base64.b64decode(spec["data"])), dtype=np.uint8)
+
+    cells = rows * bins
+    if spec.get("format") == "i16":
+        if raw.size != 2 * cells:
+            raise ValueError("Espectrograma i16 truncado.")
+        delta = (raw[:cells].astype(np.uint16) | (raw[cells:].astype(np.uint16) << 8)).reshape(rows, bins)
+        q = np.cumsum(delta, axis=0, dtype=np.uint16).view(np.int16)
+    else:
+        if raw.size != cells:
+            raise ValueError("Espectrograma u8 truncado.")
+        q = np.cumsum(raw.reshape(rows, bins), axis=0, dtype=np.uint8)
+
+    return float(spec["q_offset_db"]) + q.astype(np.float64) * float(spec["q_scale_db"])
+
 @dataclass
 class FilterConfig:
     """Configuración de filtrado digital para la señal de RF."""
     start_freq_hz: int #: Frecuencia de inicio en Hertz
     end_freq_hz: int #: Frecuencia de fin en Hertz
+    zoom: bool = False #: Zoom-FFT: rf_app diezma la banda antes de la PSD (misma RBW, FFT más chica)
 
 @dataclass
 class ServerRealtimeConfig:
@@ -45,6 +149,7 @@ class ServerRealtimeConfig:
     cooldown_request: float = 1.0
     demodulation: Optional[str] = None
     filter: Optional[FilterConfig] = None
+    target_averages: Optional[int] = None #: Promedios por captura (None = F_s/4 bytes, latencia ~250 ms)
 
     def __post_init__(self):
         """Valida las restricciones físicas del hardware SDR."""
@@ -89,6 +194,9 @@ class ServerRealtimeConfig:
         if self.cooldown_request < 0:
             raise ValueError(f"cooldown_request {self.cooldown_request} inválido. Debe ser >= 0.")
 
+        if self.target_averages is not None and int(self.target_averages) < 1:
+            raise ValueError(f"target_averages {self.target_averages} inválido. Debe ser >= 1.")
+
 class RequestClient:
     """
     Cliente HTTP ligero con códigos de retorno unificados.
@@ -340,11 +448,13 @@ class ZmqPairController:
 
         try:
             if await self.socket.poll(self.timeout_ms, zmq.POLLIN):
-                msg = await self.socket.recv_string()
+                frames = await self.socket.recv_multipart()
                 self._awaiting_reply = False
                 if self.verbose:
                     print(f"[PY] << Datos recibidos")
-                return json.loads(msg)
+                if len(frames) > 1:
+                    return decode_psd_reply(frames)
+                return json.loads(frames[0].decode("utf-8"))
         except zmq.ZMQError:
             self._reopen_socket()
             raise
@@ -366,3 +476,58 @@ class ZmqPairController:
 
     async def __aexit__(self, exc_type, exc_value, traceback):
         self.close()
+
+
+class ZmqPsdSubscriber:
+    """
+    Suscriptor asíncrono del modo streaming PSD de ``rf_app``.
+
+    Tras enviar por :class:`ZmqPairController` un request con el objeto
+    ``"stream": {"rate_hz": ..., "frames": ...}``, el motor C responde
+    ``status: "streaming"`` con ``pub_addr`` y publica frames PSD consecutivos
+    en ese socket PUB. Cada frame se entrega con el mismo formato que el reply
+    REQ/REP (JSON o multipart binario) más la llave ``seq``.
+    """
+    def __init__(self, addr: str = "ipc:///tmp/rf_psd_stream", timeout_ms: int = 5000):
+        self.addr = addr
+        self.timeout_ms = timeout_ms
+        self.context = None
+        self.socket = None
+
+    def start(self):
+        """Crea el socket SUB y se conecta al PUB del motor RF."""
+        if self.socket is not None:
+            return
+        self.context = zmq.asyncio.Context()
+        self.socket = self.context.socket(zmq.SUB)
+        self.socket.setsockopt(zmq.LINGER, 0)
+        self.socket.setsockopt(zmq.RCVHWM, 4)
+        self.socket.setsockopt(zmq.SUBSCRIBE, b"")
+        self.socket.connect(self.addr)
+
+    def close(self):
+        """Libera el socket y el contexto."""
+        if self.socket:
+            self.socket.close()
+            self.socket = None
+        if self.context:
+            self.context.term()
+            self.context = None
+
+    async def next_frame(self) -> dict | None:
+        """Espera el siguiente frame; retorna ``None`` si vence ``timeout_ms``."""
+        if not self.socket:
+            raise RuntimeError("Socket no iniciado.")
+        if not await self.socket.poll(self.timeout_ms, zmq.POLLIN):
+            return None
+        frames = await self.socket.recv_multipart()
+        if len(frames) > 1:
+            return decode_psd_reply(frames)
+        return json.loads(frames[0].decode("utf-8"))
+
+    async def __aenter__(self):
+        self.start()
+        return self
+
+    async def __aexit__(self, exc_type, exc_value, traceback):
+        self.close()